@@ -21,120 +21,118 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, PFManager *pf_manager, si
   std::cout << fmt::format("Create BPM (size={}, k={})", pool_size, replacer_k) << std::endl;
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
-
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  std::lock_guard<std::mutex> lk(latch_);
-
-  if (!free_list_.empty()) {
-    // Get The Physical Memory
-    frame_id_t fid = free_list_.front();
-    free_list_.pop_front();
-
-    // reset memory and metadata
-    *page_id = AllocatePage();
-    this->ResetMetaInfo(&pages_[fid], *page_id);
-    pages_[fid].pin_count_ = 1;
-    page_table_.insert({*page_id, fid});
-    replacer_->RecordAccess(fid);
-    return &pages_[fid];
+BufferPoolManager::~BufferPoolManager() {
+  // drain read-ahead before the frames go away
+  for (auto &[page_id, read_done] : inflight_reads_) {
+    read_done.wait();
   }
+  delete[] pages_;
+}
 
-  // check if it has the evictable frame
+auto BufferPoolManager::NewPage(page_id_t *page_id, AccessType access_type) -> Page * {
+  std::lock_guard<std::mutex> lk(latch_);
 
   frame_id_t fid;
-  if (!replacer_->Evict(&fid)) {
+  if (!AcquireFrame(&fid)) {
     return nullptr;
   }
 
-  if (pages_[fid].is_dirty_) {  // flush dirty page
-    // Get the mapping page meta info
-    const Page *evict_frame = &pages_[fid];
-    WritePageData(evict_frame->data_, evict_frame->page_id_);
-  }
-
-  // allocate the new page_id, pin the frame
+  // allocate the new page_id, reset memory and metadata, pin the frame
   *page_id = AllocatePage();
   this->ResetMetaInfo(&pages_[fid], *page_id);
   pages_[fid].pin_count_ = 1;
 
   page_table_.insert({*page_id, fid});
-  replacer_->RecordAccess(fid);
+  replacer_->RecordAccess(fid, access_type);
+  replacer_->SetEvictable(fid, false);
   return &pages_[fid];
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id) -> Page * {
-  std::lock_guard<std::mutex> lk(latch_);
-//  std::cout << "Fetch Page " << page_id << std::endl;
-
-  if (page_table_.count(page_id) == 0) {
-    return nullptr;
-  }
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  std::unique_lock<std::mutex> lk(latch_);
 
   // check if in buffer now
-  frame_id_t fid = -1;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].page_id_ == page_id) {
-      fid = i;
-      break;
-    }
-  }
-  if (fid != -1) {
+  auto page_iter = page_table_.find(page_id);
+  if (page_iter != page_table_.end()) {
+    frame_id_t fid = page_iter->second;
     pages_[fid].pin_count_++;
-    if (pages_[fid].pin_count_ > 0) {
-      replacer_->SetEvictable(fid, false);
+    replacer_->RecordAccess(fid, access_type);
+    replacer_->SetEvictable(fid, false);
+
+    // the page may still be landing from a read-ahead, wait for it without blocking the whole pool
+    auto inflight = inflight_reads_.find(page_id);
+    if (inflight != inflight_reads_.end()) {
+      std::shared_future<bool> read_done = inflight->second;
+      if (read_done.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        inflight_reads_.erase(inflight);
+      } else {
+        lk.unlock();
+        read_done.wait();
+      }
     }
     return &pages_[fid];
   }
 
-  // if not, find the replacement in the free_list
-  if (!free_list_.empty()) {
-    fid = free_list_.front();
-    free_list_.pop_front();
-
-    // set Meta Info And Read Data
-    this->ResetMetaInfo(&pages_[fid], page_id);
-    pages_[fid].pin_count_ = 1;
-    ReadPageData(pages_[fid].data_, page_id);
-
-    replacer_->RecordAccess(fid);
-    return &pages_[fid];
+  // a deallocated page is not fetched until NewPage() hands its id out again, a stale id must not resurrect it
+  if (page_id == INVALID_PAGE_ID || free_page_ids_.count(page_id) > 0) {
+    return nullptr;
   }
 
-  frame_id_t evict_id;
-  if (!replacer_->Evict(&evict_id)) {
+  // if not, find the replacement in the free_list or the replacer
+  frame_id_t fid;
+  if (!AcquireFrame(&fid)) {
     return nullptr;
   }
 
-  if (pages_[evict_id].is_dirty_) {
-    // flush
-    const Page *page = &pages_[evict_id];
-    WritePageData(page->data_, page->page_id_);
+  // reset meta info, read data
+  this->ResetMetaInfo(&pages_[fid], page_id);
+  pages_[fid].pin_count_ = 1;
+  page_table_.insert({page_id, fid});
+  replacer_->RecordAccess(fid, access_type);
+  replacer_->SetEvictable(fid, false);
+  ReadPageData(pages_[fid].data_, page_id);
+
+  return &pages_[fid];
+}
+
+auto BufferPoolManager::PrefetchPage(page_id_t page_id, AccessType access_type) -> bool {
+  std::lock_guard<std::mutex> lk(latch_);
+
+  if (page_table_.count(page_id) > 0) {
+    return true;
+  }
+  if (page_id == INVALID_PAGE_ID || free_page_ids_.count(page_id) > 0) {
+    return false;
   }
 
-  // reset meta info
-  // read data
-  this->ResetMetaInfo(&pages_[evict_id], page_id);
-  pages_[evict_id].pin_count_ = 1;
-  page_table_.insert({page_id, evict_id});
-  ReadPageData(pages_[evict_id].data_, page_id);
-  replacer_->RecordAccess(evict_id);
+  frame_id_t fid;
+  if (!AcquireFrame(&fid)) {
+    return false;
+  }
+
+  this->ResetMetaInfo(&pages_[fid], page_id);
+  page_table_.insert({page_id, fid});
+  replacer_->RecordAccess(fid, access_type);
+  replacer_->SetEvictable(fid, true);
 
-  return &pages_[evict_id];
+  // hand the read to the scheduler and remember the future, FetchPage/eviction will wait on it
+  auto promise = disk_scheduler_->CreatePromise();
+  inflight_reads_.insert({page_id, promise.get_future().share()});
+  disk_scheduler_->Schedule(
+      {.is_write_ = false, .data_ = pages_[fid].data_, .page_id_ = page_id, .callback_ = std::move(promise)});
+  return true;
 }
 
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) -> bool {
   std::lock_guard<std::mutex> lk(latch_);
 
-  frame_id_t frame_id = -1;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].page_id_ == page_id) {
-      frame_id = static_cast<int32_t>(i);
-      break;
-    }
+  auto page_iter = page_table_.find(page_id);
+  if (page_iter == page_table_.end()) {
+    return false;
   }
 
-  if (frame_id == -1 || pages_[frame_id].pin_count_ == 0) {
+  frame_id_t frame_id = page_iter->second;
+  if (pages_[frame_id].pin_count_ == 0) {
     return false;
   }
 
@@ -160,10 +158,7 @@ auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
   }
 
   frame_id_t fid = page_iter->second;
-  if (pages_[fid].page_id_ != page_id) {
-    return false;
-  }
-
+  WaitInflightRead(page_id);
   WritePageData(pages_[fid].data_, page_id);
   pages_[fid].is_dirty_ = false;
   return true;
@@ -172,30 +167,31 @@ auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
 void BufferPoolManager::FlushAllPages() {
   std::lock_guard<std::mutex> lk(latch_);
 
-  for (size_t i = 0; i < pool_size_; i++) {
-    WritePageData(pages_[i].data_, pages_[i].page_id_);
+  for (const auto &[page_id, fid] : page_table_) {
+    WaitInflightRead(page_id);
+    WritePageData(pages_[fid].data_, page_id);
+    pages_[fid].is_dirty_ = false;
   }
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
   std::lock_guard<std::mutex> lk(latch_);
 
-  frame_id_t frame_id = -1;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].page_id_ == page_id) {
-      frame_id = static_cast<int32_t>(i);
-      break;
+  auto page_iter = page_table_.find(page_id);
+  if (page_iter == page_table_.end()) {
+    if (page_id != INVALID_PAGE_ID && page_id < next_page_id_) {
+      DeallocatePage(page_id);
     }
-  }
-  if (frame_id == -1) {
     return true;
   }
 
+  frame_id_t frame_id = page_iter->second;
   if (pages_[frame_id].pin_count_ > 0) {
     return false;
   }
 
-  page_table_.erase(page_id);
+  WaitInflightRead(page_id);
+  page_table_.erase(page_iter);
   replacer_->Remove(frame_id);
   free_list_.push_back(frame_id);
 
@@ -204,12 +200,50 @@ auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::AcquireFrame(frame_id_t *frame_id) -> bool {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+
+  // check if it has the evictable frame
+  if (!replacer_->Evict(frame_id)) {
+    return false;
+  }
+
+  Page *victim = &pages_[*frame_id];
+  WaitInflightRead(victim->page_id_);
+  if (victim->is_dirty_) {  // flush dirty page
+    WritePageData(victim->data_, victim->page_id_);
+  }
+  page_table_.erase(victim->page_id_);
+  return true;
+}
+
+void BufferPoolManager::WaitInflightRead(page_id_t page_id) {
+  auto inflight = inflight_reads_.find(page_id);
+  if (inflight != inflight_reads_.end()) {
+    inflight->second.wait();
+    inflight_reads_.erase(inflight);
+  }
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+auto BufferPoolManager::AllocatePage() -> page_id_t {
+  if (!free_page_ids_.empty()) {
+    page_id_t page_id = *free_page_ids_.begin();
+    free_page_ids_.erase(free_page_ids_.begin());
+    return page_id;
+  }
+  return next_page_id_++;
+}
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  Page *page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  Page *page = FetchPage(page_id, access_type);
   if (page != nullptr) {
     page->RLatch();
     return {this, page};
@@ -217,8 +251,8 @@ auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
   return {this, nullptr};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  Page *page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  Page *page = FetchPage(page_id, access_type);
   if (page != nullptr) {
     page->WLatch();
     return {this, page};
@@ -226,7 +260,9 @@ auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
   return {this, nullptr};
 }
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, NewPage(page_id, access_type)};
+}
 
 void BufferPoolManager::ReadPageData(const char *data, page_id_t page_id) {
   auto promise = disk_scheduler_->CreatePromise();
@@ -235,7 +271,6 @@ void BufferPoolManager::ReadPageData(const char *data, page_id_t page_id) {
   disk_scheduler_->Schedule(
       {.is_write_ = false, .data_ = const_cast<char *>(data), .page_id_ = page_id, .callback_ = std::move(promise)});
   is_done_future.get();  // block until read
-  std::cout << "finished read page " << page_id << std::endl;
 }
 
 void BufferPoolManager::WritePageData(const char *data, page_id_t page_id) {
@@ -246,8 +281,6 @@ void BufferPoolManager::WritePageData(const char *data, page_id_t page_id) {
       {.is_write_ = true, .data_ = const_cast<char *>(data), .page_id_ = page_id, .callback_ = std::move(promise)});
 
   is_done_future.get();  // block until write
-
-  std::cout << "finished write page " << page_id << std::endl;
 }
 
 }  // namespace bustub
@@ -1,5 +1,6 @@
 #include "buffer/lru_k_replacer.h"
 #include <fmt/format.h>
+#include <initializer_list>
 #include "common/exception.h"
 
 namespace redbase {
@@ -7,65 +8,22 @@ namespace redbase {
 LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : k_(k), maximum_frame_(num_frames) {}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-  std::unordered_map<frame_id_t, size_t> distance_map;
-  std::vector<frame_id_t> inf_fids;
-
   std::lock_guard<std::mutex> lk(this->latch_);
 
-  for (const auto &entry : this->node_store_) {
-    if (entry.second.IsEvictable()) {
-      frame_id_t fid = entry.first;
-      size_t distance = entry.second.GetKDistance(current_timestamp_);
-
-      if (distance == LRUKNode::MAX_TIMESTAMP) {
-        inf_fids.push_back(fid);
-      } else {
-        distance_map.insert({fid, distance});
-      }
+  // scan-only frames go first in LRU order, then the +inf frames in LRU order, then the largest k-distance
+  for (EvictionQueue *queue : {&this->scan_queue_, &this->inf_queue_, &this->k_queue_}) {
+    if (!queue->empty()) {
+      *frame_id = queue->begin()->second;
+      queue->erase(queue->begin());
+      this->node_store_.erase(*frame_id);
+      this->replacer_size_--;
+      return true;
     }
   }
-
-  // check if replacer only has one inf
-  if (inf_fids.size() == 1) {
-    frame_id_t temp = inf_fids.front();
-    *frame_id = temp;
-  } else if (inf_fids.empty()) {
-    // check if the replacer has the evictable frame
-    if (distance_map.empty()) {
-      return false;
-    }
-
-    // compute the max_distance
-    frame_id_t evict_fid = -1;
-    size_t max_dis = 0;
-    for (const auto &entry : distance_map) {
-      if (entry.second > max_dis) {
-        max_dis = entry.second;
-        evict_fid = entry.first;
-      }
-    }
-    *frame_id = evict_fid;
-  } else {
-    // exist more inf frame
-    int recent_fid = -1;
-    size_t far_from_recent_timestamp = LRUKNode::MAX_TIMESTAMP - 1;
-
-    for (auto fid : inf_fids) {
-      size_t frame_recent_acc_time = this->node_store_.at(fid).GetRecentAccessTimestamp();
-      if (frame_recent_acc_time < far_from_recent_timestamp) {
-        far_from_recent_timestamp = frame_recent_acc_time;
-        recent_fid = fid;
-      }
-    }
-    *frame_id = recent_fid;
-  }
-
-  this->node_store_.erase(*frame_id);
-  this->replacer_size_--;
-  return true;
+  return false;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
   std::lock_guard<std::mutex> lk(this->latch_);
 
   if (static_cast<size_t>(frame_id) >= this->maximum_frame_) {
@@ -74,12 +32,15 @@ void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType
 
   auto node = this->node_store_.find(frame_id);
   if (node == this->node_store_.end()) {  // add a new node with history dsz
-    LRUKNode new_node(this->k_, frame_id, false);
+    LRUKNode new_node(this->k_, frame_id, false, access_type == AccessType::Scan);
     this->node_store_.insert({frame_id, new_node});
 
     node = this->node_store_.find(frame_id);
   }
+  Dequeue(frame_id, node->second);
   node->second.AddHistory(this->current_timestamp_);
+  node->second.MarkAccessType(access_type);
+  Enqueue(frame_id, node->second);
   this->current_timestamp_++;
 }
 
@@ -102,11 +63,13 @@ void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   }
 
   if (node.IsEvictable()) {
+    Dequeue(frame_id, node);
     this->replacer_size_ -= 1;
   } else {
     this->replacer_size_ += 1;
   }
   node.SetEvictable(set_evictable);
+  Enqueue(frame_id, node);
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
@@ -120,10 +83,30 @@ void LRUKReplacer::Remove(frame_id_t frame_id) {
   if (!node_iter->second.IsEvictable()) {
     throw Exception(fmt::format("the frame_id {%d} is non-evictable", frame_id));
   }
-  this->node_store_.erase(frame_id);
+  Dequeue(frame_id, node_iter->second);
+  this->node_store_.erase(node_iter);
   this->replacer_size_ -= 1;
 }
 
 auto LRUKReplacer::Size() -> size_t { return this->replacer_size_; }
 
+auto LRUKReplacer::QueueOf(LRUKNode &node) -> EvictionQueue & {
+  if (node.IsScanOnly()) {
+    return this->scan_queue_;
+  }
+  return node.HasKHistory() ? this->k_queue_ : this->inf_queue_;
+}
+
+void LRUKReplacer::Enqueue(frame_id_t frame_id, LRUKNode &node) {
+  if (node.IsEvictable()) {
+    QueueOf(node).emplace(node.GetRecentAccessTimestamp(), frame_id);
+  }
+}
+
+void LRUKReplacer::Dequeue(frame_id_t frame_id, LRUKNode &node) {
+  if (node.IsEvictable()) {
+    QueueOf(node).erase({node.GetRecentAccessTimestamp(), frame_id});
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,125 @@
+#include "buffer/sorted_run.h"
+
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+void ReadSpillPage(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t page_idx,
+                   std::vector<char> *page, const char *what) {
+  size_t prefetch_begin = page_idx == 0 ? 1 : page_idx + SCAN_READ_AHEAD;
+  for (size_t i = prefetch_begin; i <= page_idx + SCAN_READ_AHEAD && i < page_ids.size(); i++) {
+    bpm->PrefetchPage(page_ids[i]);
+  }
+  page_id_t page_id = page_ids[page_idx];
+  auto guard = bpm->FetchPageRead(page_id, AccessType::Scan);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("{} page {} cannot be fetched", what, page_id));
+  }
+  page->resize(PAGE_SIZE);
+  memcpy(page->data(), guard.GetData(), PAGE_SIZE);
+  guard.Drop();
+  bpm->DeletePage(page_id);
+}
+
+SortedRun::SortedRun(BufferPoolManager *bpm, uint32_t record_size, const char *what)
+    : bpm_(bpm), record_size_(record_size), what_(what) {
+  records_per_page_ = record_size_ == 0 ? 0 : (PAGE_SIZE - RUN_PAGE_HEADER_SIZE) / record_size_;
+  if (records_per_page_ == 0) {
+    throw Exception(fmt::format("{}: a record of {} bytes does not fit a run page", what_, record_size_));
+  }
+}
+
+SortedRun::SortedRun(SortedRun &&other) noexcept
+    : bpm_(other.bpm_),
+      record_size_(other.record_size_),
+      what_(other.what_),
+      records_per_page_(other.records_per_page_),
+      page_ids_(std::move(other.page_ids_)),
+      page_idx_(other.page_idx_),
+      page_(std::move(other.page_)),
+      count_(other.count_),
+      slot_(other.slot_),
+      head_(other.head_) {
+  other.page_ids_.clear();
+  other.page_idx_ = 0;
+  other.head_ = nullptr;
+}
+
+auto SortedRun::operator=(SortedRun &&other) noexcept -> SortedRun & {
+  if (this != &other) {
+    DeletePages();
+    bpm_ = other.bpm_;
+    record_size_ = other.record_size_;
+    what_ = other.what_;
+    records_per_page_ = other.records_per_page_;
+    page_ids_ = std::move(other.page_ids_);
+    page_idx_ = other.page_idx_;
+    page_ = std::move(other.page_);
+    count_ = other.count_;
+    slot_ = other.slot_;
+    head_ = other.head_;
+    other.page_ids_.clear();
+    other.page_idx_ = 0;
+    other.head_ = nullptr;
+  }
+  return *this;
+}
+
+void SortedRun::Append(const char *record) {
+  page_.resize(PAGE_SIZE);
+  memcpy(page_.data() + RUN_PAGE_HEADER_SIZE + size_t{count_} * record_size_, record, record_size_);
+  count_++;
+  if (count_ == records_per_page_) {
+    FlushPage();
+  }
+}
+
+void SortedRun::Finish() {
+  FlushPage();
+  slot_ = 0;
+}
+
+auto SortedRun::Advance() -> const char * {
+  while (slot_ >= count_) {
+    if (page_idx_ >= page_ids_.size()) {
+      head_ = nullptr;
+      return head_;
+    }
+    ReadSpillPage(bpm_, page_ids_, page_idx_++, &page_, what_);
+    memcpy(&count_, page_.data(), sizeof(uint32_t));
+    slot_ = 0;
+  }
+  head_ = page_.data() + RUN_PAGE_HEADER_SIZE + size_t{slot_++} * record_size_;
+  return head_;
+}
+
+void SortedRun::FlushPage() {
+  if (count_ == 0) {
+    return;
+  }
+  memcpy(page_.data(), &count_, sizeof(uint32_t));
+  page_id_t page_id;
+  auto basic = bpm_->NewPageGuarded(&page_id, AccessType::Scan);
+  if (!basic.IsValid()) {
+    throw Exception(fmt::format("{}: no free frame in the buffer pool for a run page", what_));
+  }
+  auto guard = basic.UpgradeWrite();
+  memcpy(guard.GetDataMut(), page_.data(), PAGE_SIZE);
+  page_ids_.push_back(page_id);
+  count_ = 0;
+}
+
+void SortedRun::DeletePages() {
+  for (size_t i = page_idx_; i < page_ids_.size(); i++) {
+    bpm_->DeletePage(page_ids_[i]);
+  }
+  page_ids_.clear();
+  page_idx_ = 0;
+}
+
+}  // namespace redbase
@@ -0,0 +1,48 @@
+#include "catalog/catalog.h"
+
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+auto Catalog::CreateTable(const std::string &name, Schema schema, TableHeap *heap)
+    -> std::shared_ptr<const TableInfo> {
+  std::unique_lock lock(latch_);
+  if (tables_.count(name) != 0) {
+    throw Exception(fmt::format("table {} already exists", name));
+  }
+  auto table = std::make_shared<const TableInfo>(TableInfo{name, std::move(schema), heap, {}});
+  tables_.emplace(name, table);
+  version_.fetch_add(1, std::memory_order_release);
+  return table;
+}
+
+void Catalog::DropTable(const std::string &name) {
+  std::unique_lock lock(latch_);
+  if (tables_.erase(name) == 0) {
+    throw Exception(fmt::format("no table {}", name));
+  }
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+auto Catalog::GetTable(const std::string &name) const -> std::shared_ptr<const TableInfo> {
+  std::shared_lock lock(latch_);
+  auto iter = tables_.find(name);
+  return iter == tables_.end() ? nullptr : iter->second;
+}
+
+void Catalog::SetStatistics(const std::string &name, TableStatistics statistics) {
+  std::unique_lock lock(latch_);
+  auto iter = tables_.find(name);
+  if (iter == tables_.end()) {
+    throw Exception(fmt::format("no table {}", name));
+  }
+  auto table = std::make_shared<TableInfo>(*iter->second);
+  table->statistics_ = statistics;
+  iter->second = std::move(table);
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+}  // namespace redbase
@@ -0,0 +1,193 @@
+#include "common/task_scheduler.h"
+
+#include <algorithm>
+
+namespace redbase {
+
+namespace {
+
+/** The scheduler the calling thread works for, if any, and its index. */
+thread_local const TaskScheduler *current_scheduler = nullptr;
+thread_local size_t current_worker = 0;
+
+}  // namespace
+
+TaskScheduler::TaskScheduler(size_t num_workers) {
+  num_workers = std::max<size_t>(num_workers, 1);
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (size_t i = 0; i < num_workers; i++) {
+    workers_[i]->thread_ = std::thread([this, i] { WorkerLoop(i); });
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::scoped_lock lock(sleep_latch_);
+    stop_ = true;
+  }
+  sleep_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker->thread_.join();
+  }
+}
+
+auto TaskScheduler::CurrentWorker() const -> std::optional<size_t> {
+  if (current_scheduler != this) {
+    return std::nullopt;
+  }
+  return current_worker;
+}
+
+void TaskScheduler::Push(size_t worker_idx, Entry entry) {
+  {
+    std::scoped_lock lock(workers_[worker_idx]->latch_);
+    workers_[worker_idx]->tasks_.push_back(std::move(entry));
+  }
+  {
+    std::scoped_lock lock(sleep_latch_);
+    queued_++;
+  }
+  sleep_cv_.notify_one();
+}
+
+auto TaskScheduler::Take(size_t worker_idx, const TaskGroup *group, Entry *entry) -> bool {
+  auto matches = [group](const Entry &queued) { return group == nullptr || queued.group_ == group; };
+  {
+    Worker &own = *workers_[worker_idx];
+    std::scoped_lock lock(own.latch_);
+    auto iter = std::find_if(own.tasks_.rbegin(), own.tasks_.rend(), matches);
+    if (iter != own.tasks_.rend()) {
+      *entry = std::move(*iter);
+      own.tasks_.erase(std::next(iter).base());
+      queued_--;
+      entry->group_->OnTaken();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); i++) {
+    Worker &victim = *workers_[(worker_idx + i) % workers_.size()];
+    std::scoped_lock lock(victim.latch_);
+    auto iter = std::find_if(victim.tasks_.begin(), victim.tasks_.end(), matches);
+    if (iter != victim.tasks_.end()) {
+      *entry = std::move(*iter);
+      victim.tasks_.erase(iter);
+      queued_--;
+      entry->group_->OnTaken();
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::Run(size_t worker_idx, Entry *entry) {
+  std::exception_ptr error;
+  try {
+    entry->task_(worker_idx);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the task goes before the group hears of it, the group may be gone right after
+  entry->task_ = nullptr;
+  entry->group_->OnFinished(error);
+}
+
+void TaskScheduler::WorkerLoop(size_t worker_idx) {
+  current_scheduler = this;
+  current_worker = worker_idx;
+  Entry entry;
+  while (true) {
+    if (Take(worker_idx, nullptr, &entry)) {
+      Run(worker_idx, &entry);
+      continue;
+    }
+    std::unique_lock lock(sleep_latch_);
+    sleep_cv_.wait(lock, [this] { return queued_ > 0 || stop_; });
+    if (stop_ && queued_ == 0) {
+      return;
+    }
+  }
+}
+
+TaskGroup::~TaskGroup() {
+  std::unique_lock lock(latch_);
+  cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void TaskGroup::Spawn(TaskScheduler::Task task) {
+  std::optional<size_t> worker = scheduler_->CurrentWorker();
+  Spawn(worker.has_value() ? *worker : scheduler_->next_worker_++, std::move(task));
+}
+
+void TaskGroup::Spawn(size_t worker_idx, TaskScheduler::Task task) {
+  {
+    std::scoped_lock lock(latch_);
+    pending_++;
+    queued_++;
+  }
+  scheduler_->Push(worker_idx % scheduler_->GetWorkerCount(), {this, std::move(task)});
+  // a worker waiting for the group may run it
+  cv_.notify_all();
+}
+
+void TaskGroup::Wait() {
+  std::optional<size_t> worker = scheduler_->CurrentWorker();
+  std::unique_lock lock(latch_);
+  while (pending_ > 0) {
+    if (worker.has_value() && queued_ > 0) {
+      lock.unlock();
+      TaskScheduler::Entry entry;
+      if (scheduler_->Take(*worker, this, &entry)) {
+        scheduler_->Run(*worker, &entry);
+      }
+      lock.lock();
+      continue;
+    }
+    cv_.wait(lock, [&] { return pending_ == 0 || (worker.has_value() && queued_ > 0); });
+  }
+  if (error_ != nullptr) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    failed_ = false;
+    std::rethrow_exception(error);
+  }
+}
+
+void TaskGroup::OnTaken() {
+  std::scoped_lock lock(latch_);
+  queued_--;
+}
+
+void TaskGroup::OnFinished(std::exception_ptr error) {
+  std::scoped_lock lock(latch_);
+  if (error != nullptr && error_ == nullptr) {
+    error_ = error;
+    failed_ = true;
+  }
+  pending_--;
+  if (pending_ == 0) {
+    cv_.notify_all();
+  }
+}
+
+void ParallelFor(TaskScheduler *scheduler, size_t num_threads, size_t count, const std::function<void(size_t i)> &fn) {
+  if (scheduler == nullptr && (num_threads <= 1 || count <= 1)) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+  std::optional<TaskScheduler> own;
+  if (scheduler == nullptr) {
+    own.emplace(std::min(num_threads, count));
+    scheduler = &*own;
+  }
+  TaskGroup group(scheduler);
+  for (size_t i = 0; i < count; i++) {
+    group.Spawn([&fn, i](size_t /*worker_idx*/) { fn(i); });
+  }
+  group.Wait();
+}
+
+}  // namespace redbase
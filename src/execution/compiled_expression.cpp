@@ -0,0 +1,515 @@
+#include "execution/compiled_expression.h"
+
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+
+namespace redbase {
+
+namespace {
+
+/** @return the type whose kernels serve a column type: DATE is stored like INTEGER */
+auto StorageType(TypeId type_id) -> TypeId { return type_id == TypeId::DATE ? TypeId::INTEGER : type_id; }
+
+template <typename T>
+constexpr auto TypeOf() -> TypeId {
+  if constexpr (std::is_same_v<T, int32_t>) {
+    return TypeId::INTEGER;
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return TypeId::BIGINT;
+  } else {
+    return TypeId::DOUBLE;
+  }
+}
+
+/** The type arithmetic on an L and an R is carried out in, see ArithmeticExpression. */
+template <typename L, typename R>
+using ArithmeticResult = std::conditional_t<std::is_same_v<L, double> || std::is_same_v<R, double>, double, int64_t>;
+
+/** @return true if the storage type of a column holds the value exactly */
+auto Fits(TypeId type_id, const Value &value) -> bool {
+  switch (StorageType(type_id)) {
+    case TypeId::INTEGER:
+      return ExactAs<int32_t>(value).has_value();
+    case TypeId::BIGINT:
+      return ExactAs<int64_t>(value).has_value();
+    case TypeId::DOUBLE:
+      return ExactAs<double>(value).has_value();
+    default:
+      return false;
+  }
+}
+
+/** A constant checked by Fits() at compile time. */
+template <typename T>
+inline auto ConstantAs(const Value &value) -> T {
+  if constexpr (std::is_same_v<T, double>) {
+    return value.GetAsDouble();
+  } else {
+    return static_cast<T>(value.GetAsInteger());
+  }
+}
+
+template <ComparisonType OP, typename T>
+inline auto Compare(T a, T b) -> bool {
+  if constexpr (OP == ComparisonType::EQUAL) {
+    return a == b;
+  } else if constexpr (OP == ComparisonType::NOT_EQUAL) {
+    return a != b;
+  } else if constexpr (OP == ComparisonType::LESS_THAN) {
+    return a < b;
+  } else if constexpr (OP == ComparisonType::LESS_EQUAL) {
+    return a <= b;
+  } else if constexpr (OP == ComparisonType::GREATER_THAN) {
+    return a > b;
+  } else {
+    return a >= b;
+  }
+}
+
+template <ArithmeticType OP, typename T>
+inline auto Compute(T a, T b) -> T {
+  if constexpr (OP == ArithmeticType::PLUS) {
+    return a + b;
+  } else if constexpr (OP == ArithmeticType::MINUS) {
+    return a - b;
+  } else {
+    return a * b;
+  }
+}
+
+/** Rows per block of SelectDense(). */
+constexpr size_t FUSED_BLOCK = 1024;
+
+/**
+ * Refine the selection of all the rows of a chunk a block at a time: `fill(begin, n, bitmap)` sets the bits of the
+ * rows [begin, begin + n) that pass, and the rows set are written to the selection.
+ */
+template <typename F>
+inline void SelectDense(SelectionVector *selection, F &&fill) {
+  uint32_t *rows = selection->GetData();
+  size_t count = selection->GetCount();
+  uint64_t bitmap[FUSED_BLOCK / 64];
+  size_t kept = 0;
+  for (size_t begin = 0; begin < count; begin += FUSED_BLOCK) {
+    size_t n = std::min(FUSED_BLOCK, count - begin);
+    fill(begin, n, bitmap);
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+      for (uint64_t word = bitmap[w]; word != 0; word &= word - 1) {
+        rows[kept++] = static_cast<uint32_t>(begin + w * 64 + __builtin_ctzll(word));
+      }
+    }
+  }
+  selection->SetCount(kept);
+}
+
+/**
+ * Keep the rows of a sparse selection for which `pass(row)` holds. The loop is branch free, see SelectLoop() of the
+ * interpreter; the selection is overwritten behind the rows read.
+ */
+template <typename Pass>
+inline void Refine(SelectionVector *selection, Pass &&pass) {
+  uint32_t *rows = selection->GetData();
+  size_t kept = 0;
+  for (size_t i = 0; i < selection->GetCount(); i++) {
+    uint32_t row = rows[i];
+    rows[kept] = row;
+    kept += pass(row);
+  }
+  selection->SetCount(kept);
+}
+
+/** Make `result` a vector of type T that holds the rows of the chunk. */
+template <typename T>
+inline void PrepareResult(const DataChunk &chunk, Vector *result) {
+  if (result->GetType() != TypeOf<T>() || result->IsConstant() || result->GetCapacity() < chunk.GetCapacity()) {
+    *result = Vector(TypeOf<T>(), sizeof(T), chunk.GetCapacity());
+  }
+}
+
+/** Compute `value(row)` (and its NULL flag `is_null(row)`) for the selected rows of a chunk. */
+template <typename T, typename F, typename N>
+inline void Compute(const DataChunk &chunk, Vector *result, F &&value, N &&is_null) {
+  PrepareResult<T>(chunk, result);
+  T *out = result->GetData<T>();
+  uint8_t *out_nulls = result->GetNulls();
+  const SelectionVector &selection = chunk.GetSelection();
+  if (selection.IsIdentity()) {
+    for (uint32_t row = 0; row < selection.GetCount(); row++) {
+      out[row] = value(row);
+      out_nulls[row] = is_null(row);
+    }
+    return;
+  }
+  for (size_t i = 0; i < selection.GetCount(); i++) {
+    uint32_t row = selection[i];
+    out[row] = value(row);
+    out_nulls[row] = is_null(row);
+  }
+}
+
+template <typename T0, typename T1>
+void CompareAndCompare(const FusedArgs &args, const DataChunk &chunk, SelectionVector *selection) {
+  const Vector &column0 = chunk.GetColumn(args.col_idxs_[0]);
+  const Vector &column1 = chunk.GetColumn(args.col_idxs_[1]);
+  const T0 *data0 = column0.GetData<T0>();
+  const T1 *data1 = column1.GetData<T1>();
+  const uint8_t *nulls0 = column0.GetNulls();
+  const uint8_t *nulls1 = column1.GetNulls();
+  auto predicate0 = ColumnPredicate<T0>::Compare(args.comparison_types_[0], ConstantAs<T0>(args.constants_[0]));
+  auto predicate1 = ColumnPredicate<T1>::Compare(args.comparison_types_[1], ConstantAs<T1>(args.constants_[1]));
+  if (!selection->IsIdentity()) {
+    uint32_t *rows = selection->GetData();
+    size_t kept = SelectRows(predicate0, data0, nulls0, rows, selection->GetCount(), rows);
+    selection->SetCount(SelectRows(predicate1, data1, nulls1, rows, kept, rows));
+    return;
+  }
+  SelectDense(selection, [&](size_t begin, size_t n, uint64_t *bitmap) {
+    uint64_t bitmap1[FUSED_BLOCK / 64];
+    SelectBitmap(predicate0, data0 + begin, nulls0 + begin, n, bitmap);
+    SelectBitmap(predicate1, data1 + begin, nulls1 + begin, n, bitmap1);
+    for (size_t w = 0; w < (n + 63) / 64; w++) {
+      bitmap[w] &= bitmap1[w];
+    }
+  });
+}
+
+template <typename T0, typename T1, ArithmeticType ARITH, ComparisonType OP>
+void ArithmeticCompare(const FusedArgs &args, const DataChunk &chunk, SelectionVector *selection) {
+  using R = ArithmeticResult<T0, T1>;
+  const Vector &column0 = chunk.GetColumn(args.col_idxs_[0]);
+  const Vector &column1 = chunk.GetColumn(args.col_idxs_[1]);
+  const T0 *data0 = column0.GetData<T0>();
+  const T1 *data1 = column1.GetData<T1>();
+  const uint8_t *nulls0 = column0.GetNulls();
+  const uint8_t *nulls1 = column1.GetNulls();
+  R constant = ConstantAs<R>(args.constants_[0]);
+  if (!selection->IsIdentity()) {
+    Refine(selection, [&](uint32_t row) -> uint8_t {
+      R value = Compute<ARITH>(static_cast<R>(data0[row]), static_cast<R>(data1[row]));
+      return static_cast<uint8_t>((nulls0[row] | nulls1[row]) == 0) & Compare<OP>(value, constant);
+    });
+    return;
+  }
+  // the values of a block are computed by a loop the compiler vectorizes, then compared by the SIMD kernels
+  auto predicate = ColumnPredicate<R>::Compare(OP, constant);
+  SelectDense(selection, [&](size_t begin, size_t n, uint64_t *bitmap) {
+    R values[FUSED_BLOCK];
+    uint8_t nulls[FUSED_BLOCK];
+    for (size_t i = 0; i < n; i++) {
+      values[i] = Compute<ARITH>(static_cast<R>(data0[begin + i]), static_cast<R>(data1[begin + i]));
+      nulls[i] = nulls0[begin + i] | nulls1[begin + i];
+    }
+    SelectBitmap(predicate, values, nulls, n, bitmap);
+  });
+}
+
+template <typename T0, typename T1, ArithmeticType ARITH>
+void ArithmeticColumns(const FusedArgs &args, const DataChunk &chunk, Vector *result) {
+  using R = ArithmeticResult<T0, T1>;
+  const Vector &column0 = chunk.GetColumn(args.col_idxs_[0]);
+  const Vector &column1 = chunk.GetColumn(args.col_idxs_[1]);
+  const T0 *data0 = column0.GetData<T0>();
+  const T1 *data1 = column1.GetData<T1>();
+  const uint8_t *nulls0 = column0.GetNulls();
+  const uint8_t *nulls1 = column1.GetNulls();
+  Compute<R>(
+      chunk, result,
+      [&](uint32_t row) { return Compute<ARITH>(static_cast<R>(data0[row]), static_cast<R>(data1[row])); },
+      [&](uint32_t row) { return static_cast<uint8_t>(nulls0[row] | nulls1[row]); });
+}
+
+/** `col <arith> const`, or `const <arith> col` with CONSTANT_LEFT; R is the type of the constant and the result. */
+template <typename T, typename R, ArithmeticType ARITH, bool CONSTANT_LEFT>
+void ArithmeticConstant(const FusedArgs &args, const DataChunk &chunk, Vector *result) {
+  const Vector &column = chunk.GetColumn(args.col_idxs_[0]);
+  const T *data = column.GetData<T>();
+  const uint8_t *nulls = column.GetNulls();
+  R constant = ConstantAs<R>(args.constants_[0]);
+  Compute<R>(
+      chunk, result,
+      [&](uint32_t row) {
+        return CONSTANT_LEFT ? Compute<ARITH>(constant, static_cast<R>(data[row]))
+                             : Compute<ARITH>(static_cast<R>(data[row]), constant);
+      },
+      [&](uint32_t row) { return nulls[row]; });
+}
+
+auto MakeKey(FusedShape shape, TypeId type0, TypeId type1, int op0, int op1, bool flag = false) -> uint64_t {
+  return static_cast<uint64_t>(shape) | static_cast<uint64_t>(type0) << 8 | static_cast<uint64_t>(type1) << 16 |
+         static_cast<uint64_t>(op0) << 24 | static_cast<uint64_t>(op1) << 32 | static_cast<uint64_t>(flag) << 40;
+}
+
+template <typename F>
+void ForEachType(F &&f) {
+  f(int32_t{});
+  f(int64_t{});
+  f(double{});
+}
+
+template <typename F>
+void ForEachComparison(F &&f) {
+  f(std::integral_constant<ComparisonType, ComparisonType::EQUAL>{});
+  f(std::integral_constant<ComparisonType, ComparisonType::NOT_EQUAL>{});
+  f(std::integral_constant<ComparisonType, ComparisonType::LESS_THAN>{});
+  f(std::integral_constant<ComparisonType, ComparisonType::LESS_EQUAL>{});
+  f(std::integral_constant<ComparisonType, ComparisonType::GREATER_THAN>{});
+  f(std::integral_constant<ComparisonType, ComparisonType::GREATER_EQUAL>{});
+}
+
+template <typename F>
+void ForEachArithmetic(F &&f) {
+  f(std::integral_constant<ArithmeticType, ArithmeticType::PLUS>{});
+  f(std::integral_constant<ArithmeticType, ArithmeticType::MINUS>{});
+  f(std::integral_constant<ArithmeticType, ArithmeticType::MULTIPLY>{});
+}
+
+/** Every kernel of every shape, instantiated when redbase is built and keyed by MakeKey(). */
+struct Registry {
+  std::unordered_map<uint64_t, FusedPredicateFn> predicates_;
+  std::unordered_map<uint64_t, FusedValueFn> values_;
+};
+
+auto BuildRegistry() -> Registry {
+  Registry registry;
+  ForEachType([&](auto t0) {
+    using T0 = decltype(t0);
+    ForEachType([&](auto t1) {
+      using T1 = decltype(t1);
+      registry.predicates_[MakeKey(FusedShape::COMPARE_AND_COMPARE, TypeOf<T0>(), TypeOf<T1>(), 0, 0)] =
+          &CompareAndCompare<T0, T1>;
+      ForEachArithmetic([&](auto arith) {
+        registry.values_[MakeKey(FusedShape::ARITHMETIC_COLUMNS, TypeOf<T0>(), TypeOf<T1>(),
+                                 static_cast<int>(arith.value), 0)] = &ArithmeticColumns<T0, T1, arith.value>;
+        ForEachComparison([&](auto op) {
+          registry.predicates_[MakeKey(FusedShape::ARITHMETIC_COMPARE, TypeOf<T0>(), TypeOf<T1>(),
+                                       static_cast<int>(arith.value), static_cast<int>(op.value))] =
+              &ArithmeticCompare<T0, T1, arith.value, op.value>;
+        });
+        // T1 is the type of the result here, which the constant is carried in
+        using R = ArithmeticResult<T0, T1>;
+        if constexpr (std::is_same_v<T1, R>) {
+          registry.values_[MakeKey(FusedShape::ARITHMETIC_CONSTANT, TypeOf<T0>(), TypeOf<T1>(),
+                                   static_cast<int>(arith.value), 0, false)] =
+              &ArithmeticConstant<T0, R, arith.value, false>;
+          registry.values_[MakeKey(FusedShape::ARITHMETIC_CONSTANT, TypeOf<T0>(), TypeOf<T1>(),
+                                   static_cast<int>(arith.value), 0, true)] =
+              &ArithmeticConstant<T0, R, arith.value, true>;
+        }
+      });
+    });
+  });
+  return registry;
+}
+
+auto GetRegistry() -> const Registry & {
+  static const Registry REGISTRY = BuildRegistry();
+  return REGISTRY;
+}
+
+template <typename Fn>
+auto Lookup(const std::unordered_map<uint64_t, Fn> &kernels, uint64_t key) -> Fn {
+  auto it = kernels.find(key);
+  return it == kernels.end() ? nullptr : it->second;
+}
+
+/** @return true if the columns of the chunk are in the form the kernel was instantiated for */
+auto ColumnsMatch(const FusedArgs &args, const std::array<TypeId, 2> &column_types, const DataChunk &chunk) -> bool {
+  for (size_t i = 0; i < column_types.size(); i++) {
+    if (column_types[i] == TypeId::INVALID) {
+      continue;
+    }
+    const Vector &column = chunk.GetColumn(args.col_idxs_[i]);
+    if (column.IsConstant() || StorageType(column.GetType()) != column_types[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto AsColumn(const ExpressionRef &expression) -> const ColumnRefExpression * {
+  const auto *column = dynamic_cast<const ColumnRefExpression *>(expression.get());
+  return column != nullptr && IsNumeric(column->GetReturnType()) ? column : nullptr;
+}
+
+auto AsConstant(const ExpressionRef &expression) -> const ConstantExpression * {
+  const auto *constant = dynamic_cast<const ConstantExpression *>(expression.get());
+  return constant != nullptr && !constant->GetValue().IsNull() ? constant : nullptr;
+}
+
+/** A comparison put in the order `column <op> constant`. */
+struct ColumnComparison {
+  const ColumnRefExpression *column_;
+  ComparisonType comparison_type_;
+  Value constant_;
+};
+
+/** @return the comparison of a column with a constant the column type holds exactly, nullopt for other predicates */
+auto MatchColumnComparison(const ExpressionRef &expression) -> std::optional<ColumnComparison> {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expression.get());
+  if (comparison == nullptr) {
+    return std::nullopt;
+  }
+  const auto &children = comparison->GetChildren();
+  for (int left = 0; left < 2; left++) {
+    const auto *column = AsColumn(children[left]);
+    const auto *constant = AsConstant(children[1 - left]);
+    if (column != nullptr && constant != nullptr && Fits(column->GetReturnType(), constant->GetValue())) {
+      ComparisonType comparison_type = comparison->GetComparisonType();
+      return ColumnComparison{column, left == 0 ? comparison_type : FlipComparison(comparison_type),
+                              constant->GetValue()};
+    }
+  }
+  return std::nullopt;
+}
+
+auto FuseComparisons(const ColumnComparison &first, const ColumnComparison &second, ExpressionRef interpreted)
+    -> ExpressionRef {
+  std::array<TypeId, 2> types = {StorageType(first.column_->GetReturnType()),
+                                 StorageType(second.column_->GetReturnType())};
+  auto fn = Lookup(GetRegistry().predicates_, MakeKey(FusedShape::COMPARE_AND_COMPARE, types[0], types[1], 0, 0));
+  if (fn == nullptr) {
+    return interpreted;
+  }
+  FusedArgs args{{first.column_->GetColIdx(), second.column_->GetColIdx()},
+                 {first.constant_, second.constant_},
+                 {first.comparison_type_, second.comparison_type_}};
+  return std::make_shared<FusedPredicateExpression>(fn, args, types, std::move(interpreted));
+}
+
+auto CompileConjunction(const ConjunctionExpression &conjunction) -> ExpressionRef {
+  std::vector<ExpressionRef> children;
+  // a column comparison still waiting for a partner, and its index into children
+  std::optional<ColumnComparison> pending;
+  size_t pending_idx = 0;
+  for (const auto &child : conjunction.GetChildren()) {
+    auto comparison = MatchColumnComparison(child);
+    if (!comparison.has_value()) {
+      children.push_back(CompileExpression(child));
+      continue;
+    }
+    if (!pending.has_value()) {
+      pending = comparison;
+      pending_idx = children.size();
+      children.push_back(child);
+      continue;
+    }
+    auto interpreted =
+        std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{children[pending_idx], child});
+    children[pending_idx] = FuseComparisons(*pending, *comparison, interpreted);
+    pending.reset();
+  }
+  return children.size() == 1 ? children[0] : std::make_shared<ConjunctionExpression>(std::move(children));
+}
+
+auto CompileComparison(const ExpressionRef &expression, const ComparisonExpression &comparison) -> ExpressionRef {
+  const auto &children = comparison.GetChildren();
+  // (col <arith> col) <op> const, in either order
+  for (int left = 0; left < 2; left++) {
+    const auto *arithmetic = dynamic_cast<const ArithmeticExpression *>(children[left].get());
+    const auto *constant = AsConstant(children[1 - left]);
+    if (arithmetic == nullptr || constant == nullptr) {
+      continue;
+    }
+    const auto *column0 = AsColumn(arithmetic->GetChildren()[0]);
+    const auto *column1 = AsColumn(arithmetic->GetChildren()[1]);
+    if (column0 == nullptr || column1 == nullptr || !Fits(arithmetic->GetReturnType(), constant->GetValue())) {
+      continue;
+    }
+    std::array<TypeId, 2> types = {StorageType(column0->GetReturnType()), StorageType(column1->GetReturnType())};
+    ComparisonType comparison_type =
+        left == 0 ? comparison.GetComparisonType() : FlipComparison(comparison.GetComparisonType());
+    auto fn = Lookup(GetRegistry().predicates_,
+                     MakeKey(FusedShape::ARITHMETIC_COMPARE, types[0], types[1],
+                             static_cast<int>(arithmetic->GetArithmeticType()), static_cast<int>(comparison_type)));
+    if (fn != nullptr) {
+      FusedArgs args{{column0->GetColIdx(), column1->GetColIdx()}, {constant->GetValue(), Value()}};
+      return std::make_shared<FusedPredicateExpression>(fn, args, types, expression);
+    }
+  }
+  auto compiled_left = CompileExpression(children[0]);
+  auto compiled_right = CompileExpression(children[1]);
+  if (compiled_left == children[0] && compiled_right == children[1]) {
+    return expression;
+  }
+  return std::make_shared<ComparisonExpression>(comparison.GetComparisonType(), compiled_left, compiled_right);
+}
+
+auto CompileArithmetic(const ExpressionRef &expression, const ArithmeticExpression &arithmetic) -> ExpressionRef {
+  const auto &children = arithmetic.GetChildren();
+  auto arith = static_cast<int>(arithmetic.GetArithmeticType());
+  const auto *column0 = AsColumn(children[0]);
+  const auto *column1 = AsColumn(children[1]);
+  if (column0 != nullptr && column1 != nullptr) {
+    std::array<TypeId, 2> types = {StorageType(column0->GetReturnType()), StorageType(column1->GetReturnType())};
+    auto fn = Lookup(GetRegistry().values_, MakeKey(FusedShape::ARITHMETIC_COLUMNS, types[0], types[1], arith, 0));
+    if (fn != nullptr) {
+      FusedArgs args{{column0->GetColIdx(), column1->GetColIdx()}, {}};
+      return std::make_shared<FusedValueExpression>(fn, args, types, expression);
+    }
+  }
+  for (int left = 0; left < 2; left++) {
+    const auto *column = AsColumn(children[1 - left]);
+    const auto *constant = AsConstant(children[left]);
+    if (column == nullptr || constant == nullptr) {
+      continue;
+    }
+    // the constant is carried in the type of the result
+    TypeId result_type = arithmetic.GetReturnType();
+    TypeId column_type = StorageType(column->GetReturnType());
+    auto fn = Lookup(GetRegistry().values_,
+                     MakeKey(FusedShape::ARITHMETIC_CONSTANT, column_type, result_type, arith, 0, left == 0));
+    if (fn != nullptr && Fits(result_type, constant->GetValue())) {
+      FusedArgs args{{column->GetColIdx(), 0}, {constant->GetValue(), Value()}};
+      return std::make_shared<FusedValueExpression>(
+          fn, args, std::array<TypeId, 2>{column_type, TypeId::INVALID}, expression);
+    }
+  }
+  auto compiled_left = CompileExpression(children[0]);
+  auto compiled_right = CompileExpression(children[1]);
+  if (compiled_left == children[0] && compiled_right == children[1]) {
+    return expression;
+  }
+  return std::make_shared<ArithmeticExpression>(arithmetic.GetArithmeticType(), compiled_left, compiled_right);
+}
+
+}  // namespace
+
+void FusedPredicateExpression::Select(const DataChunk &chunk, SelectionVector *selection) const {
+  if (!ColumnsMatch(args_, column_types_, chunk)) {
+    interpreted_->Select(chunk, selection);
+    return;
+  }
+  fn_(args_, chunk, selection);
+}
+
+void FusedValueExpression::Evaluate(const DataChunk &chunk, Vector *result) const {
+  if (!ColumnsMatch(args_, column_types_, chunk)) {
+    interpreted_->Evaluate(chunk, result);
+    return;
+  }
+  fn_(args_, chunk, result);
+}
+
+auto CompileExpression(const ExpressionRef &expression) -> ExpressionRef {
+  if (const auto *conjunction = dynamic_cast<const ConjunctionExpression *>(expression.get())) {
+    return CompileConjunction(*conjunction);
+  }
+  if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(expression.get())) {
+    return CompileComparison(expression, *comparison);
+  }
+  if (const auto *arithmetic = dynamic_cast<const ArithmeticExpression *>(expression.get())) {
+    return CompileArithmetic(expression, *arithmetic);
+  }
+  return expression;
+}
+
+auto FusedKernelCount(FusedShape shape) -> size_t {
+  const Registry &registry = GetRegistry();
+  auto count_shape = [shape](const auto &entry) { return (entry.first & 0xff) == static_cast<uint64_t>(shape); };
+  return std::count_if(registry.predicates_.begin(), registry.predicates_.end(), count_shape) +
+         std::count_if(registry.values_.begin(), registry.values_.end(), count_shape);
+}
+
+}  // namespace redbase
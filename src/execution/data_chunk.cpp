@@ -0,0 +1,103 @@
+#include "execution/data_chunk.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+Vector::Vector(TypeId type_id, uint32_t width, size_t capacity)
+    : type_id_(type_id),
+      width_(width),
+      capacity_(capacity),
+      data_(std::make_shared<std::vector<char>>(width * capacity)),
+      nulls_(std::make_shared<std::vector<uint8_t>>(capacity)) {}
+
+auto Vector::MakeConstant(const Value &value) -> Vector {
+  if (!IsNumeric(value.GetTypeId())) {
+    throw Exception("a constant vector needs a numeric value");
+  }
+  Vector vector(value.GetTypeId(), TypeSize(value.GetTypeId()), 1);
+  vector.SetValue(0, value);
+  vector.is_constant_ = true;
+  return vector;
+}
+
+auto Vector::GetValue(size_t row) const -> Value {
+  if (is_constant_) {
+    row = 0;
+  }
+  if (IsNull(row)) {
+    return Value::MakeNull(type_id_);
+  }
+  switch (type_id_) {
+    case TypeId::INTEGER:
+    case TypeId::DATE:
+      return {type_id_, GetData<int32_t>()[row]};
+    case TypeId::BIGINT:
+      return {type_id_, GetData<int64_t>()[row]};
+    case TypeId::DOUBLE:
+      return Value(GetData<double>()[row]);
+    default:
+      throw Exception(fmt::format("vector of type {} is not numeric", static_cast<int>(type_id_)));
+  }
+}
+
+void Vector::SetValue(size_t row, const Value &value) {
+  (*nulls_)[row] = value.IsNull() ? 1 : 0;
+  if (value.IsNull()) {
+    return;
+  }
+  switch (type_id_) {
+    case TypeId::INTEGER:
+    case TypeId::DATE:
+      GetData<int32_t>()[row] = static_cast<int32_t>(value.GetAsInteger());
+      break;
+    case TypeId::BIGINT:
+      GetData<int64_t>()[row] = value.GetAsInteger();
+      break;
+    case TypeId::DOUBLE:
+      GetData<double>()[row] = value.GetAsDouble();
+      break;
+    default:
+      throw Exception(fmt::format("vector of type {} is not numeric", static_cast<int>(type_id_)));
+  }
+}
+
+void Vector::Reference(const Vector &other) { *this = other; }
+
+void SelectionVector::SetIdentity(size_t count) {
+  std::iota(indexes_.begin(), indexes_.begin() + count, 0);
+  count_ = count;
+  is_identity_ = true;
+}
+
+void SelectionVector::Assign(const SelectionVector &other) {
+  std::copy(other.indexes_.begin(), other.indexes_.begin() + other.count_, indexes_.begin());
+  count_ = other.count_;
+  is_identity_ = other.is_identity_;
+}
+
+void DataChunk::Initialize(const Schema &schema, size_t capacity) {
+  columns_.clear();
+  for (const auto &column : schema.GetColumns()) {
+    columns_.emplace_back(column.GetType(), column.GetLength(), capacity);
+  }
+  capacity_ = capacity;
+  size_ = 0;
+  selection_ = SelectionVector(capacity);
+}
+
+void DataChunk::SetSize(size_t size) {
+  size_ = size;
+  selection_.SetIdentity(size);
+}
+
+void DataChunk::SetSize(size_t size, const SelectionVector &selection) {
+  size_ = size;
+  selection_.Assign(selection);
+}
+
+}  // namespace redbase
@@ -0,0 +1,293 @@
+#include "execution/expression.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+/** Call `f` with a value of the C++ type that stores a vector of the given type. */
+template <typename F>
+void DispatchNumeric(TypeId type_id, F &&f) {
+  switch (type_id) {
+    case TypeId::INTEGER:
+    case TypeId::DATE:
+      f(int32_t{});
+      break;
+    case TypeId::BIGINT:
+      f(int64_t{});
+      break;
+    case TypeId::DOUBLE:
+      f(double{});
+      break;
+    default:
+      throw Exception(fmt::format("type {} is not numeric", static_cast<int>(type_id)));
+  }
+}
+
+/** Call `f` with the function object of a comparison. */
+template <typename F>
+void DispatchComparison(ComparisonType comparison_type, F &&f) {
+  switch (comparison_type) {
+    case ComparisonType::EQUAL:
+      f(std::equal_to<>{});
+      break;
+    case ComparisonType::NOT_EQUAL:
+      f(std::not_equal_to<>{});
+      break;
+    case ComparisonType::LESS_THAN:
+      f(std::less<>{});
+      break;
+    case ComparisonType::LESS_EQUAL:
+      f(std::less_equal<>{});
+      break;
+    case ComparisonType::GREATER_THAN:
+      f(std::greater<>{});
+      break;
+    case ComparisonType::GREATER_EQUAL:
+      f(std::greater_equal<>{});
+      break;
+  }
+}
+
+/**
+ * Keep the selected rows for which `op(left, right)` holds. The loop is branch free: every row is written to the
+ * output, which only advances past the rows kept. The output may be the input, a row is never written ahead of the
+ * rows read.
+ */
+template <typename L, typename R, typename Op>
+auto SelectLoop(const Vector &left, const Vector &right, const uint32_t *selection, size_t count, uint32_t *out)
+    -> size_t {
+  using T = std::common_type_t<L, R>;
+  const L *left_data = left.GetData<L>();
+  const R *right_data = right.GetData<R>();
+  const uint8_t *left_nulls = left.GetNulls();
+  const uint8_t *right_nulls = right.GetNulls();
+  // a constant stands for every row, it is always read at index 0
+  size_t left_step = left.IsConstant() ? 0 : 1;
+  size_t right_step = right.IsConstant() ? 0 : 1;
+  Op op;
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t row = selection[i];
+    size_t l = row * left_step;
+    size_t r = row * right_step;
+    bool keep = (left_nulls[l] | right_nulls[r]) == 0 &&
+                op(static_cast<T>(left_data[l]), static_cast<T>(right_data[r]));
+    out[kept] = row;
+    kept += keep ? 1 : 0;
+  }
+  return kept;
+}
+
+template <typename T, typename L, typename R, typename Op>
+void ArithmeticLoop(const Vector &left, const Vector &right, const SelectionVector &selection, Vector *result) {
+  const L *left_data = left.GetData<L>();
+  const R *right_data = right.GetData<R>();
+  const uint8_t *left_nulls = left.GetNulls();
+  const uint8_t *right_nulls = right.GetNulls();
+  size_t left_step = left.IsConstant() ? 0 : 1;
+  size_t right_step = right.IsConstant() ? 0 : 1;
+  T *out = result->GetData<T>();
+  uint8_t *out_nulls = result->GetNulls();
+  Op op;
+  for (size_t i = 0; i < selection.GetCount(); i++) {
+    uint32_t row = selection[i];
+    size_t l = row * left_step;
+    size_t r = row * right_step;
+    out_nulls[row] = left_nulls[l] | right_nulls[r];
+    out[row] = op(static_cast<T>(left_data[l]), static_cast<T>(right_data[r]));
+  }
+}
+
+/**
+ * @brief Refine a selection by a predicate on a column with the kernels of SelectRows().
+ * @param make_predicate `auto make_predicate(T) -> std::optional<ColumnPredicate<T>>` for the C++ type T of the
+ * column, nullopt if the predicate cannot be expressed on a T
+ * @return false if make_predicate returned nullopt, the selection is untouched
+ */
+template <typename F>
+auto SelectColumn(const Vector &column, SelectionVector *selection, F &&make_predicate) -> bool {
+  bool done = false;
+  DispatchNumeric(column.GetType(), [&](auto t) {
+    using T = decltype(t);
+    std::optional<ColumnPredicate<T>> predicate = make_predicate(t);
+    if (!predicate.has_value()) {
+      return;
+    }
+    uint32_t *rows = selection->GetData();
+    size_t kept = SelectRows(*predicate, column.GetData<T>(), column.GetNulls(),
+                             selection->IsIdentity() ? nullptr : rows, selection->GetCount(), rows);
+    selection->SetCount(kept);
+    done = true;
+  });
+  return done;
+}
+
+/** Refine a selection a Value at a time, the path of the predicates the kernels cannot take. */
+template <typename F>
+void SelectValues(const Vector &vector, SelectionVector *selection, F &&test) {
+  uint32_t *rows = selection->GetData();
+  size_t kept = 0;
+  for (size_t i = 0; i < selection->GetCount(); i++) {
+    uint32_t row = rows[i];
+    Value value = vector.GetValue(row);
+    bool keep = !value.IsNull() && test(value);
+    rows[kept] = row;
+    kept += keep ? 1 : 0;
+  }
+  selection->SetCount(kept);
+}
+
+}  // namespace
+
+void Expression::Evaluate(const DataChunk &chunk, Vector *result) const {
+  throw Exception("a predicate has no value, use Select()");
+}
+
+void Expression::Select(const DataChunk &chunk, SelectionVector *selection) const {
+  throw Exception("a value expression is not a predicate, use Evaluate()");
+}
+
+void ColumnRefExpression::Evaluate(const DataChunk &chunk, Vector *result) const {
+  result->Reference(chunk.GetColumn(col_idx_));
+}
+
+void ConstantExpression::Evaluate(const DataChunk &chunk, Vector *result) const { result->Reference(vector_); }
+
+void ComparisonExpression::Select(const DataChunk &chunk, SelectionVector *selection) const {
+  Vector left;
+  Vector right;
+  GetChildren()[0]->Evaluate(chunk, &left);
+  GetChildren()[1]->Evaluate(chunk, &right);
+  if (left.IsConstant() != right.IsConstant()) {
+    // a column against a constant, put in the order column <op> constant
+    const Vector &column = left.IsConstant() ? right : left;
+    Value constant = (left.IsConstant() ? left : right).GetValue(0);
+    ComparisonType comparison_type = left.IsConstant() ? FlipComparison(comparison_type_) : comparison_type_;
+    if (constant.IsNull()) {
+      selection->SetCount(0);
+      return;
+    }
+    if (SelectColumn(column, selection, [&](auto t) -> std::optional<ColumnPredicate<decltype(t)>> {
+          auto value = ExactAs<decltype(t)>(constant);
+          if (!value.has_value()) {
+            return std::nullopt;
+          }
+          return ColumnPredicate<decltype(t)>::Compare(comparison_type, *value);
+        })) {
+      return;
+    }
+  }
+  size_t kept = 0;
+  DispatchNumeric(left.GetType(), [&](auto l) {
+    DispatchNumeric(right.GetType(), [&](auto r) {
+      DispatchComparison(comparison_type_, [&](auto op) {
+        kept = SelectLoop<decltype(l), decltype(r), decltype(op)>(left, right, selection->GetData(),
+                                                                  selection->GetCount(), selection->GetData());
+      });
+    });
+  });
+  selection->SetCount(kept);
+}
+
+void ConjunctionExpression::Select(const DataChunk &chunk, SelectionVector *selection) const {
+  for (const auto &child : GetChildren()) {
+    if (selection->GetCount() == 0) {
+      return;
+    }
+    child->Select(chunk, selection);
+  }
+}
+
+void BetweenExpression::Select(const DataChunk &chunk, SelectionVector *selection) const {
+  if (low_.IsNull() || high_.IsNull()) {
+    selection->SetCount(0);
+    return;
+  }
+  Vector child;
+  GetChildren()[0]->Evaluate(chunk, &child);
+  if (!child.IsConstant() &&
+      SelectColumn(child, selection, [&](auto t) -> std::optional<ColumnPredicate<decltype(t)>> {
+        auto low = ExactAs<decltype(t)>(low_);
+        auto high = ExactAs<decltype(t)>(high_);
+        if (!low.has_value() || !high.has_value()) {
+          return std::nullopt;
+        }
+        return ColumnPredicate<decltype(t)>::Between(*low, *high);
+      })) {
+    return;
+  }
+  SelectValues(child, selection,
+               [&](const Value &value) { return value.CompareTo(low_) >= 0 && value.CompareTo(high_) <= 0; });
+}
+
+void InListExpression::Select(const DataChunk &chunk, SelectionVector *selection) const {
+  std::vector<Value> list;
+  std::copy_if(list_.begin(), list_.end(), std::back_inserter(list),
+               [](const Value &value) { return !value.IsNull(); });
+  Vector child;
+  GetChildren()[0]->Evaluate(chunk, &child);
+  if (!child.IsConstant() &&
+      SelectColumn(child, selection, [&](auto t) -> std::optional<ColumnPredicate<decltype(t)>> {
+        std::vector<decltype(t)> values;
+        for (const auto &value : list) {
+          auto exact = ExactAs<decltype(t)>(value);
+          if (!exact.has_value()) {
+            return std::nullopt;
+          }
+          values.push_back(*exact);
+        }
+        return ColumnPredicate<decltype(t)>::In(std::move(values));
+      })) {
+    return;
+  }
+  SelectValues(child, selection, [&](const Value &value) {
+    return std::any_of(list.begin(), list.end(), [&](const Value &item) { return value.CompareTo(item) == 0; });
+  });
+}
+
+ArithmeticExpression::ArithmeticExpression(ArithmeticType arithmetic_type, ExpressionRef left, ExpressionRef right)
+    : Expression(left->GetReturnType() == TypeId::DOUBLE || right->GetReturnType() == TypeId::DOUBLE ? TypeId::DOUBLE
+                                                                                                       : TypeId::BIGINT,
+                 {left, right}),
+      arithmetic_type_(arithmetic_type) {}
+
+void ArithmeticExpression::Evaluate(const DataChunk &chunk, Vector *result) const {
+  Vector left;
+  Vector right;
+  GetChildren()[0]->Evaluate(chunk, &left);
+  GetChildren()[1]->Evaluate(chunk, &right);
+  TypeId type_id = GetReturnType();
+  if (result->GetType() != type_id || result->IsConstant() || result->GetCapacity() < chunk.GetCapacity()) {
+    *result = Vector(type_id, TypeSize(type_id), chunk.GetCapacity());
+  }
+  DispatchNumeric(type_id, [&](auto t) {
+    using T = decltype(t);
+    DispatchNumeric(left.GetType(), [&](auto l) {
+      DispatchNumeric(right.GetType(), [&](auto r) {
+        using L = decltype(l);
+        using R = decltype(r);
+        switch (arithmetic_type_) {
+          case ArithmeticType::PLUS:
+            ArithmeticLoop<T, L, R, std::plus<>>(left, right, chunk.GetSelection(), result);
+            break;
+          case ArithmeticType::MINUS:
+            ArithmeticLoop<T, L, R, std::minus<>>(left, right, chunk.GetSelection(), result);
+            break;
+          case ArithmeticType::MULTIPLY:
+            ArithmeticLoop<T, L, R, std::multiplies<>>(left, right, chunk.GetSelection(), result);
+            break;
+        }
+      });
+    });
+  });
+}
+
+}  // namespace redbase
@@ -0,0 +1,44 @@
+#include "execution/filter_operator.h"
+
+#include "execution/compiled_expression.h"
+#include "execution/seq_scan_operator.h"
+
+namespace redbase {
+
+FilterOperator::FilterOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, ExpressionRef predicate)
+    : Operator(ctx, child->GetOutputSchema()), child_(std::move(child)), predicate_(std::move(predicate)) {
+  auto *scan = dynamic_cast<SeqScanOperator *>(child_.get());
+  if (ctx_->push_down_predicates_ && scan != nullptr && predicate_ != nullptr) {
+    predicate_ = scan->PushDown(predicate_);
+  }
+  if (ctx_->compile_expressions_ && predicate_ != nullptr) {
+    predicate_ = CompileExpression(predicate_);
+  }
+}
+
+void FilterOperator::Init() { child_->Init(); }
+
+auto FilterOperator::MakeWorker() -> std::unique_ptr<Operator> {
+  auto child = child_->MakeWorker();
+  if (child == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<FilterOperator>(ctx_, std::move(child), predicate_);
+}
+
+void FilterOperator::InitMorsel(size_t morsel_idx) { child_->InitMorsel(morsel_idx); }
+
+auto FilterOperator::Next(DataChunk *chunk) -> bool {
+  while (child_->Next(chunk)) {
+    if (predicate_ == nullptr) {
+      return true;
+    }
+    predicate_->Select(*chunk, &chunk->GetSelection());
+    if (chunk->GetSelectedCount() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace redbase
@@ -0,0 +1,605 @@
+#include "execution/hash_aggregate_operator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "common/util/hash_util.h"
+#include "execution/parallel_consume.h"
+#include "fmt/format.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+namespace {
+
+/** Spill pages start with the number of state rows they hold. */
+constexpr size_t SPILL_PAGE_HEADER_SIZE = 8;
+
+/** Bytes of the arena blocks state rows are carved from. */
+constexpr size_t ARENA_BLOCK_SIZE = 64 << 10;
+
+/** Bytes of the state of an aggregate: its value (an int64_t or a double) and the number of values it is made of. */
+constexpr uint32_t STATE_SIZE = 16;
+
+auto OutputType(AggregateType type, TypeId input_type) -> TypeId {
+  switch (type) {
+    case AggregateType::COUNT_STAR:
+    case AggregateType::COUNT:
+      return TypeId::BIGINT;
+    case AggregateType::SUM:
+      return input_type == TypeId::DOUBLE ? TypeId::DOUBLE : TypeId::BIGINT;
+    case AggregateType::AVG:
+      return TypeId::DOUBLE;
+    default:
+      return input_type;
+  }
+}
+
+auto AggregateName(AggregateType type) -> const char * {
+  switch (type) {
+    case AggregateType::COUNT_STAR:
+    case AggregateType::COUNT:
+      return "count";
+    case AggregateType::SUM:
+      return "sum";
+    case AggregateType::MIN:
+      return "min";
+    case AggregateType::MAX:
+      return "max";
+    default:
+      return "avg";
+  }
+}
+
+/** Integer sums wrap around rather than overflow. */
+template <typename T>
+inline auto Add(T lhs, T rhs) -> T {
+  if constexpr (std::is_integral_v<T>) {
+    return static_cast<T>(static_cast<uint64_t>(lhs) + static_cast<uint64_t>(rhs));
+  } else {
+    return lhs + rhs;
+  }
+}
+
+/** Fold a value into the state of an aggregate; `first` if the state holds no value yet. */
+template <AggregateType TYPE, typename Acc>
+inline auto Fold(Acc acc, Acc value, bool first) -> Acc {
+  if constexpr (TYPE == AggregateType::SUM || TYPE == AggregateType::AVG) {
+    return Add(acc, value);
+  } else if constexpr (TYPE == AggregateType::MIN) {
+    return first || value < acc ? value : acc;
+  } else if constexpr (TYPE == AggregateType::MAX) {
+    return first || value > acc ? value : acc;
+  } else {
+    return acc;
+  }
+}
+
+/** Update the states at `offset` of the rows `states` with the selected rows of a column, NULLs skipped. */
+template <AggregateType TYPE, typename In, typename Acc>
+void UpdateStates(char *const *states, uint32_t offset, const Vector &column, const SelectionVector &selection) {
+  const auto *data = column.GetData<In>();
+  const uint8_t *nulls = column.GetNulls();
+  size_t step = column.IsConstant() ? 0 : 1;
+  for (size_t i = 0; i < selection.GetCount(); i++) {
+    size_t idx = selection[i] * step;
+    if (nulls[idx] != 0) {
+      continue;
+    }
+    char *state = states[i] + offset;
+    Acc acc;
+    int64_t count;
+    memcpy(&acc, state, sizeof(Acc));
+    memcpy(&count, state + 8, sizeof(count));
+    acc = Fold<TYPE, Acc>(acc, static_cast<Acc>(data[idx]), count == 0);
+    count++;
+    memcpy(state, &acc, sizeof(Acc));
+    memcpy(state + 8, &count, sizeof(count));
+  }
+}
+
+template <AggregateType TYPE>
+void UpdateStatesOfType(char *const *states, uint32_t offset, const Vector &column, const SelectionVector &selection) {
+  switch (column.GetType()) {
+    case TypeId::INTEGER:
+    case TypeId::DATE:
+      UpdateStates<TYPE, int32_t, int64_t>(states, offset, column, selection);
+      break;
+    case TypeId::BIGINT:
+      UpdateStates<TYPE, int64_t, int64_t>(states, offset, column, selection);
+      break;
+    default:
+      UpdateStates<TYPE, double, double>(states, offset, column, selection);
+      break;
+  }
+}
+
+/** Merge a state into another of the same aggregate. */
+template <typename Acc>
+void CombineState(AggregateType type, const char *from, char *to) {
+  Acc from_acc;
+  Acc to_acc;
+  int64_t from_count;
+  int64_t to_count;
+  memcpy(&from_acc, from, sizeof(Acc));
+  memcpy(&from_count, from + 8, sizeof(from_count));
+  memcpy(&to_acc, to, sizeof(Acc));
+  memcpy(&to_count, to + 8, sizeof(to_count));
+  if (from_count == 0) {
+    return;
+  }
+  switch (type) {
+    case AggregateType::SUM:
+    case AggregateType::AVG:
+      to_acc = Add(to_acc, from_acc);
+      break;
+    case AggregateType::MIN:
+      to_acc = to_count == 0 || from_acc < to_acc ? from_acc : to_acc;
+      break;
+    case AggregateType::MAX:
+      to_acc = to_count == 0 || from_acc > to_acc ? from_acc : to_acc;
+      break;
+    default:
+      break;
+  }
+  to_count += from_count;
+  memcpy(to, &to_acc, sizeof(Acc));
+  memcpy(to + 8, &to_count, sizeof(to_count));
+}
+
+auto GroupSchema(const Schema &schema, const std::vector<uint32_t> &group_by) -> Schema {
+  std::vector<Column> columns;
+  for (auto col_idx : group_by) {
+    columns.push_back(schema.GetColumn(col_idx));
+  }
+  return Schema(columns);
+}
+
+auto AggregateSchema(const Schema &schema, const std::vector<uint32_t> &group_by,
+                     const std::vector<Aggregate> &aggregates) -> Schema {
+  std::vector<Column> columns = GroupSchema(schema, group_by).GetColumns();
+  for (const auto &aggregate : aggregates) {
+    if (aggregate.type_ == AggregateType::COUNT_STAR) {
+      columns.emplace_back("count(*)", TypeId::BIGINT);
+      continue;
+    }
+    const Column &input = schema.GetColumn(aggregate.col_idx_);
+    if (aggregate.type_ != AggregateType::COUNT && !IsNumeric(input.GetType())) {
+      throw Exception(fmt::format("aggregate: {} of column {} which is not numeric", AggregateName(aggregate.type_),
+                                  input.GetName()));
+    }
+    columns.emplace_back(fmt::format("{}({})", AggregateName(aggregate.type_), input.GetName()),
+                         OutputType(aggregate.type_, input.GetType()));
+  }
+  return Schema(columns);
+}
+
+}  // namespace
+
+HashAggregateOperator::HashAggregateOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child,
+                                             std::vector<uint32_t> group_by, std::vector<Aggregate> aggregates,
+                                             BufferPoolManager *bpm, HashAggregateOptions options)
+    : Operator(ctx, AggregateSchema(child->GetOutputSchema(), group_by, aggregates)),
+      child_(std::move(child)),
+      group_by_(std::move(group_by)),
+      bpm_(bpm),
+      options_(options),
+      key_layout_(GroupSchema(child_->GetOutputSchema(), group_by_)) {
+  options_.num_threads_ = std::max<size_t>(options_.num_threads_, 1);
+  key_size_ = (key_layout_.GetSize() + 7) / 8 * 8;
+  row_size_ = sizeof(uint64_t) + key_size_;
+  for (const auto &aggregate : aggregates) {
+    TypeId input_type = TypeId::BIGINT;
+    if (aggregate.type_ != AggregateType::COUNT_STAR) {
+      input_type = child_->GetOutputSchema().GetColumn(aggregate.col_idx_).GetType();
+    }
+    aggregates_.push_back(
+        {aggregate.type_, aggregate.col_idx_, input_type, OutputType(aggregate.type_, input_type), row_size_});
+    row_size_ += STATE_SIZE;
+  }
+  if ((PAGE_SIZE - SPILL_PAGE_HEADER_SIZE) / row_size_ == 0) {
+    throw Exception(fmt::format("aggregate: a group of {} bytes does not fit a spill page", row_size_));
+  }
+}
+
+HashAggregateOperator::~HashAggregateOperator() {
+  for (auto &local : locals_) {
+    for (auto &file : local.files_) {
+      DeleteFile(&file);
+    }
+  }
+}
+
+auto HashAggregateOperator::PartitionOf(uint64_t hash) const -> size_t {
+  return options_.partition_bits_ == 0 ? 0 : hash >> (64 - options_.partition_bits_);
+}
+
+void HashAggregateOperator::Init() {
+  for (auto &local : locals_) {
+    for (auto &file : local.files_) {
+      DeleteFile(&file);
+    }
+  }
+  size_t num_partitions = size_t{1} << options_.partition_bits_;
+  locals_.clear();
+  locals_.resize(ctx_->GetThreadCount(options_.num_threads_));
+  for (auto &local : locals_) {
+    local.tables_.resize(num_partitions);
+    local.files_.resize(num_partitions);
+  }
+  partitions_spilled_ = 0;
+  merged_.clear();
+  merged_.resize(num_partitions);
+  next_partition_ = 0;
+  group_.clear();
+  group_pos_ = 0;
+  row_pos_ = 0;
+
+  child_->Init();
+  ConsumeChild();
+
+  if (group_by_.empty()) {
+    // without group columns there is always a group, even for an empty input
+    bool empty = true;
+    for (const auto &local : locals_) {
+      for (size_t p = 0; p < num_partitions; p++) {
+        empty = empty && local.tables_[p].rows_.empty() && local.files_[p].page_ids_.empty() &&
+                local.files_[p].count_ == 0;
+      }
+    }
+    if (empty) {
+      uint64_t hash = HashUtil::HashBytes(nullptr, 0);
+      FindOrCreate(&locals_[0].tables_[PartitionOf(hash)], hash, nullptr);
+    }
+  }
+}
+
+auto HashAggregateOperator::Next(DataChunk *chunk) -> bool {
+  while (true) {
+    if (group_pos_ < group_.size()) {
+      Table &table = merged_[group_[group_pos_]];
+      if (row_pos_ < table.rows_.size()) {
+        size_t count = std::min(ctx_->batch_size_, table.rows_.size() - row_pos_);
+        WriteGroups(table, row_pos_, row_pos_ + count, chunk);
+        row_pos_ += count;
+        chunk->SetSize(count);
+        return true;
+      }
+      table = Table{};
+      group_pos_++;
+      row_pos_ = 0;
+      continue;
+    }
+    if (!NextPartitionGroup()) {
+      return false;
+    }
+  }
+}
+
+void HashAggregateOperator::ConsumeChild() {
+  ParallelConsume(ctx_, child_.get(), options_.num_threads_,
+                  [this](const DataChunk &chunk, size_t thread_idx) { Consume(chunk, &locals_[thread_idx]); });
+}
+
+void HashAggregateOperator::Consume(const DataChunk &chunk, LocalState *local) {
+  const SelectionVector &selection = chunk.GetSelection();
+  size_t count = selection.GetCount();
+  if (count == 0) {
+    return;
+  }
+  HashKeys(chunk, local);
+
+  // the slots of a chunk are fetched together, so that their cache misses overlap
+  for (size_t i = 0; i < count; i++) {
+    const Table &table = local->tables_[PartitionOf(local->hashes_[i])];
+    if (!table.slot_rows_.empty()) {
+      __builtin_prefetch(&table.slot_hashes_[local->hashes_[i] & table.mask_]);
+    }
+  }
+  local->states_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    Table &table = local->tables_[PartitionOf(local->hashes_[i])];
+    size_t memory = table.memory_;
+    local->states_[i] = FindOrCreate(&table, local->hashes_[i], local->keys_.data() + i * key_size_);
+    local->memory_ += table.memory_ - memory;
+  }
+
+  char *const *states = local->states_.data();
+  for (const auto &aggregate : aggregates_) {
+    switch (aggregate.type_) {
+      case AggregateType::COUNT_STAR:
+        for (size_t i = 0; i < count; i++) {
+          char *state = states[i] + aggregate.offset_ + 8;
+          int64_t rows;
+          memcpy(&rows, state, sizeof(rows));
+          rows++;
+          memcpy(state, &rows, sizeof(rows));
+        }
+        break;
+      case AggregateType::COUNT: {
+        const Vector &column = chunk.GetColumn(aggregate.col_idx_);
+        size_t step = column.IsConstant() ? 0 : 1;
+        for (size_t i = 0; i < count; i++) {
+          char *state = states[i] + aggregate.offset_ + 8;
+          int64_t rows;
+          memcpy(&rows, state, sizeof(rows));
+          rows += column.GetNulls()[selection[i] * step] == 0 ? 1 : 0;
+          memcpy(state, &rows, sizeof(rows));
+        }
+        break;
+      }
+      case AggregateType::SUM:
+      case AggregateType::AVG:
+        UpdateStatesOfType<AggregateType::SUM>(states, aggregate.offset_, chunk.GetColumn(aggregate.col_idx_),
+                                               selection);
+        break;
+      case AggregateType::MIN:
+        UpdateStatesOfType<AggregateType::MIN>(states, aggregate.offset_, chunk.GetColumn(aggregate.col_idx_),
+                                               selection);
+        break;
+      case AggregateType::MAX:
+        UpdateStatesOfType<AggregateType::MAX>(states, aggregate.offset_, chunk.GetColumn(aggregate.col_idx_),
+                                               selection);
+        break;
+    }
+  }
+
+  size_t budget = options_.memory_budget_ / locals_.size();
+  while (local->memory_ > budget) {
+    SpillLargest(local);
+  }
+}
+
+void HashAggregateOperator::HashKeys(const DataChunk &chunk, LocalState *local) const {
+  const SelectionVector &selection = chunk.GetSelection();
+  size_t count = selection.GetCount();
+  local->keys_.assign(count * key_size_, 0);
+  local->hashes_.resize(count);
+  char *keys = local->keys_.data();
+  for (size_t col = 0; col < group_by_.size(); col++) {
+    const Vector &column = chunk.GetColumn(group_by_[col]);
+    uint32_t width = column.GetWidth();
+    uint32_t offset = key_layout_.GetOffset(col);
+    size_t step = column.IsConstant() ? 0 : 1;
+    for (size_t i = 0; i < count; i++) {
+      size_t idx = selection[i] * step;
+      char *key = keys + i * key_size_;
+      if (column.GetNulls()[idx] != 0) {
+        key[col] = 1;
+        continue;
+      }
+      memcpy(key + offset, column.GetData() + idx * width, width);
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    local->hashes_[i] = HashUtil::HashBytes(keys + i * key_size_, key_size_);
+  }
+}
+
+auto HashAggregateOperator::FindOrCreate(Table *table, uint64_t hash, const char *key) const -> char * {
+  if (2 * (table->rows_.size() + 1) > table->slot_rows_.size()) {
+    Grow(table);
+  }
+  uint64_t slot = hash & table->mask_;
+  while (table->slot_rows_[slot] != nullptr) {
+    if (table->slot_hashes_[slot] == hash &&
+        (key_size_ == 0 || memcmp(table->slot_rows_[slot] + sizeof(uint64_t), key, key_size_) == 0)) {
+      return table->slot_rows_[slot];
+    }
+    slot = (slot + 1) & table->mask_;
+  }
+  if (table->blocks_.empty() || table->block_used_ + row_size_ > ARENA_BLOCK_SIZE) {
+    table->blocks_.emplace_back(new char[ARENA_BLOCK_SIZE]);
+    table->block_used_ = 0;
+    table->memory_ += ARENA_BLOCK_SIZE;
+  }
+  char *row = table->blocks_.back().get() + table->block_used_;
+  table->block_used_ += row_size_;
+  memcpy(row, &hash, sizeof(hash));
+  if (key_size_ > 0) {
+    memcpy(row + sizeof(hash), key, key_size_);
+  }
+  memset(row + sizeof(hash) + key_size_, 0, row_size_ - sizeof(hash) - key_size_);
+  table->rows_.push_back(row);
+  table->slot_hashes_[slot] = hash;
+  table->slot_rows_[slot] = row;
+  return row;
+}
+
+void HashAggregateOperator::Grow(Table *table) const {
+  size_t capacity = std::max<size_t>(16, 2 * table->slot_rows_.size());
+  table->memory_ -= table->slot_rows_.size() * (sizeof(uint64_t) + sizeof(char *));
+  table->slot_hashes_.assign(capacity, 0);
+  table->slot_rows_.assign(capacity, nullptr);
+  table->mask_ = capacity - 1;
+  table->memory_ += capacity * (sizeof(uint64_t) + sizeof(char *));
+  for (char *row : table->rows_) {
+    uint64_t hash;
+    memcpy(&hash, row, sizeof(hash));
+    uint64_t slot = hash & table->mask_;
+    while (table->slot_rows_[slot] != nullptr) {
+      slot = (slot + 1) & table->mask_;
+    }
+    table->slot_hashes_[slot] = hash;
+    table->slot_rows_[slot] = row;
+  }
+}
+
+void HashAggregateOperator::Combine(const char *from, char *to) const {
+  for (const auto &aggregate : aggregates_) {
+    if (aggregate.input_type_ == TypeId::DOUBLE) {
+      CombineState<double>(aggregate.type_, from + aggregate.offset_, to + aggregate.offset_);
+    } else {
+      CombineState<int64_t>(aggregate.type_, from + aggregate.offset_, to + aggregate.offset_);
+    }
+  }
+}
+
+void HashAggregateOperator::SpillLargest(LocalState *local) {
+  size_t largest = 0;
+  for (size_t p = 1; p < local->tables_.size(); p++) {
+    if (local->tables_[p].memory_ > local->tables_[largest].memory_) {
+      largest = p;
+    }
+  }
+  Table &table = local->tables_[largest];
+  for (const char *row : table.rows_) {
+    AppendToFile(&local->files_[largest], row);
+  }
+  local->memory_ -= table.memory_;
+  table = Table{};
+  partitions_spilled_++;
+}
+
+void HashAggregateOperator::AppendToFile(SpillFile *file, const char *row) {
+  size_t rows_per_page = (PAGE_SIZE - SPILL_PAGE_HEADER_SIZE) / row_size_;
+  if (file->page_.empty()) {
+    file->page_.resize(PAGE_SIZE);
+  }
+  memcpy(file->page_.data() + SPILL_PAGE_HEADER_SIZE + file->count_ * row_size_, row, row_size_);
+  file->count_++;
+  if (file->count_ == rows_per_page) {
+    FlushFile(file);
+  }
+}
+
+void HashAggregateOperator::FlushFile(SpillFile *file) {
+  if (file->count_ == 0) {
+    return;
+  }
+  memcpy(file->page_.data(), &file->count_, sizeof(uint32_t));
+  page_id_t page_id;
+  auto basic = bpm_->NewPageGuarded(&page_id, AccessType::Scan);
+  if (!basic.IsValid()) {
+    throw Exception("aggregate: no free frame in the buffer pool for a spill page");
+  }
+  auto guard = basic.UpgradeWrite();
+  memcpy(guard.GetDataMut(), file->page_.data(), PAGE_SIZE);
+  file->page_ids_.push_back(page_id);
+  file->count_ = 0;
+}
+
+void HashAggregateOperator::DeleteFile(SpillFile *file) {
+  for (auto page_id : file->page_ids_) {
+    if (page_id != INVALID_PAGE_ID) {
+      bpm_->DeletePage(page_id);
+    }
+  }
+  file->page_ids_.clear();
+  file->page_.clear();
+  file->count_ = 0;
+}
+
+void HashAggregateOperator::MergePartition(size_t partition_idx) {
+  Table &merged = merged_[partition_idx];
+  auto combine_rows = [&](const char *rows, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      const char *row = rows + i * row_size_;
+      uint64_t hash;
+      memcpy(&hash, row, sizeof(hash));
+      Combine(row, FindOrCreate(&merged, hash, row + sizeof(hash)));
+    }
+  };
+  for (auto &local : locals_) {
+    Table &table = local.tables_[partition_idx];
+    if (merged.rows_.empty()) {
+      // the first table is taken over as it is, its groups are distinct already
+      merged = std::move(table);
+    } else {
+      for (const char *row : table.rows_) {
+        combine_rows(row, 1);
+      }
+    }
+    table = Table{};
+
+    SpillFile &file = local.files_[partition_idx];
+    std::vector<char> page(PAGE_SIZE);
+    for (size_t page_idx = 0; page_idx < file.page_ids_.size(); page_idx++) {
+      size_t prefetch_begin = page_idx == 0 ? 1 : page_idx + SCAN_READ_AHEAD;
+      for (size_t i = prefetch_begin; i <= page_idx + SCAN_READ_AHEAD && i < file.page_ids_.size(); i++) {
+        bpm_->PrefetchPage(file.page_ids_[i]);
+      }
+      page_id_t page_id = file.page_ids_[page_idx];
+      auto guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+      if (!guard.IsValid()) {
+        throw Exception(fmt::format("aggregate: spill page {} cannot be fetched", page_id));
+      }
+      memcpy(page.data(), guard.GetData(), PAGE_SIZE);
+      guard.Drop();
+      bpm_->DeletePage(page_id);
+      file.page_ids_[page_idx] = INVALID_PAGE_ID;
+      uint32_t count;
+      memcpy(&count, page.data(), sizeof(count));
+      combine_rows(page.data() + SPILL_PAGE_HEADER_SIZE, count);
+    }
+    // the page being filled was never written
+    if (file.count_ > 0) {
+      combine_rows(file.page_.data() + SPILL_PAGE_HEADER_SIZE, file.count_);
+    }
+    DeleteFile(&file);
+  }
+}
+
+auto HashAggregateOperator::NextPartitionGroup() -> bool {
+  group_.clear();
+  group_pos_ = 0;
+  row_pos_ = 0;
+  while (next_partition_ < merged_.size() && group_.size() < locals_.size()) {
+    group_.push_back(next_partition_++);
+  }
+  if (group_.empty()) {
+    return false;
+  }
+  ParallelFor(ctx_->scheduler_, group_.size(), group_.size(), [this](size_t i) { MergePartition(group_[i]); });
+  return true;
+}
+
+void HashAggregateOperator::WriteGroups(const Table &table, size_t begin, size_t end, DataChunk *chunk) {
+  size_t count = end - begin;
+  const char *const *rows = table.rows_.data() + begin;
+  out_keys_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    out_keys_[i] = rows[i] + sizeof(uint64_t);
+  }
+  key_layout_.Gather(out_keys_.data(), count, chunk, 0, 0);
+
+  for (size_t a = 0; a < aggregates_.size(); a++) {
+    const AggregateInfo &aggregate = aggregates_[a];
+    Vector &column = chunk->GetColumn(group_by_.size() + a);
+    uint8_t *nulls = column.GetNulls();
+    for (size_t i = 0; i < count; i++) {
+      const char *state = rows[i] + aggregate.offset_;
+      int64_t values;
+      memcpy(&values, state + 8, sizeof(values));
+      if (aggregate.type_ == AggregateType::COUNT_STAR || aggregate.type_ == AggregateType::COUNT) {
+        nulls[i] = 0;
+        column.GetData<int64_t>()[i] = values;
+        continue;
+      }
+      nulls[i] = values == 0 ? 1 : 0;
+      if (values == 0) {
+        memset(column.GetData() + i * column.GetWidth(), 0, column.GetWidth());
+        continue;
+      }
+      if (aggregate.input_type_ == TypeId::DOUBLE) {
+        double acc;
+        memcpy(&acc, state, sizeof(acc));
+        column.GetData<double>()[i] = aggregate.type_ == AggregateType::AVG ? acc / static_cast<double>(values) : acc;
+        continue;
+      }
+      int64_t acc;
+      memcpy(&acc, state, sizeof(acc));
+      if (aggregate.type_ == AggregateType::AVG) {
+        column.GetData<double>()[i] = static_cast<double>(acc) / static_cast<double>(values);
+      } else if (aggregate.output_type_ == TypeId::BIGINT) {
+        column.GetData<int64_t>()[i] = acc;
+      } else {
+        column.GetData<int32_t>()[i] = static_cast<int32_t>(acc);
+      }
+    }
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,559 @@
+#include "execution/hash_join_operator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "buffer/sorted_run.h"
+#include "common/exception.h"
+#include "common/util/hash_util.h"
+#include "fmt/format.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+namespace {
+
+/** Spill pages start with the number of rows they hold. */
+constexpr size_t SPILL_PAGE_HEADER_SIZE = 8;
+
+/** Probe rows between the lookup of a row and the prefetch of its slot. */
+constexpr size_t PREFETCH_DISTANCE = 16;
+
+auto IsIntegerKey(TypeId type_id) -> bool {
+  return type_id == TypeId::INTEGER || type_id == TypeId::BIGINT || type_id == TypeId::DATE;
+}
+
+/** @return false if the key of the row is NULL */
+inline auto ReadKey(const Vector &column, uint32_t row, int64_t *key) -> bool {
+  size_t idx = column.IsConstant() ? 0 : row;
+  if (column.GetNulls()[idx] != 0) {
+    return false;
+  }
+  *key = column.GetType() == TypeId::BIGINT ? column.GetData<int64_t>()[idx] : column.GetData<int32_t>()[idx];
+  return true;
+}
+
+inline auto HashKey(int64_t key) -> uint64_t { return HashUtil::Mix(static_cast<uint64_t>(key)); }
+
+/** The tag of a slot: bits of the hash neither the partition nor the slot index come from, never 0. */
+inline auto TagOf(uint64_t hash) -> uint8_t { return static_cast<uint8_t>(0x80 | ((hash >> 32) & 0x7f)); }
+
+/** Copy rows `rows` of a column (`step` 0 for a constant) to the rows [0, count) of another. WIDTH 0 for any width. */
+template <uint32_t WIDTH>
+void GatherColumn(const char *from, const uint8_t *from_nulls, size_t step, const uint32_t *rows, size_t count,
+                  uint32_t width, char *to, uint8_t *to_nulls) {
+  uint32_t w = WIDTH == 0 ? width : WIDTH;
+  for (size_t i = 0; i < count; i++) {
+    size_t idx = rows[i] * step;
+    to_nulls[i] = from_nulls[idx];
+    memcpy(to + i * w, from + idx * w, WIDTH == 0 ? width : WIDTH);
+  }
+}
+
+auto JoinSchema(const Schema &probe, const Schema &build) -> Schema {
+  std::vector<Column> columns = probe.GetColumns();
+  columns.insert(columns.end(), build.GetColumns().begin(), build.GetColumns().end());
+  return Schema(columns);
+}
+
+}  // namespace
+
+HashJoinOperator::HashJoinOperator(ExecutorContext *ctx, std::unique_ptr<Operator> probe,
+                                   std::unique_ptr<Operator> build, uint32_t probe_key_idx, uint32_t build_key_idx,
+                                   BufferPoolManager *bpm, HashJoinOptions options)
+    : Operator(ctx, JoinSchema(probe->GetOutputSchema(), build->GetOutputSchema())),
+      probe_(std::move(probe)),
+      build_(std::move(build)),
+      probe_key_idx_(probe_key_idx),
+      build_key_idx_(build_key_idx),
+      bpm_(bpm),
+      options_(options),
+      probe_layout_(probe_->GetOutputSchema()),
+      build_layout_(build_->GetOutputSchema()) {
+  if (!IsIntegerKey(probe_->GetOutputSchema().GetColumn(probe_key_idx_).GetType()) ||
+      !IsIntegerKey(build_->GetOutputSchema().GetColumn(build_key_idx_).GetType())) {
+    throw Exception(fmt::format("hash join: keys {} and {} must be integer columns", probe_key_idx, build_key_idx));
+  }
+  options_.partition_bits_ = std::min<size_t>(options_.partition_bits_, 16);
+  options_.num_threads_ = std::max<size_t>(options_.num_threads_, 1);
+  row_.resize(std::max(probe_layout_.GetSize(), build_layout_.GetSize()));
+}
+
+HashJoinOperator::HashJoinOperator(HashJoinOperator *builder, std::unique_ptr<Operator> probe)
+    : Operator(builder->ctx_, builder->GetOutputSchema()),
+      probe_(std::move(probe)),
+      probe_key_idx_(builder->probe_key_idx_),
+      build_key_idx_(builder->build_key_idx_),
+      bpm_(builder->bpm_),
+      options_(builder->options_),
+      probe_layout_(builder->probe_layout_),
+      build_layout_(builder->build_layout_),
+      probed_(&builder->partitions_),
+      probe_chunk_(probe_->MakeChunk()) {}
+
+HashJoinOperator::~HashJoinOperator() {
+  for (auto &partition : partitions_) {
+    DeleteFile(&partition.build_file_);
+    DeleteFile(&partition.probe_file_);
+  }
+}
+
+auto HashJoinOperator::PartitionOf(uint64_t hash) const -> size_t {
+  return options_.partition_bits_ == 0 ? 0 : hash >> (64 - options_.partition_bits_);
+}
+
+void HashJoinOperator::Init() {
+  for (auto &partition : partitions_) {
+    DeleteFile(&partition.build_file_);
+    DeleteFile(&partition.probe_file_);
+  }
+  partitions_.clear();
+  partitions_.resize(size_t{1} << options_.partition_bits_);
+  memory_used_ = 0;
+  peak_memory_ = 0;
+  partitions_spilled_ = 0;
+  spilled_.clear();
+  group_.clear();
+
+  ConsumeBuild();
+  std::vector<size_t> in_memory;
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    if (partitions_[i].spilled_) {
+      FlushFile(&partitions_[i].build_file_);
+      spilled_.push_back(i);
+    } else {
+      in_memory.push_back(i);
+    }
+  }
+  BuildTables(in_memory, false);
+
+  probe_->Init();
+  probe_chunk_ = probe_->MakeChunk();
+  pending_rows_.clear();
+  pending_keys_.clear();
+  pending_hashes_.clear();
+  pending_pos_ = 0;
+  resume_slot_ = UINT64_MAX;
+  phase_ = Phase::IN_MEMORY;
+}
+
+auto HashJoinOperator::MakeWorker() -> std::unique_ptr<Operator> {
+  if (partitions_spilled_ > 0) {
+    return nullptr;
+  }
+  auto probe = probe_->MakeWorker();
+  if (probe == nullptr) {
+    return nullptr;
+  }
+  return std::unique_ptr<Operator>(new HashJoinOperator(this, std::move(probe)));
+}
+
+void HashJoinOperator::InitMorsel(size_t morsel_idx) {
+  probe_->InitMorsel(morsel_idx);
+  pending_rows_.clear();
+  pending_keys_.clear();
+  pending_hashes_.clear();
+  pending_pos_ = 0;
+  resume_slot_ = UINT64_MAX;
+  phase_ = Phase::IN_MEMORY;
+}
+
+void HashJoinOperator::ConsumeBuild() {
+  build_->Init();
+  DataChunk chunk = build_->MakeChunk();
+  while (build_->Next(&chunk)) {
+    const Vector &key_column = chunk.GetColumn(build_key_idx_);
+    const SelectionVector &selection = chunk.GetSelection();
+    for (size_t i = 0; i < selection.GetCount(); i++) {
+      int64_t key;
+      if (!ReadKey(key_column, selection[i], &key)) {
+        continue;
+      }
+      size_t partition_idx = PartitionOf(HashKey(key));
+      Partition &partition = partitions_[partition_idx];
+      if (partition.spilled_) {
+        build_layout_.Store(chunk, selection[i], row_.data());
+        AppendToFile(&partition.build_file_, build_layout_, row_.data());
+        continue;
+      }
+      // charge the row, the growth of the vectors it may cause and of the table, before allocating any of it
+      size_t rows = partition.keys_.size();
+      size_t reserved = rows < partition.keys_.capacity() ? partition.keys_.capacity() : std::max<size_t>(16, 2 * rows);
+      size_t bytes = PartitionBytes(reserved, rows + 1);
+      memory_used_ += bytes - partition.bytes_;
+      partition.bytes_ = bytes;
+      while (memory_used_ > options_.memory_budget_) {
+        // the largest partition goes, it frees the most memory for one spill
+        size_t largest = partitions_.size();
+        for (size_t p = 0; p < partitions_.size(); p++) {
+          if (!partitions_[p].spilled_ &&
+              (largest == partitions_.size() || partitions_[p].bytes_ > partitions_[largest].bytes_)) {
+            largest = p;
+          }
+        }
+        if (largest == partitions_.size()) {
+          break;
+        }
+        SpillPartition(largest);
+      }
+      if (partition.spilled_) {
+        build_layout_.Store(chunk, selection[i], row_.data());
+        AppendToFile(&partition.build_file_, build_layout_, row_.data());
+        continue;
+      }
+      peak_memory_ = std::max(peak_memory_, memory_used_);
+      partition.keys_.reserve(reserved);
+      partition.rows_.reserve(reserved * build_layout_.GetSize());
+      partition.keys_.push_back(key);
+      partition.rows_.resize(partition.rows_.size() + build_layout_.GetSize());
+      char *row = partition.rows_.data() + partition.rows_.size() - build_layout_.GetSize();
+      build_layout_.Store(chunk, selection[i], row);
+    }
+  }
+}
+
+void HashJoinOperator::SpillPartition(size_t partition_idx) {
+  Partition &partition = partitions_[partition_idx];
+  for (size_t i = 0; i < partition.keys_.size(); i++) {
+    AppendToFile(&partition.build_file_, build_layout_, partition.rows_.data() + i * build_layout_.GetSize());
+  }
+  ReleaseRows(&partition);
+  partition.spilled_ = true;
+  partitions_spilled_++;
+}
+
+void HashJoinOperator::AppendToFile(SpillFile *file, const RowLayout &layout, const char *row) {
+  size_t rows_per_page = (PAGE_SIZE - SPILL_PAGE_HEADER_SIZE) / layout.GetSize();
+  if (rows_per_page == 0) {
+    throw Exception(fmt::format("hash join: a row of {} bytes does not fit a spill page", layout.GetSize()));
+  }
+  if (file->page_.empty()) {
+    file->page_.resize(PAGE_SIZE);
+  }
+  memcpy(file->page_.data() + SPILL_PAGE_HEADER_SIZE + file->count_ * layout.GetSize(), row, layout.GetSize());
+  file->count_++;
+  file->rows_++;
+  if (file->count_ == rows_per_page) {
+    FlushFile(file);
+  }
+}
+
+void HashJoinOperator::FlushFile(SpillFile *file) {
+  if (file->count_ == 0) {
+    return;
+  }
+  memcpy(file->page_.data(), &file->count_, sizeof(uint32_t));
+  page_id_t page_id;
+  auto basic = bpm_->NewPageGuarded(&page_id, AccessType::Scan);
+  if (!basic.IsValid()) {
+    throw Exception("hash join: no free frame in the buffer pool for a spill page");
+  }
+  auto guard = basic.UpgradeWrite();
+  memcpy(guard.GetDataMut(), file->page_.data(), PAGE_SIZE);
+  file->page_ids_.push_back(page_id);
+  file->count_ = 0;
+}
+
+auto HashJoinOperator::TableCapacity(size_t rows) -> size_t {
+  size_t capacity = 16;
+  while (capacity < 2 * rows) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+auto HashJoinOperator::PartitionBytes(size_t reserved, size_t rows) const -> size_t {
+  constexpr size_t slot_bytes = sizeof(uint8_t) + sizeof(int64_t) + sizeof(uint32_t);
+  return reserved * (build_layout_.GetSize() + sizeof(int64_t)) + TableCapacity(rows) * slot_bytes;
+}
+
+void HashJoinOperator::BuildTable(Partition *partition) {
+  size_t capacity = TableCapacity(partition->keys_.size());
+  partition->tags_.assign(capacity, 0);
+  partition->slot_keys_.resize(capacity);
+  partition->slot_rows_.resize(capacity);
+  partition->mask_ = capacity - 1;
+  for (size_t i = 0; i < partition->keys_.size(); i++) {
+    uint64_t hash = HashKey(partition->keys_[i]);
+    uint64_t slot = hash & partition->mask_;
+    while (partition->tags_[slot] != 0) {
+      slot = (slot + 1) & partition->mask_;
+    }
+    partition->tags_[slot] = TagOf(hash);
+    partition->slot_keys_[slot] = partition->keys_[i];
+    partition->slot_rows_[slot] = static_cast<uint32_t>(i);
+  }
+}
+
+void HashJoinOperator::BuildTables(const std::vector<size_t> &partition_idxs, bool load) {
+  ParallelFor(ctx_->scheduler_, options_.num_threads_, partition_idxs.size(), [&](size_t i) {
+    if (load) {
+      LoadPartition(partition_idxs[i]);
+    }
+    BuildTable(&partitions_[partition_idxs[i]]);
+  });
+}
+
+void HashJoinOperator::LoadPartition(size_t partition_idx) {
+  Partition &partition = partitions_[partition_idx];
+  SpillFile &file = partition.build_file_;
+  uint32_t key_offset = build_layout_.GetOffset(build_key_idx_);
+  bool wide_key = build_->GetOutputSchema().GetColumn(build_key_idx_).GetType() == TypeId::BIGINT;
+  partition.keys_.reserve(file.rows_);
+  partition.rows_.resize(file.rows_ * build_layout_.GetSize());
+  std::vector<char> page;
+  size_t row = 0;
+  for (size_t page_idx = 0; page_idx < file.page_ids_.size(); page_idx++) {
+    ReadFilePage(&file, page_idx, &page);
+    uint32_t count;
+    memcpy(&count, page.data(), sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i++, row++) {
+      const char *in = page.data() + SPILL_PAGE_HEADER_SIZE + i * build_layout_.GetSize();
+      memcpy(partition.rows_.data() + row * build_layout_.GetSize(), in, build_layout_.GetSize());
+      if (wide_key) {
+        int64_t key;
+        memcpy(&key, in + key_offset, sizeof(int64_t));
+        partition.keys_.push_back(key);
+      } else {
+        int32_t key;
+        memcpy(&key, in + key_offset, sizeof(int32_t));
+        partition.keys_.push_back(key);
+      }
+    }
+  }
+  file.page_ids_.clear();
+}
+
+void HashJoinOperator::ReadFilePage(SpillFile *file, size_t page_idx, std::vector<char> *page) {
+  ReadSpillPage(bpm_, file->page_ids_, page_idx, page, "hash join: spill");
+  file->page_ids_[page_idx] = INVALID_PAGE_ID;
+}
+
+void HashJoinOperator::DeleteFile(SpillFile *file) {
+  for (auto page_id : file->page_ids_) {
+    if (page_id != INVALID_PAGE_ID) {
+      bpm_->DeletePage(page_id);
+    }
+  }
+  file->page_ids_.clear();
+  file->count_ = 0;
+  file->rows_ = 0;
+}
+
+void HashJoinOperator::ReleaseRows(Partition *partition) {
+  memory_used_ -= partition->bytes_;
+  partition->bytes_ = 0;
+  std::vector<int64_t>().swap(partition->keys_);
+  std::vector<char>().swap(partition->rows_);
+  std::vector<uint8_t>().swap(partition->tags_);
+  std::vector<int64_t>().swap(partition->slot_keys_);
+  std::vector<uint32_t>().swap(partition->slot_rows_);
+  partition->mask_ = 0;
+}
+
+auto HashJoinOperator::Next(DataChunk *chunk) -> bool {
+  match_probe_rows_.resize(chunk->GetCapacity());
+  match_build_rows_.resize(chunk->GetCapacity());
+  size_t out = 0;
+  while (phase_ != Phase::DONE) {
+    // the matches are copied out before the next probe rows replace the ones they point to
+    size_t begin = out;
+    out = EmitMatches(chunk, out);
+    WriteMatches(chunk, begin, out);
+    if (out == chunk->GetCapacity() || !NextProbeChunk()) {
+      break;
+    }
+  }
+  chunk->SetSize(out);
+  return out > 0;
+}
+
+auto HashJoinOperator::NextProbeChunk() -> bool {
+  while (true) {
+    if (phase_ == Phase::IN_MEMORY) {
+      if (probe_->Next(&probe_chunk_)) {
+        PrepareProbeRows();
+        return true;
+      }
+      // the probe side is exhausted, the partitions in memory are done with
+      for (auto &partition : partitions_) {
+        if (partition.spilled_) {
+          FlushFile(&partition.probe_file_);
+        } else {
+          ReleaseRows(&partition);
+        }
+      }
+      // the spilled probe rows are decoded into a chunk of our own, the one of the child may share its buffers
+      probe_chunk_ = probe_->MakeChunk();
+      phase_ = Phase::SPILLED;
+    } else if (phase_ == Phase::SPILLED) {
+      if (NextSpilledProbeRows()) {
+        PrepareProbeRows();
+        return true;
+      }
+      if (!NextSpilledGroup()) {
+        phase_ = Phase::DONE;
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+}
+
+auto HashJoinOperator::NextSpilledGroup() -> bool {
+  size_t group_bytes = 0;
+  while (!spilled_.empty()) {
+    Partition &partition = partitions_[spilled_.front()];
+    if (partition.build_file_.rows_ == 0 || partition.probe_file_.rows_ == 0) {
+      // one side is empty, nothing of the partition can match
+      DeleteFile(&partition.build_file_);
+      DeleteFile(&partition.probe_file_);
+      spilled_.erase(spilled_.begin());
+      continue;
+    }
+    // a spilled partition is read back into vectors of its exact size
+    size_t bytes = PartitionBytes(partition.build_file_.rows_, partition.build_file_.rows_);
+    if (!group_.empty() && group_bytes + bytes > options_.memory_budget_) {
+      break;
+    }
+    partition.bytes_ = bytes;
+    group_bytes += bytes;
+    group_.push_back(spilled_.front());
+    spilled_.erase(spilled_.begin());
+  }
+  if (group_.empty()) {
+    return false;
+  }
+  memory_used_ += group_bytes;
+  peak_memory_ = std::max(peak_memory_, memory_used_);
+  BuildTables(group_, true);
+  probe_page_idx_ = 0;
+  probe_page_count_ = 0;
+  probe_page_pos_ = 0;
+  return true;
+}
+
+auto HashJoinOperator::NextSpilledProbeRows() -> bool {
+  while (!group_.empty()) {
+    SpillFile &file = partitions_[group_.front()].probe_file_;
+    if (probe_page_pos_ < probe_page_count_) {
+      size_t count = std::min<size_t>(probe_chunk_.GetCapacity(), probe_page_count_ - probe_page_pos_);
+      for (size_t i = 0; i < count; i++, probe_page_pos_++) {
+        probe_layout_.Load(probe_page_.data() + SPILL_PAGE_HEADER_SIZE + probe_page_pos_ * probe_layout_.GetSize(),
+                           &probe_chunk_, i, 0);
+      }
+      probe_chunk_.SetSize(count);
+      return true;
+    }
+    if (probe_page_idx_ < file.page_ids_.size()) {
+      ReadFilePage(&file, probe_page_idx_++, &probe_page_);
+      memcpy(&probe_page_count_, probe_page_.data(), sizeof(uint32_t));
+      probe_page_pos_ = 0;
+      continue;
+    }
+    // the partition is joined
+    DeleteFile(&file);
+    ReleaseRows(&partitions_[group_.front()]);
+    group_.erase(group_.begin());
+    probe_page_idx_ = 0;
+    probe_page_count_ = 0;
+    probe_page_pos_ = 0;
+  }
+  return false;
+}
+
+void HashJoinOperator::PrepareProbeRows() {
+  pending_rows_.clear();
+  pending_keys_.clear();
+  pending_hashes_.clear();
+  pending_pos_ = 0;
+  resume_slot_ = UINT64_MAX;
+  const Vector &key_column = probe_chunk_.GetColumn(probe_key_idx_);
+  const SelectionVector &selection = probe_chunk_.GetSelection();
+  for (size_t i = 0; i < selection.GetCount(); i++) {
+    uint32_t row = selection[i];
+    int64_t key;
+    if (!ReadKey(key_column, row, &key)) {
+      continue;
+    }
+    uint64_t hash = HashKey(key);
+    Partition &partition = (*probed_)[PartitionOf(hash)];
+    if (phase_ == Phase::IN_MEMORY && partition.spilled_) {
+      probe_layout_.Store(probe_chunk_, row, row_.data());
+      AppendToFile(&partition.probe_file_, probe_layout_, row_.data());
+      continue;
+    }
+    if (partition.tags_.empty()) {
+      continue;
+    }
+    pending_rows_.push_back(row);
+    pending_keys_.push_back(key);
+    pending_hashes_.push_back(hash);
+  }
+  for (size_t i = 0; i < PREFETCH_DISTANCE && i < pending_rows_.size(); i++) {
+    PrefetchSlot(i);
+  }
+}
+
+void HashJoinOperator::PrefetchSlot(size_t pending_idx) const {
+  const Partition &partition = (*probed_)[PartitionOf(pending_hashes_[pending_idx])];
+  uint64_t slot = pending_hashes_[pending_idx] & partition.mask_;
+  __builtin_prefetch(&partition.tags_[slot]);
+  __builtin_prefetch(&partition.slot_keys_[slot]);
+  __builtin_prefetch(&partition.slot_rows_[slot]);
+}
+
+auto HashJoinOperator::EmitMatches(DataChunk *chunk, size_t out) -> size_t {
+  size_t capacity = chunk->GetCapacity();
+  size_t num_pending = pending_rows_.size();
+  uint32_t row_size = build_layout_.GetSize();
+  // the state lives in locals through the loop, the stores to the match arrays would reload members otherwise
+  size_t pos = pending_pos_;
+  uint64_t resume_slot = resume_slot_;
+  for (; pos < num_pending; pos++, resume_slot = UINT64_MAX) {
+    uint64_t hash = pending_hashes_[pos];
+    int64_t key = pending_keys_[pos];
+    const Partition &partition = (*probed_)[PartitionOf(hash)];
+    if (resume_slot == UINT64_MAX && pos + PREFETCH_DISTANCE < num_pending) {
+      PrefetchSlot(pos + PREFETCH_DISTANCE);
+    }
+    const uint8_t *tags = partition.tags_.data();
+    const int64_t *slot_keys = partition.slot_keys_.data();
+    uint64_t mask = partition.mask_;
+    uint8_t tag = TagOf(hash);
+    for (uint64_t slot = resume_slot == UINT64_MAX ? hash & mask : resume_slot; tags[slot] != 0;
+         slot = (slot + 1) & mask) {
+      if (tags[slot] != tag || slot_keys[slot] != key) {
+        continue;
+      }
+      if (out == capacity) {
+        pending_pos_ = pos;
+        resume_slot_ = slot;
+        return out;
+      }
+      match_probe_rows_[out] = pending_rows_[pos];
+      match_build_rows_[out] = partition.rows_.data() + size_t{partition.slot_rows_[slot]} * row_size;
+      out++;
+    }
+  }
+  pending_pos_ = pos;
+  resume_slot_ = UINT64_MAX;
+  return out;
+}
+
+void HashJoinOperator::WriteMatches(DataChunk *chunk, size_t begin, size_t end) const {
+  size_t probe_columns = probe_layout_.GetColumnCount();
+  for (size_t col = 0; col < probe_columns; col++) {
+    const Vector &from = probe_chunk_.GetColumn(col);
+    Vector &to = chunk->GetColumn(col);
+    DispatchWidth(from.GetWidth(), [&](auto fixed_width) {
+      GatherColumn<fixed_width.value>(from.GetData(), from.GetNulls(), from.IsConstant() ? 0 : 1,
+                                      match_probe_rows_.data() + begin, end - begin, from.GetWidth(),
+                                      to.GetData() + begin * to.GetWidth(), to.GetNulls() + begin);
+    });
+  }
+  build_layout_.Gather(match_build_rows_.data() + begin, end - begin, chunk, begin, probe_columns);
+}
+
+}  // namespace redbase
@@ -0,0 +1,34 @@
+#include "execution/limit_operator.h"
+
+#include <algorithm>
+
+namespace redbase {
+
+LimitOperator::LimitOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, size_t limit, size_t offset)
+    : Operator(ctx, child->GetOutputSchema()), child_(std::move(child)), limit_(limit), offset_(offset) {}
+
+void LimitOperator::Init() {
+  child_->Init();
+  to_skip_ = offset_;
+  emitted_ = 0;
+}
+
+auto LimitOperator::Next(DataChunk *chunk) -> bool {
+  // once the limit is reached the child is not pulled any more
+  while (emitted_ < limit_ && child_->Next(chunk)) {
+    SelectionVector &selection = chunk->GetSelection();
+    size_t skip = std::min(to_skip_, selection.GetCount());
+    size_t take = std::min(selection.GetCount() - skip, limit_ - emitted_);
+    uint32_t *rows = selection.GetData();
+    std::copy(rows + skip, rows + skip + take, rows);
+    selection.SetCount(take);
+    to_skip_ -= skip;
+    emitted_ += take;
+    if (take > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace redbase
@@ -0,0 +1,135 @@
+#include "execution/parallel_consume.h"
+
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <vector>
+
+namespace redbase {
+
+namespace {
+
+/** Copy the selected rows of a chunk to the rows [0, count) of a chunk of the same schema. */
+void CopySelected(const DataChunk &from, DataChunk *to) {
+  const SelectionVector &selection = from.GetSelection();
+  for (size_t col = 0; col < from.GetColumnCount(); col++) {
+    const Vector &source = from.GetColumn(col);
+    Vector &target = to->GetColumn(col);
+    uint32_t width = source.GetWidth();
+    size_t step = source.IsConstant() ? 0 : 1;
+    for (size_t i = 0; i < selection.GetCount(); i++) {
+      size_t idx = selection[i] * step;
+      target.GetNulls()[i] = source.GetNulls()[idx];
+      memcpy(target.GetData() + i * width, source.GetData() + idx * width, width);
+    }
+  }
+  to->SetSize(selection.GetCount());
+}
+
+/** Consume the morsels of the pipeline of the child, a copy of it per worker. @return false if it has none */
+auto ConsumeMorsels(TaskScheduler *scheduler, Operator *child,
+                    const std::function<void(const DataChunk &chunk, size_t thread_idx)> &consume) -> bool {
+  size_t num_workers = scheduler->GetWorkerCount();
+  std::vector<std::unique_ptr<Operator>> pipelines;
+  std::vector<DataChunk> chunks;
+  for (size_t i = 0; i < num_workers; i++) {
+    pipelines.push_back(child->MakeWorker());
+    if (pipelines.back() == nullptr) {
+      return false;
+    }
+    chunks.push_back(pipelines.back()->MakeChunk());
+  }
+  size_t num_morsels = child->GetMorselCount();
+  TaskGroup group(scheduler);
+  for (size_t morsel_idx = 0; morsel_idx < num_morsels; morsel_idx++) {
+    group.Spawn(morsel_idx * num_workers / num_morsels, [&, morsel_idx](size_t worker_idx) {
+      Operator *pipeline = pipelines[worker_idx].get();
+      DataChunk *chunk = &chunks[worker_idx];
+      pipeline->InitMorsel(morsel_idx);
+      while (!group.HasFailed() && pipeline->Next(chunk)) {
+        consume(*chunk, worker_idx);
+      }
+    });
+  }
+  group.Wait();
+  return true;
+}
+
+/** Pull the child on the calling thread, a task consuming each chunk. */
+void ConsumeChunks(TaskScheduler *scheduler, Operator *child,
+                   const std::function<void(const DataChunk &chunk, size_t thread_idx)> &consume) {
+  std::mutex latch;
+  std::condition_variable cv;
+  std::vector<DataChunk> chunks(2 * scheduler->GetWorkerCount());
+  std::vector<DataChunk *> free_chunks;
+  for (auto &chunk : chunks) {
+    chunk = child->MakeChunk();
+    free_chunks.push_back(&chunk);
+  }
+  DataChunk input = child->MakeChunk();
+  TaskGroup group(scheduler);
+  std::exception_ptr error;
+  try {
+    while (!group.HasFailed() && child->Next(&input)) {
+      DataChunk *chunk;
+      {
+        std::unique_lock lock(latch);
+        cv.wait(lock, [&] { return !free_chunks.empty(); });
+        chunk = free_chunks.back();
+        free_chunks.pop_back();
+      }
+      CopySelected(input, chunk);
+      group.Spawn([&, chunk](size_t worker_idx) {
+        std::exception_ptr task_error;
+        try {
+          consume(*chunk, worker_idx);
+        } catch (...) {
+          task_error = std::current_exception();
+        }
+        // the chunk goes back to the pool even on an error, the pulling thread may be waiting for it
+        {
+          std::scoped_lock lock(latch);
+          free_chunks.push_back(chunk);
+        }
+        cv.notify_one();
+        if (task_error != nullptr) {
+          std::rethrow_exception(task_error);
+        }
+      });
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the tasks are waited for before the error of the child is rethrown, they use the chunks of this frame
+  group.Wait();
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace
+
+void ParallelConsume(ExecutorContext *ctx, Operator *child, size_t num_threads,
+                     const std::function<void(const DataChunk &chunk, size_t thread_idx)> &consume) {
+  TaskScheduler *scheduler = ctx->scheduler_;
+  std::optional<TaskScheduler> own;
+  if (scheduler == nullptr) {
+    if (num_threads <= 1) {
+      DataChunk input = child->MakeChunk();
+      while (child->Next(&input)) {
+        consume(input, 0);
+      }
+      return;
+    }
+    own.emplace(num_threads);
+    scheduler = &*own;
+  }
+  if (!ConsumeMorsels(scheduler, child, consume)) {
+    ConsumeChunks(scheduler, child, consume);
+  }
+}
+
+}  // namespace redbase
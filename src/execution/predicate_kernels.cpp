@@ -0,0 +1,620 @@
+#include "execution/predicate_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace redbase {
+
+namespace {
+
+template <ComparisonType OP, typename T>
+inline auto Compare(T a, T b) -> bool {
+  if constexpr (OP == ComparisonType::EQUAL) {
+    return a == b;
+  } else if constexpr (OP == ComparisonType::NOT_EQUAL) {
+    return a != b;
+  } else if constexpr (OP == ComparisonType::LESS_THAN) {
+    return a < b;
+  } else if constexpr (OP == ComparisonType::LESS_EQUAL) {
+    return a <= b;
+  } else if constexpr (OP == ComparisonType::GREATER_THAN) {
+    return a > b;
+  } else {
+    return a >= b;
+  }
+}
+
+// The predicates the kernels are instantiated for. Test() is the scalar form, the vector forms are the Avx2Mask() and
+// Avx512Mask() overloads below.
+
+template <typename T, ComparisonType OP>
+struct ComparePredicate {
+  auto Test(T value) const -> bool { return Compare<OP>(value, constant_); }
+  T constant_;
+};
+
+template <typename T>
+struct BetweenPredicate {
+  auto Test(T value) const -> bool { return (low_ <= value) & (value <= high_); }
+  T low_;
+  T high_;
+};
+
+template <typename T>
+struct InPredicate {
+  auto Test(T value) const -> bool {
+    bool found = false;
+    for (size_t i = 0; i < size_; i++) {
+      found |= list_[i] == value;
+    }
+    return found;
+  }
+  const T *list_;
+  size_t size_;
+};
+
+/** Call `f` with the predicate object of a ColumnPredicate. */
+template <typename T, typename F>
+auto DispatchPredicate(const ColumnPredicate<T> &predicate, F &&f) {
+  switch (predicate.kind_) {
+    case PredicateKind::BETWEEN:
+      return f(BetweenPredicate<T>{predicate.low_, predicate.high_});
+    case PredicateKind::IN:
+      return f(InPredicate<T>{predicate.in_list_.data(), predicate.in_list_.size()});
+    case PredicateKind::COMPARE:
+      break;
+  }
+  switch (predicate.comparison_type_) {
+    case ComparisonType::EQUAL:
+      return f(ComparePredicate<T, ComparisonType::EQUAL>{predicate.low_});
+    case ComparisonType::NOT_EQUAL:
+      return f(ComparePredicate<T, ComparisonType::NOT_EQUAL>{predicate.low_});
+    case ComparisonType::LESS_THAN:
+      return f(ComparePredicate<T, ComparisonType::LESS_THAN>{predicate.low_});
+    case ComparisonType::LESS_EQUAL:
+      return f(ComparePredicate<T, ComparisonType::LESS_EQUAL>{predicate.low_});
+    case ComparisonType::GREATER_THAN:
+      return f(ComparePredicate<T, ComparisonType::GREATER_THAN>{predicate.low_});
+    case ComparisonType::GREATER_EQUAL:
+      break;
+  }
+  return f(ComparePredicate<T, ComparisonType::GREATER_EQUAL>{predicate.low_});
+}
+
+/**
+ * The selection positions [begin, count), one row at a time and without a branch: every row is written to the output,
+ * which only advances past the rows kept. `kept` rows are in the output already.
+ */
+template <bool DENSE, typename T, typename Pred>
+auto SelectScalar(const Pred &pred, const T *data, const uint8_t *nulls, const uint32_t *selection, size_t begin,
+                  size_t count, uint32_t *out, size_t kept) -> size_t {
+  for (size_t i = begin; i < count; i++) {
+    uint32_t row = DENSE ? static_cast<uint32_t>(i) : selection[i];
+    bool keep = (nulls[row] == 0) & pred.Test(data[row]);
+    out[kept] = row;
+    kept += keep ? 1 : 0;
+  }
+  return kept;
+}
+
+/** The rows [begin, count) into a bitmap whose bits are cleared. */
+template <typename T, typename Pred>
+void BitmapScalar(const Pred &pred, const T *data, const uint8_t *nulls, size_t begin, size_t count,
+                  uint64_t *bitmap) {
+  for (size_t i = begin; i < count; i++) {
+    auto bit = static_cast<uint64_t>((nulls[i] == 0) & pred.Test(data[i]));
+    bitmap[i / 64] |= bit << (i % 64);
+  }
+}
+
+#if defined(__x86_64__)
+
+// Every function below that uses vector instructions carries the target attribute of its instruction set, so that
+// the file builds without -mavx2 and the kernels are only entered once GetSelectKernel() has checked the CPU. The
+// gathers go through the masked forms with a zeroed source, which all lanes overwrite.
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512vl")))
+
+/** For every mask of 8 lanes, the permutation that moves the lanes set in the mask to the front, in order. */
+constexpr auto MakeCompressTable() -> std::array<std::array<uint32_t, 8>, 256> {
+  std::array<std::array<uint32_t, 8>, 256> table{};
+  for (uint32_t mask = 0; mask < 256; mask++) {
+    uint32_t k = 0;
+    for (uint32_t lane = 0; lane < 8; lane++) {
+      if (((mask >> lane) & 1) != 0) {
+        table[mask][k++] = lane;
+      }
+    }
+  }
+  return table;
+}
+
+alignas(32) constexpr auto COMPRESS_TABLE = MakeCompressTable();
+
+/** @return bit j set if row j of the LANES rows starting at `nulls` is not NULL, LANES <= 8 */
+template <size_t LANES>
+TARGET_AVX2 inline auto ValidDense(const uint8_t *nulls) -> uint32_t {
+  uint64_t bytes = 0;
+  memcpy(&bytes, nulls, LANES);
+  __m128i flags = _mm_cvtsi64_si128(static_cast<int64_t>(bytes));
+  auto zero = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(flags, _mm_setzero_si128())));
+  return zero & ((1U << LANES) - 1);
+}
+
+/** @return bit j set if the row rows[j] is not NULL */
+template <size_t LANES>
+inline auto ValidSparse(const uint8_t *nulls, const uint32_t *rows) -> uint32_t {
+  uint32_t valid = 0;
+  for (size_t j = 0; j < LANES; j++) {
+    valid |= static_cast<uint32_t>(nulls[rows[j]] == 0) << j;
+  }
+  return valid;
+}
+
+constexpr auto DoubleImm(ComparisonType comparison_type) -> int {
+  switch (comparison_type) {
+    case ComparisonType::EQUAL:
+      return _CMP_EQ_OQ;
+    case ComparisonType::NOT_EQUAL:
+      // true when either side is NaN, like the scalar operator
+      return _CMP_NEQ_UQ;
+    case ComparisonType::LESS_THAN:
+      return _CMP_LT_OQ;
+    case ComparisonType::LESS_EQUAL:
+      return _CMP_LE_OQ;
+    case ComparisonType::GREATER_THAN:
+      return _CMP_GT_OQ;
+    case ComparisonType::GREATER_EQUAL:
+      break;
+  }
+  return _CMP_GE_OQ;
+}
+
+constexpr auto IntImm(ComparisonType comparison_type) -> int {
+  switch (comparison_type) {
+    case ComparisonType::EQUAL:
+      return _MM_CMPINT_EQ;
+    case ComparisonType::NOT_EQUAL:
+      return _MM_CMPINT_NE;
+    case ComparisonType::LESS_THAN:
+      return _MM_CMPINT_LT;
+    case ComparisonType::LESS_EQUAL:
+      return _MM_CMPINT_LE;
+    case ComparisonType::GREATER_THAN:
+      return _MM_CMPINT_NLE;
+    case ComparisonType::GREATER_EQUAL:
+      break;
+  }
+  return _MM_CMPINT_NLT;
+}
+
+/** AVX2 integers only compare for equality and greater than, the other comparisons are derived from those. */
+template <typename V, ComparisonType OP>
+TARGET_AVX2 inline auto Avx2IntCompare(typename V::Reg a, typename V::Reg b) -> uint32_t {
+  constexpr uint32_t ALL = (1U << V::LANES) - 1;
+  if constexpr (OP == ComparisonType::EQUAL) {
+    return V::Eq(a, b);
+  } else if constexpr (OP == ComparisonType::NOT_EQUAL) {
+    return ~V::Eq(a, b) & ALL;
+  } else if constexpr (OP == ComparisonType::LESS_THAN) {
+    return V::Gt(b, a);
+  } else if constexpr (OP == ComparisonType::LESS_EQUAL) {
+    return ~V::Gt(a, b) & ALL;
+  } else if constexpr (OP == ComparisonType::GREATER_THAN) {
+    return V::Gt(a, b);
+  } else {
+    return ~V::Gt(b, a) & ALL;
+  }
+}
+
+template <typename T>
+struct Avx2;
+
+template <>
+struct Avx2<int32_t> {
+  static constexpr size_t LANES = 8;
+  using Reg = __m256i;
+
+  static TARGET_AVX2 auto Set1(int32_t value) -> Reg { return _mm256_set1_epi32(value); }
+  static TARGET_AVX2 auto Load(const int32_t *data) -> Reg {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+  }
+  static TARGET_AVX2 auto Gather(const int32_t *data, __m256i rows) -> Reg {
+    return _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), data, rows, _mm256_set1_epi32(-1), 4);
+  }
+  static TARGET_AVX2 auto Eq(Reg a, Reg b) -> uint32_t { return Movemask(_mm256_cmpeq_epi32(a, b)); }
+  static TARGET_AVX2 auto Gt(Reg a, Reg b) -> uint32_t { return Movemask(_mm256_cmpgt_epi32(a, b)); }
+  static TARGET_AVX2 auto Movemask(Reg mask) -> uint32_t {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+  }
+  template <ComparisonType OP>
+  static TARGET_AVX2 auto Compare(Reg a, Reg b) -> uint32_t {
+    return Avx2IntCompare<Avx2, OP>(a, b);
+  }
+};
+
+template <>
+struct Avx2<int64_t> {
+  static constexpr size_t LANES = 4;
+  using Reg = __m256i;
+
+  static TARGET_AVX2 auto Set1(int64_t value) -> Reg { return _mm256_set1_epi64x(value); }
+  static TARGET_AVX2 auto Load(const int64_t *data) -> Reg {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+  }
+  static TARGET_AVX2 auto Gather(const int64_t *data, __m256i rows) -> Reg {
+    return _mm256_mask_i32gather_epi64(_mm256_setzero_si256(), reinterpret_cast<const long long *>(data),  // NOLINT
+                                       _mm256_castsi256_si128(rows), _mm256_set1_epi64x(-1), 8);
+  }
+  static TARGET_AVX2 auto Eq(Reg a, Reg b) -> uint32_t { return Movemask(_mm256_cmpeq_epi64(a, b)); }
+  static TARGET_AVX2 auto Gt(Reg a, Reg b) -> uint32_t { return Movemask(_mm256_cmpgt_epi64(a, b)); }
+  static TARGET_AVX2 auto Movemask(Reg mask) -> uint32_t {
+    return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+  }
+  template <ComparisonType OP>
+  static TARGET_AVX2 auto Compare(Reg a, Reg b) -> uint32_t {
+    return Avx2IntCompare<Avx2, OP>(a, b);
+  }
+};
+
+template <>
+struct Avx2<double> {
+  static constexpr size_t LANES = 4;
+  using Reg = __m256d;
+
+  static TARGET_AVX2 auto Set1(double value) -> Reg { return _mm256_set1_pd(value); }
+  static TARGET_AVX2 auto Load(const double *data) -> Reg { return _mm256_loadu_pd(data); }
+  static TARGET_AVX2 auto Gather(const double *data, __m256i rows) -> Reg {
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), data, _mm256_castsi256_si128(rows),
+                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+  }
+  template <ComparisonType OP>
+  static TARGET_AVX2 auto Compare(Reg a, Reg b) -> uint32_t {
+    constexpr int IMM = DoubleImm(OP);
+    return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, IMM)));
+  }
+};
+
+template <typename T, ComparisonType OP>
+TARGET_AVX2 inline auto Avx2Mask(const ComparePredicate<T, OP> &pred, typename Avx2<T>::Reg values) -> uint32_t {
+  return Avx2<T>::template Compare<OP>(values, Avx2<T>::Set1(pred.constant_));
+}
+
+template <typename T>
+TARGET_AVX2 inline auto Avx2Mask(const BetweenPredicate<T> &pred, typename Avx2<T>::Reg values) -> uint32_t {
+  return Avx2<T>::template Compare<ComparisonType::GREATER_EQUAL>(values, Avx2<T>::Set1(pred.low_)) &
+         Avx2<T>::template Compare<ComparisonType::LESS_EQUAL>(values, Avx2<T>::Set1(pred.high_));
+}
+
+template <typename T>
+TARGET_AVX2 inline auto Avx2Mask(const InPredicate<T> &pred, typename Avx2<T>::Reg values) -> uint32_t {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < pred.size_; i++) {
+    mask |= Avx2<T>::template Compare<ComparisonType::EQUAL>(values, Avx2<T>::Set1(pred.list_[i]));
+  }
+  return mask;
+}
+
+/**
+ * A vector of rows at a time: the values are loaded (or gathered through the selection), compared, and the rows
+ * that pass are packed to the front of a register by a permutation looked up from the mask and stored at once. The
+ * store writes a whole vector of rows, but never past the rows of the selection that were read already.
+ */
+template <bool DENSE, typename T, typename Pred>
+TARGET_AVX2 auto SelectAvx2(const Pred &pred, const T *data, const uint8_t *nulls, const uint32_t *selection,
+                            size_t count, uint32_t *out) -> size_t {
+  using V = Avx2<T>;
+  constexpr size_t LANES = V::LANES;
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  size_t kept = 0;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    __m256i rows;
+    typename V::Reg values;
+    uint32_t valid;
+    if constexpr (DENSE) {
+      rows = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), lanes);
+      values = V::Load(data + i);
+      valid = ValidDense<LANES>(nulls + i);
+    } else {
+      rows = LANES == 8 ? _mm256_loadu_si256(reinterpret_cast<const __m256i *>(selection + i))
+                        : _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(selection + i)));
+      values = V::Gather(data, rows);
+      valid = ValidSparse<LANES>(nulls, selection + i);
+    }
+    uint32_t mask = Avx2Mask(pred, values) & valid;
+    __m256i permutation = _mm256_load_si256(reinterpret_cast<const __m256i *>(COMPRESS_TABLE[mask].data()));
+    __m256i packed = _mm256_permutevar8x32_epi32(rows, permutation);
+    if constexpr (LANES == 8) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + kept), packed);
+    } else {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + kept), _mm256_castsi256_si128(packed));
+    }
+    kept += __builtin_popcount(mask);
+  }
+  return SelectScalar<DENSE>(pred, data, nulls, selection, i, count, out, kept);
+}
+
+template <typename T, typename Pred>
+TARGET_AVX2 void BitmapAvx2(const Pred &pred, const T *data, const uint8_t *nulls, size_t count, uint64_t *bitmap) {
+  constexpr size_t LANES = Avx2<T>::LANES;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    uint64_t mask = Avx2Mask(pred, Avx2<T>::Load(data + i)) & ValidDense<LANES>(nulls + i);
+    bitmap[i / 64] |= mask << (i % 64);
+  }
+  BitmapScalar(pred, data, nulls, i, count, bitmap);
+}
+
+template <typename T>
+struct Avx512;
+
+template <>
+struct Avx512<int32_t> {
+  static constexpr size_t LANES = 16;
+  using Reg = __m512i;
+  using Rows = __m512i;
+
+  static TARGET_AVX512 auto Set1(int32_t value) -> Reg { return _mm512_set1_epi32(value); }
+  static TARGET_AVX512 auto Load(const int32_t *data) -> Reg { return _mm512_loadu_si512(data); }
+  static TARGET_AVX512 auto Gather(const int32_t *data, Rows rows) -> Reg {
+    return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xffff, rows, data, 4);
+  }
+  template <ComparisonType OP>
+  static TARGET_AVX512 auto Compare(Reg a, Reg b) -> uint32_t {
+    constexpr int IMM = IntImm(OP);
+    return _mm512_cmp_epi32_mask(a, b, IMM);
+  }
+  static TARGET_AVX512 auto DenseRows(size_t begin) -> Rows {
+    return _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(begin)),
+                            _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+  }
+  static TARGET_AVX512 auto LoadRows(const uint32_t *selection) -> Rows { return _mm512_loadu_si512(selection); }
+  static TARGET_AVX512 void CompressStore(uint32_t *out, uint32_t mask, Rows rows) {
+    _mm512_mask_compressstoreu_epi32(out, static_cast<__mmask16>(mask), rows);
+  }
+};
+
+/** The 8 lanes of the 64-bit types keep their rows in a 256-bit register. */
+struct Avx512Rows8 {
+  using Rows = __m256i;
+
+  static TARGET_AVX512 auto DenseRows(size_t begin) -> Rows {
+    return _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  }
+  static TARGET_AVX512 auto LoadRows(const uint32_t *selection) -> Rows {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(selection));
+  }
+  static TARGET_AVX512 void CompressStore(uint32_t *out, uint32_t mask, Rows rows) {
+    _mm256_mask_compressstoreu_epi32(out, static_cast<__mmask8>(mask), rows);
+  }
+};
+
+template <>
+struct Avx512<int64_t> : Avx512Rows8 {
+  static constexpr size_t LANES = 8;
+  using Reg = __m512i;
+
+  static TARGET_AVX512 auto Set1(int64_t value) -> Reg { return _mm512_set1_epi64(value); }
+  static TARGET_AVX512 auto Load(const int64_t *data) -> Reg { return _mm512_loadu_si512(data); }
+  static TARGET_AVX512 auto Gather(const int64_t *data, Rows rows) -> Reg {
+    return _mm512_mask_i32gather_epi64(_mm512_setzero_si512(), 0xff, rows, data, 8);
+  }
+  template <ComparisonType OP>
+  static TARGET_AVX512 auto Compare(Reg a, Reg b) -> uint32_t {
+    constexpr int IMM = IntImm(OP);
+    return _mm512_cmp_epi64_mask(a, b, IMM);
+  }
+};
+
+template <>
+struct Avx512<double> : Avx512Rows8 {
+  static constexpr size_t LANES = 8;
+  using Reg = __m512d;
+
+  static TARGET_AVX512 auto Set1(double value) -> Reg { return _mm512_set1_pd(value); }
+  static TARGET_AVX512 auto Load(const double *data) -> Reg { return _mm512_loadu_pd(data); }
+  static TARGET_AVX512 auto Gather(const double *data, Rows rows) -> Reg {
+    return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, rows, data, 8);
+  }
+  template <ComparisonType OP>
+  static TARGET_AVX512 auto Compare(Reg a, Reg b) -> uint32_t {
+    constexpr int IMM = DoubleImm(OP);
+    return _mm512_cmp_pd_mask(a, b, IMM);
+  }
+};
+
+template <size_t LANES>
+TARGET_AVX512 inline auto ValidDense512(const uint8_t *nulls) -> uint32_t {
+  if constexpr (LANES == 16) {
+    return _mm_cmpeq_epi8_mask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(nulls)), _mm_setzero_si128());
+  } else {
+    return ValidDense<LANES>(nulls);
+  }
+}
+
+template <typename T, ComparisonType OP>
+TARGET_AVX512 inline auto Avx512Mask(const ComparePredicate<T, OP> &pred, typename Avx512<T>::Reg values)
+    -> uint32_t {
+  return Avx512<T>::template Compare<OP>(values, Avx512<T>::Set1(pred.constant_));
+}
+
+template <typename T>
+TARGET_AVX512 inline auto Avx512Mask(const BetweenPredicate<T> &pred, typename Avx512<T>::Reg values) -> uint32_t {
+  return Avx512<T>::template Compare<ComparisonType::GREATER_EQUAL>(values, Avx512<T>::Set1(pred.low_)) &
+         Avx512<T>::template Compare<ComparisonType::LESS_EQUAL>(values, Avx512<T>::Set1(pred.high_));
+}
+
+template <typename T>
+TARGET_AVX512 inline auto Avx512Mask(const InPredicate<T> &pred, typename Avx512<T>::Reg values) -> uint32_t {
+  uint32_t mask = 0;
+  for (size_t i = 0; i < pred.size_; i++) {
+    mask |= Avx512<T>::template Compare<ComparisonType::EQUAL>(values, Avx512<T>::Set1(pred.list_[i]));
+  }
+  return mask;
+}
+
+/** Like SelectAvx2(), the comparisons yield mask registers and the rows kept are written by a compressing store. */
+template <bool DENSE, typename T, typename Pred>
+TARGET_AVX512 auto SelectAvx512(const Pred &pred, const T *data, const uint8_t *nulls, const uint32_t *selection,
+                                size_t count, uint32_t *out) -> size_t {
+  using V = Avx512<T>;
+  constexpr size_t LANES = V::LANES;
+  size_t kept = 0;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    typename V::Rows rows;
+    typename V::Reg values;
+    uint32_t valid;
+    if constexpr (DENSE) {
+      rows = V::DenseRows(i);
+      values = V::Load(data + i);
+      valid = ValidDense512<LANES>(nulls + i);
+    } else {
+      rows = V::LoadRows(selection + i);
+      values = V::Gather(data, rows);
+      valid = ValidSparse<LANES>(nulls, selection + i);
+    }
+    uint32_t mask = Avx512Mask(pred, values) & valid;
+    V::CompressStore(out + kept, mask, rows);
+    kept += __builtin_popcount(mask);
+  }
+  return SelectScalar<DENSE>(pred, data, nulls, selection, i, count, out, kept);
+}
+
+template <typename T, typename Pred>
+TARGET_AVX512 void BitmapAvx512(const Pred &pred, const T *data, const uint8_t *nulls, size_t count,
+                                uint64_t *bitmap) {
+  constexpr size_t LANES = Avx512<T>::LANES;
+  size_t i = 0;
+  for (; i + LANES <= count; i += LANES) {
+    uint64_t mask = Avx512Mask(pred, Avx512<T>::Load(data + i)) & ValidDense512<LANES>(nulls + i);
+    bitmap[i / 64] |= mask << (i % 64);
+  }
+  BitmapScalar(pred, data, nulls, i, count, bitmap);
+}
+
+#endif
+
+template <bool DENSE, typename T, typename Pred>
+auto Select(SelectKernel kernel, const Pred &pred, const T *data, const uint8_t *nulls, const uint32_t *selection,
+            size_t count, uint32_t *out) -> size_t {
+#if defined(__x86_64__)
+  switch (kernel) {
+    case SelectKernel::AVX512:
+      return SelectAvx512<DENSE>(pred, data, nulls, selection, count, out);
+    case SelectKernel::AVX2:
+      return SelectAvx2<DENSE>(pred, data, nulls, selection, count, out);
+    case SelectKernel::SCALAR:
+      break;
+  }
+#endif
+  return SelectScalar<DENSE>(pred, data, nulls, selection, 0, count, out, 0);
+}
+
+}  // namespace
+
+auto FlipComparison(ComparisonType comparison_type) -> ComparisonType {
+  switch (comparison_type) {
+    case ComparisonType::LESS_THAN:
+      return ComparisonType::GREATER_THAN;
+    case ComparisonType::LESS_EQUAL:
+      return ComparisonType::GREATER_EQUAL;
+    case ComparisonType::GREATER_THAN:
+      return ComparisonType::LESS_THAN;
+    case ComparisonType::GREATER_EQUAL:
+      return ComparisonType::LESS_EQUAL;
+    default:
+      return comparison_type;
+  }
+}
+
+auto GetSelectKernel() -> SelectKernel {
+  static const SelectKernel KERNEL = [] {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl")) {
+      return SelectKernel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return SelectKernel::AVX2;
+    }
+#endif
+    return SelectKernel::SCALAR;
+  }();
+  return KERNEL;
+}
+
+auto SelectKernelName(SelectKernel kernel) -> const char * {
+  switch (kernel) {
+    case SelectKernel::SCALAR:
+      return "scalar";
+    case SelectKernel::AVX2:
+      return "avx2";
+    case SelectKernel::AVX512:
+      return "avx512";
+  }
+  return "unknown";
+}
+
+template <typename T>
+auto SelectRows(const ColumnPredicate<T> &predicate, const T *data, const uint8_t *nulls, const uint32_t *selection,
+                size_t count, uint32_t *out, SelectKernel kernel) -> size_t {
+  return DispatchPredicate(predicate, [&](const auto &pred) {
+    return selection == nullptr ? Select<true>(kernel, pred, data, nulls, selection, count, out)
+                                : Select<false>(kernel, pred, data, nulls, selection, count, out);
+  });
+}
+
+template <typename T>
+void SelectBitmap(const ColumnPredicate<T> &predicate, const T *data, const uint8_t *nulls, size_t count,
+                  uint64_t *bitmap, SelectKernel kernel) {
+  std::fill(bitmap, bitmap + (count + 63) / 64, 0);
+  DispatchPredicate(predicate, [&](const auto &pred) {
+#if defined(__x86_64__)
+    switch (kernel) {
+      case SelectKernel::AVX512:
+        return BitmapAvx512(pred, data, nulls, count, bitmap);
+      case SelectKernel::AVX2:
+        return BitmapAvx2(pred, data, nulls, count, bitmap);
+      case SelectKernel::SCALAR:
+        break;
+    }
+#endif
+    BitmapScalar(pred, data, nulls, 0, count, bitmap);
+  });
+}
+
+auto BitmapToSelection(const uint64_t *bitmap, size_t count, uint32_t *out) -> size_t {
+  size_t kept = 0;
+  for (size_t word = 0; word < (count + 63) / 64; word++) {
+    uint64_t bits = bitmap[word];
+    while (bits != 0) {
+      out[kept++] = static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits));
+      bits &= bits - 1;
+    }
+  }
+  return kept;
+}
+
+template auto SelectRows(const ColumnPredicate<int32_t> &, const int32_t *, const uint8_t *, const uint32_t *, size_t,
+                         uint32_t *, SelectKernel) -> size_t;
+template auto SelectRows(const ColumnPredicate<int64_t> &, const int64_t *, const uint8_t *, const uint32_t *, size_t,
+                         uint32_t *, SelectKernel) -> size_t;
+template auto SelectRows(const ColumnPredicate<double> &, const double *, const uint8_t *, const uint32_t *, size_t,
+                         uint32_t *, SelectKernel) -> size_t;
+template void SelectBitmap(const ColumnPredicate<int32_t> &, const int32_t *, const uint8_t *, size_t, uint64_t *,
+                           SelectKernel);
+template void SelectBitmap(const ColumnPredicate<int64_t> &, const int64_t *, const uint8_t *, size_t, uint64_t *,
+                           SelectKernel);
+template void SelectBitmap(const ColumnPredicate<double> &, const double *, const uint8_t *, size_t, uint64_t *,
+                           SelectKernel);
+
+}  // namespace redbase
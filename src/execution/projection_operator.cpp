@@ -0,0 +1,65 @@
+#include "execution/projection_operator.h"
+
+#include "execution/compiled_expression.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+auto ProjectionColumns(const Schema &input_schema, const std::vector<ExpressionRef> &expressions)
+    -> std::vector<Column> {
+  std::vector<Column> columns;
+  for (size_t i = 0; i < expressions.size(); i++) {
+    if (const auto *column_ref = dynamic_cast<const ColumnRefExpression *>(expressions[i].get())) {
+      columns.push_back(input_schema.GetColumn(column_ref->GetColIdx()));
+    } else {
+      columns.emplace_back(fmt::format("expr{}", i), expressions[i]->GetReturnType());
+    }
+  }
+  return columns;
+}
+
+}  // namespace
+
+ProjectionOperator::ProjectionOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child,
+                                       std::vector<ExpressionRef> expressions)
+    : Operator(ctx, Schema(ProjectionColumns(child->GetOutputSchema(), expressions))),
+      child_(std::move(child)),
+      expressions_(std::move(expressions)) {
+  if (ctx->compile_expressions_) {
+    for (auto &expression : expressions_) {
+      expression = CompileExpression(expression);
+    }
+  }
+}
+
+void ProjectionOperator::Init() {
+  child_->Init();
+  input_ = child_->MakeChunk();
+}
+
+auto ProjectionOperator::MakeWorker() -> std::unique_ptr<Operator> {
+  auto child = child_->MakeWorker();
+  if (child == nullptr) {
+    return nullptr;
+  }
+  auto worker = std::make_unique<ProjectionOperator>(ctx_, std::move(child), expressions_);
+  worker->input_ = worker->child_->MakeChunk();
+  return worker;
+}
+
+void ProjectionOperator::InitMorsel(size_t morsel_idx) { child_->InitMorsel(morsel_idx); }
+
+auto ProjectionOperator::Next(DataChunk *chunk) -> bool {
+  if (!child_->Next(&input_)) {
+    return false;
+  }
+  for (size_t i = 0; i < expressions_.size(); i++) {
+    expressions_[i]->Evaluate(input_, &chunk->GetColumn(i));
+  }
+  chunk->SetSize(input_.GetSize(), input_.GetSelection());
+  return true;
+}
+
+}  // namespace redbase
@@ -0,0 +1,59 @@
+#include "execution/row_layout.h"
+
+#include <cstring>
+
+namespace redbase {
+
+namespace {
+
+/** Copy a column of rows (its NULL flag at byte `col_idx`, its value at `offset`). WIDTH 0 for any width. */
+template <uint32_t WIDTH>
+void GatherColumn(const char *const *rows, size_t count, size_t col_idx, uint32_t offset, uint32_t width, char *to,
+                  uint8_t *to_nulls) {
+  uint32_t w = WIDTH == 0 ? width : WIDTH;
+  for (size_t i = 0; i < count; i++) {
+    to_nulls[i] = static_cast<uint8_t>(rows[i][col_idx]);
+    memcpy(to + i * w, rows[i] + offset, WIDTH == 0 ? width : WIDTH);
+  }
+}
+
+}  // namespace
+
+RowLayout::RowLayout(const Schema &schema) {
+  size_ = schema.GetColumnCount();
+  for (const auto &column : schema.GetColumns()) {
+    offsets_.push_back(size_);
+    widths_.push_back(column.GetLength());
+    size_ += column.GetLength();
+  }
+}
+
+void RowLayout::Store(const DataChunk &chunk, uint32_t row, char *out) const {
+  for (size_t col = 0; col < widths_.size(); col++) {
+    const Vector &vector = chunk.GetColumn(col);
+    size_t idx = vector.IsConstant() ? 0 : row;
+    out[col] = static_cast<char>(vector.GetNulls()[idx]);
+    memcpy(out + offsets_[col], vector.GetData() + idx * widths_[col], widths_[col]);
+  }
+}
+
+void RowLayout::Load(const char *in, DataChunk *chunk, size_t row, size_t first_col) const {
+  for (size_t col = 0; col < widths_.size(); col++) {
+    Vector &vector = chunk->GetColumn(first_col + col);
+    vector.GetNulls()[row] = static_cast<uint8_t>(in[col]);
+    memcpy(vector.GetData() + row * widths_[col], in + offsets_[col], widths_[col]);
+  }
+}
+
+void RowLayout::Gather(const char *const *rows, size_t count, DataChunk *chunk, size_t first_row,
+                       size_t first_col) const {
+  for (size_t col = 0; col < widths_.size(); col++) {
+    Vector &to = chunk->GetColumn(first_col + col);
+    DispatchWidth(widths_[col], [&](auto fixed_width) {
+      GatherColumn<fixed_width.value>(rows, count, col, offsets_[col], widths_[col],
+                                      to.GetData() + first_row * widths_[col], to.GetNulls() + first_row);
+    });
+  }
+}
+
+}  // namespace redbase
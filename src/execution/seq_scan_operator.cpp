@@ -0,0 +1,317 @@
+#include "execution/seq_scan_operator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "execution/predicate_kernels.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+auto ScanColumns(const Schema *table_schema, const std::vector<uint32_t> &column_idxs) -> std::vector<Column> {
+  std::vector<Column> columns;
+  for (uint32_t col_idx : column_idxs) {
+    if (col_idx >= table_schema->GetColumnCount()) {
+      throw Exception(fmt::format("column {} out of range, the table has {} columns", col_idx,
+                                  table_schema->GetColumnCount()));
+    }
+    columns.push_back(table_schema->GetColumn(col_idx));
+  }
+  return columns;
+}
+
+/** Copy a column of the tuples into a vector. A fixed width lets the compiler turn the copy into a single move. */
+template <uint32_t WIDTH>
+void DecodeColumn(const std::vector<TupleView> &batch, uint32_t offset, uint32_t width, char *out) {
+  if constexpr (WIDTH == 0) {
+    for (size_t i = 0; i < batch.size(); i++) {
+      memcpy(out + i * width, batch[i].data_ + offset, width);
+    }
+  } else {
+    for (size_t i = 0; i < batch.size(); i++) {
+      memcpy(out + i * WIDTH, batch[i].data_ + offset, WIDTH);
+    }
+  }
+}
+
+template <typename T>
+auto ConstantOf(const Value &value) -> T {
+  if constexpr (std::is_floating_point_v<T>) {
+    return value.GetAsDouble();
+  } else {
+    return static_cast<T>(value.GetAsInteger());
+  }
+}
+
+/** Keep the rows of a selection whose value is within the bounds of a range. @return the number of rows kept */
+template <typename T>
+auto SelectInRange(const ColumnRange &range, const Vector &column, uint32_t *rows, size_t count) -> size_t {
+  const T *data = column.GetData<T>();
+  if (range.lower_.has_value()) {
+    auto comparison = range.lower_inclusive_ ? ComparisonType::GREATER_EQUAL : ComparisonType::GREATER_THAN;
+    count = SelectRows(ColumnPredicate<T>::Compare(comparison, ConstantOf<T>(*range.lower_)), data,
+                       column.GetNulls(), rows, count, rows);
+  }
+  if (range.upper_.has_value()) {
+    auto comparison = range.upper_inclusive_ ? ComparisonType::LESS_EQUAL : ComparisonType::LESS_THAN;
+    count = SelectRows(ColumnPredicate<T>::Compare(comparison, ConstantOf<T>(*range.upper_)), data,
+                       column.GetNulls(), rows, count, rows);
+  }
+  return count;
+}
+
+}  // namespace
+
+SeqScanOperator::SeqScanOperator(ExecutorContext *ctx, TableHeap *heap, const Schema *table_schema,
+                                 std::vector<uint32_t> column_idxs)
+    : Operator(ctx, Schema(ScanColumns(table_schema, column_idxs))),
+      heap_(heap),
+      table_schema_(table_schema),
+      column_idxs_(std::move(column_idxs)) {}
+
+SeqScanOperator::~SeqScanOperator() { CloseIterator(); }
+
+void SeqScanOperator::Init() {
+  iter_.reset();
+  stats_->pages_skipped_ = 0;
+  stats_->rows_filtered_ = 0;
+  stats_->tuples_filtered_ = 0;
+  page_count_ = heap_->GetPageCount();
+  Open(0, SIZE_MAX);
+}
+
+auto SeqScanOperator::MakeWorker() -> std::unique_ptr<Operator> {
+  auto worker = std::make_unique<SeqScanOperator>(ctx_, heap_, table_schema_, column_idxs_);
+  worker->SetDynamicFilter(filter_);
+  worker->pushed_ = pushed_;
+  worker->page_count_ = page_count_;
+  worker->stats_ = stats_;
+  return worker;
+}
+
+auto SeqScanOperator::GetMorselCount() const -> size_t { return (page_count_ + MORSEL_PAGES - 1) / MORSEL_PAGES; }
+
+void SeqScanOperator::InitMorsel(size_t morsel_idx) {
+  size_t begin = morsel_idx * MORSEL_PAGES;
+  Open(begin, std::min(begin + MORSEL_PAGES, page_count_));
+}
+
+void SeqScanOperator::Open(size_t begin, size_t end) {
+  ScanOptions options;
+  options.batch_size_ = ctx_->batch_size_;
+  if (filter_ != nullptr || !pushed_.empty()) {
+    options.zone_map_ = heap_->GetZoneMap();
+  }
+  if (filter_ != nullptr) {
+    options.dynamic_filter_ = filter_.get();
+  }
+  if (!pushed_.empty()) {
+    options.ranges_ = pushed_;
+    options.schema_ = table_schema_;
+  }
+  filter_version_ = 0;
+  // the previous iterator releases its pages before the new one starts
+  CloseIterator();
+  iter_.emplace(heap_->MakeScanIterator(begin, end, options));
+  batch_.reserve(ctx_->batch_size_);
+}
+
+auto SeqScanOperator::Next(DataChunk *chunk) -> bool {
+  if (chunk->GetCapacity() < ctx_->batch_size_) {
+    throw Exception(fmt::format("chunk of {} rows, the scan reads batches of {}", chunk->GetCapacity(),
+                                ctx_->batch_size_));
+  }
+  do {
+    if (!iter_.has_value()) {
+      return false;
+    }
+    if (!iter_->NextBatch(&batch_)) {
+      // release the pages and the hold of the compaction latch now, not when the operator goes away
+      CloseIterator();
+      return false;
+    }
+    DecodeBatch(chunk);
+    ApplyDynamicFilter(chunk);
+  } while (chunk->GetSelectedCount() == 0);
+  return true;
+}
+
+void SeqScanOperator::DecodeBatch(DataChunk *chunk) {
+  for (uint32_t i = 0; i < column_idxs_.size(); i++) {
+    uint32_t col_idx = column_idxs_[i];
+    Vector &vector = chunk->GetColumn(i);
+    uint8_t *nulls = vector.GetNulls();
+    for (size_t row = 0; row < batch_.size(); row++) {
+      nulls[row] = table_schema_->IsNull(batch_[row].data_, col_idx) ? 1 : 0;
+    }
+    uint32_t offset = table_schema_->GetOffset(col_idx);
+    switch (vector.GetWidth()) {
+      case 4:
+        DecodeColumn<4>(batch_, offset, 4, vector.GetData());
+        break;
+      case 8:
+        DecodeColumn<8>(batch_, offset, 8, vector.GetData());
+        break;
+      default:
+        DecodeColumn<0>(batch_, offset, vector.GetWidth(), vector.GetData());
+        break;
+    }
+  }
+  chunk->SetSize(batch_.size());
+}
+
+void SeqScanOperator::CloseIterator() {
+  if (iter_.has_value()) {
+    stats_->pages_skipped_ += iter_->GetPagesSkipped();
+    stats_->tuples_filtered_ += iter_->GetTuplesFiltered();
+    iter_.reset();
+  }
+}
+
+void SeqScanOperator::PushPredicate(ColumnRange range) {
+  if (range.column_idx_ >= table_schema_->GetColumnCount() ||
+      !IsNumeric(table_schema_->GetColumn(range.column_idx_).GetType())) {
+    throw Exception(fmt::format("cannot push a range on column {} into the scan", range.column_idx_));
+  }
+  pushed_.push_back(std::move(range));
+}
+
+auto SeqScanOperator::PushDown(const ExpressionRef &predicate) -> ExpressionRef {
+  std::vector<ExpressionRef> conjuncts;
+  if (dynamic_cast<const ConjunctionExpression *>(predicate.get()) != nullptr) {
+    conjuncts = predicate->GetChildren();
+  } else {
+    conjuncts.push_back(predicate);
+  }
+  std::vector<ExpressionRef> rest;
+  for (const auto &conjunct : conjuncts) {
+    if (auto range = MatchRange(conjunct)) {
+      PushPredicate(*std::move(range));
+    } else {
+      rest.push_back(conjunct);
+    }
+  }
+  if (rest.empty()) {
+    return nullptr;
+  }
+  if (rest.size() == conjuncts.size()) {
+    return predicate;
+  }
+  return rest.size() == 1 ? rest[0] : std::make_shared<ConjunctionExpression>(std::move(rest));
+}
+
+auto SeqScanOperator::MatchRange(const ExpressionRef &conjunct) const -> std::optional<ColumnRange> {
+  auto table_column = [this](const ExpressionRef &expression) -> std::optional<uint32_t> {
+    const auto *column = dynamic_cast<const ColumnRefExpression *>(expression.get());
+    if (column == nullptr || column->GetColIdx() >= column_idxs_.size() ||
+        !IsNumeric(GetOutputSchema().GetColumn(column->GetColIdx()).GetType())) {
+      return std::nullopt;
+    }
+    return column_idxs_[column->GetColIdx()];
+  };
+  ColumnRange range;
+  if (const auto *between = dynamic_cast<const BetweenExpression *>(conjunct.get())) {
+    auto col_idx = table_column(between->GetChildren()[0]);
+    if (!col_idx.has_value() || between->GetLow().IsNull() || between->GetHigh().IsNull()) {
+      return std::nullopt;
+    }
+    range.column_idx_ = *col_idx;
+    range.lower_ = between->GetLow();
+    range.upper_ = between->GetHigh();
+    return range;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(conjunct.get());
+  if (comparison == nullptr || comparison->GetComparisonType() == ComparisonType::NOT_EQUAL) {
+    return std::nullopt;
+  }
+  const auto &children = comparison->GetChildren();
+  for (int left = 0; left < 2; left++) {
+    auto col_idx = table_column(children[left]);
+    const auto *constant = dynamic_cast<const ConstantExpression *>(children[1 - left].get());
+    if (!col_idx.has_value() || constant == nullptr || constant->GetValue().IsNull()) {
+      continue;
+    }
+    range.column_idx_ = *col_idx;
+    const Value &value = constant->GetValue();
+    ComparisonType comparison_type =
+        left == 0 ? comparison->GetComparisonType() : FlipComparison(comparison->GetComparisonType());
+    switch (comparison_type) {
+      case ComparisonType::EQUAL:
+        range.lower_ = value;
+        range.upper_ = value;
+        break;
+      case ComparisonType::LESS_THAN:
+      case ComparisonType::LESS_EQUAL:
+        range.upper_ = value;
+        range.upper_inclusive_ = comparison_type == ComparisonType::LESS_EQUAL;
+        break;
+      default:
+        range.lower_ = value;
+        range.lower_inclusive_ = comparison_type == ComparisonType::GREATER_EQUAL;
+        break;
+    }
+    return range;
+  }
+  return std::nullopt;
+}
+
+void SeqScanOperator::SetDynamicFilter(std::shared_ptr<const DynamicFilter> filter) {
+  filter_ = std::move(filter);
+  filter_output_idx_.reset();
+  if (filter_ == nullptr) {
+    return;
+  }
+  auto iter = std::find(column_idxs_.begin(), column_idxs_.end(), filter_->GetColumnIdx());
+  if (iter != column_idxs_.end() && IsNumeric(table_schema_->GetColumn(*iter).GetType())) {
+    filter_output_idx_ = iter - column_idxs_.begin();
+  }
+}
+
+void SeqScanOperator::ApplyDynamicFilter(DataChunk *chunk) {
+  if (!filter_output_idx_.has_value() || filter_->GetVersion() == 0) {
+    return;
+  }
+  if (filter_->GetVersion() != filter_version_) {
+    filter_version_ = filter_->GetVersion();
+    filter_range_ = filter_->GetRange();
+  }
+  const Vector &column = chunk->GetColumn(*filter_output_idx_);
+  SelectionVector &selection = chunk->GetSelection();
+  size_t count = selection.GetCount();
+  null_rows_.clear();
+  if (filter_range_.include_nulls_) {
+    for (size_t i = 0; i < count; i++) {
+      if (column.GetNulls()[selection[i]] != 0) {
+        null_rows_.push_back(selection[i]);
+      }
+    }
+  }
+  size_t kept;
+  switch (column.GetType()) {
+    case TypeId::INTEGER:
+    case TypeId::DATE:
+      kept = SelectInRange<int32_t>(filter_range_, column, selection.GetData(), count);
+      break;
+    case TypeId::BIGINT:
+      kept = SelectInRange<int64_t>(filter_range_, column, selection.GetData(), count);
+      break;
+    default:
+      kept = SelectInRange<double>(filter_range_, column, selection.GetData(), count);
+      break;
+  }
+  if (!null_rows_.empty()) {
+    merged_rows_.resize(kept + null_rows_.size());
+    std::merge(selection.GetData(), selection.GetData() + kept, null_rows_.begin(), null_rows_.end(),
+               merged_rows_.begin());
+    std::copy(merged_rows_.begin(), merged_rows_.end(), selection.GetData());
+    kept = merged_rows_.size();
+  }
+  stats_->rows_filtered_.fetch_add(count - kept, std::memory_order_relaxed);
+  selection.SetCount(kept);
+}
+
+}  // namespace redbase
@@ -0,0 +1,113 @@
+#include "execution/sort_key.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+/** The normalized bits of an integer: sign bit flipped, so that unsigned order is signed order. */
+template <typename T>
+inline auto IntegerBits(const char *value) -> uint64_t {
+  T v;
+  memcpy(&v, value, sizeof(T));
+  return static_cast<uint64_t>(static_cast<std::make_unsigned_t<T>>(v)) ^ (uint64_t{1} << (8 * sizeof(T) - 1));
+}
+
+/** The normalized bits of a double: all bits flipped if negative, only the sign bit otherwise. */
+inline auto DoubleBits(const char *value) -> uint64_t {
+  double v;
+  memcpy(&v, value, sizeof(v));
+  if (v == 0) {
+    v = 0;  // -0.0 and 0.0 are equal keys
+  }
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return (bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63);
+}
+
+/**
+ * Encode a numeric column into the records `out`, `out + record_size`, ...: a flag byte then the normalized bits big
+ * endian, every byte xored with `invert`.
+ */
+template <uint32_t WIDTH, typename Bits>
+void EncodeNumbers(const Vector &column, const SelectionVector &selection, Bits bits_of, uint8_t invert, char *out,
+                   size_t stride) {
+  const char *data = column.GetData();
+  const uint8_t *nulls = column.GetNulls();
+  size_t step = column.IsConstant() ? 0 : 1;
+  uint64_t mask = invert == 0 ? 0 : ~uint64_t{0};
+  for (size_t i = 0; i < selection.GetCount(); i++, out += stride) {
+    size_t idx = selection[i] * step;
+    if (nulls[idx] != 0) {
+      memset(out, invert, 1 + WIDTH);
+      continue;
+    }
+    out[0] = static_cast<char>(1 ^ invert);
+    uint64_t bits = (bits_of(data + idx * WIDTH) ^ mask) << (64 - 8 * WIDTH);
+    bits = __builtin_bswap64(bits);
+    memcpy(out + 1, &bits, WIDTH);
+  }
+}
+
+void EncodeChars(const Vector &column, const SelectionVector &selection, uint8_t invert, char *out,
+                 size_t stride) {
+  uint32_t width = column.GetWidth();
+  size_t step = column.IsConstant() ? 0 : 1;
+  for (size_t i = 0; i < selection.GetCount(); i++, out += stride) {
+    size_t idx = selection[i] * step;
+    if (column.GetNulls()[idx] != 0) {
+      memset(out, invert, 1 + width);
+      continue;
+    }
+    out[0] = static_cast<char>(1 ^ invert);
+    memcpy(out + 1, column.GetData() + idx * width, width);
+    if (invert != 0) {
+      for (uint32_t b = 1; b <= width; b++) {
+        out[b] = static_cast<char>(~out[b]);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+SortKeyEncoder::SortKeyEncoder(const Schema &schema, std::vector<SortKey> keys) : keys_(std::move(keys)) {
+  for (const auto &key : keys_) {
+    const Column &column = schema.GetColumn(key.col_idx_);
+    if (column.GetType() == TypeId::INVALID) {
+      throw Exception(fmt::format("sort: column {} cannot be a sort key", column.GetName()));
+    }
+    key_size_ += 1 + column.GetLength();
+  }
+}
+
+void SortKeyEncoder::Encode(const DataChunk &chunk, char *out, size_t stride) const {
+  const SelectionVector &selection = chunk.GetSelection();
+  for (const auto &key : keys_) {
+    const Vector &column = chunk.GetColumn(key.col_idx_);
+    uint8_t invert = key.ascending_ ? 0 : 0xff;
+    switch (column.GetType()) {
+      case TypeId::INTEGER:
+      case TypeId::DATE:
+        EncodeNumbers<4>(column, selection, IntegerBits<int32_t>, invert, out, stride);
+        break;
+      case TypeId::BIGINT:
+        EncodeNumbers<8>(column, selection, IntegerBits<int64_t>, invert, out, stride);
+        break;
+      case TypeId::DOUBLE:
+        EncodeNumbers<8>(column, selection, DoubleBits, invert, out, stride);
+        break;
+      default:
+        EncodeChars(column, selection, invert, out, stride);
+        break;
+    }
+    out += 1 + column.GetWidth();
+  }
+}
+
+}  // namespace redbase
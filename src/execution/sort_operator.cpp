@@ -0,0 +1,177 @@
+#include "execution/sort_operator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace redbase {
+
+namespace {
+
+/** Bytes of the key held by an entry. */
+constexpr uint32_t PREFIX_SIZE = sizeof(uint64_t);
+
+/** @return the first PREFIX_SIZE bytes of a key (zero padded) as an integer, in the same order */
+inline auto PrefixOf(const char *key, uint32_t key_size) -> uint64_t {
+  uint64_t prefix = 0;
+  memcpy(&prefix, key, std::min(key_size, PREFIX_SIZE));
+  return __builtin_bswap64(prefix);
+}
+
+}  // namespace
+
+SortOperator::SortOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, std::vector<SortKey> keys,
+                           BufferPoolManager *bpm, ExternalSortOptions options)
+    : Operator(ctx, child->GetOutputSchema()),
+      child_(std::move(child)),
+      encoder_(child_->GetOutputSchema(), std::move(keys)),
+      bpm_(bpm),
+      options_(options),
+      layout_(GetOutputSchema()) {
+  key_size_ = encoder_.GetKeySize();
+  record_size_ = key_size_ + layout_.GetSize();
+  options_.max_fan_in_ = std::max<size_t>(options_.max_fan_in_, 2);
+  options_.num_threads_ = std::max<size_t>(options_.num_threads_, 1);
+}
+
+void SortOperator::Init() {
+  // the runs of the last Init() delete the pages they have left
+  tree_.reset();
+  runs_.clear();
+  arena_.clear();
+  entries_.clear();
+  entry_pos_ = 0;
+  runs_spilled_ = 0;
+  advance_top_ = false;
+
+  child_->Init();
+  DataChunk chunk = child_->MakeChunk();
+  while (child_->Next(&chunk)) {
+    AppendChunk(chunk);
+    if (arena_.size() + entries_.size() * sizeof(Entry) >= options_.memory_budget_) {
+      SpillRun();
+    }
+  }
+  if (runs_.empty()) {
+    SortEntries();
+    return;
+  }
+  if (!entries_.empty()) {
+    SpillRun();
+  }
+  // intermediate passes merge the oldest runs first, so that every record is rewritten about the same number of times
+  while (runs_.size() > options_.max_fan_in_) {
+    std::vector<SortedRun> inputs(std::make_move_iterator(runs_.begin()),
+                                  std::make_move_iterator(runs_.begin() + options_.max_fan_in_));
+    runs_.erase(runs_.begin(), runs_.begin() + options_.max_fan_in_);
+    runs_.push_back(MergeRuns(&inputs));
+  }
+  OpenMerge(&runs_);
+}
+
+auto SortOperator::Next(DataChunk *chunk) -> bool {
+  size_t count = 0;
+  if (runs_.empty()) {
+    count = std::min(ctx_->batch_size_, entries_.size() - entry_pos_);
+    out_rows_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      out_rows_[i] = RecordAt(entries_[entry_pos_ + i].idx_) + key_size_;
+    }
+    entry_pos_ += count;
+    layout_.Gather(out_rows_.data(), count, chunk, 0, 0);
+  } else {
+    // the head of a run lives in its page buffer until the run moves on, so it is copied row by row
+    const char *record;
+    while (count < ctx_->batch_size_ && (record = NextMerged(&runs_)) != nullptr) {
+      layout_.Load(record + key_size_, chunk, count++, 0);
+    }
+  }
+  chunk->SetSize(count);
+  return count > 0;
+}
+
+void SortOperator::AppendChunk(const DataChunk &chunk) {
+  const SelectionVector &selection = chunk.GetSelection();
+  size_t first = entries_.size();
+  size_t count = selection.GetCount();
+  if (first + count > UINT32_MAX) {
+    throw Exception("sort: too many rows in memory");
+  }
+  arena_.resize(arena_.size() + count * record_size_);
+  encoder_.Encode(chunk, arena_.data() + first * record_size_, record_size_);
+  for (size_t i = 0; i < count; i++) {
+    auto idx = static_cast<uint32_t>(first + i);
+    char *record = arena_.data() + size_t{idx} * record_size_;
+    layout_.Store(chunk, selection[i], record + key_size_);
+    entries_.push_back({PrefixOf(record, key_size_), idx});
+  }
+}
+
+void SortOperator::SortEntries() {
+  const char *arena = arena_.data();
+  uint32_t record_size = record_size_;
+  uint32_t rest = key_size_ > PREFIX_SIZE ? key_size_ - PREFIX_SIZE : 0;
+  auto less = [arena, record_size, rest](const Entry &lhs, const Entry &rhs) {
+    if (lhs.prefix_ != rhs.prefix_ || rest == 0) {
+      return lhs.prefix_ < rhs.prefix_;
+    }
+    return memcmp(arena + size_t{lhs.idx_} * record_size + PREFIX_SIZE,
+                  arena + size_t{rhs.idx_} * record_size + PREFIX_SIZE, rest) < 0;
+  };
+  ParallelSort(&entries_, less, options_.num_threads_, ctx_->scheduler_);
+}
+
+void SortOperator::SpillRun() {
+  SortEntries();
+  SortedRun run(bpm_, record_size_, "sort: run");
+  for (const auto &entry : entries_) {
+    run.Append(RecordAt(entry.idx_));
+  }
+  run.Finish();
+  arena_.clear();
+  entries_.clear();
+  runs_.push_back(std::move(run));
+  runs_spilled_++;
+}
+
+auto SortOperator::RunOrder::operator()(size_t lhs, size_t rhs) const -> bool {
+  const char *left = (*runs_)[lhs].GetHead();
+  const char *right = (*runs_)[rhs].GetHead();
+  return left != nullptr && (right == nullptr || memcmp(left, right, key_size_) < 0);
+}
+
+void SortOperator::OpenMerge(std::vector<SortedRun> *runs) {
+  for (auto &run : *runs) {
+    run.Advance();
+  }
+  tree_.emplace(runs->size(), RunOrder{runs, key_size_});
+  tree_->Build();
+  advance_top_ = false;
+}
+
+auto SortOperator::NextMerged(std::vector<SortedRun> *runs) -> const char * {
+  if (advance_top_) {
+    (*runs)[tree_->Top()].Advance();
+    tree_->Replay();
+  }
+  const char *head = (*runs)[tree_->Top()].GetHead();
+  advance_top_ = head != nullptr;
+  return head;
+}
+
+auto SortOperator::MergeRuns(std::vector<SortedRun> *inputs) -> SortedRun {
+  OpenMerge(inputs);
+  SortedRun output(bpm_, record_size_, "sort: run");
+  const char *record;
+  while ((record = NextMerged(inputs)) != nullptr) {
+    output.Append(record);
+  }
+  output.Finish();
+  runs_spilled_++;
+  return output;
+}
+
+}  // namespace redbase
@@ -0,0 +1,145 @@
+#include "execution/top_n_operator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "execution/parallel_consume.h"
+
+namespace redbase {
+
+TopNOperator::TopNOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, std::vector<SortKey> keys,
+                           size_t limit, size_t offset, TopNOptions options)
+    : Operator(ctx, child->GetOutputSchema()),
+      child_(std::move(child)),
+      encoder_(child_->GetOutputSchema(), std::move(keys)),
+      limit_(limit),
+      offset_(offset),
+      options_(options),
+      layout_(GetOutputSchema()) {
+  key_size_ = encoder_.GetKeySize();
+  record_size_ = key_size_ + layout_.GetSize();
+  options_.num_threads_ = std::max<size_t>(options_.num_threads_, 1);
+}
+
+auto TopNOperator::MakeDynamicFilter(uint32_t column_idx) -> std::shared_ptr<const DynamicFilter> {
+  // NULLs come first in ascending order, they can always get in
+  filter_ = std::make_shared<DynamicFilter>(column_idx, encoder_.GetKeys().front().ascending_);
+  return filter_;
+}
+
+void TopNOperator::Init() {
+  heaps_.assign(ctx_->GetThreadCount(options_.num_threads_), Heap{});
+  size_t capacity = limit_ + offset_;
+  rows_.clear();
+  row_pos_ = 0;
+
+  if (filter_ != nullptr) {
+    filter_->Reset();
+  }
+  child_->Init();
+  if (limit_ > 0) {
+    ParallelConsume(ctx_, child_.get(), options_.num_threads_,
+                    [this](const DataChunk &chunk, size_t thread_idx) { Consume(chunk, &heaps_[thread_idx]); });
+  }
+
+  for (const auto &heap : heaps_) {
+    for (uint32_t idx : heap.order_) {
+      rows_.push_back(RecordAt(heap, idx));
+    }
+  }
+  uint32_t key_size = key_size_;
+  auto less = [key_size](const char *lhs, const char *rhs) { return std::memcmp(lhs, rhs, key_size) < 0; };
+  size_t end = std::min(rows_.size(), capacity);
+  std::partial_sort(rows_.begin(), rows_.begin() + end, rows_.end(), less);
+  rows_.resize(end);
+  row_pos_ = std::min(offset_, end);
+  for (auto &row : rows_) {
+    row += key_size_;
+  }
+}
+
+auto TopNOperator::Next(DataChunk *chunk) -> bool {
+  size_t count = std::min(ctx_->batch_size_, rows_.size() - row_pos_);
+  layout_.Gather(rows_.data() + row_pos_, count, chunk, 0, 0);
+  row_pos_ += count;
+  chunk->SetSize(count);
+  return count > 0;
+}
+
+void TopNOperator::Consume(const DataChunk &chunk, Heap *heap) const {
+  const SelectionVector &selection = chunk.GetSelection();
+  size_t count = selection.GetCount();
+  size_t capacity = limit_ + offset_;
+  heap->keys_.resize(count * key_size_);
+  encoder_.Encode(chunk, heap->keys_.data(), key_size_);
+
+  auto less = [this, heap](uint32_t lhs, uint32_t rhs) {
+    return std::memcmp(RecordAt(*heap, lhs), RecordAt(*heap, rhs), key_size_) < 0;
+  };
+  bool changed = false;
+  for (size_t i = 0; i < count; i++) {
+    const char *key = heap->keys_.data() + i * key_size_;
+    uint32_t idx;
+    if (heap->order_.size() < capacity) {
+      // the records grow with the heap, a large limit over a small input costs no more than the input
+      idx = static_cast<uint32_t>(heap->order_.size());
+      heap->order_.push_back(idx);
+      heap->records_.resize(heap->order_.size() * record_size_);
+    } else if (std::memcmp(key, RecordAt(*heap, heap->order_.front()), key_size_) < 0) {
+      // the worst row makes room: its record is overwritten and sifted back in
+      std::pop_heap(heap->order_.begin(), heap->order_.end(), less);
+      idx = heap->order_.back();
+    } else {
+      continue;
+    }
+    char *record = heap->records_.data() + size_t{idx} * record_size_;
+    std::memcpy(record, key, key_size_);
+    layout_.Store(chunk, selection[i], record + key_size_);
+    std::push_heap(heap->order_.begin(), heap->order_.end(), less);
+    changed = true;
+  }
+  if (changed && filter_ != nullptr && heap->order_.size() == capacity) {
+    Publish(*heap);
+  }
+}
+
+void TopNOperator::Publish(const Heap &heap) const {
+  const SortKey &first = encoder_.GetKeys().front();
+  TypeId type = GetOutputSchema().GetColumn(first.col_idx_).GetType();
+  const char *row = RecordAt(heap, heap.order_.front()) + key_size_;
+  if (!IsNumeric(type) || row[first.col_idx_] != 0) {
+    return;
+  }
+  const char *data = row + layout_.GetOffset(first.col_idx_);
+  Value bound;
+  switch (type) {
+    case TypeId::INTEGER:
+    case TypeId::DATE: {
+      int32_t value;
+      std::memcpy(&value, data, sizeof(value));
+      bound = Value(type, int64_t{value});
+      break;
+    }
+    case TypeId::BIGINT: {
+      int64_t value;
+      std::memcpy(&value, data, sizeof(value));
+      bound = Value(type, value);
+      break;
+    }
+    default: {
+      double value;
+      std::memcpy(&value, data, sizeof(value));
+      bound = Value(value);
+      break;
+    }
+  }
+  // with a single key a row tying with the worst one cannot get in either
+  bool inclusive = encoder_.GetKeys().size() > 1;
+  if (first.ascending_) {
+    filter_->TightenUpper(bound, inclusive);
+  } else {
+    filter_->TightenLower(bound, inclusive);
+  }
+}
+
+}  // namespace redbase
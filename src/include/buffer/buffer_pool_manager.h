@@ -1,8 +1,10 @@
 #pragma once
 
+#include <future>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <set>
 #include <unordered_map>
 
 #include "buffer/lru_k_replacer.h"
@@ -52,9 +54,10 @@ class BufferPoolManager {
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
    * @param[out] page_id id of created page
+   * @param access_type type of access recorded for the new frame
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  auto NewPage(page_id_t *page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
   /**
    *
@@ -65,9 +68,10 @@ class BufferPoolManager {
    * BasicPageGuard structure.
    *
    * @param[out] page_id, the id of the new page
+   * @param access_type type of access recorded for the new frame
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
 
   /**
    *
@@ -82,10 +86,11 @@ class BufferPoolManager {
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
-   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   * @param access_type type of access to the page, Scan accesses are evicted before the hot set
+   * @return nullptr if page_id cannot be fetched (no frame is free, or the page was deallocated), otherwise pointer to
+   * the requested page
    */
-  auto FetchPage(page_id_t page_id) -> Page *;
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
   /**
    *
@@ -97,11 +102,27 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   *
+   * @brief Start reading a page into the buffer pool without waiting for the I/O and without pinning it.
+   *
+   * If the page is already resident (or being read) nothing happens. Otherwise a frame is taken from the free
+   * list or the replacer and a read request is handed to the disk scheduler. The frame is left evictable; a later
+   * FetchPage() of the page waits for the outstanding read instead of issuing a second one, and evicting the frame
+   * waits for the read to land before the frame is reused.
+   *
+   * @param page_id id of page to be read ahead
+   * @param access_type type of access recorded in the replacer, read-ahead is normally on behalf of a scan
+   * @return false if no frame could be found for the page, true otherwise
+   */
+  auto PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Scan) -> bool;
 
   /**
    *
@@ -138,12 +159,12 @@ class BufferPoolManager {
 
   /**
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool and free its page id. If the page is pinned and cannot be deleted,
+   * return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * back to the free list. Also, reset the page's memory and metadata. Finally, DeallocatePage() hands the page id to
+   * the free-page map, so a later NewPage() reuses it. A page that is not resident is only deallocated.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
@@ -155,6 +176,8 @@ class BufferPoolManager {
   const size_t pool_size_;
   /** The next page id to be allocated  */
   std::atomic<page_id_t> next_page_id_ = 0;
+  /** Free-page map: deleted page ids, handed out again (lowest first) before new ones are allocated. */
+  std::set<page_id_t> free_page_ids_;
 
   /** Array of buffer pool pages. */
   Page *pages_;
@@ -169,12 +192,16 @@ class BufferPoolManager {
   
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  
+
+  /** Reads issued by PrefetchPage() that may still be in flight, keyed by page id. */
+  std::unordered_map<page_id_t, std::shared_future<bool>> inflight_reads_;
+
   /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
   std::mutex latch_;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk, reusing a deallocated one if there is any. Caller should acquire the latch
+   * before calling this function.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
@@ -183,9 +210,7 @@ class BufferPoolManager {
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { free_page_ids_.insert(page_id); }
 
   /**
    * Read The Certain Page to data
@@ -201,6 +226,20 @@ class BufferPoolManager {
    */
   void WritePageData(const char *data, page_id_t page_id);
 
+  /**
+   * @brief Find a frame for a new resident page, from the free list first and then from the replacer. A dirty
+   * victim is written back and its page table entry removed. Caller should acquire the latch before calling.
+   * @param[out] frame_id the frame that can be reused
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Wait for a read-ahead of page_id to land, if one is outstanding. Caller should acquire the latch.
+   * @param page_id id of the page
+   */
+  void WaitInflightRead(page_id_t page_id);
+
   void ResetMetaInfo(Page *page, page_id_t page_id) {
     page->ResetMemory();
     page->page_id_ = page_id;
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/sorted_run.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/task_scheduler.h"
+#include "common/util/loser_tree.h"
+
+namespace redbase {
+
+/** Knobs of an external sort. */
+struct ExternalSortOptions {
+  /** Bytes of records buffered in memory before a sorted run is spilled to temp pages. */
+  size_t memory_budget_{64 << 20};
+  /** Threads sorting a buffer before it is spilled. */
+  size_t num_threads_{1};
+  /** Max number of runs merged at once, each of them pins one page during the merge. */
+  size_t max_fan_in_{64};
+};
+
+/** Records below which a slice is not worth a thread of its own. */
+static constexpr size_t MIN_RECORDS_PER_THREAD = 1 << 14;
+
+/**
+ * Sort records in parallel: slices are sorted, then merged pairwise, the merges of a round in parallel. The slices are
+ * tasks of `scheduler`, one per worker, or if it is null run on up to num_threads threads.
+ */
+template <typename T, typename Less>
+void ParallelSort(std::vector<T> *records, const Less &less, size_t num_threads, TaskScheduler *scheduler = nullptr) {
+  if (scheduler != nullptr) {
+    num_threads = scheduler->GetWorkerCount();
+  }
+  size_t num_slices = std::min(num_threads, std::max<size_t>(1, records->size() / MIN_RECORDS_PER_THREAD));
+  if (num_slices <= 1) {
+    std::sort(records->begin(), records->end(), less);
+    return;
+  }
+  std::vector<size_t> bounds;
+  for (size_t i = 0; i <= num_slices; i++) {
+    bounds.push_back(records->size() * i / num_slices);
+  }
+  auto begin = records->begin();
+  ParallelFor(scheduler, num_slices, num_slices,
+              [&](size_t i) { std::sort(begin + bounds[i], begin + bounds[i + 1], less); });
+  for (size_t width = 1; width < num_slices; width *= 2) {
+    std::vector<size_t> firsts;
+    for (size_t i = 0; i + width < num_slices; i += 2 * width) {
+      firsts.push_back(i);
+    }
+    ParallelFor(scheduler, firsts.size(), firsts.size(), [&](size_t merge_idx) {
+      size_t i = firsts[merge_idx];
+      size_t last = std::min(i + 2 * width, num_slices);
+      std::inplace_merge(begin + bounds[i], begin + bounds[i + width], begin + bounds[last], less);
+    });
+  }
+}
+
+/**
+ * ExternalSorter sorts more fixed-size records than fit in memory. Records are buffered up to memory_budget_; a full
+ * buffer is sorted by num_threads_ threads (each sorts a slice, then the slices are merged pairwise) and spilled as a
+ * SortedRun to temp pages of the buffer pool. Once every record has been added, runs are merged max_fan_in_ at a time,
+ * through a LoserTree, until one merge pass can produce the output, which Next() streams in order. Each temp page is
+ * deleted (back to the free-page map) as soon as it has been read, and the next pages of every run are prefetched
+ * while the merge consumes the current one. If everything fits in the budget nothing is spilled.
+ *
+ * @tparam T a trivially copyable record
+ * @tparam Less a strict weak order on T
+ */
+template <typename T, typename Less>
+class ExternalSorter {
+  static_assert(std::is_trivially_copyable_v<T>, "records are copied to and from pages as bytes");
+
+  /** Records of a full run page, about: the buffer holds at least that many. */
+  static constexpr size_t RECORDS_PER_PAGE = PAGE_SIZE / sizeof(T);
+  static_assert(RECORDS_PER_PAGE > 0, "a record must fit into a page");
+
+ public:
+  ExternalSorter(BufferPoolManager *bpm, Less less, ExternalSortOptions options = {})
+      : bpm_(bpm), less_(std::move(less)), options_(options) {
+    buffer_capacity_ = std::max(RECORDS_PER_PAGE, options_.memory_budget_ / sizeof(T));
+    options_.max_fan_in_ = std::max<size_t>(options_.max_fan_in_, 2);
+    options_.num_threads_ = std::max<size_t>(options_.num_threads_, 1);
+  }
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /** The runs not consumed yet delete their temp pages. */
+  ~ExternalSorter() = default;
+
+  /** Add a record, spilling a run if the buffer is full. Must not be called after Finish(). */
+  void Add(const T &record) {
+    REDBASE_ASSERT(!finished_, "records added after Finish()");
+    if (buffer_.size() >= buffer_capacity_) {
+      SpillRun();
+    }
+    buffer_.push_back(record);
+    count_++;
+  }
+
+  /** Sort what is left and get ready to hand out the records, merging runs down to max_fan_in_. */
+  void Finish() {
+    REDBASE_ASSERT(!finished_, "Finish() called twice");
+    finished_ = true;
+    if (runs_.empty()) {
+      ParallelSort(&buffer_);
+      return;
+    }
+    // the tail becomes a run like the others, SpillRun() sorts it
+    if (!buffer_.empty()) {
+      SpillRun();
+    }
+    // intermediate passes merge the oldest runs first, so that every record is rewritten about the same number of times
+    while (runs_.size() > options_.max_fan_in_) {
+      std::vector<SortedRun> inputs;
+      for (size_t i = 0; i < options_.max_fan_in_; i++) {
+        inputs.push_back(std::move(runs_[i]));
+      }
+      runs_.erase(runs_.begin(), runs_.begin() + options_.max_fan_in_);
+      runs_.push_back(MergeRuns(&inputs));
+    }
+    OpenMerge(&runs_);
+  }
+
+  /**
+   * @brief Hand out the next record in sorted order. Only valid after Finish().
+   * @return false once every record has been handed out
+   */
+  auto Next(T *record) -> bool {
+    REDBASE_ASSERT(finished_, "Next() called before Finish()");
+    if (runs_.empty()) {
+      if (buffer_pos_ >= buffer_.size()) {
+        return false;
+      }
+      *record = buffer_[buffer_pos_++];
+      return true;
+    }
+    return NextMerged(&runs_, record);
+  }
+
+  /** @return the number of records added */
+  auto GetCount() const -> size_t { return count_; }
+
+  /** @return the number of runs spilled so far, intermediate merge passes included */
+  auto GetRunsSpilled() const -> size_t { return runs_spilled_; }
+
+ private:
+  /** Records lie unaligned in the run pages, they are copied out to be compared. */
+  static auto RecordOf(const char *data) -> T {
+    T record;
+    memcpy(&record, data, sizeof(T));
+    return record;
+  }
+
+  /** Sort the buffer with up to num_threads_ threads. */
+  void ParallelSort(std::vector<T> *records) { redbase::ParallelSort(records, less_, options_.num_threads_); }
+
+  /** @return an empty run of records */
+  auto NewRun() -> SortedRun { return SortedRun(bpm_, sizeof(T), "external sort: run"); }
+
+  /** Sort the buffer and write it out as a new run. */
+  void SpillRun() {
+    ParallelSort(&buffer_);
+    SortedRun run = NewRun();
+    for (const auto &record : buffer_) {
+      run.Append(reinterpret_cast<const char *>(&record));
+    }
+    run.Finish();
+    buffer_.clear();
+    runs_.push_back(std::move(run));
+    runs_spilled_++;
+  }
+
+  /** Load the first record of every run and play the matches of the merge. */
+  void OpenMerge(std::vector<SortedRun> *runs) {
+    for (auto &run : *runs) {
+      run.Advance();
+    }
+    tree_.emplace(runs->size(), RunOrder{runs, &less_});
+    tree_->Build();
+  }
+
+  /** Hand out the smallest head of the merge and move its run on. */
+  auto NextMerged(std::vector<SortedRun> *runs, T *record) -> bool {
+    if (runs->empty() || (*runs)[tree_->Top()].GetHead() == nullptr) {
+      return false;
+    }
+    SortedRun &run = (*runs)[tree_->Top()];
+    *record = RecordOf(run.GetHead());
+    run.Advance();
+    tree_->Replay();
+    return true;
+  }
+
+  /** Merge some runs into a new one, the inputs are consumed. */
+  auto MergeRuns(std::vector<SortedRun> *inputs) -> SortedRun {
+    OpenMerge(inputs);
+    SortedRun output = NewRun();
+    T record;
+    while (NextMerged(inputs, &record)) {
+      output.Append(reinterpret_cast<const char *>(&record));
+    }
+    output.Finish();
+    runs_spilled_++;
+    return output;
+  }
+
+  /** Orders the runs of a merge by their heads, the exhausted ones last. */
+  struct RunOrder {
+    auto operator()(size_t lhs, size_t rhs) const -> bool {
+      const char *left = (*runs_)[lhs].GetHead();
+      const char *right = (*runs_)[rhs].GetHead();
+      return left != nullptr && (right == nullptr || (*less_)(RecordOf(left), RecordOf(right)));
+    }
+    const std::vector<SortedRun> *runs_;
+    const Less *less_;
+  };
+
+  BufferPoolManager *bpm_;
+  Less less_;
+  ExternalSortOptions options_;
+  size_t buffer_capacity_;
+
+  std::vector<T> buffer_;
+  /** Next record of the buffer handed out when nothing was spilled. */
+  size_t buffer_pos_{0};
+  std::vector<SortedRun> runs_;
+  std::optional<LoserTree<RunOrder>> tree_;
+  size_t count_{0};
+  size_t runs_spilled_{0};
+  bool finished_{false};
+};
+
+}  // namespace redbase
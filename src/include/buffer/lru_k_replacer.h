@@ -3,7 +3,9 @@
 #include <limits>
 #include <list>
 #include <mutex>  // NOLINT
+#include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -15,7 +17,8 @@ enum class AccessType { Unknown = 0, Lookup, Scan, Index };
 
 class LRUKNode {
  public:
-  LRUKNode(size_t k, frame_id_t fid, bool is_evictable = false) : k_(k), fid_(fid), is_evictable_(is_evictable) {}
+  LRUKNode(size_t k, frame_id_t fid, bool is_evictable = false, bool is_scan_only = false)
+      : k_(k), fid_(fid), is_evictable_(is_evictable), is_scan_only_(is_scan_only) {}
 
   void AddHistory(size_t cur_timestamp) {
     this->history_.push_front(cur_timestamp);
@@ -41,8 +44,20 @@ class LRUKNode {
     ;
   }
 
+  /** @return true once the frame has k accesses, that is a finite backward k-distance */
+  auto HasKHistory() const -> bool { return this->history_.size() >= this->k_; }
+
   void ClearHistory() { this->history_.clear(); }
 
+  /** A frame stays scan-only until it sees its first non-scan access. */
+  void MarkAccessType(AccessType access_type) {
+    if (access_type != AccessType::Scan) {
+      this->is_scan_only_ = false;
+    }
+  }
+
+  auto IsScanOnly() const -> bool { return this->is_scan_only_; }
+
   void SetEvictable(bool is_evictable) { this->is_evictable_ = is_evictable; }
 
   auto IsEvictable() const -> bool { return this->is_evictable_; }
@@ -55,6 +70,8 @@ class LRUKNode {
   size_t k_;
   [[maybe_unused]] frame_id_t fid_;
   bool is_evictable_{false};
+  /** Only touched by sequential scans so far, these frames are evicted before the hot set. */
+  bool is_scan_only_{false};
 
  public:
   static constexpr size_t MAX_TIMESTAMP = SIZE_MAX;
@@ -70,6 +87,10 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * The evictable frames are kept in ordered queues, keyed on the oldest timestamp of their history: the largest
+ * k-distance is the smallest key, and so is the least recent first access among the +inf frames. Evict() takes the
+ * head of the first non-empty queue instead of scanning every frame.
  */
 class LRUKReplacer {
  public:
@@ -98,6 +119,9 @@ class LRUKReplacer {
    * If multiple frames have inf backward k-distance, then evict frame with earliest timestamp
    * based on LRU.
    *
+   * Frames that were only ever accessed by scans (AccessType::Scan) are evicted first, so that a large
+   * sequential scan recycles its own frames instead of flushing the hot set out of the pool.
+   *
    * Successful eviction of a frame should decrement the size of replacer and remove the frame's
    * access history.
    *
@@ -115,8 +139,8 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received. A frame first seen by a Scan access is
+   * kept scan-only (and evicted first) until it is accessed any other way.
    */
   void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
 
@@ -164,7 +188,23 @@ class LRUKReplacer {
   auto Size() -> size_t;
 
  private:
+  /** Evictable frames by the oldest timestamp of their history, the head is evicted first. */
+  using EvictionQueue = std::set<std::pair<size_t, frame_id_t>>;
+
+  /** @return the queue an evictable frame belongs in */
+  auto QueueOf(LRUKNode &node) -> EvictionQueue &;
+
+  /** Put an evictable frame into its queue, or take it out; called around every change of its history. */
+  void Enqueue(frame_id_t frame_id, LRUKNode &node);
+  void Dequeue(frame_id_t frame_id, LRUKNode &node);
+
   std::unordered_map<frame_id_t, LRUKNode> node_store_;
+  /** Frames only ever touched by scans, evicted before the others. */
+  EvictionQueue scan_queue_;
+  /** Frames with fewer than k accesses, +inf k-distance. */
+  EvictionQueue inf_queue_;
+  /** Frames with k accesses. */
+  EvictionQueue k_queue_;
   size_t current_timestamp_{0};
   volatile size_t replacer_size_{0};
   size_t k_;
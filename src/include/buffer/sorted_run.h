@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace redbase {
+
+/**
+ * @brief Read a page of a spill file (the pages an operator wrote its rows to, read back in order) and delete it.
+ * The SCAN_READ_AHEAD pages that follow are prefetched: all of them on the first page, then the one entering the
+ * window on each next page.
+ * @param what the operator and the file, for the error message
+ * @throw Exception if the page cannot be fetched
+ */
+void ReadSpillPage(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t page_idx,
+                   std::vector<char> *page, const char *what);
+
+/**
+ * SortedRun is a run of an external sort spilled to temp pages of the buffer pool: fixed-size records packed into
+ * pages that start with the number of records they hold. It is written once with Append() and Finish(), then read
+ * once in order with Advance(), each page copied out and deleted through ReadSpillPage() as soon as the run reaches
+ * it. The pages not read yet are deleted along with the run, so that a sort cut short by an exception leaves none
+ * behind.
+ */
+class SortedRun {
+ public:
+  /**
+   * @param what the sort, for the error messages
+   * @throw Exception if a record of `record_size` bytes does not fit a page
+   */
+  SortedRun(BufferPoolManager *bpm, uint32_t record_size, const char *what);
+
+  SortedRun(SortedRun &&other) noexcept;
+
+  auto operator=(SortedRun &&other) noexcept -> SortedRun &;
+
+  DISALLOW_COPY(SortedRun);
+
+  /** Delete the pages not read yet. */
+  ~SortedRun() { DeletePages(); }
+
+  /** Append a record, writing out the page it fills. @throw Exception if no frame is free for the page */
+  void Append(const char *record);
+
+  /** Write out the last page; the run can be read from then on. */
+  void Finish();
+
+  /**
+   * Move on to the next record, reading (and deleting) the next page when done with one.
+   * @return the record, valid until the next call, or nullptr once the run is exhausted
+   */
+  auto Advance() -> const char *;
+
+  /** @return the record the last Advance() moved to, nullptr if none */
+  auto GetHead() const -> const char * { return head_; }
+
+ private:
+  /** Run pages start with the number of records they hold. */
+  static constexpr size_t RUN_PAGE_HEADER_SIZE = 8;
+
+  void FlushPage();
+
+  void DeletePages();
+
+  BufferPoolManager *bpm_;
+  uint32_t record_size_;
+  const char *what_;
+  uint32_t records_per_page_;
+  std::vector<page_id_t> page_ids_;
+  /** Next page to read; the pages before it have been read and deleted. */
+  size_t page_idx_{0};
+  /** The page being written, then the page being read. */
+  std::vector<char> page_;
+  uint32_t count_{0};
+  uint32_t slot_{0};
+  const char *head_{nullptr};
+};
+
+}  // namespace redbase
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rm/schema.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+/** What the planner may know about the contents of a table. */
+struct TableStatistics {
+  size_t row_count_{0};
+};
+
+/** A table of the catalog. The heap belongs to the caller that registered the table. */
+struct TableInfo {
+  std::string name_;
+  Schema schema_;
+  TableHeap *heap_;
+  TableStatistics statistics_;
+};
+
+/**
+ * Catalog maps table names to their schema, heap and statistics.
+ *
+ * Every change (a table created or dropped, new statistics) bumps the version of the catalog, so that what was
+ * derived from an older version, the plans of a PlanCache in particular, can tell it is stale. Lookups hand out
+ * immutable snapshots of the tables: new statistics replace the TableInfo rather than modify it, and a dropped
+ * table lives on as long as a plan refers to it.
+ */
+class Catalog {
+ public:
+  /**
+   * @brief Register a table.
+   * @throw Exception if a table of that name exists
+   */
+  auto CreateTable(const std::string &name, Schema schema, TableHeap *heap) -> std::shared_ptr<const TableInfo>;
+
+  /** @throw Exception if there is no table of that name */
+  void DropTable(const std::string &name);
+
+  /** @return the table of that name, nullptr if there is none */
+  auto GetTable(const std::string &name) const -> std::shared_ptr<const TableInfo>;
+
+  /** @throw Exception if there is no table of that name */
+  void SetStatistics(const std::string &name, TableStatistics statistics);
+
+  /** @return a number that changes with every change of the catalog */
+  auto GetVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+ private:
+  mutable std::shared_mutex latch_;
+  std::unordered_map<std::string, std::shared_ptr<const TableInfo>> tables_;
+  std::atomic<uint64_t> version_{0};
+};
+
+}  // namespace redbase
@@ -7,6 +7,11 @@ namespace redbase {
 static constexpr int PAGE_SIZE = 1 << 12;       // 4K
 static constexpr int INVALID_PAGE_ID = -1;
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr size_t SCAN_BATCH_SIZE = 128;  // max tuples handed out per table scan batch
+static constexpr size_t SCAN_READ_AHEAD = 8;    // pages prefetched ahead of a table scan
+static constexpr size_t EXECUTION_BATCH_SIZE = 1024;  // max rows per chunk passed between executor operators
+static constexpr size_t MORSEL_PAGES = 16;      // pages of a table per morsel of a parallel pipeline
+static constexpr size_t PLAN_CACHE_SIZE = 1024;  // plans kept by a plan cache
 
 
 using page_id_t = int32_t;
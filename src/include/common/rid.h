@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+
+#include "common/config.h"
+
+namespace redbase {
+
+/**
+ * A record id, the page a tuple lives on plus its slot inside that page.
+ */
+class RID {
+ public:
+  /** The default constructor creates an invalid RID! */
+  RID() = default;
+
+  RID(page_id_t page_id, uint32_t slot_num) : page_id_(page_id), slot_num_(slot_num) {}
+
+  inline auto GetPageId() const -> page_id_t { return page_id_; }
+
+  inline auto GetSlotNum() const -> uint32_t { return slot_num_; }
+
+  inline void Set(page_id_t page_id, uint32_t slot_num) {
+    page_id_ = page_id;
+    slot_num_ = slot_num;
+  }
+
+  inline auto IsValid() const -> bool { return page_id_ != INVALID_PAGE_ID; }
+
+  auto ToString() const -> std::string {
+    std::stringstream os;
+    os << "page_id: " << page_id_ << " slot_num: " << slot_num_;
+    return os.str();
+  }
+
+  auto operator==(const RID &other) const -> bool {
+    return page_id_ == other.page_id_ && slot_num_ == other.slot_num_;
+  }
+
+  auto operator!=(const RID &other) const -> bool { return !(*this == other); }
+
+  auto operator<(const RID &other) const -> bool {
+    return page_id_ < other.page_id_ || (page_id_ == other.page_id_ && slot_num_ < other.slot_num_);
+  }
+
+ private:
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint32_t slot_num_{0};  // logical offset from 0, 1...
+};
+
+}  // namespace redbase
+
+namespace std {
+template <>
+struct hash<redbase::RID> {
+  auto operator()(const redbase::RID &rid) const -> size_t {
+    return hash<int64_t>()((static_cast<int64_t>(rid.GetPageId()) << 32) | rid.GetSlotNum());
+  }
+};
+}  // namespace std
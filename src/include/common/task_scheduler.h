@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace redbase {
+
+class TaskGroup;
+
+/**
+ * TaskScheduler runs tasks on a fixed pool of worker threads, each with a deque of its own. A worker takes the tasks
+ * of its deque from the back, newest first, so that what a task spawns runs next on the same core while its data is
+ * still in cache; a worker whose deque is empty steals from the front of the others, the oldest tasks, which are the
+ * largest pieces of work left. Idle workers sleep until a task is queued.
+ *
+ * Tasks are spawned and waited for through a TaskGroup. A task is told the index of the worker running it, so that
+ * the tasks of an operator can keep a state per worker without locking: a worker runs one task at a time.
+ */
+class TaskScheduler {
+ public:
+  using Task = std::function<void(size_t worker_idx)>;
+
+  /** Start the workers. */
+  explicit TaskScheduler(size_t num_workers);
+
+  /** Stop the workers, once the tasks queued have run. */
+  ~TaskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(TaskScheduler);
+
+  auto GetWorkerCount() const -> size_t { return workers_.size(); }
+
+  /** @return the index of the calling thread if it is a worker of this scheduler */
+  auto CurrentWorker() const -> std::optional<size_t>;
+
+ private:
+  friend class TaskGroup;
+
+  struct Entry {
+    TaskGroup *group_;
+    Task task_;
+  };
+
+  struct Worker {
+    std::mutex latch_;
+    std::deque<Entry> tasks_;
+    std::thread thread_;
+  };
+
+  /** Queue a task on the deque of a worker and wake a sleeping one. */
+  void Push(size_t worker_idx, Entry entry);
+
+  /**
+   * @brief Take a task off the back of the deque of a worker, or steal one off the front of another.
+   * @param group if not null, only a task of this group is taken
+   */
+  auto Take(size_t worker_idx, const TaskGroup *group, Entry *entry) -> bool;
+
+  void Run(size_t worker_idx, Entry *entry);
+
+  void WorkerLoop(size_t worker_idx);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  /** Tasks queued and not taken yet, changed under sleep_latch_ when it goes up so that no wakeup is lost. */
+  std::atomic<size_t> queued_{0};
+  std::mutex sleep_latch_;
+  std::condition_variable sleep_cv_;
+  bool stop_{false};
+  /** Next worker a task spawned from outside the pool is queued on. */
+  std::atomic<size_t> next_worker_{0};
+};
+
+/**
+ * TaskGroup is a set of tasks of a TaskScheduler that someone waits for: the barrier of a pipeline breaker, which
+ * spawns the work of a phase into a group and waits for it before the next phase. The first exception thrown by a task
+ * is kept and rethrown by Wait(); the other tasks still run.
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(TaskScheduler *scheduler) : scheduler_(scheduler) {}
+
+  /** Wait for the tasks still running, an exception is dropped. */
+  ~TaskGroup();
+
+  DISALLOW_COPY_AND_MOVE(TaskGroup);
+
+  /** Queue a task on the calling worker, or on the workers in turn when called from outside the pool. */
+  void Spawn(TaskScheduler::Task task);
+
+  /** Queue a task on a given worker (modulo their count), which keeps it unless another one runs out of work. */
+  void Spawn(size_t worker_idx, TaskScheduler::Task task);
+
+  /**
+   * @brief Wait until every task of the group has run, rethrowing the first exception of a task. A worker of the
+   * scheduler runs the tasks of the group meanwhile, so that a task can wait for the tasks it spawns.
+   */
+  void Wait();
+
+  /** @return true once a task has thrown */
+  auto HasFailed() const -> bool { return failed_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class TaskScheduler;
+
+  /** A task of the group was taken off a deque. */
+  void OnTaken();
+
+  /** A task of the group is done, having thrown `error` if not null. */
+  void OnFinished(std::exception_ptr error);
+
+  TaskScheduler *scheduler_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  /** Tasks spawned and not done yet, and those of them still queued. */
+  size_t pending_{0};
+  size_t queued_{0};
+  std::exception_ptr error_;
+  std::atomic<bool> failed_{false};
+};
+
+/**
+ * @brief Run fn(i) for every i in [0, count) and wait for them: as tasks of `scheduler`, or if it is null on up to
+ * `num_threads` threads of a scheduler of its own. The first exception of a call is rethrown.
+ */
+void ParallelFor(TaskScheduler *scheduler, size_t num_threads, size_t count, const std::function<void(size_t i)> &fn);
+
+}  // namespace redbase
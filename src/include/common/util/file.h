@@ -11,7 +11,7 @@ namespace redbase
  * Return the size of a filename
  * return -1 if failed or not a common file
 */
-auto GetFileSize(const std::string& filepath) -> int {
+inline auto GetFileSize(const std::string& filepath) -> int {
     struct stat st;
     int ret = stat(filepath.c_str(), &st);
     if (ret == -1 || !S_ISREG(st.st_mode)) {
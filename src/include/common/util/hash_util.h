@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace redbase {
+
+using hash_t = uint64_t;
+
+/** Hashing of raw bytes, shared by the hash-based structures. */
+class HashUtil {
+ public:
+  /** @return a well mixed 64-bit value, the finalizer of MurmurHash3 */
+  static constexpr auto Mix(uint64_t x) -> hash_t {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  /** @return the hash of `size` bytes, eight of them folded in per step */
+  static auto HashBytes(const void *data, size_t size) -> hash_t {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    hash_t hash = 0x9e3779b97f4a7c15ULL ^ size;
+    for (; size >= 8; bytes += 8, size -= 8) {
+      uint64_t word;
+      memcpy(&word, bytes, 8);
+      hash = Mix(hash ^ word);
+    }
+    if (size > 0) {
+      uint64_t word = 0;
+      memcpy(&word, bytes, size);
+      hash = Mix(hash ^ word);
+    }
+    return hash;
+  }
+
+  /** @return a hash of two hashes, order sensitive */
+  static constexpr auto CombineHashes(hash_t lhs, hash_t rhs) -> hash_t {
+    return Mix(lhs ^ (rhs + 0x9e3779b97f4a7c15ULL + (lhs << 6) + (lhs >> 2)));
+  }
+};
+
+}  // namespace redbase
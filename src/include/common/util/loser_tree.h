@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace redbase {
+
+/**
+ * LoserTree picks, again and again, the smallest of the current items of k sorted sources, as the k-way merges of the
+ * external sorts do. Each inner node of the tree holds the source that lost the match played there, so that once the
+ * winner has advanced to its next item, a single walk from its leaf to the root (log2 k comparisons, always against
+ * the same nodes) finds the next winner, where a binary heap compares both children at every level.
+ *
+ * The tree only deals in source indices, the items are kept by the caller:
+ *
+ * @tparam SourceLess `auto less(size_t a, size_t b) -> bool`, true if the current item of source a comes before the
+ * current item of source b. An exhausted source must come after every other one.
+ */
+template <typename SourceLess>
+class LoserTree {
+ public:
+  LoserTree(size_t num_sources, SourceLess less) : less_(std::move(less)), num_sources_(num_sources) {}
+
+  /** Play every match, once each source holds its first item (or is exhausted). */
+  void Build() {
+    nodes_.assign(std::max<size_t>(num_sources_, 1), 0);
+    if (num_sources_ <= 1) {
+      return;
+    }
+    // winners of the subtrees, the leaf of source i being node num_sources_ + i
+    std::vector<size_t> winners(2 * num_sources_);
+    for (size_t i = 0; i < num_sources_; i++) {
+      winners[num_sources_ + i] = i;
+    }
+    for (size_t node = num_sources_ - 1; node >= 1; node--) {
+      size_t left = winners[2 * node];
+      size_t right = winners[2 * node + 1];
+      bool right_wins = less_(right, left);
+      winners[node] = right_wins ? right : left;
+      nodes_[node] = right_wins ? left : right;
+    }
+    nodes_[0] = winners[1];
+  }
+
+  /** @return the source whose current item is the smallest, an exhausted one if they all are */
+  auto Top() const -> size_t { return nodes_[0]; }
+
+  /** Replay the matches of the top source after it moved to its next item (or ran out). */
+  void Replay() {
+    size_t winner = nodes_[0];
+    for (size_t node = (num_sources_ + winner) / 2; node >= 1; node /= 2) {
+      if (less_(nodes_[node], winner)) {
+        std::swap(nodes_[node], winner);
+      }
+    }
+    nodes_[0] = winner;
+  }
+
+ private:
+  SourceLess less_;
+  size_t num_sources_;
+  /** The winner at index 0, the loser of inner node n at index n. */
+  std::vector<size_t> nodes_;
+};
+
+}  // namespace redbase
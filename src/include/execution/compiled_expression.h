@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "execution/expression.h"
+
+namespace redbase {
+
+/** The expression shapes that have fused kernels. */
+enum class FusedShape : uint8_t {
+  /** `col <op> const AND col <op> const` */
+  COMPARE_AND_COMPARE,
+  /** `(col <arith> col) <op> const` */
+  ARITHMETIC_COMPARE,
+  /** `col <arith> col`, a value */
+  ARITHMETIC_COLUMNS,
+  /** `col <arith> const` or `const <arith> col`, a value */
+  ARITHMETIC_CONSTANT,
+};
+
+/** The columns and constants a fused kernel runs on, taken from the expression it replaces. */
+struct FusedArgs {
+  std::array<uint32_t, 2> col_idxs_{};
+  /** Of the type the kernel was instantiated for, checked by CompileExpression(). */
+  std::array<Value, 2> constants_{};
+  /** Of the comparisons of COMPARE_AND_COMPARE, which are left to the SIMD kernels of SelectRows(). */
+  std::array<ComparisonType, 2> comparison_types_{};
+};
+
+using FusedPredicateFn = void (*)(const FusedArgs &args, const DataChunk &chunk, SelectionVector *selection);
+using FusedValueFn = void (*)(const FusedArgs &args, const DataChunk &chunk, Vector *result);
+
+/**
+ * A predicate evaluated by a fused kernel, instantiated for the column types and operators of its shape, in place of
+ * the tree of expressions it was lowered from: no intermediate vector, no dispatch on types per node. The tree is
+ * kept, it runs instead when a column does not come in the form the kernel expects (a constant vector, another type).
+ */
+class FusedPredicateExpression : public Expression {
+ public:
+  FusedPredicateExpression(FusedPredicateFn fn, FusedArgs args, std::array<TypeId, 2> column_types,
+                           ExpressionRef interpreted)
+      : Expression(TypeId::INVALID, {}),
+        fn_(fn),
+        args_(std::move(args)),
+        column_types_(column_types),
+        interpreted_(std::move(interpreted)) {}
+
+  void Select(const DataChunk &chunk, SelectionVector *selection) const override;
+
+ private:
+  FusedPredicateFn fn_;
+  FusedArgs args_;
+  std::array<TypeId, 2> column_types_;
+  ExpressionRef interpreted_;
+};
+
+/** A value computed by a fused kernel, see FusedPredicateExpression. */
+class FusedValueExpression : public Expression {
+ public:
+  FusedValueExpression(FusedValueFn fn, FusedArgs args, std::array<TypeId, 2> column_types, ExpressionRef interpreted)
+      : Expression(interpreted->GetReturnType(), {}),
+        fn_(fn),
+        args_(std::move(args)),
+        column_types_(column_types),
+        interpreted_(std::move(interpreted)) {}
+
+  void Evaluate(const DataChunk &chunk, Vector *result) const override;
+
+ private:
+  FusedValueFn fn_;
+  FusedArgs args_;
+  std::array<TypeId, 2> column_types_;
+  ExpressionRef interpreted_;
+};
+
+/**
+ * @brief Lower an expression tree into fused kernels, at plan time.
+ *
+ * The shapes of FusedShape are looked up, for the types and operators at hand, in a registry of kernels that are all
+ * instantiated when redbase is built. A conjunction has its comparisons of a column with a constant fused two by
+ * two, its other children are lowered on their own. What matches no kernel is left to the interpreter.
+ *
+ * @return an equivalent expression, the expression itself if nothing could be fused
+ */
+auto CompileExpression(const ExpressionRef &expression) -> ExpressionRef;
+
+/** @return the number of kernels in the registry of a shape */
+auto FusedKernelCount(FusedShape shape) -> size_t;
+
+}  // namespace redbase
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rm/schema.h"
+#include "rm/value.h"
+
+namespace redbase {
+
+/**
+ * Vector is one column of a batch of rows: a fixed-width value per row, laid out as in a tuple (INTEGER and DATE are
+ * int32_t, BIGINT is int64_t, DOUBLE is double, CHAR(n) is n zero-padded bytes), plus a NULL flag per row.
+ *
+ * A constant vector holds a single value that stands for every row. The buffers are shared by Reference(), which
+ * lets an operator hand a column of its input downstream without copying it.
+ */
+class Vector {
+ public:
+  Vector() = default;
+
+  /** @param width the number of bytes of a value */
+  Vector(TypeId type_id, uint32_t width, size_t capacity);
+
+  /** @return a vector holding `value` for every row */
+  static auto MakeConstant(const Value &value) -> Vector;
+
+  auto GetType() const -> TypeId { return type_id_; }
+  auto GetWidth() const -> uint32_t { return width_; }
+  auto GetCapacity() const -> size_t { return capacity_; }
+  auto IsConstant() const -> bool { return is_constant_; }
+
+  auto GetData() -> char * { return data_->data(); }
+  auto GetData() const -> const char * { return data_->data(); }
+
+  template <typename T>
+  auto GetData() -> T * {
+    return reinterpret_cast<T *>(data_->data());
+  }
+
+  template <typename T>
+  auto GetData() const -> const T * {
+    return reinterpret_cast<const T *>(data_->data());
+  }
+
+  /** @return the NULL flags, one byte per row, 1 for NULL */
+  auto GetNulls() -> uint8_t * { return nulls_->data(); }
+  auto GetNulls() const -> const uint8_t * { return nulls_->data(); }
+
+  auto IsNull(size_t row) const -> bool { return (*nulls_)[is_constant_ ? 0 : row] != 0; }
+
+  /** @return the value of a numeric row */
+  auto GetValue(size_t row) const -> Value;
+
+  /** Store a numeric value (or a NULL) in a row. */
+  void SetValue(size_t row, const Value &value);
+
+  /** Share the buffers of another vector, which must not be written while this one is read. */
+  void Reference(const Vector &other);
+
+ private:
+  TypeId type_id_{TypeId::INVALID};
+  uint32_t width_{0};
+  size_t capacity_{0};
+  bool is_constant_{false};
+  std::shared_ptr<std::vector<char>> data_;
+  std::shared_ptr<std::vector<uint8_t>> nulls_;
+};
+
+/**
+ * The rows of a batch that are still alive, as an increasing list of row indexes. A selection of all the rows of a
+ * batch is known to be one, so that the filters can read the vectors densely instead of through the indexes.
+ */
+class SelectionVector {
+ public:
+  SelectionVector() = default;
+  explicit SelectionVector(size_t capacity) : indexes_(capacity) {}
+
+  /** Select the rows [0, count). */
+  void SetIdentity(size_t count);
+
+  /** Select the rows another selection selects. */
+  void Assign(const SelectionVector &other);
+
+  auto GetCount() const -> size_t { return count_; }
+
+  /** Keep the first `count` indexes, which are expected to be changed through GetData() first if rows are dropped. */
+  void SetCount(size_t count) {
+    is_identity_ = is_identity_ && count == count_;
+    count_ = count;
+  }
+
+  /** @return true if the selection is [0, GetCount()) */
+  auto IsIdentity() const -> bool { return is_identity_; }
+
+  auto operator[](size_t i) const -> uint32_t { return indexes_[i]; }
+
+  auto GetData() -> uint32_t * { return indexes_.data(); }
+  auto GetData() const -> const uint32_t * { return indexes_.data(); }
+
+ private:
+  std::vector<uint32_t> indexes_;
+  size_t count_{0};
+  bool is_identity_{false};
+};
+
+/**
+ * DataChunk is the unit operators pass to each other: one Vector per column of the operator's output schema, holding
+ * GetSize() rows, and the selection vector of the rows that are alive. A filter only shrinks the selection, the rows
+ * are not moved, so downstream operators work on the selected rows of the vectors.
+ */
+class DataChunk {
+ public:
+  /** Make one vector of `capacity` rows per column of the schema. */
+  void Initialize(const Schema &schema, size_t capacity);
+
+  auto GetColumnCount() const -> size_t { return columns_.size(); }
+  auto GetColumn(size_t col_idx) -> Vector & { return columns_[col_idx]; }
+  auto GetColumn(size_t col_idx) const -> const Vector & { return columns_[col_idx]; }
+
+  auto GetCapacity() const -> size_t { return capacity_; }
+
+  /** @return the number of rows in the vectors, selected or not */
+  auto GetSize() const -> size_t { return size_; }
+
+  /** Set the number of rows in the vectors and select all of them. */
+  void SetSize(size_t size);
+
+  /** Set the number of rows in the vectors and select the rows of `selection`. */
+  void SetSize(size_t size, const SelectionVector &selection);
+
+  auto GetSelection() -> SelectionVector & { return selection_; }
+  auto GetSelection() const -> const SelectionVector & { return selection_; }
+
+  /** @return the number of rows alive */
+  auto GetSelectedCount() const -> size_t { return selection_.GetCount(); }
+
+  /** @return the value of a numeric column of the i-th row alive */
+  auto GetValue(size_t col_idx, size_t i) const -> Value { return columns_[col_idx].GetValue(selection_[i]); }
+
+ private:
+  std::vector<Vector> columns_;
+  size_t capacity_{0};
+  size_t size_{0};
+  SelectionVector selection_;
+};
+
+}  // namespace redbase
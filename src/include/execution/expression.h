@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "execution/data_chunk.h"
+#include "execution/predicate_kernels.h"
+
+namespace redbase {
+
+/** @return a non-NULL value as a T (int32_t, int64_t or double), if a T holds it exactly */
+template <typename T>
+inline auto ExactAs(const Value &value) -> std::optional<T> {
+  if constexpr (std::is_same_v<T, double>) {
+    // doubles hold the integers of up to 53 bits
+    if (value.GetTypeId() != TypeId::DOUBLE && std::abs(value.GetAsInteger()) > (int64_t{1} << 53)) {
+      return std::nullopt;
+    }
+    return value.GetAsDouble();
+  } else {
+    int64_t integer = value.GetAsInteger();
+    if (value.GetTypeId() == TypeId::DOUBLE || integer < std::numeric_limits<T>::min() ||
+        integer > std::numeric_limits<T>::max()) {
+      return std::nullopt;
+    }
+    return static_cast<T>(integer);
+  }
+}
+
+class Expression;
+using ExpressionRef = std::shared_ptr<const Expression>;
+
+/**
+ * Expression is a scalar expression evaluated a batch at a time. An expression is either a value, computed for the
+ * selected rows of a chunk by Evaluate(), or a predicate, which narrows down the selection of a chunk by Select().
+ * Expressions hold no state of their own, a tree can be shared by several operators and threads.
+ */
+class Expression {
+ public:
+  Expression(TypeId return_type, std::vector<ExpressionRef> children)
+      : return_type_(return_type), children_(std::move(children)) {}
+  virtual ~Expression() = default;
+
+  /** @return the type of the values computed by Evaluate() */
+  auto GetReturnType() const -> TypeId { return return_type_; }
+
+  auto GetChildren() const -> const std::vector<ExpressionRef> & { return children_; }
+
+  /**
+   * @brief Compute the expression for the selected rows of a chunk. Row i of the result belongs to row i of the
+   * chunk, the rows not selected are left undefined.
+   * @param[out] result reused if it has the right type and capacity, reallocated otherwise
+   */
+  virtual void Evaluate(const DataChunk &chunk, Vector *result) const;
+
+  /**
+   * @brief Keep the rows of a selection on which the predicate is true. A NULL operand makes the predicate unknown,
+   * the row is dropped.
+   * @param[in,out] selection rows of the chunk, refined in place
+   */
+  virtual void Select(const DataChunk &chunk, SelectionVector *selection) const;
+
+ private:
+  TypeId return_type_;
+  std::vector<ExpressionRef> children_;
+};
+
+/** A column of the input chunk. */
+class ColumnRefExpression : public Expression {
+ public:
+  ColumnRefExpression(uint32_t col_idx, TypeId type_id) : Expression(type_id, {}), col_idx_(col_idx) {}
+
+  auto GetColIdx() const -> uint32_t { return col_idx_; }
+
+  /** Shares the column of the chunk, nothing is copied. */
+  void Evaluate(const DataChunk &chunk, Vector *result) const override;
+
+ private:
+  uint32_t col_idx_;
+};
+
+/** A numeric literal. */
+class ConstantExpression : public Expression {
+ public:
+  explicit ConstantExpression(const Value &value)
+      : Expression(value.GetTypeId(), {}), value_(value), vector_(Vector::MakeConstant(value)) {}
+
+  auto GetValue() const -> const Value & { return value_; }
+
+  void Evaluate(const DataChunk &chunk, Vector *result) const override;
+
+ private:
+  Value value_;
+  Vector vector_;
+};
+
+/**
+ * A comparison of two numeric values, a predicate. A column compared with a constant of a type it can hold exactly
+ * is filtered by the SIMD kernels of SelectRows().
+ */
+class ComparisonExpression : public Expression {
+ public:
+  ComparisonExpression(ComparisonType comparison_type, ExpressionRef left, ExpressionRef right)
+      : Expression(TypeId::INVALID, {std::move(left), std::move(right)}), comparison_type_(comparison_type) {}
+
+  auto GetComparisonType() const -> ComparisonType { return comparison_type_; }
+
+  void Select(const DataChunk &chunk, SelectionVector *selection) const override;
+
+ private:
+  ComparisonType comparison_type_;
+};
+
+/** The conjunction of predicates, evaluated one after the other on the rows the previous ones kept. */
+class ConjunctionExpression : public Expression {
+ public:
+  explicit ConjunctionExpression(std::vector<ExpressionRef> children)
+      : Expression(TypeId::INVALID, std::move(children)) {}
+
+  void Select(const DataChunk &chunk, SelectionVector *selection) const override;
+};
+
+/** `value BETWEEN low AND high`, bounds included. */
+class BetweenExpression : public Expression {
+ public:
+  BetweenExpression(ExpressionRef child, const Value &low, const Value &high)
+      : Expression(TypeId::INVALID, {std::move(child)}), low_(low), high_(high) {}
+
+  auto GetLow() const -> const Value & { return low_; }
+
+  auto GetHigh() const -> const Value & { return high_; }
+
+  void Select(const DataChunk &chunk, SelectionVector *selection) const override;
+
+ private:
+  Value low_;
+  Value high_;
+};
+
+/** `value IN (list)`. NULLs of the list match nothing. */
+class InListExpression : public Expression {
+ public:
+  InListExpression(ExpressionRef child, std::vector<Value> list)
+      : Expression(TypeId::INVALID, {std::move(child)}), list_(std::move(list)) {}
+
+  void Select(const DataChunk &chunk, SelectionVector *selection) const override;
+
+ private:
+  std::vector<Value> list_;
+};
+
+enum class ArithmeticType { PLUS, MINUS, MULTIPLY };
+
+/** Arithmetic on two numeric values: a DOUBLE if either side is one, a BIGINT otherwise. NULL in, NULL out. */
+class ArithmeticExpression : public Expression {
+ public:
+  ArithmeticExpression(ArithmeticType arithmetic_type, ExpressionRef left, ExpressionRef right);
+
+  auto GetArithmeticType() const -> ArithmeticType { return arithmetic_type_; }
+
+  void Evaluate(const DataChunk &chunk, Vector *result) const override;
+
+ private:
+  ArithmeticType arithmetic_type_;
+};
+
+}  // namespace redbase
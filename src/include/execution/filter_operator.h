@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+
+#include "execution/expression.h"
+#include "execution/operator.h"
+
+namespace redbase {
+
+/**
+ * FilterOperator keeps the rows of its child on which a predicate is true. The rows stay where they are in the
+ * vectors, only the selection of the chunk shrinks; chunks left without a selected row are not handed out.
+ *
+ * Over a SeqScanOperator, the conjuncts the scan can check in the pages are pushed down into it (see
+ * SeqScanOperator::PushDown()) unless the context says otherwise, and the filter only evaluates the rest.
+ */
+class FilterOperator : public Operator {
+ public:
+  FilterOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, ExpressionRef predicate);
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+  auto MakeWorker() -> std::unique_ptr<Operator> override;
+
+  auto GetMorselCount() const -> size_t override { return child_->GetMorselCount(); }
+
+  void InitMorsel(size_t morsel_idx) override;
+
+ private:
+  std::unique_ptr<Operator> child_;
+  ExpressionRef predicate_;
+};
+
+}  // namespace redbase
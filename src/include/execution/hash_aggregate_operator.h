@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/operator.h"
+#include "execution/row_layout.h"
+
+namespace redbase {
+
+/** The aggregate functions of a GROUP BY. */
+enum class AggregateType { COUNT_STAR, COUNT, SUM, MIN, MAX, AVG };
+
+/** An aggregate of a GROUP BY: a function over a numeric column of the input (none for COUNT_STAR). */
+struct Aggregate {
+  AggregateType type_;
+  uint32_t col_idx_{0};
+};
+
+/** Knobs of a hash aggregation. */
+struct HashAggregateOptions {
+  /** Bytes of groups held in memory, shared evenly by the threads; past it, partitions are spilled to temp pages. */
+  size_t memory_budget_{64 << 20};
+  /** Groups are split into 2^partition_bits_ partitions by the high bits of the hash of their key. */
+  size_t partition_bits_{4};
+  /** Threads aggregating the input, then merging the partitions, when the context has no scheduler. */
+  size_t num_threads_{1};
+};
+
+/**
+ * HashAggregateOperator is a GROUP BY: the output has the group columns followed by an aggregate per column, with SQL
+ * semantics: NULL keys form a group of their own, COUNT is 0 and the other aggregates are NULL for a group without
+ * a non-NULL value, and without group columns an empty input still gives one row. COUNT is a BIGINT, SUM of integers
+ * a BIGINT, AVG a DOUBLE, and MIN, MAX, SUM of doubles have the type of their column. The child is consumed by Init().
+ *
+ * The state of a group is a fixed-layout row allocated from an arena: the hash and the key of the group (see
+ * RowLayout, NULL values zeroed so that keys compare with memcmp), then 16 bytes per aggregate (a value and a count).
+ * A chunk is aggregated in steps that each run as a loop over the rows: the keys are encoded and hashed, the group
+ * of every row is looked up (prefetching the slots of the whole chunk first), then each aggregate updates the groups
+ * of the rows with a kernel specialized on its function and on the type of its column.
+ *
+ * The input is pre-aggregated by num_threads_ threads (the workers of the scheduler of the context if it has one)
+ * into tables of their own, one per partition (the high bits of the hash), the input being handed out a morsel or a
+ * chunk at a time (see ParallelConsume()). When the tables of a thread outgrow its share of memory_budget_, its
+ * largest table is written to temp pages of the buffer pool as partial states and started afresh. Once the input is
+ * exhausted, the partitions are merged a few at a time, one task per partition: the tables of every thread and the
+ * states spilled for a partition are combined into one table, whose groups Next() then hands out. A partition whose
+ * groups outgrow the budget is still merged in memory, it is not partitioned further.
+ */
+class HashAggregateOperator : public Operator {
+ public:
+  /**
+   * @param group_by the group columns, in the output of `child`
+   * @param bpm the buffer pool of the temp pages of spilled partitions
+   */
+  HashAggregateOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, std::vector<uint32_t> group_by,
+                        std::vector<Aggregate> aggregates, BufferPoolManager *bpm, HashAggregateOptions options = {});
+
+  /** Delete the temp pages not read yet. */
+  ~HashAggregateOperator() override;
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+  /** @return the number of tables spilled by the last Init(), a partition may be spilled by many threads or often */
+  auto GetPartitionsSpilled() const -> size_t { return partitions_spilled_; }
+
+ private:
+  /** Group states written to temp pages, a page is written once full. */
+  struct SpillFile {
+    std::vector<page_id_t> page_ids_;
+    /** The page being filled. */
+    std::vector<char> page_;
+    uint32_t count_{0};
+  };
+
+  /** The groups of a partition: state rows in an arena, and an open-addressing table over them. */
+  struct Table {
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    /** Bytes used of the last block. */
+    size_t block_used_{0};
+    std::vector<char *> rows_;
+    /** Per slot the hash of its group and its row, nullptr for an empty slot. */
+    std::vector<uint64_t> slot_hashes_;
+    std::vector<char *> slot_rows_;
+    uint64_t mask_{0};
+    /** Bytes of the arena and of the slots. */
+    size_t memory_{0};
+  };
+
+  /** What a thread aggregates into. */
+  struct LocalState {
+    std::vector<Table> tables_;
+    std::vector<SpillFile> files_;
+    size_t memory_{0};
+    /** Per row of the chunk being aggregated, its key, hash and state row. */
+    std::vector<char> keys_;
+    std::vector<uint64_t> hashes_;
+    std::vector<char *> states_;
+  };
+
+  /** How an aggregate keeps its state and where. */
+  struct AggregateInfo {
+    AggregateType type_;
+    uint32_t col_idx_;
+    TypeId input_type_;
+    TypeId output_type_;
+    uint32_t offset_;
+  };
+
+  auto PartitionOf(uint64_t hash) const -> size_t;
+
+  /** Pull the child dry into the local states, in parallel. */
+  void ConsumeChild();
+
+  /** Aggregate the selected rows of a chunk into the tables of a thread. */
+  void Consume(const DataChunk &chunk, LocalState *local);
+
+  /** Encode and hash the keys of the selected rows of a chunk. */
+  void HashKeys(const DataChunk &chunk, LocalState *local) const;
+
+  /** Find the state row of a group, making one (its states zeroed) if it is new. */
+  auto FindOrCreate(Table *table, uint64_t hash, const char *key) const -> char *;
+
+  /** Double the slots of a table. */
+  void Grow(Table *table) const;
+
+  /** Add the states of a row of the same group to another. */
+  void Combine(const char *from, char *to) const;
+
+  /** Write the largest table of a thread out to temp pages as partial states and start it afresh. */
+  void SpillLargest(LocalState *local);
+
+  void AppendToFile(SpillFile *file, const char *row);
+
+  void FlushFile(SpillFile *file);
+
+  void DeleteFile(SpillFile *file);
+
+  /** Merge the tables and the spilled states of every thread for a partition into merged_[partition_idx]. */
+  void MergePartition(size_t partition_idx);
+
+  /** Merge the next partitions, one per thread, in parallel. @return false once there is none left */
+  auto NextPartitionGroup() -> bool;
+
+  /** Copy the groups of the rows [begin, end) of a merged table to the chunk, a column at a time. */
+  void WriteGroups(const Table &table, size_t begin, size_t end, DataChunk *chunk);
+
+  std::unique_ptr<Operator> child_;
+  std::vector<uint32_t> group_by_;
+  BufferPoolManager *bpm_;
+  HashAggregateOptions options_;
+  std::vector<AggregateInfo> aggregates_;
+  /** The layout of the keys, over the group columns. */
+  RowLayout key_layout_;
+  /** A state row: the hash, the key padded to 8 bytes, then the aggregates. */
+  uint32_t key_size_{0};
+  uint32_t row_size_{0};
+
+  std::vector<LocalState> locals_;
+  std::atomic<size_t> partitions_spilled_{0};
+
+  /** Merged tables of the partitions, the first of the group being handed out. */
+  std::vector<Table> merged_;
+  size_t next_partition_{0};
+  std::vector<size_t> group_;
+  size_t group_pos_{0};
+  size_t row_pos_{0};
+  /** Keys of the rows of the output chunk. */
+  std::vector<const char *> out_keys_;
+};
+
+}  // namespace redbase
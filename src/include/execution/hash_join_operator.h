@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/operator.h"
+#include "execution/row_layout.h"
+
+namespace redbase {
+
+/** Knobs of a hash join. */
+struct HashJoinOptions {
+  /**
+   * Bytes of build rows held in memory, their keys and the hash tables over them included; past it, whole partitions
+   * are spilled to temp pages.
+   */
+  size_t memory_budget_{64 << 20};
+  /** The build side is split into 2^partition_bits_ partitions by the high bits of the hash of the key. */
+  size_t partition_bits_{6};
+  /** Threads building the hash tables of the partitions, when the context has no scheduler. */
+  size_t num_threads_{1};
+};
+
+/**
+ * HashJoinOperator is the inner equi-join of two children on an integer key (INTEGER, BIGINT or DATE); a NULL key
+ * matches nothing. The output has the columns of the probe side followed by those of the build side.
+ *
+ * The build side is consumed by Init() and radix-partitioned on the high bits of the hash of the key. A partition is
+ * the unit of the parallel build, of spilling, and of the join of spilled rows, where the table of one partition is
+ * probed by all of its rows in a row, small enough to stay in cache. Each table is an open-addressing one with linear
+ * probing and a tag byte per slot (a few bits of the hash), which settles most mismatches without touching the keys;
+ * the tables are built in parallel, one partition per task (see ParallelFor()).
+ *
+ * Probe rows are hashed a chunk at a time and looked up in order, prefetching the slots of the rows a few steps ahead
+ * so that their cache misses overlap. A probe row may match many build rows, a chunk is resumed where the previous
+ * call to Next() stopped.
+ *
+ * A partition in memory is charged for its rows and keys as reserved and for the table it will get, before any of
+ * them is allocated. When the charges outgrow memory_budget_, the largest partition still in memory is written to
+ * temp pages of the buffer pool, a page at a time, along with every later build row of that partition, and the probe
+ * rows of spilled partitions are written out the same way (a grace hash join). Once the probe side is exhausted, the
+ * spilled partitions are read back in groups that fit the budget, the tables of a group built in parallel, and joined
+ * with their probe rows. Temp pages are deleted as soon as they have been read. A single partition larger than the
+ * budget is still joined in memory, it is not partitioned further.
+ *
+ * When nothing was spilled, the probe pipeline can run on morsels (see MakeWorker()): every worker probes the tables
+ * built by Init() with the probe rows of its morsels, the tables are only read once built.
+ */
+class HashJoinOperator : public Operator {
+ public:
+  /**
+   * @param probe_key_idx column of the key in the output of `probe`
+   * @param build_key_idx column of the key in the output of `build`
+   * @param bpm the buffer pool of the temp pages of spilled partitions
+   */
+  HashJoinOperator(ExecutorContext *ctx, std::unique_ptr<Operator> probe, std::unique_ptr<Operator> build,
+                   uint32_t probe_key_idx, uint32_t build_key_idx, BufferPoolManager *bpm,
+                   HashJoinOptions options = {});
+
+  /** Delete the temp pages not read yet. */
+  ~HashJoinOperator() override;
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+  /** @return the number of partitions spilled by the last Init() */
+  auto GetPartitionsSpilled() const -> size_t { return partitions_spilled_; }
+
+  /** @return the most bytes of build rows, keys and tables held at once since the last Init() */
+  auto GetPeakMemory() const -> size_t { return peak_memory_; }
+
+  /** A worker probes the tables built by Init() with a morsel of the probe side; none if a partition was spilled. */
+  auto MakeWorker() -> std::unique_ptr<Operator> override;
+
+  auto GetMorselCount() const -> size_t override { return probe_->GetMorselCount(); }
+
+  void InitMorsel(size_t morsel_idx) override;
+
+ private:
+  /** Rows of a partition appended to temp pages, a page is written once full. */
+  struct SpillFile {
+    std::vector<page_id_t> page_ids_;
+    /** The page being filled. */
+    std::vector<char> page_;
+    uint32_t count_{0};
+    size_t rows_{0};
+  };
+
+  struct Partition {
+    /** Key and row of every build row in memory. */
+    std::vector<int64_t> keys_;
+    std::vector<char> rows_;
+    /** The hash table: per slot a tag (0 for an empty slot), the key and the index of the build row. */
+    std::vector<uint8_t> tags_;
+    std::vector<int64_t> slot_keys_;
+    std::vector<uint32_t> slot_rows_;
+    uint64_t mask_{0};
+    /** Bytes charged to memory_used_ for the partition, see PartitionBytes(). */
+    size_t bytes_{0};
+    bool spilled_{false};
+    SpillFile build_file_;
+    SpillFile probe_file_;
+  };
+
+  /** The stage of the join Next() is in. */
+  enum class Phase { IN_MEMORY, SPILLED, DONE };
+
+  /** A worker of `builder`, see MakeWorker(). */
+  HashJoinOperator(HashJoinOperator *builder, std::unique_ptr<Operator> probe);
+
+  auto PartitionOf(uint64_t hash) const -> size_t;
+
+  /** Consume the build side into the partitions, spilling as the budget requires. */
+  void ConsumeBuild();
+
+  /** Write a partition still in memory out to temp pages and free its rows. */
+  void SpillPartition(size_t partition_idx);
+
+  void AppendToFile(SpillFile *file, const RowLayout &layout, const char *row);
+
+  void FlushFile(SpillFile *file);
+
+  /** @return the number of slots of the table of a partition of `rows` rows */
+  static auto TableCapacity(size_t rows) -> size_t;
+
+  /** @return the bytes of a partition with room for `reserved` rows and a table for `rows` of them */
+  auto PartitionBytes(size_t reserved, size_t rows) const -> size_t;
+
+  /** Build the table of a partition from its rows in memory. */
+  static void BuildTable(Partition *partition);
+
+  /** Build the tables of some partitions in parallel, reading their rows back first if `load`. */
+  void BuildTables(const std::vector<size_t> &partition_idxs, bool load);
+
+  /** Read the build rows of a spilled partition back into memory. */
+  void LoadPartition(size_t partition_idx);
+
+  /** Copy page `page_idx` of a file into `page` and delete it, prefetching the pages that follow. */
+  void ReadFilePage(SpillFile *file, size_t page_idx, std::vector<char> *page);
+
+  void DeleteFile(SpillFile *file);
+
+  /** Free the rows and the table of a partition, and their charge. */
+  void ReleaseRows(Partition *partition);
+
+  /** Get the next chunk of probe rows and hash them. @return false once there is none */
+  auto NextProbeChunk() -> bool;
+
+  /** Load the next group of spilled partitions. @return false once every one has been joined */
+  auto NextSpilledGroup() -> bool;
+
+  /** Decode the next rows of the probe file of the current spilled partition. @return false at its end */
+  auto NextSpilledProbeRows() -> bool;
+
+  /** Hash the selected rows of probe_chunk_, keeping those to look up (spilling them if their partition is). */
+  void PrepareProbeRows();
+
+  /** Prefetch the home slot of a pending probe row. */
+  void PrefetchSlot(size_t pending_idx) const;
+
+  /** Look the pending probe rows up, recording their matches from row `out` on. @return the next free row */
+  auto EmitMatches(DataChunk *chunk, size_t out) -> size_t;
+
+  /** Copy the columns of the matches [begin, end) to the chunk, a column at a time. */
+  void WriteMatches(DataChunk *chunk, size_t begin, size_t end) const;
+
+  std::unique_ptr<Operator> probe_;
+  std::unique_ptr<Operator> build_;
+  uint32_t probe_key_idx_;
+  uint32_t build_key_idx_;
+  BufferPoolManager *bpm_;
+  HashJoinOptions options_;
+  RowLayout probe_layout_;
+  RowLayout build_layout_;
+
+  std::vector<Partition> partitions_;
+  /** The partitions probed: partitions_, or those of the operator a worker was made from. */
+  std::vector<Partition> *probed_{&partitions_};
+  /** A row being spilled. */
+  std::vector<char> row_;
+  /** Bytes charged by the partitions in memory. */
+  size_t memory_used_{0};
+  size_t peak_memory_{0};
+  size_t partitions_spilled_{0};
+
+  Phase phase_{Phase::DONE};
+  DataChunk probe_chunk_;
+  /** The probe rows of probe_chunk_ to look up, with the hash of their key. */
+  std::vector<uint32_t> pending_rows_;
+  std::vector<int64_t> pending_keys_;
+  std::vector<uint64_t> pending_hashes_;
+  /** Next pending row, and the slot its lookup resumes from (UINT64_MAX to start from its home slot). */
+  size_t pending_pos_{0};
+  uint64_t resume_slot_{UINT64_MAX};
+  /** Per row of the output chunk, the probe row and the build row it joins. */
+  std::vector<uint32_t> match_probe_rows_;
+  std::vector<const char *> match_build_rows_;
+
+  /** The spilled partitions left to join, and the group in memory; the first of the group is being probed. */
+  std::vector<size_t> spilled_;
+  std::vector<size_t> group_;
+  /** Probe page of the current spilled partition being decoded, and the next record in it. */
+  size_t probe_page_idx_{0};
+  std::vector<char> probe_page_;
+  uint32_t probe_page_count_{0};
+  uint32_t probe_page_pos_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "execution/operator.h"
+
+namespace redbase {
+
+/** LimitOperator skips the first `offset` rows of its child and stops after `limit` more. */
+class LimitOperator : public Operator {
+ public:
+  LimitOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, size_t limit, size_t offset = 0);
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+ private:
+  std::unique_ptr<Operator> child_;
+  size_t limit_;
+  size_t offset_;
+  /** Rows still to be skipped. */
+  size_t to_skip_{0};
+  /** Rows handed out so far. */
+  size_t emitted_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/task_scheduler.h"
+#include "execution/data_chunk.h"
+#include "rm/schema.h"
+
+namespace redbase {
+
+/** What the operators of a query share. */
+struct ExecutorContext {
+  /** Max number of rows per chunk, the scans read their tables in batches of this size. */
+  size_t batch_size_{EXECUTION_BATCH_SIZE};
+  /** Lower the expressions of the operators into fused kernels, see CompileExpression(). */
+  bool compile_expressions_{true};
+  /** Let the filters hand the comparisons of a column with a constant to the scan below them, see PushDown(). */
+  bool push_down_predicates_{true};
+  /**
+   * Runs the parallel work of the operators: their pipelines a morsel at a time (see ParallelConsume()) and the
+   * phases of their pipeline breakers. Null for every operator to run on threads of its own, num_threads_ of them.
+   */
+  TaskScheduler *scheduler_{nullptr};
+
+  /** @return the threads an operator configured with `num_threads` runs on: the workers of the scheduler if any */
+  auto GetThreadCount(size_t num_threads) const -> size_t {
+    return scheduler_ != nullptr ? scheduler_->GetWorkerCount() : std::max<size_t>(num_threads, 1);
+  }
+};
+
+/**
+ * Operator is a node of a pull-based (volcano) operator tree whose unit of work is a chunk of rows rather than a
+ * single tuple: every call to Next() moves up to batch_size_ rows through the operator, so the cost of the virtual
+ * call and of the per-operator bookkeeping is paid once per batch, and the expressions run as tight loops over
+ * column vectors.
+ *
+ * The caller owns the output chunk and initializes it once with MakeChunk(). An operator may hand out chunks whose
+ * vectors share buffers with its input or with its own state, they stay valid until the next call to Next().
+ */
+class Operator {
+ public:
+  Operator(ExecutorContext *ctx, Schema output_schema) : ctx_(ctx), output_schema_(std::move(output_schema)) {}
+  virtual ~Operator() = default;
+
+  DISALLOW_COPY_AND_MOVE(Operator);
+
+  /** Prepare the operator (and its children) to produce rows from the start. */
+  virtual void Init() = 0;
+
+  /**
+   * @brief Produce the next chunk of rows.
+   * @param[out] chunk initialized by MakeChunk(), overwritten; only its selected rows are part of the output
+   * @return false once the operator is exhausted, true with at least one selected row otherwise
+   */
+  virtual auto Next(DataChunk *chunk) -> bool = 0;
+
+  auto GetOutputSchema() const -> const Schema & { return output_schema_; }
+
+  /**
+   * @brief Make a copy of the pipeline this operator ends, for a worker of a morsel-driven execution: the copy
+   * produces the rows of the morsels (page ranges of the table at the source) it is given by InitMorsel(), and
+   * shares the state of the pipeline breakers below (a built hash table). Called after Init().
+   * @return nullptr if the pipeline cannot be split into morsels
+   */
+  virtual auto MakeWorker() -> std::unique_ptr<Operator> { return nullptr; }
+
+  /** @return the number of morsels of the pipeline, see MakeWorker() */
+  virtual auto GetMorselCount() const -> size_t { return 0; }
+
+  /** Prepare a copy made by MakeWorker() to produce the rows of morsel `morsel_idx`, in place of Init(). */
+  virtual void InitMorsel(size_t morsel_idx) {}
+
+  /** @return a chunk of the output schema, large enough for Next() */
+  auto MakeChunk() const -> DataChunk {
+    DataChunk chunk;
+    chunk.Initialize(output_schema_, ctx_->batch_size_);
+    return chunk;
+  }
+
+ protected:
+  ExecutorContext *ctx_;
+
+ private:
+  Schema output_schema_;
+};
+
+}  // namespace redbase
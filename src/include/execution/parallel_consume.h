@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "execution/operator.h"
+
+namespace redbase {
+
+/**
+ * @brief Pull an initialized operator dry in parallel, for the operators that consume their child with a state per
+ * thread (a pre-aggregation table, a heap of the best rows). The work runs as tasks of the scheduler of the context,
+ * or of a scheduler of its own with `num_threads` workers if the context has none; with neither, the chunks are
+ * consumed in place by the calling thread.
+ *
+ * If the pipeline of the child splits into morsels (see Operator::MakeWorker()), every worker runs a copy of it and
+ * a task per morsel consumes the rows of that morsel: the morsels are dealt to the workers in contiguous blocks, so
+ * that a worker reads neighbouring pages, and the idle workers steal what is left from the others. Otherwise the
+ * calling thread pulls the child, copies the selected rows of each chunk into a chunk of a small pool (chunks may
+ * share buffers with the operator, only valid until the next call to Next()), and spawns a task to consume it. The
+ * first exception thrown by `consume` or by the operator is rethrown once every task is done.
+ *
+ * @param consume called as consume(chunk, thread_idx), thread_idx in [0, ctx->GetThreadCount(num_threads)); a
+ * thread consumes a chunk at a time
+ */
+void ParallelConsume(ExecutorContext *ctx, Operator *child, size_t num_threads,
+                     const std::function<void(const DataChunk &chunk, size_t thread_idx)> &consume);
+
+}  // namespace redbase
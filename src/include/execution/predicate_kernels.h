@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace redbase {
+
+enum class ComparisonType { EQUAL, NOT_EQUAL, LESS_THAN, LESS_EQUAL, GREATER_THAN, GREATER_EQUAL };
+
+/** @return the comparison that holds for (b, a) when `comparison_type` holds for (a, b) */
+auto FlipComparison(ComparisonType comparison_type) -> ComparisonType;
+
+/** Implementations of the predicate kernels. */
+enum class SelectKernel { SCALAR, AVX2, AVX512 };
+
+/** @return the fastest kernel the CPU supports, detected once */
+auto GetSelectKernel() -> SelectKernel;
+
+/** @return the name of a kernel */
+auto SelectKernelName(SelectKernel kernel) -> const char *;
+
+enum class PredicateKind { COMPARE, BETWEEN, IN };
+
+/**
+ * A predicate on a fixed-width column against constants: `value <op> constant`, `value BETWEEN low AND high`
+ * (bounds included) or `value IN (list)`. T is the C++ type of the column: int32_t for INTEGER and DATE, int64_t
+ * for BIGINT, double for DOUBLE.
+ */
+template <typename T>
+struct ColumnPredicate {
+  static auto Compare(ComparisonType comparison_type, T constant) -> ColumnPredicate {
+    return {PredicateKind::COMPARE, comparison_type, constant, constant, {}};
+  }
+
+  static auto Between(T low, T high) -> ColumnPredicate {
+    return {PredicateKind::BETWEEN, ComparisonType::EQUAL, low, high, {}};
+  }
+
+  static auto In(std::vector<T> list) -> ColumnPredicate {
+    return {PredicateKind::IN, ComparisonType::EQUAL, T{}, T{}, std::move(list)};
+  }
+
+  PredicateKind kind_;
+  ComparisonType comparison_type_;
+  /** The operand of a comparison, the lower bound of a BETWEEN. */
+  T low_;
+  /** The upper bound of a BETWEEN. */
+  T high_;
+  std::vector<T> in_list_;
+};
+
+/**
+ * @brief Keep the rows of a selection whose value satisfies the predicate. NULL values never do.
+ *
+ * The comparisons run a vector of values at a time (8 or 16 lanes with AVX-512, 4 or 8 with AVX2), the passing rows
+ * are written out without a branch per row. A conjunction is evaluated by refining a selection predicate after
+ * predicate, each one only looking at the rows the previous ones kept.
+ *
+ * @param data the values of the column, indexed by row
+ * @param nulls the NULL flags of the column, one byte per row, non-zero for NULL
+ * @param selection the rows to look at, in increasing order; null for all rows [0, count)
+ * @param count number of rows in the selection
+ * @param[out] out the rows kept, in increasing order; room for `count` rows, may be the selection itself
+ * @param kernel must be supported by the CPU (see GetSelectKernel())
+ * @return the number of rows kept
+ */
+template <typename T>
+auto SelectRows(const ColumnPredicate<T> &predicate, const T *data, const uint8_t *nulls, const uint32_t *selection,
+                size_t count, uint32_t *out, SelectKernel kernel = GetSelectKernel()) -> size_t;
+
+/**
+ * @brief Evaluate the predicate on all rows [0, count) into a bitmap: bit r % 64 of word r / 64 is set if row r
+ * satisfies it. The (count + 63) / 64 words are overwritten, the bits past `count` are cleared.
+ */
+template <typename T>
+void SelectBitmap(const ColumnPredicate<T> &predicate, const T *data, const uint8_t *nulls, size_t count,
+                  uint64_t *bitmap, SelectKernel kernel = GetSelectKernel());
+
+/** @return the number of rows set in a bitmap of `count` rows, written to `out` in increasing order */
+auto BitmapToSelection(const uint64_t *bitmap, size_t count, uint32_t *out) -> size_t;
+
+}  // namespace redbase
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "execution/expression.h"
+#include "execution/operator.h"
+
+namespace redbase {
+
+/**
+ * ProjectionOperator computes one output column per expression over the selected rows of its child. A column
+ * reference is passed through without a copy, the output shares the vector of the input.
+ */
+class ProjectionOperator : public Operator {
+ public:
+  ProjectionOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, std::vector<ExpressionRef> expressions);
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+  auto MakeWorker() -> std::unique_ptr<Operator> override;
+
+  auto GetMorselCount() const -> size_t override { return child_->GetMorselCount(); }
+
+  void InitMorsel(size_t morsel_idx) override;
+
+ private:
+  std::unique_ptr<Operator> child_;
+  std::vector<ExpressionRef> expressions_;
+  DataChunk input_;
+};
+
+}  // namespace redbase
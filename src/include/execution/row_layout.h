@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "execution/data_chunk.h"
+
+namespace redbase {
+
+/** Call `f` with the width of a column as a constant if it is 4 or 8 bytes, with 0 otherwise. */
+template <typename F>
+void DispatchWidth(uint32_t width, F &&f) {
+  switch (width) {
+    case 4:
+      f(std::integral_constant<uint32_t, 4>{});
+      break;
+    case 8:
+      f(std::integral_constant<uint32_t, 8>{});
+      break;
+    default:
+      f(std::integral_constant<uint32_t, 0>{});
+      break;
+  }
+}
+
+/**
+ * RowLayout is the row format of the operators that keep rows around, out of their chunks (the build side of a hash
+ * join, the runs of a sort): the NULL flags of the columns, a byte each, followed by their values at fixed offsets.
+ */
+class RowLayout {
+ public:
+  explicit RowLayout(const Schema &schema);
+
+  /** @return the number of bytes of a row */
+  auto GetSize() const -> uint32_t { return size_; }
+  auto GetColumnCount() const -> size_t { return widths_.size(); }
+  auto GetOffset(size_t col_idx) const -> uint32_t { return offsets_[col_idx]; }
+  auto GetWidth(size_t col_idx) const -> uint32_t { return widths_[col_idx]; }
+
+  /** Copy a row of a chunk out, `out` has GetSize() bytes. */
+  void Store(const DataChunk &chunk, uint32_t row, char *out) const;
+
+  /** Copy a row into the columns [first_col, first_col + GetColumnCount()) of a chunk. */
+  void Load(const char *in, DataChunk *chunk, size_t row, size_t first_col) const;
+
+  /** Copy rows into the rows [first_row, first_row + count) of a chunk, a column at a time, see Load(). */
+  void Gather(const char *const *rows, size_t count, DataChunk *chunk, size_t first_row, size_t first_col) const;
+
+ private:
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> widths_;
+  uint32_t size_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "execution/expression.h"
+#include "execution/operator.h"
+#include "rm/dynamic_filter.h"
+#include "rm/table_heap.h"
+#include "rm/tuple_view.h"
+
+namespace redbase {
+
+/**
+ * SeqScanOperator reads a table heap through a TableScanIterator, batch_size_ tuples at a time, and decodes the
+ * columns it is asked for straight from the pinned pages into the vectors of the chunk, one column at a time.
+ *
+ * A dynamic filter, narrowed by an operator above while the scan runs, lets the scan skip the pages the zone map of
+ * the heap rules out, and drop the rows outside its range (with the predicate kernels) if its column is read.
+ *
+ * Comparisons of a column with a constant can be pushed down into the scan (see PushDown()): the iterator checks
+ * them on the bytes of each tuple in its pinned page, so the tuples that fail are never decoded, and with a zone map
+ * on the heap it skips the pages where no tuple can pass.
+ */
+class SeqScanOperator : public Operator {
+ public:
+  /**
+   * @param table_schema the layout of the tuples of the heap
+   * @param column_idxs the columns to read, indices into the table schema; the output has them in this order
+   */
+  SeqScanOperator(ExecutorContext *ctx, TableHeap *heap, const Schema *table_schema,
+                  std::vector<uint32_t> column_idxs);
+
+  /** A worker counts what it skipped in the totals of the scan it was made from. */
+  ~SeqScanOperator() override;
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+  /** A worker scans the pages of the heap as of Init(), MORSEL_PAGES of them per morsel. */
+  auto MakeWorker() -> std::unique_ptr<Operator> override;
+
+  auto GetMorselCount() const -> size_t override;
+
+  void InitMorsel(size_t morsel_idx) override;
+
+  /** Check a dynamic filter on a column of the table from the next Init() on, see DynamicFilter. */
+  void SetDynamicFilter(std::shared_ptr<const DynamicFilter> filter);
+
+  /** Drop the tuples outside a range on a column of the table, in their pages, from the next Init() on. */
+  void PushPredicate(ColumnRange range);
+
+  /**
+   * @brief Take over the conjuncts of a predicate on the output of the scan that compare a column with a non-NULL
+   * constant (NOT_EQUAL aside) or that are a BETWEEN of a column, see PushPredicate().
+   * @return the rest of the predicate, to be evaluated on the output; nullptr if nothing is left
+   */
+  auto PushDown(const ExpressionRef &predicate) -> ExpressionRef;
+
+  /** @return the number of pages skipped thanks to the zone map since the last Init(), by the workers too */
+  auto GetPagesSkipped() const -> size_t {
+    return stats_->pages_skipped_ + (iter_.has_value() ? iter_->GetPagesSkipped() : 0);
+  }
+
+  /** @return the number of rows of the pages read that the dynamic filter dropped since the last Init() */
+  auto GetRowsFiltered() const -> size_t { return stats_->rows_filtered_; }
+
+  /** @return the number of tuples the pushed-down ranges dropped since the last Init(), by the workers too */
+  auto GetTuplesFiltered() const -> size_t {
+    return stats_->tuples_filtered_ + (iter_.has_value() ? iter_->GetTuplesFiltered() : 0);
+  }
+
+ private:
+  /** Start a scan of the pages [begin, end) of the heap. */
+  void Open(size_t begin, size_t end);
+
+  /** Decode the columns of the tuples of batch_ into the chunk. */
+  void DecodeBatch(DataChunk *chunk);
+
+  /** Drop the rows of the chunk outside the range of the dynamic filter. */
+  void ApplyDynamicFilter(DataChunk *chunk);
+
+  /** @return the range on a table column a conjunct amounts to, nullopt if it cannot be pushed down */
+  auto MatchRange(const ExpressionRef &conjunct) const -> std::optional<ColumnRange>;
+
+  /** Add the counters of the iterator to the totals and close it. */
+  void CloseIterator();
+
+  TableHeap *heap_;
+  const Schema *table_schema_;
+  std::vector<uint32_t> column_idxs_;
+  std::optional<TableScanIterator> iter_;
+  /** Pages of the heap as of Init(), split into morsels. */
+  size_t page_count_{0};
+  /** The tuples of the last batch, pinned by the iterator until the next one. */
+  std::vector<TupleView> batch_;
+  /** Ranges on columns of the table the iterator checks on the tuples. */
+  std::vector<ColumnRange> pushed_;
+
+  std::shared_ptr<const DynamicFilter> filter_;
+  /** The output column of the filter column, if it is read. */
+  std::optional<size_t> filter_output_idx_;
+  /** The range of the filter as of version filter_version_, and the NULL rows of a chunk when it keeps them. */
+  ColumnRange filter_range_;
+  uint64_t filter_version_{0};
+  std::vector<uint32_t> null_rows_;
+  std::vector<uint32_t> merged_rows_;
+
+  /** What the scan skipped, shared with its workers. */
+  struct Stats {
+    std::atomic<size_t> pages_skipped_{0};
+    std::atomic<size_t> rows_filtered_{0};
+    std::atomic<size_t> tuples_filtered_{0};
+  };
+  std::shared_ptr<Stats> stats_{std::make_shared<Stats>()};
+};
+
+}  // namespace redbase
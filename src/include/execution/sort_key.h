@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "execution/data_chunk.h"
+
+namespace redbase {
+
+/** A column of the ORDER BY of a sort. */
+struct SortKey {
+  uint32_t col_idx_;
+  bool ascending_{true};
+};
+
+/**
+ * SortKeyEncoder encodes the sort keys of rows into binary strings whose byte order (memcmp) is the order of the
+ * rows: per key column the encoding of KeyNormalizer (a flag byte, 0 for NULL, then the value), every byte of a
+ * descending column inverted. NULLs thus come first in ascending order and last in descending order. The keys are
+ * encoded a column at a time, straight from the vectors of a chunk.
+ */
+class SortKeyEncoder {
+ public:
+  /** @param schema the schema of the chunks to encode */
+  SortKeyEncoder(const Schema &schema, std::vector<SortKey> keys);
+
+  /** @return the size of an encoded key */
+  auto GetKeySize() const -> uint32_t { return key_size_; }
+
+  auto GetKeys() const -> const std::vector<SortKey> & { return keys_; }
+
+  /** Encode the keys of the selected rows of a chunk into `out`, `out + stride`, ... */
+  void Encode(const DataChunk &chunk, char *out, size_t stride) const;
+
+ private:
+  std::vector<SortKey> keys_;
+  uint32_t key_size_{0};
+};
+
+}  // namespace redbase
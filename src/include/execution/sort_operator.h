@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/external_sorter.h"
+#include "buffer/sorted_run.h"
+#include "common/util/loser_tree.h"
+#include "execution/operator.h"
+#include "execution/row_layout.h"
+#include "execution/sort_key.h"
+
+namespace redbase {
+
+/**
+ * SortOperator is the ORDER BY of its child: NULLs come first in ascending order, last in descending order, and rows
+ * with equal keys come in no particular order. The child is consumed by Init().
+ *
+ * Each row is copied into a record: its key (see SortKeyEncoder) followed by the row (see RowLayout), so that rows are
+ * compared with memcmp whatever the key columns. What gets sorted is an array of entries, the first 8 bytes of the
+ * key as an integer and the index of the record, so that most comparisons settle on the prefix without touching the
+ * records, and a sort moves 16 bytes per row whatever their width. The array is sorted in parallel (see
+ * ParallelSort()), by the workers of the scheduler of the context if it has one, by num_threads_ threads otherwise.
+ *
+ * When the records outgrow memory_budget_ they are sorted and written as a run to temp pages of the buffer pool, and
+ * once the child is exhausted the runs are merged through a LoserTree, max_fan_in_ at a time, until one pass can
+ * produce the output. Each run page is copied out and deleted as soon as the merge reaches it, while the next
+ * SCAN_READ_AHEAD pages of the run are prefetched (see SortedRun).
+ */
+class SortOperator : public Operator {
+ public:
+  /** @param bpm the buffer pool of the temp pages of the runs */
+  SortOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, std::vector<SortKey> keys,
+               BufferPoolManager *bpm, ExternalSortOptions options = {});
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+  /** @return the number of runs written by the last Init(), intermediate merge passes included */
+  auto GetRunsSpilled() const -> size_t { return runs_spilled_; }
+
+ private:
+  /** A record in memory: the first bytes of its key, big endian, and its index in the arena. */
+  struct Entry {
+    uint64_t prefix_;
+    uint32_t idx_;
+  };
+
+  /** Orders the runs of a merge by their heads, the exhausted ones last. */
+  struct RunOrder {
+    auto operator()(size_t lhs, size_t rhs) const -> bool;
+    const std::vector<SortedRun> *runs_;
+    uint32_t key_size_;
+  };
+
+  /** Encode the selected rows of a chunk into records. */
+  void AppendChunk(const DataChunk &chunk);
+
+  auto RecordAt(uint32_t idx) const -> const char * { return arena_.data() + size_t{idx} * record_size_; }
+
+  /** Sort the entries of the records in memory. */
+  void SortEntries();
+
+  /** Sort the records in memory and write them out as a run. */
+  void SpillRun();
+
+  /** Load the first record of every run and play the matches of the merge. */
+  void OpenMerge(std::vector<SortedRun> *runs);
+
+  /** @return the smallest head of the merge, nullptr once the runs are exhausted; the run moves on at the next call */
+  auto NextMerged(std::vector<SortedRun> *runs) -> const char *;
+
+  /** Merge some runs into a new one, the inputs are consumed. */
+  auto MergeRuns(std::vector<SortedRun> *inputs) -> SortedRun;
+
+  std::unique_ptr<Operator> child_;
+  SortKeyEncoder encoder_;
+  BufferPoolManager *bpm_;
+  ExternalSortOptions options_;
+  RowLayout layout_;
+  uint32_t key_size_{0};
+  uint32_t record_size_{0};
+
+  /** The records in memory, and an entry per record. */
+  std::vector<char> arena_;
+  std::vector<Entry> entries_;
+  /** Next entry handed out when nothing was spilled. */
+  size_t entry_pos_{0};
+
+  std::vector<SortedRun> runs_;
+  std::optional<LoserTree<RunOrder>> tree_;
+  /** The top run of the merge has to move on before the next record is handed out. */
+  bool advance_top_{false};
+  size_t runs_spilled_{0};
+  /** Rows of the output chunk, as records. */
+  std::vector<const char *> out_rows_;
+};
+
+}  // namespace redbase
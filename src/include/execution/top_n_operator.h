@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "execution/operator.h"
+#include "execution/row_layout.h"
+#include "execution/sort_key.h"
+#include "rm/dynamic_filter.h"
+
+namespace redbase {
+
+/** Knobs of a Top-N. */
+struct TopNOptions {
+  /** Threads consuming the input, each into a heap of its own, when the context has no scheduler. */
+  size_t num_threads_{1};
+};
+
+/**
+ * TopNOperator is an ORDER BY followed by a LIMIT: it hands out the rows [offset, offset + limit) of the order of
+ * SortOperator (NULLs first in ascending order, last in descending order) without sorting its whole input. The child
+ * is consumed by Init().
+ *
+ * Every thread keeps the best limit + offset rows it has seen in a max-heap of records, a sort key (see
+ * SortKeyEncoder) followed by the row (see RowLayout): a row is compared with the worst of the heap by its key alone,
+ * and only copied when it gets in. Once the input is exhausted the heaps are merged and sorted.
+ *
+ * A full heap also bounds the first key column: a row whose first key is past that of the worst row of the heap can
+ * never get in. If the operator was asked for a dynamic filter, every thread narrows it to that bound after each
+ * chunk, and the scan below checks it to skip pages and rows (see SeqScanOperator::SetDynamicFilter()).
+ */
+class TopNOperator : public Operator {
+ public:
+  /** @param limit, offset the rows handed out are [offset, offset + limit) of the order */
+  TopNOperator(ExecutorContext *ctx, std::unique_ptr<Operator> child, std::vector<SortKey> keys, size_t limit,
+               size_t offset = 0, TopNOptions options = {});
+
+  /**
+   * @brief Make the dynamic filter the operator narrows from now on, for a scan below to check. Only a first key over
+   * a numeric column gets narrowed.
+   * @param column_idx the column of the table the first key is read from
+   */
+  auto MakeDynamicFilter(uint32_t column_idx) -> std::shared_ptr<const DynamicFilter>;
+
+  void Init() override;
+
+  auto Next(DataChunk *chunk) -> bool override;
+
+ private:
+  /** The best rows a thread has seen. */
+  struct Heap {
+    /** Up to limit + offset records. */
+    std::vector<char> records_;
+    /** A max-heap of record indexes by key, the worst row on top. */
+    std::vector<uint32_t> order_;
+    /** The keys of the chunk being consumed. */
+    std::vector<char> keys_;
+  };
+
+  auto RecordAt(const Heap &heap, uint32_t idx) const -> const char * {
+    return heap.records_.data() + size_t{idx} * record_size_;
+  }
+
+  /** Offer the selected rows of a chunk to the heap of a thread. */
+  void Consume(const DataChunk &chunk, Heap *heap) const;
+
+  /** Narrow the dynamic filter to the first key of the worst row of a full heap. */
+  void Publish(const Heap &heap) const;
+
+  std::unique_ptr<Operator> child_;
+  SortKeyEncoder encoder_;
+  size_t limit_;
+  size_t offset_;
+  TopNOptions options_;
+  RowLayout layout_;
+  uint32_t key_size_{0};
+  uint32_t record_size_{0};
+
+  std::shared_ptr<DynamicFilter> filter_;
+
+  std::vector<Heap> heaps_;
+  /** The rows of the output, in order. */
+  std::vector<const char *> rows_;
+  size_t row_pos_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "ix/b_plus_tree_header_page.h"
+#include "ix/b_plus_tree_internal_page.h"
+#include "ix/b_plus_tree_leaf_page.h"
+#include "ix/bloom_filter.h"
+#include "ix/generic_key.h"
+#include "ix/index_iterator.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+/** The latches a modifying descent holds. */
+class Context {
+ public:
+  /** Write latch on the header page, held for as long as the root may be replaced. */
+  std::optional<WritePageGuard> header_page_{std::nullopt};
+
+  /** The root when the descent started, valid while header_page_ is held. */
+  page_id_t root_page_id_{INVALID_PAGE_ID};
+
+  /** The write latched nodes of the path that may still be modified, the one closest to the root first. */
+  std::deque<WritePageGuard> write_set_;
+
+  auto IsRootPage(page_id_t page_id) const -> bool { return page_id == root_page_id_; }
+
+  /** Release the header and every node above the last one, once that node is known to be safe. */
+  void ReleaseAncestors() {
+    header_page_ = std::nullopt;
+    while (write_set_.size() > 1) {
+      write_set_.pop_front();
+    }
+  }
+};
+
+#define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * BPlusTree is the index of the IX layer: a disk-resident B+ tree whose nodes are buffer pool pages, reached
+ * through a header page that holds the root id. Keys are unique, a non-unique index is a tree over NonUniqueKey
+ * (see GetAllValues()).
+ *
+ * Descents are optimistic first (optimistic lock coupling): the header and inner nodes are pinned but not latched,
+ * each node's version is taken before reading it and the parent's version is validated once the child is pinned, so
+ * that a descent restarts whenever a writer touched a node it went through. Only the leaf is latched, read latched for
+ * lookups and scans, write latched for an insert or remove that cannot split or underflow it.
+ *
+ * After MAX_OPTIMISTIC_RESTARTS failed attempts, and for every structure modification, the tree falls back to latch
+ * crabbing. Readers latch a child before releasing its parent. Inserts and removes write latch their path top down
+ * and release every ancestor (the header page included) as soon as the current node is safe, i.e. cannot split or
+ * underflow, so that only a structure modification keeps the upper levels latched. Leaf siblings are always latched
+ * left to right, which is also the order of the range iterators.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree {
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  /** Called by a descent with the parent of the leaf it reaches, which it may read but must not keep. */
+  using LeafParentVisitor = std::function<void(const InternalPage *)>;
+
+ public:
+  /**
+   * @brief Create a new, empty tree.
+   * @param leaf_max_size max number of entries of a leaf
+   * @param internal_max_size max number of children of an internal node
+   */
+  BPlusTree(std::string name, BufferPoolManager *bpm, const KeyComparator &comparator,
+            int leaf_max_size = LeafPage::SLOT_CNT - 1, int internal_max_size = InternalPage::SLOT_CNT - 1);
+
+  /**
+   * @brief Open an existing tree.
+   * @param header_page_id the header page of the tree, see GetHeaderPageId()
+   */
+  BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *bpm, const KeyComparator &comparator,
+            int leaf_max_size = LeafPage::SLOT_CNT - 1, int internal_max_size = InternalPage::SLOT_CNT - 1);
+
+  /** @return true if the tree holds no key */
+  auto IsEmpty() const -> bool;
+
+  /**
+   * @brief Insert a key/value pair.
+   * @return false if the key is already in the tree
+   */
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * @brief Remove a key and its value.
+   * @return false if the key is not in the tree
+   */
+  auto Remove(const KeyType &key) -> bool;
+
+  /**
+   * @brief Point lookup.
+   * @param[out] result the value of the key is appended to it
+   * @return true if the key is in the tree
+   */
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) const -> bool;
+
+  /**
+   * @brief Batched point lookups, such as the probes of an index nested-loop join. The keys are sorted, then the
+   * leaves are visited in key order, each one read latched once for all the keys it may hold. A key past the current
+   * leaf moves on to its right sibling when it lies there, and descends again otherwise; every descent prefetches the
+   * leaves its parent routes the next keys to, so that they are read while the current leaf is searched.
+   * @param[out] results one entry per key, in the order of `keys`: its value, or nullopt if it is not in the tree
+   * @return the number of keys found
+   */
+  auto GetValues(const std::vector<KeyType> &keys, std::vector<std::optional<ValueType>> *results) const -> size_t;
+
+  /**
+   * @brief Build the tree bottom-up from entries handed out in strictly increasing key order, which is much cheaper
+   * than inserting them one by one: leaves are filled left to right, then each inner level is built over the one
+   * below, and every node is flushed as soon as it is complete, so the index is written sequentially. Nodes are packed
+   * to `fill_factor` of their max size (never below their min size), keeping the rest free for later inserts.
+   *
+   * The tree must be empty. The header stays write latched for the whole build.
+   *
+   * @param num_entries the number of entries `next` hands out
+   * @param next produces the next entry, returns false once there is none left
+   * @param fill_factor fraction of each node filled, in (0, 1]
+   */
+  void BulkLoad(size_t num_entries, const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = 1.0);
+
+  /** @return an iterator on the smallest key */
+  auto Begin() const -> INDEXITERATOR_TYPE;
+
+  /** @return an iterator on the first key not smaller than `key` */
+  auto Begin(const KeyType &key) const -> INDEXITERATOR_TYPE;
+
+  /** @return the end iterator */
+  auto End() const -> INDEXITERATOR_TYPE { return {}; }
+
+  auto GetRootPageId() const -> page_id_t;
+
+  auto GetHeaderPageId() const -> page_id_t { return header_page_id_; }
+
+  auto GetComparator() const -> const KeyComparator & { return comparator_; }
+
+  /**
+   * @brief Consult a Bloom filter before every point lookup, and add every key inserted or bulk loaded from now on to
+   * it. Keys already in the tree are not added: attach the filter to an empty tree, or to one it was flushed with.
+   */
+  void SetBloomFilter(BloomFilter *bloom_filter) { bloom_filter_ = bloom_filter; }
+
+  auto GetBloomFilter() const -> BloomFilter * { return bloom_filter_; }
+
+ private:
+  /** Optimistic descents tried before an operation falls back to latch crabbing. */
+  static constexpr int MAX_OPTIMISTIC_RESTARTS = 16;
+
+  /**
+   * @brief Descend to the leaf that may hold `key` (the leftmost leaf if `key` is null) without latching any page.
+   * @param[out] leaf the leaf, pinned but not latched, not valid if the tree is empty
+   * @param[out] leaf_version the version of the leaf the descent validated against
+   * @return false if a writer got in the way, the descent has to restart
+   */
+  auto TryFindLeafOptimistic(const KeyType *key, BasicPageGuard *leaf, uint64_t *leaf_version,
+                             const LeafParentVisitor &visit_parent = nullptr) const -> bool;
+
+  /**
+   * @param visit_parent if set, called with the parent of the leaf, which an optimistic descent has not validated yet
+   * @return the leaf that may hold `key` (the leftmost leaf if `key` is null), read latched
+   */
+  auto FindLeafRead(const KeyType *key, const LeafParentVisitor &visit_parent = nullptr) const -> ReadPageGuard;
+
+  /** FindLeafRead() through latch crabbing only. */
+  auto FindLeafReadPessimistic(const KeyType *key, const LeafParentVisitor &visit_parent = nullptr) const
+      -> ReadPageGuard;
+
+  /**
+   * @brief Write latch the leaf of `key` through an optimistic descent.
+   * @return an invalid guard if the tree is empty, or if the leaf is not safe for the operation (checked by
+   * `is_safe`) or cannot be reached without restarting too often, in which case the caller goes pessimistic
+   */
+  template <typename IsSafe>
+  auto FindLeafWriteOptimistic(const KeyType &key, IsSafe is_safe) -> WritePageGuard;
+
+  /** Insert through latch crabbing, for inserts that may split nodes. */
+  auto InsertPessimistic(const KeyType &key, const ValueType &value) -> bool;
+
+  /** Remove through latch crabbing, for removes that may merge nodes. */
+  auto RemovePessimistic(const KeyType &key) -> bool;
+
+  /** Allocate and write latch a page for a new node. */
+  auto NewNode(page_id_t *page_id) -> WritePageGuard;
+
+  /**
+   * @brief Register the split of the last node of the write set with its parent, splitting the parent in turn if it
+   * overflows. The split node is popped from the write set.
+   */
+  void InsertIntoParent(Context *ctx, page_id_t old_page_id, const KeyType &key, page_id_t new_page_id);
+
+  /** Fix the last node of the write set after a removal: borrow, merge or shrink the root, up the path as needed. */
+  void HandleUnderflow(Context *ctx);
+
+  /**
+   * @brief Split the `num_items` entries of a level evenly over nodes filled to about `fill_factor`.
+   * @return the number of nodes, each of which gets at least min_size and at most max_size entries if there are two
+   * or more
+   */
+  static auto BulkLevelWidth(size_t num_items, int max_size, int min_size, double fill_factor) -> size_t;
+
+  /** Release a node built by BulkLoad() and write it out. */
+  void FlushNode(WritePageGuard *guard);
+
+  /** Delete a node whose guard has been dropped, waiting a little for optimistic readers to unpin it. */
+  void FreeNode(page_id_t page_id);
+
+  std::string index_name_;
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+  page_id_t header_page_id_;
+  /** Shortcut for absent keys, may be null. */
+  BloomFilter *bloom_filter_{nullptr};
+};
+
+/**
+ * @brief Collect the values of every entry of a key in a non-unique index.
+ * @return true if the key has at least one entry
+ */
+template <typename KeyType, typename KeyComparator>
+auto GetAllValues(const BPlusTree<NonUniqueKey<KeyType>, RID, NonUniqueComparator<KeyType, KeyComparator>> &tree,
+                  const KeyType &key, std::vector<RID> *result) -> bool {
+  const KeyComparator &comparator = tree.GetComparator().GetKeyComparator();
+  size_t old_size = result->size();
+  for (auto iter = tree.Begin(NonUniqueKey<KeyType>::MakeLowest(key)); !iter.IsEnd(); ++iter) {
+    if (comparator((*iter).first.key_, key) != 0) {
+      break;
+    }
+    result->push_back((*iter).second);
+  }
+  return result->size() > old_size;
+}
+
+}  // namespace redbase
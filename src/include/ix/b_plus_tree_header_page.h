@@ -0,0 +1,20 @@
+#pragma once
+
+#include "common/config.h"
+
+namespace redbase {
+
+/**
+ * The header page of a B+ tree never moves, it points at the current root. Latching it is how a structure
+ * modification that replaces the root excludes every other descent.
+ */
+class BPlusTreeHeaderPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreeHeaderPage() = delete;
+  BPlusTreeHeaderPage(const BPlusTreeHeaderPage &other) = delete;
+
+  page_id_t root_page_id_;
+};
+
+}  // namespace redbase
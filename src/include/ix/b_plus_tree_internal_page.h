@@ -0,0 +1,172 @@
+#pragma once
+
+#include <utility>
+
+#include "ix/b_plus_tree_page.h"
+#include "ix/b_plus_tree_prefix_page.h"
+#include "ix/normalized_key.h"
+
+namespace redbase {
+
+#define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
+static constexpr size_t INTERNAL_PAGE_HEADER_SIZE = INDEX_PAGE_HEADER_SIZE;
+
+/**
+ * Internal page of a B+ tree, n keys and n+1 child pointers stored as n+1 (key, child) pairs whose first key is
+ * unused. As in leaves, keys and children live in two separate arrays:
+ *
+ *  ---------------------------------------------------------------------------------------
+ *  | HEADER | INVALID_KEY | KEY(2) | ... | KEY(n) | PAGE_ID(1) | PAGE_ID(2) | ... | PAGE_ID(n) |
+ *  ---------------------------------------------------------------------------------------
+ *
+ * Child i holds the keys K with KeyAt(i) <= K < KeyAt(i+1). The size of an internal page is its number of children.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeInternalPage : public BPlusTreePage {
+ public:
+  /** Number of entries that fit into a page, with room for the padding that aligns the key array. */
+  static constexpr int SLOT_CNT =
+      (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - alignof(KeyType)) / (sizeof(KeyType) + sizeof(ValueType));
+
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreeInternalPage() = delete;
+  BPlusTreeInternalPage(const BPlusTreeInternalPage &other) = delete;
+
+  /** @param max_size max number of children, one slot is kept free for splits */
+  void Init(int max_size = SLOT_CNT - 1);
+
+  auto KeyAt(int index) const -> KeyType { return keys_[index]; }
+  void SetKeyAt(int index, const KeyType &key) { keys_[index] = key; }
+
+  auto ValueAt(int index) const -> ValueType { return values_[index]; }
+  void SetValueAt(int index, const ValueType &value) { values_[index] = value; }
+
+  /** @return the index of a child pointer, -1 if it is not in the page */
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  /** @return the index of the child whose subtree may hold the key */
+  auto LookupIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /** @return the child whose subtree may hold the key */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+    return ValueAt(LookupIndex(key, comparator));
+  }
+
+  /** Turn the page into a root with two children, `key` separating them. */
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &key, const ValueType &new_value);
+
+  /** Insert (key, value) right after the child at `index`. */
+  void InsertAfter(int index, const KeyType &key, const ValueType &value);
+
+  /** Remove the key and child at `index`. */
+  void Remove(int index);
+
+  /**
+   * @brief Move the upper half of the children to an empty sibling, on a split.
+   * @return the key that separates the two pages in the parent
+   */
+  auto MoveHalfTo(BPlusTreeInternalPage *recipient) -> KeyType;
+
+  /** Append every child to the left sibling, `middle_key` being the separator of the two pages in the parent. */
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+
+  /**
+   * @brief Move the first child to the end of the left sibling.
+   * @return the new separator of the two pages
+   */
+  auto MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) -> KeyType;
+
+  /**
+   * @brief Move the last child to the front of the right sibling.
+   * @return the new separator of the two pages
+   */
+  auto MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) -> KeyType;
+
+  /** @return true if the children of the right sibling fit into the page, for a merge */
+  auto CanMergeRight(const BPlusTreeInternalPage *right) const -> bool {
+    return GetSize() + right->GetSize() <= GetMaxSize();
+  }
+
+  /** @return true if the page can take the last child of its left sibling */
+  auto CanBorrowLast(const BPlusTreeInternalPage * /*left*/) const -> bool { return true; }
+
+  /** @return true if the page can take the first child of its right sibling */
+  auto CanBorrowFirst(const BPlusTreeInternalPage * /*right*/) const -> bool { return true; }
+
+  /** Record the key range the parent routes to the page, only prefix-compressed pages keep it. */
+  void SetKeyRange(const KeyType * /*low*/, const KeyType * /*high*/) {}
+
+  /** @return the max size of a new page asked to hold up to `max_size` children */
+  static auto InitialMaxSize(int max_size) -> int { return max_size; }
+
+ private:
+  /** Shift the entries in [index, size) one slot to the right. */
+  void ShiftRight(int index);
+
+  KeyType keys_[SLOT_CNT];
+  ValueType values_[SLOT_CNT];
+};
+
+/**
+ * Internal page of a tree over NormalizedKeys, with the API of the other internal pages but prefix-compressed keys
+ * (see BPlusTreePrefixPage). The fences of a page are the separators around it in its parent, moving children between
+ * siblings also moves them.
+ */
+template <size_t KeySize, typename ValueType>
+class BPlusTreeInternalPage<NormalizedKey<KeySize>, ValueType, NormalizedComparator<KeySize>>
+    : public BPlusTreePrefixPage<KeySize, ValueType> {
+  using Base = BPlusTreePrefixPage<KeySize, ValueType>;
+  using KeyType = NormalizedKey<KeySize>;
+  using KeyComparator = NormalizedComparator<KeySize>;
+
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreeInternalPage() = delete;
+  BPlusTreeInternalPage(const BPlusTreeInternalPage &other) = delete;
+
+  /** @param max_size max number of children, one slot is kept free for splits */
+  void Init(int max_size = Base::SLOT_CNT - 1);
+
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  auto LookupIndex(const KeyType &key, const KeyComparator & /*comparator*/) const -> int {
+    return this->Search(key, 1, true) - 1;
+  }
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+    return this->ValueAt(LookupIndex(key, comparator));
+  }
+
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &key, const ValueType &new_value);
+  void InsertAfter(int index, const KeyType &key, const ValueType &value);
+  void Remove(int index);
+
+  auto MoveHalfTo(BPlusTreeInternalPage *recipient) -> KeyType;
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  auto MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) -> KeyType;
+  auto MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) -> KeyType;
+
+  /** A merge widens the range of the page up to the high fence of its right sibling. */
+  auto CanMergeRight(const BPlusTreeInternalPage *right) const -> bool {
+    return this->Fits(this->GetSize() + right->GetSize(), this->LowFence(), right->HighFence());
+  }
+
+  /** The last separator of the left sibling becomes the low fence of the page. */
+  auto CanBorrowLast(const BPlusTreeInternalPage *left) const -> bool {
+    if (left->GetSize() < 3) {
+      return false;
+    }
+    KeyType low = left->KeyAt(left->GetSize() - 1);
+    return this->Fits(this->GetSize() + 1, &low, this->HighFence());
+  }
+
+  /** The first separator of the right sibling becomes the high fence of the page. */
+  auto CanBorrowFirst(const BPlusTreeInternalPage *right) const -> bool {
+    if (right->GetSize() < 3) {
+      return false;
+    }
+    KeyType high = right->KeyAt(1);
+    return this->Fits(this->GetSize() + 1, this->LowFence(), &high);
+  }
+};
+
+}  // namespace redbase
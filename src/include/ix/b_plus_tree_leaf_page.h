@@ -0,0 +1,157 @@
+#pragma once
+
+#include <utility>
+
+#include "ix/b_plus_tree_page.h"
+#include "ix/b_plus_tree_prefix_page.h"
+#include "ix/normalized_key.h"
+
+namespace redbase {
+
+#define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
+static constexpr size_t LEAF_PAGE_HEADER_SIZE = INDEX_PAGE_HEADER_SIZE + sizeof(page_id_t);
+
+/**
+ * Leaf page of a B+ tree, sorted (key, value) pairs plus the id of the next leaf so that range scans can walk the
+ * leaf level from left to right. Keys and values are stored in two arrays, so that a search only touches keys and,
+ * for integer keys, can compare several of them per instruction (see node_search.h):
+ *
+ *  ------------------------------------------------------------------------------------
+ *  | HEADER | NextPageId (4) | KEY(1) | KEY(2) | ... | KEY(n) | VALUE(1) | ... | VALUE(n) |
+ *  ------------------------------------------------------------------------------------
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeLeafPage : public BPlusTreePage {
+ public:
+  /** Number of entries that fit into a page, with room for the padding that aligns the key array. */
+  static constexpr int SLOT_CNT =
+      (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - alignof(KeyType)) / (sizeof(KeyType) + sizeof(ValueType));
+
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreeLeafPage() = delete;
+  BPlusTreeLeafPage(const BPlusTreeLeafPage &other) = delete;
+
+  /** @param max_size max number of entries, one slot is kept free for splits */
+  void Init(int max_size = SLOT_CNT - 1);
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  auto KeyAt(int index) const -> KeyType { return keys_[index]; }
+  auto ValueAt(int index) const -> ValueType { return values_[index]; }
+  auto GetItem(int index) const -> std::pair<KeyType, ValueType> { return {keys_[index], values_[index]}; }
+
+  /** @return the index of the first key not smaller than `key`, GetSize() if there is none */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /** @return true and the value of `key` if the page holds it */
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+
+  /** @return false if the key is already in the page */
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
+
+  /** @return false if the key is not in the page */
+  auto Remove(const KeyType &key, const KeyComparator &comparator) -> bool;
+
+  /** Move the upper half of the entries to an empty right sibling, on a split. */
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+
+  /** Append every entry to the left sibling and hand it the next page id. */
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+
+  /** Move the first entry to the end of the left sibling. */
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+
+  /** Move the last entry to the front of the right sibling. */
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+
+  /** @return true if the entries of the right sibling fit into the page, for a merge */
+  auto CanMergeRight(const BPlusTreeLeafPage *right) const -> bool {
+    return GetSize() + right->GetSize() <= GetMaxSize();
+  }
+
+  /** @return true if the page can take the last entry of its left sibling */
+  auto CanBorrowLast(const BPlusTreeLeafPage * /*left*/) const -> bool { return true; }
+
+  /** @return true if the page can take the first entry of its right sibling */
+  auto CanBorrowFirst(const BPlusTreeLeafPage * /*right*/) const -> bool { return true; }
+
+  /** Record the key range the parent routes to the page, only prefix-compressed pages keep it. */
+  void SetKeyRange(const KeyType * /*low*/, const KeyType * /*high*/) {}
+
+  /** @return the max size of a new page asked to hold up to `max_size` entries */
+  static auto InitialMaxSize(int max_size) -> int { return max_size; }
+
+ private:
+  /** Shift the entries in [index, size) one slot to the right. */
+  void ShiftRight(int index);
+
+  /** Shift the entries in [index + 1, size) one slot to the left, over the entry at `index`. */
+  void ShiftLeft(int index);
+
+  page_id_t next_page_id_;
+  KeyType keys_[SLOT_CNT];
+  ValueType values_[SLOT_CNT];
+};
+
+/**
+ * Leaf page of a tree over NormalizedKeys, with the API of the other leaves but prefix-compressed keys (see
+ * BPlusTreePrefixPage). Moving entries between siblings also moves the fences between them.
+ */
+template <size_t KeySize, typename ValueType>
+class BPlusTreeLeafPage<NormalizedKey<KeySize>, ValueType, NormalizedComparator<KeySize>>
+    : public BPlusTreePrefixPage<KeySize, ValueType> {
+  using Base = BPlusTreePrefixPage<KeySize, ValueType>;
+  using KeyType = NormalizedKey<KeySize>;
+  using KeyComparator = NormalizedComparator<KeySize>;
+
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreeLeafPage() = delete;
+  BPlusTreeLeafPage(const BPlusTreeLeafPage &other) = delete;
+
+  /** @param max_size max number of entries, one slot is kept free for splits */
+  void Init(int max_size = Base::SLOT_CNT - 1);
+
+  auto GetNextPageId() const -> page_id_t { return this->next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { this->next_page_id_ = next_page_id; }
+
+  auto GetItem(int index) const -> std::pair<KeyType, ValueType> { return {this->KeyAt(index), this->ValueAt(index)}; }
+
+  auto KeyIndex(const KeyType &key, const KeyComparator & /*comparator*/) const -> int {
+    return this->Search(key, 0, false);
+  }
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
+  auto Remove(const KeyType &key, const KeyComparator &comparator) -> bool;
+
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+
+  /** A merge widens the range of the page up to the high fence of its right sibling. */
+  auto CanMergeRight(const BPlusTreeLeafPage *right) const -> bool {
+    return this->Fits(this->GetSize() + right->GetSize(), this->LowFence(), right->HighFence());
+  }
+
+  /** The last key of the left sibling becomes the low fence of the page. */
+  auto CanBorrowLast(const BPlusTreeLeafPage *left) const -> bool {
+    if (left->GetSize() < 2) {
+      return false;
+    }
+    KeyType low = left->KeyAt(left->GetSize() - 1);
+    return this->Fits(this->GetSize() + 1, &low, this->HighFence());
+  }
+
+  /** The second key of the right sibling becomes the high fence of the page. */
+  auto CanBorrowFirst(const BPlusTreeLeafPage *right) const -> bool {
+    if (right->GetSize() < 2) {
+      return false;
+    }
+    KeyType high = right->KeyAt(1);
+    return this->Fits(this->GetSize() + 1, this->LowFence(), &high);
+  }
+};
+
+}  // namespace redbase
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common/config.h"
+
+namespace redbase {
+
+#define INDEX_TEMPLATE_ARGUMENTS template <typename KeyType, typename ValueType, typename KeyComparator>
+
+enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
+
+/**
+ * Both internal and leaf pages inherit from this page. It holds the common header:
+ *
+ *  ----------------------------------------------------------
+ *  | PageType (4) | CurrentSize (4) | MaxSize (4) |  ...   |
+ *  ----------------------------------------------------------
+ *
+ * A node may hold one entry above MaxSize for the time it takes to split it, the page layouts reserve that slot.
+ */
+class BPlusTreePage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreePage() = delete;
+  BPlusTreePage(const BPlusTreePage &other) = delete;
+  ~BPlusTreePage() = delete;
+
+  auto IsLeafPage() const -> bool { return page_type_ == IndexPageType::LEAF_PAGE; }
+  void SetPageType(IndexPageType page_type) { page_type_ = page_type; }
+
+  auto GetSize() const -> int { return size_; }
+  void SetSize(int size) { size_ = size; }
+  void IncreaseSize(int amount) { size_ += amount; }
+
+  auto GetMaxSize() const -> int { return max_size_; }
+  void SetMaxSize(int max_size) { max_size_ = max_size; }
+
+  /** @return the smallest size a non-root node may shrink to before it borrows from or merges with a sibling */
+  auto GetMinSize() const -> int { return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2; }
+
+  /** @return true if inserting one entry cannot make the node split */
+  auto IsInsertSafe() const -> bool { return size_ < max_size_; }
+
+  /** @return true if removing one entry cannot make the node underflow */
+  auto IsRemoveSafe(bool is_root) const -> bool {
+    if (is_root) {
+      // a root leaf only goes away when it is empty, a root internal node when it has a single child
+      return IsLeafPage() ? size_ > 1 : size_ > 2;
+    }
+    return size_ > GetMinSize();
+  }
+
+ private:
+  IndexPageType page_type_;
+  int size_;
+  int max_size_;
+};
+
+static constexpr size_t INDEX_PAGE_HEADER_SIZE = 12;
+static_assert(sizeof(BPlusTreePage) == INDEX_PAGE_HEADER_SIZE);
+
+}  // namespace redbase
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "ix/b_plus_tree_page.h"
+#include "ix/normalized_key.h"
+
+namespace redbase {
+
+/**
+ * BPlusTreePrefixPage holds what the leaf and internal nodes of a tree over NormalizedKeys have in common: their keys
+ * are prefix compressed. Every node records its fences, the bounds of the key range its parent routes to it (missing
+ * at the ends of the key space). All the keys of that range share the longest common prefix of the two fences, so the
+ * node stores the prefix once (as the start of the low fence) and only the remaining bytes of each key:
+ *
+ *  -----------------------------------------------------------------------------------------------------------
+ *  | HEADER | NextPageId (4) | MaxSizeCap (4) | PrefixLen (2) | HasLow (1) | HasHigh (1) | LOW (n) | HIGH (n) |
+ *  -----------------------------------------------------------------------------------------------------------
+ *  | SUFFIX(1) | SUFFIX(2) | ... | SUFFIX(capacity) | VALUE(1) | VALUE(2) | ... | VALUE(capacity) |
+ *  -----------------------------------------------------------------------------------------------------------
+ *
+ * The shorter the suffixes, the more entries fit: the max size of a node follows its prefix, it is the number of
+ * entries that fit minus the slot kept for splits, capped by the max size the tree asked for (MaxSizeCap). Inserts
+ * stay inside the fences and never shorten the prefix, splits narrow the fences and may lengthen it. A merge or a
+ * borrow widens the range of the node that receives entries and may shorten its prefix, so the tree first checks that
+ * the entries still fit (CanMergeRight(), CanBorrowFirst(), CanBorrowLast() of the leaf and internal pages).
+ */
+template <size_t KeySize, typename ValueType>
+class BPlusTreePrefixPage : public BPlusTreePage {
+ public:
+  using KeyType = NormalizedKey<KeySize>;
+
+  static constexpr size_t HEADER_SIZE = INDEX_PAGE_HEADER_SIZE + 12 + 2 * KeySize;
+  static constexpr size_t DATA_SIZE = PAGE_SIZE - HEADER_SIZE;
+
+  /** Number of entries that fit into a page with the longest possible prefix. */
+  static constexpr int SLOT_CNT = DATA_SIZE / (1 + sizeof(ValueType));
+
+  /** @return the number of entries that fit into a page whose prefix is `prefix_len` bytes long */
+  static constexpr auto Capacity(size_t prefix_len) -> int {
+    return static_cast<int>(DATA_SIZE / (KeySize - prefix_len + sizeof(ValueType)));
+  }
+
+  /** @return the max size of a new page (without prefix) asked to hold up to `max_size` entries */
+  static auto InitialMaxSize(int max_size) -> int { return std::min(max_size, Capacity(0) - 1); }
+
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreePrefixPage() = delete;
+  BPlusTreePrefixPage(const BPlusTreePrefixPage &other) = delete;
+
+  auto GetPrefixLength() const -> size_t { return Prefix(); }
+
+  auto KeyAt(int index) const -> KeyType;
+  void SetKeyAt(int index, const KeyType &key);
+
+  auto ValueAt(int index) const -> ValueType;
+  void SetValueAt(int index, const ValueType &value);
+
+  /**
+   * @brief Set both fences and lay the entries out again under the prefix they imply.
+   * @param low the smallest key routed to the page, nullptr if unbounded
+   * @param high the smallest key above the range of the page, nullptr if unbounded
+   */
+  void SetKeyRange(const KeyType *low, const KeyType *high);
+
+ protected:
+  /** Reset the header of an empty page with unbounded fences. */
+  void InitPrefixPage(IndexPageType page_type, int max_size);
+
+  /** @return the low fence, nullptr if unbounded */
+  auto LowFence() const -> const KeyType * { return has_low_ != 0 ? reinterpret_cast<const KeyType *>(low_) : nullptr; }
+
+  /** @return the high fence, nullptr if unbounded */
+  auto HighFence() const -> const KeyType * {
+    return has_high_ != 0 ? reinterpret_cast<const KeyType *>(high_) : nullptr;
+  }
+
+  /**
+   * @brief Binary search over the suffixes, after a single comparison of the prefix.
+   * @return the index of the first entry in [begin, size) whose key is not smaller than `key` (greater than `key`
+   * if `upper`), the size if there is none
+   */
+  auto Search(const KeyType &key, int begin, bool upper) const -> int;
+
+  /** @return true if `count` entries fit into the page once its fences are `low` and `high` */
+  auto Fits(int count, const KeyType *low, const KeyType *high) const -> bool;
+
+  /** Shift the entries in [index, size) one slot to the right. */
+  void ShiftRight(int index);
+
+  /** Shift the entries in [index + 1, size) one slot to the left, over the entry at `index`. */
+  void ShiftLeft(int index);
+
+  /** Add an entry after the last one, the key must be inside the fences. */
+  void Append(const KeyType &key, const ValueType &value);
+
+  /** Next leaf, only used by leaves. */
+  page_id_t next_page_id_;
+
+ private:
+  /** @return the length of the longest common prefix of two fences, 0 if one is unbounded */
+  static auto CommonPrefix(const KeyType *low, const KeyType *high) -> size_t;
+
+  /** @return the prefix length, kept inside the page for optimistic readers that may see a torn header */
+  auto Prefix() const -> size_t { return std::min<size_t>(prefix_len_, KeySize - 1); }
+
+  auto SuffixAt(int index) const -> const uint8_t * { return data_ + index * (KeySize - Prefix()); }
+
+  auto ValueOffset(int index) const -> size_t {
+    size_t prefix_len = Prefix();
+    return Capacity(prefix_len) * (KeySize - prefix_len) + index * sizeof(ValueType);
+  }
+
+  int32_t max_size_cap_;
+  uint16_t prefix_len_;
+  uint8_t has_low_;
+  uint8_t has_high_;
+  uint8_t low_[KeySize];
+  uint8_t high_[KeySize];
+  uint8_t data_[DATA_SIZE];
+};
+
+}  // namespace redbase
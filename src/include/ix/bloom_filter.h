@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/util/hash_util.h"
+
+namespace redbase {
+
+/** Sizing of a Bloom filter. */
+struct BloomFilterOptions {
+  /** Number of keys the filter is sized for, more keys raise the false positive rate. */
+  size_t expected_keys_{0};
+  /** Target rate of absent keys the filter lets through. */
+  double false_positive_rate_{0.01};
+  /** Upper bound of the filter size in bytes, 0 for none. The rate is missed if the budget is too small. */
+  size_t max_bytes_{0};
+};
+
+/** Probe counters of a Bloom filter. */
+struct BloomFilterStats {
+  /** Probes answered "absent", each one a lookup that never touched the index. */
+  uint64_t skipped_{0};
+  /** Probes answered "maybe present". */
+  uint64_t passed_{0};
+  /** Passed probes whose key turned out to be absent, as reported by the index. */
+  uint64_t false_positives_{0};
+};
+
+/**
+ * BloomFilter is a blocked Bloom filter over 64-bit key hashes, the negative lookup shortcut of an index: a key the
+ * filter has never seen is answered "absent" without a single page fetch.
+ *
+ * The filter is an array of cache-line sized blocks of eight 64-bit words. The high half of a hash selects a block,
+ * the low half is multiplied by eight odd constants whose top bits set one bit in each word (a split block filter).
+ * A probe therefore touches one cache line, and checks all eight bits at once with AVX2 where the CPU has it.
+ *
+ * Bits are only ever set, so removed keys stay in the filter and it always answers "maybe" for live keys. Inserts
+ * set bits atomically and may run concurrently with each other and with probes. The filter is sized once, from
+ * BloomFilterOptions, and persisted by Flush() to a chain of pages it can be loaded back from.
+ */
+class BloomFilter {
+ public:
+  static constexpr size_t BLOCK_SIZE = 64;
+  static constexpr size_t WORDS_PER_BLOCK = BLOCK_SIZE / sizeof(uint64_t);
+
+  /** @brief Create an empty filter. */
+  BloomFilter(BufferPoolManager *bpm, const BloomFilterOptions &options);
+
+  /** @brief Load a filter from the pages written by Flush(). */
+  BloomFilter(BufferPoolManager *bpm, page_id_t first_page_id);
+
+  /** Add the hash of a key. */
+  void Insert(hash_t hash);
+
+  /** @return false if the key of the hash was never inserted, counted in the stats */
+  auto MayContain(hash_t hash) const -> bool;
+
+  /** Count a probe that passed the filter but whose key was absent. */
+  void RecordFalsePositive() const { false_positives_.fetch_add(1, std::memory_order_relaxed); }
+
+  auto GetStats() const -> BloomFilterStats;
+
+  void ResetStats();
+
+  /** @return the false positive rate expected from the number of inserted keys */
+  auto EstimatedFalsePositiveRate() const -> double { return EstimateFalsePositiveRate(num_blocks_, num_keys_); }
+
+  /** @return the false positive rate of `num_blocks` blocks holding `num_keys` keys */
+  static auto EstimateFalsePositiveRate(size_t num_blocks, size_t num_keys) -> double;
+
+  auto GetNumBlocks() const -> size_t { return num_blocks_; }
+
+  auto GetSizeBytes() const -> size_t { return num_blocks_ * BLOCK_SIZE; }
+
+  /** @return the number of inserts so far, counting a key inserted twice twice */
+  auto GetNumKeys() const -> size_t { return num_keys_.load(std::memory_order_relaxed); }
+
+  /** Write the filter to its pages, allocating the chain on first use. */
+  void Flush();
+
+  /** @return the first page of the filter, INVALID_PAGE_ID before the first Flush() */
+  auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
+
+  /** Hand the pages written by Flush() back to the buffer pool, the filter itself stays usable. */
+  void DeletePages();
+
+ private:
+  struct alignas(BLOCK_SIZE) Block {
+    uint64_t words_[WORDS_PER_BLOCK];
+  };
+
+  /** @return the block of a hash, picked by its high half */
+  auto BlockIndex(hash_t hash) const -> size_t { return ((hash >> 32) * num_blocks_) >> 32; }
+
+  BufferPoolManager *bpm_;
+  page_id_t first_page_id_{INVALID_PAGE_ID};
+  size_t num_blocks_;
+  std::vector<Block> blocks_;
+  std::atomic<size_t> num_keys_{0};
+
+  mutable std::atomic<uint64_t> skipped_{0};
+  mutable std::atomic<uint64_t> passed_{0};
+  mutable std::atomic<uint64_t> false_positives_{0};
+};
+
+}  // namespace redbase
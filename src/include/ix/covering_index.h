@@ -0,0 +1,130 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "common/macros.h"
+#include "fmt/format.h"
+#include "ix/b_plus_tree.h"
+#include "ix/covering_value.h"
+#include "ix/index_builder.h"
+#include "rm/schema.h"
+#include "rm/tuple_view.h"
+
+namespace redbase {
+
+#define COVERING_TEMPLATE_ARGUMENTS template <typename KeyType, size_t PAYLOAD_SIZE, typename KeyComparator>
+#define COVERING_TREE_TYPE BPlusTree<KeyType, CoveringValue<PAYLOAD_SIZE>, KeyComparator>
+
+/**
+ * IndexInclude describes the INCLUDE columns of a covering index: the columns of the table copied into the leaf
+ * entries next to the RID. The payload of an entry is a tuple of its own, laid out by GetSchema() (a NULL bitmap, then
+ * the INCLUDE columns in the order they were listed), so that it is read like any table tuple.
+ */
+class IndexInclude {
+ public:
+  /**
+   * @param table_schema the schema of the indexed table
+   * @param column_idxs the INCLUDE columns, indices into the table schema
+   */
+  IndexInclude(const Schema *table_schema, std::vector<uint32_t> column_idxs);
+
+  /** @return the layout of a payload */
+  auto GetSchema() const -> const Schema & { return schema_; }
+
+  /** @return the number of bytes of a payload, which must fit into the CoveringValue of the index */
+  auto GetPayloadSize() const -> uint32_t { return schema_.GetTupleSize(); }
+
+  /** @return the column of the payload that carries a column of the table */
+  auto GetPayloadColumn(uint32_t table_col_idx) const -> std::optional<uint32_t>;
+
+  /**
+   * @return true if every listed table column is carried by the payload, i.e. a query that reads only these columns
+   * (besides the key) can be answered by an index-only scan
+   */
+  auto Covers(const std::vector<uint32_t> &table_col_idxs) const -> bool;
+
+  /** Copy the INCLUDE columns of a table tuple, NULL bits included, into a payload of GetPayloadSize() bytes. */
+  void Pack(const char *tuple, char *payload) const;
+
+  /** @return the leaf value of a table tuple: its RID and its INCLUDE columns */
+  template <size_t PAYLOAD_SIZE>
+  auto MakeValue(const TupleView &tuple) const -> CoveringValue<PAYLOAD_SIZE> {
+    CoveringValue<PAYLOAD_SIZE> value{tuple.rid_, {}};
+    Pack(tuple.data_, value.payload_);
+    return value;
+  }
+
+ private:
+  const Schema *table_schema_;
+  std::vector<uint32_t> column_idxs_;
+  Schema schema_;
+};
+
+/**
+ * IndexOnlyScan is the index-only access path: it walks a key range of a covering index and hands out the INCLUDE
+ * payloads of the matching entries, answering a query that only needs indexed columns from the leaf pages alone,
+ * without a single heap page fetch. Its batches mirror TableScanIterator::NextBatch(): every TupleView carries the
+ * RID of the tuple and points to its payload, to be read through IndexInclude::GetSchema().
+ */
+COVERING_TEMPLATE_ARGUMENTS
+class IndexOnlyScan {
+ public:
+  using Tree = COVERING_TREE_TYPE;
+
+  /**
+   * @brief Scan the keys in [*lower, *upper].
+   * @param lower first key of the range, null to start at the smallest key
+   * @param upper last key of the range, null to run to the largest key
+   * @param batch_size max number of entries handed out per NextBatch() call
+   */
+  IndexOnlyScan(const Tree *tree, const IndexInclude *include, const KeyType *lower, const KeyType *upper,
+                size_t batch_size = SCAN_BATCH_SIZE);
+
+  DISALLOW_COPY(IndexOnlyScan);
+  IndexOnlyScan(IndexOnlyScan &&that) noexcept = default;
+  auto operator=(IndexOnlyScan &&that) noexcept -> IndexOnlyScan & = default;
+  ~IndexOnlyScan() = default;
+
+  /**
+   * @brief Fill `batch` with the payloads of up to batch_size entries.
+   *
+   * The views point into a buffer of the scan, they stay valid until the next call to NextBatch().
+   *
+   * @param[out] batch the entries of this batch, cleared first
+   * @return false once the range is exhausted, in which case the batch is empty
+   */
+  auto NextBatch(std::vector<TupleView> *batch) -> bool;
+
+ private:
+  KeyComparator comparator_;
+  uint32_t payload_size_;
+  size_t batch_size_;
+  IndexIterator<KeyType, CoveringValue<PAYLOAD_SIZE>, KeyComparator> iter_;
+  std::optional<KeyType> upper_;
+  /** Copies of the entries handed out by the last batch. */
+  std::vector<CoveringValue<PAYLOAD_SIZE>> values_;
+};
+
+/**
+ * @brief Build a covering index over the live tuples of a table heap, like BulkBuildIndex(), with the INCLUDE columns
+ * of every tuple stored next to its RID.
+ * @param tree an empty covering tree, whose payload must be large enough for the INCLUDE columns
+ * @param make_key builds the index key of a tuple: `auto make_key(const TupleView &tuple) -> KeyType`
+ * @return the number of entries loaded
+ */
+template <typename KeyType, size_t PAYLOAD_SIZE, typename KeyComparator, typename MakeKey>
+auto BulkBuildCoveringIndex(BufferPoolManager *bpm, TableHeap *heap, COVERING_TREE_TYPE *tree, MakeKey make_key,
+                            const IndexInclude &include, const IndexBuildOptions &options = {}) -> size_t {
+  if (include.GetPayloadSize() > PAYLOAD_SIZE) {
+    throw Exception(fmt::format("INCLUDE columns take {} bytes, the index payload holds {}", include.GetPayloadSize(),
+                                PAYLOAD_SIZE));
+  }
+  return BulkBuildIndex(
+      bpm, heap, tree, make_key,
+      [&include](const TupleView &tuple) { return include.MakeValue<PAYLOAD_SIZE>(tuple); }, options);
+}
+
+}  // namespace redbase
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+#include "common/rid.h"
+
+namespace redbase {
+
+/**
+ * The value stored in the leaves of a covering index: the RID of the tuple, followed by a copy of its INCLUDE columns
+ * laid out as IndexInclude::GetSchema() describes. The payload widens every leaf entry, so a covering index trades
+ * fanout (and leaf count) for index-only scans that never touch the table heap.
+ */
+template <size_t PAYLOAD_SIZE>
+struct CoveringValue {
+  RID rid_;
+  char payload_[PAYLOAD_SIZE];
+};
+
+}  // namespace redbase
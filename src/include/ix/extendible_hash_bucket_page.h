@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "ix/b_plus_tree_page.h"
+
+namespace redbase {
+
+#define EXTENDIBLE_HASH_BUCKET_PAGE_TYPE ExtendibleHashBucketPage<KeyType, ValueType, KeyComparator>
+static constexpr size_t HASH_BUCKET_PAGE_HEADER_SIZE = 8;
+
+/**
+ * Bucket page of an extendible hash index, an unordered set of (key, value) pairs. The 32-bit hash of every key is
+ * kept next to it, so that a lookup compares hashes (a tight loop over one array) before it compares keys, and a
+ * split moves entries without hashing them again:
+ *
+ *  -------------------------------------------------------------------------------------------------------
+ *  | Size (4) | MaxSize (4) | HASH(1) | ... | HASH(n) | KEY(1) | ... | KEY(n) | VALUE(1) | ... | VALUE(n) |
+ *  -------------------------------------------------------------------------------------------------------
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashBucketPage {
+ public:
+  /** Number of entries that fit into a page, with room for the padding that aligns the key and value arrays. */
+  static constexpr int SLOT_CNT = (PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE - alignof(KeyType) - alignof(ValueType)) /
+                                  (sizeof(uint32_t) + sizeof(KeyType) + sizeof(ValueType));
+
+  // Delete all constructor / destructor to ensure memory safety
+  ExtendibleHashBucketPage() = delete;
+  ExtendibleHashBucketPage(const ExtendibleHashBucketPage &other) = delete;
+
+  /** @param max_size max number of entries */
+  void Init(uint32_t max_size = SLOT_CNT);
+
+  /** @return true and the value of `key` if the bucket holds it */
+  auto Lookup(uint32_t hash, const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+
+  /** @return false if the key is already in the bucket, the bucket must not be full */
+  auto Insert(uint32_t hash, const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> bool;
+
+  /** @return false if the key is not in the bucket */
+  auto Remove(uint32_t hash, const KeyType &key, const KeyComparator &comparator) -> bool;
+
+  /** Move the entries whose hash has `bit` set to an empty split image. */
+  void SplitTo(ExtendibleHashBucketPage *image, uint32_t bit);
+
+  auto HashAt(uint32_t index) const -> uint32_t { return hashes_[index]; }
+  auto KeyAt(uint32_t index) const -> KeyType { return keys_[index]; }
+  auto ValueAt(uint32_t index) const -> ValueType { return values_[index]; }
+
+  auto Size() const -> uint32_t { return size_; }
+  auto IsFull() const -> bool { return size_ >= max_size_; }
+  auto IsEmpty() const -> bool { return size_ == 0; }
+
+ private:
+  /** @return the index of the key, -1 if the bucket does not hold it */
+  auto Find(uint32_t hash, const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /** Add an entry after the last one. */
+  void Append(uint32_t hash, const KeyType &key, const ValueType &value);
+
+  /** Remove the entry at `index`, the last entry takes its place. */
+  void RemoveAt(uint32_t index);
+
+  uint32_t size_;
+  uint32_t max_size_;
+  uint32_t hashes_[SLOT_CNT];
+  KeyType keys_[SLOT_CNT];
+  ValueType values_[SLOT_CNT];
+};
+
+}  // namespace redbase
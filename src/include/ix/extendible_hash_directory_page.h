@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace redbase {
+
+static constexpr uint32_t HASH_DIRECTORY_MAX_DEPTH = 9;
+static constexpr uint32_t HASH_DIRECTORY_ARRAY_SIZE = 1 << HASH_DIRECTORY_MAX_DEPTH;
+
+/**
+ * The directory page of an extendible hash index maps the low global_depth bits of a hash to a bucket page. A bucket
+ * of local depth d < global_depth is shared by the 2^(global_depth - d) slots that agree on their low d bits:
+ *
+ *  -------------------------------------------------------------------------------------------------
+ *  | MaxDepth (4) | GlobalDepth (4) | LocalDepth(0) (1) | ... | BucketPageId(0) (4) | ... |
+ *  -------------------------------------------------------------------------------------------------
+ *
+ * Splitting a bucket of local depth d adds a bit to it: the slots whose bit d is set move to its split image, the
+ * directory doubling first if d already is the global depth. Merging a bucket with its split image does the reverse.
+ */
+class ExtendibleHashDirectoryPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  ExtendibleHashDirectoryPage() = delete;
+  ExtendibleHashDirectoryPage(const ExtendibleHashDirectoryPage &other) = delete;
+
+  /** @param max_depth max global depth, at most HASH_DIRECTORY_MAX_DEPTH */
+  void Init(uint32_t max_depth = HASH_DIRECTORY_MAX_DEPTH);
+
+  /** @return the slot a hash belongs to */
+  auto HashToBucketIndex(uint32_t hash) const -> uint32_t { return hash & GetGlobalDepthMask(); }
+
+  auto GetBucketPageId(uint32_t bucket_idx) const -> page_id_t { return bucket_page_ids_[bucket_idx]; }
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) { bucket_page_ids_[bucket_idx] = bucket_page_id; }
+
+  auto GetLocalDepth(uint32_t bucket_idx) const -> uint32_t { return local_depths_[bucket_idx]; }
+
+  void SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) { local_depths_[bucket_idx] = local_depth; }
+
+  /** @return the slot that differs from `bucket_idx` in the highest bit of its local depth */
+  auto GetSplitImageIndex(uint32_t bucket_idx) const -> uint32_t;
+
+  auto GetGlobalDepth() const -> uint32_t { return global_depth_; }
+  auto GetMaxDepth() const -> uint32_t { return max_depth_; }
+  auto GetGlobalDepthMask() const -> uint32_t { return (1U << global_depth_) - 1; }
+
+  /** Double the directory, the new upper half mirrors the lower one. */
+  void IncrGlobalDepth();
+
+  /** Halve the directory, only valid if CanShrink(). */
+  void DecrGlobalDepth() { global_depth_--; }
+
+  /** @return true if every bucket has a local depth below the global depth */
+  auto CanShrink() const -> bool;
+
+  /** @return the number of slots */
+  auto Size() const -> uint32_t { return 1 << global_depth_; }
+
+  /** @return the number of slots at the max depth */
+  auto MaxSize() const -> uint32_t { return 1 << max_depth_; }
+
+ private:
+  uint32_t max_depth_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[HASH_DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[HASH_DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(ExtendibleHashDirectoryPage) <= PAGE_SIZE);
+
+}  // namespace redbase
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace redbase {
+
+static constexpr uint32_t HASH_HEADER_MAX_DEPTH = 9;
+static constexpr uint32_t HASH_HEADER_ARRAY_SIZE = 1 << HASH_HEADER_MAX_DEPTH;
+
+/**
+ * The header page of an extendible hash index never moves. It spreads the hash space over up to 2^max_depth
+ * directories by the top max_depth bits of a key's hash, directories being created on first use:
+ *
+ *  ------------------------------------------------------------------------
+ *  | MaxDepth (4) | DirectoryPageId(0) | DirectoryPageId(1) | ... |
+ *  ------------------------------------------------------------------------
+ */
+class ExtendibleHashHeaderPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  ExtendibleHashHeaderPage() = delete;
+  ExtendibleHashHeaderPage(const ExtendibleHashHeaderPage &other) = delete;
+
+  /** @param max_depth number of hash bits that select a directory, at most HASH_HEADER_MAX_DEPTH */
+  void Init(uint32_t max_depth = HASH_HEADER_MAX_DEPTH);
+
+  /** @return the index of the directory a hash belongs to */
+  auto HashToDirectoryIndex(uint32_t hash) const -> uint32_t {
+    return max_depth_ == 0 ? 0 : hash >> (32 - max_depth_);
+  }
+
+  auto GetDirectoryPageId(uint32_t directory_idx) const -> page_id_t { return directory_page_ids_[directory_idx]; }
+  void SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id) {
+    directory_page_ids_[directory_idx] = directory_page_id;
+  }
+
+  auto GetMaxDepth() const -> uint32_t { return max_depth_; }
+
+  /** @return the number of directories the header can point at */
+  auto MaxSize() const -> uint32_t { return 1 << max_depth_; }
+
+ private:
+  uint32_t max_depth_;
+  page_id_t directory_page_ids_[HASH_HEADER_ARRAY_SIZE];
+};
+
+static_assert(sizeof(ExtendibleHashHeaderPage) <= PAGE_SIZE);
+
+}  // namespace redbase
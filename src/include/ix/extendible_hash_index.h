@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/util/hash_util.h"
+#include "ix/bloom_filter.h"
+#include "ix/extendible_hash_bucket_page.h"
+#include "ix/extendible_hash_directory_page.h"
+#include "ix/extendible_hash_header_page.h"
+#include "ix/generic_key.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+/**
+ * Hashes a key through its bytes. Keys the comparator finds equal must have equal bytes, which holds for integers and
+ * for GenericKeys built with SetFromKey() or SetFromTuple() (unused bytes and NULL columns are zeroed).
+ */
+template <typename KeyType>
+class HashFunction {
+ public:
+  auto GetHash(const KeyType &key) const -> uint32_t {
+    return static_cast<uint32_t>(HashUtil::HashBytes(&key, sizeof(KeyType)));
+  }
+};
+
+#define EXTENDIBLE_HASH_INDEX_TYPE ExtendibleHashIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExtendibleHashIndex is the equality-only index of the IX layer: a disk-resident extendible hash table whose pages
+ * are buffer pool pages. A header page selects a directory by the top bits of a key's 32-bit hash, the directory
+ * selects a bucket by the low global_depth bits, so every lookup fetches three pages whatever the number of keys,
+ * where a B+ tree descends its whole height. Keys are unique.
+ *
+ * A full bucket splits on its own (its local depth grows by one and half of its slots move to a new page), the
+ * directory only doubles when the bucket already uses every bit of the global depth. A bucket emptied by a removal
+ * merges back with its split image, and the directory halves once no bucket needs its top bit.
+ *
+ * Concurrency is page-level latching, always header, then directory, then bucket. The header only changes when a
+ * directory is created, and directories are never deleted, so the header is released as soon as it has been read.
+ * Lookups then read latch the directory and the bucket, releasing the directory once the bucket is latched. Inserts
+ * and removes do the same but write latch the bucket; a split (or a merge) restarts with the directory write latched,
+ * which keeps every other operation on that directory away while its buckets change.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashIndex {
+  using BucketPage = EXTENDIBLE_HASH_BUCKET_PAGE_TYPE;
+
+ public:
+  /**
+   * @brief Create a new, empty index.
+   * @param header_max_depth number of hash bits that select a directory
+   * @param directory_max_depth max global depth of a directory
+   * @param bucket_max_size max number of entries of a bucket
+   */
+  ExtendibleHashIndex(std::string name, BufferPoolManager *bpm, const KeyComparator &comparator,
+                      uint32_t header_max_depth = HASH_HEADER_MAX_DEPTH,
+                      uint32_t directory_max_depth = HASH_DIRECTORY_MAX_DEPTH,
+                      uint32_t bucket_max_size = BucketPage::SLOT_CNT);
+
+  /**
+   * @brief Open an existing index.
+   * @param header_page_id the header page of the index, see GetHeaderPageId()
+   */
+  ExtendibleHashIndex(std::string name, page_id_t header_page_id, BufferPoolManager *bpm,
+                      const KeyComparator &comparator, uint32_t directory_max_depth = HASH_DIRECTORY_MAX_DEPTH,
+                      uint32_t bucket_max_size = BucketPage::SLOT_CNT);
+
+  /**
+   * @brief Insert a key/value pair.
+   * @return false if the key is already in the index
+   */
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * @brief Remove a key and its value.
+   * @return false if the key is not in the index
+   */
+  auto Remove(const KeyType &key) -> bool;
+
+  /**
+   * @brief Point lookup.
+   * @param[out] result the value of the key is appended to it
+   * @return true if the key is in the index
+   */
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) const -> bool;
+
+  auto GetHeaderPageId() const -> page_id_t { return header_page_id_; }
+
+  /** @return the global depth of the directory a key belongs to, 0 if it does not exist yet */
+  auto GetGlobalDepth(const KeyType &key) const -> uint32_t;
+
+  /**
+   * @brief Consult a Bloom filter before every point lookup, and add every key inserted from now on to it. Keys already
+   * in the index are not added: attach the filter to an empty index, or to one it was flushed with.
+   */
+  void SetBloomFilter(BloomFilter *bloom_filter) { bloom_filter_ = bloom_filter; }
+
+  auto GetBloomFilter() const -> BloomFilter * { return bloom_filter_; }
+
+ private:
+  auto Hash(const KeyType &key) const -> uint32_t { return hash_fn_.GetHash(key); }
+
+  /** @return the directory of a hash, INVALID_PAGE_ID if none was created yet */
+  auto GetDirectoryPageId(uint32_t hash) const -> page_id_t;
+
+  /** Allocate and write latch a page. */
+  auto NewPage(page_id_t *page_id) -> WritePageGuard;
+
+  /** @return a new directory with a single, empty bucket */
+  auto NewDirectory() -> page_id_t;
+
+  /** Insert with the directory write latched, splitting the bucket of the key until it has room. */
+  auto InsertPessimistic(const KeyType &key, const ValueType &value, uint32_t hash) -> bool;
+
+  /** Merge the empty bucket of a hash with its split image as long as possible, then shrink the directory. */
+  void MergeBuckets(page_id_t directory_page_id, uint32_t hash);
+
+  /** Delete a page whose guard has been dropped, waiting a little for readers to unpin it. */
+  void FreePage(page_id_t page_id);
+
+  std::string index_name_;
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  HashFunction<KeyType> hash_fn_;
+  uint32_t directory_max_depth_;
+  uint32_t bucket_max_size_;
+  page_id_t header_page_id_;
+  /** Shortcut for absent keys, may be null. */
+  BloomFilter *bloom_filter_{nullptr};
+};
+
+}  // namespace redbase
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "common/util/hash_util.h"
+#include "rm/schema.h"
+
+namespace redbase {
+
+/**
+ * GenericKey is the fixed-size key of an index: the key columns of a tuple laid out as a tuple of the key schema
+ * (NULL bitmap first, then the columns), zero padded up to KeySize bytes.
+ */
+template <size_t KeySize>
+class GenericKey {
+ public:
+  /** Copy a key tuple, which must not be larger than KeySize. */
+  void SetFromKey(const char *key_tuple, uint32_t size) {
+    memset(data_, 0, KeySize);
+    memcpy(data_, key_tuple, std::min<size_t>(size, KeySize));
+  }
+
+  /**
+   * @brief Build the key of a table tuple.
+   * @param key_attrs the columns of the table schema the key is made of, in key order
+   */
+  void SetFromTuple(const char *tuple, const Schema &schema, const std::vector<uint32_t> &key_attrs,
+                    const Schema &key_schema) {
+    memset(data_, 0, KeySize);
+    for (uint32_t i = 0; i < key_attrs.size(); i++) {
+      uint32_t col_idx = key_attrs[i];
+      if (schema.IsNull(tuple, col_idx)) {
+        key_schema.SetNull(data_, i, true);
+      } else if (schema.GetColumn(col_idx).GetType() == TypeId::CHAR) {
+        key_schema.SetChar(data_, i, schema.GetChar(tuple, col_idx));
+      } else {
+        key_schema.SetValue(data_, i, schema.GetValue(tuple, col_idx));
+      }
+    }
+  }
+
+  /** @return the key tuple */
+  auto GetData() const -> const char * { return data_; }
+
+  auto ToString(const Schema &key_schema) const -> std::string {
+    std::string str = "(";
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      if (i > 0) {
+        str += ", ";
+      }
+      if (key_schema.GetColumn(i).GetType() == TypeId::CHAR && !key_schema.IsNull(data_, i)) {
+        str += key_schema.GetChar(data_, i);
+      } else {
+        str += key_schema.GetValue(data_, i).ToString();
+      }
+    }
+    return str + ")";
+  }
+
+  char data_[KeySize];
+};
+
+/** Orders GenericKeys column by column, NULLs first. */
+template <size_t KeySize>
+class GenericComparator {
+ public:
+  explicit GenericComparator(const Schema *key_schema) : key_schema_(key_schema) {}
+
+  GenericComparator(const GenericComparator &other) = default;
+
+  /** @return -1, 0 or 1 if lhs is smaller than, equal to or greater than rhs */
+  auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++) {
+      bool lhs_null = key_schema_->IsNull(lhs.data_, i);
+      bool rhs_null = key_schema_->IsNull(rhs.data_, i);
+      if (lhs_null || rhs_null) {
+        if (lhs_null != rhs_null) {
+          return lhs_null ? -1 : 1;
+        }
+        continue;
+      }
+
+      int cmp;
+      if (key_schema_->GetColumn(i).GetType() == TypeId::CHAR) {
+        cmp = key_schema_->GetChar(lhs.data_, i).compare(key_schema_->GetChar(rhs.data_, i));
+      } else {
+        cmp = key_schema_->GetValue(lhs.data_, i).CompareTo(key_schema_->GetValue(rhs.data_, i));
+      }
+      if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * @return a hash of a key that agrees with operator(): keys that compare equal hash alike even when their bytes
+   * differ, such as DOUBLE -0.0 and 0.0, or CHARs with different bytes past their terminator
+   */
+  auto Hash(const GenericKey<KeySize> &key) const -> hash_t {
+    hash_t hash = key_schema_->GetColumnCount();
+    for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++) {
+      hash_t column_hash;
+      if (key_schema_->IsNull(key.data_, i)) {
+        column_hash = 0;
+      } else if (key_schema_->GetColumn(i).GetType() == TypeId::CHAR) {
+        std::string_view str = key_schema_->GetChar(key.data_, i);
+        column_hash = HashUtil::HashBytes(str.data(), str.size());
+      } else if (key_schema_->GetColumn(i).GetType() == TypeId::DOUBLE) {
+        double decimal = key_schema_->GetValue(key.data_, i).GetAsDouble();
+        decimal = decimal == 0 ? 0.0 : decimal;
+        column_hash = HashUtil::HashBytes(&decimal, sizeof(decimal));
+      } else {
+        int64_t integer = key_schema_->GetValue(key.data_, i).GetAsInteger();
+        column_hash = HashUtil::HashBytes(&integer, sizeof(integer));
+      }
+      hash = HashUtil::CombineHashes(hash, column_hash);
+    }
+    return hash;
+  }
+
+ private:
+  const Schema *key_schema_;
+};
+
+template <typename KeyType, typename KeyComparator, typename = void>
+struct HasKeyHash : std::false_type {};
+
+template <typename KeyType, typename KeyComparator>
+struct HasKeyHash<KeyType, KeyComparator,
+                  std::void_t<decltype(std::declval<const KeyComparator &>().Hash(std::declval<const KeyType &>()))>>
+    : std::true_type {};
+
+/**
+ * @return a hash of an index key that agrees with the comparator of the index, for the Bloom filters of the indexes:
+ * the comparator's Hash() if it has one, the bytes of the key for the comparators that compare the bytes
+ */
+template <typename KeyType, typename KeyComparator>
+auto HashIndexKey(const KeyType &key, const KeyComparator &comparator) -> hash_t {
+  if constexpr (HasKeyHash<KeyType, KeyComparator>::value) {
+    return comparator.Hash(key);
+  } else {
+    return HashUtil::HashBytes(&key, sizeof(KeyType));
+  }
+}
+
+/**
+ * Orders plain integer keys. A tree over int32_t or int64_t keys with this comparator is specialized at compile time:
+ * its nodes search keys with SIMD kernels instead of calling the comparator (see node_search.h).
+ */
+template <typename T>
+class IntegerComparator {
+ public:
+  auto operator()(T lhs, T rhs) const -> int { return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0); }
+};
+
+/**
+ * NonUniqueKey turns a key that may repeat into a unique one by appending the RID of the tuple, so that a
+ * non-unique index is a unique B+ tree over (key, RID) pairs. All the entries of a key are adjacent in the tree,
+ * starting at MakeLowest(key).
+ */
+template <typename KeyType>
+struct NonUniqueKey {
+  /** @return the smallest composite key with the given key part */
+  static auto MakeLowest(const KeyType &key) -> NonUniqueKey { return {key, RID(INVALID_PAGE_ID, 0)}; }
+
+  KeyType key_;
+  RID rid_;
+};
+
+/** Orders NonUniqueKeys by key, then by RID. */
+template <typename KeyType, typename KeyComparator>
+class NonUniqueComparator {
+ public:
+  explicit NonUniqueComparator(const KeyComparator &comparator) : comparator_(comparator) {}
+
+  auto operator()(const NonUniqueKey<KeyType> &lhs, const NonUniqueKey<KeyType> &rhs) const -> int {
+    int cmp = comparator_(lhs.key_, rhs.key_);
+    if (cmp != 0) {
+      return cmp;
+    }
+    if (lhs.rid_ == rhs.rid_) {
+      return 0;
+    }
+    return lhs.rid_ < rhs.rid_ ? -1 : 1;
+  }
+
+  /** @return a hash that agrees with operator(), see HashIndexKey() */
+  auto Hash(const NonUniqueKey<KeyType> &key) const -> hash_t {
+    return HashUtil::CombineHashes(HashIndexKey(key.key_, comparator_), HashUtil::HashBytes(&key.rid_, sizeof(RID)));
+  }
+
+  /** @return the comparator of the key part */
+  auto GetKeyComparator() const -> const KeyComparator & { return comparator_; }
+
+ private:
+  KeyComparator comparator_;
+};
+
+}  // namespace redbase
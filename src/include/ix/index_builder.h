@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/external_sorter.h"
+#include "common/rid.h"
+#include "ix/b_plus_tree.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+/** Knobs of a bulk index build. */
+struct IndexBuildOptions {
+  /** Fraction of every node filled by the build, the rest is left for later inserts. */
+  double fill_factor_{0.9};
+  /** Memory budget and threads of the sort of the (key, RID) pairs. */
+  ExternalSortOptions sort_options_;
+};
+
+/** A (key, value) pair of an index being built, as sorted by the external sort. */
+template <typename KeyType, typename ValueType = RID>
+struct IndexEntry {
+  KeyType key_;
+  ValueType value_;
+};
+
+/**
+ * @brief Build an index over the live tuples of a table heap, the bulk path of CREATE INDEX.
+ *
+ * The (key, value) pair of every tuple is extracted by a scan of the heap, the pairs are sorted by an ExternalSorter
+ * (in parallel, spilling runs to temp pages when they do not fit in the sort budget), then the sorted stream is
+ * loaded bottom-up into the tree with BPlusTree::BulkLoad(). Compared to inserting the keys one by one this writes
+ * every index page once, in order, with leaves packed to the fill factor instead of about half full.
+ *
+ * @param tree an empty tree, the build throws if a key repeats (use NonUniqueKey for a non-unique index)
+ * @param make_key builds the index key of a tuple: `auto make_key(const TupleView &tuple) -> KeyType`
+ * @param make_value builds the value stored with the key: `auto make_value(const TupleView &tuple) -> ValueType`
+ * @return the number of entries loaded
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename MakeKey, typename MakeValue>
+auto BulkBuildIndex(BufferPoolManager *bpm, TableHeap *heap, BPlusTree<KeyType, ValueType, KeyComparator> *tree,
+                    MakeKey make_key, MakeValue make_value, const IndexBuildOptions &options) -> size_t {
+  using Entry = IndexEntry<KeyType, ValueType>;
+  const KeyComparator &comparator = tree->GetComparator();
+  auto less = [&comparator](const Entry &lhs, const Entry &rhs) { return comparator(lhs.key_, rhs.key_) < 0; };
+  ExternalSorter<Entry, decltype(less)> sorter(bpm, less, options.sort_options_);
+
+  {
+    auto iter = heap->MakeScanIterator();
+    std::vector<TupleView> batch;
+    while (iter.NextBatch(&batch)) {
+      for (const auto &tuple : batch) {
+        sorter.Add({make_key(tuple), make_value(tuple)});
+      }
+    }
+  }
+  sorter.Finish();
+
+  tree->BulkLoad(
+      sorter.GetCount(),
+      [&sorter](KeyType *key, ValueType *value) {
+        Entry entry;
+        if (!sorter.Next(&entry)) {
+          return false;
+        }
+        *key = entry.key_;
+        *value = entry.value_;
+        return true;
+      },
+      options.fill_factor_);
+  return sorter.GetCount();
+}
+
+/**
+ * @brief Build an index mapping the key of every live tuple of a table heap to its RID, see the generic overload.
+ * @param make_key builds the index key of a tuple: `auto make_key(const TupleView &tuple) -> KeyType`
+ * @return the number of entries loaded
+ */
+template <typename KeyType, typename KeyComparator, typename MakeKey>
+auto BulkBuildIndex(BufferPoolManager *bpm, TableHeap *heap, BPlusTree<KeyType, RID, KeyComparator> *tree,
+                    MakeKey make_key, const IndexBuildOptions &options = {}) -> size_t {
+  return BulkBuildIndex(
+      bpm, heap, tree, make_key, [](const TupleView &tuple) { return tuple.rid_; }, options);
+}
+
+}  // namespace redbase
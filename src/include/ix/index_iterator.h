@@ -0,0 +1,57 @@
+#pragma once
+
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "ix/b_plus_tree_leaf_page.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+#define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
+
+/**
+ * IndexIterator walks the leaf level of a B+ tree from left to right. It keeps the current leaf read latched, and
+ * latches the next leaf before releasing the current one, which is the order every other leaf-level access follows.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class IndexIterator {
+ public:
+  using LeafPage = B_PLUS_TREE_LEAF_PAGE_TYPE;
+
+  /** The end iterator. */
+  IndexIterator() = default;
+
+  /** An iterator positioned on entry `index` of a latched leaf, moved past the leaf if needed. */
+  IndexIterator(BufferPoolManager *bpm, ReadPageGuard guard, int index);
+
+  DISALLOW_COPY(IndexIterator);
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
+  ~IndexIterator() = default;
+
+  auto IsEnd() const -> bool { return !guard_.IsValid(); }
+
+  /** @return a copy of the current entry */
+  auto operator*() -> std::pair<KeyType, ValueType>;
+
+  auto operator++() -> IndexIterator &;
+
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return page_id_ == itr.page_id_ && index_ == itr.index_;
+  }
+
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
+
+ private:
+  /** Step over the exhausted leaves, becoming the end iterator after the last one. */
+  void SkipExhaustedLeaves();
+
+  BufferPoolManager *bpm_{nullptr};
+  ReadPageGuard guard_;
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int index_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "ix/lsm_memtable.h"
+#include "ix/lsm_run.h"
+
+namespace redbase {
+
+#define LSM_VERSION_TYPE LSMVersion<KeyType, ValueType, KeyComparator>
+#define LSM_MERGE_ITERATOR_TYPE LSMMergeIterator<KeyType, ValueType, KeyComparator>
+#define LSM_ITERATOR_TYPE LSMIterator<KeyType, ValueType, KeyComparator>
+
+/**
+ * The state of an LSM tree at one point in time. A version is never changed once published, writes to the memtable
+ * aside: flushes and compactions publish a new one, and readers hold on to the version they started with.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+struct LSMVersion {
+  std::shared_ptr<LSM_MEMTABLE_TYPE> memtable_;
+  /** Frozen memtables waiting to be written out, newest first. */
+  std::vector<std::shared_ptr<LSM_MEMTABLE_TYPE>> immutables_;
+  /** The runs of level 0 newest first, their key ranges overlap; every deeper level holds at most one run. */
+  std::vector<std::vector<std::shared_ptr<LSM_RUN_TYPE>>> levels_;
+};
+
+/**
+ * LSMMergeIterator merges sorted sources, memtables and runs, into one stream of keys in key order. Every key comes
+ * with the entry of the newest source that has it, tombstones included, and the older entries are skipped.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMMergeIterator {
+ public:
+  using MemTable = LSM_MEMTABLE_TYPE;
+  using Run = LSM_RUN_TYPE;
+
+  /** Both lists of sources are ordered newest first, the memtables are newer than the runs. */
+  LSMMergeIterator(const std::vector<const MemTable *> &memtables, const std::vector<const Run *> &runs,
+                   const KeyComparator &comparator);
+
+  /** Position on the first key not smaller than `key`. */
+  void Seek(const KeyType &key);
+
+  void SeekToFirst();
+
+  auto IsValid() const -> bool { return current_ >= 0; }
+
+  void Next();
+
+  auto Key() const -> const KeyType & { return sources_[current_].Key(); }
+  auto Value() const -> const ValueType & { return sources_[current_].Value(); }
+  auto IsDeleted() const -> bool { return sources_[current_].IsDeleted(); }
+
+ private:
+  struct Source {
+    bool is_memtable_;
+    typename MemTable::Iterator memtable_it_;
+    typename Run::Iterator run_it_;
+
+    auto IsValid() const -> bool { return is_memtable_ ? memtable_it_.IsValid() : run_it_.IsValid(); }
+    auto Key() const -> const KeyType & { return is_memtable_ ? memtable_it_.Key() : run_it_.Key(); }
+    auto Value() const -> const ValueType & { return is_memtable_ ? memtable_it_.Value() : run_it_.Value(); }
+    auto IsDeleted() const -> bool { return is_memtable_ ? memtable_it_.IsDeleted() : run_it_.IsDeleted(); }
+  };
+
+  /** Make the newest source holding the smallest key the current one. */
+  void FindCurrent();
+
+  KeyComparator comparator_;
+  std::vector<Source> sources_;
+  int current_{-1};
+};
+
+/**
+ * LSMIterator walks the live entries of an LSM tree in key order, with the interface of IndexIterator. It reads the
+ * version of the tree it was created on: writes made later are not seen, and the runs it reads are kept alive even
+ * if a compaction replaces them meanwhile.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMIterator {
+ public:
+  using Version = LSM_VERSION_TYPE;
+
+  /** The end iterator. */
+  LSMIterator() = default;
+
+  /** An iterator positioned on the first live key not smaller than `*start`, or the first live key if null. */
+  LSMIterator(std::shared_ptr<const Version> version, const KeyComparator &comparator, const KeyType *start);
+
+  DISALLOW_COPY(LSMIterator);
+  LSMIterator(LSMIterator &&that) noexcept = default;
+  auto operator=(LSMIterator &&that) noexcept -> LSMIterator & = default;
+  ~LSMIterator() = default;
+
+  auto IsEnd() const -> bool { return merge_ == nullptr; }
+
+  /** @return a copy of the current entry */
+  auto operator*() -> std::pair<KeyType, ValueType> { return {merge_->Key(), merge_->Value()}; }
+
+  auto operator++() -> LSMIterator &;
+
+  auto operator==(const LSMIterator &itr) const -> bool;
+
+  auto operator!=(const LSMIterator &itr) const -> bool { return !(*this == itr); }
+
+ private:
+  /** Step over tombstones, becoming the end iterator after the last key. */
+  void SkipDeleted();
+
+  std::shared_ptr<const Version> version_;
+  std::unique_ptr<LSM_MERGE_ITERATOR_TYPE> merge_;
+};
+
+}  // namespace redbase
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+#include "common/macros.h"
+#include "ix/b_plus_tree_page.h"
+
+namespace redbase {
+
+#define LSM_MEMTABLE_TYPE LSMMemTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * The memtable of an LSM tree: a skiplist holding the latest writes in key order. Every write adds a version of its
+ * key, tagged with a sequence number, and versions of a key are ordered newest first, so that the first node not
+ * smaller than a key is its latest version. A removal adds a tombstone version.
+ *
+ * Nodes are never changed or unlinked once published: a writer fills a node in and links it bottom up, with release
+ * stores of the next pointers, and readers follow them with acquire loads. Lookups and iterators therefore run
+ * without any latch, concurrently with one writer; writers are serialized by the caller.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMMemTable {
+  struct Node;
+
+ public:
+  static constexpr int MAX_HEIGHT = 12;
+
+  explicit LSMMemTable(const KeyComparator &comparator);
+
+  DISALLOW_COPY_AND_MOVE(LSMMemTable);
+
+  ~LSMMemTable();
+
+  /** Add a version of `key`, newer than every version already there. The caller serializes writers. */
+  void Put(const KeyType &key, const ValueType &value, bool deleted);
+
+  /**
+   * @param[out] deleted true if the latest version is a tombstone
+   * @return true and the latest version of `key` if the memtable has one
+   */
+  auto Get(const KeyType &key, ValueType *value, bool *deleted) const -> bool;
+
+  /** @return the number of versions, which bounds the number of distinct keys */
+  auto Size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /** Walks the latest version of every key in key order, tombstones included. */
+  class Iterator {
+   public:
+    Iterator() = default;
+    explicit Iterator(const LSMMemTable *memtable) : memtable_(memtable) {}
+
+    auto IsValid() const -> bool { return node_ != nullptr; }
+
+    /** Position on the first key not smaller than `key`. */
+    void Seek(const KeyType &key);
+
+    void SeekToFirst();
+
+    /** Move to the next key, past the older versions of the current one. */
+    void Next();
+
+    auto Key() const -> const KeyType & { return node_->key_; }
+    auto Value() const -> const ValueType & { return node_->value_; }
+    auto IsDeleted() const -> bool { return node_->deleted_; }
+
+   private:
+    const LSMMemTable *memtable_{nullptr};
+    const Node *node_{nullptr};
+  };
+
+ private:
+  struct Node {
+    KeyType key_;
+    ValueType value_;
+    uint64_t seq_;
+    bool deleted_;
+    /** One pointer per level the node is on, allocated past the end of the node. */
+    std::atomic<Node *> next_[1];
+
+    auto Next(int level) const -> Node * { return next_[level].load(std::memory_order_acquire); }
+  };
+
+  /** @return a node of `height` levels, unlinked */
+  auto NewNode(const KeyType &key, const ValueType &value, bool deleted, int height) -> Node *;
+
+  auto RandomHeight() -> int;
+
+  /** @return true if the node comes before the version (key, seq): a smaller key, or a newer version of it */
+  auto IsBefore(const Node *node, const KeyType &key, uint64_t seq) const -> bool;
+
+  /**
+   * @param[out] prev if not null, the last node before (key, seq) on every level
+   * @return the first node not before (key, seq)
+   */
+  auto FindGreaterOrEqual(const KeyType &key, uint64_t seq, Node **prev) const -> Node *;
+
+  KeyComparator comparator_;
+  Node *head_;
+  std::atomic<int> height_{1};
+  std::atomic<size_t> size_{0};
+  /** Written by the single writer only. */
+  uint64_t next_seq_{0};
+  std::minstd_rand rng_{0x5eed};
+};
+
+}  // namespace redbase
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "ix/b_plus_tree_page.h"
+#include "ix/bloom_filter.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+#define LSM_RUN_PAGE_TYPE LSMRunPage<KeyType, ValueType, KeyComparator>
+#define LSM_RUN_TYPE LSMRun<KeyType, ValueType, KeyComparator>
+static constexpr size_t LSM_RUN_PAGE_HEADER_SIZE = 8;
+
+/**
+ * Data page of an LSM run, sorted entries that each are the latest version of their key when the run was written.
+ * A tombstone entry records a removal, it shadows the versions of its key in older runs:
+ *
+ *  ------------------------------------------------------------------------------------------------------------
+ *  | Size (4) | Reserved (4) | KEY(1) | ... | KEY(n) | VALUE(1) | ... | VALUE(n) | DELETED(1) | ... | DELETED(n) |
+ *  ------------------------------------------------------------------------------------------------------------
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMRunPage {
+ public:
+  /** Number of entries that fit into a page, with room for the padding that aligns the key and value arrays. */
+  static constexpr int SLOT_CNT = (PAGE_SIZE - LSM_RUN_PAGE_HEADER_SIZE - alignof(KeyType) - alignof(ValueType)) /
+                                  (sizeof(KeyType) + sizeof(ValueType) + 1);
+
+  // Delete all constructor / destructor to ensure memory safety
+  LSMRunPage() = delete;
+  LSMRunPage(const LSMRunPage &other) = delete;
+
+  void Init() { size_ = 0; }
+
+  auto GetSize() const -> int { return static_cast<int>(size_); }
+  auto IsFull() const -> bool { return size_ >= SLOT_CNT; }
+
+  auto KeyAt(int index) const -> const KeyType & { return keys_[index]; }
+  auto ValueAt(int index) const -> const ValueType & { return values_[index]; }
+  auto IsDeletedAt(int index) const -> bool { return deleted_[index] != 0; }
+
+  /** @return the index of the first key not smaller than `key`, GetSize() if there is none */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /** Add an entry after the last one, its key must be larger. */
+  void Append(const KeyType &key, const ValueType &value, bool deleted);
+
+ private:
+  uint32_t size_;
+  uint32_t reserved_;
+  KeyType keys_[SLOT_CNT];
+  ValueType values_[SLOT_CNT];
+  uint8_t deleted_[SLOT_CNT];
+};
+
+/**
+ * LSMRun is an immutable sorted run of an LSM tree. Its data pages are written once, in key order and one after the
+ * other, by a Builder; the first key of every page is kept in memory as a fence pointer, so that a lookup reads a
+ * single data page, and a Bloom filter over the keys of the run answers most lookups of absent keys without any.
+ * The fences and the filter are persisted in pages of their own, from which the run can be loaded back.
+ *
+ * A run that compaction replaced is marked obsolete, its pages are handed back to the buffer pool when the last
+ * reader lets go of it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMRun {
+ public:
+  using RunPage = LSM_RUN_PAGE_TYPE;
+
+  /** Writes a new run from entries handed in strictly increasing key order. */
+  class Builder {
+   public:
+    /**
+     * @param expected_entries an upper bound of the number of entries, which sizes the Bloom filter
+     * @param bloom_false_positive_rate false positive rate of the filter, 0 for no filter
+     */
+    Builder(BufferPoolManager *bpm, const KeyComparator &comparator, size_t expected_entries,
+            double bloom_false_positive_rate);
+
+    void Add(const KeyType &key, const ValueType &value, bool deleted);
+
+    /**
+     * @brief Write out the last data page, the fences and the filter.
+     * @return the run, null if no entry was added
+     */
+    auto Finish() -> std::shared_ptr<LSMRun>;
+
+   private:
+    /** Flush the data page being filled. */
+    void FinishPage();
+
+    std::shared_ptr<LSMRun> run_;
+    WritePageGuard guard_;
+  };
+
+  /**
+   * @brief Load a run written by a Builder.
+   * @param fence_page_id first page of the fences, see GetFencePageId()
+   * @param bloom_page_id first page of the filter, INVALID_PAGE_ID if the run has none
+   */
+  LSMRun(BufferPoolManager *bpm, const KeyComparator &comparator, page_id_t fence_page_id, page_id_t bloom_page_id);
+
+  DISALLOW_COPY_AND_MOVE(LSMRun);
+
+  /** Deletes the pages of the run if it is obsolete. */
+  ~LSMRun();
+
+  /** @return false if the key is out of the key range of the run, or not in its filter */
+  auto MayContain(const KeyType &key) const -> bool;
+
+  /**
+   * @brief Look `key` up in its data page, for keys that passed MayContain().
+   * @param[out] deleted true if the entry is a tombstone
+   * @return true and the entry of `key` if the run has one
+   */
+  auto Get(const KeyType &key, ValueType *value, bool *deleted) const -> bool;
+
+  /** Hand the pages back to the buffer pool once the run is no longer used. */
+  void MarkObsolete() { obsolete_ = true; }
+
+  auto GetNumEntries() const -> size_t { return num_entries_; }
+
+  /** @return the number of pages the run was written to: data, fences and filter */
+  auto GetNumPages() const -> size_t { return num_pages_; }
+
+  auto GetFencePageId() const -> page_id_t { return fence_page_ids_[0]; }
+
+  auto GetBloomPageId() const -> page_id_t {
+    return bloom_filter_ == nullptr ? INVALID_PAGE_ID : bloom_filter_->GetFirstPageId();
+  }
+
+  /** Walks the entries of the run in key order, tombstones included. */
+  class Iterator {
+   public:
+    Iterator() = default;
+    explicit Iterator(const LSMRun *run) : run_(run) {}
+
+    auto IsValid() const -> bool { return guard_.IsValid(); }
+
+    /** Position on the first key not smaller than `key`. */
+    void Seek(const KeyType &key);
+
+    void SeekToFirst() { LoadPage(0, 0); }
+
+    void Next();
+
+    auto Key() const -> const KeyType & { return page_->KeyAt(index_); }
+    auto Value() const -> const ValueType & { return page_->ValueAt(index_); }
+    auto IsDeleted() const -> bool { return page_->IsDeletedAt(index_); }
+
+   private:
+
+    /** Latch data page `page_idx` and position on entry `index`, moving to the next pages if it is past the end. */
+    void LoadPage(size_t page_idx, int index);
+
+    const LSMRun *run_{nullptr};
+    ReadPageGuard guard_;
+    /** The data page latched by guard_. */
+    const RunPage *page_{nullptr};
+    size_t page_idx_{0};
+    int index_{0};
+    /** Data pages below this one were prefetched already. */
+    size_t prefetched_{0};
+  };
+
+ private:
+  LSMRun(BufferPoolManager *bpm, const KeyComparator &comparator);
+
+  /** @return the data page that may hold `key`, the last one whose first key is not greater */
+  auto FindPage(const KeyType &key) const -> size_t;
+
+  auto FetchDataPage(size_t page_idx, AccessType access_type) const -> ReadPageGuard;
+
+  /** Persist the fence pointers, see GetFencePageId(). */
+  void WriteFences();
+
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  /** The first key and the id of every data page. */
+  std::vector<KeyType> fence_keys_;
+  std::vector<page_id_t> page_ids_;
+  KeyType last_key_{};
+  std::vector<page_id_t> fence_page_ids_;
+  std::unique_ptr<BloomFilter> bloom_filter_;
+  size_t num_entries_{0};
+  size_t num_pages_{0};
+  std::atomic<bool> obsolete_{false};
+};
+
+}  // namespace redbase
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "ix/lsm_iterator.h"
+#include "ix/lsm_memtable.h"
+#include "ix/lsm_run.h"
+
+namespace redbase {
+
+#define LSMTREE_TYPE LSMTree<KeyType, ValueType, KeyComparator>
+
+/** Tuning knobs of an LSM tree. */
+struct LSMOptions {
+  /** The memtable is frozen, to be written out as a level-0 run, once it holds this many versions. */
+  size_t memtable_max_entries_{16384};
+  /** Level 0 is merged into level 1 once it holds this many runs. */
+  size_t level0_max_runs_{4};
+  /** Level i holds up to level0_max_runs_ memtables times level_size_ratio_^i entries before moving down. */
+  size_t level_size_ratio_{10};
+  /** False positive rate of the Bloom filter of every run, 0 for no filters. */
+  double bloom_false_positive_rate_{0.01};
+  /** How long the background task sleeps when there is nothing to flush or compact. */
+  std::chrono::milliseconds interval_{100};
+};
+
+/** Counters of an LSM tree, cumulative since it was opened. */
+struct LSMStats {
+  /** Versions written to the memtable, inserts and removals. */
+  size_t entries_inserted_{0};
+  /** Entries written to runs by flushes and compactions, over entries_inserted_ it is the write amplification. */
+  size_t entries_written_{0};
+  /** Pages of the runs written by flushes and compactions. */
+  size_t pages_written_{0};
+  /** Memtables written out as level-0 runs. */
+  size_t flushes_{0};
+  /** Runs merged into the next level. */
+  size_t compactions_{0};
+  /** Lookups of a run answered without reading it, by its key range or its Bloom filter. */
+  size_t runs_skipped_{0};
+  /** Lookups of a run that read one of its data pages. */
+  size_t runs_probed_{0};
+};
+
+/**
+ * LSMTree is a write-optimized alternative to the B+ tree with the same lookup and range-iterator interface. Writes
+ * go to an in-memory memtable; a full memtable is frozen and written out sequentially as an immutable sorted run, and
+ * runs are merged by a leveled compaction: level 0 holds the flushed runs, whose key ranges overlap, and each deeper
+ * level a single run, level_size_ratio_ times larger than the one above it. A key is therefore written a handful of
+ * times in large sequential batches instead of updating a leaf page in place. Removals write tombstones, which are
+ * dropped when they reach the bottom level.
+ *
+ * A lookup searches the memtables, then the runs from the newest to the oldest and stops at the first one that has
+ * the key; runs whose key range or Bloom filter excludes the key are skipped without a read, and the fence pointers
+ * of a run lead straight to the only data page that may hold it.
+ *
+ * The state of the tree is an immutable version, replaced by flushes and compactions; readers take a reference to
+ * the current version and run without latches. Writers are serialized, and flushes and compactions are serialized
+ * with each other, run by a background thread (see Start()) or, without one, by the writer that fills a memtable.
+ *
+ * The runs are durable, the memtables are not: call Flush() before closing the tree to keep the latest writes.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class LSMTree {
+  using MemTable = LSM_MEMTABLE_TYPE;
+  using SortedRun = LSM_RUN_TYPE;
+  using Version = LSM_VERSION_TYPE;
+
+ public:
+  /** @brief Create a new, empty tree. */
+  LSMTree(std::string name, BufferPoolManager *bpm, const KeyComparator &comparator, LSMOptions options = {});
+
+  /**
+   * @brief Open an existing tree.
+   * @param header_page_id the header page of the tree, see GetHeaderPageId()
+   */
+  LSMTree(std::string name, page_id_t header_page_id, BufferPoolManager *bpm, const KeyComparator &comparator,
+          LSMOptions options = {});
+
+  DISALLOW_COPY_AND_MOVE(LSMTree);
+
+  /** Stops the background task if it is running. The memtables are discarded, see Flush(). */
+  ~LSMTree();
+
+  /** @return true if the tree holds no key */
+  auto IsEmpty() const -> bool { return Begin().IsEnd(); }
+
+  /**
+   * @brief Insert a key/value pair.
+   * @return false if the key is already in the tree
+   */
+  auto Insert(const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * @brief Remove a key and its value, by writing a tombstone.
+   * @return false if the key is not in the tree
+   */
+  auto Remove(const KeyType &key) -> bool;
+
+  /**
+   * @brief Point lookup.
+   * @param[out] result the value of the key is appended to it
+   * @return true if the key is in the tree
+   */
+  auto GetValue(const KeyType &key, std::vector<ValueType> *result) const -> bool;
+
+  /** @return an iterator on the smallest key */
+  auto Begin() const -> LSM_ITERATOR_TYPE { return {CurrentVersion(), comparator_, nullptr}; }
+
+  /** @return an iterator on the first key not smaller than `key` */
+  auto Begin(const KeyType &key) const -> LSM_ITERATOR_TYPE { return {CurrentVersion(), comparator_, &key}; }
+
+  /** @return the end iterator */
+  auto End() const -> LSM_ITERATOR_TYPE { return {}; }
+
+  /** @return the page id of the header page, which lists the runs of the tree */
+  auto GetHeaderPageId() const -> page_id_t { return header_page_id_; }
+
+  /** Write the memtable out as a level-0 run, along with the frozen ones, so that every write so far is durable. */
+  void Flush();
+
+  /**
+   * @brief Do one unit of background work in the calling thread: write out the oldest frozen memtable, or else merge
+   * the first level that is over its size into the next one.
+   * @return false if there was nothing to do
+   */
+  auto CompactOnce() -> bool;
+
+  /** Start flushing and compacting in a background thread. */
+  void Start();
+
+  /** Stop the background thread, waiting for the current unit of work to finish. */
+  void Stop();
+
+  auto GetStats() const -> LSMStats;
+
+  /** @return the number of runs of every level, level 0 first */
+  auto GetRunCounts() const -> std::vector<size_t>;
+
+ private:
+  /** Frozen memtables a writer lets pile up for the background thread before writing them out itself. */
+  static constexpr size_t MAX_IMMUTABLES = 2;
+
+  auto CurrentVersion() const -> std::shared_ptr<const Version>;
+
+  /** Publish a copy of the current version changed by `update`. */
+  void UpdateVersion(const std::function<void(Version *)> &update);
+
+  /**
+   * @param[out] deleted true if the latest entry of the key is a tombstone
+   * @return true and the latest entry of `key` if the version has one
+   */
+  auto Lookup(const Version &version, const KeyType &key, ValueType *value, bool *deleted) const -> bool;
+
+  /** Add a version of `key` to the memtable, freezing it once full. Called with write_latch_ held. */
+  void Write(const KeyType &key, const ValueType &value, bool deleted);
+
+  /** Swap the memtable for an empty one. Called with write_latch_ held. */
+  void FreezeMemTable();
+
+  /** Write the oldest frozen memtable out as a level-0 run. Called with maintenance_latch_ held. */
+  auto FlushImmutable() -> bool;
+
+  /** Merge the first level that is over its size into the next one. Called with maintenance_latch_ held. */
+  auto CompactLevel() -> bool;
+
+  /** @return the number of entries level `level` (> 0) may hold */
+  auto LevelCapacity(size_t level) const -> size_t;
+
+  /** Persist the list of runs of `version` to the header page. */
+  void WriteHeader(const Version &version);
+
+  /** Body of the background thread. */
+  void Run();
+
+  std::string index_name_;
+  BufferPoolManager *bpm_;
+  KeyComparator comparator_;
+  LSMOptions options_;
+  page_id_t header_page_id_;
+
+  /** Protects current_, held only to read or swap the pointer. */
+  mutable std::mutex version_latch_;
+  std::shared_ptr<const Version> current_;
+  /** Serializes the writers. */
+  std::mutex write_latch_;
+  /** Serializes flushes and compactions. */
+  std::mutex maintenance_latch_;
+
+  std::atomic<size_t> entries_inserted_{0};
+  std::atomic<size_t> entries_written_{0};
+  std::atomic<size_t> pages_written_{0};
+  std::atomic<size_t> flushes_{0};
+  std::atomic<size_t> compactions_{0};
+  mutable std::atomic<size_t> runs_skipped_{0};
+  mutable std::atomic<size_t> runs_probed_{0};
+
+  /** Protects stop_, the background thread sleeps on cv_. */
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::optional<std::thread> background_thread_;
+};
+
+}  // namespace redbase
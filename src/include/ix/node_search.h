@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+/** Implementations of the in-node search of integer keys. */
+enum class SearchKernel { SCALAR, SSE4, AVX2 };
+
+/** true for the trees whose nodes search keys with NodeLowerBound() / NodeUpperBound() */
+template <typename KeyType, typename KeyComparator>
+inline constexpr bool HAS_SIMD_SEARCH =
+    (std::is_same_v<KeyType, int32_t> || std::is_same_v<KeyType, int64_t>) &&
+    std::is_same_v<KeyComparator, IntegerComparator<KeyType>>;
+
+/** @return the fastest kernel the CPU supports, detected once */
+auto GetSearchKernel() -> SearchKernel;
+
+/** @return the name of a kernel */
+auto SearchKernelName(SearchKernel kernel) -> const char *;
+
+/**
+ * @brief Lower bound in a sorted array of integer keys: a branch-free binary search narrows the range down to one cache
+ * line of keys, which is then compared against the key a vector at a time.
+ * @return the number of the `n` keys that are smaller than `key`
+ */
+auto NodeLowerBound(const int32_t *keys, int n, int32_t key) -> int;
+auto NodeLowerBound(const int64_t *keys, int n, int64_t key) -> int;
+
+/** @return the number of the `n` sorted keys that are not greater than `key` */
+auto NodeUpperBound(const int32_t *keys, int n, int32_t key) -> int;
+auto NodeUpperBound(const int64_t *keys, int n, int64_t key) -> int;
+
+/**
+ * @brief The same searches with a given kernel, which the CPU must support (see GetSearchKernel()), for tests and
+ * benchmarks.
+ * @param upper count the keys not greater than `key` instead of the keys smaller than it
+ */
+auto NodeSearch(SearchKernel kernel, const int32_t *keys, int n, int32_t key, bool upper) -> int;
+auto NodeSearch(SearchKernel kernel, const int64_t *keys, int n, int64_t key, bool upper) -> int;
+
+}  // namespace redbase
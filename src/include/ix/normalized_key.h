@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "rm/schema.h"
+
+namespace redbase {
+
+/**
+ * KeyNormalizer encodes the key columns of a tuple into a binary string whose byte order (memcmp) is the order of the
+ * keys, so that comparing two keys needs neither the schema nor a dispatch on the column types. Every column takes
+ * a fixed number of bytes:
+ *
+ *  - a flag byte, 0 for NULL (NULLs sort first) and 1 otherwise, followed by the value, zeroed if NULL;
+ *  - INTEGER, DATE, BIGINT: big endian, sign bit flipped;
+ *  - DOUBLE: big endian IEEE bits, all bits flipped for negative numbers and only the sign bit for the others;
+ *  - CHAR(n): the n bytes of the column, zero padded.
+ */
+class KeyNormalizer {
+ public:
+  /**
+   * @param schema the schema of the tuples to encode
+   * @param key_attrs the columns of the schema the key is made of, in key order
+   */
+  KeyNormalizer(const Schema *schema, std::vector<uint32_t> key_attrs);
+
+  /** A normalizer of key tuples, every column of the key schema being part of the key. */
+  explicit KeyNormalizer(const Schema *key_schema);
+
+  /** @return the size of an encoded key */
+  auto GetKeySize() const -> uint32_t { return key_size_; }
+
+  /** Encode the key of a tuple into GetKeySize() bytes. */
+  void Normalize(const char *tuple, char *out) const;
+
+ private:
+  const Schema *schema_;
+  std::vector<uint32_t> key_attrs_;
+  uint32_t key_size_{0};
+};
+
+/**
+ * NormalizedKey is the fixed-size key of an index over normalized keys (see KeyNormalizer), zero padded up to
+ * KeySize bytes. The nodes of such a tree are prefix compressed (see BPlusTreePrefixPage).
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  /** Encode the key of a tuple. */
+  void SetFromTuple(const char *tuple, const KeyNormalizer &normalizer) {
+    if (normalizer.GetKeySize() > KeySize) {
+      throw Exception(fmt::format("normalized key of {} bytes does not fit in {}", normalizer.GetKeySize(), KeySize));
+    }
+    memset(data_, 0, KeySize);
+    normalizer.Normalize(tuple, reinterpret_cast<char *>(data_));
+  }
+
+  /** @return the bytes of the key in hex, for debugging */
+  auto ToString() const -> std::string {
+    std::string str;
+    for (auto byte : data_) {
+      str += fmt::format("{:02x}", byte);
+    }
+    return str;
+  }
+
+  uint8_t data_[KeySize];
+};
+
+/** Orders NormalizedKeys with a single memcmp. */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  auto operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const -> int {
+    int cmp = memcmp(lhs.data_, rhs.data_, KeySize);
+    return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+  }
+};
+
+}  // namespace redbase
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+/** Extents are reserved in multiples of this many bytes. */
+static constexpr uint32_t COMPRESSED_EXTENT_ALIGN = 256;
+
+/** Where a logical page lives in a compressed db file. */
+struct PageExtent {
+  /** Byte offset of the extent in the db file. */
+  uint64_t offset_;
+  /** Bytes stored, PAGE_SIZE means the page did not compress and is stored raw. */
+  uint32_t size_;
+  /** Bytes reserved for the page, size_ rounded up to COMPRESSED_EXTENT_ALIGN. */
+  uint32_t capacity_;
+};
+
+/**
+ * CompressedPFManager stores every page compressed with PageCodec. Pages no longer sit at page_id * PAGE_SIZE: a
+ * page translation table maps each logical page id to a variable-length extent of the file. When a page is
+ * rewritten it stays in its extent if it still fits, otherwise the old extent goes back to the free-space map and
+ * a new one is carved out of the best fitting free extent (or the end of the file). Free extents are coalesced.
+ *
+ * The translation table lives in memory and is written through to `<db_file>.ptt`: a snapshot of the table followed
+ * by a journal that gets one record per page whose extent changed, appended once the page is written and before the
+ * extent it left can be reused. Before a record is appended the page bytes are synced to the db file, and the record
+ * is synced before the extent the page left is freed, so a crash leaves a moved page either at its new extent or
+ * intact at its old one, and never lets a page be read from bytes another page took over (a page rewritten in place
+ * can be torn, as with PFManager). Journal records and the snapshot carry a checksum: opening replays the journal up
+ * to the first record that does not check out (one torn by the crash), and refuses a snapshot that does not. The
+ * snapshot is rewritten on open, by Shutdown() and whenever the journal outgrows the table: written aside and synced,
+ * then renamed over the old one and the directory synced, so that the journal it replaces is only dropped once the
+ * new table is on disk. The free-space map is rebuilt from the gaps between extents when the file is opened again.
+ *
+ * Like PFManager, concurrent ReadPage()/WritePage() calls on the same page must be serialized by the caller (the
+ * DiskScheduler does).
+ */
+class CompressedPFManager : public PFManager {
+ public:
+  /** Open or create a compressed db file, loading its translation table if there is one. */
+  explicit CompressedPFManager(const std::string &db_file);
+
+  /** Close the files, without a snapshot: the journal has every change. */
+  ~CompressedPFManager() override;
+
+  /** Write a snapshot of the translation table and close the file. */
+  void Shutdown() override;
+
+  /** Read a page, a page that was never written reads as zeros. */
+  void ReadPage(page_id_t page_id, char *data) override;
+
+  /** Compress and write a page. */
+  void WritePage(page_id_t page_id, const char *data) override;
+
+  /** @return the extent of a page, nullopt if it was never written */
+  auto GetExtent(page_id_t page_id) -> std::optional<PageExtent>;
+
+  /** @return the bytes below the end of the file that are free for reuse */
+  auto GetFreeBytes() -> uint64_t;
+
+  /** @return the end of the last extent in the file */
+  auto GetFileEnd() -> uint64_t;
+
+ private:
+  /** Reserve an extent for `size` bytes. Caller holds ptt_latch_. */
+  auto AllocateExtent(uint32_t size) -> PageExtent;
+
+  /** Return a byte range to the free-space map. Caller holds ptt_latch_. */
+  void FreeExtent(uint64_t offset, uint64_t length);
+
+  /** Read the snapshot of the translation table and replay its journal. */
+  void LoadTranslationTable();
+
+  /** Replace the snapshot with the table and start an empty journal. Caller holds ptt_latch_. */
+  void StoreTranslationTable();
+
+  /**
+   * Journal the new extent of a page, compacting the journal when it is too long. The record is on disk when this
+   * returns. Caller holds ptt_latch_.
+   */
+  void AppendTranslation(page_id_t page_id, const PageExtent &extent);
+
+  /** Sync the page bytes written so far to the db file, before the table points at them. */
+  void SyncPages();
+
+  void CloseFiles();
+
+  std::string ptt_filename_;
+  /** Appends to the .ptt file, past the snapshot. */
+  int ptt_fd_{-1};
+  size_t journal_records_{0};
+  /** The db file, opened again to sync the pages PFManager writes. */
+  int db_sync_fd_{-1};
+
+  /** Protects the translation table and the free-space map. */
+  std::mutex ptt_latch_;
+  std::unordered_map<page_id_t, PageExtent> ptt_;
+  /** Free extents below file_end_, offset -> length. */
+  std::map<uint64_t, uint64_t> free_extents_;
+  uint64_t file_end_{0};
+};
+
+}  // namespace redbase
@@ -43,8 +43,6 @@ class DiskScheduler {
   ~DiskScheduler();
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Schedules a request for the DiskManager to execute.
    *
    * @param r The request to be scheduled.
@@ -52,8 +50,6 @@ class DiskScheduler {
   void Schedule(DiskRequest r);
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Background worker thread function that processes scheduled requests.
    *
    * The background thread needs to process requests while the DiskScheduler exists, i.e., this function should not
@@ -73,7 +69,7 @@ class DiskScheduler {
 
  private:
   /** Pointer to the disk manager. */
-  PFManager *pf_manager_ __attribute__((__unused__));
+  PFManager *pf_manager_;
   /** A shared queue to concurrently schedule and process requests. When the DiskScheduler's destructor is called,
    * `std::nullopt` is put into the queue to signal to the background thread to stop execution. */
   
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace redbase {
+
+static constexpr uint64_t OVERFLOW_PAGE_HEADER_SIZE = 8;
+
+/**
+ * One link of an overflow page chain, holding a chunk of a large value.
+ *
+ *  Header format (size in bytes):
+ *  ----------------------------------------------------------------------------
+ *  | NextPageId (4) | ChunkSize (4) | ... CHUNK BYTES ... |
+ *  ----------------------------------------------------------------------------
+ */
+class OverflowPage {
+ public:
+  /** Max number of value bytes a single page holds. */
+  static constexpr uint32_t CHUNK_CAPACITY = PAGE_SIZE - OVERFLOW_PAGE_HEADER_SIZE;
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    chunk_size_ = 0;
+  }
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  auto GetChunkSize() const -> uint32_t { return chunk_size_; }
+
+  void SetChunkSize(uint32_t chunk_size) { chunk_size_ = chunk_size; }
+
+  auto GetChunk() const -> const char * { return chunk_; }
+
+  auto GetChunkMut() -> char * { return chunk_; }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t chunk_size_;
+  char chunk_[0];
+};
+
+static_assert(sizeof(OverflowPage) == OVERFLOW_PAGE_HEADER_SIZE);
+
+}  // namespace redbase
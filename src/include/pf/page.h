@@ -6,7 +6,7 @@
 
 #include "common/config.h"
 #include "common/rwlatch.h"
-#include "buffer/buffer_pool_manager.h"
+#include <atomic>
 #include <string.h>
 
 
@@ -19,7 +19,9 @@ friend class BufferPoolManager;
 private:
     /** Page data */
     char *data_{nullptr};
-    RWLatch *rwlock_;
+    RWLatch rwlatch_;
+    /** Odd while the page is write latched, bumped on every WLatch() and WUnlatch(). */
+    std::atomic<uint64_t> version_{0};
 
     /** How many txn use this page */
     int pin_count_{0};
@@ -59,13 +61,36 @@ public:
     /* Is Dirty */
     inline bool IsDirty() { return is_dirty_; }
 
-    inline void RLatch() { rwlock_->RLock(); }
+    inline void RLatch() { rwlatch_.RLock(); }
 
-    inline void RUnlatch() { rwlock_->RUnlock(); }
+    inline void RUnlatch() { rwlatch_.RUnlock(); }
 
-    inline void WLatch() { rwlock_->WLock(); }
+    inline void WLatch() {
+        rwlatch_.WLock();
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // the odd version must be visible before any of the writes to the page
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    inline void WUnlatch() {
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        rwlatch_.WUnlock();
+    }
+
+    /**
+     * Optimistic reads: a reader that keeps the page pinned but does not latch it takes the version first, reads,
+     * then validates the version. The read is consistent if the version was even and did not move.
+     */
+    inline uint64_t GetVersion() { return version_.load(std::memory_order_acquire); }
 
-    inline void WUnlatch() { rwlock_->WUnlock(); }
+    /** @return true if the page was not write latched since `version` was taken */
+    inline bool ValidateVersion(uint64_t version) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == version;
+    }
+
+    /** @return true if the version was taken while a writer held the page */
+    static inline bool IsWriteLocked(uint64_t version) { return (version & 1) != 0; }
 };
 
 
@@ -73,4 +98,3 @@ public:
     
 } // namespace redbase
 
-
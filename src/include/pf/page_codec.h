@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+namespace redbase {
+
+/**
+ * PageCodec is a small LZ77 block compressor in the spirit of LZ4, used to store pages compressed on disk without
+ * pulling in an external library.
+ *
+ * A block is a list of sequences. Each sequence is a token byte (high nibble: literal count, low nibble: match
+ * length - 4, 15 meaning "more bytes follow"), the extra literal count bytes, the literals, a 2-byte little endian
+ * match offset and the extra match length bytes. The last sequence only carries literals.
+ */
+class PageCodec {
+ public:
+  /** @return the size of the largest block Compress() can produce for `src_size` bytes */
+  static constexpr auto CompressBound(size_t src_size) -> size_t { return src_size + src_size / 255 + 16; }
+
+  /**
+   * @brief Compress a block.
+   * @return the compressed size, or 0 if the result would not fit into `dst_capacity` bytes
+   */
+  static auto Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> size_t;
+
+  /**
+   * @brief Decompress a block that must expand to exactly `dst_size` bytes.
+   * @return false if the block is corrupt
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) -> bool;
+};
+
+}  // namespace redbase
@@ -83,10 +83,19 @@ class BasicPageGuard {
    */
   auto UpgradeWrite() -> WritePageGuard;
 
+  /** @return false if the guard holds no page, e.g. the fetch failed because every frame was pinned */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
   auto PageId() -> page_id_t { return page_->GetPageId(); }
 
   auto GetData() -> const char * { return page_->GetData(); }
 
+  /** @return the version of the page, for reads through an unlatched guard (see Page::GetVersion()) */
+  auto GetVersion() -> uint64_t { return page_->GetVersion(); }
+
+  /** @return true if the page was not modified since `version` was taken */
+  auto ValidateVersion(uint64_t version) -> bool { return page_->ValidateVersion(version); }
+
   template <class T>
   auto As() -> const T * {
     return reinterpret_cast<const T *>(GetData());
@@ -162,10 +171,15 @@ class ReadPageGuard {
    */
   ~ReadPageGuard();
 
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
   auto PageId() -> page_id_t { return guard_.PageId(); }
 
   auto GetData() -> const char * { return guard_.GetData(); }
 
+  /** @return true if the page was not modified since `version` was taken, see Page::ValidateVersion() */
+  auto ValidateVersion(uint64_t version) -> bool { return guard_.ValidateVersion(version); }
+
   template <class T>
   auto As() -> const T * {
     return guard_.As<T>();
@@ -222,10 +236,15 @@ class WritePageGuard {
    */
   ~WritePageGuard();
 
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
   auto PageId() -> page_id_t { return guard_.PageId(); }
 
   auto GetData() -> const char * { return guard_.GetData(); }
 
+  /** @return true if the page was not modified since `version` was taken, see Page::ValidateVersion() */
+  auto ValidateVersion(uint64_t version) -> bool { return guard_.ValidateVersion(version); }
+
   template <class T>
   auto As() -> const T * {
     return guard_.As<T>();
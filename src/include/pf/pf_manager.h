@@ -1,12 +1,35 @@
 #pragma once
 
 #include "common/config.h"
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <mutex>
 #include <fstream>
 
 namespace redbase {
 
+/* A snapshot of the I/O counters of a PFManager */
+struct IOStats {
+    uint64_t num_reads_{0};
+    uint64_t num_writes_{0};
+    /* bytes of pages handed in/out by the caller */
+    uint64_t logical_bytes_read_{0};
+    uint64_t logical_bytes_written_{0};
+    /* bytes that actually hit the file */
+    uint64_t physical_bytes_read_{0};
+    uint64_t physical_bytes_written_{0};
+    /* CPU time spent in the page codec, 0 when the pages are stored raw */
+    uint64_t compress_ns_{0};
+    uint64_t decompress_ns_{0};
+
+    /* logical / physical bytes written, 1.0 for raw pages */
+    auto CompressionRatio() const -> double {
+        return physical_bytes_written_ == 0 ? 1.0
+                                            : static_cast<double>(logical_bytes_written_) / physical_bytes_written_;
+    }
+};
+
 class PFManager {
 public:
     /* Create a DB file */
@@ -18,18 +41,41 @@ public:
     virtual ~PFManager() = default;
 
     /* close file resources */
-    void Shutdown();
+    virtual void Shutdown();
 
     /* Read a page data by a page_number from db_file */
     virtual void ReadPage(page_id_t page_id, char *data);
 
     /* Write a page data use a page_number */
     virtual void WritePage(page_id_t page_id, const char *data);
+
+    /* I/O counters since the file was opened */
+    auto GetIOStats() const -> IOStats;
     
 
 protected:
     auto GetSelfFileSize() -> size_t;
 
+    auto GetFileName() const -> const std::string & { return db_filename_; }
+
+    /* Read up to size bytes at a byte offset, return how many bytes were read */
+    auto ReadBytes(size_t offset, char *data, size_t size) -> size_t;
+
+    /* Write size bytes at a byte offset */
+    void WriteBytes(size_t offset, const char *data, size_t size);
+
+    struct IOCounters {
+        std::atomic<uint64_t> num_reads_{0};
+        std::atomic<uint64_t> num_writes_{0};
+        std::atomic<uint64_t> logical_bytes_read_{0};
+        std::atomic<uint64_t> logical_bytes_written_{0};
+        std::atomic<uint64_t> physical_bytes_read_{0};
+        std::atomic<uint64_t> physical_bytes_written_{0};
+        std::atomic<uint64_t> compress_ns_{0};
+        std::atomic<uint64_t> decompress_ns_{0};
+    };
+    IOCounters io_counters_;
+
 private:
     std::fstream db_io_;
     std::string db_filename_;
@@ -37,4 +83,4 @@ private:
 };
 
 
-}
\ No newline at end of file
+}
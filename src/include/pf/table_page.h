@@ -1,11 +1,117 @@
 #pragma once
 
-class TablePage
-{
-private:
-    /* data */
-    
-public:
+#include <cstdint>
+#include <optional>
 
+#include "common/config.h"
 
+namespace redbase {
+
+static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
+
+/** Per-tuple metadata kept in the slot array. */
+struct TupleMeta {
+  /** The tuple was deleted, its slot stays so that the RIDs of later tuples do not move. */
+  bool is_deleted_;
 };
+
+/**
+ * Slotted page format:
+ *  ---------------------------------------------------------
+ *  | HEADER | ... FREE SPACE ... | ... INSERTED TUPLES ... |
+ *  ---------------------------------------------------------
+ *                                ^
+ *                                free space pointer
+ *
+ *  Header format (size in bytes):
+ *  ----------------------------------------------------------------------------
+ *  | NextPageId (4)| NumTuples(2) | NumDeletedTuples(2) |
+ *  ----------------------------------------------------------------------------
+ *  ----------------------------------------------------------------
+ *  | Tuple_1 offset+size+meta (6) | Tuple_2 offset+size+meta (6) | ... |
+ *  ----------------------------------------------------------------
+ *
+ * Tuples are packed from the end of the page towards the slot array, in slot order.
+ */
+class TablePage {
+ public:
+  /** Initialize the TablePage header. */
+  void Init();
+
+  /** @return number of tuples in this page, deleted ones included */
+  auto GetNumTuples() const -> uint32_t { return num_tuples_; }
+
+  /** @return number of deleted tuples in this page */
+  auto GetNumDeletedTuples() const -> uint32_t { return num_deleted_tuples_; }
+
+  /** @return the page ID of the next table page */
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /** @return the size of the largest tuple an empty page can hold */
+  static constexpr auto GetMaxTupleSize() -> uint32_t {
+    return PAGE_SIZE - TABLE_PAGE_HEADER_SIZE - TUPLE_INFO_SIZE;
+  }
+
+  /** @return the offset the next tuple of `size` bytes would be stored at, or nullopt if it does not fit */
+  auto GetNextTupleOffset(uint32_t size) const -> std::optional<uint16_t>;
+
+  /**
+   * Insert a tuple into the page.
+   * @return the slot number of the new tuple, or nullopt if the page is full
+   */
+  auto InsertTuple(const TupleMeta &meta, const char *data, uint32_t size) -> std::optional<uint16_t>;
+
+  /** Update the metadata of a tuple. */
+  void UpdateTupleMeta(const TupleMeta &meta, uint32_t slot_num);
+
+  /** @return the metadata of a tuple */
+  auto GetTupleMeta(uint32_t slot_num) const -> TupleMeta;
+
+  /**
+   * @param[out] size the size of the tuple in bytes
+   * @return a pointer to the bytes of the tuple, valid as long as the page stays pinned
+   */
+  auto GetTupleData(uint32_t slot_num, uint32_t *size) const -> const char *;
+
+  /** Overwrite a tuple with new bytes of the same size. @return false if the size differs */
+  auto UpdateTupleInPlace(uint32_t slot_num, const char *data, uint32_t size) -> bool;
+
+  /** @return the number of bytes taken by tuples that are not deleted */
+  auto GetLiveBytes() const -> uint32_t;
+
+  /** @return the bytes inserts could use (tuple data plus their slots) once Compact() has run */
+  auto GetCompactedFreeSpace() const -> uint32_t {
+    return PAGE_SIZE - TABLE_PAGE_HEADER_SIZE - TUPLE_INFO_SIZE * num_tuples_ - GetLiveBytes();
+  }
+
+  /** @return the bytes of page taken by the slot of a tuple, on top of the tuple itself */
+  static constexpr auto GetSlotSize() -> uint32_t { return TUPLE_INFO_SIZE; }
+
+  /**
+   * Repack the live tuples against the end of the page so that the space of deleted tuples can take inserts again.
+   * Slots (and thus RIDs) do not move, but the bytes of deleted tuples are dropped for good.
+   */
+  void Compact();
+
+ private:
+  struct TupleInfo {
+    uint16_t offset_;
+    uint16_t size_;
+    TupleMeta meta_;
+  };
+  static constexpr size_t TUPLE_INFO_SIZE = sizeof(TupleInfo);
+
+  char page_start_[0];
+  page_id_t next_page_id_;
+  uint16_t num_tuples_;
+  uint16_t num_deleted_tuples_;
+  TupleInfo tuple_info_[0];
+};
+
+static_assert(sizeof(page_id_t) == 4);
+static_assert(sizeof(TablePage) == TABLE_PAGE_HEADER_SIZE);
+
+}  // namespace redbase
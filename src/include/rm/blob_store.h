@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "pf/page_guard.h"
+
+namespace redbase {
+
+/**
+ * Handle of a large value stored in an overflow page chain. It is small enough to be embedded in a tuple in place
+ * of the value itself.
+ */
+struct BlobId {
+  /** First page of the chain, INVALID_PAGE_ID for an empty value. */
+  page_id_t first_page_id_{INVALID_PAGE_ID};
+  /** Size of the value in bytes. */
+  uint64_t size_{0};
+};
+
+/**
+ * BlobWriter streams a large value into a new overflow page chain. Only the tail page of the chain is pinned at a
+ * time, so values of any size can be written without materializing them.
+ */
+class BlobWriter {
+ public:
+  explicit BlobWriter(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  DISALLOW_COPY(BlobWriter);
+  BlobWriter(BlobWriter &&that) noexcept = default;
+  auto operator=(BlobWriter &&that) noexcept -> BlobWriter & = default;
+  ~BlobWriter() = default;
+
+  /** Append bytes to the value. */
+  void Append(const char *data, size_t size);
+
+  /** Release the tail page. @return the handle of the written value */
+  auto Finish() -> BlobId;
+
+ private:
+  /** Chain a new page after the tail page. */
+  void NextPage();
+
+  BufferPoolManager *bpm_;
+  BlobId id_;
+  BasicPageGuard tail_;
+};
+
+/**
+ * BlobReader streams a large value out of its overflow page chain, one page chunk at a time. Pages are fetched with
+ * AccessType::Scan so that reading a large value does not push the hot set out of the buffer pool, and the next page
+ * of the chain is prefetched while the current one is being consumed.
+ */
+class BlobReader {
+ public:
+  BlobReader(BufferPoolManager *bpm, BlobId id);
+
+  DISALLOW_COPY(BlobReader);
+  BlobReader(BlobReader &&that) noexcept = default;
+  auto operator=(BlobReader &&that) noexcept -> BlobReader & = default;
+  ~BlobReader() = default;
+
+  /**
+   * @brief Zero-copy access to the next chunk of the value.
+   *
+   * The chunk points into a page the reader keeps pinned until the next call to NextChunk() or Read().
+   *
+   * @param[out] data start of the chunk
+   * @param[out] size size of the chunk
+   * @return false once the whole value has been read
+   */
+  auto NextChunk(const char **data, size_t *size) -> bool;
+
+  /**
+   * @brief Copy the next bytes of the value into `buffer`.
+   * @return the number of bytes copied, less than `size` only at the end of the value
+   */
+  auto Read(char *buffer, size_t size) -> size_t;
+
+  /** @return the number of bytes not read yet */
+  auto Remaining() const -> uint64_t { return id_.size_ - consumed_; }
+
+ private:
+  /** Move to the next page of the chain. @return false at the end of the chain */
+  auto NextPage() -> bool;
+
+  BufferPoolManager *bpm_;
+  BlobId id_;
+  page_id_t next_page_id_;
+  ReadPageGuard page_;
+  /** Bytes of the current page chunk already handed out. */
+  uint32_t chunk_offset_{0};
+  uint64_t consumed_{0};
+};
+
+/**
+ * BlobStore keeps values too large for a TablePage in chains of overflow pages, built on the buffer pool.
+ */
+class BlobStore {
+ public:
+  explicit BlobStore(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /** Store a value in one call. */
+  auto Put(const char *data, size_t size) -> BlobId;
+
+  /** @return a writer for a new value */
+  auto NewWriter() -> BlobWriter { return BlobWriter(bpm_); }
+
+  /** @return a reader over a stored value */
+  auto NewReader(BlobId id) -> BlobReader { return {bpm_, id}; }
+
+  /** Drop the pages of a value. */
+  void Delete(BlobId id);
+
+ private:
+  BufferPoolManager *bpm_;
+};
+
+}  // namespace redbase
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+
+#include "rm/zone_map.h"
+
+namespace redbase {
+
+/**
+ * DynamicFilter is a range on a column of a table that is only known while the query runs: an operator above the
+ * scan narrows it as it learns which rows it has no use for (a Top-N, once it holds its N rows, has no use for the
+ * rows past the worst of them), and the scans of the table check it as they go, to skip pages with the zone map and
+ * to drop rows before they leave the scan. The range only ever narrows, so a row a scan lets through under an older
+ * range is merely one the operator will drop itself.
+ */
+class DynamicFilter {
+ public:
+  /**
+   * @param column_idx the column of the table the range is on
+   * @param include_nulls whether NULLs pass the range (see ColumnRange)
+   */
+  explicit DynamicFilter(uint32_t column_idx, bool include_nulls = false);
+
+  /** Narrow the range to the values below `bound` (up to it if `inclusive`); a looser bound is ignored. */
+  void TightenUpper(const Value &bound, bool inclusive);
+
+  /** Narrow the range to the values above `bound` (from it on if `inclusive`); a looser bound is ignored. */
+  void TightenLower(const Value &bound, bool inclusive);
+
+  /** Widen the range back to every value, for a new run of the query; no scan may be checking the filter. */
+  void Reset();
+
+  /** @return the current range */
+  auto GetRange() const -> ColumnRange;
+
+  /** @return a number that changes whenever the range does, 0 while it is unbounded */
+  auto GetVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  auto GetColumnIdx() const -> uint32_t { return range_.column_idx_; }
+
+ private:
+  mutable std::mutex latch_;
+  ColumnRange range_;
+  std::atomic<uint64_t> version_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rm/value.h"
+
+namespace redbase {
+
+class Column {
+ public:
+  /**
+   * @param name name of the column
+   * @param type_id type of the column
+   * @param length length of a CHAR column, ignored for the other types
+   */
+  Column(std::string name, TypeId type_id, uint32_t length = 0)
+      : name_(std::move(name)), type_id_(type_id), length_(type_id == TypeId::CHAR ? length : TypeSize(type_id)) {}
+
+  auto GetName() const -> const std::string & { return name_; }
+
+  auto GetType() const -> TypeId { return type_id_; }
+
+  /** @return the number of bytes the column takes in a tuple */
+  auto GetLength() const -> uint32_t { return length_; }
+
+ private:
+  std::string name_;
+  TypeId type_id_;
+  uint32_t length_;
+};
+
+/**
+ * Schema describes the layout of the fixed-length tuples of a table:
+ *
+ *  ------------------------------------------------------------
+ *  | NULL bitmap (1 bit per column) | column 0 | column 1 | ... |
+ *  ------------------------------------------------------------
+ *
+ * Every column sits at a fixed offset, so a column of a tuple can be read straight out of a page.
+ */
+class Schema {
+ public:
+  explicit Schema(std::vector<Column> columns);
+
+  auto GetColumns() const -> const std::vector<Column> & { return columns_; }
+
+  auto GetColumn(uint32_t col_idx) const -> const Column & { return columns_[col_idx]; }
+
+  auto GetColumnCount() const -> uint32_t { return static_cast<uint32_t>(columns_.size()); }
+
+  /** @return the index of the column with the given name */
+  auto GetColumnIdx(const std::string &name) const -> std::optional<uint32_t>;
+
+  /** @return the offset of a column inside a tuple */
+  auto GetOffset(uint32_t col_idx) const -> uint32_t { return offsets_[col_idx]; }
+
+  /** @return the size of a tuple in bytes */
+  auto GetTupleSize() const -> uint32_t { return tuple_size_; }
+
+  auto IsNull(const char *tuple, uint32_t col_idx) const -> bool {
+    return (tuple[col_idx / 8] & (1 << (col_idx % 8))) != 0;
+  }
+
+  /** @return the value of a numeric column */
+  auto GetValue(const char *tuple, uint32_t col_idx) const -> Value;
+
+  /** Store a numeric value (or a NULL) in a column. */
+  void SetValue(char *tuple, uint32_t col_idx, const Value &value) const;
+
+  /** @return the bytes of a CHAR column, without the zero padding */
+  auto GetChar(const char *tuple, uint32_t col_idx) const -> std::string_view;
+
+  /** Store a string in a CHAR column, truncated to the column length. */
+  void SetChar(char *tuple, uint32_t col_idx, std::string_view str) const;
+
+  void SetNull(char *tuple, uint32_t col_idx, bool is_null) const;
+
+ private:
+  std::vector<Column> columns_;
+  std::vector<uint32_t> offsets_;
+  uint32_t tuple_size_;
+};
+
+}  // namespace redbase
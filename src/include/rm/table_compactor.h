@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+/** Knobs of a table compactor. */
+struct CompactionOptions {
+  /** A page whose live tuples take less than this fraction of the page is worth merging with its successor. */
+  double fill_threshold_{0.5};
+  /** I/O budget of the background task, in pages visited per second. 0 removes the throttle. */
+  size_t max_pages_per_second_{200};
+  /** How long the background task sleeps between two rounds. */
+  std::chrono::milliseconds interval_{1000};
+};
+
+/** Counters of a table compactor, cumulative since its creation. */
+struct CompactionStats {
+  /** Pages read or written while looking for merges. */
+  size_t pages_visited_{0};
+  /** Pages unlinked from the heap and handed back to the free-page map. */
+  size_t pages_freed_{0};
+  /** Tuples relocated, each left a forwarding RID behind. */
+  size_t tuples_moved_{0};
+  /** Rounds given up because a scan was open on the heap. */
+  size_t rounds_skipped_{0};
+};
+
+/**
+ * TableCompactor vacuums a table heap that deletes left sparse. It walks the page chain and merges an under-filled
+ * page with its successor whenever all the live tuples of both fit into one page: the destination page is compacted,
+ * the tuples of the successor are moved in (their old RIDs are forwarded by the heap), and the emptied page is unlinked.
+ * It returns to the free-page map of the buffer pool once no RID is forwarded from it anymore (see TableHeap). The
+ * last page of the heap takes the appends and is never touched.
+ *
+ * Compaction runs under the heap's compaction latch in exclusive mode, taken with try_lock: a round that finds a scan
+ * open on the heap is skipped rather than stalling foreground work. Rounds are also bounded by a page budget derived
+ * from max_pages_per_second_, so the background task cannot saturate the disk.
+ */
+class TableCompactor {
+ public:
+  explicit TableCompactor(TableHeap *heap, CompactionOptions options = {});
+
+  DISALLOW_COPY_AND_MOVE(TableCompactor);
+
+  /** Stops the background task if it is running. */
+  ~TableCompactor();
+
+  /** Start compacting in a background thread, one round every interval_. */
+  void Start();
+
+  /** Stop the background thread, waiting for the current round to finish. */
+  void Stop();
+
+  /**
+   * @brief Run one compaction round in the calling thread.
+   * @param page_budget max number of pages visited by the round
+   * @return the number of pages freed
+   */
+  auto CompactOnce(size_t page_budget = SIZE_MAX) -> size_t;
+
+  auto GetStats() const -> CompactionStats;
+
+ private:
+  /** Body of the background thread. */
+  void Run();
+
+  /** @return the number of pages a background round may visit */
+  auto GetRoundBudget() const -> size_t;
+
+  TableHeap *heap_;
+  CompactionOptions options_;
+
+  std::atomic<size_t> pages_visited_{0};
+  std::atomic<size_t> pages_freed_{0};
+  std::atomic<size_t> tuples_moved_{0};
+  std::atomic<size_t> rounds_skipped_{0};
+
+  /** Protects stop_, the background thread sleeps on cv_. */
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::optional<std::thread> background_thread_;
+};
+
+}  // namespace redbase
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "pf/table_page.h"
+#include "rm/table_scan_iterator.h"
+#include "rm/zone_map.h"
+
+namespace redbase {
+
+/**
+ * TableHeap is a heap file: a chain of TablePages linked through their next page ids. Tuples are appended to the
+ * last page of the chain. The heap also keeps an in-memory directory of its pages in chain order, which is what
+ * scans use to split the table into page ranges.
+ *
+ * A TableCompactor may merge sparse pages of the heap and move their tuples. The RIDs of moved tuples stay valid:
+ * the heap forwards them to the new location on every point access. The forwarding table lives in memory only.
+ * A page emptied by compaction is retired rather than freed while RIDs of its slots are forwarded, so that its id is
+ * not handed out again and the old RIDs cannot name tuples of a new page.
+ */
+class TableHeap {
+ public:
+  /**
+   * @brief Create a new, empty table heap with a single page.
+   * @param bpm the buffer pool the heap pages live in
+   */
+  explicit TableHeap(BufferPoolManager *bpm);
+
+  /**
+   * @brief Open an existing table heap, the page directory is rebuilt by walking the page chain.
+   * @param bpm the buffer pool the heap pages live in
+   * @param first_page_id first page of the chain
+   */
+  TableHeap(BufferPoolManager *bpm, page_id_t first_page_id);
+
+  /** Gives back the retired pages, their forwarded RIDs die with the heap. */
+  ~TableHeap();
+
+  /**
+   * @brief Append a tuple to the heap.
+   * @return the RID of the new tuple, or nullopt if the tuple can never fit into a page
+   */
+  auto InsertTuple(const TupleMeta &meta, const char *data, uint32_t size) -> std::optional<RID>;
+
+  /**
+   * @brief Update the metadata (e.g. the delete flag) of a tuple.
+   *
+   * The point accesses below take the compaction latch in shared mode, which a scan iterator of the heap already
+   * holds: a thread with a scan of the heap open must use the overloads taking that scan instead, so that it does not
+   * lock the latch twice. The pages of the last batch of the scan stay read latched, the updates must not target them.
+   */
+  void UpdateTupleMeta(const TupleMeta &meta, RID rid);
+
+  /** Update the metadata of a tuple under the hold of the compaction latch of an open scan of the heap. */
+  void UpdateTupleMeta(const TupleMeta &meta, RID rid, const TableScanIterator &scan);
+
+  /**
+   * @brief Overwrite a tuple with new bytes of the same size.
+   * @return false if the size differs from the stored tuple
+   */
+  auto UpdateTupleInPlace(RID rid, const char *data, uint32_t size) -> bool;
+
+  /** Overwrite a tuple under the hold of the compaction latch of an open scan of the heap. */
+  auto UpdateTupleInPlace(RID rid, const char *data, uint32_t size, const TableScanIterator &scan) -> bool;
+
+  /**
+   * @brief Keep a zone map up to date with every insert and update from now on. Tuples already in the heap are not
+   * summarized, see ZoneMap::Build().
+   */
+  void SetZoneMap(ZoneMap *zone_map) { zone_map_ = zone_map; }
+
+  auto GetZoneMap() const -> ZoneMap * { return zone_map_; }
+
+  /**
+   * @brief Copy a tuple out of the heap.
+   * @param[out] data the bytes of the tuple
+   * @return the metadata of the tuple
+   */
+  auto GetTuple(RID rid, std::vector<char> *data) -> TupleMeta;
+
+  /** Copy a tuple out of the heap under the hold of the compaction latch of an open scan of the heap. */
+  auto GetTuple(RID rid, std::vector<char> *data, const TableScanIterator &scan) -> TupleMeta;
+
+  /** @return the first page of the heap */
+  auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
+
+  /** @return the number of pages in the heap */
+  auto GetPageCount() -> size_t;
+
+  /** @return the ids of the pages in [begin, end) of the heap, by position in the chain */
+  auto GetPageIds(size_t begin, size_t end) -> std::vector<page_id_t>;
+
+  /** @return the RID a tuple lives at now, following the forwarding left behind by compaction */
+  auto ResolveRID(RID rid) -> RID;
+
+  /** @return an iterator over the whole heap */
+  auto MakeScanIterator(ScanOptions options = {}) -> TableScanIterator;
+
+  /** @return an iterator over the pages in [begin, end) of the heap */
+  auto MakeScanIterator(size_t begin, size_t end, ScanOptions options = {}) -> TableScanIterator;
+
+  /**
+   * @brief Split the heap into contiguous page ranges of (almost) equal size, one iterator per range, so that
+   * several threads can scan the table in parallel. Empty ranges are not returned.
+   */
+  auto MakePartitionedScan(size_t num_partitions, ScanOptions options = {}) -> std::vector<TableScanIterator>;
+
+ private:
+  friend class TableCompactor;
+
+  /**
+   * @brief Move every live tuple of `src_page_id` into `dest_page_id`, its predecessor in the chain, then unlink and
+   * delete the source page. Caller holds compaction_latch_ exclusively, the source page must not be the last one.
+   * @param[out] tuples_moved number of tuples relocated
+   * @return false if the live tuples of the source page do not fit into the destination page, nothing is changed
+   */
+  auto MergePages(page_id_t dest_page_id, page_id_t src_page_id, size_t *tuples_moved) -> bool;
+
+  /** @return the forwarded RID, caller holds forwarding_latch_ */
+  auto ResolveRIDLocked(RID rid) const -> RID;
+
+  /** The point accesses, caller holds compaction_latch_ in shared mode. */
+  void UpdateTupleMetaLocked(const TupleMeta &meta, RID rid);
+  auto UpdateTupleInPlaceLocked(RID rid, const char *data, uint32_t size) -> bool;
+  auto GetTupleLocked(RID rid, std::vector<char> *data) -> TupleMeta;
+
+  /** @throw Exception if `scan` does not hold the compaction latch of this heap */
+  void CheckScanHold(const TableScanIterator &scan) const;
+
+  /** Give a page that is no longer in the chain back to the buffer pool. */
+  void FreePage(page_id_t page_id);
+
+  BufferPoolManager *bpm_;
+  page_id_t first_page_id_{INVALID_PAGE_ID};
+
+  /** Protects the page directory and serializes appends to the last page. */
+  std::mutex latch_;
+  /** All pages of the heap in chain order, the last one takes the inserts. */
+  std::vector<page_id_t> page_ids_;
+
+  /**
+   * Held shared by scans and point accesses, exclusively by the compactor while it moves tuples around. Appends do
+   * not take it, they only touch the last page which is never compacted.
+   */
+  std::shared_mutex compaction_latch_;
+
+  /** Protects forwarding_ and retired_pages_. */
+  std::mutex forwarding_latch_;
+  /**
+   * Old RID -> current RID of every tuple moved by compaction. Targets are always final: when a page is merged, the
+   * entries pointing into it are retargeted, so that a lookup is a single probe.
+   */
+  std::map<RID, RID> forwarding_;
+  /**
+   * Pages unlinked by compaction -> number of forwarding_ entries from their slots. A page is freed when its count
+   * drops to zero, i.e. when every tuple moved out of it has been deleted and its page merged in turn.
+   */
+  std::unordered_map<page_id_t, size_t> retired_pages_;
+
+  /** Summaries maintained on insert/update, may be null. */
+  ZoneMap *zone_map_{nullptr};
+};
+
+}  // namespace redbase
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "pf/page_guard.h"
+#include "rm/dynamic_filter.h"
+#include "rm/tuple_filter.h"
+#include "rm/tuple_view.h"
+#include "rm/zone_map.h"
+
+namespace redbase {
+
+/** Knobs of a table scan. */
+struct ScanOptions {
+  /** Max number of tuples handed out per NextBatch() call. */
+  size_t batch_size_{SCAN_BATCH_SIZE};
+  /** Number of pages read ahead of the scan cursor through asynchronous prefetch, 0 disables read-ahead. */
+  size_t read_ahead_{SCAN_READ_AHEAD};
+  /** Summaries of the table, pages that cannot satisfy `ranges_` are skipped without being fetched. */
+  const ZoneMap *zone_map_{nullptr};
+  /** Conjunction of column ranges the caller is going to filter on. */
+  std::vector<ColumnRange> ranges_;
+  /** The layout of the tuples. With one, the tuples outside `ranges_` are dropped in their page, not handed out. */
+  const Schema *schema_{nullptr};
+  /** A range that narrows as the scan goes, checked against the zone map along with `ranges_`. */
+  const DynamicFilter *dynamic_filter_{nullptr};
+};
+
+/**
+ * TableScanIterator walks a range of table heap pages and hands out the live tuples in batches.
+ *
+ * Pages are fetched with AccessType::Scan so that the replacer recycles them before the hot set, and the next
+ * `read_ahead_` pages of the range are prefetched while the current one is being consumed. An iterator covers a
+ * fixed list of pages, so several iterators over disjoint ranges of the same heap (TableHeap::MakePartitionedScan())
+ * can run on different threads.
+ *
+ * With a zone map and ranges in the options, pages whose summaries rule out every tuple are neither fetched nor
+ * prefetched; the range of a dynamic filter is read again whenever it changes. Given the schema of the tuples too,
+ * the iterator checks `ranges_` on the bytes of every tuple of the pages it visits (see TupleFilter) and only hands
+ * out the tuples that satisfy them, so that the caller never copies the others; otherwise filtering is up to the
+ * caller. The range of the dynamic filter only ever skips pages.
+ *
+ * Iterators made by a TableHeap hold its compaction latch in shared mode for their whole lifetime, so that the pages
+ * they cover are not merged or freed under them (see TableCompactor). The iterators of a partitioned scan share one
+ * hold of the latch, released with the last of them.
+ */
+class TableScanIterator {
+ public:
+  TableScanIterator(BufferPoolManager *bpm, std::vector<page_id_t> page_ids, ScanOptions options = {},
+                    std::shared_ptr<std::shared_lock<std::shared_mutex>> heap_lock = nullptr);
+
+  DISALLOW_COPY(TableScanIterator);
+  TableScanIterator(TableScanIterator &&that) noexcept = default;
+  auto operator=(TableScanIterator &&that) noexcept -> TableScanIterator & = default;
+  ~TableScanIterator() = default;
+
+  /**
+   * @brief Fill `batch` with up to batch_size_ live tuples.
+   *
+   * The views point into pages that the iterator keeps pinned and read latched until the next call to NextBatch()
+   * (or until the iterator is destroyed), so the caller can work on them without copying.
+   *
+   * @param[out] batch the tuples of this batch, cleared first
+   * @return false once the scan is exhausted, in which case the batch is empty
+   */
+  auto NextBatch(std::vector<TupleView> *batch) -> bool;
+
+  /** @return the pages this iterator covers, in scan order */
+  auto GetPageIds() const -> const std::vector<page_id_t> & { return page_ids_; }
+
+  /** @return the number of pages skipped so far thanks to the zone map */
+  auto GetPagesSkipped() const -> size_t { return pages_skipped_; }
+
+  /** @return the number of live tuples of the pages visited so far that were outside `ranges_` */
+  auto GetTuplesFiltered() const -> size_t { return tuples_filtered_; }
+
+  /** @return true if the iterator holds `latch` in shared mode, i.e. it was made by the heap that owns the latch */
+  auto HoldsLatch(const std::shared_mutex &latch) const -> bool {
+    return heap_lock_ != nullptr && heap_lock_->owns_lock() && heap_lock_->mutex() == &latch;
+  }
+
+ private:
+  /** Issue prefetches for the pages following the cursor. */
+  void ReadAhead();
+
+  /** @return true if the zone map rules out the page at `index` */
+  auto CanSkip(size_t index) -> bool;
+
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  ScanOptions options_;
+
+  /** Index (into page_ids_) of the page being scanned. */
+  size_t cursor_{0};
+  /** Next slot to look at on the page being scanned. */
+  uint32_t slot_{0};
+  /** Index of the first page not prefetched yet. */
+  size_t prefetch_cursor_{0};
+  /** Keeps the heap from being compacted while the scan is open, released after the pages below. */
+  std::shared_ptr<std::shared_lock<std::shared_mutex>> heap_lock_;
+  /** Pages referenced by the last batch. */
+  std::vector<ReadPageGuard> pinned_;
+  size_t pages_skipped_{0};
+  /** Checks `ranges_` on the tuples, if the options have a schema. */
+  std::optional<TupleFilter> tuple_filter_;
+  size_t tuples_filtered_{0};
+  /** The ranges checked against the zone map: `ranges_` then the range of the dynamic filter, of this version. */
+  std::vector<ColumnRange> ranges_;
+  uint64_t dynamic_version_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rm/schema.h"
+#include "rm/tuple_view.h"
+#include "rm/zone_map.h"
+
+namespace redbase {
+
+/**
+ * TupleFilter evaluates a conjunction of column ranges on the bytes of a tuple, where it lies in its page, so that
+ * a scan can drop the tuples outside without copying or decoding them.
+ *
+ * Each range is turned once into closed bounds of the type of its column, an exclusive or fractional bound on an
+ * integer column becoming the nearest integer inside the range and a missing bound the limit of the type. Select()
+ * checks a batch of tuples one range at a time, two comparisons per tuple and no branch on their outcome.
+ */
+class TupleFilter {
+ public:
+  /** @param ranges on numeric columns of the schema */
+  TupleFilter(const Schema *schema, const std::vector<ColumnRange> &ranges);
+
+  /** @return true if the tuple satisfies every range */
+  auto Matches(const char *tuple) const -> bool;
+
+  /**
+   * @brief Keep the tuples that satisfy every range, in their order.
+   * @param[in,out] tuples compacted in place
+   * @return the number of tuples kept, at the front of `tuples`
+   */
+  auto Select(TupleView *tuples, size_t count) const -> size_t;
+
+ private:
+  /** A range with closed bounds, on a column stored as an int32_t, an int64_t or a double. */
+  struct Check {
+    uint32_t column_idx_;
+    uint32_t offset_;
+    TypeId type_;
+    bool include_nulls_;
+    int64_t integer_lower_;
+    int64_t integer_upper_;
+    double decimal_lower_;
+    double decimal_upper_;
+  };
+
+  const Schema *schema_;
+  std::vector<Check> checks_;
+};
+
+}  // namespace redbase
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/rid.h"
+
+namespace redbase {
+
+/**
+ * A reference to a tuple that lives on a pinned page. The view does not own the bytes, it is only valid while the
+ * page it points into stays pinned (see TableScanIterator::NextBatch()).
+ */
+struct TupleView {
+  /** Where the tuple lives. */
+  RID rid_;
+  /** Start of the tuple bytes inside the page. */
+  const char *data_;
+  /** Size of the tuple in bytes. */
+  uint32_t size_;
+};
+
+}  // namespace redbase
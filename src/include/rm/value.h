@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace redbase {
+
+/** Types a column can have. All of them are fixed width, CHAR(n) is padded with zeros. */
+enum class TypeId : uint8_t { INVALID = 0, INTEGER, BIGINT, DOUBLE, DATE, CHAR };
+
+/** @return the number of bytes a value of a numeric type takes in a tuple */
+inline auto TypeSize(TypeId type_id) -> uint32_t {
+  switch (type_id) {
+    case TypeId::INTEGER:
+    case TypeId::DATE:
+      return 4;
+    case TypeId::BIGINT:
+    case TypeId::DOUBLE:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/** @return true for the types a Value can hold */
+inline auto IsNumeric(TypeId type_id) -> bool { return type_id != TypeId::INVALID && type_id != TypeId::CHAR; }
+
+/**
+ * A single numeric value (INTEGER, BIGINT, DATE as days since epoch, DOUBLE) or a NULL of such a type. Integer
+ * types are widened to 64 bits, so values of different integer types compare directly.
+ */
+class Value {
+ public:
+  /** The default constructor creates an invalid NULL. */
+  Value() = default;
+
+  /** An integer-like value (INTEGER, BIGINT or DATE). */
+  Value(TypeId type_id, int64_t integer) : type_id_(type_id), is_null_(false) { value_.integer_ = integer; }
+
+  /** A DOUBLE value. */
+  explicit Value(double decimal) : type_id_(TypeId::DOUBLE), is_null_(false) { value_.decimal_ = decimal; }
+
+  static auto MakeNull(TypeId type_id) -> Value {
+    Value value;
+    value.type_id_ = type_id;
+    return value;
+  }
+
+  auto GetTypeId() const -> TypeId { return type_id_; }
+
+  auto IsNull() const -> bool { return is_null_; }
+
+  auto GetAsInteger() const -> int64_t {
+    return type_id_ == TypeId::DOUBLE ? static_cast<int64_t>(value_.decimal_) : value_.integer_;
+  }
+
+  auto GetAsDouble() const -> double {
+    return type_id_ == TypeId::DOUBLE ? value_.decimal_ : static_cast<double>(value_.integer_);
+  }
+
+  /**
+   * @brief Three-way comparison of two non-NULL values. Integers compare exactly, a DOUBLE on either side makes
+   * the comparison happen on doubles.
+   * @return <0, 0 or >0
+   */
+  auto CompareTo(const Value &other) const -> int {
+    if (type_id_ == TypeId::DOUBLE || other.type_id_ == TypeId::DOUBLE) {
+      double a = GetAsDouble();
+      double b = other.GetAsDouble();
+      return a < b ? -1 : (a > b ? 1 : 0);
+    }
+    return value_.integer_ < other.value_.integer_ ? -1 : (value_.integer_ > other.value_.integer_ ? 1 : 0);
+  }
+
+  auto ToString() const -> std::string {
+    if (is_null_) {
+      return "NULL";
+    }
+    return type_id_ == TypeId::DOUBLE ? std::to_string(value_.decimal_) : std::to_string(value_.integer_);
+  }
+
+ private:
+  TypeId type_id_{TypeId::INVALID};
+  bool is_null_{true};
+  union {
+    int64_t integer_;
+    double decimal_;
+  } value_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "rm/schema.h"
+
+namespace redbase {
+
+class TableHeap;
+
+/** A range predicate on one column, a missing bound is unbounded. NULLs only satisfy it if include_nulls_. */
+struct ColumnRange {
+  uint32_t column_idx_;
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+  bool include_nulls_{false};
+};
+
+/** Min/max/null-count summary of one column over a set of tuples. */
+struct ColumnZone {
+  /** Smallest and largest non-NULL value, only meaningful when value_count_ > 0. */
+  Value min_;
+  Value max_;
+  uint32_t null_count_{0};
+  uint32_t value_count_{0};
+
+  void Update(const Value &value);
+
+  void Merge(const ColumnZone &other);
+
+  /** @return false if no tuple summarized here can satisfy the range */
+  auto MayMatch(const ColumnRange &range) const -> bool;
+};
+
+/**
+ * ZoneMap keeps per-page min/max/null-count summaries of some numeric columns of a table heap, plus the same
+ * summaries per extent of PAGES_PER_EXTENT consecutive pages. Scans consult it to skip pages (or whole extents) that
+ * cannot hold a matching tuple without fetching them.
+ *
+ * Summaries are maintained incrementally: the heap reports every inserted or updated tuple, which can only widen
+ * the ranges. Deletes do not shrink them, so a summary is always a superset of the live values. The summaries are
+ * cached in memory and written to a chain of summary pages by Flush().
+ */
+class ZoneMap {
+ public:
+  static constexpr size_t PAGES_PER_EXTENT = 32;
+
+  /**
+   * @brief Create an empty zone map.
+   * @param column_idxs the numeric columns of the schema to summarize
+   */
+  ZoneMap(BufferPoolManager *bpm, const Schema *schema, std::vector<uint32_t> column_idxs);
+
+  /**
+   * @brief Load a zone map from the summary pages written by Flush().
+   */
+  ZoneMap(BufferPoolManager *bpm, const Schema *schema, std::vector<uint32_t> column_idxs,
+          page_id_t first_summary_page_id);
+
+  /** Summarize every tuple already in the heap. */
+  void Build(TableHeap *heap);
+
+  /** Widen the summaries of a page with a tuple inserted into it. */
+  void OnInsert(page_id_t page_id, const char *tuple);
+
+  /** Widen the summaries of a page with the new image of an updated tuple. */
+  void OnUpdate(page_id_t page_id, const char *tuple) { OnInsert(page_id, tuple); }
+
+  /**
+   * @brief Forget the tuples of a page the heap gave back, so that the page summarizes nothing if its id comes back.
+   * The extent summary cannot shrink and keeps covering the old values.
+   */
+  void OnPageFreed(page_id_t page_id);
+
+  /**
+   * @return false if no tuple of the page can satisfy all the ranges. Ranges on columns that are not summarized and
+   * pages the zone map does not know never prune anything.
+   */
+  auto MayMatch(page_id_t page_id, const std::vector<ColumnRange> &ranges) const -> bool;
+
+  /** @return the summary of a column on a page, nullopt if the page or column is not summarized */
+  auto GetPageZone(page_id_t page_id, uint32_t column_idx) const -> std::optional<ColumnZone>;
+
+  /** Write the summaries to the summary pages, allocating the chain on first use. */
+  void Flush();
+
+  /** @return the first summary page, INVALID_PAGE_ID before the first Flush() */
+  auto GetFirstSummaryPageId() const -> page_id_t;
+
+ private:
+  /** @return the ordinal of a page, registering it if needed. Caller holds the latch exclusively. */
+  auto GetOrAddOrdinal(page_id_t page_id) -> size_t;
+
+  /** @return the position of a schema column among the summarized ones */
+  auto GetSlot(uint32_t column_idx) const -> std::optional<size_t>;
+
+  BufferPoolManager *bpm_;
+  const Schema *schema_;
+  std::vector<uint32_t> column_idxs_;
+  page_id_t first_summary_page_id_{INVALID_PAGE_ID};
+
+  mutable std::shared_mutex latch_;
+  /** Pages in the order they were first seen, which is the heap chain order. */
+  std::vector<page_id_t> page_ids_;
+  std::unordered_map<page_id_t, size_t> ordinals_;
+  /** [ordinal][slot] */
+  std::vector<std::vector<ColumnZone>> page_zones_;
+  /** [ordinal / PAGES_PER_EXTENT][slot] */
+  std::vector<std::vector<ColumnZone>> extent_zones_;
+};
+
+}  // namespace redbase
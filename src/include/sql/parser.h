@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "execution/expression.h"
+#include "rm/value.h"
+
+namespace redbase {
+
+enum class ParsedKind { COLUMN, LITERAL, PARAMETER, COMPARISON, BETWEEN, IN_LIST, AND, ARITHMETIC };
+
+/** A node of the syntax tree of an expression, names not resolved yet. */
+struct ParsedExpression {
+  explicit ParsedExpression(ParsedKind kind) : kind_(kind) {}
+
+  ParsedKind kind_;
+  /** COLUMN: the column name. */
+  std::string name_;
+  /** LITERAL: the number. */
+  Value value_;
+  /** PARAMETER: its position among the `?` of the statement, from 0. */
+  uint32_t param_idx_{0};
+  ComparisonType comparison_type_{ComparisonType::EQUAL};
+  ArithmeticType arithmetic_type_{ArithmeticType::PLUS};
+  /**
+   * The operands: both sides of a comparison or an arithmetic, the value then the bounds (or the list) of a BETWEEN
+   * (or an IN), the conjuncts of an AND.
+   */
+  std::vector<ParsedExpression> children_;
+};
+
+/**
+ * `SELECT select_list FROM table [WHERE conjunction] [LIMIT n [OFFSET m]]`, where the select list is `*` or
+ * expressions, and the conjunction is made of comparisons, BETWEENs and INs. Expressions are numbers, columns,
+ * parameters (`?`) and `+`, `-`, `*` on them.
+ */
+struct SelectStatement {
+  /** Empty for `*`. */
+  std::vector<ParsedExpression> select_list_;
+  std::string table_;
+  std::optional<ParsedExpression> where_;
+  std::optional<int64_t> limit_;
+  int64_t offset_{0};
+  uint32_t param_count_{0};
+};
+
+/**
+ * @brief Parse a SELECT statement.
+ * @throw Exception on a syntax error
+ */
+auto ParseSelect(std::string_view sql) -> SelectStatement;
+
+/**
+ * @brief Put a statement in a canonical form: its tokens separated by one space, keywords in upper case. Statements
+ * that differ only in layout or in the case of their keywords normalize to the same text.
+ * @throw Exception on a character that starts no token
+ */
+auto NormalizeSql(std::string_view sql) -> std::string;
+
+}  // namespace redbase
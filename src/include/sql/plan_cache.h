@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "common/config.h"
+#include "sql/planner.h"
+
+namespace redbase {
+
+/**
+ * PlanCache keeps the plans of the most recently used statements, keyed by their normalized text (see
+ * NormalizeSql()), so that the sessions that run the same statement parse, bind and plan it once between them. It is
+ * thread safe; the plans it hands out are immutable and shared.
+ *
+ * A plan is only good for the version of the catalog it was planned against: a lookup under a newer version evicts
+ * it, so a change of the catalog or of the statistics invalidates the plans that predate it. Past `capacity` plans,
+ * the least recently used one is evicted.
+ */
+class PlanCache {
+ public:
+  explicit PlanCache(size_t capacity = PLAN_CACHE_SIZE) : capacity_(capacity) {}
+
+  /** @return the plan of a normalized statement planned against `catalog_version`, nullptr if there is none */
+  auto Lookup(const std::string &sql, uint64_t catalog_version) -> std::shared_ptr<const Plan>;
+
+  /** Cache the plan of a normalized statement, replacing the one there is. */
+  void Insert(const std::string &sql, std::shared_ptr<const Plan> plan);
+
+  auto GetSize() const -> size_t;
+
+  auto GetHits() const -> size_t { return hits_; }
+
+  auto GetMisses() const -> size_t { return misses_; }
+
+  /** @return the number of plans evicted because the catalog changed after they were planned */
+  auto GetInvalidations() const -> size_t { return invalidations_; }
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<const Plan>>;
+
+  size_t capacity_;
+  mutable std::mutex latch_;
+  /** Most recently used first. */
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  std::atomic<size_t> hits_{0};
+  std::atomic<size_t> misses_{0};
+  std::atomic<size_t> invalidations_{0};
+};
+
+}  // namespace redbase
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expression.h"
+#include "execution/operator.h"
+#include "sql/parser.h"
+
+namespace redbase {
+
+/**
+ * A ParsedExpression with its names resolved and its types known: columns are outputs of the scan of the plan, and
+ * parameters are left as slots, to be filled when the plan is instantiated.
+ */
+struct BoundExpression {
+  explicit BoundExpression(ParsedKind kind, TypeId type = TypeId::INVALID) : kind_(kind), type_(type) {}
+
+  ParsedKind kind_;
+  /** The type of the value computed, INVALID for predicates and for parameters. */
+  TypeId type_;
+  /** COLUMN: the output of the scan. */
+  uint32_t col_idx_{0};
+  Value value_;
+  uint32_t param_idx_{0};
+  ComparisonType comparison_type_{ComparisonType::EQUAL};
+  ArithmeticType arithmetic_type_{ArithmeticType::PLUS};
+  std::vector<BoundExpression> children_;
+};
+
+/**
+ * Plan is what is left of a SELECT statement once it has been parsed, bound against the catalog and planned: a scan
+ * of the columns of a table the statement uses, an optional filter, a projection and an optional limit. It refers to
+ * the parameters of the statement by position, so a plan serves every execution of the statement, whatever the
+ * values of its parameters; InstantiatePlan() turns it into a tree of operators for one execution.
+ *
+ * A plan is immutable, and is only valid for the version of the catalog it was planned against.
+ */
+struct Plan {
+  std::shared_ptr<const TableInfo> table_;
+  /** The columns of the table the scan reads. */
+  std::vector<uint32_t> scan_columns_;
+  std::optional<BoundExpression> predicate_;
+  std::vector<BoundExpression> projections_;
+  /** The projections are the columns of the scan in order, the plan needs no projection operator. */
+  bool scan_only_{false};
+  std::optional<size_t> limit_;
+  size_t offset_{0};
+  uint32_t param_count_{0};
+  uint64_t catalog_version_{0};
+};
+
+/**
+ * @brief Bind a statement against the catalog and plan it.
+ * @throw Exception on an unknown table or column, or on a column that is not numeric where a number is expected
+ */
+auto PlanSelect(const SelectStatement &statement, const Catalog &catalog) -> std::shared_ptr<const Plan>;
+
+/**
+ * @brief Build the operators of one execution of a plan. They keep the plan alive.
+ * @param params the values of the parameters, in the order of the `?` of the statement
+ * @throw Exception if a parameter is missing or NULL
+ */
+auto InstantiatePlan(std::shared_ptr<const Plan> plan, ExecutorContext *ctx, const std::vector<Value> &params)
+    -> std::unique_ptr<Operator>;
+
+}  // namespace redbase
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/operator.h"
+#include "sql/plan_cache.h"
+#include "sql/planner.h"
+
+namespace redbase {
+
+class Session;
+
+/**
+ * PreparedStatement is a statement parsed, bound and planned once, to be executed any number of times with
+ * different parameters. Before each execution it checks that its plan still matches the catalog, and plans the
+ * statement again (through the plan cache of the session, if any) when the catalog or the statistics changed.
+ */
+class PreparedStatement {
+ public:
+  /**
+   * @brief Build the operators of an execution of the statement, ready to be initialized.
+   * @param params the values of the `?` of the statement, in order
+   * @throw Exception if the statement no longer binds, or on wrong parameters
+   */
+  auto Execute(const std::vector<Value> &params = {}) -> std::unique_ptr<Operator>;
+
+  auto GetParameterCount() const -> uint32_t { return plan_->param_count_; }
+
+  /** @return the normalized text of the statement */
+  auto GetSql() const -> const std::string & { return sql_; }
+
+ private:
+  friend class Session;
+
+  PreparedStatement(Session *session, std::string sql, std::shared_ptr<const Plan> plan)
+      : session_(session), sql_(std::move(sql)), plan_(std::move(plan)) {}
+
+  Session *session_;
+  std::string sql_;
+  std::shared_ptr<const Plan> plan_;
+};
+
+/**
+ * Session is what a client runs its statements through: it turns SQL text into plans against a catalog, and plans
+ * into operators that run in its executor context. Sessions of different threads can share a PlanCache, the plans a
+ * statement gets are then planned once for all of them.
+ */
+class Session {
+ public:
+  /** @param cache shared plan cache, nullptr to plan every statement prepared or executed */
+  Session(Catalog *catalog, ExecutorContext *ctx, PlanCache *cache = nullptr)
+      : catalog_(catalog), ctx_(ctx), cache_(cache) {}
+
+  /**
+   * @brief Parse, bind and plan a statement for later executions.
+   * @throw Exception on a syntax error or if the statement does not bind
+   */
+  auto Prepare(std::string_view sql) -> PreparedStatement;
+
+  /** Prepare a statement and execute it once, see PreparedStatement::Execute(). */
+  auto Execute(std::string_view sql, const std::vector<Value> &params = {}) -> std::unique_ptr<Operator>;
+
+ private:
+  friend class PreparedStatement;
+
+  /** @return the plan of a normalized statement, from the cache if it holds a plan for the current catalog */
+  auto GetPlan(const std::string &sql) -> std::shared_ptr<const Plan>;
+
+  Catalog *catalog_;
+  ExecutorContext *ctx_;
+  PlanCache *cache_;
+};
+
+}  // namespace redbase
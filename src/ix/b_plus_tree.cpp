@@ -0,0 +1,813 @@
+#include "ix/b_plus_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "ix/covering_value.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *bpm, const KeyComparator &comparator,
+                          int leaf_max_size, int internal_max_size)
+    : BPlusTree(std::move(name), INVALID_PAGE_ID, bpm, comparator, leaf_max_size, internal_max_size) {
+  auto guard = bpm_->NewPageGuarded(&header_page_id_);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot create index {}: no free frame in the buffer pool", index_name_));
+  }
+  guard.AsMut<BPlusTreeHeaderPage>()->root_page_id_ = INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *bpm,
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+    : index_name_(std::move(name)),
+      bpm_(bpm),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size),
+      header_page_id_(header_page_id) {
+  if (leaf_max_size_ < 2 || leaf_max_size_ > LeafPage::SLOT_CNT - 1) {
+    throw Exception(fmt::format("leaf max size {} out of range [2, {}]", leaf_max_size_, LeafPage::SLOT_CNT - 1));
+  }
+  if (internal_max_size_ < 3 || internal_max_size_ > InternalPage::SLOT_CNT - 1) {
+    throw Exception(
+        fmt::format("internal max size {} out of range [3, {}]", internal_max_size_, InternalPage::SLOT_CNT - 1));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return GetRootPageId() == INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetRootPageId() const -> page_id_t {
+  auto guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  return guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryFindLeafOptimistic(const KeyType *key, BasicPageGuard *leaf, uint64_t *leaf_version,
+                                           const LeafParentVisitor &visit_parent) const -> bool {
+  BasicPageGuard parent = bpm_->FetchPageBasic(header_page_id_, AccessType::Index);
+  if (!parent.IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  uint64_t parent_version = parent.GetVersion();
+  if (Page::IsWriteLocked(parent_version)) {
+    return false;
+  }
+  page_id_t page_id = parent.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (!parent.ValidateVersion(parent_version)) {
+    return false;
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    leaf->Drop();
+    return true;
+  }
+
+  while (true) {
+    // the page id was read from a validated parent, but the page may have been freed since: the fetch can fail
+    BasicPageGuard node = bpm_->FetchPageBasic(page_id, AccessType::Index);
+    if (!node.IsValid()) {
+      return false;
+    }
+    uint64_t version = node.GetVersion();
+    // the parent did not move since it pointed at this page, so the page still is its child
+    if (Page::IsWriteLocked(version) || !parent.ValidateVersion(parent_version)) {
+      return false;
+    }
+    if (visit_parent && parent.PageId() != header_page_id_ && node.As<BPlusTreePage>()->IsLeafPage()) {
+      visit_parent(parent.As<InternalPage>());
+    }
+    parent = std::move(node);
+    parent_version = version;
+
+    bool is_leaf = parent.As<BPlusTreePage>()->IsLeafPage();
+    if (!is_leaf) {
+      auto internal = parent.As<InternalPage>();
+      page_id = key == nullptr ? internal->ValueAt(0) : internal->Lookup(*key, comparator_);
+    }
+    if (!parent.ValidateVersion(parent_version)) {
+      return false;
+    }
+    if (is_leaf) {
+      *leaf = std::move(parent);
+      *leaf_version = parent_version;
+      return true;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType *key, const LeafParentVisitor &visit_parent) const -> ReadPageGuard {
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_RESTARTS; attempt++) {
+    BasicPageGuard leaf;
+    uint64_t version;
+    if (!TryFindLeafOptimistic(key, &leaf, &version, visit_parent)) {
+      continue;
+    }
+    if (!leaf.IsValid()) {
+      return {};
+    }
+    ReadPageGuard guard = leaf.UpgradeRead();
+    if (guard.ValidateVersion(version)) {
+      return guard;
+    }
+  }
+  return FindLeafReadPessimistic(key, visit_parent);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafReadPessimistic(const KeyType *key, const LeafParentVisitor &visit_parent) const
+    -> ReadPageGuard {
+  auto header_guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
+  if (!header_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  page_id_t page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return {};
+  }
+
+  auto guard = bpm_->FetchPageRead(page_id, AccessType::Index);
+  header_guard.Drop();
+  while (true) {
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("index {}: page {} cannot be fetched", index_name_, page_id));
+    }
+    if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+      return guard;
+    }
+    auto internal = guard.As<InternalPage>();
+    page_id = key == nullptr ? internal->ValueAt(0) : internal->Lookup(*key, comparator_);
+    // the child is latched before the parent is released
+    auto child_guard = bpm_->FetchPageRead(page_id, AccessType::Index);
+    if (visit_parent && child_guard.IsValid() && child_guard.As<BPlusTreePage>()->IsLeafPage()) {
+      visit_parent(internal);
+    }
+    guard = std::move(child_guard);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) const -> bool {
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(HashIndexKey(key, comparator_))) {
+    return false;
+  }
+  ReadPageGuard guard = FindLeafRead(&key);
+  ValueType value;
+  if (!guard.IsValid() || !guard.As<LeafPage>()->Lookup(key, &value, comparator_)) {
+    if (bloom_filter_ != nullptr) {
+      bloom_filter_->RecordFalsePositive();
+    }
+    return false;
+  }
+  result->push_back(value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::optional<ValueType>> *results) const
+    -> size_t {
+  results->assign(keys.size(), std::nullopt);
+  std::vector<size_t> order;
+  order.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (bloom_filter_ == nullptr || bloom_filter_->MayContain(HashIndexKey(keys[i], comparator_))) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t lhs, size_t rhs) { return comparator_(keys[lhs], keys[rhs]) < 0; });
+
+  size_t next = 0;
+  // the leaf each key was routed to by the parent of a leaf seen by a descent, a hint that may be stale
+  std::vector<page_id_t> hints(order.size(), INVALID_PAGE_ID);
+  // keys before it have a hint, and their leaves were prefetched
+  size_t routed = 0;
+  // read in the leaves of the keys after `next`, SCAN_READ_AHEAD of them past the leaf of `next` at most
+  auto prefetch = [&](const InternalPage *parent) {
+    size_t i = std::max(routed, next + 1);
+    int last_child = parent->LookupIndex(keys[order[i - 1]], comparator_);
+    for (size_t issued = 0; i < order.size() && issued < SCAN_READ_AHEAD; i++) {
+      int child = parent->LookupIndex(keys[order[i]], comparator_);
+      if (child == parent->GetSize() - 1) {
+        break;  // the last child, which may not hold the key: leave it to the parent of the next leaf
+      }
+      hints[i] = parent->ValueAt(child);
+      if (child > last_child) {
+        bpm_->PrefetchPage(hints[i], AccessType::Index);
+        last_child = child;
+        issued++;
+      }
+    }
+    routed = i;
+  };
+
+  size_t found = 0;
+  ReadPageGuard guard;
+  // true while the leaf was reached by a descent for the current key, which it then covers
+  bool descended = false;
+  while (next < order.size()) {
+    const KeyType &key = keys[order[next]];
+    if (!guard.IsValid()) {
+      guard = FindLeafRead(&key, prefetch);
+      if (!guard.IsValid()) {
+        break;  // empty tree
+      }
+      descended = true;
+    }
+    auto leaf = guard.As<LeafPage>();
+    int size = leaf->GetSize();
+    // a key up to the last one of the leaf lies in it, since the previous key did. Only a descent can tell where a
+    // key goes once a remove has emptied the leaf.
+    if (!descended && size == 0) {
+      guard.Drop();
+      continue;
+    }
+    if (!descended && comparator_(key, leaf->KeyAt(size - 1)) > 0) {
+      page_id_t next_page_id = leaf->GetNextPageId();
+      if (next_page_id == INVALID_PAGE_ID) {
+        break;  // past the largest key of the tree
+      }
+      if (hints[next] != next_page_id) {
+        guard.Drop();
+        continue;  // further away than the right sibling, descend again
+      }
+      // latch coupling: the sibling is latched before the leaf is released, left to right like the range iterators
+      // and the merges do, so the sibling cannot be merged away or freed in between
+      auto next_guard = bpm_->FetchPageRead(next_page_id, AccessType::Index);
+      guard.Drop();
+      if (!next_guard.IsValid()) {
+        throw Exception(fmt::format("index {}: page {} cannot be fetched", index_name_, next_page_id));
+      }
+      auto next_leaf = next_guard.As<LeafPage>();
+      int next_size = next_leaf->GetSize();
+      if (next_size == 0 || comparator_(key, next_leaf->KeyAt(next_size - 1)) > 0) {
+        continue;  // the sibling was emptied by a remove, or the key lies past it: descend again
+      }
+      guard = std::move(next_guard);
+      continue;
+    }
+
+    ValueType value;
+    if (leaf->Lookup(key, &value, comparator_)) {
+      (*results)[order[next]] = value;
+      found++;
+    } else if (bloom_filter_ != nullptr) {
+      bloom_filter_->RecordFalsePositive();
+    }
+    next++;
+    descended = false;
+  }
+  if (bloom_filter_ != nullptr) {
+    for (size_t i = next; i < order.size(); i++) {
+      bloom_filter_->RecordFalsePositive();
+    }
+  }
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewNode(page_id_t *page_id) -> WritePageGuard {
+  auto guard = bpm_->NewPageGuarded(page_id, AccessType::Index);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("index {}: no free frame in the buffer pool for a new node", index_name_));
+  }
+  return guard.UpgradeWrite();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename IsSafe>
+auto BPLUSTREE_TYPE::FindLeafWriteOptimistic(const KeyType &key, IsSafe is_safe) -> WritePageGuard {
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_RESTARTS; attempt++) {
+    BasicPageGuard leaf;
+    uint64_t version;
+    if (!TryFindLeafOptimistic(&key, &leaf, &version)) {
+      continue;
+    }
+    if (!leaf.IsValid()) {
+      return {};
+    }
+    WritePageGuard guard = leaf.UpgradeWrite();
+    // taking the write latch moved the version once
+    if (!guard.ValidateVersion(version + 1)) {
+      continue;
+    }
+    if (!is_safe(guard.As<LeafPage>())) {
+      return {};
+    }
+    return guard;
+  }
+  return {};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  // before the key becomes visible, so that a lookup finding it in the tree also passes the filter
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(HashIndexKey(key, comparator_));
+  }
+  WritePageGuard guard = FindLeafWriteOptimistic(key, [](const LeafPage *leaf) { return leaf->IsInsertSafe(); });
+  if (guard.IsValid()) {
+    return guard.AsMut<LeafPage>()->Insert(key, value, comparator_);
+  }
+  return InsertPessimistic(key, value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertPessimistic(const KeyType &key, const ValueType &value) -> bool {
+  Context ctx;
+  ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
+  if (!ctx.header_page_->IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  auto header = ctx.header_page_->AsMut<BPlusTreeHeaderPage>();
+  if (header->root_page_id_ == INVALID_PAGE_ID) {
+    page_id_t root_page_id;
+    WritePageGuard root_guard = NewNode(&root_page_id);
+    auto root = root_guard.AsMut<LeafPage>();
+    root->Init(leaf_max_size_);
+    root->Insert(key, value, comparator_);
+    header->root_page_id_ = root_page_id;
+    return true;
+  }
+
+  ctx.root_page_id_ = header->root_page_id_;
+  page_id_t page_id = ctx.root_page_id_;
+  while (true) {
+    auto guard = bpm_->FetchPageWrite(page_id, AccessType::Index);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("index {}: page {} cannot be fetched", index_name_, page_id));
+    }
+    auto node = guard.As<BPlusTreePage>();
+    bool is_leaf = node->IsLeafPage();
+    bool is_safe = node->IsInsertSafe();
+    if (!is_leaf) {
+      page_id = guard.As<InternalPage>()->Lookup(key, comparator_);
+    }
+    ctx.write_set_.push_back(std::move(guard));
+    if (is_safe) {
+      ctx.ReleaseAncestors();
+    }
+    if (is_leaf) {
+      break;
+    }
+  }
+
+  auto &leaf_guard = ctx.write_set_.back();
+  auto leaf = leaf_guard.AsMut<LeafPage>();
+  if (!leaf->Insert(key, value, comparator_)) {
+    return false;
+  }
+  if (leaf->GetSize() <= leaf->GetMaxSize()) {
+    return true;
+  }
+
+  page_id_t new_page_id;
+  WritePageGuard new_guard = NewNode(&new_page_id);
+  auto new_leaf = new_guard.AsMut<LeafPage>();
+  new_leaf->Init(leaf_max_size_);
+  leaf->MoveHalfTo(new_leaf);
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  leaf->SetNextPageId(new_page_id);
+  KeyType separator = new_leaf->KeyAt(0);
+  new_guard.Drop();
+  InsertIntoParent(&ctx, leaf_guard.PageId(), separator, new_page_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(Context *ctx, page_id_t old_page_id, const KeyType &key,
+                                      page_id_t new_page_id) {
+  ctx->write_set_.pop_back();
+  if (ctx->write_set_.empty()) {
+    // the root split, an unsafe root keeps the header latched
+    REDBASE_ASSERT(ctx->header_page_.has_value() && ctx->IsRootPage(old_page_id), "root split without header latch");
+    page_id_t root_page_id;
+    WritePageGuard root_guard = NewNode(&root_page_id);
+    auto root = root_guard.AsMut<InternalPage>();
+    root->Init(internal_max_size_);
+    root->PopulateNewRoot(old_page_id, key, new_page_id);
+    ctx->header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = root_page_id;
+    return;
+  }
+
+  auto &parent_guard = ctx->write_set_.back();
+  auto parent = parent_guard.AsMut<InternalPage>();
+  parent->InsertAfter(parent->ValueIndex(old_page_id), key, new_page_id);
+  if (parent->GetSize() <= parent->GetMaxSize()) {
+    return;
+  }
+
+  page_id_t sibling_page_id;
+  WritePageGuard sibling_guard = NewNode(&sibling_page_id);
+  auto sibling = sibling_guard.AsMut<InternalPage>();
+  sibling->Init(internal_max_size_);
+  KeyType separator = parent->MoveHalfTo(sibling);
+  sibling_guard.Drop();
+  InsertIntoParent(ctx, parent_guard.PageId(), separator, sibling_page_id);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Remove(const KeyType &key) -> bool {
+  // the leaf may have become the root behind the descent's back, but a leaf above the min size is safe either way
+  WritePageGuard guard = FindLeafWriteOptimistic(key, [](const LeafPage *leaf) { return leaf->IsRemoveSafe(false); });
+  if (guard.IsValid()) {
+    return guard.AsMut<LeafPage>()->Remove(key, comparator_);
+  }
+  return RemovePessimistic(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemovePessimistic(const KeyType &key) -> bool {
+  Context ctx;
+  ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
+  if (!ctx.header_page_->IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  ctx.root_page_id_ = ctx.header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (ctx.root_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  page_id_t page_id = ctx.root_page_id_;
+  while (true) {
+    auto guard = bpm_->FetchPageWrite(page_id, AccessType::Index);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("index {}: page {} cannot be fetched", index_name_, page_id));
+    }
+    auto node = guard.As<BPlusTreePage>();
+    bool is_leaf = node->IsLeafPage();
+    bool is_safe = node->IsRemoveSafe(ctx.IsRootPage(page_id));
+    if (!is_leaf) {
+      page_id = guard.As<InternalPage>()->Lookup(key, comparator_);
+    }
+    ctx.write_set_.push_back(std::move(guard));
+    if (is_safe) {
+      ctx.ReleaseAncestors();
+    }
+    if (is_leaf) {
+      break;
+    }
+  }
+
+  if (!ctx.write_set_.back().AsMut<LeafPage>()->Remove(key, comparator_)) {
+    return false;
+  }
+  HandleUnderflow(&ctx);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreeNode(page_id_t page_id) {
+  // optimistic descents pin pages without latching them and let go as soon as they fail validation, which they will
+  // since the parent of the node was just modified. A range iterator may hold on longer, then the page is left alone
+  // (and leaked) rather than freed under it.
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_RESTARTS; attempt++) {
+    if (bpm_->DeletePage(page_id)) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::HandleUnderflow(Context *ctx) {
+  auto &guard = ctx->write_set_.back();
+  page_id_t page_id = guard.PageId();
+  auto node = guard.As<BPlusTreePage>();
+
+  if (ctx->IsRootPage(page_id)) {
+    // an empty root leaf empties the tree, a root with a single child hands the root over to that child
+    bool is_leaf = node->IsLeafPage();
+    if ((is_leaf && node->GetSize() > 0) || (!is_leaf && node->GetSize() > 1)) {
+      return;
+    }
+    REDBASE_ASSERT(ctx->header_page_.has_value(), "root shrink without header latch");
+    page_id_t new_root_page_id = is_leaf ? INVALID_PAGE_ID : guard.As<InternalPage>()->ValueAt(0);
+    ctx->header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = new_root_page_id;
+    ctx->write_set_.pop_back();
+    FreeNode(page_id);
+    return;
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return;
+  }
+
+  // an underflowing node was not safe, so its parent is still latched
+  auto &parent_guard = ctx->write_set_[ctx->write_set_.size() - 2];
+  auto parent = parent_guard.AsMut<InternalPage>();
+  int index = parent->ValueIndex(page_id);
+  // merge with a sibling, or else borrow from it. Prefix-compressed nodes may have room for neither, since taking
+  // entries widens the key range of a node and may shorten its prefix: the node then stays below its min size, and a
+  // parent may even be left with a single child.
+  if (parent->GetSize() < 2) {
+    return;
+  }
+
+  if (node->IsLeafPage()) {
+    // leaves are latched left to right like the iterators do: to reach its left sibling, let go of the node, then latch
+    // the sibling and the node again. The parent latch keeps every other writer away from both in between.
+    WritePageGuard leaf_guard = std::move(guard);
+    ctx->write_set_.pop_back();
+    if (index > 0) {
+      page_id_t left_page_id = parent->ValueAt(index - 1);
+      leaf_guard.Drop();
+      auto left_guard = bpm_->FetchPageWrite(left_page_id, AccessType::Index);
+      leaf_guard = bpm_->FetchPageWrite(page_id, AccessType::Index);
+      if (!leaf_guard.IsValid()) {
+        throw Exception(fmt::format("index {}: page {} cannot be fetched", index_name_, page_id));
+      }
+      if (left_guard.IsValid()) {
+        auto left = left_guard.AsMut<LeafPage>();
+        auto leaf = leaf_guard.AsMut<LeafPage>();
+        if (left->CanMergeRight(leaf)) {
+          leaf->MoveAllTo(left);
+          parent->Remove(index);
+          leaf_guard.Drop();
+          left_guard.Drop();
+          FreeNode(page_id);
+          HandleUnderflow(ctx);
+        } else if (leaf->CanBorrowLast(left)) {
+          left->MoveLastToFrontOf(leaf);
+          parent->SetKeyAt(index, leaf->KeyAt(0));
+        }
+        return;
+      }
+      // no frame for the left sibling, the right one may do
+    }
+    // the key is removed either way: without a sibling to latch, the leaf stays under its min size
+    if (index + 1 >= parent->GetSize()) {
+      return;
+    }
+    page_id_t right_page_id = parent->ValueAt(index + 1);
+    auto right_guard = bpm_->FetchPageWrite(right_page_id, AccessType::Index);
+    if (!right_guard.IsValid()) {
+      return;
+    }
+    auto leaf = leaf_guard.AsMut<LeafPage>();
+    auto right = right_guard.AsMut<LeafPage>();
+    if (leaf->CanMergeRight(right)) {
+      right->MoveAllTo(leaf);
+      parent->Remove(index + 1);
+      right_guard.Drop();
+      leaf_guard.Drop();
+      FreeNode(right_page_id);
+      HandleUnderflow(ctx);
+    } else if (leaf->CanBorrowFirst(right)) {
+      right->MoveFirstToEndOf(leaf);
+      parent->SetKeyAt(index + 1, right->KeyAt(0));
+    }
+    return;
+  }
+
+  auto internal = guard.AsMut<InternalPage>();
+  if (index > 0) {
+    page_id_t left_page_id = parent->ValueAt(index - 1);
+    auto left_guard = bpm_->FetchPageWrite(left_page_id, AccessType::Index);
+    if (left_guard.IsValid()) {
+      auto left = left_guard.AsMut<InternalPage>();
+      if (left->CanMergeRight(internal)) {
+        internal->MoveAllTo(left, parent->KeyAt(index));
+        parent->Remove(index);
+        left_guard.Drop();
+        ctx->write_set_.pop_back();
+        FreeNode(page_id);
+        HandleUnderflow(ctx);
+      } else if (internal->CanBorrowLast(left)) {
+        parent->SetKeyAt(index, left->MoveLastToFrontOf(internal, parent->KeyAt(index)));
+      }
+      return;
+    }
+    // no frame for the left sibling, the right one may do
+  }
+  if (index + 1 >= parent->GetSize()) {
+    return;
+  }
+  page_id_t right_page_id = parent->ValueAt(index + 1);
+  auto right_guard = bpm_->FetchPageWrite(right_page_id, AccessType::Index);
+  if (!right_guard.IsValid()) {
+    return;
+  }
+  auto right = right_guard.AsMut<InternalPage>();
+  if (internal->CanMergeRight(right)) {
+    right->MoveAllTo(internal, parent->KeyAt(index + 1));
+    parent->Remove(index + 1);
+    right_guard.Drop();
+    ctx->write_set_.pop_back();
+    FreeNode(right_page_id);
+    HandleUnderflow(ctx);
+  } else if (internal->CanBorrowFirst(right)) {
+    parent->SetKeyAt(index + 1, right->MoveFirstToEndOf(internal, parent->KeyAt(index + 1)));
+  }
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLevelWidth(size_t num_items, int max_size, int min_size, double fill_factor) -> size_t {
+  auto target =
+      static_cast<size_t>(std::clamp(static_cast<int>(std::lround(max_size * fill_factor)), min_size, max_size));
+  size_t width = (num_items + target - 1) / target;
+  // spreading the entries evenly may leave every node under its min size, use fewer, fuller nodes then
+  if (width > 1 && num_items / width < static_cast<size_t>(min_size)) {
+    width = std::max<size_t>(1, num_items / min_size);
+  }
+  while ((num_items + width - 1) / width > static_cast<size_t>(max_size)) {
+    width++;
+  }
+  return width;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FlushNode(WritePageGuard *guard) {
+  page_id_t page_id = guard->PageId();
+  guard->Drop();
+  bpm_->FlushPage(page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoad(size_t num_entries, const std::function<bool(KeyType *, ValueType *)> &next,
+                              double fill_factor) {
+  if (!(fill_factor > 0 && fill_factor <= 1)) {
+    throw Exception(fmt::format("index {}: fill factor {} out of range (0, 1]", index_name_, fill_factor));
+  }
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
+  if (!header_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  auto header = header_guard.AsMut<BPlusTreeHeaderPage>();
+  if (header->root_page_id_ != INVALID_PAGE_ID) {
+    throw Exception(fmt::format("index {}: bulk load into a non-empty tree", index_name_));
+  }
+  if (num_entries == 0) {
+    return;
+  }
+
+  // the first key and the page of every node of the level built last
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  // prefix-compressed nodes only learn their key range, hence their capacity, once filled: size them without prefix
+  int leaf_max_size = LeafPage::InitialMaxSize(leaf_max_size_);
+  size_t num_leaves = BulkLevelWidth(num_entries, leaf_max_size, leaf_max_size / 2, fill_factor);
+  WritePageGuard prev_guard;
+  KeyType key{};
+  KeyType last_key{};
+  ValueType value{};
+  for (size_t i = 0; i < num_leaves; i++) {
+    page_id_t page_id;
+    WritePageGuard guard = NewNode(&page_id);
+    auto leaf = guard.AsMut<LeafPage>();
+    leaf->Init(leaf_max_size_);
+    level.emplace_back(KeyType{}, page_id);
+
+    size_t size = num_entries / num_leaves + (i < num_entries % num_leaves ? 1 : 0);
+    for (size_t j = 0; j < size; j++) {
+      std::string error;
+      if (!next(&key, &value)) {
+        error = fmt::format("input ran out before {} entries", num_entries);
+      } else if ((i > 0 || j > 0) && comparator_(last_key, key) >= 0) {
+        error = "input is not in strictly increasing key order";
+      }
+      if (!error.empty()) {
+        // nothing links to the leaves built so far, hand them back
+        guard.Drop();
+        prev_guard.Drop();
+        for (const auto &[first_key, leaf_page_id] : level) {
+          bpm_->DeletePage(leaf_page_id);
+        }
+        throw Exception(fmt::format("index {}: bulk load failed, {}", index_name_, error));
+      }
+      // keys come in increasing order, so this appends
+      leaf->Insert(key, value, comparator_);
+      if (bloom_filter_ != nullptr) {
+        bloom_filter_->Insert(HashIndexKey(key, comparator_));
+      }
+      last_key = key;
+    }
+    level.back().first = leaf->KeyAt(0);
+    if (prev_guard.IsValid()) {
+      // the first keys of the leaves are the separators above them, hence their fences
+      auto prev = prev_guard.AsMut<LeafPage>();
+      prev->SetNextPageId(page_id);
+      prev->SetKeyRange(i > 1 ? &level[i - 1].first : nullptr, &level[i].first);
+      FlushNode(&prev_guard);
+    }
+    prev_guard = std::move(guard);
+  }
+  prev_guard.AsMut<LeafPage>()->SetKeyRange(num_leaves > 1 ? &level.back().first : nullptr, nullptr);
+  FlushNode(&prev_guard);
+
+  while (level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    int internal_max_size = InternalPage::InitialMaxSize(internal_max_size_);
+    size_t width = BulkLevelWidth(level.size(), internal_max_size, (internal_max_size + 1) / 2, fill_factor);
+    size_t child = 0;
+    for (size_t i = 0; i < width; i++) {
+      page_id_t page_id;
+      WritePageGuard guard = NewNode(&page_id);
+      auto node = guard.AsMut<InternalPage>();
+      node->Init(internal_max_size_);
+      size_t size = level.size() / width + (i < level.size() % width ? 1 : 0);
+      node->SetValueAt(0, level[child].second);
+      node->SetSize(1);
+      for (size_t j = 1; j < size; j++) {
+        node->InsertAfter(static_cast<int>(j) - 1, level[child + j].first, level[child + j].second);
+      }
+      node->SetKeyRange(child > 0 ? &level[child].first : nullptr,
+                        child + size < level.size() ? &level[child + size].first : nullptr);
+      // the first key of the subtree separates it from its left neighbour one level up
+      parents.emplace_back(level[child].first, page_id);
+      child += size;
+      FlushNode(&guard);
+    }
+    level = std::move(parents);
+  }
+  header->root_page_id_ = level[0].second;
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin() const -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard = FindLeafRead(nullptr);
+  if (!guard.IsValid()) {
+    return End();
+  }
+  return {bpm_, std::move(guard), 0};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) const -> INDEXITERATOR_TYPE {
+  ReadPageGuard guard = FindLeafRead(&key);
+  if (!guard.IsValid()) {
+    return End();
+  }
+  int index = guard.As<LeafPage>()->KeyIndex(key, comparator_);
+  return {bpm_, std::move(guard), index};
+}
+
+template class BPlusTree<int32_t, RID, IntegerComparator<int32_t>>;
+template class BPlusTree<int64_t, RID, IntegerComparator<int64_t>>;
+template class BPlusTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<NonUniqueKey<GenericKey<8>>, RID, NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<16>>, RID,
+                         NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<32>>, RID,
+                         NonUniqueComparator<GenericKey<32>, GenericComparator<32>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<64>>, RID,
+                         NonUniqueComparator<GenericKey<64>, GenericComparator<64>>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTree<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+
+template class BPlusTree<GenericKey<8>, CoveringValue<16>, GenericComparator<8>>;
+template class BPlusTree<GenericKey<8>, CoveringValue<32>, GenericComparator<8>>;
+template class BPlusTree<GenericKey<8>, CoveringValue<64>, GenericComparator<8>>;
+template class BPlusTree<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+template class BPlusTree<GenericKey<16>, CoveringValue<32>, GenericComparator<16>>;
+template class BPlusTree<GenericKey<16>, CoveringValue<64>, GenericComparator<16>>;
+template class BPlusTree<NonUniqueKey<GenericKey<8>>, CoveringValue<16>,
+                         NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<8>>, CoveringValue<32>,
+                         NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<8>>, CoveringValue<64>,
+                         NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<16>>, CoveringValue<16>,
+                         NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<16>>, CoveringValue<32>,
+                         NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTree<NonUniqueKey<GenericKey<16>>, CoveringValue<64>,
+                         NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+
+}  // namespace redbase
@@ -0,0 +1,239 @@
+#include "ix/b_plus_tree_internal_page.h"
+
+#include <algorithm>
+
+#include "common/rid.h"
+#include "ix/generic_key.h"
+#include "ix/node_search.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) {
+  static_assert(sizeof(BPlusTreeInternalPage) <= PAGE_SIZE, "an internal node must fit into a page");
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetMaxSize(max_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < GetSize(); i++) {
+    if (values_[i] == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  // find the first separator greater than the key, the child on its left covers the key. An optimistic reader may
+  // see a torn size, keep the search inside the page anyway, the reader validates the result afterwards.
+  int high = std::clamp(GetSize(), 1, SLOT_CNT);
+  if constexpr (HAS_SIMD_SEARCH<KeyType, KeyComparator>) {
+    return NodeUpperBound(keys_ + 1, high - 1, key);
+  }
+  int low = 1;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(keys_[mid], key) <= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &key,
+                                                     const ValueType &new_value) {
+  values_[0] = old_value;
+  keys_[1] = key;
+  values_[1] = new_value;
+  SetSize(2);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertAfter(int index, const KeyType &key, const ValueType &value) {
+  ShiftRight(index + 1);
+  keys_[index + 1] = key;
+  values_[index + 1] = value;
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  std::move(keys_ + index + 1, keys_ + GetSize(), keys_ + index);
+  std::move(values_ + index + 1, values_ + GetSize(), values_ + index);
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) -> KeyType {
+  int mid = GetSize() / 2;
+  std::copy(keys_ + mid, keys_ + GetSize(), recipient->keys_);
+  std::copy(values_ + mid, values_ + GetSize(), recipient->values_);
+  recipient->SetSize(GetSize() - mid);
+  SetSize(mid);
+  // the first key of the recipient moves up to the parent, in the recipient it becomes the unused one
+  return recipient->keys_[0];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  keys_[0] = middle_key;
+  std::copy(keys_, keys_ + GetSize(), recipient->keys_ + recipient->GetSize());
+  std::copy(values_, values_ + GetSize(), recipient->values_ + recipient->GetSize());
+  recipient->IncreaseSize(GetSize());
+  SetSize(0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key)
+    -> KeyType {
+  recipient->keys_[recipient->GetSize()] = middle_key;
+  recipient->values_[recipient->GetSize()] = values_[0];
+  recipient->IncreaseSize(1);
+  KeyType separator = keys_[1];
+  Remove(0);
+  return separator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key)
+    -> KeyType {
+  recipient->ShiftRight(0);
+  recipient->keys_[1] = middle_key;
+  recipient->values_[0] = values_[GetSize() - 1];
+  recipient->IncreaseSize(1);
+  KeyType separator = keys_[GetSize() - 1];
+  IncreaseSize(-1);
+  return separator;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::ShiftRight(int index) {
+  std::move_backward(keys_ + index, keys_ + GetSize(), keys_ + GetSize() + 1);
+  std::move_backward(values_ + index, values_ + GetSize(), values_ + GetSize() + 1);
+}
+
+/*****************************************************************************
+ * PREFIX-COMPRESSED INTERNAL PAGES
+ *****************************************************************************/
+
+#define NORMALIZED_KEY_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+#define B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE \
+  BPlusTreeInternalPage<NormalizedKey<KeySize>, ValueType, NormalizedComparator<KeySize>>
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::Init(int max_size) {
+  this->InitPrefixPage(IndexPageType::INTERNAL_PAGE, max_size);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (this->ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &key,
+                                                                const ValueType &new_value) {
+  this->SetValueAt(0, old_value);
+  this->SetKeyAt(1, key);
+  this->SetValueAt(1, new_value);
+  this->SetSize(2);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::InsertAfter(int index, const KeyType &key, const ValueType &value) {
+  this->ShiftRight(index + 1);
+  this->SetKeyAt(index + 1, key);
+  this->SetValueAt(index + 1, value);
+  this->IncreaseSize(1);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::Remove(int index) {
+  this->ShiftLeft(index);
+  this->IncreaseSize(-1);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) -> KeyType {
+  int mid = this->GetSize() / 2;
+  KeyType separator = this->KeyAt(mid);
+  recipient->SetKeyRange(&separator, this->HighFence());
+  for (int i = mid; i < this->GetSize(); i++) {
+    recipient->Append(this->KeyAt(i), this->ValueAt(i));
+  }
+  this->SetSize(mid);
+  this->SetKeyRange(this->LowFence(), &separator);
+  return separator;
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
+                                                          const KeyType &middle_key) {
+  recipient->SetKeyRange(recipient->LowFence(), this->HighFence());
+  recipient->Append(middle_key, this->ValueAt(0));
+  for (int i = 1; i < this->GetSize(); i++) {
+    recipient->Append(this->KeyAt(i), this->ValueAt(i));
+  }
+  this->SetSize(0);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
+                                                                 const KeyType &middle_key) -> KeyType {
+  KeyType separator = this->KeyAt(1);
+  ValueType child = this->ValueAt(0);
+  Remove(0);
+  recipient->SetKeyRange(recipient->LowFence(), &separator);
+  recipient->Append(middle_key, child);
+  this->SetKeyRange(&separator, this->HighFence());
+  return separator;
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
+                                                                  const KeyType &middle_key) -> KeyType {
+  KeyType separator = this->KeyAt(this->GetSize() - 1);
+  ValueType child = this->ValueAt(this->GetSize() - 1);
+  this->IncreaseSize(-1);
+  recipient->SetKeyRange(&separator, recipient->HighFence());
+  recipient->ShiftRight(0);
+  recipient->SetKeyAt(1, middle_key);
+  recipient->SetValueAt(0, child);
+  recipient->IncreaseSize(1);
+  this->SetKeyRange(this->LowFence(), &separator);
+  return separator;
+}
+
+template class BPlusTreeInternalPage<int32_t, page_id_t, IntegerComparator<int32_t>>;
+template class BPlusTreeInternalPage<int64_t, page_id_t, IntegerComparator<int64_t>>;
+template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<8>>, page_id_t,
+                                     NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<16>>, page_id_t,
+                                     NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<32>>, page_id_t,
+                                     NonUniqueComparator<GenericKey<32>, GenericComparator<32>>>;
+template class BPlusTreeInternalPage<NonUniqueKey<GenericKey<64>>, page_id_t,
+                                     NonUniqueComparator<GenericKey<64>, GenericComparator<64>>>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
+template class BPlusTreeInternalPage<NormalizedKey<128>, page_id_t, NormalizedComparator<128>>;
+
+}  // namespace redbase
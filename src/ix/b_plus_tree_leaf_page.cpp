@@ -0,0 +1,260 @@
+#include "ix/b_plus_tree_leaf_page.h"
+
+#include <algorithm>
+
+#include "common/rid.h"
+#include "ix/covering_value.h"
+#include "ix/generic_key.h"
+#include "ix/node_search.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) {
+  static_assert(sizeof(BPlusTreeLeafPage) <= PAGE_SIZE, "a leaf must fit into a page");
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetMaxSize(max_size);
+  next_page_id_ = INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  if constexpr (HAS_SIMD_SEARCH<KeyType, KeyComparator>) {
+    return NodeLowerBound(keys_, GetSize(), key);
+  }
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(keys_[mid], key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(keys_[index], key) != 0) {
+    return false;
+  }
+  *value = values_[index];
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator)
+    -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(keys_[index], key) == 0) {
+    return false;
+  }
+  ShiftRight(index);
+  keys_[index] = key;
+  values_[index] = value;
+  IncreaseSize(1);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comparator) -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(keys_[index], key) != 0) {
+    return false;
+  }
+  ShiftLeft(index);
+  IncreaseSize(-1);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int mid = GetSize() / 2;
+  std::copy(keys_ + mid, keys_ + GetSize(), recipient->keys_);
+  std::copy(values_ + mid, values_ + GetSize(), recipient->values_);
+  recipient->SetSize(GetSize() - mid);
+  SetSize(mid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::copy(keys_, keys_ + GetSize(), recipient->keys_ + recipient->GetSize());
+  std::copy(values_, values_ + GetSize(), recipient->values_ + recipient->GetSize());
+  recipient->IncreaseSize(GetSize());
+  recipient->SetNextPageId(next_page_id_);
+  SetSize(0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->keys_[recipient->GetSize()] = keys_[0];
+  recipient->values_[recipient->GetSize()] = values_[0];
+  recipient->IncreaseSize(1);
+  ShiftLeft(0);
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->ShiftRight(0);
+  recipient->keys_[0] = keys_[GetSize() - 1];
+  recipient->values_[0] = values_[GetSize() - 1];
+  recipient->IncreaseSize(1);
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::ShiftRight(int index) {
+  std::move_backward(keys_ + index, keys_ + GetSize(), keys_ + GetSize() + 1);
+  std::move_backward(values_ + index, values_ + GetSize(), values_ + GetSize() + 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::ShiftLeft(int index) {
+  std::move(keys_ + index + 1, keys_ + GetSize(), keys_ + index);
+  std::move(values_ + index + 1, values_ + GetSize(), values_ + index);
+}
+
+/*****************************************************************************
+ * PREFIX-COMPRESSED LEAVES
+ *****************************************************************************/
+
+#define NORMALIZED_KEY_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+#define B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE \
+  BPlusTreeLeafPage<NormalizedKey<KeySize>, ValueType, NormalizedComparator<KeySize>>
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::Init(int max_size) {
+  this->InitPrefixPage(IndexPageType::LEAF_PAGE, max_size);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value,
+                                                   const KeyComparator &comparator) const -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == this->GetSize() || comparator(this->KeyAt(index), key) != 0) {
+    return false;
+  }
+  *value = this->ValueAt(index);
+  return true;
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                                                   const KeyComparator &comparator) -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index < this->GetSize() && comparator(this->KeyAt(index), key) == 0) {
+    return false;
+  }
+  this->ShiftRight(index);
+  this->SetKeyAt(index, key);
+  this->SetValueAt(index, value);
+  this->IncreaseSize(1);
+  return true;
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comparator) -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == this->GetSize() || comparator(this->KeyAt(index), key) != 0) {
+    return false;
+  }
+  this->ShiftLeft(index);
+  this->IncreaseSize(-1);
+  return true;
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  // the separator splits the range of the page, both halves get a prefix at least as long as the current one
+  int mid = this->GetSize() / 2;
+  KeyType separator = this->KeyAt(mid);
+  recipient->SetKeyRange(&separator, this->HighFence());
+  for (int i = mid; i < this->GetSize(); i++) {
+    recipient->Append(this->KeyAt(i), this->ValueAt(i));
+  }
+  this->SetSize(mid);
+  this->SetKeyRange(this->LowFence(), &separator);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->SetKeyRange(recipient->LowFence(), this->HighFence());
+  for (int i = 0; i < this->GetSize(); i++) {
+    recipient->Append(this->KeyAt(i), this->ValueAt(i));
+  }
+  recipient->SetNextPageId(this->next_page_id_);
+  this->SetSize(0);
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  KeyType key = this->KeyAt(0);
+  ValueType value = this->ValueAt(0);
+  this->ShiftLeft(0);
+  this->IncreaseSize(-1);
+  // the new first key of the page separates the two pages from now on
+  KeyType separator = this->KeyAt(0);
+  recipient->SetKeyRange(recipient->LowFence(), &separator);
+  recipient->Append(key, value);
+  this->SetKeyRange(&separator, this->HighFence());
+}
+
+NORMALIZED_KEY_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_NORMALIZED_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  KeyType separator = this->KeyAt(this->GetSize() - 1);
+  ValueType value = this->ValueAt(this->GetSize() - 1);
+  this->IncreaseSize(-1);
+  recipient->SetKeyRange(&separator, recipient->HighFence());
+  recipient->ShiftRight(0);
+  recipient->SetKeyAt(0, separator);
+  recipient->SetValueAt(0, value);
+  recipient->IncreaseSize(1);
+  this->SetKeyRange(this->LowFence(), &separator);
+}
+
+template class BPlusTreeLeafPage<int32_t, RID, IntegerComparator<int32_t>>;
+template class BPlusTreeLeafPage<int64_t, RID, IntegerComparator<int64_t>>;
+template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<8>>, RID,
+                                 NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<16>>, RID,
+                                 NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<32>>, RID,
+                                 NonUniqueComparator<GenericKey<32>, GenericComparator<32>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<64>>, RID,
+                                 NonUniqueComparator<GenericKey<64>, GenericComparator<64>>>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTreeLeafPage<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+
+template class BPlusTreeLeafPage<GenericKey<8>, CoveringValue<16>, GenericComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<8>, CoveringValue<32>, GenericComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<8>, CoveringValue<64>, GenericComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<16>, CoveringValue<32>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<16>, CoveringValue<64>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<8>>, CoveringValue<16>,
+                                 NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<8>>, CoveringValue<32>,
+                                 NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<8>>, CoveringValue<64>,
+                                 NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<16>>, CoveringValue<16>,
+                                 NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<16>>, CoveringValue<32>,
+                                 NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class BPlusTreeLeafPage<NonUniqueKey<GenericKey<16>>, CoveringValue<64>,
+                                 NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+
+}  // namespace redbase
@@ -0,0 +1,172 @@
+#include "ix/b_plus_tree_prefix_page.h"
+
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rid.h"
+
+namespace redbase {
+
+#define PREFIX_PAGE_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+#define B_PLUS_TREE_PREFIX_PAGE_TYPE BPlusTreePrefixPage<KeySize, ValueType>
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::InitPrefixPage(IndexPageType page_type, int max_size) {
+  static_assert(sizeof(BPlusTreePrefixPage) <= PAGE_SIZE, "a prefix-compressed node must fit into a page");
+  SetPageType(page_type);
+  SetSize(0);
+  max_size_cap_ = max_size;
+  prefix_len_ = 0;
+  has_low_ = 0;
+  has_high_ = 0;
+  SetMaxSize(InitialMaxSize(max_size));
+  next_page_id_ = INVALID_PAGE_ID;
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_PREFIX_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  size_t prefix_len = Prefix();
+  KeyType key;
+  memcpy(key.data_, low_, prefix_len);
+  memcpy(key.data_ + prefix_len, SuffixAt(index), KeySize - prefix_len);
+  return key;
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  size_t prefix_len = Prefix();
+  memcpy(data_ + index * (KeySize - prefix_len), key.data_ + prefix_len, KeySize - prefix_len);
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_PREFIX_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  // an optimistic reader may have computed the index under another prefix, keep it inside the page
+  index = std::clamp(index, 0, Capacity(Prefix()) - 1);
+  ValueType value;
+  memcpy(&value, data_ + ValueOffset(index), sizeof(ValueType));
+  return value;
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  memcpy(data_ + ValueOffset(index), &value, sizeof(ValueType));
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::SetKeyRange(const KeyType *low, const KeyType *high) {
+  size_t prefix_len = CommonPrefix(low, high);
+  // the fences may point into this page, copy them before anything moves
+  KeyType low_key{};
+  KeyType high_key{};
+  if (low != nullptr) {
+    low_key = *low;
+  }
+  if (high != nullptr) {
+    high_key = *high;
+  }
+
+  std::vector<KeyType> keys;
+  std::vector<ValueType> values;
+  bool relayout = prefix_len != Prefix();
+  if (relayout) {
+    for (int i = 0; i < GetSize(); i++) {
+      keys.push_back(KeyAt(i));
+      values.push_back(ValueAt(i));
+    }
+  }
+
+  REDBASE_ASSERT(GetSize() <= Capacity(prefix_len), "the entries do not fit into the new key range");
+  has_low_ = low != nullptr ? 1 : 0;
+  has_high_ = high != nullptr ? 1 : 0;
+  memcpy(low_, low_key.data_, KeySize);
+  memcpy(high_, high_key.data_, KeySize);
+  prefix_len_ = static_cast<uint16_t>(prefix_len);
+  SetMaxSize(std::min(max_size_cap_, Capacity(prefix_len) - 1));
+  for (size_t i = 0; i < keys.size(); i++) {
+    SetKeyAt(static_cast<int>(i), keys[i]);
+    SetValueAt(static_cast<int>(i), values[i]);
+  }
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_PREFIX_PAGE_TYPE::Search(const KeyType &key, int begin, bool upper) const -> int {
+  size_t prefix_len = Prefix();
+  // an optimistic reader may see a torn size, keep the search inside the page anyway
+  int size = std::clamp(GetSize(), 0, Capacity(prefix_len));
+  if (prefix_len > 0) {
+    // a key outside the fences is below or above every entry
+    int cmp = memcmp(key.data_, low_, prefix_len);
+    if (cmp < 0) {
+      return begin;
+    }
+    if (cmp > 0) {
+      return std::max(begin, size);
+    }
+  }
+  size_t stride = KeySize - prefix_len;
+  const uint8_t *suffix = key.data_ + prefix_len;
+  int low = begin;
+  int high = size;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    int cmp = memcmp(data_ + mid * stride, suffix, stride);
+    if (upper ? cmp <= 0 : cmp < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_PREFIX_PAGE_TYPE::Fits(int count, const KeyType *low, const KeyType *high) const -> bool {
+  return count <= std::min(max_size_cap_, Capacity(CommonPrefix(low, high)) - 1);
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::ShiftRight(int index) {
+  size_t stride = KeySize - Prefix();
+  size_t count = GetSize() - index;
+  memmove(data_ + (index + 1) * stride, data_ + index * stride, count * stride);
+  memmove(data_ + ValueOffset(index + 1), data_ + ValueOffset(index), count * sizeof(ValueType));
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::ShiftLeft(int index) {
+  size_t stride = KeySize - Prefix();
+  size_t count = GetSize() - index - 1;
+  memmove(data_ + index * stride, data_ + (index + 1) * stride, count * stride);
+  memmove(data_ + ValueOffset(index), data_ + ValueOffset(index + 1), count * sizeof(ValueType));
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_PREFIX_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  SetKeyAt(GetSize(), key);
+  SetValueAt(GetSize(), value);
+  IncreaseSize(1);
+}
+
+PREFIX_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_PREFIX_PAGE_TYPE::CommonPrefix(const KeyType *low, const KeyType *high) -> size_t {
+  if (low == nullptr || high == nullptr) {
+    return 0;
+  }
+  // keep at least one byte per key, fences are distinct anyway
+  size_t prefix_len = 0;
+  while (prefix_len < KeySize - 1 && low->data_[prefix_len] == high->data_[prefix_len]) {
+    prefix_len++;
+  }
+  return prefix_len;
+}
+
+template class BPlusTreePrefixPage<16, RID>;
+template class BPlusTreePrefixPage<32, RID>;
+template class BPlusTreePrefixPage<64, RID>;
+template class BPlusTreePrefixPage<128, RID>;
+template class BPlusTreePrefixPage<16, page_id_t>;
+template class BPlusTreePrefixPage<32, page_id_t>;
+template class BPlusTreePrefixPage<64, page_id_t>;
+template class BPlusTreePrefixPage<128, page_id_t>;
+
+}  // namespace redbase
@@ -0,0 +1,252 @@
+#include "ix/bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace redbase {
+
+namespace {
+
+/** Odd multipliers, one per word of a block, whose products with a hash spread its bits over the words. */
+alignas(32) constexpr uint32_t SALTS[BloomFilter::WORDS_PER_BLOCK] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+/** The top 6 bits of the product pick a bit of a 64-bit word. */
+constexpr int BIT_SHIFT = 26;
+
+/**
+ * Filter page format:
+ *  --------------------------------------------------------------------------------------
+ *  | NextPageId (4) | NumBlocks (4) | TotalBlocks (8) | NumKeys (8) | padding | block 0 | ... |
+ *  --------------------------------------------------------------------------------------
+ * NumBlocks counts the blocks of the page, TotalBlocks and NumKeys are only meaningful on the first page. The header
+ * takes one block worth of bytes, which keeps the blocks cache line aligned within the page.
+ */
+struct FilterPageHeader {
+  page_id_t next_page_id_;
+  uint32_t num_blocks_;
+  uint64_t total_blocks_;
+  uint64_t num_keys_;
+};
+
+constexpr size_t BLOCKS_PER_PAGE = PAGE_SIZE / BloomFilter::BLOCK_SIZE - 1;
+
+inline auto BitOf(uint32_t hash, size_t word) -> uint64_t {
+  return uint64_t{1} << ((hash * SALTS[word]) >> BIT_SHIFT);
+}
+
+auto ProbeScalar(const uint64_t *words, uint32_t hash) -> bool {
+  for (size_t i = 0; i < BloomFilter::WORDS_PER_BLOCK; i++) {
+    auto bit = BitOf(hash, i);
+    if ((__atomic_load_n(&words[i], __ATOMIC_RELAXED) & bit) != bit) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#if defined(__x86_64__)
+
+/** The eight bit positions at once, then two 4 x 64-bit masks tested against the two halves of the block. */
+__attribute__((target("avx2"))) auto ProbeAvx2(const uint64_t *words, uint32_t hash) -> bool {
+  __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i *>(SALTS));
+  __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts), BIT_SHIFT);
+  __m256i ones = _mm256_set1_epi64x(1);
+  __m256i low_mask = _mm256_sllv_epi64(ones, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+  __m256i high_mask = _mm256_sllv_epi64(ones, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+  __m256i low_words = _mm256_load_si256(reinterpret_cast<const __m256i *>(words));
+  __m256i high_words = _mm256_load_si256(reinterpret_cast<const __m256i *>(words + 4));
+  // testc is 1 when every bit of the mask is set in the words
+  return (_mm256_testc_si256(low_words, low_mask) & _mm256_testc_si256(high_words, high_mask)) != 0;
+}
+
+#endif
+
+auto HasAvx2() -> bool {
+  static const bool HAS_AVX2 = [] {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+  }();
+  return HAS_AVX2;
+}
+
+/** @return the number of blocks that meet the options, the smallest one within the budget */
+auto SizeFilter(const BloomFilterOptions &options) -> size_t {
+  if (!(options.false_positive_rate_ > 0 && options.false_positive_rate_ < 1)) {
+    throw Exception(fmt::format("bloom filter: false positive rate {} out of range (0, 1)",
+                                options.false_positive_rate_));
+  }
+  size_t max_blocks =
+      options.max_bytes_ == 0 ? size_t{1} << 31 : std::max<size_t>(1, options.max_bytes_ / BloomFilter::BLOCK_SIZE);
+  // the rate falls with the size: double up to a size that meets it, then bisect
+  size_t high = 1;
+  while (high < max_blocks &&
+         BloomFilter::EstimateFalsePositiveRate(high, options.expected_keys_) > options.false_positive_rate_) {
+    high *= 2;
+  }
+  if (high >= max_blocks) {
+    return max_blocks;
+  }
+  size_t low = high / 2;
+  while (low + 1 < high) {
+    size_t mid = low + (high - low) / 2;
+    if (BloomFilter::EstimateFalsePositiveRate(mid, options.expected_keys_) > options.false_positive_rate_) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  return high;
+}
+
+}  // namespace
+
+BloomFilter::BloomFilter(BufferPoolManager *bpm, const BloomFilterOptions &options)
+    : bpm_(bpm), num_blocks_(SizeFilter(options)), blocks_(num_blocks_) {}
+
+BloomFilter::BloomFilter(BufferPoolManager *bpm, page_id_t first_page_id)
+    : bpm_(bpm), first_page_id_(first_page_id), num_blocks_(0) {
+  size_t loaded = 0;
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("cannot load bloom filter: page {} cannot be fetched", page_id));
+    }
+    auto header = guard.As<FilterPageHeader>();
+    if (page_id == first_page_id) {
+      num_blocks_ = header->total_blocks_;
+      num_keys_ = header->num_keys_;
+      blocks_.resize(num_blocks_);
+    }
+    if (loaded + header->num_blocks_ > num_blocks_) {
+      throw Exception(fmt::format("cannot load bloom filter: page {} holds more blocks than the filter", page_id));
+    }
+    memcpy(blocks_.data() + loaded, guard.GetData() + BLOCK_SIZE, header->num_blocks_ * BLOCK_SIZE);
+    loaded += header->num_blocks_;
+    page_id = header->next_page_id_;
+  }
+  if (num_blocks_ == 0 || loaded != num_blocks_) {
+    throw Exception(fmt::format("cannot load bloom filter: {} of {} blocks found", loaded, num_blocks_));
+  }
+}
+
+void BloomFilter::Insert(hash_t hash) {
+  Block &block = blocks_[BlockIndex(hash)];
+  auto low = static_cast<uint32_t>(hash);
+  for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+    __atomic_fetch_or(&block.words_[i], BitOf(low, i), __ATOMIC_RELAXED);
+  }
+  num_keys_.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto BloomFilter::MayContain(hash_t hash) const -> bool {
+  const uint64_t *words = blocks_[BlockIndex(hash)].words_;
+  auto low = static_cast<uint32_t>(hash);
+  bool maybe;
+#if defined(__x86_64__)
+  maybe = HasAvx2() ? ProbeAvx2(words, low) : ProbeScalar(words, low);
+#else
+  maybe = ProbeScalar(words, low);
+#endif
+  (maybe ? passed_ : skipped_).fetch_add(1, std::memory_order_relaxed);
+  return maybe;
+}
+
+auto BloomFilter::GetStats() const -> BloomFilterStats {
+  return {skipped_.load(std::memory_order_relaxed), passed_.load(std::memory_order_relaxed),
+          false_positives_.load(std::memory_order_relaxed)};
+}
+
+void BloomFilter::ResetStats() {
+  skipped_ = 0;
+  passed_ = 0;
+  false_positives_ = 0;
+}
+
+auto BloomFilter::EstimateFalsePositiveRate(size_t num_blocks, size_t num_keys) -> double {
+  if (num_keys == 0) {
+    return 0;
+  }
+  // the keys of a block follow a Poisson distribution, a block holding j of them sets a given bit of each word with
+  // probability 1 - (1 - 1/64)^j, and an absent key passes if its bit is set in all eight words
+  double lambda = static_cast<double>(num_keys) / static_cast<double>(num_blocks);
+  double spread = 10 * std::sqrt(lambda) + 10;
+  auto first = static_cast<size_t>(std::max(0.0, lambda - spread));
+  auto last = static_cast<size_t>(lambda + spread);
+  double rate = 0;
+  for (size_t j = first; j <= last; j++) {
+    double probability = std::exp(-lambda + static_cast<double>(j) * std::log(lambda) - std::lgamma(j + 1.0));
+    double bit_set = 1 - std::pow(1 - 1.0 / 64, static_cast<double>(j));
+    rate += probability * std::pow(bit_set, static_cast<double>(WORDS_PER_BLOCK));
+  }
+  return std::min(rate, 1.0);
+}
+
+void BloomFilter::Flush() {
+  page_id_t page_id = first_page_id_;
+  WritePageGuard prev_guard;
+  size_t written = 0;
+  while (written < num_blocks_) {
+    WritePageGuard guard;
+    if (page_id == INVALID_PAGE_ID) {
+      // the filter never grows, so the chain is only extended by the first flush
+      auto basic_guard = bpm_->NewPageGuarded(&page_id);
+      if (!basic_guard.IsValid()) {
+        throw Exception("cannot flush bloom filter: no free frame in the buffer pool");
+      }
+      guard = basic_guard.UpgradeWrite();
+      guard.AsMut<FilterPageHeader>()->next_page_id_ = INVALID_PAGE_ID;
+      if (prev_guard.IsValid()) {
+        prev_guard.AsMut<FilterPageHeader>()->next_page_id_ = page_id;
+      } else {
+        first_page_id_ = page_id;
+      }
+    } else {
+      guard = bpm_->FetchPageWrite(page_id);
+      if (!guard.IsValid()) {
+        throw Exception(fmt::format("cannot flush bloom filter: page {} cannot be fetched", page_id));
+      }
+    }
+
+    auto header = guard.AsMut<FilterPageHeader>();
+    size_t count = std::min(BLOCKS_PER_PAGE, num_blocks_ - written);
+    header->num_blocks_ = static_cast<uint32_t>(count);
+    header->total_blocks_ = num_blocks_;
+    header->num_keys_ = GetNumKeys();
+    memcpy(guard.GetDataMut() + BLOCK_SIZE, blocks_.data() + written, count * BLOCK_SIZE);
+    written += count;
+
+    page_id = header->next_page_id_;
+    prev_guard = std::move(guard);
+  }
+}
+
+void BloomFilter::DeletePages() {
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("cannot delete bloom filter: page {} cannot be fetched", page_id));
+    }
+    page_id_t next_page_id = guard.As<FilterPageHeader>()->next_page_id_;
+    guard.Drop();
+    bpm_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  first_page_id_ = INVALID_PAGE_ID;
+}
+
+}  // namespace redbase
@@ -0,0 +1,113 @@
+#include "ix/covering_index.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+namespace {
+
+auto IncludeColumns(const Schema *table_schema, const std::vector<uint32_t> &column_idxs) -> std::vector<Column> {
+  std::vector<Column> columns;
+  for (uint32_t col_idx : column_idxs) {
+    if (col_idx >= table_schema->GetColumnCount()) {
+      throw Exception(fmt::format("INCLUDE column {} out of range, the table has {} columns", col_idx,
+                                  table_schema->GetColumnCount()));
+    }
+    columns.push_back(table_schema->GetColumn(col_idx));
+  }
+  return columns;
+}
+
+}  // namespace
+
+IndexInclude::IndexInclude(const Schema *table_schema, std::vector<uint32_t> column_idxs)
+    : table_schema_(table_schema),
+      column_idxs_(std::move(column_idxs)),
+      schema_(IncludeColumns(table_schema, column_idxs_)) {}
+
+auto IndexInclude::GetPayloadColumn(uint32_t table_col_idx) const -> std::optional<uint32_t> {
+  auto it = std::find(column_idxs_.begin(), column_idxs_.end(), table_col_idx);
+  if (it == column_idxs_.end()) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(it - column_idxs_.begin());
+}
+
+auto IndexInclude::Covers(const std::vector<uint32_t> &table_col_idxs) const -> bool {
+  return std::all_of(table_col_idxs.begin(), table_col_idxs.end(),
+                     [this](uint32_t col_idx) { return GetPayloadColumn(col_idx).has_value(); });
+}
+
+void IndexInclude::Pack(const char *tuple, char *payload) const {
+  memset(payload, 0, GetPayloadSize());
+  for (uint32_t i = 0; i < column_idxs_.size(); i++) {
+    uint32_t col_idx = column_idxs_[i];
+    if (table_schema_->IsNull(tuple, col_idx)) {
+      schema_.SetNull(payload, i, true);
+      continue;
+    }
+    memcpy(payload + schema_.GetOffset(i), tuple + table_schema_->GetOffset(col_idx), schema_.GetColumn(i).GetLength());
+  }
+}
+
+COVERING_TEMPLATE_ARGUMENTS
+IndexOnlyScan<KeyType, PAYLOAD_SIZE, KeyComparator>::IndexOnlyScan(const Tree *tree, const IndexInclude *include,
+                                                                   const KeyType *lower, const KeyType *upper,
+                                                                   size_t batch_size)
+    : comparator_(tree->GetComparator()),
+      payload_size_(include->GetPayloadSize()),
+      batch_size_(batch_size),
+      iter_(lower != nullptr ? tree->Begin(*lower) : tree->Begin()) {
+  if (payload_size_ > PAYLOAD_SIZE) {
+    throw Exception(fmt::format("INCLUDE columns take {} bytes, the index payload holds {}", payload_size_,
+                                PAYLOAD_SIZE));
+  }
+  if (upper != nullptr) {
+    upper_ = *upper;
+  }
+  values_.reserve(batch_size_);
+}
+
+COVERING_TEMPLATE_ARGUMENTS
+auto IndexOnlyScan<KeyType, PAYLOAD_SIZE, KeyComparator>::NextBatch(std::vector<TupleView> *batch) -> bool {
+  batch->clear();
+  values_.clear();
+  while (values_.size() < batch_size_ && !iter_.IsEnd()) {
+    auto [key, value] = *iter_;
+    if (upper_.has_value() && comparator_(key, *upper_) > 0) {
+      iter_ = {};
+      break;
+    }
+    values_.push_back(value);
+    ++iter_;
+  }
+  // the buffer is filled first, so that the views do not move with it
+  for (const auto &value : values_) {
+    batch->push_back({value.rid_, value.payload_, payload_size_});
+  }
+  return !batch->empty();
+}
+
+template class IndexOnlyScan<GenericKey<8>, 16, GenericComparator<8>>;
+template class IndexOnlyScan<GenericKey<8>, 32, GenericComparator<8>>;
+template class IndexOnlyScan<GenericKey<8>, 64, GenericComparator<8>>;
+template class IndexOnlyScan<GenericKey<16>, 16, GenericComparator<16>>;
+template class IndexOnlyScan<GenericKey<16>, 32, GenericComparator<16>>;
+template class IndexOnlyScan<GenericKey<16>, 64, GenericComparator<16>>;
+template class IndexOnlyScan<NonUniqueKey<GenericKey<8>>, 16,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexOnlyScan<NonUniqueKey<GenericKey<8>>, 32,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexOnlyScan<NonUniqueKey<GenericKey<8>>, 64,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexOnlyScan<NonUniqueKey<GenericKey<16>>, 16,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class IndexOnlyScan<NonUniqueKey<GenericKey<16>>, 32,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class IndexOnlyScan<NonUniqueKey<GenericKey<16>>, 64,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+
+}  // namespace redbase
@@ -0,0 +1,97 @@
+#include "ix/extendible_hash_bucket_page.h"
+
+#include "common/macros.h"
+#include "common/rid.h"
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::Init(uint32_t max_size) {
+  static_assert(sizeof(ExtendibleHashBucketPage) <= PAGE_SIZE, "a bucket must fit into a page");
+  REDBASE_ASSERT(max_size > 0 && max_size <= SLOT_CNT, "bucket max size out of range");
+  size_ = 0;
+  max_size_ = max_size;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::Find(uint32_t hash, const KeyType &key, const KeyComparator &comparator) const
+    -> int {
+  for (uint32_t i = 0; i < size_; i++) {
+    if (hashes_[i] == hash && comparator(keys_[i], key) == 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::Lookup(uint32_t hash, const KeyType &key, ValueType *value,
+                                              const KeyComparator &comparator) const -> bool {
+  int index = Find(hash, key, comparator);
+  if (index < 0) {
+    return false;
+  }
+  *value = values_[index];
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::Insert(uint32_t hash, const KeyType &key, const ValueType &value,
+                                              const KeyComparator &comparator) -> bool {
+  REDBASE_ASSERT(!IsFull(), "insert into a full bucket");
+  if (Find(hash, key, comparator) >= 0) {
+    return false;
+  }
+  Append(hash, key, value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::Remove(uint32_t hash, const KeyType &key, const KeyComparator &comparator)
+    -> bool {
+  int index = Find(hash, key, comparator);
+  if (index < 0) {
+    return false;
+  }
+  RemoveAt(index);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::SplitTo(ExtendibleHashBucketPage *image, uint32_t bit) {
+  uint32_t i = 0;
+  while (i < size_) {
+    if ((hashes_[i] & bit) != 0) {
+      image->Append(hashes_[i], keys_[i], values_[i]);
+      RemoveAt(i);
+    } else {
+      i++;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::Append(uint32_t hash, const KeyType &key, const ValueType &value) {
+  hashes_[size_] = hash;
+  keys_[size_] = key;
+  values_[size_] = value;
+  size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_BUCKET_PAGE_TYPE::RemoveAt(uint32_t index) {
+  size_--;
+  hashes_[index] = hashes_[size_];
+  keys_[index] = keys_[size_];
+  values_[index] = values_[size_];
+}
+
+template class ExtendibleHashBucketPage<int32_t, RID, IntegerComparator<int32_t>>;
+template class ExtendibleHashBucketPage<int64_t, RID, IntegerComparator<int64_t>>;
+template class ExtendibleHashBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace redbase
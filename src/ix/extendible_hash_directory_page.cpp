@@ -0,0 +1,37 @@
+#include "ix/extendible_hash_directory_page.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace redbase {
+
+void ExtendibleHashDirectoryPage::Init(uint32_t max_depth) {
+  REDBASE_ASSERT(max_depth <= HASH_DIRECTORY_MAX_DEPTH, "directory max depth out of range");
+  max_depth_ = max_depth;
+  global_depth_ = 0;
+  std::fill(local_depths_, local_depths_ + HASH_DIRECTORY_ARRAY_SIZE, 0);
+  std::fill(bucket_page_ids_, bucket_page_ids_ + HASH_DIRECTORY_ARRAY_SIZE, INVALID_PAGE_ID);
+}
+
+auto ExtendibleHashDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const -> uint32_t {
+  uint32_t local_depth = local_depths_[bucket_idx];
+  return local_depth == 0 ? bucket_idx : bucket_idx ^ (1U << (local_depth - 1));
+}
+
+void ExtendibleHashDirectoryPage::IncrGlobalDepth() {
+  REDBASE_ASSERT(global_depth_ < max_depth_, "directory already at its max depth");
+  uint32_t size = Size();
+  std::copy(local_depths_, local_depths_ + size, local_depths_ + size);
+  std::copy(bucket_page_ids_, bucket_page_ids_ + size, bucket_page_ids_ + size);
+  global_depth_++;
+}
+
+auto ExtendibleHashDirectoryPage::CanShrink() const -> bool {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  return std::all_of(local_depths_, local_depths_ + Size(), [this](uint8_t depth) { return depth < global_depth_; });
+}
+
+}  // namespace redbase
@@ -0,0 +1,15 @@
+#include "ix/extendible_hash_header_page.h"
+
+#include "common/macros.h"
+
+namespace redbase {
+
+void ExtendibleHashHeaderPage::Init(uint32_t max_depth) {
+  REDBASE_ASSERT(max_depth <= HASH_HEADER_MAX_DEPTH, "header max depth out of range");
+  max_depth_ = max_depth;
+  for (auto &directory_page_id : directory_page_ids_) {
+    directory_page_id = INVALID_PAGE_ID;
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,327 @@
+#include "ix/extendible_hash_index.h"
+
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTENDIBLE_HASH_INDEX_TYPE::ExtendibleHashIndex(std::string name, BufferPoolManager *bpm,
+                                                const KeyComparator &comparator, uint32_t header_max_depth,
+                                                uint32_t directory_max_depth, uint32_t bucket_max_size)
+    : ExtendibleHashIndex(std::move(name), INVALID_PAGE_ID, bpm, comparator, directory_max_depth, bucket_max_size) {
+  if (header_max_depth > HASH_HEADER_MAX_DEPTH) {
+    throw Exception(fmt::format("header max depth {} out of range [0, {}]", header_max_depth, HASH_HEADER_MAX_DEPTH));
+  }
+  auto guard = bpm_->NewPageGuarded(&header_page_id_);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot create index {}: no free frame in the buffer pool", index_name_));
+  }
+  guard.AsMut<ExtendibleHashHeaderPage>()->Init(header_max_depth);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTENDIBLE_HASH_INDEX_TYPE::ExtendibleHashIndex(std::string name, page_id_t header_page_id, BufferPoolManager *bpm,
+                                                const KeyComparator &comparator, uint32_t directory_max_depth,
+                                                uint32_t bucket_max_size)
+    : index_name_(std::move(name)),
+      bpm_(bpm),
+      comparator_(comparator),
+      directory_max_depth_(directory_max_depth),
+      bucket_max_size_(bucket_max_size),
+      header_page_id_(header_page_id) {
+  if (directory_max_depth_ > HASH_DIRECTORY_MAX_DEPTH) {
+    throw Exception(fmt::format("directory max depth {} out of range [0, {}]", directory_max_depth_,
+                                HASH_DIRECTORY_MAX_DEPTH));
+  }
+  if (bucket_max_size_ < 1 || bucket_max_size_ > BucketPage::SLOT_CNT) {
+    throw Exception(fmt::format("bucket max size {} out of range [1, {}]", bucket_max_size_, BucketPage::SLOT_CNT));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::GetDirectoryPageId(uint32_t hash) const -> page_id_t {
+  auto guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  auto header = guard.As<ExtendibleHashHeaderPage>();
+  // directories are never deleted, their page id stays valid once the header is released
+  return header->GetDirectoryPageId(header->HashToDirectoryIndex(hash));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::GetGlobalDepth(const KeyType &key) const -> uint32_t {
+  page_id_t directory_page_id = GetDirectoryPageId(Hash(key));
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return 0;
+  }
+  auto guard = bpm_->FetchPageRead(directory_page_id, AccessType::Index);
+  return guard.As<ExtendibleHashDirectoryPage>()->GetGlobalDepth();
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) const -> bool {
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(HashIndexKey(key, comparator_))) {
+    return false;
+  }
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    if (bloom_filter_ != nullptr) {
+      bloom_filter_->RecordFalsePositive();
+    }
+    return false;
+  }
+  auto directory_guard = bpm_->FetchPageRead(directory_page_id, AccessType::Index);
+  if (!directory_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: directory page {} cannot be fetched", index_name_, directory_page_id));
+  }
+  auto directory = directory_guard.As<ExtendibleHashDirectoryPage>();
+  page_id_t bucket_page_id = directory->GetBucketPageId(directory->HashToBucketIndex(hash));
+  auto bucket_guard = bpm_->FetchPageRead(bucket_page_id, AccessType::Index);
+  directory_guard.Drop();
+  if (!bucket_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: bucket page {} cannot be fetched", index_name_, bucket_page_id));
+  }
+
+  ValueType value;
+  if (!bucket_guard.As<BucketPage>()->Lookup(hash, key, &value, comparator_)) {
+    if (bloom_filter_ != nullptr) {
+      bloom_filter_->RecordFalsePositive();
+    }
+    return false;
+  }
+  result->push_back(value);
+  return true;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::NewPage(page_id_t *page_id) -> WritePageGuard {
+  auto guard = bpm_->NewPageGuarded(page_id, AccessType::Index);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("index {}: no free frame in the buffer pool for a new page", index_name_));
+  }
+  return guard.UpgradeWrite();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::NewDirectory() -> page_id_t {
+  page_id_t directory_page_id;
+  WritePageGuard directory_guard = NewPage(&directory_page_id);
+  auto directory = directory_guard.AsMut<ExtendibleHashDirectoryPage>();
+  directory->Init(directory_max_depth_);
+
+  page_id_t bucket_page_id;
+  WritePageGuard bucket_guard = NewPage(&bucket_page_id);
+  bucket_guard.AsMut<BucketPage>()->Init(bucket_max_size_);
+  directory->SetBucketPageId(0, bucket_page_id);
+  directory->SetLocalDepth(0, 0);
+  return directory_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  // before the key becomes visible, so that a lookup finding it in the index also passes the filter
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(HashIndexKey(key, comparator_));
+  }
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return InsertPessimistic(key, value, hash);
+  }
+
+  // a bucket with room takes the key under the directory's read latch, as it cannot split
+  auto directory_guard = bpm_->FetchPageRead(directory_page_id, AccessType::Index);
+  if (!directory_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: directory page {} cannot be fetched", index_name_, directory_page_id));
+  }
+  auto directory = directory_guard.As<ExtendibleHashDirectoryPage>();
+  page_id_t bucket_page_id = directory->GetBucketPageId(directory->HashToBucketIndex(hash));
+  auto bucket_guard = bpm_->FetchPageWrite(bucket_page_id, AccessType::Index);
+  directory_guard.Drop();
+  auto bucket = bucket_guard.AsMut<BucketPage>();
+  if (!bucket->IsFull()) {
+    return bucket->Insert(hash, key, value, comparator_);
+  }
+  ValueType existing;
+  if (bucket->Lookup(hash, key, &existing, comparator_)) {
+    return false;
+  }
+  bucket_guard.Drop();
+  return InsertPessimistic(key, value, hash);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::InsertPessimistic(const KeyType &key, const ValueType &value, uint32_t hash)
+    -> bool {
+  page_id_t directory_page_id = GetDirectoryPageId(hash);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    // first key of its directory, the header is write latched to create it, checking again that nobody else did
+    auto header_guard = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
+    auto header = header_guard.AsMut<ExtendibleHashHeaderPage>();
+    uint32_t directory_idx = header->HashToDirectoryIndex(hash);
+    directory_page_id = header->GetDirectoryPageId(directory_idx);
+    if (directory_page_id == INVALID_PAGE_ID) {
+      directory_page_id = NewDirectory();
+      header->SetDirectoryPageId(directory_idx, directory_page_id);
+    }
+  }
+
+  auto directory_guard = bpm_->FetchPageWrite(directory_page_id, AccessType::Index);
+  if (!directory_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: directory page {} cannot be fetched", index_name_, directory_page_id));
+  }
+  auto directory = directory_guard.AsMut<ExtendibleHashDirectoryPage>();
+  while (true) {
+    uint32_t bucket_idx = directory->HashToBucketIndex(hash);
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    auto bucket_guard = bpm_->FetchPageWrite(bucket_page_id, AccessType::Index);
+    auto bucket = bucket_guard.AsMut<BucketPage>();
+    if (!bucket->IsFull()) {
+      return bucket->Insert(hash, key, value, comparator_);
+    }
+    ValueType existing;
+    if (bucket->Lookup(hash, key, &existing, comparator_)) {
+      return false;
+    }
+
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (local_depth == directory->GetGlobalDepth()) {
+      if (local_depth == directory->GetMaxDepth()) {
+        throw Exception(
+            fmt::format("index {}: bucket of hash {:#010x} is full at max depth {}", index_name_, hash, local_depth));
+      }
+      directory->IncrGlobalDepth();
+    }
+
+    // the entries whose next hash bit is set move to the split image, and so do the slots
+    page_id_t image_page_id;
+    WritePageGuard image_guard = NewPage(&image_page_id);
+    auto image = image_guard.AsMut<BucketPage>();
+    image->Init(bucket_max_size_);
+    uint32_t bit = 1U << local_depth;
+    bucket->SplitTo(image, bit);
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      if (directory->GetBucketPageId(i) == bucket_page_id) {
+        directory->SetLocalDepth(i, local_depth + 1);
+        if ((i & bit) != 0) {
+          directory->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    // all the entries may have landed on one side, in which case the loop splits again
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+auto EXTENDIBLE_HASH_INDEX_TYPE::Remove(const KeyType &key) -> bool {
+  uint32_t hash = Hash(key);
+  page_id_t directory_page_id = GetDirectoryPageId(hash);
+  if (directory_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto directory_guard = bpm_->FetchPageRead(directory_page_id, AccessType::Index);
+  if (!directory_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: directory page {} cannot be fetched", index_name_, directory_page_id));
+  }
+  auto directory = directory_guard.As<ExtendibleHashDirectoryPage>();
+  uint32_t bucket_idx = directory->HashToBucketIndex(hash);
+  page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+  bool can_merge = directory->GetLocalDepth(bucket_idx) > 0;
+  auto bucket_guard = bpm_->FetchPageWrite(bucket_page_id, AccessType::Index);
+  directory_guard.Drop();
+
+  auto bucket = bucket_guard.AsMut<BucketPage>();
+  if (!bucket->Remove(hash, key, comparator_)) {
+    return false;
+  }
+  bool is_empty = bucket->IsEmpty();
+  bucket_guard.Drop();
+  if (is_empty && can_merge) {
+    MergeBuckets(directory_page_id, hash);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_INDEX_TYPE::MergeBuckets(page_id_t directory_page_id, uint32_t hash) {
+  auto directory_guard = bpm_->FetchPageWrite(directory_page_id, AccessType::Index);
+  if (!directory_guard.IsValid()) {
+    throw Exception(fmt::format("index {}: directory page {} cannot be fetched", index_name_, directory_page_id));
+  }
+  auto directory = directory_guard.AsMut<ExtendibleHashDirectoryPage>();
+  uint32_t bucket_idx = directory->HashToBucketIndex(hash);
+  while (true) {
+    // the bucket may have been refilled, merged or split since the removal released it: check again
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (local_depth == 0 || directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    // with the directory write latched, nobody else latches two buckets: no order to follow between them
+    auto bucket_guard = bpm_->FetchPageWrite(bucket_page_id, AccessType::Index);
+    auto image_guard = bpm_->FetchPageWrite(image_page_id, AccessType::Index);
+    bool bucket_empty = bucket_guard.As<BucketPage>()->IsEmpty();
+    if (!bucket_empty && !image_guard.As<BucketPage>()->IsEmpty()) {
+      break;
+    }
+    bucket_guard.Drop();
+    image_guard.Drop();
+
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    page_id_t freed_page_id = bucket_empty ? bucket_page_id : image_page_id;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      page_id_t page_id = directory->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        directory->SetBucketPageId(i, kept_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    FreePage(freed_page_id);
+    // the merged bucket may in turn have an empty split image
+    bucket_idx &= (1U << (local_depth - 1)) - 1;
+  }
+  while (directory->CanShrink()) {
+    directory->DecrGlobalDepth();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_INDEX_TYPE::FreePage(page_id_t page_id) {
+  // a reader that latched the bucket before the merge may still have it pinned, in which case the page is leaked
+  for (int attempt = 0; attempt < 16; attempt++) {
+    if (bpm_->DeletePage(page_id)) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+}
+
+template class ExtendibleHashIndex<int32_t, RID, IntegerComparator<int32_t>>;
+template class ExtendibleHashIndex<int64_t, RID, IntegerComparator<int64_t>>;
+template class ExtendibleHashIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace redbase
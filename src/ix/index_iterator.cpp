@@ -0,0 +1,94 @@
+#include "ix/index_iterator.h"
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "ix/covering_value.h"
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, ReadPageGuard guard, int index)
+    : bpm_(bpm), guard_(std::move(guard)), index_(index) {
+  page_id_ = guard_.PageId();
+  SkipExhaustedLeaves();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> std::pair<KeyType, ValueType> {
+  return guard_.template As<LeafPage>()->GetItem(index_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> IndexIterator & {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (guard_.IsValid()) {
+    auto leaf = guard_.template As<LeafPage>();
+    if (index_ < leaf->GetSize()) {
+      return;
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      guard_.Drop();
+      page_id_ = INVALID_PAGE_ID;
+      index_ = 0;
+      return;
+    }
+    // latch coupling: the next leaf is latched before the current one is released
+    ReadPageGuard next_guard = bpm_->FetchPageRead(next_page_id, AccessType::Scan);
+    if (!next_guard.IsValid()) {
+      throw Exception(fmt::format("index iterator: leaf {} cannot be fetched", next_page_id));
+    }
+    guard_ = std::move(next_guard);
+    page_id_ = next_page_id;
+    index_ = 0;
+  }
+}
+
+template class IndexIterator<int32_t, RID, IntegerComparator<int32_t>>;
+template class IndexIterator<int64_t, RID, IntegerComparator<int64_t>>;
+template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<NonUniqueKey<GenericKey<8>>, RID,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<16>>, RID,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<32>>, RID,
+                             NonUniqueComparator<GenericKey<32>, GenericComparator<32>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<64>>, RID,
+                             NonUniqueComparator<GenericKey<64>, GenericComparator<64>>>;
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class IndexIterator<NormalizedKey<128>, RID, NormalizedComparator<128>>;
+
+template class IndexIterator<GenericKey<8>, CoveringValue<16>, GenericComparator<8>>;
+template class IndexIterator<GenericKey<8>, CoveringValue<32>, GenericComparator<8>>;
+template class IndexIterator<GenericKey<8>, CoveringValue<64>, GenericComparator<8>>;
+template class IndexIterator<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+template class IndexIterator<GenericKey<16>, CoveringValue<32>, GenericComparator<16>>;
+template class IndexIterator<GenericKey<16>, CoveringValue<64>, GenericComparator<16>>;
+template class IndexIterator<NonUniqueKey<GenericKey<8>>, CoveringValue<16>,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<8>>, CoveringValue<32>,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<8>>, CoveringValue<64>,
+                             NonUniqueComparator<GenericKey<8>, GenericComparator<8>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<16>>, CoveringValue<16>,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<16>>, CoveringValue<32>,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+template class IndexIterator<NonUniqueKey<GenericKey<16>>, CoveringValue<64>,
+                             NonUniqueComparator<GenericKey<16>, GenericComparator<16>>>;
+
+}  // namespace redbase
@@ -0,0 +1,140 @@
+#include "ix/lsm_iterator.h"
+
+#include <cstring>
+
+#include "common/rid.h"
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_MERGE_ITERATOR_TYPE::LSMMergeIterator(const std::vector<const MemTable *> &memtables,
+                                          const std::vector<const Run *> &runs, const KeyComparator &comparator)
+    : comparator_(comparator) {
+  sources_.reserve(memtables.size() + runs.size());
+  for (const auto *memtable : memtables) {
+    sources_.push_back({true, typename MemTable::Iterator(memtable), {}});
+  }
+  for (const auto *run : runs) {
+    sources_.push_back({false, {}, typename Run::Iterator(run)});
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MERGE_ITERATOR_TYPE::Seek(const KeyType &key) {
+  for (auto &source : sources_) {
+    if (source.is_memtable_) {
+      source.memtable_it_.Seek(key);
+    } else {
+      source.run_it_.Seek(key);
+    }
+  }
+  FindCurrent();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MERGE_ITERATOR_TYPE::SeekToFirst() {
+  for (auto &source : sources_) {
+    if (source.is_memtable_) {
+      source.memtable_it_.SeekToFirst();
+    } else {
+      source.run_it_.SeekToFirst();
+    }
+  }
+  FindCurrent();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MERGE_ITERATOR_TYPE::Next() {
+  KeyType key = Key();
+  // the current key leaves every source that has it, the older entries are shadowed
+  for (auto &source : sources_) {
+    if (!source.IsValid() || comparator_(source.Key(), key) != 0) {
+      continue;
+    }
+    if (source.is_memtable_) {
+      source.memtable_it_.Next();
+    } else {
+      source.run_it_.Next();
+    }
+  }
+  FindCurrent();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MERGE_ITERATOR_TYPE::FindCurrent() {
+  // there are a handful of sources, a linear pass beats maintaining a heap; ties go to the newer source
+  current_ = -1;
+  for (int i = 0; i < static_cast<int>(sources_.size()); i++) {
+    if (sources_[i].IsValid() && (current_ < 0 || comparator_(sources_[i].Key(), Key()) < 0)) {
+      current_ = i;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_ITERATOR_TYPE::LSMIterator(std::shared_ptr<const Version> version, const KeyComparator &comparator,
+                               const KeyType *start)
+    : version_(std::move(version)) {
+  std::vector<const LSM_MEMTABLE_TYPE *> memtables{version_->memtable_.get()};
+  for (const auto &memtable : version_->immutables_) {
+    memtables.push_back(memtable.get());
+  }
+  std::vector<const LSM_RUN_TYPE *> runs;
+  for (const auto &level : version_->levels_) {
+    for (const auto &run : level) {
+      runs.push_back(run.get());
+    }
+  }
+  merge_ = std::make_unique<LSM_MERGE_ITERATOR_TYPE>(memtables, runs, comparator);
+  if (start != nullptr) {
+    merge_->Seek(*start);
+  } else {
+    merge_->SeekToFirst();
+  }
+  SkipDeleted();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_ITERATOR_TYPE::operator++() -> LSMIterator & {
+  merge_->Next();
+  SkipDeleted();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_ITERATOR_TYPE::operator==(const LSMIterator &itr) const -> bool {
+  if (IsEnd() || itr.IsEnd()) {
+    return IsEnd() == itr.IsEnd();
+  }
+  return version_ == itr.version_ && memcmp(&merge_->Key(), &itr.merge_->Key(), sizeof(KeyType)) == 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_ITERATOR_TYPE::SkipDeleted() {
+  while (merge_->IsValid() && merge_->IsDeleted()) {
+    merge_->Next();
+  }
+  if (!merge_->IsValid()) {
+    merge_.reset();
+    version_.reset();
+  }
+}
+
+template class LSMMergeIterator<int32_t, RID, IntegerComparator<int32_t>>;
+template class LSMMergeIterator<int64_t, RID, IntegerComparator<int64_t>>;
+template class LSMMergeIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMMergeIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMMergeIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMMergeIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMMergeIterator<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class LSMIterator<int32_t, RID, IntegerComparator<int32_t>>;
+template class LSMIterator<int64_t, RID, IntegerComparator<int64_t>>;
+template class LSMIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMIterator<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace redbase
@@ -0,0 +1,141 @@
+#include "ix/lsm_memtable.h"
+
+#include <limits>
+#include <new>
+
+#include "common/rid.h"
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+/** Sequence number of a lookup: larger than every version, so that a search stops on the latest one. */
+static constexpr uint64_t LATEST_SEQ = std::numeric_limits<uint64_t>::max();
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_MEMTABLE_TYPE::LSMMemTable(const KeyComparator &comparator) : comparator_(comparator) {
+  head_ = NewNode(KeyType{}, ValueType{}, false, MAX_HEIGHT);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_MEMTABLE_TYPE::~LSMMemTable() {
+  Node *node = head_;
+  while (node != nullptr) {
+    Node *next = node->Next(0);
+    ::operator delete(node);
+    node = next;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_MEMTABLE_TYPE::NewNode(const KeyType &key, const ValueType &value, bool deleted, int height) -> Node * {
+  void *memory = ::operator new(sizeof(Node) + (height - 1) * sizeof(std::atomic<Node *>));
+  auto node = static_cast<Node *>(memory);
+  node->key_ = key;
+  node->value_ = value;
+  node->seq_ = 0;
+  node->deleted_ = deleted;
+  for (int level = 0; level < height; level++) {
+    new (&node->next_[level]) std::atomic<Node *>(nullptr);
+  }
+  return node;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_MEMTABLE_TYPE::RandomHeight() -> int {
+  // one node in four moves up a level
+  int height = 1;
+  while (height < MAX_HEIGHT && rng_() % 4 == 0) {
+    height++;
+  }
+  return height;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_MEMTABLE_TYPE::IsBefore(const Node *node, const KeyType &key, uint64_t seq) const -> bool {
+  int cmp = comparator_(node->key_, key);
+  return cmp < 0 || (cmp == 0 && node->seq_ > seq);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_MEMTABLE_TYPE::FindGreaterOrEqual(const KeyType &key, uint64_t seq, Node **prev) const -> Node * {
+  Node *node = head_;
+  int level = height_.load(std::memory_order_relaxed) - 1;
+  while (true) {
+    Node *next = node->Next(level);
+    if (next != nullptr && IsBefore(next, key, seq)) {
+      node = next;
+      continue;
+    }
+    if (prev != nullptr) {
+      prev[level] = node;
+    }
+    if (level == 0) {
+      return next;
+    }
+    level--;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MEMTABLE_TYPE::Put(const KeyType &key, const ValueType &value, bool deleted) {
+  uint64_t seq = next_seq_++;
+  Node *prev[MAX_HEIGHT];
+  FindGreaterOrEqual(key, seq, prev);
+
+  int height = RandomHeight();
+  int old_height = height_.load(std::memory_order_relaxed);
+  for (int level = old_height; level < height; level++) {
+    prev[level] = head_;
+  }
+  // readers that see the new height before the new links find null pointers at the head, which is fine
+  if (height > old_height) {
+    height_.store(height, std::memory_order_relaxed);
+  }
+
+  Node *node = NewNode(key, value, deleted, height);
+  node->seq_ = seq;
+  for (int level = 0; level < height; level++) {
+    node->next_[level].store(prev[level]->Next(level), std::memory_order_relaxed);
+    // publishes the node, filled in above, to the readers of this level
+    prev[level]->next_[level].store(node, std::memory_order_release);
+  }
+  size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_MEMTABLE_TYPE::Get(const KeyType &key, ValueType *value, bool *deleted) const -> bool {
+  Node *node = FindGreaterOrEqual(key, LATEST_SEQ, nullptr);
+  if (node == nullptr || comparator_(key, node->key_) != 0) {
+    return false;
+  }
+  *value = node->value_;
+  *deleted = node->deleted_;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MEMTABLE_TYPE::Iterator::Seek(const KeyType &key) {
+  node_ = memtable_->FindGreaterOrEqual(key, LATEST_SEQ, nullptr);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MEMTABLE_TYPE::Iterator::SeekToFirst() { node_ = memtable_->head_->Next(0); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_MEMTABLE_TYPE::Iterator::Next() {
+  const Node *node = node_->Next(0);
+  while (node != nullptr && memtable_->comparator_(node->key_, node_->key_) == 0) {
+    node = node->Next(0);
+  }
+  node_ = node;
+}
+
+template class LSMMemTable<int32_t, RID, IntegerComparator<int32_t>>;
+template class LSMMemTable<int64_t, RID, IntegerComparator<int64_t>>;
+template class LSMMemTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMMemTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMMemTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMMemTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMMemTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace redbase
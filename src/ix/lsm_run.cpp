@@ -0,0 +1,309 @@
+#include "ix/lsm_run.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+namespace {
+
+/**
+ * Fence page format, a chain of them holds the fence pointers of a run:
+ *  -------------------------------------------------------------------------------------------------
+ *  | NextPageId (4) | Count (4) | NumEntries (8) | KEY(1) | ... | KEY(n) | PAGE_ID(1) | ... | PAGE_ID(n) |
+ *  -------------------------------------------------------------------------------------------------
+ * NumEntries, the number of entries of the run, is only meaningful on the first page.
+ */
+template <typename KeyType>
+struct LSMFencePage {
+  static constexpr size_t CAPACITY = (PAGE_SIZE - 16 - alignof(KeyType)) / (sizeof(KeyType) + sizeof(page_id_t));
+
+  page_id_t next_page_id_;
+  uint32_t count_;
+  uint64_t num_entries_;
+  KeyType keys_[CAPACITY];
+  page_id_t page_ids_[CAPACITY];
+};
+
+/** Write a finished page out right away: runs are written once, in page order. */
+void FlushGuard(BufferPoolManager *bpm, WritePageGuard *guard) {
+  page_id_t page_id = guard->PageId();
+  guard->Drop();
+  bpm->FlushPage(page_id);
+}
+
+auto NewWritePage(BufferPoolManager *bpm, page_id_t *page_id) -> WritePageGuard {
+  auto basic_guard = bpm->NewPageGuarded(page_id, AccessType::Index);
+  if (!basic_guard.IsValid()) {
+    throw Exception("cannot write lsm run: no free frame in the buffer pool");
+  }
+  return basic_guard.UpgradeWrite();
+}
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_RUN_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(keys_[mid], key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_PAGE_TYPE::Append(const KeyType &key, const ValueType &value, bool deleted) {
+  static_assert(sizeof(LSMRunPage) <= PAGE_SIZE, "a run page must fit into a page");
+  REDBASE_ASSERT(!IsFull(), "append to a full run page");
+  keys_[size_] = key;
+  values_[size_] = value;
+  deleted_[size_] = deleted ? 1 : 0;
+  size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_RUN_TYPE::Builder::Builder(BufferPoolManager *bpm, const KeyComparator &comparator, size_t expected_entries,
+                               double bloom_false_positive_rate)
+    : run_(new LSMRun(bpm, comparator)) {
+  if (bloom_false_positive_rate > 0) {
+    BloomFilterOptions options;
+    options.expected_keys_ = std::max<size_t>(expected_entries, 1);
+    options.false_positive_rate_ = bloom_false_positive_rate;
+    run_->bloom_filter_ = std::make_unique<BloomFilter>(bpm, options);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_TYPE::Builder::Add(const KeyType &key, const ValueType &value, bool deleted) {
+  REDBASE_ASSERT(run_->num_entries_ == 0 || run_->comparator_(run_->last_key_, key) < 0,
+                 "run entries must come in strictly increasing key order");
+  if (guard_.IsValid() && guard_.As<RunPage>()->IsFull()) {
+    FinishPage();
+  }
+  if (!guard_.IsValid()) {
+    page_id_t page_id;
+    guard_ = NewWritePage(run_->bpm_, &page_id);
+    guard_.AsMut<RunPage>()->Init();
+    run_->fence_keys_.push_back(key);
+    run_->page_ids_.push_back(page_id);
+  }
+  guard_.AsMut<RunPage>()->Append(key, value, deleted);
+  if (run_->bloom_filter_ != nullptr) {
+    run_->bloom_filter_->Insert(HashIndexKey(key, run_->comparator_));
+  }
+  run_->last_key_ = key;
+  run_->num_entries_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_TYPE::Builder::FinishPage() {
+  FlushGuard(run_->bpm_, &guard_);
+  run_->num_pages_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_RUN_TYPE::Builder::Finish() -> std::shared_ptr<LSMRun> {
+  if (guard_.IsValid()) {
+    FinishPage();
+  }
+  if (run_->num_entries_ == 0) {
+    return nullptr;
+  }
+  run_->WriteFences();
+  if (run_->bloom_filter_ != nullptr) {
+    run_->bloom_filter_->Flush();
+    // a filter page holds a header and 63 blocks
+    size_t blocks_per_page = PAGE_SIZE / BloomFilter::BLOCK_SIZE - 1;
+    run_->num_pages_ += (run_->bloom_filter_->GetNumBlocks() + blocks_per_page - 1) / blocks_per_page;
+  }
+  return std::move(run_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_RUN_TYPE::LSMRun(BufferPoolManager *bpm, const KeyComparator &comparator) : bpm_(bpm), comparator_(comparator) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_RUN_TYPE::LSMRun(BufferPoolManager *bpm, const KeyComparator &comparator, page_id_t fence_page_id,
+                     page_id_t bloom_page_id)
+    : bpm_(bpm), comparator_(comparator) {
+  using FencePage = LSMFencePage<KeyType>;
+  page_id_t page_id = fence_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageRead(page_id, AccessType::Index);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("cannot load lsm run: fence page {} cannot be fetched", page_id));
+    }
+    auto page = guard.As<FencePage>();
+    if (page_id == fence_page_id) {
+      num_entries_ = page->num_entries_;
+    }
+    fence_keys_.insert(fence_keys_.end(), page->keys_, page->keys_ + page->count_);
+    page_ids_.insert(page_ids_.end(), page->page_ids_, page->page_ids_ + page->count_);
+    fence_page_ids_.push_back(page_id);
+    page_id = page->next_page_id_;
+  }
+  if (page_ids_.empty() || num_entries_ == 0) {
+    throw Exception(fmt::format("cannot load lsm run: fence page {} holds no data page", fence_page_id));
+  }
+
+  ReadPageGuard guard = FetchDataPage(page_ids_.size() - 1, AccessType::Index);
+  auto last_page = guard.As<RunPage>();
+  last_key_ = last_page->KeyAt(last_page->GetSize() - 1);
+  num_pages_ = page_ids_.size() + fence_page_ids_.size();
+  if (bloom_page_id != INVALID_PAGE_ID) {
+    bloom_filter_ = std::make_unique<BloomFilter>(bpm_, bloom_page_id);
+    size_t blocks_per_page = PAGE_SIZE / BloomFilter::BLOCK_SIZE - 1;
+    num_pages_ += (bloom_filter_->GetNumBlocks() + blocks_per_page - 1) / blocks_per_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSM_RUN_TYPE::~LSMRun() {
+  if (!obsolete_) {
+    return;
+  }
+  for (page_id_t page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+  for (page_id_t page_id : fence_page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->DeletePages();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_TYPE::WriteFences() {
+  using FencePage = LSMFencePage<KeyType>;
+  static_assert(sizeof(FencePage) <= PAGE_SIZE, "a fence page must fit into a page");
+  WritePageGuard prev_guard;
+  size_t written = 0;
+  while (written < page_ids_.size()) {
+    page_id_t page_id;
+    WritePageGuard guard = NewWritePage(bpm_, &page_id);
+    auto page = guard.AsMut<FencePage>();
+    size_t count = std::min(FencePage::CAPACITY, page_ids_.size() - written);
+    page->next_page_id_ = INVALID_PAGE_ID;
+    page->count_ = static_cast<uint32_t>(count);
+    page->num_entries_ = num_entries_;
+    std::copy_n(fence_keys_.begin() + written, count, page->keys_);
+    std::copy_n(page_ids_.begin() + written, count, page->page_ids_);
+    written += count;
+
+    if (prev_guard.IsValid()) {
+      prev_guard.AsMut<FencePage>()->next_page_id_ = page_id;
+      FlushGuard(bpm_, &prev_guard);
+    }
+    fence_page_ids_.push_back(page_id);
+    num_pages_++;
+    prev_guard = std::move(guard);
+  }
+  FlushGuard(bpm_, &prev_guard);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_RUN_TYPE::FindPage(const KeyType &key) const -> size_t {
+  auto it = std::upper_bound(fence_keys_.begin(), fence_keys_.end(), key,
+                             [&](const KeyType &a, const KeyType &b) { return comparator_(a, b) < 0; });
+  return it == fence_keys_.begin() ? 0 : static_cast<size_t>(it - fence_keys_.begin()) - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_RUN_TYPE::FetchDataPage(size_t page_idx, AccessType access_type) const -> ReadPageGuard {
+  auto guard = bpm_->FetchPageRead(page_ids_[page_idx], access_type);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("lsm run: data page {} cannot be fetched", page_ids_[page_idx]));
+  }
+  return guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_RUN_TYPE::MayContain(const KeyType &key) const -> bool {
+  if (comparator_(key, fence_keys_[0]) < 0 || comparator_(key, last_key_) > 0) {
+    return false;
+  }
+  return bloom_filter_ == nullptr || bloom_filter_->MayContain(HashIndexKey(key, comparator_));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSM_RUN_TYPE::Get(const KeyType &key, ValueType *value, bool *deleted) const -> bool {
+  ReadPageGuard guard = FetchDataPage(FindPage(key), AccessType::Lookup);
+  auto page = guard.As<RunPage>();
+  int index = page->KeyIndex(key, comparator_);
+  if (index < page->GetSize() && comparator_(page->KeyAt(index), key) == 0) {
+    *value = page->ValueAt(index);
+    *deleted = page->IsDeletedAt(index);
+    return true;
+  }
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->RecordFalsePositive();
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_TYPE::Iterator::Seek(const KeyType &key) {
+  size_t page_idx = run_->FindPage(key);
+  LoadPage(page_idx, 0);
+  if (guard_.IsValid() && page_idx_ == page_idx) {
+    index_ = page_->KeyIndex(key, run_->comparator_);
+    if (index_ >= page_->GetSize()) {
+      LoadPage(page_idx + 1, 0);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_TYPE::Iterator::Next() {
+  index_++;
+  if (index_ >= page_->GetSize()) {
+    LoadPage(page_idx_ + 1, 0);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSM_RUN_TYPE::Iterator::LoadPage(size_t page_idx, int index) {
+  const auto &page_ids = run_->page_ids_;
+  if (page_idx >= page_ids.size()) {
+    guard_.Drop();
+    return;
+  }
+  // the pages of a run are read in order: keep the next few of them on their way in
+  prefetched_ = std::max(prefetched_, page_idx + 1);
+  while (prefetched_ < page_ids.size() && prefetched_ <= page_idx + SCAN_READ_AHEAD) {
+    run_->bpm_->PrefetchPage(page_ids[prefetched_++]);
+  }
+  guard_ = run_->FetchDataPage(page_idx, AccessType::Scan);
+  page_ = guard_.As<RunPage>();
+  page_idx_ = page_idx;
+  index_ = index;
+}
+
+template class LSMRunPage<int32_t, RID, IntegerComparator<int32_t>>;
+template class LSMRunPage<int64_t, RID, IntegerComparator<int64_t>>;
+template class LSMRunPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMRunPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMRunPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMRunPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMRunPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class LSMRun<int32_t, RID, IntegerComparator<int32_t>>;
+template class LSMRun<int64_t, RID, IntegerComparator<int64_t>>;
+template class LSMRun<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMRun<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMRun<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMRun<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMRun<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace redbase
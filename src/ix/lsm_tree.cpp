@@ -0,0 +1,413 @@
+#include "ix/lsm_tree.h"
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "fmt/format.h"
+#include "ix/generic_key.h"
+
+namespace redbase {
+
+namespace {
+
+struct LSMRunEntry {
+  uint32_t level_;
+  page_id_t fence_page_id_;
+  page_id_t bloom_page_id_;
+  uint32_t reserved_;
+};
+
+/**
+ * Header page format, the runs of the tree in lookup order (level 0 newest first, then the deeper levels):
+ *  -----------------------------------------------------------------------------------
+ *  | NumRuns (4) | Reserved (4) | Level, FencePageId, BloomPageId, Reserved (16) | ... |
+ *  -----------------------------------------------------------------------------------
+ */
+struct LSMHeaderPage {
+  static constexpr size_t MAX_RUNS = (PAGE_SIZE - 8) / sizeof(LSMRunEntry);
+
+  uint32_t num_runs_;
+  uint32_t reserved_;
+  LSMRunEntry runs_[MAX_RUNS];
+};
+
+}  // namespace
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::LSMTree(std::string name, BufferPoolManager *bpm, const KeyComparator &comparator, LSMOptions options)
+    : index_name_(std::move(name)), bpm_(bpm), comparator_(comparator), options_(options) {
+  auto guard = bpm_->NewPageGuarded(&header_page_id_);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot create index {}: no free frame in the buffer pool", index_name_));
+  }
+  guard.AsMut<LSMHeaderPage>()->num_runs_ = 0;
+  auto version = std::make_shared<Version>();
+  version->memtable_ = std::make_shared<MemTable>(comparator_);
+  version->levels_.resize(1);
+  current_ = std::move(version);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::LSMTree(std::string name, page_id_t header_page_id, BufferPoolManager *bpm,
+                      const KeyComparator &comparator, LSMOptions options)
+    : index_name_(std::move(name)), bpm_(bpm), comparator_(comparator), options_(options),
+      header_page_id_(header_page_id) {
+  auto version = std::make_shared<Version>();
+  version->memtable_ = std::make_shared<MemTable>(comparator_);
+  version->levels_.resize(1);
+  auto guard = bpm_->FetchPageRead(header_page_id_, AccessType::Index);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot open index {}: header page cannot be fetched", index_name_));
+  }
+  auto header = guard.As<LSMHeaderPage>();
+  for (uint32_t i = 0; i < header->num_runs_; i++) {
+    const auto &entry = header->runs_[i];
+    if (version->levels_.size() <= entry.level_) {
+      version->levels_.resize(entry.level_ + 1);
+    }
+    version->levels_[entry.level_].push_back(
+        std::make_shared<SortedRun>(bpm_, comparator_, entry.fence_page_id_, entry.bloom_page_id_));
+  }
+  current_ = std::move(version);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+LSMTREE_TYPE::~LSMTree() { Stop(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::CurrentVersion() const -> std::shared_ptr<const Version> {
+  std::lock_guard<std::mutex> lk(version_latch_);
+  return current_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::UpdateVersion(const std::function<void(Version *)> &update) {
+  // writers and maintenance change disjoint parts of the version, the copy and the swap must not interleave
+  std::lock_guard<std::mutex> lk(version_latch_);
+  auto version = std::make_shared<Version>(*current_);
+  update(version.get());
+  current_ = std::move(version);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Lookup(const Version &version, const KeyType &key, ValueType *value, bool *deleted) const
+    -> bool {
+  if (version.memtable_->Get(key, value, deleted)) {
+    return true;
+  }
+  for (const auto &memtable : version.immutables_) {
+    if (memtable->Get(key, value, deleted)) {
+      return true;
+    }
+  }
+  for (const auto &level : version.levels_) {
+    for (const auto &run : level) {
+      if (!run->MayContain(key)) {
+        runs_skipped_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      runs_probed_.fetch_add(1, std::memory_order_relaxed);
+      if (run->Get(key, value, deleted)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) const -> bool {
+  ValueType value;
+  bool deleted;
+  if (!Lookup(*CurrentVersion(), key, &value, &deleted) || deleted) {
+    return false;
+  }
+  result->push_back(value);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Insert(const KeyType &key, const ValueType &value) -> bool {
+  std::lock_guard<std::mutex> lk(write_latch_);
+  ValueType found;
+  bool deleted;
+  if (Lookup(*CurrentVersion(), key, &found, &deleted) && !deleted) {
+    return false;
+  }
+  Write(key, value, false);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::Remove(const KeyType &key) -> bool {
+  std::lock_guard<std::mutex> lk(write_latch_);
+  ValueType found;
+  bool deleted;
+  if (!Lookup(*CurrentVersion(), key, &found, &deleted) || deleted) {
+    return false;
+  }
+  Write(key, ValueType{}, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Write(const KeyType &key, const ValueType &value, bool deleted) {
+  auto memtable = CurrentVersion()->memtable_;
+  memtable->Put(key, value, deleted);
+  entries_inserted_.fetch_add(1, std::memory_order_relaxed);
+  if (memtable->Size() < options_.memtable_max_entries_) {
+    return;
+  }
+  FreezeMemTable();
+
+  bool background;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    background = background_thread_.has_value();
+  }
+  if (background && CurrentVersion()->immutables_.size() <= MAX_IMMUTABLES) {
+    cv_.notify_one();
+    return;
+  }
+  // without a background thread, or with one that fell behind, the writer does the work, which throttles the writes
+  std::lock_guard<std::mutex> lk(maintenance_latch_);
+  while (FlushImmutable() || CompactLevel()) {
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::FreezeMemTable() {
+  auto memtable = std::make_shared<MemTable>(comparator_);
+  UpdateVersion([&](Version *version) {
+    version->immutables_.insert(version->immutables_.begin(), std::move(version->memtable_));
+    version->memtable_ = std::move(memtable);
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::FlushImmutable() -> bool {
+  auto version = CurrentVersion();
+  if (version->immutables_.empty()) {
+    return false;
+  }
+  auto memtable = version->immutables_.back();
+  // the tombstones of the first run of a tree have nothing left to shadow
+  bool bottom = true;
+  for (const auto &level : version->levels_) {
+    bottom = bottom && level.empty();
+  }
+
+  typename SortedRun::Builder builder(bpm_, comparator_, memtable->Size(), options_.bloom_false_positive_rate_);
+  typename MemTable::Iterator it(memtable.get());
+  for (it.SeekToFirst(); it.IsValid(); it.Next()) {
+    if (!(bottom && it.IsDeleted())) {
+      builder.Add(it.Key(), it.Value(), it.IsDeleted());
+    }
+  }
+  auto run = builder.Finish();
+
+  UpdateVersion([&](Version *new_version) {
+    new_version->immutables_.pop_back();
+    if (run != nullptr) {
+      new_version->levels_[0].insert(new_version->levels_[0].begin(), run);
+    }
+  });
+  WriteHeader(*CurrentVersion());
+  if (run != nullptr) {
+    entries_written_.fetch_add(run->GetNumEntries(), std::memory_order_relaxed);
+    pages_written_.fetch_add(run->GetNumPages(), std::memory_order_relaxed);
+  }
+  flushes_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::LevelCapacity(size_t level) const -> size_t {
+  size_t capacity = options_.memtable_max_entries_ * options_.level0_max_runs_;
+  for (size_t i = 0; i < level; i++) {
+    capacity *= options_.level_size_ratio_;
+  }
+  return capacity;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::CompactLevel() -> bool {
+  auto version = CurrentVersion();
+  const auto &levels = version->levels_;
+  size_t source = levels.size();
+  if (levels[0].size() >= options_.level0_max_runs_) {
+    source = 0;
+  } else {
+    for (size_t level = 1; level < levels.size(); level++) {
+      if (!levels[level].empty() && levels[level][0]->GetNumEntries() > LevelCapacity(level)) {
+        source = level;
+        break;
+      }
+    }
+  }
+  if (source == levels.size()) {
+    return false;
+  }
+  size_t target = source + 1;
+
+  // the runs of the source level are newer than the run of the target level, and level 0 is ordered newest first
+  std::vector<std::shared_ptr<SortedRun>> inputs = levels[source];
+  if (target < levels.size()) {
+    inputs.insert(inputs.end(), levels[target].begin(), levels[target].end());
+  }
+  std::vector<const SortedRun *> runs;
+  size_t expected_entries = 0;
+  for (const auto &run : inputs) {
+    runs.push_back(run.get());
+    expected_entries += run->GetNumEntries();
+  }
+  bool bottom = true;
+  for (size_t level = target + 1; level < levels.size(); level++) {
+    bottom = bottom && levels[level].empty();
+  }
+
+  LSM_MERGE_ITERATOR_TYPE merge({}, runs, comparator_);
+  typename SortedRun::Builder builder(bpm_, comparator_, expected_entries, options_.bloom_false_positive_rate_);
+  for (merge.SeekToFirst(); merge.IsValid(); merge.Next()) {
+    if (!(bottom && merge.IsDeleted())) {
+      builder.Add(merge.Key(), merge.Value(), merge.IsDeleted());
+    }
+  }
+  auto run = builder.Finish();
+
+  // only maintenance changes the levels, which still are those the inputs were taken from
+  UpdateVersion([&](Version *new_version) {
+    new_version->levels_[source].clear();
+    if (new_version->levels_.size() <= target) {
+      new_version->levels_.resize(target + 1);
+    }
+    new_version->levels_[target].clear();
+    if (run != nullptr) {
+      new_version->levels_[target].push_back(run);
+    }
+  });
+  WriteHeader(*CurrentVersion());
+  // the pages of the inputs go once their last reader is done with them
+  for (const auto &input : inputs) {
+    input->MarkObsolete();
+  }
+  if (run != nullptr) {
+    entries_written_.fetch_add(run->GetNumEntries(), std::memory_order_relaxed);
+    pages_written_.fetch_add(run->GetNumPages(), std::memory_order_relaxed);
+  }
+  compactions_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::WriteHeader(const Version &version) {
+  size_t num_runs = 0;
+  for (const auto &level : version.levels_) {
+    num_runs += level.size();
+  }
+  if (num_runs > LSMHeaderPage::MAX_RUNS) {
+    throw Exception(fmt::format("index {}: {} runs do not fit into the header page", index_name_, num_runs));
+  }
+  auto guard = bpm_->FetchPageWrite(header_page_id_, AccessType::Index);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("index {}: header page cannot be fetched", index_name_));
+  }
+  auto header = guard.AsMut<LSMHeaderPage>();
+  header->num_runs_ = 0;
+  for (size_t level = 0; level < version.levels_.size(); level++) {
+    for (const auto &run : version.levels_[level]) {
+      header->runs_[header->num_runs_++] = {static_cast<uint32_t>(level), run->GetFencePageId(), run->GetBloomPageId(),
+                                            0};
+    }
+  }
+  guard.Drop();
+  bpm_->FlushPage(header_page_id_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Flush() {
+  {
+    std::lock_guard<std::mutex> lk(write_latch_);
+    if (CurrentVersion()->memtable_->Size() > 0) {
+      FreezeMemTable();
+    }
+  }
+  std::lock_guard<std::mutex> lk(maintenance_latch_);
+  while (FlushImmutable()) {
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::CompactOnce() -> bool {
+  std::lock_guard<std::mutex> lk(maintenance_latch_);
+  return FlushImmutable() || CompactLevel();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Start() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (background_thread_.has_value()) {
+    return;
+  }
+  stop_ = false;
+  background_thread_.emplace([&] { Run(); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!background_thread_.has_value()) {
+      return;
+    }
+    stop_ = true;
+  }
+  cv_.notify_all();
+  background_thread_->join();
+  background_thread_.reset();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void LSMTREE_TYPE::Run() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (!stop_) {
+    lk.unlock();
+    bool worked = CompactOnce();
+    lk.lock();
+    // keep going while there is work, sleep otherwise
+    if (!worked) {
+      cv_.wait_for(lk, options_.interval_, [&] { return stop_; });
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetStats() const -> LSMStats {
+  LSMStats stats;
+  stats.entries_inserted_ = entries_inserted_.load(std::memory_order_relaxed);
+  stats.entries_written_ = entries_written_.load(std::memory_order_relaxed);
+  stats.pages_written_ = pages_written_.load(std::memory_order_relaxed);
+  stats.flushes_ = flushes_.load(std::memory_order_relaxed);
+  stats.compactions_ = compactions_.load(std::memory_order_relaxed);
+  stats.runs_skipped_ = runs_skipped_.load(std::memory_order_relaxed);
+  stats.runs_probed_ = runs_probed_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto LSMTREE_TYPE::GetRunCounts() const -> std::vector<size_t> {
+  std::vector<size_t> counts;
+  for (const auto &level : CurrentVersion()->levels_) {
+    counts.push_back(level.size());
+  }
+  return counts;
+}
+
+template class LSMTree<int32_t, RID, IntegerComparator<int32_t>>;
+template class LSMTree<int64_t, RID, IntegerComparator<int64_t>>;
+template class LSMTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class LSMTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class LSMTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class LSMTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class LSMTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace redbase
@@ -0,0 +1,170 @@
+#include "ix/node_search.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace redbase {
+
+namespace {
+
+/** Bytes of keys compared linearly at the end of a SIMD search: one cache line, two AVX2 or four SSE vectors. */
+constexpr int LINEAR_WINDOW_BYTES = 64;
+
+/** @return true if `probe` comes before the position searched for */
+template <bool UPPER, typename T>
+inline auto Before(T probe, T key) -> bool {
+  return UPPER ? probe <= key : probe < key;
+}
+
+/**
+ * Branch-free binary search (the comparison compiles to a conditional move) of the range [*base, *base + *len) down
+ * to `window` keys. The keys before the range come before the position searched for, the keys after it do not.
+ */
+template <bool UPPER, typename T>
+inline void Narrow(const T **base, int *len, T key, int window) {
+  while (*len > window) {
+    int half = *len / 2;
+    *base = Before<UPPER>((*base)[half], key) ? *base + half : *base;
+    *len -= half;
+  }
+}
+
+#if defined(__x86_64__)
+
+// The kernels count the keys of a window of LINEAR_WINDOW_BYTES that come before the position searched for. A lower
+// bound counts the keys smaller than the needle (needle > key), an upper bound the keys not greater than it, i.e. the
+// lanes where key > needle is false.
+
+template <bool UPPER>
+__attribute__((target("sse4.2"))) auto CountSse4(const int32_t *keys, int32_t key) -> int {
+  __m128i needle = _mm_set1_epi32(key);
+  int count = 0;
+  for (int i = 0; i < LINEAR_WINDOW_BYTES / 4; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    __m128i mask = UPPER ? _mm_cmpgt_epi32(v, needle) : _mm_cmpgt_epi32(needle, v);
+    int bits = __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+    count += UPPER ? 4 - bits : bits;
+  }
+  return count;
+}
+
+template <bool UPPER>
+__attribute__((target("sse4.2"))) auto CountSse4(const int64_t *keys, int64_t key) -> int {
+  __m128i needle = _mm_set1_epi64x(key);
+  int count = 0;
+  for (int i = 0; i < LINEAR_WINDOW_BYTES / 8; i += 2) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+    __m128i mask = UPPER ? _mm_cmpgt_epi64(v, needle) : _mm_cmpgt_epi64(needle, v);
+    int bits = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(mask)));
+    count += UPPER ? 2 - bits : bits;
+  }
+  return count;
+}
+
+template <bool UPPER>
+__attribute__((target("avx2"))) auto CountAvx2(const int32_t *keys, int32_t key) -> int {
+  __m256i needle = _mm256_set1_epi32(key);
+  int count = 0;
+  for (int i = 0; i < LINEAR_WINDOW_BYTES / 4; i += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    __m256i mask = UPPER ? _mm256_cmpgt_epi32(v, needle) : _mm256_cmpgt_epi32(needle, v);
+    int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+    count += UPPER ? 8 - bits : bits;
+  }
+  return count;
+}
+
+template <bool UPPER>
+__attribute__((target("avx2"))) auto CountAvx2(const int64_t *keys, int64_t key) -> int {
+  __m256i needle = _mm256_set1_epi64x(key);
+  int count = 0;
+  for (int i = 0; i < LINEAR_WINDOW_BYTES / 8; i += 4) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+    __m256i mask = UPPER ? _mm256_cmpgt_epi64(v, needle) : _mm256_cmpgt_epi64(needle, v);
+    int bits = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    count += UPPER ? 4 - bits : bits;
+  }
+  return count;
+}
+
+#endif
+
+template <bool UPPER, typename T>
+auto Search(SearchKernel kernel, const T *keys, int n, T key) -> int {
+  constexpr int window = LINEAR_WINDOW_BYTES / sizeof(T);
+  if (n <= 0) {
+    return 0;
+  }
+  const T *base = keys;
+  int len = n;
+#if defined(__x86_64__)
+  if (kernel != SearchKernel::SCALAR && n >= window) {
+    Narrow<UPPER>(&base, &len, key, window);
+    // widen the range to a full window to the left: the keys added there come before the position as well
+    base = std::min(base, keys + n - window);
+    int count = kernel == SearchKernel::AVX2 ? CountAvx2<UPPER>(base, key) : CountSse4<UPPER>(base, key);
+    return static_cast<int>(base - keys) + count;
+  }
+#endif
+  Narrow<UPPER>(&base, &len, key, 1);
+  return static_cast<int>(base - keys) + (Before<UPPER>(*base, key) ? 1 : 0);
+}
+
+}  // namespace
+
+auto GetSearchKernel() -> SearchKernel {
+  static const SearchKernel KERNEL = [] {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SearchKernel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SearchKernel::SSE4;
+    }
+#endif
+    return SearchKernel::SCALAR;
+  }();
+  return KERNEL;
+}
+
+auto SearchKernelName(SearchKernel kernel) -> const char * {
+  switch (kernel) {
+    case SearchKernel::SCALAR:
+      return "scalar";
+    case SearchKernel::SSE4:
+      return "sse4";
+    case SearchKernel::AVX2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+auto NodeLowerBound(const int32_t *keys, int n, int32_t key) -> int {
+  return Search<false>(GetSearchKernel(), keys, n, key);
+}
+
+auto NodeLowerBound(const int64_t *keys, int n, int64_t key) -> int {
+  return Search<false>(GetSearchKernel(), keys, n, key);
+}
+
+auto NodeUpperBound(const int32_t *keys, int n, int32_t key) -> int {
+  return Search<true>(GetSearchKernel(), keys, n, key);
+}
+
+auto NodeUpperBound(const int64_t *keys, int n, int64_t key) -> int {
+  return Search<true>(GetSearchKernel(), keys, n, key);
+}
+
+auto NodeSearch(SearchKernel kernel, const int32_t *keys, int n, int32_t key, bool upper) -> int {
+  return upper ? Search<true>(kernel, keys, n, key) : Search<false>(kernel, keys, n, key);
+}
+
+auto NodeSearch(SearchKernel kernel, const int64_t *keys, int n, int64_t key, bool upper) -> int {
+  return upper ? Search<true>(kernel, keys, n, key) : Search<false>(kernel, keys, n, key);
+}
+
+}  // namespace redbase
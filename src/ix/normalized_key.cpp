@@ -0,0 +1,76 @@
+#include "ix/normalized_key.h"
+
+#include <numeric>
+#include <utility>
+
+namespace redbase {
+
+namespace {
+
+/** Store the `size` low bytes of `bits` big endian. */
+void StoreBigEndian(uint64_t bits, uint32_t size, char *out) {
+  for (uint32_t i = 0; i < size; i++) {
+    out[i] = static_cast<char>(bits >> (8 * (size - 1 - i)));
+  }
+}
+
+}  // namespace
+
+KeyNormalizer::KeyNormalizer(const Schema *schema, std::vector<uint32_t> key_attrs)
+    : schema_(schema), key_attrs_(std::move(key_attrs)) {
+  for (auto col_idx : key_attrs_) {
+    key_size_ += 1 + schema_->GetColumn(col_idx).GetLength();
+  }
+}
+
+KeyNormalizer::KeyNormalizer(const Schema *key_schema)
+    : KeyNormalizer(key_schema, [key_schema] {
+        std::vector<uint32_t> key_attrs(key_schema->GetColumnCount());
+        std::iota(key_attrs.begin(), key_attrs.end(), 0);
+        return key_attrs;
+      }()) {}
+
+void KeyNormalizer::Normalize(const char *tuple, char *out) const {
+  for (auto col_idx : key_attrs_) {
+    const Column &column = schema_->GetColumn(col_idx);
+    uint32_t length = column.GetLength();
+    if (schema_->IsNull(tuple, col_idx)) {
+      memset(out, 0, 1 + length);
+      out += 1 + length;
+      continue;
+    }
+    *out++ = 1;
+
+    switch (column.GetType()) {
+      case TypeId::INTEGER:
+      case TypeId::DATE:
+      case TypeId::BIGINT: {
+        auto v = static_cast<uint64_t>(schema_->GetValue(tuple, col_idx).GetAsInteger());
+        StoreBigEndian(v ^ (uint64_t{1} << (8 * length - 1)), length, out);
+        break;
+      }
+      case TypeId::DOUBLE: {
+        double v = schema_->GetValue(tuple, col_idx).GetAsDouble();
+        if (v == 0) {
+          v = 0;  // -0.0 and 0.0 are equal keys
+        }
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        bits = (bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63);
+        StoreBigEndian(bits, length, out);
+        break;
+      }
+      case TypeId::CHAR: {
+        std::string_view str = schema_->GetChar(tuple, col_idx);
+        memset(out, 0, length);
+        memcpy(out, str.data(), str.size());
+        break;
+      }
+      default:
+        throw Exception(fmt::format("column {} cannot be part of a key", column.GetName()));
+    }
+    out += length;
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,413 @@
+#include "pf/compressed_pf_manager.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/hash_util.h"
+#include "fmt/format.h"
+#include "pf/page_codec.h"
+
+namespace redbase {
+
+namespace {
+
+constexpr uint32_t PTT_MAGIC = 0x54545052;  // "RPTT"
+/** The journal is compacted into a new snapshot past this many records, or past the size of the table if larger. */
+constexpr size_t PTT_JOURNAL_MIN_RECORDS = 1024;
+
+inline auto AlignExtent(uint64_t size) -> uint64_t {
+  return (size + COMPRESSED_EXTENT_ALIGN - 1) / COMPRESSED_EXTENT_ALIGN * COMPRESSED_EXTENT_ALIGN;
+}
+
+inline auto ElapsedNs(std::chrono::steady_clock::time_point start) -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** An entry of the table: a page id and its extent. A journal record is an entry followed by its checksum. */
+constexpr size_t PTT_ENTRY_SIZE = sizeof(page_id_t) + sizeof(PageExtent);
+constexpr size_t PTT_RECORD_SIZE = PTT_ENTRY_SIZE + sizeof(hash_t);
+/** The snapshot starts with the magic and the number of entries, and ends with the checksum of all but the magic. */
+constexpr size_t PTT_HEADER_SIZE = sizeof(PTT_MAGIC) + sizeof(uint64_t);
+
+inline void EncodeEntry(char *out, page_id_t page_id, const PageExtent &extent) {
+  memcpy(out, &page_id, sizeof(page_id));
+  memcpy(out + sizeof(page_id), &extent, sizeof(extent));
+}
+
+inline void DecodeEntry(const char *in, page_id_t *page_id, PageExtent *extent) {
+  memcpy(page_id, in, sizeof(*page_id));
+  memcpy(extent, in + sizeof(*page_id), sizeof(*extent));
+}
+
+/** @return true if the `size` bytes at `data` are followed by their checksum */
+inline auto ChecksumMatches(const char *data, size_t size) -> bool {
+  hash_t checksum;
+  memcpy(&checksum, data + size, sizeof(checksum));
+  return checksum == HashUtil::HashBytes(data, size);
+}
+
+/** Closes a file descriptor when it goes out of scope. */
+struct ScopedFd {
+  ~ScopedFd() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+  int fd_;
+};
+
+void WriteFully(int fd, const char *data, size_t size, const std::string &filename) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      throw Exception(fmt::format("page translation table {} can not be written", filename));
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+
+void SyncFile(int fd, const std::string &filename) {
+  if (::fsync(fd) != 0) {
+    throw Exception(fmt::format("{} can not be synced", filename));
+  }
+}
+
+/** Sync the directory entry of a file, so that a rename to it survives a crash. */
+void SyncDirectoryOf(const std::string &filename) {
+  size_t slash = filename.find_last_of('/');
+  std::string directory = slash == std::string::npos ? "." : filename.substr(0, std::max<size_t>(slash, 1));
+  ScopedFd dir{::open(directory.c_str(), O_RDONLY | O_DIRECTORY)};
+  if (dir.fd_ < 0) {
+    throw Exception(fmt::format("directory {} can not open", directory));
+  }
+  SyncFile(dir.fd_, directory);
+}
+
+}  // namespace
+
+CompressedPFManager::CompressedPFManager(const std::string &db_file)
+    : PFManager(db_file), ptt_filename_(db_file + ".ptt") {
+  db_sync_fd_ = ::open(GetFileName().c_str(), O_RDONLY);
+  if (db_sync_fd_ < 0) {
+    throw Exception(fmt::format("{} can not open", GetFileName()));
+  }
+  LoadTranslationTable();
+  std::scoped_lock ptt_lock(ptt_latch_);
+  StoreTranslationTable();
+}
+
+CompressedPFManager::~CompressedPFManager() { CloseFiles(); }
+
+void CompressedPFManager::Shutdown() {
+  {
+    std::scoped_lock ptt_lock(ptt_latch_);
+    StoreTranslationTable();
+    CloseFiles();
+  }
+  PFManager::Shutdown();
+}
+
+void CompressedPFManager::ReadPage(page_id_t page_id, char *data) {
+  auto extent = GetExtent(page_id);
+  if (!extent.has_value()) {
+    LOG_DEBUG("I/O err reading page %d that was never written", page_id);
+    memset(data, 0, PAGE_SIZE);
+    return;
+  }
+
+  size_t read_size;
+  if (extent->size_ == PAGE_SIZE) {
+    read_size = ReadBytes(extent->offset_, data, PAGE_SIZE);
+    if (read_size < PAGE_SIZE) {
+      LOG_DEBUG("The size of read data less than a page size");
+      memset(data + read_size, 0, PAGE_SIZE - read_size);
+    }
+  } else {
+    char buffer[PAGE_SIZE];
+    read_size = ReadBytes(extent->offset_, buffer, extent->size_);
+    auto start = std::chrono::steady_clock::now();
+    if (read_size != extent->size_ || !PageCodec::Decompress(buffer, extent->size_, data, PAGE_SIZE)) {
+      throw Exception(fmt::format("page {} is corrupt in {}", page_id, GetFileName()));
+    }
+    io_counters_.decompress_ns_ += ElapsedNs(start);
+  }
+
+  io_counters_.num_reads_++;
+  io_counters_.logical_bytes_read_ += PAGE_SIZE;
+  io_counters_.physical_bytes_read_ += read_size;
+}
+
+void CompressedPFManager::WritePage(page_id_t page_id, const char *data) {
+  // only keep the compressed form if it saves at least one extent unit
+  char buffer[PageCodec::CompressBound(PAGE_SIZE)];
+  auto start = std::chrono::steady_clock::now();
+  size_t compressed_size = PageCodec::Compress(data, PAGE_SIZE, buffer, PAGE_SIZE - COMPRESSED_EXTENT_ALIGN);
+  io_counters_.compress_ns_ += ElapsedNs(start);
+
+  const char *payload = compressed_size == 0 ? data : buffer;
+  auto size = static_cast<uint32_t>(compressed_size == 0 ? PAGE_SIZE : compressed_size);
+
+  PageExtent extent;
+  {
+    std::scoped_lock ptt_lock(ptt_latch_);
+    auto iter = ptt_.find(page_id);
+    uint64_t needed = AlignExtent(size);
+    if (iter != ptt_.end() && iter->second.capacity_ >= needed) {
+      // rewrite in place, the tail the page no longer needs is given back below
+      extent = iter->second;
+      extent.capacity_ = needed;
+    } else {
+      extent = AllocateExtent(size);
+    }
+    extent.size_ = size;
+  }
+
+  WriteBytes(extent.offset_, payload, size);
+
+  {
+    // journal the new extent before the bytes the page left can go to another page
+    std::scoped_lock ptt_lock(ptt_latch_);
+    auto iter = ptt_.find(page_id);
+    if (iter == ptt_.end()) {
+      ptt_[page_id] = extent;
+      AppendTranslation(page_id, extent);
+    } else if (iter->second.offset_ != extent.offset_ || iter->second.size_ != extent.size_ ||
+               iter->second.capacity_ != extent.capacity_) {
+      PageExtent old_extent = iter->second;
+      iter->second = extent;
+      AppendTranslation(page_id, extent);
+      if (old_extent.offset_ != extent.offset_) {
+        FreeExtent(old_extent.offset_, old_extent.capacity_);
+      } else if (old_extent.capacity_ > extent.capacity_) {
+        FreeExtent(extent.offset_ + extent.capacity_, old_extent.capacity_ - extent.capacity_);
+      }
+    }
+  }
+
+  io_counters_.num_writes_++;
+  io_counters_.logical_bytes_written_ += PAGE_SIZE;
+  io_counters_.physical_bytes_written_ += size;
+}
+
+auto CompressedPFManager::GetExtent(page_id_t page_id) -> std::optional<PageExtent> {
+  std::scoped_lock ptt_lock(ptt_latch_);
+  auto iter = ptt_.find(page_id);
+  if (iter == ptt_.end()) {
+    return std::nullopt;
+  }
+  return iter->second;
+}
+
+auto CompressedPFManager::GetFreeBytes() -> uint64_t {
+  std::scoped_lock ptt_lock(ptt_latch_);
+  uint64_t free_bytes = 0;
+  for (const auto &[offset, length] : free_extents_) {
+    free_bytes += length;
+  }
+  return free_bytes;
+}
+
+auto CompressedPFManager::GetFileEnd() -> uint64_t {
+  std::scoped_lock ptt_lock(ptt_latch_);
+  return file_end_;
+}
+
+auto CompressedPFManager::AllocateExtent(uint32_t size) -> PageExtent {
+  uint64_t needed = AlignExtent(size);
+
+  // best fit among the free extents
+  auto best = free_extents_.end();
+  for (auto iter = free_extents_.begin(); iter != free_extents_.end(); ++iter) {
+    if (iter->second >= needed && (best == free_extents_.end() || iter->second < best->second)) {
+      best = iter;
+      if (best->second == needed) {
+        break;
+      }
+    }
+  }
+
+  if (best == free_extents_.end()) {
+    PageExtent extent{file_end_, size, static_cast<uint32_t>(needed)};
+    file_end_ += needed;
+    return extent;
+  }
+
+  PageExtent extent{best->first, size, static_cast<uint32_t>(needed)};
+  uint64_t remainder = best->second - needed;
+  free_extents_.erase(best);
+  if (remainder > 0) {
+    free_extents_.insert({extent.offset_ + needed, remainder});
+  }
+  return extent;
+}
+
+void CompressedPFManager::FreeExtent(uint64_t offset, uint64_t length) {
+  // merge with the free neighbours
+  auto next = free_extents_.lower_bound(offset);
+  if (next != free_extents_.end() && offset + length == next->first) {
+    length += next->second;
+    next = free_extents_.erase(next);
+  }
+  if (next != free_extents_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      length += prev->second;
+      free_extents_.erase(prev);
+    }
+  }
+
+  if (offset + length == file_end_) {
+    file_end_ = offset;
+    return;
+  }
+  free_extents_.insert({offset, length});
+}
+
+void CompressedPFManager::LoadTranslationTable() {
+  std::ifstream ptt_io(ptt_filename_, std::ios::binary | std::ios::in);
+  if (!ptt_io.is_open()) {
+    return;
+  }
+  std::vector<char> bytes((std::istreambuf_iterator<char>(ptt_io)), std::istreambuf_iterator<char>());
+
+  uint32_t magic = 0;
+  uint64_t count = 0;
+  if (bytes.size() < PTT_HEADER_SIZE) {
+    throw Exception(fmt::format("page translation table {} is corrupt", ptt_filename_));
+  }
+  memcpy(&magic, bytes.data(), sizeof(magic));
+  memcpy(&count, bytes.data() + sizeof(magic), sizeof(count));
+  if (magic != PTT_MAGIC) {
+    throw Exception(fmt::format("page translation table {} is corrupt", ptt_filename_));
+  }
+  if (count > (bytes.size() - PTT_HEADER_SIZE) / PTT_ENTRY_SIZE ||
+      bytes.size() < PTT_HEADER_SIZE + count * PTT_ENTRY_SIZE + sizeof(hash_t)) {
+    throw Exception(fmt::format("page translation table {} is truncated", ptt_filename_));
+  }
+  size_t table_size = PTT_HEADER_SIZE + count * PTT_ENTRY_SIZE;
+  if (!ChecksumMatches(bytes.data() + sizeof(magic), table_size - sizeof(magic))) {
+    throw Exception(fmt::format("page translation table {} is corrupt", ptt_filename_));
+  }
+
+  for (uint64_t i = 0; i < count; i++) {
+    page_id_t page_id;
+    PageExtent extent;
+    DecodeEntry(bytes.data() + PTT_HEADER_SIZE + i * PTT_ENTRY_SIZE, &page_id, &extent);
+    ptt_.insert({page_id, extent});
+  }
+  // replay the journal, the last record may have been cut short or garbled by a crash
+  for (size_t pos = table_size + sizeof(hash_t); pos + PTT_RECORD_SIZE <= bytes.size(); pos += PTT_RECORD_SIZE) {
+    if (!ChecksumMatches(bytes.data() + pos, PTT_ENTRY_SIZE)) {
+      LOG_DEBUG("page translation table %s: journal ends in a torn record", ptt_filename_.c_str());
+      break;
+    }
+    page_id_t page_id;
+    PageExtent extent;
+    DecodeEntry(bytes.data() + pos, &page_id, &extent);
+    ptt_[page_id] = extent;
+  }
+
+  // every byte below the last extent that no page owns is free
+  std::vector<PageExtent> extents;
+  extents.reserve(ptt_.size());
+  for (const auto &[page_id, extent] : ptt_) {
+    extents.push_back(extent);
+  }
+  std::sort(extents.begin(), extents.end(),
+            [](const PageExtent &a, const PageExtent &b) { return a.offset_ < b.offset_; });
+  for (const auto &extent : extents) {
+    if (extent.offset_ > file_end_) {
+      free_extents_.insert({file_end_, extent.offset_ - file_end_});
+    }
+    file_end_ = std::max(file_end_, extent.offset_ + extent.capacity_);
+  }
+}
+
+void CompressedPFManager::StoreTranslationTable() {
+  // the snapshot may point at pages no journal record has, their bytes go to disk first
+  SyncPages();
+  std::vector<char> snapshot(PTT_HEADER_SIZE + ptt_.size() * PTT_ENTRY_SIZE + sizeof(hash_t));
+  uint64_t count = ptt_.size();
+  memcpy(snapshot.data(), &PTT_MAGIC, sizeof(PTT_MAGIC));
+  memcpy(snapshot.data() + sizeof(PTT_MAGIC), &count, sizeof(count));
+  size_t pos = PTT_HEADER_SIZE;
+  for (const auto &[page_id, extent] : ptt_) {
+    EncodeEntry(snapshot.data() + pos, page_id, extent);
+    pos += PTT_ENTRY_SIZE;
+  }
+  hash_t checksum = HashUtil::HashBytes(snapshot.data() + sizeof(PTT_MAGIC), pos - sizeof(PTT_MAGIC));
+  memcpy(snapshot.data() + pos, &checksum, sizeof(checksum));
+
+  // write the snapshot aside, sync it, and rename it over the old one: a crash leaves the old table and its journal
+  // or the new table, whole
+  std::string tmp_filename = ptt_filename_ + ".tmp";
+  {
+    ScopedFd tmp{::open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (tmp.fd_ < 0) {
+      throw Exception(fmt::format("page translation table {} can not open", tmp_filename));
+    }
+    WriteFully(tmp.fd_, snapshot.data(), snapshot.size(), tmp_filename);
+    SyncFile(tmp.fd_, tmp_filename);
+  }
+
+  if (ptt_fd_ >= 0) {
+    ::close(ptt_fd_);
+    ptt_fd_ = -1;
+  }
+  if (std::rename(tmp_filename.c_str(), ptt_filename_.c_str()) != 0) {
+    throw Exception(fmt::format("page translation table {} can not be replaced", ptt_filename_));
+  }
+  SyncDirectoryOf(ptt_filename_);
+  ptt_fd_ = ::open(ptt_filename_.c_str(), O_WRONLY | O_APPEND);
+  if (ptt_fd_ < 0) {
+    throw Exception(fmt::format("page translation table {} can not open", ptt_filename_));
+  }
+  journal_records_ = 0;
+}
+
+void CompressedPFManager::AppendTranslation(page_id_t page_id, const PageExtent &extent) {
+  if (journal_records_ >= std::max(ptt_.size(), PTT_JOURNAL_MIN_RECORDS)) {
+    StoreTranslationTable();  // ptt_ already holds the new extent
+    return;
+  }
+  char record[PTT_RECORD_SIZE];
+  EncodeEntry(record, page_id, extent);
+  hash_t checksum = HashUtil::HashBytes(record, PTT_ENTRY_SIZE);
+  memcpy(record + PTT_ENTRY_SIZE, &checksum, sizeof(checksum));
+
+  // the page reaches the disk before the record that points at it, the record before the caller frees the extent
+  // the page left
+  SyncPages();
+  WriteFully(ptt_fd_, record, PTT_RECORD_SIZE, ptt_filename_);
+  SyncFile(ptt_fd_, ptt_filename_);
+  journal_records_++;
+}
+
+void CompressedPFManager::SyncPages() { SyncFile(db_sync_fd_, GetFileName()); }
+
+void CompressedPFManager::CloseFiles() {
+  for (int *fd : {&ptt_fd_, &db_sync_fd_}) {
+    if (*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,36 @@
+#include "pf/disk_scheduler.h"
+
+namespace redbase {
+
+DiskScheduler::DiskScheduler(PFManager *pf_manager) : pf_manager_(pf_manager) {
+  // Spawn the background thread
+  background_thread_.emplace([&] { StartWorkerThread(); });
+}
+
+DiskScheduler::~DiskScheduler() {
+  // Put a `std::nullopt` in the queue to signal to exit the loop
+  request_queue_.Put(std::nullopt);
+  if (background_thread_.has_value()) {
+    background_thread_->join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) { request_queue_.Put(std::make_optional(std::move(r))); }
+
+void DiskScheduler::StartWorkerThread() {
+  while (true) {
+    auto request = request_queue_.Get();
+    if (!request.has_value()) {
+      return;
+    }
+
+    if (request->is_write_) {
+      pf_manager_->WritePage(request->page_id_, request->data_);
+    } else {
+      pf_manager_->ReadPage(request->page_id_, request->data_);
+    }
+    request->callback_.set_value(true);
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,186 @@
+#include "pf/page_codec.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace redbase {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+/** The last bytes of a block are always emitted as literals, which keeps the match loop free of bound checks. */
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_LOG = 12;
+
+inline auto Read32(const uint8_t *p) -> uint32_t {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline auto Hash(uint32_t sequence) -> uint32_t { return (sequence * 2654435761U) >> (32 - HASH_LOG); }
+
+/** Append a length in the "15 + 255 + 255 + ... + rest" form, returns false on overflow. */
+inline auto WriteLength(size_t length, uint8_t **op, const uint8_t *op_end) -> bool {
+  for (; length >= 255; length -= 255) {
+    if (*op >= op_end) {
+      return false;
+    }
+    *(*op)++ = 255;
+  }
+  if (*op >= op_end) {
+    return false;
+  }
+  *(*op)++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+inline auto ReadLength(const uint8_t **ip, const uint8_t *ip_end, size_t *length) -> bool {
+  uint8_t b;
+  do {
+    if (*ip >= ip_end) {
+      return false;
+    }
+    b = *(*ip)++;
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+auto EmitSequence(const uint8_t *literals, size_t literal_len, size_t offset, size_t match_len, uint8_t **op,
+                  const uint8_t *op_end) -> bool {
+  uint8_t *token = *op;
+  if (token >= op_end) {
+    return false;
+  }
+  (*op)++;
+
+  uint8_t literal_nibble = literal_len >= 15 ? 15 : literal_len;
+  if (literal_len >= 15 && !WriteLength(literal_len - 15, op, op_end)) {
+    return false;
+  }
+  if (static_cast<size_t>(op_end - *op) < literal_len) {
+    return false;
+  }
+  memcpy(*op, literals, literal_len);
+  *op += literal_len;
+
+  uint8_t match_nibble = 0;
+  if (match_len > 0) {
+    if (op_end - *op < 2) {
+      return false;
+    }
+    *(*op)++ = static_cast<uint8_t>(offset & 0xFF);
+    *(*op)++ = static_cast<uint8_t>(offset >> 8);
+    size_t extra = match_len - MIN_MATCH;
+    match_nibble = extra >= 15 ? 15 : extra;
+    if (extra >= 15 && !WriteLength(extra - 15, op, op_end)) {
+      return false;
+    }
+  }
+  *token = static_cast<uint8_t>(literal_nibble << 4 | match_nibble);
+  return true;
+}
+
+}  // namespace
+
+auto PageCodec::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> size_t {
+  const auto *base = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip = base;
+  const uint8_t *anchor = base;
+  const uint8_t *ip_end = base + src_size;
+  auto *op = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *op_end = op + dst_capacity;
+
+  if (src_size > MIN_MATCH + LAST_LITERALS) {
+    const uint8_t *match_limit = ip_end - LAST_LITERALS;
+    // positions + 1, 0 means empty
+    uint32_t table[1 << HASH_LOG] = {0};
+
+    while (ip + MIN_MATCH <= match_limit) {
+      uint32_t sequence = Read32(ip);
+      uint32_t h = Hash(sequence);
+      uint32_t candidate = table[h];
+      table[h] = static_cast<uint32_t>(ip - base) + 1;
+
+      if (candidate == 0) {
+        ip++;
+        continue;
+      }
+      const uint8_t *ref = base + candidate - 1;
+      if (static_cast<size_t>(ip - ref) > MAX_OFFSET || Read32(ref) != sequence) {
+        ip++;
+        continue;
+      }
+
+      size_t match_len = MIN_MATCH;
+      while (ip + match_len < match_limit && ip[match_len] == ref[match_len]) {
+        match_len++;
+      }
+      if (!EmitSequence(anchor, ip - anchor, ip - ref, match_len, &op, op_end)) {
+        return 0;
+      }
+      ip += match_len;
+      anchor = ip;
+    }
+  }
+
+  if (!EmitSequence(anchor, ip_end - anchor, 0, 0, &op, op_end)) {
+    return 0;
+  }
+  return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+auto PageCodec::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) -> bool {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *ip_end = ip + src_size;
+  auto *base = reinterpret_cast<uint8_t *>(dst);
+  uint8_t *op = base;
+  const uint8_t *op_end = base + dst_size;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+
+    size_t literal_len = token >> 4;
+    if (literal_len == 15 && !ReadLength(&ip, ip_end, &literal_len)) {
+      return false;
+    }
+    if (static_cast<size_t>(ip_end - ip) < literal_len || static_cast<size_t>(op_end - op) < literal_len) {
+      return false;
+    }
+    memcpy(op, ip, literal_len);
+    ip += literal_len;
+    op += literal_len;
+
+    if (ip == ip_end) {
+      // last sequence
+      break;
+    }
+
+    if (ip_end - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_len = token & 0x0F;
+    if (match_len == 15 && !ReadLength(&ip, ip_end, &match_len)) {
+      return false;
+    }
+    match_len += MIN_MATCH;
+
+    if (offset == 0 || offset > static_cast<size_t>(op - base) || static_cast<size_t>(op_end - op) < match_len) {
+      return false;
+    }
+    // the match may overlap the bytes being produced, copy forward byte by byte
+    const uint8_t *match = op - offset;
+    for (size_t i = 0; i < match_len; i++) {
+      op[i] = match[i];
+    }
+    op += match_len;
+  }
+
+  return op == op_end;
+}
+
+}  // namespace redbase
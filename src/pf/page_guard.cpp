@@ -20,6 +20,9 @@ void BasicPageGuard::Drop() {
 }
 
 auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard & {
+  if (this == &that) {
+    return *this;
+  }
   if (this->page_ != nullptr) {
     this->Drop();
   }
@@ -35,7 +38,6 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
 BasicPageGuard::~BasicPageGuard() { Drop(); }
 
 auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
-  std::cout << "Basic Guard Call Upgrade read in page " << page_->GetPageId() << std::endl;
 
   ReadPageGuard r = ReadPageGuard(bpm_, page_);
   if (page_ != nullptr) {
@@ -46,7 +48,6 @@ auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
 }
 
 auto BasicPageGuard::UpgradeWrite() -> WritePageGuard {
-  std::cout << "Basic Guard Call Upgrade Write in page " << page_->GetPageId() << std::endl;
   WritePageGuard w = WritePageGuard(bpm_, page_);
   if (page_ != nullptr) {
     page_->WLatch();
@@ -58,20 +59,13 @@ auto BasicPageGuard::UpgradeWrite() -> WritePageGuard {
 ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept { *this = std::move(that); }
 
 auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & {
-  // release shared lock
-  if (that.guard_.page_ != nullptr) {
-    that.guard_.page_->RUnlatch();
-  }
-  if (guard_.page_ != nullptr && guard_.page_ != that.guard_.page_) {  // in case, that == this, release once
-    guard_.page_->RUnlatch();
+  if (this == &that) {
+    return *this;
   }
 
-  // move date, then lock self
+  // release the page we hold, then take over the latch (and pin) held by that
+  Drop();
   guard_ = std::move(that.guard_);
-  if (guard_.page_ != nullptr) {
-    guard_.page_->RLatch();
-  }
-
   return *this;
 }
 
@@ -82,29 +76,18 @@ void ReadPageGuard::Drop() {
   }
 }
 
-ReadPageGuard::~ReadPageGuard() {
-  if (guard_.page_ != nullptr) {
-    guard_.page_->WUnlatch();
-    guard_.Drop();
-  }
-}  // NOLINT
+ReadPageGuard::~ReadPageGuard() { Drop(); }  // NOLINT
 
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept { *this = std::move(that); }
 
 auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard & {
-  // release lock
-  if (that.guard_.page_ != nullptr) {
-    that.guard_.page_->WUnlatch();
-  }
-  if (guard_.page_ != nullptr) {
-    guard_.page_->WUnlatch();
+  if (this == &that) {
+    return *this;
   }
 
+  // release the page we hold, then take over the latch (and pin) held by that
+  Drop();
   guard_ = std::move(that.guard_);
-  if (guard_.page_ != nullptr) {
-    guard_.page_->WLatch();
-  }
-
   return *this;
 }
 
@@ -5,9 +5,11 @@
 #include "common/util/file.h"
 #include "fmt/core.h"
 
+#include <cstring>
+
 namespace redbase {
 
-PF_Manager::PF_Manager(const std::string& db_file) : db_filename_(db_file) {
+PFManager::PFManager(const std::string& db_file) : db_filename_(db_file) {
     std::scoped_lock scoped_io_lock(db_io_latch_);
 
     db_io_.open(db_filename_, std::ios::binary |std::ios::in |std::ios::out );
@@ -21,18 +23,17 @@ PF_Manager::PF_Manager(const std::string& db_file) : db_filename_(db_file) {
     }
 }
 
-void PF_Manager::Shutdown() {
+void PFManager::Shutdown() {
     {
         std::scoped_lock scoped_io_lock(db_io_latch_);
         db_io_.close();
     }
 }
 
-void PF_Manager::ReadPage(page_id_t page_id, char *data) {
+void PFManager::ReadPage(page_id_t page_id, char *data) {
     std::scoped_lock scoped_io_lock(db_io_latch_);
     size_t offset = page_id * PAGE_SIZE;
 
-    std::cout << GetSelfFileSize() << std::endl;
     if (offset >= GetSelfFileSize()) {
       LOG_DEBUG("I/O err reading pass the end of file");
       return ;
@@ -52,18 +53,19 @@ void PF_Manager::ReadPage(page_id_t page_id, char *data) {
         db_io_.clear();
         memset(data + read_size, 0, PAGE_SIZE - read_size);
     }
+
+    io_counters_.num_reads_++;
+    io_counters_.logical_bytes_read_ += PAGE_SIZE;
+    io_counters_.physical_bytes_read_ += read_size;
 }
 
-void PF_Manager::WritePage(page_id_t page_id, const char *data) {
+void PFManager::WritePage(page_id_t page_id, const char *data) {
     std::scoped_lock scoped_io_lock(db_io_latch_);
 
-    std::cout << db_io_.tellp() << " " << db_io_.tellg() << std::endl;
     size_t offset = page_id * PAGE_SIZE;
     db_io_.seekp(offset);
     db_io_.write(data, PAGE_SIZE);
 
-    std::cout << db_io_.tellp() << " " << db_io_.tellg() << std::endl;
-
     if (db_io_.bad()) {
         LOG_DEBUG("I/O error while writing data");
         return ;
@@ -71,10 +73,57 @@ void PF_Manager::WritePage(page_id_t page_id, const char *data) {
     
     // flush
     db_io_.flush();
+
+    io_counters_.num_writes_++;
+    io_counters_.logical_bytes_written_ += PAGE_SIZE;
+    io_counters_.physical_bytes_written_ += PAGE_SIZE;
+}
+
+auto PFManager::GetIOStats() const -> IOStats {
+    IOStats stats;
+    stats.num_reads_ = io_counters_.num_reads_.load();
+    stats.num_writes_ = io_counters_.num_writes_.load();
+    stats.logical_bytes_read_ = io_counters_.logical_bytes_read_.load();
+    stats.logical_bytes_written_ = io_counters_.logical_bytes_written_.load();
+    stats.physical_bytes_read_ = io_counters_.physical_bytes_read_.load();
+    stats.physical_bytes_written_ = io_counters_.physical_bytes_written_.load();
+    stats.compress_ns_ = io_counters_.compress_ns_.load();
+    stats.decompress_ns_ = io_counters_.decompress_ns_.load();
+    return stats;
+}
+
+auto PFManager::ReadBytes(size_t offset, char *data, size_t size) -> size_t {
+    std::scoped_lock scoped_io_lock(db_io_latch_);
+
+    db_io_.seekg(offset);
+    db_io_.read(data, size);
+    if (db_io_.bad()) {
+        LOG_DEBUG("I/O error while reading data");
+        db_io_.clear();
+        return 0;
+    }
+
+    size_t read_size = db_io_.gcount();
+    if (read_size < size) {
+        db_io_.clear();
+    }
+    return read_size;
+}
+
+void PFManager::WriteBytes(size_t offset, const char *data, size_t size) {
+    std::scoped_lock scoped_io_lock(db_io_latch_);
+
+    db_io_.seekp(offset);
+    db_io_.write(data, size);
+    if (db_io_.bad()) {
+        LOG_DEBUG("I/O error while writing data");
+        return ;
+    }
+    db_io_.flush();
 }
 
 
-auto PF_Manager::GetSelfFileSize() -> size_t {
+auto PFManager::GetSelfFileSize() -> size_t {
     return redbase::GetFileSize(db_filename_);
 }
 
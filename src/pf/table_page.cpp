@@ -0,0 +1,113 @@
+#include "pf/table_page.h"
+
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+void TablePage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  num_tuples_ = 0;
+  num_deleted_tuples_ = 0;
+}
+
+auto TablePage::GetNextTupleOffset(uint32_t size) const -> std::optional<uint16_t> {
+  size_t slot_end_offset = num_tuples_ > 0 ? tuple_info_[num_tuples_ - 1].offset_ : PAGE_SIZE;
+  if (slot_end_offset < size) {
+    return std::nullopt;
+  }
+  size_t tuple_offset = slot_end_offset - size;
+  size_t offset_size = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * (num_tuples_ + 1);
+  if (tuple_offset < offset_size) {
+    return std::nullopt;
+  }
+  return static_cast<uint16_t>(tuple_offset);
+}
+
+auto TablePage::InsertTuple(const TupleMeta &meta, const char *data, uint32_t size) -> std::optional<uint16_t> {
+  auto tuple_offset = GetNextTupleOffset(size);
+  if (!tuple_offset.has_value()) {
+    return std::nullopt;
+  }
+
+  uint16_t slot_num = num_tuples_;
+  tuple_info_[slot_num] = {*tuple_offset, static_cast<uint16_t>(size), meta};
+  num_tuples_++;
+  if (meta.is_deleted_) {
+    num_deleted_tuples_++;
+  }
+  memcpy(page_start_ + *tuple_offset, data, size);
+  return slot_num;
+}
+
+void TablePage::UpdateTupleMeta(const TupleMeta &meta, uint32_t slot_num) {
+  if (slot_num >= num_tuples_) {
+    throw Exception(fmt::format("slot {} out of range, page has {} tuples", slot_num, num_tuples_));
+  }
+  TupleMeta &old_meta = tuple_info_[slot_num].meta_;
+  if (!old_meta.is_deleted_ && meta.is_deleted_) {
+    num_deleted_tuples_++;
+  } else if (old_meta.is_deleted_ && !meta.is_deleted_) {
+    num_deleted_tuples_--;
+  }
+  old_meta = meta;
+}
+
+auto TablePage::GetTupleMeta(uint32_t slot_num) const -> TupleMeta {
+  if (slot_num >= num_tuples_) {
+    throw Exception(fmt::format("slot {} out of range, page has {} tuples", slot_num, num_tuples_));
+  }
+  return tuple_info_[slot_num].meta_;
+}
+
+auto TablePage::GetTupleData(uint32_t slot_num, uint32_t *size) const -> const char * {
+  if (slot_num >= num_tuples_) {
+    throw Exception(fmt::format("slot {} out of range, page has {} tuples", slot_num, num_tuples_));
+  }
+  const TupleInfo &info = tuple_info_[slot_num];
+  *size = info.size_;
+  return page_start_ + info.offset_;
+}
+
+auto TablePage::UpdateTupleInPlace(uint32_t slot_num, const char *data, uint32_t size) -> bool {
+  if (slot_num >= num_tuples_) {
+    throw Exception(fmt::format("slot {} out of range, page has {} tuples", slot_num, num_tuples_));
+  }
+  const TupleInfo &info = tuple_info_[slot_num];
+  if (info.size_ != size) {
+    return false;
+  }
+  memcpy(page_start_ + info.offset_, data, size);
+  return true;
+}
+
+auto TablePage::GetLiveBytes() const -> uint32_t {
+  uint32_t live_bytes = 0;
+  for (uint32_t i = 0; i < num_tuples_; i++) {
+    if (!tuple_info_[i].meta_.is_deleted_) {
+      live_bytes += tuple_info_[i].size_;
+    }
+  }
+  return live_bytes;
+}
+
+void TablePage::Compact() {
+  // tuples stay in slot order, packed from the end of the page like InsertTuple() does
+  char buffer[PAGE_SIZE];
+  size_t offset = PAGE_SIZE;
+  for (uint32_t i = 0; i < num_tuples_; i++) {
+    TupleInfo &info = tuple_info_[i];
+    if (info.meta_.is_deleted_) {
+      info.size_ = 0;
+    } else {
+      offset -= info.size_;
+      memcpy(buffer + offset, page_start_ + info.offset_, info.size_);
+    }
+    info.offset_ = static_cast<uint16_t>(offset);
+  }
+  memcpy(page_start_ + offset, buffer + offset, PAGE_SIZE - offset);
+}
+
+}  // namespace redbase
@@ -0,0 +1,127 @@
+#include "rm/blob_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "pf/overflow_page.h"
+
+namespace redbase {
+
+void BlobWriter::Append(const char *data, size_t size) {
+  while (size > 0) {
+    if (!tail_.IsValid() || tail_.As<OverflowPage>()->GetChunkSize() == OverflowPage::CHUNK_CAPACITY) {
+      NextPage();
+    }
+
+    auto page = tail_.AsMut<OverflowPage>();
+    uint32_t chunk_size = page->GetChunkSize();
+    size_t n = std::min<size_t>(size, OverflowPage::CHUNK_CAPACITY - chunk_size);
+    memcpy(page->GetChunkMut() + chunk_size, data, n);
+    page->SetChunkSize(chunk_size + n);
+
+    data += n;
+    size -= n;
+    id_.size_ += n;
+  }
+}
+
+auto BlobWriter::Finish() -> BlobId {
+  tail_.Drop();
+  return id_;
+}
+
+void BlobWriter::NextPage() {
+  page_id_t page_id;
+  auto guard = bpm_->NewPageGuarded(&page_id, AccessType::Scan);
+  if (!guard.IsValid()) {
+    throw Exception("cannot write large value: no free frame in the buffer pool");
+  }
+  guard.AsMut<OverflowPage>()->Init();
+
+  if (tail_.IsValid()) {
+    tail_.AsMut<OverflowPage>()->SetNextPageId(page_id);
+  } else {
+    id_.first_page_id_ = page_id;
+  }
+  tail_ = std::move(guard);
+}
+
+BlobReader::BlobReader(BufferPoolManager *bpm, BlobId id) : bpm_(bpm), id_(id), next_page_id_(id.first_page_id_) {}
+
+auto BlobReader::NextChunk(const char **data, size_t *size) -> bool {
+  if (!page_.IsValid() || chunk_offset_ == page_.As<OverflowPage>()->GetChunkSize()) {
+    if (!NextPage()) {
+      return false;
+    }
+  }
+
+  auto page = page_.As<OverflowPage>();
+  *data = page->GetChunk() + chunk_offset_;
+  *size = page->GetChunkSize() - chunk_offset_;
+  chunk_offset_ = page->GetChunkSize();
+  consumed_ += *size;
+  return true;
+}
+
+auto BlobReader::Read(char *buffer, size_t size) -> size_t {
+  size_t copied = 0;
+  while (copied < size) {
+    if (!page_.IsValid() || chunk_offset_ == page_.As<OverflowPage>()->GetChunkSize()) {
+      if (!NextPage()) {
+        break;
+      }
+    }
+
+    auto page = page_.As<OverflowPage>();
+    size_t n = std::min<size_t>(size - copied, page->GetChunkSize() - chunk_offset_);
+    memcpy(buffer + copied, page->GetChunk() + chunk_offset_, n);
+    chunk_offset_ += n;
+    consumed_ += n;
+    copied += n;
+  }
+  return copied;
+}
+
+auto BlobReader::NextPage() -> bool {
+  page_.Drop();
+  chunk_offset_ = 0;
+  if (next_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  page_ = bpm_->FetchPageRead(next_page_id_, AccessType::Scan);
+  if (!page_.IsValid()) {
+    throw Exception(fmt::format("cannot read large value: page {} cannot be fetched", next_page_id_));
+  }
+  next_page_id_ = page_.As<OverflowPage>()->GetNextPageId();
+  if (next_page_id_ != INVALID_PAGE_ID) {
+    bpm_->PrefetchPage(next_page_id_, AccessType::Scan);
+  }
+  return true;
+}
+
+auto BlobStore::Put(const char *data, size_t size) -> BlobId {
+  BlobWriter writer(bpm_);
+  writer.Append(data, size);
+  return writer.Finish();
+}
+
+void BlobStore::Delete(BlobId id) {
+  page_id_t page_id = id.first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_id_t next_page_id;
+    {
+      auto guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+      if (!guard.IsValid()) {
+        throw Exception(fmt::format("cannot delete large value: page {} cannot be fetched", page_id));
+      }
+      next_page_id = guard.As<OverflowPage>()->GetNextPageId();
+    }
+    bpm_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,48 @@
+#include "rm/dynamic_filter.h"
+
+namespace redbase {
+
+DynamicFilter::DynamicFilter(uint32_t column_idx, bool include_nulls) {
+  range_.column_idx_ = column_idx;
+  range_.include_nulls_ = include_nulls;
+}
+
+void DynamicFilter::TightenUpper(const Value &bound, bool inclusive) {
+  std::scoped_lock lock(latch_);
+  if (range_.upper_.has_value()) {
+    int cmp = bound.CompareTo(*range_.upper_);
+    if (cmp > 0 || (cmp == 0 && (inclusive || !range_.upper_inclusive_))) {
+      return;
+    }
+  }
+  range_.upper_ = bound;
+  range_.upper_inclusive_ = inclusive;
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+void DynamicFilter::TightenLower(const Value &bound, bool inclusive) {
+  std::scoped_lock lock(latch_);
+  if (range_.lower_.has_value()) {
+    int cmp = bound.CompareTo(*range_.lower_);
+    if (cmp < 0 || (cmp == 0 && (inclusive || !range_.lower_inclusive_))) {
+      return;
+    }
+  }
+  range_.lower_ = bound;
+  range_.lower_inclusive_ = inclusive;
+  version_.fetch_add(1, std::memory_order_release);
+}
+
+void DynamicFilter::Reset() {
+  std::scoped_lock lock(latch_);
+  range_.lower_.reset();
+  range_.upper_.reset();
+  version_.store(0, std::memory_order_release);
+}
+
+auto DynamicFilter::GetRange() const -> ColumnRange {
+  std::scoped_lock lock(latch_);
+  return range_;
+}
+
+}  // namespace redbase
@@ -0,0 +1,113 @@
+#include "rm/schema.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+Schema::Schema(std::vector<Column> columns) : columns_(std::move(columns)) {
+  uint32_t offset = (columns_.size() + 7) / 8;
+  for (const auto &column : columns_) {
+    if (column.GetType() == TypeId::INVALID) {
+      throw Exception(fmt::format("column {} has no type", column.GetName()));
+    }
+    offsets_.push_back(offset);
+    offset += column.GetLength();
+  }
+  tuple_size_ = offset;
+}
+
+auto Schema::GetColumnIdx(const std::string &name) const -> std::optional<uint32_t> {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    if (columns_[i].GetName() == name) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+auto Schema::GetValue(const char *tuple, uint32_t col_idx) const -> Value {
+  TypeId type_id = columns_[col_idx].GetType();
+  if (IsNull(tuple, col_idx)) {
+    return Value::MakeNull(type_id);
+  }
+
+  const char *data = tuple + offsets_[col_idx];
+  switch (type_id) {
+    case TypeId::INTEGER:
+    case TypeId::DATE: {
+      int32_t v;
+      memcpy(&v, data, sizeof(v));
+      return {type_id, v};
+    }
+    case TypeId::BIGINT: {
+      int64_t v;
+      memcpy(&v, data, sizeof(v));
+      return {type_id, v};
+    }
+    case TypeId::DOUBLE: {
+      double v;
+      memcpy(&v, data, sizeof(v));
+      return Value(v);
+    }
+    default:
+      throw Exception(fmt::format("column {} is not numeric", columns_[col_idx].GetName()));
+  }
+}
+
+void Schema::SetValue(char *tuple, uint32_t col_idx, const Value &value) const {
+  SetNull(tuple, col_idx, value.IsNull());
+  if (value.IsNull()) {
+    return;
+  }
+
+  char *data = tuple + offsets_[col_idx];
+  switch (columns_[col_idx].GetType()) {
+    case TypeId::INTEGER:
+    case TypeId::DATE: {
+      auto v = static_cast<int32_t>(value.GetAsInteger());
+      memcpy(data, &v, sizeof(v));
+      break;
+    }
+    case TypeId::BIGINT: {
+      int64_t v = value.GetAsInteger();
+      memcpy(data, &v, sizeof(v));
+      break;
+    }
+    case TypeId::DOUBLE: {
+      double v = value.GetAsDouble();
+      memcpy(data, &v, sizeof(v));
+      break;
+    }
+    default:
+      throw Exception(fmt::format("column {} is not numeric", columns_[col_idx].GetName()));
+  }
+}
+
+auto Schema::GetChar(const char *tuple, uint32_t col_idx) const -> std::string_view {
+  const char *data = tuple + offsets_[col_idx];
+  uint32_t length = columns_[col_idx].GetLength();
+  return {data, strnlen(data, length)};
+}
+
+void Schema::SetChar(char *tuple, uint32_t col_idx, std::string_view str) const {
+  SetNull(tuple, col_idx, false);
+  char *data = tuple + offsets_[col_idx];
+  uint32_t length = columns_[col_idx].GetLength();
+  size_t n = std::min<size_t>(length, str.size());
+  memcpy(data, str.data(), n);
+  memset(data + n, 0, length - n);
+}
+
+void Schema::SetNull(char *tuple, uint32_t col_idx, bool is_null) const {
+  if (is_null) {
+    tuple[col_idx / 8] |= static_cast<char>(1 << (col_idx % 8));
+  } else {
+    tuple[col_idx / 8] &= static_cast<char>(~(1 << (col_idx % 8)));
+  }
+}
+
+}  // namespace redbase
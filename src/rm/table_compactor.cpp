@@ -0,0 +1,112 @@
+#include "rm/table_compactor.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "pf/table_page.h"
+
+namespace redbase {
+
+TableCompactor::TableCompactor(TableHeap *heap, CompactionOptions options) : heap_(heap), options_(options) {}
+
+TableCompactor::~TableCompactor() { Stop(); }
+
+void TableCompactor::Start() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (background_thread_.has_value()) {
+    return;
+  }
+  stop_ = false;
+  background_thread_.emplace([&] { Run(); });
+}
+
+void TableCompactor::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (!background_thread_.has_value()) {
+      return;
+    }
+    stop_ = true;
+  }
+  cv_.notify_all();
+  background_thread_->join();
+  background_thread_.reset();
+}
+
+void TableCompactor::Run() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  while (!cv_.wait_for(lk, options_.interval_, [&] { return stop_; })) {
+    lk.unlock();
+    CompactOnce(GetRoundBudget());
+    lk.lock();
+  }
+}
+
+auto TableCompactor::GetRoundBudget() const -> size_t {
+  if (options_.max_pages_per_second_ == 0) {
+    return SIZE_MAX;
+  }
+  size_t budget = options_.max_pages_per_second_ * options_.interval_.count() / 1000;
+  return std::max<size_t>(budget, 2);
+}
+
+auto TableCompactor::CompactOnce(size_t page_budget) -> size_t {
+  std::unique_lock compaction_lk(heap_->compaction_latch_, std::try_to_lock);
+  if (!compaction_lk.owns_lock()) {
+    rounds_skipped_++;
+    return 0;
+  }
+
+  BufferPoolManager *bpm = heap_->bpm_;
+  auto page_fill = [&](page_id_t page_id) {
+    auto guard = bpm->FetchPageRead(page_id, AccessType::Scan);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("cannot compact: page {} cannot be fetched", page_id));
+    }
+    auto page = guard.As<TablePage>();
+    uint32_t num_live = page->GetNumTuples() - page->GetNumDeletedTuples();
+    return static_cast<double>(page->GetLiveBytes() + num_live * TablePage::GetSlotSize()) / PAGE_SIZE;
+  };
+
+  std::vector<page_id_t> page_ids = heap_->GetPageIds(0, SIZE_MAX);
+  size_t visited = 0;
+  size_t freed = 0;
+  size_t i = 0;
+  // the last page takes the appends, it is never merged away
+  while (i + 2 < page_ids.size() && visited + 2 <= page_budget) {
+    page_id_t dest_page_id = page_ids[i];
+    page_id_t src_page_id = page_ids[i + 1];
+    visited += 2;
+    if (page_fill(dest_page_id) >= options_.fill_threshold_ && page_fill(src_page_id) >= options_.fill_threshold_) {
+      i++;
+      continue;
+    }
+
+    size_t tuples_moved;
+    if (!heap_->MergePages(dest_page_id, src_page_id, &tuples_moved)) {
+      i++;
+      continue;
+    }
+    // stay on the destination page, it may absorb its new successor as well
+    page_ids.erase(page_ids.begin() + i + 1);
+    freed++;
+    tuples_moved_ += tuples_moved;
+  }
+
+  pages_visited_ += visited;
+  pages_freed_ += freed;
+  return freed;
+}
+
+auto TableCompactor::GetStats() const -> CompactionStats {
+  CompactionStats stats;
+  stats.pages_visited_ = pages_visited_.load();
+  stats.pages_freed_ = pages_freed_.load();
+  stats.tuples_moved_ = tuples_moved_.load();
+  stats.rounds_skipped_ = rounds_skipped_.load();
+  return stats;
+}
+
+}  // namespace redbase
@@ -0,0 +1,309 @@
+#include "rm/table_heap.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
+  page_id_t page_id;
+  auto guard = bpm_->NewPageGuarded(&page_id);
+  if (!guard.IsValid()) {
+    throw Exception("cannot create table heap: no free frame in the buffer pool");
+  }
+  guard.AsMut<TablePage>()->Init();
+  first_page_id_ = page_id;
+  page_ids_.push_back(page_id);
+}
+
+TableHeap::TableHeap(BufferPoolManager *bpm, page_id_t first_page_id) : bpm_(bpm), first_page_id_(first_page_id) {
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids_.push_back(page_id);
+    auto guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("cannot open table heap: page {} cannot be fetched", page_id));
+    }
+    page_id = guard.As<TablePage>()->GetNextPageId();
+  }
+}
+
+TableHeap::~TableHeap() {
+  for (const auto &[page_id, num_forwarded] : retired_pages_) {
+    FreePage(page_id);
+  }
+}
+
+auto TableHeap::InsertTuple(const TupleMeta &meta, const char *data, uint32_t size) -> std::optional<RID> {
+  if (size > TablePage::GetMaxTupleSize()) {
+    LOG_DEBUG("tuple of %u bytes does not fit into a page", size);
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lk(latch_);
+
+  page_id_t last_page_id = page_ids_.back();
+  auto guard = bpm_->FetchPageWrite(last_page_id);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot insert: page {} cannot be fetched", last_page_id));
+  }
+
+  auto slot = guard.AsMut<TablePage>()->InsertTuple(meta, data, size);
+  if (slot.has_value()) {
+    if (zone_map_ != nullptr) {
+      zone_map_->OnInsert(last_page_id, data);
+    }
+    return RID(last_page_id, *slot);
+  }
+
+  // the last page is full, chain a new one
+  page_id_t next_page_id;
+  auto next_guard = bpm_->NewPageGuarded(&next_page_id);
+  if (!next_guard.IsValid()) {
+    throw Exception("cannot insert: no free frame in the buffer pool");
+  }
+  auto next_page = next_guard.AsMut<TablePage>();
+  next_page->Init();
+  slot = next_page->InsertTuple(meta, data, size);
+
+  guard.AsMut<TablePage>()->SetNextPageId(next_page_id);
+  page_ids_.push_back(next_page_id);
+  if (zone_map_ != nullptr) {
+    zone_map_->OnInsert(next_page_id, data);
+  }
+  return RID(next_page_id, *slot);
+}
+
+void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
+  std::shared_lock compaction_lk(compaction_latch_);
+  UpdateTupleMetaLocked(meta, rid);
+}
+
+void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid, const TableScanIterator &scan) {
+  CheckScanHold(scan);
+  UpdateTupleMetaLocked(meta, rid);
+}
+
+void TableHeap::UpdateTupleMetaLocked(const TupleMeta &meta, RID rid) {
+  rid = ResolveRID(rid);
+  auto guard = bpm_->FetchPageWrite(rid.GetPageId());
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot update tuple: page {} cannot be fetched", rid.GetPageId()));
+  }
+  guard.AsMut<TablePage>()->UpdateTupleMeta(meta, rid.GetSlotNum());
+}
+
+auto TableHeap::UpdateTupleInPlace(RID rid, const char *data, uint32_t size) -> bool {
+  std::shared_lock compaction_lk(compaction_latch_);
+  return UpdateTupleInPlaceLocked(rid, data, size);
+}
+
+auto TableHeap::UpdateTupleInPlace(RID rid, const char *data, uint32_t size, const TableScanIterator &scan) -> bool {
+  CheckScanHold(scan);
+  return UpdateTupleInPlaceLocked(rid, data, size);
+}
+
+auto TableHeap::UpdateTupleInPlaceLocked(RID rid, const char *data, uint32_t size) -> bool {
+  rid = ResolveRID(rid);
+  auto guard = bpm_->FetchPageWrite(rid.GetPageId());
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot update tuple: page {} cannot be fetched", rid.GetPageId()));
+  }
+  if (!guard.AsMut<TablePage>()->UpdateTupleInPlace(rid.GetSlotNum(), data, size)) {
+    return false;
+  }
+  if (zone_map_ != nullptr) {
+    zone_map_->OnUpdate(rid.GetPageId(), data);
+  }
+  return true;
+}
+
+auto TableHeap::GetTuple(RID rid, std::vector<char> *data) -> TupleMeta {
+  std::shared_lock compaction_lk(compaction_latch_);
+  return GetTupleLocked(rid, data);
+}
+
+auto TableHeap::GetTuple(RID rid, std::vector<char> *data, const TableScanIterator &scan) -> TupleMeta {
+  CheckScanHold(scan);
+  return GetTupleLocked(rid, data);
+}
+
+auto TableHeap::GetTupleLocked(RID rid, std::vector<char> *data) -> TupleMeta {
+  rid = ResolveRID(rid);
+  auto guard = bpm_->FetchPageRead(rid.GetPageId(), AccessType::Lookup);
+  if (!guard.IsValid()) {
+    throw Exception(fmt::format("cannot get tuple: page {} cannot be fetched", rid.GetPageId()));
+  }
+  auto page = guard.As<TablePage>();
+  uint32_t size;
+  const char *tuple_data = page->GetTupleData(rid.GetSlotNum(), &size);
+  data->assign(tuple_data, tuple_data + size);
+  return page->GetTupleMeta(rid.GetSlotNum());
+}
+
+auto TableHeap::GetPageCount() -> size_t {
+  std::lock_guard<std::mutex> lk(latch_);
+  return page_ids_.size();
+}
+
+auto TableHeap::GetPageIds(size_t begin, size_t end) -> std::vector<page_id_t> {
+  std::lock_guard<std::mutex> lk(latch_);
+  end = std::min(end, page_ids_.size());
+  if (begin >= end) {
+    return {};
+  }
+  return {page_ids_.begin() + begin, page_ids_.begin() + end};
+}
+
+auto TableHeap::MakeScanIterator(ScanOptions options) -> TableScanIterator {
+  return MakeScanIterator(0, SIZE_MAX, options);
+}
+
+auto TableHeap::ResolveRID(RID rid) -> RID {
+  std::lock_guard<std::mutex> lk(forwarding_latch_);
+  return ResolveRIDLocked(rid);
+}
+
+auto TableHeap::ResolveRIDLocked(RID rid) const -> RID {
+  auto iter = forwarding_.find(rid);
+  return iter == forwarding_.end() ? rid : iter->second;
+}
+
+void TableHeap::CheckScanHold(const TableScanIterator &scan) const {
+  if (!scan.HoldsLatch(compaction_latch_)) {
+    throw Exception("the scan does not hold the compaction latch of this heap");
+  }
+}
+
+auto TableHeap::MakeScanIterator(size_t begin, size_t end, ScanOptions options) -> TableScanIterator {
+  // latch before taking the page list, so that none of the pages can be freed by compaction in between
+  auto compaction_lk = std::make_shared<std::shared_lock<std::shared_mutex>>(compaction_latch_);
+  auto page_ids = GetPageIds(begin, end);
+  return {bpm_, std::move(page_ids), std::move(options), std::move(compaction_lk)};
+}
+
+auto TableHeap::MakePartitionedScan(size_t num_partitions, ScanOptions options) -> std::vector<TableScanIterator> {
+  std::vector<TableScanIterator> iterators;
+  if (num_partitions == 0) {
+    return iterators;
+  }
+
+  // one hold of the latch shared by all the iterators: a thread must not lock a shared_mutex it already holds
+  auto compaction_lk = std::make_shared<std::shared_lock<std::shared_mutex>>(compaction_latch_);
+  std::vector<page_id_t> page_ids = GetPageIds(0, SIZE_MAX);
+  size_t per_partition = page_ids.size() / num_partitions;
+  size_t remainder = page_ids.size() % num_partitions;
+  size_t begin = 0;
+  for (size_t i = 0; i < num_partitions && begin < page_ids.size(); i++) {
+    size_t end = begin + per_partition + (i < remainder ? 1 : 0);
+    iterators.emplace_back(bpm_, std::vector<page_id_t>(page_ids.begin() + begin, page_ids.begin() + end), options,
+                           compaction_lk);
+    begin = end;
+  }
+  return iterators;
+}
+
+auto TableHeap::MergePages(page_id_t dest_page_id, page_id_t src_page_id, size_t *tuples_moved) -> bool {
+  *tuples_moved = 0;
+  std::unordered_map<uint32_t, RID> moved;
+  {
+    auto dest_guard = bpm_->FetchPageWrite(dest_page_id);
+    auto src_guard = bpm_->FetchPageWrite(src_page_id);
+    if (!dest_guard.IsValid() || !src_guard.IsValid()) {
+      throw Exception(fmt::format("cannot merge page {} into page {}: no free frame in the buffer pool", src_page_id,
+                                  dest_page_id));
+    }
+    auto dest = dest_guard.AsMut<TablePage>();
+    auto src = src_guard.AsMut<TablePage>();
+    if (dest->GetNextPageId() != src_page_id) {
+      throw Exception(fmt::format("cannot merge page {} into page {}: pages are not adjacent", src_page_id,
+                                  dest_page_id));
+    }
+
+    uint32_t num_live = src->GetNumTuples() - src->GetNumDeletedTuples();
+    if (src->GetLiveBytes() + num_live * TablePage::GetSlotSize() > dest->GetCompactedFreeSpace()) {
+      return false;
+    }
+
+    if (dest->GetNumDeletedTuples() > 0) {
+      dest->Compact();
+    }
+    for (uint32_t slot = 0; slot < src->GetNumTuples(); slot++) {
+      TupleMeta meta = src->GetTupleMeta(slot);
+      if (meta.is_deleted_) {
+        continue;
+      }
+      uint32_t size;
+      const char *data = src->GetTupleData(slot, &size);
+      auto new_slot = dest->InsertTuple(meta, data, size);
+      REDBASE_ASSERT(new_slot.has_value(), "free space was checked before moving");
+      moved.insert({slot, RID(dest_page_id, *new_slot)});
+      if (zone_map_ != nullptr) {
+        zone_map_->OnInsert(dest_page_id, data);
+      }
+    }
+    dest->SetNextPageId(src->GetNextPageId());
+  }
+  *tuples_moved = moved.size();
+
+  // pages that no RID is forwarded from anymore, the source page itself if none of its tuples was moved
+  std::vector<page_id_t> released;
+  {
+    std::lock_guard<std::mutex> lk(forwarding_latch_);
+    // keep targets final: retarget the tuples that had already been moved into the source page, and forget the ones
+    // that were deleted since, their RIDs are dead
+    for (auto iter = forwarding_.begin(); iter != forwarding_.end();) {
+      if (iter->second.GetPageId() != src_page_id) {
+        ++iter;
+        continue;
+      }
+      auto moved_iter = moved.find(iter->second.GetSlotNum());
+      if (moved_iter != moved.end()) {
+        iter->second = moved_iter->second;
+        ++iter;
+        continue;
+      }
+      auto retired_iter = retired_pages_.find(iter->first.GetPageId());
+      REDBASE_ASSERT(retired_iter != retired_pages_.end(), "RIDs are only forwarded from retired pages");
+      if (--retired_iter->second == 0) {
+        released.push_back(retired_iter->first);
+        retired_pages_.erase(retired_iter);
+      }
+      iter = forwarding_.erase(iter);
+    }
+    for (const auto &[slot, new_rid] : moved) {
+      forwarding_[RID(src_page_id, slot)] = new_rid;
+    }
+    if (moved.empty()) {
+      released.push_back(src_page_id);
+    } else {
+      retired_pages_[src_page_id] = moved.size();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(latch_);
+    page_ids_.erase(std::find(page_ids_.begin(), page_ids_.end(), src_page_id));
+  }
+  if (zone_map_ != nullptr) {
+    zone_map_->OnPageFreed(src_page_id);
+  }
+  for (page_id_t page_id : released) {
+    FreePage(page_id);
+  }
+  return true;
+}
+
+void TableHeap::FreePage(page_id_t page_id) {
+  if (!bpm_->DeletePage(page_id)) {
+    LOG_WARN("page %d was unlinked from the heap but is still pinned, it is not reused", page_id);
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,99 @@
+#include "rm/table_scan_iterator.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "pf/table_page.h"
+
+namespace redbase {
+
+TableScanIterator::TableScanIterator(BufferPoolManager *bpm, std::vector<page_id_t> page_ids, ScanOptions options,
+                                     std::shared_ptr<std::shared_lock<std::shared_mutex>> heap_lock)
+    : bpm_(bpm), page_ids_(std::move(page_ids)), options_(std::move(options)), heap_lock_(std::move(heap_lock)) {
+  if (options_.schema_ != nullptr && !options_.ranges_.empty()) {
+    tuple_filter_.emplace(options_.schema_, options_.ranges_);
+  }
+}
+
+auto TableScanIterator::NextBatch(std::vector<TupleView> *batch) -> bool {
+  batch->clear();
+  // the caller is done with the previous batch
+  pinned_.clear();
+
+  while (batch->size() < options_.batch_size_ && cursor_ < page_ids_.size()) {
+    if (slot_ == 0 && CanSkip(cursor_)) {
+      pages_skipped_++;
+      cursor_++;
+      continue;
+    }
+    ReadAhead();
+
+    page_id_t page_id = page_ids_[cursor_];
+    auto guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("table scan cannot fetch page {}: every frame is pinned", page_id));
+    }
+
+    auto page = guard.As<TablePage>();
+    uint32_t num_tuples = page->GetNumTuples();
+    size_t batch_size_before = batch->size();
+    while (slot_ < num_tuples && batch->size() < options_.batch_size_) {
+      size_t appended = batch->size();
+      for (; slot_ < num_tuples && batch->size() < options_.batch_size_; slot_++) {
+        if (page->GetTupleMeta(slot_).is_deleted_) {
+          continue;
+        }
+        uint32_t size;
+        const char *data = page->GetTupleData(slot_, &size);
+        batch->push_back({RID(page_id, slot_), data, size});
+      }
+      // check the ranges on the tuples of the page just appended, the ones dropped make room for more
+      if (tuple_filter_.has_value()) {
+        size_t kept = tuple_filter_->Select(batch->data() + appended, batch->size() - appended);
+        tuples_filtered_ += batch->size() - appended - kept;
+        batch->resize(appended + kept);
+      }
+    }
+
+    if (slot_ == num_tuples) {
+      cursor_++;
+      slot_ = 0;
+    }
+    // keep the page pinned only if the batch points into it
+    if (batch->size() > batch_size_before) {
+      pinned_.push_back(std::move(guard));
+    }
+  }
+
+  return !batch->empty();
+}
+
+void TableScanIterator::ReadAhead() {
+  size_t horizon = std::min(cursor_ + 1 + options_.read_ahead_, page_ids_.size());
+  prefetch_cursor_ = std::max(prefetch_cursor_, cursor_ + 1);
+  for (; prefetch_cursor_ < horizon; prefetch_cursor_++) {
+    if (CanSkip(prefetch_cursor_)) {
+      continue;
+    }
+    if (!bpm_->PrefetchPage(page_ids_[prefetch_cursor_], AccessType::Scan)) {
+      // the pool is under pressure, retry on the next page
+      break;
+    }
+  }
+}
+
+auto TableScanIterator::CanSkip(size_t index) -> bool {
+  if (options_.zone_map_ == nullptr) {
+    return false;
+  }
+  if (options_.dynamic_filter_ != nullptr && options_.dynamic_filter_->GetVersion() != dynamic_version_) {
+    dynamic_version_ = options_.dynamic_filter_->GetVersion();
+    ranges_ = options_.ranges_;
+    ranges_.push_back(options_.dynamic_filter_->GetRange());
+  }
+  const auto &ranges = dynamic_version_ == 0 ? options_.ranges_ : ranges_;
+  return !ranges.empty() && !options_.zone_map_->MayMatch(page_ids_[index], ranges);
+}
+
+}  // namespace redbase
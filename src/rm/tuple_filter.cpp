@@ -0,0 +1,145 @@
+#include "rm/tuple_filter.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+constexpr int64_t INTEGER_MIN = std::numeric_limits<int64_t>::min();
+constexpr int64_t INTEGER_MAX = std::numeric_limits<int64_t>::max();
+constexpr double INFINITE = std::numeric_limits<double>::infinity();
+/** 2^63, the first double past the int64_t range. */
+constexpr double INTEGER_LIMIT = 9223372036854775808.0;
+
+/** @return the smallest integer within a lower bound, INTEGER_MAX if there is none (the range is then empty) */
+auto IntegerLower(const Value &bound, bool inclusive, bool *empty) -> int64_t {
+  if (bound.GetTypeId() != TypeId::DOUBLE) {
+    int64_t integer = bound.GetAsInteger();
+    if (inclusive) {
+      return integer;
+    }
+    *empty |= integer == INTEGER_MAX;
+    return integer == INTEGER_MAX ? INTEGER_MAX : integer + 1;
+  }
+  double lower = inclusive ? std::ceil(bound.GetAsDouble()) : std::floor(bound.GetAsDouble()) + 1;
+  if (std::isnan(lower) || lower >= INTEGER_LIMIT) {
+    *empty = true;
+    return INTEGER_MAX;
+  }
+  return lower < -INTEGER_LIMIT ? INTEGER_MIN : static_cast<int64_t>(lower);
+}
+
+/** @return the largest integer within an upper bound, INTEGER_MIN if there is none (the range is then empty) */
+auto IntegerUpper(const Value &bound, bool inclusive, bool *empty) -> int64_t {
+  if (bound.GetTypeId() != TypeId::DOUBLE) {
+    int64_t integer = bound.GetAsInteger();
+    if (inclusive) {
+      return integer;
+    }
+    *empty |= integer == INTEGER_MIN;
+    return integer == INTEGER_MIN ? INTEGER_MIN : integer - 1;
+  }
+  double upper = inclusive ? std::floor(bound.GetAsDouble()) : std::ceil(bound.GetAsDouble()) - 1;
+  if (std::isnan(upper) || upper < -INTEGER_LIMIT) {
+    *empty = true;
+    return INTEGER_MIN;
+  }
+  return upper >= INTEGER_LIMIT ? INTEGER_MAX : static_cast<int64_t>(upper);
+}
+
+template <typename T>
+auto Load(const char *data) -> T {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+/** Keep the tuples whose column at `offset` (stored as a T) is within [lower, upper], or NULL if include_nulls. */
+template <typename T, typename B>
+auto SelectInRange(const Schema *schema, uint32_t col_idx, uint32_t offset, B lower, B upper, bool include_nulls,
+                   TupleView *tuples, size_t count) -> size_t {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    const char *data = tuples[i].data_;
+    B value = Load<T>(data + offset);
+    bool within = (value >= lower) & (value <= upper);
+    bool is_null = schema->IsNull(data, col_idx);
+    tuples[kept] = tuples[i];
+    kept += static_cast<size_t>(is_null ? include_nulls : within);
+  }
+  return kept;
+}
+
+}  // namespace
+
+TupleFilter::TupleFilter(const Schema *schema, const std::vector<ColumnRange> &ranges) : schema_(schema) {
+  for (const auto &range : ranges) {
+    if (range.column_idx_ >= schema->GetColumnCount()) {
+      throw Exception(fmt::format("range on column {}, the table has {} columns", range.column_idx_,
+                                  schema->GetColumnCount()));
+    }
+    TypeId type = schema->GetColumn(range.column_idx_).GetType();
+    if (!IsNumeric(type)) {
+      throw Exception(fmt::format("range on column {}, which is not numeric", range.column_idx_));
+    }
+    Check check{range.column_idx_, schema->GetOffset(range.column_idx_), type, range.include_nulls_,
+                INTEGER_MIN, INTEGER_MAX, -INFINITE, INFINITE};
+    if (type == TypeId::DOUBLE) {
+      if (range.lower_.has_value()) {
+        double lower = range.lower_->GetAsDouble();
+        check.decimal_lower_ = range.lower_inclusive_ ? lower : std::nextafter(lower, INFINITE);
+      }
+      if (range.upper_.has_value()) {
+        double upper = range.upper_->GetAsDouble();
+        check.decimal_upper_ = range.upper_inclusive_ ? upper : std::nextafter(upper, -INFINITE);
+      }
+    } else {
+      bool empty = false;
+      if (range.lower_.has_value()) {
+        check.integer_lower_ = IntegerLower(*range.lower_, range.lower_inclusive_, &empty);
+      }
+      if (range.upper_.has_value()) {
+        check.integer_upper_ = IntegerUpper(*range.upper_, range.upper_inclusive_, &empty);
+      }
+      if (empty) {
+        check.integer_lower_ = INTEGER_MAX;
+        check.integer_upper_ = INTEGER_MIN;
+      }
+    }
+    checks_.push_back(check);
+  }
+}
+
+auto TupleFilter::Matches(const char *tuple) const -> bool {
+  TupleView view{RID(), tuple, 0};
+  return Select(&view, 1) == 1;
+}
+
+auto TupleFilter::Select(TupleView *tuples, size_t count) const -> size_t {
+  for (const auto &check : checks_) {
+    switch (check.type_) {
+      case TypeId::INTEGER:
+      case TypeId::DATE:
+        count = SelectInRange<int32_t, int64_t>(schema_, check.column_idx_, check.offset_, check.integer_lower_,
+                                                check.integer_upper_, check.include_nulls_, tuples, count);
+        break;
+      case TypeId::BIGINT:
+        count = SelectInRange<int64_t, int64_t>(schema_, check.column_idx_, check.offset_, check.integer_lower_,
+                                                check.integer_upper_, check.include_nulls_, tuples, count);
+        break;
+      default:
+        count = SelectInRange<double, double>(schema_, check.column_idx_, check.offset_, check.decimal_lower_,
+                                              check.decimal_upper_, check.include_nulls_, tuples, count);
+        break;
+    }
+  }
+  return count;
+}
+
+}  // namespace redbase
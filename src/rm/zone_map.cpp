@@ -0,0 +1,315 @@
+#include "rm/zone_map.h"
+
+#include <cstring>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+namespace {
+
+/** On-page form of a ColumnZone, min/max hold int64 or double bits depending on the column type. */
+struct ZoneEntry {
+  char min_[8];
+  char max_[8];
+  uint32_t null_count_;
+  uint32_t value_count_;
+};
+
+/**
+ * Summary page format:
+ *  ----------------------------------------------------------------------------
+ *  | NextPageId (4) | NumEntries (4) | entry 0 | entry 1 | ... |
+ *  ----------------------------------------------------------------------------
+ * An entry is the heap page id (4), padding (4) and one ZoneEntry per summarized column.
+ */
+struct SummaryPageHeader {
+  page_id_t next_page_id_;
+  uint32_t num_entries_;
+};
+
+constexpr size_t ENTRY_PREFIX_SIZE = 8;
+
+void StoreBound(const Value &value, char *dst) {
+  if (value.GetTypeId() == TypeId::DOUBLE) {
+    double v = value.GetAsDouble();
+    memcpy(dst, &v, sizeof(v));
+  } else {
+    int64_t v = value.GetAsInteger();
+    memcpy(dst, &v, sizeof(v));
+  }
+}
+
+auto LoadBound(TypeId type_id, const char *src) -> Value {
+  if (type_id == TypeId::DOUBLE) {
+    double v;
+    memcpy(&v, src, sizeof(v));
+    return Value(v);
+  }
+  int64_t v;
+  memcpy(&v, src, sizeof(v));
+  return {type_id, v};
+}
+
+}  // namespace
+
+void ColumnZone::Update(const Value &value) {
+  if (value.IsNull()) {
+    null_count_++;
+    return;
+  }
+  if (value_count_ == 0 || value.CompareTo(min_) < 0) {
+    min_ = value;
+  }
+  if (value_count_ == 0 || value.CompareTo(max_) > 0) {
+    max_ = value;
+  }
+  value_count_++;
+}
+
+void ColumnZone::Merge(const ColumnZone &other) {
+  null_count_ += other.null_count_;
+  if (other.value_count_ == 0) {
+    return;
+  }
+  if (value_count_ == 0 || other.min_.CompareTo(min_) < 0) {
+    min_ = other.min_;
+  }
+  if (value_count_ == 0 || other.max_.CompareTo(max_) > 0) {
+    max_ = other.max_;
+  }
+  value_count_ += other.value_count_;
+}
+
+auto ColumnZone::MayMatch(const ColumnRange &range) const -> bool {
+  if (range.include_nulls_ && null_count_ > 0) {
+    return true;
+  }
+  if (value_count_ == 0) {
+    return false;
+  }
+  if (range.lower_.has_value()) {
+    int cmp = max_.CompareTo(*range.lower_);
+    if (cmp < 0 || (cmp == 0 && !range.lower_inclusive_)) {
+      return false;
+    }
+  }
+  if (range.upper_.has_value()) {
+    int cmp = min_.CompareTo(*range.upper_);
+    if (cmp > 0 || (cmp == 0 && !range.upper_inclusive_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ZoneMap::ZoneMap(BufferPoolManager *bpm, const Schema *schema, std::vector<uint32_t> column_idxs)
+    : bpm_(bpm), schema_(schema), column_idxs_(std::move(column_idxs)) {
+  for (auto column_idx : column_idxs_) {
+    if (column_idx >= schema_->GetColumnCount() || !IsNumeric(schema_->GetColumn(column_idx).GetType())) {
+      throw Exception(fmt::format("zone maps only summarize numeric columns, column {} is not one", column_idx));
+    }
+  }
+}
+
+ZoneMap::ZoneMap(BufferPoolManager *bpm, const Schema *schema, std::vector<uint32_t> column_idxs,
+                 page_id_t first_summary_page_id)
+    : ZoneMap(bpm, schema, std::move(column_idxs)) {
+  first_summary_page_id_ = first_summary_page_id;
+
+  size_t entry_size = ENTRY_PREFIX_SIZE + column_idxs_.size() * sizeof(ZoneEntry);
+  page_id_t page_id = first_summary_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+      throw Exception(fmt::format("cannot load zone map: page {} cannot be fetched", page_id));
+    }
+    auto header = guard.As<SummaryPageHeader>();
+    const char *entry = guard.GetData() + sizeof(SummaryPageHeader);
+    for (uint32_t i = 0; i < header->num_entries_; i++, entry += entry_size) {
+      page_id_t heap_page_id;
+      memcpy(&heap_page_id, entry, sizeof(heap_page_id));
+      size_t ordinal = GetOrAddOrdinal(heap_page_id);
+
+      for (size_t slot = 0; slot < column_idxs_.size(); slot++) {
+        ZoneEntry zone_entry;
+        memcpy(&zone_entry, entry + ENTRY_PREFIX_SIZE + slot * sizeof(ZoneEntry), sizeof(ZoneEntry));
+        TypeId type_id = schema_->GetColumn(column_idxs_[slot]).GetType();
+        ColumnZone &zone = page_zones_[ordinal][slot];
+        zone.null_count_ = zone_entry.null_count_;
+        zone.value_count_ = zone_entry.value_count_;
+        if (zone.value_count_ > 0) {
+          zone.min_ = LoadBound(type_id, zone_entry.min_);
+          zone.max_ = LoadBound(type_id, zone_entry.max_);
+        }
+        extent_zones_[ordinal / PAGES_PER_EXTENT][slot].Merge(zone);
+      }
+    }
+    page_id = header->next_page_id_;
+  }
+}
+
+void ZoneMap::Build(TableHeap *heap) {
+  {
+    // register the pages up front so that ordinals follow the chain even across empty pages
+    std::unique_lock lk(latch_);
+    for (auto page_id : heap->GetPageIds(0, SIZE_MAX)) {
+      GetOrAddOrdinal(page_id);
+    }
+  }
+
+  auto iterator = heap->MakeScanIterator();
+  std::vector<TupleView> batch;
+  while (iterator.NextBatch(&batch)) {
+    for (const auto &tuple : batch) {
+      OnInsert(tuple.rid_.GetPageId(), tuple.data_);
+    }
+  }
+}
+
+void ZoneMap::OnInsert(page_id_t page_id, const char *tuple) {
+  std::unique_lock lk(latch_);
+  size_t ordinal = GetOrAddOrdinal(page_id);
+  auto &page_zone = page_zones_[ordinal];
+  auto &extent_zone = extent_zones_[ordinal / PAGES_PER_EXTENT];
+  for (size_t slot = 0; slot < column_idxs_.size(); slot++) {
+    Value value = schema_->GetValue(tuple, column_idxs_[slot]);
+    page_zone[slot].Update(value);
+    extent_zone[slot].Update(value);
+  }
+}
+
+void ZoneMap::OnPageFreed(page_id_t page_id) {
+  std::unique_lock lk(latch_);
+  auto iter = ordinals_.find(page_id);
+  if (iter == ordinals_.end()) {
+    return;
+  }
+  page_zones_[iter->second].assign(column_idxs_.size(), ColumnZone{});
+}
+
+auto ZoneMap::MayMatch(page_id_t page_id, const std::vector<ColumnRange> &ranges) const -> bool {
+  std::shared_lock lk(latch_);
+  auto iter = ordinals_.find(page_id);
+  if (iter == ordinals_.end()) {
+    return true;
+  }
+  const auto &page_zone = page_zones_[iter->second];
+  const auto &extent_zone = extent_zones_[iter->second / PAGES_PER_EXTENT];
+
+  for (const auto &range : ranges) {
+    auto slot = GetSlot(range.column_idx_);
+    if (!slot.has_value()) {
+      continue;
+    }
+    // the extent check is the one that lets a scan jump over long runs of pages
+    if (!extent_zone[*slot].MayMatch(range) || !page_zone[*slot].MayMatch(range)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ZoneMap::GetFirstSummaryPageId() const -> page_id_t {
+  std::shared_lock lk(latch_);
+  return first_summary_page_id_;
+}
+
+auto ZoneMap::GetPageZone(page_id_t page_id, uint32_t column_idx) const -> std::optional<ColumnZone> {
+  std::shared_lock lk(latch_);
+  auto iter = ordinals_.find(page_id);
+  auto slot = GetSlot(column_idx);
+  if (iter == ordinals_.end() || !slot.has_value()) {
+    return std::nullopt;
+  }
+  return page_zones_[iter->second][*slot];
+}
+
+void ZoneMap::Flush() {
+  // exclusive: the chain may be extended and first_summary_page_id_ set, and two flushes must not write the same pages
+  std::unique_lock lk(latch_);
+
+  size_t entry_size = ENTRY_PREFIX_SIZE + column_idxs_.size() * sizeof(ZoneEntry);
+  size_t entries_per_page = (PAGE_SIZE - sizeof(SummaryPageHeader)) / entry_size;
+  if (entries_per_page == 0) {
+    throw Exception("too many summarized columns for a summary page");
+  }
+
+  page_id_t page_id = first_summary_page_id_;
+  BasicPageGuard prev_guard;
+  size_t ordinal = 0;
+  do {
+    BasicPageGuard guard;
+    if (page_id == INVALID_PAGE_ID) {
+      // extend the chain
+      guard = bpm_->NewPageGuarded(&page_id);
+      if (!guard.IsValid()) {
+        throw Exception("cannot flush zone map: no free frame in the buffer pool");
+      }
+      guard.AsMut<SummaryPageHeader>()->next_page_id_ = INVALID_PAGE_ID;
+      if (prev_guard.IsValid()) {
+        prev_guard.AsMut<SummaryPageHeader>()->next_page_id_ = page_id;
+      } else {
+        first_summary_page_id_ = page_id;
+      }
+    } else {
+      guard = bpm_->FetchPageBasic(page_id);
+      if (!guard.IsValid()) {
+        throw Exception(fmt::format("cannot flush zone map: page {} cannot be fetched", page_id));
+      }
+    }
+
+    auto header = guard.AsMut<SummaryPageHeader>();
+    char *entry = guard.GetDataMut() + sizeof(SummaryPageHeader);
+    header->num_entries_ = 0;
+    for (; ordinal < page_ids_.size() && header->num_entries_ < entries_per_page; ordinal++, entry += entry_size) {
+      memset(entry, 0, entry_size);
+      memcpy(entry, &page_ids_[ordinal], sizeof(page_id_t));
+      for (size_t slot = 0; slot < column_idxs_.size(); slot++) {
+        const ColumnZone &zone = page_zones_[ordinal][slot];
+        ZoneEntry zone_entry{};
+        zone_entry.null_count_ = zone.null_count_;
+        zone_entry.value_count_ = zone.value_count_;
+        if (zone.value_count_ > 0) {
+          StoreBound(zone.min_, zone_entry.min_);
+          StoreBound(zone.max_, zone_entry.max_);
+        }
+        memcpy(entry + ENTRY_PREFIX_SIZE + slot * sizeof(ZoneEntry), &zone_entry, sizeof(ZoneEntry));
+      }
+      header->num_entries_++;
+    }
+
+    page_id = header->next_page_id_;
+    prev_guard = std::move(guard);
+  } while (ordinal < page_ids_.size() || page_id != INVALID_PAGE_ID);
+}
+
+auto ZoneMap::GetOrAddOrdinal(page_id_t page_id) -> size_t {
+  auto iter = ordinals_.find(page_id);
+  if (iter != ordinals_.end()) {
+    return iter->second;
+  }
+
+  size_t ordinal = page_ids_.size();
+  page_ids_.push_back(page_id);
+  ordinals_.insert({page_id, ordinal});
+  page_zones_.emplace_back(column_idxs_.size());
+  if (ordinal / PAGES_PER_EXTENT >= extent_zones_.size()) {
+    extent_zones_.emplace_back(column_idxs_.size());
+  }
+  return ordinal;
+}
+
+auto ZoneMap::GetSlot(uint32_t column_idx) const -> std::optional<size_t> {
+  for (size_t slot = 0; slot < column_idxs_.size(); slot++) {
+    if (column_idxs_[slot] == column_idx) {
+      return slot;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace redbase
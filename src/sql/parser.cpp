@@ -0,0 +1,304 @@
+#include "sql/parser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+enum class TokenKind { KEYWORD, IDENTIFIER, NUMBER, PARAMETER, SYMBOL, END };
+
+struct Token {
+  TokenKind kind_;
+  /** Keywords in upper case, the other tokens as written. */
+  std::string text_;
+};
+
+constexpr std::string_view KEYWORDS[] = {"AND", "BETWEEN", "FROM", "IN", "LIMIT", "OFFSET", "SELECT", "WHERE"};
+
+auto Tokenize(std::string_view sql) -> std::vector<Token> {
+  std::vector<Token> tokens;
+  size_t pos = 0;
+  while (pos < sql.size()) {
+    char c = sql[pos];
+    if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+      pos++;
+      continue;
+    }
+    size_t start = pos;
+    if (std::isalpha(static_cast<unsigned char>(c)) != 0 || c == '_') {
+      while (pos < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[pos])) != 0 || sql[pos] == '_')) {
+        pos++;
+      }
+      std::string word(sql.substr(start, pos - start));
+      std::string upper = word;
+      std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char ch) { return std::toupper(ch); });
+      if (std::find(std::begin(KEYWORDS), std::end(KEYWORDS), upper) != std::end(KEYWORDS)) {
+        tokens.push_back({TokenKind::KEYWORD, std::move(upper)});
+      } else {
+        tokens.push_back({TokenKind::IDENTIFIER, std::move(word)});
+      }
+    } else if (std::isdigit(static_cast<unsigned char>(c)) != 0 || c == '.') {
+      while (pos < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[pos])) != 0 || sql[pos] == '.')) {
+        pos++;
+      }
+      tokens.push_back({TokenKind::NUMBER, std::string(sql.substr(start, pos - start))});
+    } else if (c == '?') {
+      pos++;
+      tokens.push_back({TokenKind::PARAMETER, "?"});
+    } else if (c == '<' || c == '>' || c == '!') {
+      pos++;
+      if (pos < sql.size() && (sql[pos] == '=' || (c == '<' && sql[pos] == '>'))) {
+        pos++;
+      } else if (c == '!') {
+        throw Exception(fmt::format("syntax error at offset {}: unexpected '!'", start));
+      }
+      tokens.push_back({TokenKind::SYMBOL, std::string(sql.substr(start, pos - start))});
+    } else if (std::string_view("(),*+-=;").find(c) != std::string_view::npos) {
+      pos++;
+      tokens.push_back({TokenKind::SYMBOL, std::string(1, c)});
+    } else {
+      throw Exception(fmt::format("syntax error at offset {}: unexpected '{}'", start, c));
+    }
+  }
+  // a trailing semicolon ends the statement
+  if (!tokens.empty() && tokens.back().text_ == ";") {
+    tokens.pop_back();
+  }
+  tokens.push_back({TokenKind::END, ""});
+  return tokens;
+}
+
+/** Recursive descent over the tokens of a SELECT statement. */
+class Parser {
+ public:
+  explicit Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
+  auto ParseStatement() -> SelectStatement {
+    SelectStatement statement;
+    Expect(TokenKind::KEYWORD, "SELECT");
+    if (!Accept(TokenKind::SYMBOL, "*")) {
+      do {
+        statement.select_list_.push_back(ParseSum());
+      } while (Accept(TokenKind::SYMBOL, ","));
+    }
+    Expect(TokenKind::KEYWORD, "FROM");
+    if (Peek().kind_ != TokenKind::IDENTIFIER) {
+      Fail("a table name");
+    }
+    statement.table_ = Next().text_;
+    if (Accept(TokenKind::KEYWORD, "WHERE")) {
+      statement.where_ = ParseConjunction();
+    }
+    if (Accept(TokenKind::KEYWORD, "LIMIT")) {
+      statement.limit_ = ParseCount();
+      if (Accept(TokenKind::KEYWORD, "OFFSET")) {
+        statement.offset_ = ParseCount();
+      }
+    }
+    if (Peek().kind_ != TokenKind::END) {
+      Fail("the end of the statement");
+    }
+    statement.param_count_ = param_count_;
+    return statement;
+  }
+
+ private:
+  auto Peek() const -> const Token & { return tokens_[pos_]; }
+
+  auto Next() -> const Token & { return tokens_[pos_++]; }
+
+  auto Accept(TokenKind kind, std::string_view text) -> bool {
+    if (Peek().kind_ == kind && Peek().text_ == text) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(TokenKind kind, std::string_view text) {
+    if (!Accept(kind, text)) {
+      Fail(fmt::format("'{}'", text));
+    }
+  }
+
+  [[noreturn]] void Fail(std::string_view expected) const {
+    throw Exception(fmt::format("syntax error at token {} ('{}'): expected {}", pos_, Peek().text_, expected));
+  }
+
+  auto ParseConjunction() -> ParsedExpression {
+    ParsedExpression condition = ParseCondition();
+    if (Peek().kind_ != TokenKind::KEYWORD || Peek().text_ != "AND") {
+      return condition;
+    }
+    ParsedExpression conjunction{ParsedKind::AND};
+    conjunction.children_.push_back(std::move(condition));
+    while (Accept(TokenKind::KEYWORD, "AND")) {
+      conjunction.children_.push_back(ParseCondition());
+    }
+    return conjunction;
+  }
+
+  auto ParseCondition() -> ParsedExpression {
+    ParsedExpression left = ParseSum();
+    if (Accept(TokenKind::KEYWORD, "BETWEEN")) {
+      ParsedExpression between{ParsedKind::BETWEEN};
+      between.children_.push_back(std::move(left));
+      between.children_.push_back(ParseSum());
+      Expect(TokenKind::KEYWORD, "AND");
+      between.children_.push_back(ParseSum());
+      return between;
+    }
+    if (Accept(TokenKind::KEYWORD, "IN")) {
+      ParsedExpression in_list{ParsedKind::IN_LIST};
+      in_list.children_.push_back(std::move(left));
+      Expect(TokenKind::SYMBOL, "(");
+      do {
+        in_list.children_.push_back(ParseSum());
+      } while (Accept(TokenKind::SYMBOL, ","));
+      Expect(TokenKind::SYMBOL, ")");
+      return in_list;
+    }
+    static const std::pair<std::string_view, ComparisonType> comparisons[] = {
+        {"=", ComparisonType::EQUAL},       {"<>", ComparisonType::NOT_EQUAL},    {"!=", ComparisonType::NOT_EQUAL},
+        {"<", ComparisonType::LESS_THAN},   {"<=", ComparisonType::LESS_EQUAL},   {">", ComparisonType::GREATER_THAN},
+        {">=", ComparisonType::GREATER_EQUAL}};
+    for (const auto &[text, comparison_type] : comparisons) {
+      if (Accept(TokenKind::SYMBOL, text)) {
+        ParsedExpression comparison{ParsedKind::COMPARISON};
+        comparison.comparison_type_ = comparison_type;
+        comparison.children_.push_back(std::move(left));
+        comparison.children_.push_back(ParseSum());
+        return comparison;
+      }
+    }
+    Fail("a comparison, BETWEEN or IN");
+  }
+
+  auto ParseSum() -> ParsedExpression {
+    ParsedExpression sum = ParseProduct();
+    while (Peek().text_ == "+" || Peek().text_ == "-") {
+      ParsedExpression arithmetic{ParsedKind::ARITHMETIC};
+      arithmetic.arithmetic_type_ = Next().text_ == "+" ? ArithmeticType::PLUS : ArithmeticType::MINUS;
+      arithmetic.children_.push_back(std::move(sum));
+      arithmetic.children_.push_back(ParseProduct());
+      sum = std::move(arithmetic);
+    }
+    return sum;
+  }
+
+  auto ParseProduct() -> ParsedExpression {
+    ParsedExpression product = ParseFactor();
+    while (Accept(TokenKind::SYMBOL, "*")) {
+      ParsedExpression arithmetic{ParsedKind::ARITHMETIC};
+      arithmetic.arithmetic_type_ = ArithmeticType::MULTIPLY;
+      arithmetic.children_.push_back(std::move(product));
+      arithmetic.children_.push_back(ParseFactor());
+      product = std::move(arithmetic);
+    }
+    return product;
+  }
+
+  auto ParseFactor() -> ParsedExpression {
+    const Token &token = Peek();
+    switch (token.kind_) {
+      case TokenKind::IDENTIFIER: {
+        ParsedExpression column{ParsedKind::COLUMN};
+        column.name_ = Next().text_;
+        return column;
+      }
+      case TokenKind::NUMBER: {
+        ParsedExpression literal{ParsedKind::LITERAL};
+        literal.value_ = ParseNumber(Next().text_, false);
+        return literal;
+      }
+      case TokenKind::PARAMETER: {
+        Next();
+        ParsedExpression parameter{ParsedKind::PARAMETER};
+        parameter.param_idx_ = param_count_++;
+        return parameter;
+      }
+      default:
+        break;
+    }
+    if (Accept(TokenKind::SYMBOL, "(")) {
+      ParsedExpression sum = ParseSum();
+      Expect(TokenKind::SYMBOL, ")");
+      return sum;
+    }
+    if (Accept(TokenKind::SYMBOL, "-")) {
+      if (Peek().kind_ == TokenKind::NUMBER) {
+        ParsedExpression literal{ParsedKind::LITERAL};
+        literal.value_ = ParseNumber(Next().text_, true);
+        return literal;
+      }
+      ParsedExpression negation{ParsedKind::ARITHMETIC};
+      negation.arithmetic_type_ = ArithmeticType::MINUS;
+      ParsedExpression zero{ParsedKind::LITERAL};
+      zero.value_ = Value(TypeId::INTEGER, 0);
+      negation.children_.push_back(std::move(zero));
+      negation.children_.push_back(ParseFactor());
+      return negation;
+    }
+    Fail("an expression");
+  }
+
+  /** @return a number literal: an INTEGER if it fits, a BIGINT otherwise, a DOUBLE if it has a decimal point */
+  auto ParseNumber(const std::string &text, bool negative) const -> Value {
+    if (text.find('.') != std::string::npos) {
+      double decimal = 0;
+      auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), decimal);
+      if (error != std::errc() || end != text.data() + text.size()) {
+        Fail("a number");
+      }
+      return Value(negative ? -decimal : decimal);
+    }
+    uint64_t magnitude = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), magnitude);
+    uint64_t limit = uint64_t{std::numeric_limits<int64_t>::max()} + (negative ? 1 : 0);
+    if (error != std::errc() || end != text.data() + text.size() || magnitude > limit) {
+      Fail("a number that fits a BIGINT");
+    }
+    auto integer = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    bool fits_integer =
+        integer >= std::numeric_limits<int32_t>::min() && integer <= std::numeric_limits<int32_t>::max();
+    return {fits_integer ? TypeId::INTEGER : TypeId::BIGINT, integer};
+  }
+
+  auto ParseCount() -> int64_t {
+    if (Peek().kind_ != TokenKind::NUMBER || Peek().text_.find('.') != std::string::npos) {
+      Fail("a row count");
+    }
+    return ParseNumber(Next().text_, false).GetAsInteger();
+  }
+
+  std::vector<Token> tokens_;
+  size_t pos_{0};
+  uint32_t param_count_{0};
+};
+
+}  // namespace
+
+auto ParseSelect(std::string_view sql) -> SelectStatement { return Parser(Tokenize(sql)).ParseStatement(); }
+
+auto NormalizeSql(std::string_view sql) -> std::string {
+  std::string normalized;
+  for (const auto &token : Tokenize(sql)) {
+    if (token.kind_ == TokenKind::END) {
+      break;
+    }
+    if (!normalized.empty()) {
+      normalized += ' ';
+    }
+    normalized += token.text_;
+  }
+  return normalized;
+}
+
+}  // namespace redbase
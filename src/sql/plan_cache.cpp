@@ -0,0 +1,51 @@
+#include "sql/plan_cache.h"
+
+namespace redbase {
+
+auto PlanCache::Lookup(const std::string &sql, uint64_t catalog_version) -> std::shared_ptr<const Plan> {
+  std::scoped_lock lock(latch_);
+  auto iter = index_.find(sql);
+  if (iter == index_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  if (iter->second->second->catalog_version_ != catalog_version) {
+    entries_.erase(iter->second);
+    index_.erase(iter);
+    invalidations_++;
+    misses_++;
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, iter->second);
+  hits_++;
+  return iter->second->second;
+}
+
+void PlanCache::Insert(const std::string &sql, std::shared_ptr<const Plan> plan) {
+  std::scoped_lock lock(latch_);
+  if (capacity_ == 0) {
+    return;
+  }
+  auto iter = index_.find(sql);
+  if (iter != index_.end()) {
+    // another session planned the statement meanwhile, keep the newer plan
+    if (iter->second->second->catalog_version_ <= plan->catalog_version_) {
+      iter->second->second = std::move(plan);
+    }
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return;
+  }
+  entries_.emplace_front(sql, std::move(plan));
+  index_.emplace(sql, entries_.begin());
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+auto PlanCache::GetSize() const -> size_t {
+  std::scoped_lock lock(latch_);
+  return entries_.size();
+}
+
+}  // namespace redbase
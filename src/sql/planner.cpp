@@ -0,0 +1,241 @@
+#include "sql/planner.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "execution/filter_operator.h"
+#include "execution/limit_operator.h"
+#include "execution/projection_operator.h"
+#include "execution/seq_scan_operator.h"
+#include "fmt/format.h"
+
+namespace redbase {
+
+namespace {
+
+auto IsPredicate(ParsedKind kind) -> bool {
+  return kind == ParsedKind::COMPARISON || kind == ParsedKind::BETWEEN || kind == ParsedKind::IN_LIST ||
+         kind == ParsedKind::AND;
+}
+
+/** Resolves the names of the expressions of a statement against its table, and collects the columns to scan. */
+class Binder {
+ public:
+  explicit Binder(const TableInfo *table) : table_(table) {}
+
+  auto BindPredicate(const ParsedExpression &expression) -> BoundExpression {
+    if (!IsPredicate(expression.kind_)) {
+      throw Exception("WHERE expects a comparison, a BETWEEN or an IN");
+    }
+    return Bind(expression);
+  }
+
+  auto BindValue(const ParsedExpression &expression) -> BoundExpression {
+    if (IsPredicate(expression.kind_)) {
+      throw Exception("a predicate is not a value");
+    }
+    return Bind(expression);
+  }
+
+  auto BindColumn(uint32_t table_col_idx) -> BoundExpression {
+    const Column &column = table_->schema_.GetColumn(table_col_idx);
+    auto iter = std::find(scan_columns_.begin(), scan_columns_.end(), table_col_idx);
+    BoundExpression bound{ParsedKind::COLUMN, column.GetType()};
+    bound.col_idx_ = iter - scan_columns_.begin();
+    if (iter == scan_columns_.end()) {
+      scan_columns_.push_back(table_col_idx);
+    }
+    return bound;
+  }
+
+  auto TakeScanColumns() -> std::vector<uint32_t> { return std::move(scan_columns_); }
+
+ private:
+  auto Bind(const ParsedExpression &expression) -> BoundExpression {
+    BoundExpression bound{expression.kind_};
+    switch (expression.kind_) {
+      case ParsedKind::COLUMN: {
+        auto col_idx = table_->schema_.GetColumnIdx(expression.name_);
+        if (!col_idx.has_value()) {
+          throw Exception(fmt::format("no column {} in table {}", expression.name_, table_->name_));
+        }
+        return BindColumn(*col_idx);
+      }
+      case ParsedKind::LITERAL:
+        bound.type_ = expression.value_.GetTypeId();
+        bound.value_ = expression.value_;
+        return bound;
+      case ParsedKind::PARAMETER:
+        bound.param_idx_ = expression.param_idx_;
+        return bound;
+      case ParsedKind::AND:
+        for (const auto &child : expression.children_) {
+          bound.children_.push_back(BindPredicate(child));
+        }
+        return bound;
+      case ParsedKind::BETWEEN:
+      case ParsedKind::IN_LIST:
+        bound.children_.push_back(BindNumber(expression.children_[0]));
+        for (size_t i = 1; i < expression.children_.size(); i++) {
+          ParsedKind kind = expression.children_[i].kind_;
+          if (kind != ParsedKind::LITERAL && kind != ParsedKind::PARAMETER) {
+            throw Exception("the bounds of a BETWEEN and the list of an IN are numbers or parameters");
+          }
+          bound.children_.push_back(Bind(expression.children_[i]));
+        }
+        return bound;
+      case ParsedKind::COMPARISON:
+        bound.comparison_type_ = expression.comparison_type_;
+        bound.children_.push_back(BindNumber(expression.children_[0]));
+        bound.children_.push_back(BindNumber(expression.children_[1]));
+        return bound;
+      case ParsedKind::ARITHMETIC: {
+        bound.arithmetic_type_ = expression.arithmetic_type_;
+        bound.children_.push_back(BindNumber(expression.children_[0]));
+        bound.children_.push_back(BindNumber(expression.children_[1]));
+        bool is_double = bound.children_[0].type_ == TypeId::DOUBLE || bound.children_[1].type_ == TypeId::DOUBLE;
+        bound.type_ = is_double ? TypeId::DOUBLE : TypeId::BIGINT;
+        return bound;
+      }
+    }
+    throw Exception("unknown expression");
+  }
+
+  /** Bind an operand of a comparison or of an arithmetic, which has to be numeric. */
+  auto BindNumber(const ParsedExpression &expression) -> BoundExpression {
+    BoundExpression bound = BindValue(expression);
+    if (bound.kind_ == ParsedKind::COLUMN && !IsNumeric(bound.type_)) {
+      throw Exception(fmt::format("column {} is not numeric", expression.name_));
+    }
+    return bound;
+  }
+
+  const TableInfo *table_;
+  std::vector<uint32_t> scan_columns_;
+};
+
+auto ParameterValue(const BoundExpression &expression, const std::vector<Value> &params) -> const Value & {
+  if (expression.kind_ == ParsedKind::LITERAL) {
+    return expression.value_;
+  }
+  const Value &value = params[expression.param_idx_];
+  if (value.IsNull()) {
+    throw Exception(fmt::format("parameter {} is NULL", expression.param_idx_ + 1));
+  }
+  return value;
+}
+
+auto MakeExpression(const BoundExpression &expression, const std::vector<Value> &params) -> ExpressionRef {
+  const auto &children = expression.children_;
+  switch (expression.kind_) {
+    case ParsedKind::COLUMN:
+      return std::make_shared<ColumnRefExpression>(expression.col_idx_, expression.type_);
+    case ParsedKind::LITERAL:
+    case ParsedKind::PARAMETER:
+      return std::make_shared<ConstantExpression>(ParameterValue(expression, params));
+    case ParsedKind::COMPARISON:
+      return std::make_shared<ComparisonExpression>(expression.comparison_type_, MakeExpression(children[0], params),
+                                                    MakeExpression(children[1], params));
+    case ParsedKind::BETWEEN:
+      return std::make_shared<BetweenExpression>(MakeExpression(children[0], params),
+                                                 ParameterValue(children[1], params),
+                                                 ParameterValue(children[2], params));
+    case ParsedKind::IN_LIST: {
+      std::vector<Value> list;
+      for (size_t i = 1; i < children.size(); i++) {
+        list.push_back(ParameterValue(children[i], params));
+      }
+      return std::make_shared<InListExpression>(MakeExpression(children[0], params), std::move(list));
+    }
+    case ParsedKind::AND: {
+      std::vector<ExpressionRef> conjuncts;
+      for (const auto &child : children) {
+        conjuncts.push_back(MakeExpression(child, params));
+      }
+      return std::make_shared<ConjunctionExpression>(std::move(conjuncts));
+    }
+    case ParsedKind::ARITHMETIC:
+      return std::make_shared<ArithmeticExpression>(expression.arithmetic_type_, MakeExpression(children[0], params),
+                                                    MakeExpression(children[1], params));
+  }
+  throw Exception("unknown expression");
+}
+
+/** The root of the operators of a plan: keeps the plan alive while they run. */
+class PlanRootOperator : public Operator {
+ public:
+  PlanRootOperator(ExecutorContext *ctx, std::shared_ptr<const Plan> plan, std::unique_ptr<Operator> child)
+      : Operator(ctx, child->GetOutputSchema()), plan_(std::move(plan)), child_(std::move(child)) {}
+
+  void Init() override { child_->Init(); }
+
+  auto Next(DataChunk *chunk) -> bool override { return child_->Next(chunk); }
+
+ private:
+  std::shared_ptr<const Plan> plan_;
+  std::unique_ptr<Operator> child_;
+};
+
+}  // namespace
+
+auto PlanSelect(const SelectStatement &statement, const Catalog &catalog) -> std::shared_ptr<const Plan> {
+  auto plan = std::make_shared<Plan>();
+  // read the version first: a change made while planning makes the plan stale rather than wrong
+  plan->catalog_version_ = catalog.GetVersion();
+  plan->table_ = catalog.GetTable(statement.table_);
+  if (plan->table_ == nullptr) {
+    throw Exception(fmt::format("no table {}", statement.table_));
+  }
+
+  Binder binder(plan->table_.get());
+  if (statement.select_list_.empty()) {
+    for (uint32_t col_idx = 0; col_idx < plan->table_->schema_.GetColumnCount(); col_idx++) {
+      plan->projections_.push_back(binder.BindColumn(col_idx));
+    }
+  } else {
+    for (const auto &expression : statement.select_list_) {
+      plan->projections_.push_back(binder.BindValue(expression));
+    }
+  }
+  if (statement.where_.has_value()) {
+    plan->predicate_ = binder.BindPredicate(*statement.where_);
+  }
+  plan->scan_columns_ = binder.TakeScanColumns();
+
+  plan->scan_only_ = plan->projections_.size() == plan->scan_columns_.size();
+  for (uint32_t i = 0; i < plan->projections_.size() && plan->scan_only_; i++) {
+    plan->scan_only_ = plan->projections_[i].kind_ == ParsedKind::COLUMN && plan->projections_[i].col_idx_ == i;
+  }
+  if (statement.limit_.has_value()) {
+    plan->limit_ = *statement.limit_;
+    plan->offset_ = statement.offset_;
+  }
+  plan->param_count_ = statement.param_count_;
+  return plan;
+}
+
+auto InstantiatePlan(std::shared_ptr<const Plan> plan, ExecutorContext *ctx, const std::vector<Value> &params)
+    -> std::unique_ptr<Operator> {
+  if (params.size() != plan->param_count_) {
+    throw Exception(fmt::format("the statement takes {} parameters, got {}", plan->param_count_, params.size()));
+  }
+  const TableInfo &table = *plan->table_;
+  std::unique_ptr<Operator> root =
+      std::make_unique<SeqScanOperator>(ctx, table.heap_, &table.schema_, plan->scan_columns_);
+  if (plan->predicate_.has_value()) {
+    root = std::make_unique<FilterOperator>(ctx, std::move(root), MakeExpression(*plan->predicate_, params));
+  }
+  if (!plan->scan_only_) {
+    std::vector<ExpressionRef> expressions;
+    for (const auto &projection : plan->projections_) {
+      expressions.push_back(MakeExpression(projection, params));
+    }
+    root = std::make_unique<ProjectionOperator>(ctx, std::move(root), std::move(expressions));
+  }
+  if (plan->limit_.has_value()) {
+    root = std::make_unique<LimitOperator>(ctx, std::move(root), *plan->limit_, plan->offset_);
+  }
+  return std::make_unique<PlanRootOperator>(ctx, std::move(plan), std::move(root));
+}
+
+}  // namespace redbase
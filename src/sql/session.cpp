@@ -0,0 +1,37 @@
+#include "sql/session.h"
+
+#include "sql/parser.h"
+
+namespace redbase {
+
+auto PreparedStatement::Execute(const std::vector<Value> &params) -> std::unique_ptr<Operator> {
+  if (plan_->catalog_version_ != session_->catalog_->GetVersion()) {
+    plan_ = session_->GetPlan(sql_);
+  }
+  return InstantiatePlan(plan_, session_->ctx_, params);
+}
+
+auto Session::Prepare(std::string_view sql) -> PreparedStatement {
+  std::string normalized = NormalizeSql(sql);
+  auto plan = GetPlan(normalized);
+  return {this, std::move(normalized), std::move(plan)};
+}
+
+auto Session::Execute(std::string_view sql, const std::vector<Value> &params) -> std::unique_ptr<Operator> {
+  return Prepare(sql).Execute(params);
+}
+
+auto Session::GetPlan(const std::string &sql) -> std::shared_ptr<const Plan> {
+  if (cache_ != nullptr) {
+    if (auto plan = cache_->Lookup(sql, catalog_->GetVersion())) {
+      return plan;
+    }
+  }
+  auto plan = PlanSelect(ParseSelect(sql), *catalog_);
+  if (cache_ != nullptr) {
+    cache_->Insert(sql, plan);
+  }
+  return plan;
+}
+
+}  // namespace redbase
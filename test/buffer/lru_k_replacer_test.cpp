@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+
+namespace redbase {
+
+TEST(LRUKReplacerTest, EvictsScanOnlyThenInfiniteThenLargestKDistance) {
+  LRUKReplacer replacer(7, 2);
+  // 1 and 2 have two accesses, 3 and 4 one, 5 only scans, 6 stays pinned
+  for (frame_id_t frame_id : {1, 2, 3, 1, 2, 4, 6}) {
+    replacer.RecordAccess(frame_id);
+  }
+  replacer.RecordAccess(5, AccessType::Scan);
+  for (frame_id_t frame_id : {1, 2, 3, 4, 5}) {
+    replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(replacer.Size(), 5U);
+
+  frame_id_t frame_id;
+  std::vector<frame_id_t> evicted;
+  while (replacer.Evict(&frame_id)) {
+    evicted.push_back(frame_id);
+  }
+  EXPECT_EQ(evicted, (std::vector<frame_id_t>{5, 3, 4, 1, 2}));
+  EXPECT_EQ(replacer.Size(), 0U);
+
+  // a pinned frame is not evicted, and moves back into line when it is unpinned
+  replacer.RecordAccess(1);
+  replacer.SetEvictable(1, true);
+  replacer.SetEvictable(6, true);
+  replacer.SetEvictable(6, false);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(frame_id, 1);
+  EXPECT_FALSE(replacer.Evict(&frame_id));
+  replacer.SetEvictable(6, true);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(frame_id, 6);
+}
+
+TEST(LRUKReplacerTest, MatchesTheDefinitionUnderRandomAccesses) {
+  // the victim of the definition: scan-only frames by first access, then +inf k-distance by first access, then the
+  // largest k-distance
+  constexpr size_t num_frames = 32;
+  constexpr size_t k = 3;
+  struct Frame {
+    std::deque<size_t> history_;
+    bool scan_only_{true};
+    bool evictable_{false};
+    bool present_{false};
+  };
+  std::vector<Frame> frames(num_frames);
+  size_t now = 0;
+  auto expected_victim = [&]() -> std::optional<frame_id_t> {
+    std::optional<frame_id_t> victim;
+    auto rank = [&](const Frame &frame) {
+      int queue = frame.scan_only_ ? 0 : frame.history_.size() < k ? 1 : 2;
+      return std::make_pair(queue, frame.history_.front());
+    };
+    for (size_t i = 0; i < num_frames; i++) {
+      if (frames[i].present_ && frames[i].evictable_ && (!victim || rank(frames[i]) < rank(frames[*victim]))) {
+        victim = static_cast<frame_id_t>(i);
+      }
+    }
+    return victim;
+  };
+
+  LRUKReplacer replacer(num_frames, k);
+  std::mt19937_64 rng(3);
+  for (int step = 0; step < 20000; step++) {
+    auto frame_id = static_cast<frame_id_t>(rng() % num_frames);
+    Frame &frame = frames[frame_id];
+    switch (rng() % 4) {
+      case 0:
+      case 1: {
+        auto access_type = rng() % 3 == 0 ? AccessType::Scan : AccessType::Lookup;
+        replacer.RecordAccess(frame_id, access_type);
+        if (!frame.present_) {
+          frame = Frame{};
+          frame.present_ = true;
+        }
+        frame.scan_only_ = frame.scan_only_ && access_type == AccessType::Scan;
+        frame.history_.push_back(now++);
+        if (frame.history_.size() > k) {
+          frame.history_.pop_front();
+        }
+        break;
+      }
+      case 2:
+        if (frame.present_) {
+          frame.evictable_ = rng() % 2 == 0;
+          replacer.SetEvictable(frame_id, frame.evictable_);
+        }
+        break;
+      default: {
+        auto victim = expected_victim();
+        frame_id_t evicted;
+        ASSERT_EQ(replacer.Evict(&evicted), victim.has_value()) << "step " << step;
+        if (victim) {
+          ASSERT_EQ(evicted, *victim) << "step " << step;
+          frames[evicted].present_ = false;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "common/task_scheduler.h"
+
+namespace redbase {
+
+TEST(TaskSchedulerTest, RunsEveryTaskOnItsWorker) {
+  TaskScheduler scheduler(4);
+  ASSERT_EQ(scheduler.GetWorkerCount(), 4U);
+  EXPECT_FALSE(scheduler.CurrentWorker().has_value());
+
+  // a worker runs one task at a time, so a counter per worker needs no latch
+  std::vector<int64_t> sums(scheduler.GetWorkerCount(), 0);
+  std::atomic<bool> wrong_worker{false};
+  TaskGroup group(&scheduler);
+  for (int64_t i = 1; i <= 10000; i++) {
+    group.Spawn(i, [&, i](size_t worker_idx) {
+      if (scheduler.CurrentWorker() != worker_idx) {
+        wrong_worker = true;
+      }
+      sums[worker_idx] += i;
+    });
+  }
+  group.Wait();
+  EXPECT_FALSE(wrong_worker);
+  int64_t total = 0;
+  for (int64_t sum : sums) {
+    total += sum;
+  }
+  EXPECT_EQ(total, 10000 * 10001 / 2);
+}
+
+TEST(TaskSchedulerTest, TasksWaitForTheTasksTheySpawn) {
+  // every worker ends up waiting inside a task, the tasks they wait for still have to run
+  TaskScheduler scheduler(2);
+  std::atomic<int> leaves{0};
+  TaskGroup outer(&scheduler);
+  for (int i = 0; i < 8; i++) {
+    outer.Spawn([&](size_t /*worker_idx*/) {
+      TaskGroup inner(&scheduler);
+      for (int j = 0; j < 50; j++) {
+        inner.Spawn([&](size_t /*worker_idx*/) { leaves++; });
+      }
+      inner.Wait();
+    });
+  }
+  outer.Wait();
+  EXPECT_EQ(leaves, 8 * 50);
+}
+
+TEST(TaskSchedulerTest, RethrowsTheErrorOfATask) {
+  TaskScheduler scheduler(3);
+  std::atomic<int> ran{0};
+  TaskGroup group(&scheduler);
+  for (int i = 0; i < 100; i++) {
+    group.Spawn([&, i](size_t /*worker_idx*/) {
+      ran++;
+      if (i == 42) {
+        throw std::runtime_error("task 42");
+      }
+    });
+  }
+  EXPECT_THROW(group.Wait(), std::runtime_error);
+  EXPECT_EQ(ran, 100);
+
+  // the group can be used again
+  group.Spawn([&](size_t /*worker_idx*/) { ran++; });
+  group.Wait();
+  EXPECT_EQ(ran, 101);
+}
+
+TEST(TaskSchedulerTest, ParallelFor) {
+  for (size_t num_threads : {1, 4}) {
+    std::vector<int> hits(1000, 0);
+    ParallelFor(nullptr, num_threads, hits.size(), [&](size_t i) { hits[i]++; });
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 1000);
+  }
+  TaskScheduler scheduler(3);
+  std::vector<int> hits(1000, 0);
+  ParallelFor(&scheduler, 0, hits.size(), [&](size_t i) { hits[i]++; });
+  EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 1000);
+  EXPECT_THROW(ParallelFor(&scheduler, 0, 10, [](size_t i) {
+                 if (i == 3) {
+                   throw std::runtime_error("3");
+                 }
+               }),
+               std::runtime_error);
+}
+
+}  // namespace redbase
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "execution/compiled_expression.h"
+
+namespace redbase {
+
+class CompiledExpressionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT), Column("c", TypeId::DOUBLE),
+                   Column("d", TypeId::DATE)});
+    chunk_.Initialize(schema, 700);
+    std::mt19937_64 rng(3);
+    for (uint32_t row = 0; row < 700; row++) {
+      chunk_.GetColumn(0).SetValue(row, Value(TypeId::INTEGER, static_cast<int64_t>(rng() % 21) - 10));
+      chunk_.GetColumn(1).SetValue(row, Value(TypeId::BIGINT, static_cast<int64_t>(rng() % 21) - 10));
+      chunk_.GetColumn(2).SetValue(row, Value(static_cast<double>(rng() % 41) / 2 - 10));
+      chunk_.GetColumn(3).SetValue(row, Value(TypeId::DATE, static_cast<int64_t>(rng() % 21)));
+      if (rng() % 9 == 0) {
+        chunk_.GetColumn(rng() % 4).SetValue(row, Value::MakeNull(TypeId::INTEGER));
+      }
+    }
+    chunk_.SetSize(700);
+    for (uint32_t i = 0; i < 4; i++) {
+      columns_.push_back(std::make_shared<ColumnRefExpression>(i, chunk_.GetColumn(i).GetType()));
+    }
+  }
+
+  /** Check the compiled predicate keeps the rows the interpreted one does, over all rows and over every third. */
+  void ExpectSameRows(const ExpressionRef &predicate) {
+    auto compiled = CompileExpression(predicate);
+    for (bool sparse : {false, true}) {
+      SelectionVector expected(700);
+      SelectionVector actual(700);
+      if (sparse) {
+        size_t count = 0;
+        for (uint32_t row = 0; row < 700; row += 3) {
+          expected.GetData()[count++] = row;
+        }
+        expected.SetCount(count);
+      } else {
+        expected.SetIdentity(700);
+      }
+      actual.Assign(expected);
+      predicate->Select(chunk_, &expected);
+      compiled->Select(chunk_, &actual);
+      ASSERT_EQ(std::vector<uint32_t>(actual.GetData(), actual.GetData() + actual.GetCount()),
+                std::vector<uint32_t>(expected.GetData(), expected.GetData() + expected.GetCount()));
+    }
+  }
+
+  void ExpectSameValues(const ExpressionRef &expression) {
+    auto compiled = CompileExpression(expression);
+    Vector expected;
+    Vector actual;
+    expression->Evaluate(chunk_, &expected);
+    compiled->Evaluate(chunk_, &actual);
+    ASSERT_EQ(actual.GetType(), expected.GetType());
+    for (uint32_t row = 0; row < 700; row++) {
+      ASSERT_EQ(actual.GetValue(row).ToString(), expected.GetValue(row).ToString()) << "row " << row;
+    }
+  }
+
+  DataChunk chunk_;
+  std::vector<ExpressionRef> columns_;
+};
+
+static auto Constant(const Value &value) -> ExpressionRef { return std::make_shared<ConstantExpression>(value); }
+
+static constexpr ComparisonType ALL_COMPARISONS[] = {ComparisonType::EQUAL,        ComparisonType::NOT_EQUAL,
+                                                     ComparisonType::LESS_THAN,    ComparisonType::LESS_EQUAL,
+                                                     ComparisonType::GREATER_THAN, ComparisonType::GREATER_EQUAL};
+
+TEST_F(CompiledExpressionTest, FusedKernelsMatchInterpreter) {
+  std::vector<Value> constants = {Value(TypeId::INTEGER, 2), Value(TypeId::DATE, 7), Value(-1.5)};
+  for (uint32_t i = 0; i < 4; i++) {
+    for (uint32_t j = 0; j < 4; j++) {
+      for (auto op : ALL_COMPARISONS) {
+        const Value &constant = constants[(i + j) % constants.size()];
+        // col <op> const AND const <op> col
+        ExpressionRef predicate = std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{
+            std::make_shared<ComparisonExpression>(op, columns_[i], Constant(constant)),
+            std::make_shared<ComparisonExpression>(op, Constant(Value(TypeId::INTEGER, 3)), columns_[j])});
+        ExpectSameRows(predicate);
+        for (auto arith : {ArithmeticType::PLUS, ArithmeticType::MINUS, ArithmeticType::MULTIPLY}) {
+          auto arithmetic = std::make_shared<ArithmeticExpression>(arith, columns_[i], columns_[j]);
+          ExpectSameRows(std::make_shared<ComparisonExpression>(op, arithmetic, Constant(constant)));
+          ExpectSameRows(std::make_shared<ComparisonExpression>(op, Constant(constant), arithmetic));
+        }
+      }
+      for (auto arith : {ArithmeticType::PLUS, ArithmeticType::MINUS, ArithmeticType::MULTIPLY}) {
+        ExpectSameValues(std::make_shared<ArithmeticExpression>(arith, columns_[i], columns_[j]));
+        ExpectSameValues(std::make_shared<ArithmeticExpression>(arith, columns_[i], Constant(constants[j % 3])));
+        ExpectSameValues(std::make_shared<ArithmeticExpression>(arith, Constant(constants[j % 3]), columns_[i]));
+      }
+    }
+  }
+}
+
+TEST_F(CompiledExpressionTest, LowersToFusedShapes) {
+  auto compare = [&](uint32_t col_idx, int64_t constant) -> ExpressionRef {
+    return std::make_shared<ComparisonExpression>(ComparisonType::LESS_THAN, columns_[col_idx],
+                                                  Constant(Value(TypeId::BIGINT, constant)));
+  };
+  // three comparisons: a pair is fused, the third stays a comparison of the conjunction
+  auto compiled = CompileExpression(
+      std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{compare(0, 1), compare(1, 2), compare(2, 3)}));
+  ASSERT_NE(dynamic_cast<const ConjunctionExpression *>(compiled.get()), nullptr);
+  ASSERT_EQ(compiled->GetChildren().size(), 2U);
+  EXPECT_NE(dynamic_cast<const FusedPredicateExpression *>(compiled->GetChildren()[0].get()), nullptr);
+  EXPECT_NE(dynamic_cast<const ComparisonExpression *>(compiled->GetChildren()[1].get()), nullptr);
+
+  // a pair alone is the fused predicate itself
+  compiled = CompileExpression(
+      std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{compare(0, 1), compare(3, 2)}));
+  EXPECT_NE(dynamic_cast<const FusedPredicateExpression *>(compiled.get()), nullptr);
+
+  // a constant an INTEGER column cannot hold is left to the interpreter
+  auto wide = std::make_shared<ConjunctionExpression>(
+      std::vector<ExpressionRef>{compare(0, int64_t{1} << 40), compare(1, 2)});
+  EXPECT_EQ(dynamic_cast<const FusedPredicateExpression *>(CompileExpression(wide).get()), nullptr);
+  ExpectSameRows(wide);
+
+  // nested arithmetic has its inner node fused
+  auto nested = std::make_shared<ArithmeticExpression>(
+      ArithmeticType::MULTIPLY, std::make_shared<ArithmeticExpression>(ArithmeticType::PLUS, columns_[0], columns_[1]),
+      columns_[2]);
+  compiled = CompileExpression(nested);
+  EXPECT_NE(dynamic_cast<const FusedValueExpression *>(compiled->GetChildren()[0].get()), nullptr);
+  ExpectSameValues(nested);
+
+  EXPECT_EQ(FusedKernelCount(FusedShape::COMPARE_AND_COMPARE), 3U * 3U);
+  EXPECT_EQ(FusedKernelCount(FusedShape::ARITHMETIC_COMPARE), 3U * 3U * 3U * 6U);
+}
+
+TEST_F(CompiledExpressionTest, ConstantColumnFallsBackToInterpreter) {
+  // a column that comes as a constant vector, as the output of a projection of a literal may
+  chunk_.GetColumn(1).Reference(Vector::MakeConstant(Value(TypeId::BIGINT, 4)));
+  ExpectSameRows(std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{
+      std::make_shared<ComparisonExpression>(ComparisonType::GREATER_THAN, columns_[0],
+                                             Constant(Value(TypeId::INTEGER, 0))),
+      std::make_shared<ComparisonExpression>(ComparisonType::EQUAL, columns_[1],
+                                             Constant(Value(TypeId::INTEGER, 4)))}));
+  ExpectSameValues(std::make_shared<ArithmeticExpression>(ArithmeticType::MINUS, columns_[1], columns_[2]));
+}
+
+}  // namespace redbase
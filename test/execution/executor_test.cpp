@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "execution/filter_operator.h"
+#include "execution/limit_operator.h"
+#include "execution/projection_operator.h"
+#include "execution/seq_scan_operator.h"
+#include "rm/table_compactor.h"
+#include "rm/table_heap.h"
+#include "table_test_fixture.h"
+
+namespace redbase {
+
+class ExecutorTest : public TableTest {
+ protected:
+  void SetUp() override {
+    OpenDatabase("executor_test.db");
+    heap_ = AddTable();
+    // id, a = id % 100 (NULL for every 7th row), b = id / 2.0
+    FillTable(heap_, schema_, 5000, [&](char *tuple, int64_t id) {
+      schema_.SetValue(tuple, 0, Value(TypeId::BIGINT, id));
+      schema_.SetValue(tuple, 1, id % 7 == 0 ? Value() : Value(TypeId::INTEGER, id % 100));
+      schema_.SetValue(tuple, 2, Value(id / 2.0));
+      schema_.SetChar(tuple, 3, "x");
+    });
+  }
+
+  /** SELECT a + b, id FROM t WHERE a < 10 AND id >= 1000 */
+  auto MakePlan() -> std::unique_ptr<Operator> {
+    auto scan = std::make_unique<SeqScanOperator>(&ctx_, heap_, &schema_, std::vector<uint32_t>{0, 1, 2});
+    auto id = std::make_shared<ColumnRefExpression>(0, TypeId::BIGINT);
+    auto a = std::make_shared<ColumnRefExpression>(1, TypeId::INTEGER);
+    auto b = std::make_shared<ColumnRefExpression>(2, TypeId::DOUBLE);
+    auto predicate = std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{
+        std::make_shared<ComparisonExpression>(ComparisonType::LESS_THAN, a,
+                                               std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 10))),
+        std::make_shared<ComparisonExpression>(ComparisonType::GREATER_EQUAL, id,
+                                               std::make_shared<ConstantExpression>(Value(TypeId::BIGINT, 1000)))});
+    auto filter = std::make_unique<FilterOperator>(&ctx_, std::move(scan), predicate);
+    return std::make_unique<ProjectionOperator>(
+        &ctx_, std::move(filter),
+        std::vector<ExpressionRef>{std::make_shared<ArithmeticExpression>(ArithmeticType::PLUS, a, b), id});
+  }
+
+  /** @return the ids of the rows the query should return */
+  static auto ExpectedIds() -> std::vector<int64_t> {
+    std::vector<int64_t> ids;
+    for (int64_t id = 1000; id < 5000; id++) {
+      if (id % 7 != 0 && id % 100 < 10) {
+        ids.push_back(id);
+      }
+    }
+    return ids;
+  }
+
+  Schema schema_{{Column("id", TypeId::BIGINT), Column("a", TypeId::INTEGER), Column("b", TypeId::DOUBLE),
+                  Column("c", TypeId::CHAR, 16)}};
+  ExecutorContext ctx_;
+  TableHeap *heap_{nullptr};
+};
+
+TEST_F(ExecutorTest, FilterProjectAtAnyBatchSize) {
+  auto expected = ExpectedIds();
+  for (size_t batch_size : {1, 7, 128, 1024}) {
+    ctx_.batch_size_ = batch_size;
+    auto plan = MakePlan();
+    EXPECT_EQ(plan->GetOutputSchema().GetColumn(0).GetType(), TypeId::DOUBLE);
+    EXPECT_EQ(plan->GetOutputSchema().GetColumn(1).GetName(), "id");
+    plan->Init();
+    DataChunk chunk = plan->MakeChunk();
+    std::vector<int64_t> ids;
+    while (plan->Next(&chunk)) {
+      ASSERT_GT(chunk.GetSelectedCount(), 0U);
+      ASSERT_LE(chunk.GetSize(), batch_size);
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        int64_t id = chunk.GetValue(1, i).GetAsInteger();
+        ASSERT_DOUBLE_EQ(chunk.GetValue(0, i).GetAsDouble(), static_cast<double>(id % 100) + id / 2.0);
+        ids.push_back(id);
+      }
+    }
+    EXPECT_EQ(ids, expected) << "batch size " << batch_size;
+  }
+}
+
+TEST_F(ExecutorTest, LimitWithOffset) {
+  auto expected = ExpectedIds();
+  ctx_.batch_size_ = 64;
+  auto plan = std::make_unique<LimitOperator>(&ctx_, MakePlan(), 100, 150);
+  DataChunk chunk = plan->MakeChunk();
+  // a second Init() starts over
+  for (int run = 0; run < 2; run++) {
+    plan->Init();
+    std::vector<int64_t> ids;
+    while (plan->Next(&chunk)) {
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        ids.push_back(chunk.GetValue(1, i).GetAsInteger());
+      }
+    }
+    EXPECT_EQ(ids, std::vector<int64_t>(expected.begin() + 150, expected.begin() + 250));
+  }
+}
+
+TEST_F(ExecutorTest, BetweenAndInList) {
+  auto id = std::make_shared<ColumnRefExpression>(0, TypeId::BIGINT);
+  auto a = std::make_shared<ColumnRefExpression>(1, TypeId::INTEGER);
+  auto count_rows = [&](const ExpressionRef &predicate) {
+    auto scan = std::make_unique<SeqScanOperator>(&ctx_, heap_, &schema_, std::vector<uint32_t>{0, 1});
+    FilterOperator filter(&ctx_, std::move(scan), predicate);
+    filter.Init();
+    DataChunk chunk = filter.MakeChunk();
+    size_t count = 0;
+    while (filter.Next(&chunk)) {
+      count += chunk.GetSelectedCount();
+    }
+    return count;
+  };
+  auto expected = [](auto match) {
+    size_t count = 0;
+    for (int64_t id = 0; id < 5000; id++) {
+      count += id % 7 != 0 && match(id % 100) ? 1 : 0;
+    }
+    return count;
+  };
+  // bounds an INTEGER holds go through the kernels, the others are compared value by value
+  EXPECT_EQ(count_rows(std::make_shared<BetweenExpression>(a, Value(TypeId::BIGINT, 10), Value(TypeId::BIGINT, 19))),
+            expected([](int64_t v) { return v >= 10 && v <= 19; }));
+  EXPECT_EQ(count_rows(std::make_shared<BetweenExpression>(a, Value(9.5), Value(19.5))),
+            expected([](int64_t v) { return v >= 10 && v <= 19; }));
+  EXPECT_EQ(count_rows(std::make_shared<InListExpression>(
+                a, std::vector<Value>{Value(TypeId::INTEGER, 3), Value(), Value(TypeId::INTEGER, 42)})),
+            expected([](int64_t v) { return v == 3 || v == 42; }));
+  EXPECT_EQ(count_rows(std::make_shared<InListExpression>(a, std::vector<Value>{Value(3.0), Value(42.5)})),
+            expected([](int64_t v) { return v == 3; }));
+  // constant <op> column is flipped into column <op> constant
+  EXPECT_EQ(count_rows(std::make_shared<ComparisonExpression>(
+                ComparisonType::GREATER_THAN, std::make_shared<ConstantExpression>(Value(TypeId::BIGINT, 4000)), id)),
+            4000U);
+}
+
+TEST_F(ExecutorTest, FilterPushesComparisonsIntoTheScan) {
+  // the scan reads (b, a), so the columns of the predicate map to other columns of the table
+  auto b = std::make_shared<ColumnRefExpression>(0, TypeId::DOUBLE);
+  auto a = std::make_shared<ColumnRefExpression>(1, TypeId::INTEGER);
+  auto predicate = std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{
+      std::make_shared<ComparisonExpression>(ComparisonType::GREATER_THAN,
+                                             std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 10)), a),
+      std::make_shared<BetweenExpression>(b, Value(TypeId::BIGINT, 500), Value(1500.0)),
+      std::make_shared<ComparisonExpression>(ComparisonType::NOT_EQUAL, a,
+                                             std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 3)))});
+  auto run = [&](bool push_down, size_t *tuples_filtered) {
+    ctx_.push_down_predicates_ = push_down;
+    auto scan = std::make_unique<SeqScanOperator>(&ctx_, heap_, &schema_, std::vector<uint32_t>{2, 1});
+    auto *scan_ptr = scan.get();
+    FilterOperator filter(&ctx_, std::move(scan), predicate);
+    filter.Init();
+    DataChunk chunk = filter.MakeChunk();
+    std::vector<double> values;
+    while (filter.Next(&chunk)) {
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        values.push_back(chunk.GetValue(0, i).GetAsDouble());
+      }
+    }
+    *tuples_filtered = scan_ptr->GetTuplesFiltered();
+    return values;
+  };
+
+  std::vector<double> expected;
+  for (int64_t id = 1000; id <= 3000; id++) {
+    if (id % 7 != 0 && id % 100 < 10 && id % 100 != 3) {
+      expected.push_back(id / 2.0);
+    }
+  }
+  size_t tuples_filtered;
+  EXPECT_EQ(run(false, &tuples_filtered), expected);
+  EXPECT_EQ(0U, tuples_filtered);
+  // the comparison and the BETWEEN are checked in the pages, the NOT_EQUAL is left to the filter
+  EXPECT_EQ(run(true, &tuples_filtered), expected);
+  size_t passed = 0;
+  for (int64_t id = 1000; id <= 3000; id++) {
+    passed += id % 7 != 0 && id % 100 < 10 ? 1 : 0;
+  }
+  EXPECT_EQ(5000U - passed, tuples_filtered);
+
+  // a predicate the scan takes entirely leaves the filter with nothing to evaluate
+  auto scan = std::make_unique<SeqScanOperator>(&ctx_, heap_, &schema_, std::vector<uint32_t>{2, 1});
+  EXPECT_EQ(nullptr, scan->PushDown(std::make_shared<ComparisonExpression>(
+                         ComparisonType::EQUAL, a, std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 4)))));
+}
+
+TEST_F(ExecutorTest, ExhaustedScanReleasesTheHeap) {
+  // make the heap sparse enough to compact
+  std::vector<RID> rids;
+  {
+    auto iterator = heap_->MakeScanIterator();
+    std::vector<TupleView> batch;
+    while (iterator.NextBatch(&batch)) {
+      for (const auto &tuple : batch) {
+        rids.push_back(tuple.rid_);
+      }
+    }
+  }
+  for (size_t i = 0; i < rids.size(); i++) {
+    if (i % 10 != 0) {
+      heap_->UpdateTupleMeta({true}, rids[i]);
+    }
+  }
+
+  SeqScanOperator scan(&ctx_, heap_, &schema_, {0});
+  scan.Init();
+  DataChunk chunk = scan.MakeChunk();
+  size_t rows = 0;
+  while (scan.Next(&chunk)) {
+    rows += chunk.GetSelectedCount();
+  }
+  EXPECT_EQ((rids.size() + 9) / 10, rows);
+  EXPECT_FALSE(scan.Next(&chunk));
+
+  // the operator is still alive, its drained scan no longer keeps the compactor out
+  TableCompactor compactor(heap_);
+  EXPECT_GT(compactor.CompactOnce(), 0U);
+  EXPECT_EQ(0U, compactor.GetStats().rounds_skipped_);
+}
+
+}  // namespace redbase
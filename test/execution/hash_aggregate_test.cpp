@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "execution/hash_aggregate_operator.h"
+#include "execution/seq_scan_operator.h"
+#include "rm/table_heap.h"
+#include "table_test_fixture.h"
+
+namespace redbase {
+
+class HashAggregateTest : public TableTest {
+ protected:
+  /** The aggregates of a group, as the operator should compute them. */
+  struct Group {
+    int64_t count_star_{0};
+    int64_t count_{0};
+    int64_t sum_{0};
+    std::optional<int64_t> min_;
+    std::optional<double> max_;
+    double sum_d_{0};
+  };
+
+  void SetUp() override {
+    OpenDatabase("hash_aggregate_test.db");
+    // t: grp = rand % 1500 (NULL for some rows), val BIGINT (NULL for some rows), d DOUBLE in halves
+    table_ = AddTable();
+    std::mt19937_64 rng(5);
+    FillTable(table_, schema_, 20000, [&](char *tuple, int64_t /*id*/) {
+      std::optional<int64_t> grp = static_cast<int64_t>(rng() % 1500);
+      std::optional<int64_t> val = static_cast<int64_t>(rng() % 2001) - 1000;
+      double d = static_cast<double>(rng() % 401) / 2 - 100;
+      if (rng() % 23 == 0) {
+        grp.reset();
+      }
+      if (rng() % 7 == 0) {
+        val.reset();
+      }
+      schema_.SetValue(tuple, 0, grp ? Value(TypeId::INTEGER, *grp) : Value());
+      schema_.SetValue(tuple, 1, val ? Value(TypeId::BIGINT, *val) : Value());
+      schema_.SetValue(tuple, 2, Value(d));
+
+      Group &group = expected_[grp];
+      group.count_star_++;
+      if (val) {
+        group.count_++;
+        group.sum_ += *val;
+        group.min_ = std::min(group.min_.value_or(*val), *val);
+      }
+      group.max_ = std::max(group.max_.value_or(d), d);
+      group.sum_d_ += d;
+    });
+  }
+
+  auto MakeScan(TableHeap *table) -> std::unique_ptr<Operator> {
+    return std::make_unique<SeqScanOperator>(&ctx_, table, &schema_, std::vector<uint32_t>{0, 1, 2});
+  }
+
+  /** SELECT grp, COUNT(*), COUNT(val), SUM(val), MIN(val), MAX(d), AVG(val), SUM(d) FROM t GROUP BY grp */
+  auto MakeAggregate(HashAggregateOptions options) -> std::unique_ptr<HashAggregateOperator> {
+    std::vector<Aggregate> aggregates = {{AggregateType::COUNT_STAR}, {AggregateType::COUNT, 1},
+                                         {AggregateType::SUM, 1},     {AggregateType::MIN, 1},
+                                         {AggregateType::MAX, 2},     {AggregateType::AVG, 1},
+                                         {AggregateType::SUM, 2}};
+    return std::make_unique<HashAggregateOperator>(&ctx_, MakeScan(table_), std::vector<uint32_t>{0},
+                                                   aggregates, bpm_.get(), options);
+  }
+
+  void ExpectGroups(Operator *aggregate) {
+    aggregate->Init();
+    DataChunk chunk = aggregate->MakeChunk();
+    std::map<std::optional<int64_t>, Group> actual;
+    while (aggregate->Next(&chunk)) {
+      ASSERT_GT(chunk.GetSelectedCount(), 0U);
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        Value grp = chunk.GetValue(0, i);
+        std::optional<int64_t> key = grp.IsNull() ? std::nullopt : std::optional<int64_t>(grp.GetAsInteger());
+        ASSERT_EQ(actual.count(key), 0U) << "group " << grp.ToString() << " handed out twice";
+        Group &group = actual[key];
+        group.count_star_ = chunk.GetValue(1, i).GetAsInteger();
+        group.count_ = chunk.GetValue(2, i).GetAsInteger();
+        ASSERT_EQ(chunk.GetValue(3, i).IsNull(), group.count_ == 0);
+        ASSERT_EQ(chunk.GetValue(6, i).IsNull(), group.count_ == 0);
+        if (group.count_ > 0) {
+          group.sum_ = chunk.GetValue(3, i).GetAsInteger();
+          group.min_ = chunk.GetValue(4, i).GetAsInteger();
+          EXPECT_DOUBLE_EQ(chunk.GetValue(6, i).GetAsDouble(),
+                           static_cast<double>(group.sum_) / static_cast<double>(group.count_));
+        }
+        group.max_ = chunk.GetValue(5, i).GetAsDouble();
+        group.sum_d_ = chunk.GetValue(7, i).GetAsDouble();
+      }
+    }
+    ASSERT_EQ(actual.size(), expected_.size());
+    for (const auto &[key, group] : expected_) {
+      const Group &other = actual[key];
+      ASSERT_EQ(other.count_star_, group.count_star_);
+      ASSERT_EQ(other.count_, group.count_);
+      ASSERT_EQ(other.sum_, group.sum_);
+      ASSERT_EQ(other.min_, group.min_);
+      ASSERT_EQ(other.max_, group.max_);
+      ASSERT_EQ(other.sum_d_, group.sum_d_);
+    }
+  }
+
+  Schema schema_{{Column("grp", TypeId::INTEGER), Column("val", TypeId::BIGINT), Column("d", TypeId::DOUBLE)}};
+  ExecutorContext ctx_;
+  TableHeap *table_{nullptr};
+  std::map<std::optional<int64_t>, Group> expected_;
+};
+
+TEST_F(HashAggregateTest, AggregatesInMemoryAtAnyBatchSize) {
+  for (size_t batch_size : {1, 7, 1024}) {
+    for (size_t num_threads : {1, 4}) {
+      ctx_.batch_size_ = batch_size;
+      HashAggregateOptions options;
+      options.num_threads_ = num_threads;
+      auto aggregate = MakeAggregate(options);
+      ExpectGroups(aggregate.get());
+      EXPECT_EQ(aggregate->GetPartitionsSpilled(), 0U);
+    }
+  }
+}
+
+TEST_F(HashAggregateTest, SpillsPartitionsOverBudget) {
+  for (size_t num_threads : {1, 3}) {
+    HashAggregateOptions options;
+    // a few arena blocks per thread
+    options.memory_budget_ = num_threads * (200 << 10);
+    options.partition_bits_ = 3;
+    options.num_threads_ = num_threads;
+    auto aggregate = MakeAggregate(options);
+    ExpectGroups(aggregate.get());
+    EXPECT_GT(aggregate->GetPartitionsSpilled(), 4U);
+    // a second run starts over
+    ExpectGroups(aggregate.get());
+  }
+}
+
+TEST_F(HashAggregateTest, RunsOnTheWorkersOfAScheduler) {
+  TaskScheduler scheduler(3);
+  ctx_.scheduler_ = &scheduler;
+  for (size_t memory_budget : {size_t{64} << 20, size_t{600} << 10}) {
+    for (size_t batch_size : {7, 1024}) {
+      ctx_.batch_size_ = batch_size;
+      HashAggregateOptions options;
+      options.memory_budget_ = memory_budget;
+      options.partition_bits_ = 3;
+      auto aggregate = MakeAggregate(options);
+      ExpectGroups(aggregate.get());
+      EXPECT_EQ(aggregate->GetPartitionsSpilled() > 0, memory_budget < (1 << 20)) << "batch " << batch_size;
+    }
+  }
+}
+
+TEST_F(HashAggregateTest, NoGroupColumns) {
+  std::vector<Aggregate> aggregates = {{AggregateType::COUNT_STAR}, {AggregateType::SUM, 1}};
+  HashAggregateOptions options;
+  options.num_threads_ = 2;
+  HashAggregateOperator total(&ctx_, MakeScan(table_), {}, aggregates, bpm_.get(), options);
+  total.Init();
+  DataChunk chunk = total.MakeChunk();
+  ASSERT_TRUE(total.Next(&chunk));
+  ASSERT_EQ(chunk.GetSelectedCount(), 1U);
+  EXPECT_EQ(chunk.GetValue(0, 0).GetAsInteger(), 20000);
+  int64_t sum = 0;
+  for (const auto &[key, group] : expected_) {
+    sum += group.sum_;
+  }
+  EXPECT_EQ(chunk.GetValue(1, 0).GetAsInteger(), sum);
+  EXPECT_FALSE(total.Next(&chunk));
+
+  // an empty input still has its row: COUNT(*) 0, SUM NULL
+  TableHeap empty(bpm_.get());
+  HashAggregateOperator none(&ctx_, MakeScan(&empty), {}, aggregates, bpm_.get(), options);
+  none.Init();
+  ASSERT_TRUE(none.Next(&chunk));
+  ASSERT_EQ(chunk.GetSelectedCount(), 1U);
+  EXPECT_EQ(chunk.GetValue(0, 0).GetAsInteger(), 0);
+  EXPECT_TRUE(chunk.GetValue(1, 0).IsNull());
+  EXPECT_FALSE(none.Next(&chunk));
+}
+
+}  // namespace redbase
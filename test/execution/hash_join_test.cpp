@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/hash_join_operator.h"
+#include "execution/parallel_consume.h"
+#include "execution/seq_scan_operator.h"
+#include "rm/table_heap.h"
+#include "table_test_fixture.h"
+
+namespace redbase {
+
+class HashJoinTest : public TableTest {
+ protected:
+  void SetUp() override {
+    OpenDatabase("hash_join_test.db");
+    // orders: id, cust = id % 1000 (NULL for every 11th row)
+    orders_ = AddTable();
+    FillTable(orders_, orders_schema_, 6000, [&](char *tuple, int64_t id) {
+      orders_schema_.SetValue(tuple, 0, Value(TypeId::BIGINT, id));
+      orders_schema_.SetValue(tuple, 1, id % 11 == 0 ? Value() : Value(TypeId::INTEGER, id % 1000));
+    });
+    // customers: cust = id % 800, so that every key below 800 is there twice, and the id of the row
+    customers_ = AddTable();
+    FillTable(customers_, customers_schema_, 1600, [&](char *tuple, int64_t id) {
+      customers_schema_.SetValue(tuple, 0, Value(TypeId::BIGINT, id % 800));
+      customers_schema_.SetValue(tuple, 1, Value(TypeId::BIGINT, id));
+      customers_schema_.SetChar(tuple, 2, "name");
+    });
+  }
+
+  /** SELECT orders.id, customers.id FROM orders JOIN customers ON orders.cust = customers.cust */
+  auto MakeJoin(HashJoinOptions options) -> std::unique_ptr<HashJoinOperator> {
+    auto probe = std::make_unique<SeqScanOperator>(&ctx_, orders_, &orders_schema_, std::vector<uint32_t>{0, 1});
+    auto build =
+        std::make_unique<SeqScanOperator>(&ctx_, customers_, &customers_schema_, std::vector<uint32_t>{0, 1, 2});
+    return std::make_unique<HashJoinOperator>(&ctx_, std::move(probe), std::move(build), 1, 0, bpm_.get(), options);
+  }
+
+  /** @return the (order id, customer id) pairs of the join, sorted */
+  static auto Run(Operator *join) -> std::vector<std::pair<int64_t, int64_t>> {
+    std::vector<std::pair<int64_t, int64_t>> pairs;
+    join->Init();
+    DataChunk chunk = join->MakeChunk();
+    while (join->Next(&chunk)) {
+      EXPECT_GT(chunk.GetSelectedCount(), 0U);
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        EXPECT_EQ(chunk.GetValue(1, i).GetAsInteger(), chunk.GetValue(2, i).GetAsInteger());
+        pairs.emplace_back(chunk.GetValue(0, i).GetAsInteger(), chunk.GetValue(3, i).GetAsInteger());
+      }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  }
+
+  static auto ExpectedPairs() -> std::vector<std::pair<int64_t, int64_t>> {
+    std::vector<std::pair<int64_t, int64_t>> pairs;
+    for (int64_t id = 0; id < 6000; id++) {
+      if (id % 11 != 0 && id % 1000 < 800) {
+        pairs.emplace_back(id, id % 1000);
+        pairs.emplace_back(id, id % 1000 + 800);
+      }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  }
+
+  Schema orders_schema_{{Column("id", TypeId::BIGINT), Column("cust", TypeId::INTEGER)}};
+  Schema customers_schema_{
+      {Column("cust", TypeId::BIGINT), Column("id", TypeId::BIGINT), Column("name", TypeId::CHAR, 16)}};
+  ExecutorContext ctx_;
+  TableHeap *orders_{nullptr};
+  TableHeap *customers_{nullptr};
+};
+
+TEST_F(HashJoinTest, JoinsInMemoryAtAnyBatchSize) {
+  auto expected = ExpectedPairs();
+  for (size_t batch_size : {1, 7, 1024}) {
+    for (size_t num_threads : {1, 4}) {
+      ctx_.batch_size_ = batch_size;
+      HashJoinOptions options;
+      options.num_threads_ = num_threads;
+      auto join = MakeJoin(options);
+      ASSERT_EQ(Run(join.get()), expected) << "batch " << batch_size << ", threads " << num_threads;
+      EXPECT_EQ(join->GetPartitionsSpilled(), 0U);
+    }
+  }
+}
+
+TEST_F(HashJoinTest, SpillsPartitionsOverBudget) {
+  auto expected = ExpectedPairs();
+  for (size_t batch_size : {7, 1024}) {
+    ctx_.batch_size_ = batch_size;
+    HashJoinOptions options;
+    // about a tenth of the build rows fit
+    options.memory_budget_ = 8 << 10;
+    options.partition_bits_ = 4;
+    options.num_threads_ = 3;
+    auto join = MakeJoin(options);
+    ASSERT_EQ(Run(join.get()), expected) << "batch " << batch_size;
+    EXPECT_GT(join->GetPartitionsSpilled(), 8U);
+    // a second run starts over
+    ASSERT_EQ(Run(join.get()), expected) << "batch " << batch_size;
+  }
+}
+
+TEST_F(HashJoinTest, PeakMemoryStaysWithinBudget) {
+  // the tables take about as much as the rows they index, they count against the budget too
+  const size_t budget = 32 << 10;
+  HashJoinOptions options;
+  options.memory_budget_ = budget;
+  options.partition_bits_ = 4;
+  auto join = MakeJoin(options);
+  ASSERT_EQ(Run(join.get()), ExpectedPairs());
+  EXPECT_GT(join->GetPartitionsSpilled(), 0U);
+  EXPECT_LE(join->GetPeakMemory(), budget);
+  EXPECT_GT(join->GetPeakMemory(), budget / 2);
+}
+
+TEST_F(HashJoinTest, ProbesMorselsOnTheWorkersOfAScheduler) {
+  auto expected = ExpectedPairs();
+  TaskScheduler scheduler(3);
+  ctx_.scheduler_ = &scheduler;
+  for (size_t memory_budget : {size_t{64} << 20, size_t{8} << 10}) {
+    HashJoinOptions options;
+    options.memory_budget_ = memory_budget;
+    options.partition_bits_ = 4;
+    auto join = MakeJoin(options);
+    join->Init();
+    // in memory every worker probes morsels of orders, spilled the joined chunks are handed out to the workers
+    EXPECT_EQ(join->MakeWorker() == nullptr, join->GetPartitionsSpilled() > 0);
+    std::vector<std::vector<std::pair<int64_t, int64_t>>> pairs(scheduler.GetWorkerCount());
+    ParallelConsume(&ctx_, join.get(), 1, [&](const DataChunk &chunk, size_t thread_idx) {
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        pairs[thread_idx].emplace_back(chunk.GetValue(0, i).GetAsInteger(), chunk.GetValue(3, i).GetAsInteger());
+      }
+    });
+    std::vector<std::pair<int64_t, int64_t>> all;
+    for (const auto &worker_pairs : pairs) {
+      all.insert(all.end(), worker_pairs.begin(), worker_pairs.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all, expected) << "budget " << memory_budget;
+  }
+}
+
+}  // namespace redbase
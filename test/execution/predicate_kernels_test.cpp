@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "execution/predicate_kernels.h"
+
+namespace redbase {
+
+/** @return the kernels the CPU supports */
+static auto SupportedKernels() -> std::vector<SelectKernel> {
+  std::vector<SelectKernel> kernels = {SelectKernel::SCALAR};
+  if (GetSelectKernel() != SelectKernel::SCALAR) {
+    kernels.push_back(SelectKernel::AVX2);
+  }
+  if (GetSelectKernel() == SelectKernel::AVX512) {
+    kernels.push_back(SelectKernel::AVX512);
+  }
+  return kernels;
+}
+
+template <typename T>
+static auto Matches(const ColumnPredicate<T> &predicate, T value) -> bool {
+  switch (predicate.kind_) {
+    case PredicateKind::BETWEEN:
+      return predicate.low_ <= value && value <= predicate.high_;
+    case PredicateKind::IN:
+      return std::find(predicate.in_list_.begin(), predicate.in_list_.end(), value) != predicate.in_list_.end();
+    case PredicateKind::COMPARE:
+      break;
+  }
+  switch (predicate.comparison_type_) {
+    case ComparisonType::EQUAL:
+      return value == predicate.low_;
+    case ComparisonType::NOT_EQUAL:
+      return value != predicate.low_;
+    case ComparisonType::LESS_THAN:
+      return value < predicate.low_;
+    case ComparisonType::LESS_EQUAL:
+      return value <= predicate.low_;
+    case ComparisonType::GREATER_THAN:
+      return value > predicate.low_;
+    case ComparisonType::GREATER_EQUAL:
+      return value >= predicate.low_;
+  }
+  return false;
+}
+
+template <typename T>
+static void CheckKernels() {
+  std::mt19937_64 rng(11);
+  std::vector<ColumnPredicate<T>> predicates = {ColumnPredicate<T>::Between(-3, 4), ColumnPredicate<T>::In({}),
+                                                ColumnPredicate<T>::In({-7, 0, 2, 9})};
+  for (auto comparison_type : {ComparisonType::EQUAL, ComparisonType::NOT_EQUAL, ComparisonType::LESS_THAN,
+                               ComparisonType::LESS_EQUAL, ComparisonType::GREATER_THAN,
+                               ComparisonType::GREATER_EQUAL}) {
+    predicates.push_back(ColumnPredicate<T>::Compare(comparison_type, 1));
+  }
+  // lengths around the vector widths, so that every kernel runs its scalar tail
+  for (size_t n : {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 64, 100, 1000}) {
+    std::vector<T> data(n);
+    std::vector<uint8_t> nulls(n);
+    for (size_t i = 0; i < n; i++) {
+      data[i] = static_cast<T>(static_cast<int64_t>(rng() % 21) - 10);
+      nulls[i] = rng() % 5 == 0 ? 1 : 0;
+    }
+    if (n > 2) {
+      data[0] = std::numeric_limits<T>::lowest();
+      data[n - 1] = std::numeric_limits<T>::max();
+    }
+    // a sparse selection: every row with probability 1/2
+    std::vector<uint32_t> selection;
+    for (uint32_t i = 0; i < n; i++) {
+      if (rng() % 2 == 0) {
+        selection.push_back(i);
+      }
+    }
+    for (const auto &predicate : predicates) {
+      std::vector<uint32_t> expected_dense;
+      std::vector<uint32_t> expected_sparse;
+      for (uint32_t i = 0; i < n; i++) {
+        if (nulls[i] == 0 && Matches(predicate, data[i])) {
+          expected_dense.push_back(i);
+        }
+      }
+      for (auto row : selection) {
+        if (nulls[row] == 0 && Matches(predicate, data[row])) {
+          expected_sparse.push_back(row);
+        }
+      }
+      for (auto kernel : SupportedKernels()) {
+        std::vector<uint32_t> out(n);
+        out.resize(SelectRows(predicate, data.data(), nulls.data(), nullptr, n, out.data(), kernel));
+        ASSERT_EQ(out, expected_dense) << SelectKernelName(kernel) << " n=" << n;
+
+        // refined in place
+        std::vector<uint32_t> rows = selection;
+        rows.resize(SelectRows(predicate, data.data(), nulls.data(), rows.data(), rows.size(), rows.data(), kernel));
+        ASSERT_EQ(rows, expected_sparse) << SelectKernelName(kernel) << " n=" << n;
+
+        std::vector<uint64_t> bitmap((n + 63) / 64, ~uint64_t{0});
+        SelectBitmap(predicate, data.data(), nulls.data(), n, bitmap.data(), kernel);
+        std::vector<uint32_t> from_bitmap(n);
+        from_bitmap.resize(BitmapToSelection(bitmap.data(), n, from_bitmap.data()));
+        ASSERT_EQ(from_bitmap, expected_dense) << SelectKernelName(kernel) << " n=" << n;
+      }
+    }
+  }
+}
+
+TEST(PredicateKernelsTest, KernelsMatchScalarPredicates) {
+  CheckKernels<int32_t>();
+  CheckKernels<int64_t>();
+  CheckKernels<double>();
+}
+
+TEST(PredicateKernelsTest, ConjunctionRefinesSelection) {
+  // a BETWEEN 10 AND 50 AND b IN (1, 3) AND a <> 21
+  size_t n = 1000;
+  std::vector<int32_t> a(n);
+  std::vector<int64_t> b(n);
+  std::vector<uint8_t> nulls(n, 0);
+  std::iota(a.begin(), a.end(), 0);
+  for (size_t i = 0; i < n; i++) {
+    b[i] = static_cast<int64_t>(i % 4);
+  }
+  std::vector<uint32_t> rows(n);
+  for (auto kernel : SupportedKernels()) {
+    size_t count = SelectRows(ColumnPredicate<int32_t>::Between(10, 50), a.data(), nulls.data(), nullptr, n,
+                              rows.data(), kernel);
+    count = SelectRows(ColumnPredicate<int64_t>::In({1, 3}), b.data(), nulls.data(), rows.data(), count, rows.data(),
+                       kernel);
+    count = SelectRows(ColumnPredicate<int32_t>::Compare(ComparisonType::NOT_EQUAL, 21), a.data(), nulls.data(),
+                       rows.data(), count, rows.data(), kernel);
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 11; i <= 49; i += 2) {
+      if (i != 21) {
+        expected.push_back(i);
+      }
+    }
+    EXPECT_EQ(std::vector<uint32_t>(rows.begin(), rows.begin() + count), expected) << SelectKernelName(kernel);
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "buffer/sorted_run.h"
+#include "execution/seq_scan_operator.h"
+#include "execution/sort_operator.h"
+#include "sort_rows_fixture.h"
+
+namespace redbase {
+
+class SortOperatorTest : public SortRowsTest {
+ protected:
+  void SetUp() override {
+    OpenDatabase("sort_operator_test.db");
+    table_ = AddTable();
+    FillRows(7, 5000, 50);
+  }
+
+  auto MakeSort(std::vector<SortKey> keys, ExternalSortOptions options) -> std::unique_ptr<SortOperator> {
+    auto scan = std::make_unique<SeqScanOperator>(&ctx_, table_, &schema_, std::vector<uint32_t>{0, 1, 2, 3});
+    return std::make_unique<SortOperator>(&ctx_, std::move(scan), std::move(keys), bpm_.get(), options);
+  }
+};
+
+TEST_F(SortOperatorTest, SortsInMemoryAtAnyBatchSize) {
+  auto expected = SortedIds();
+  for (size_t batch_size : {1, 7, 1024}) {
+    for (size_t num_threads : {1, 4}) {
+      ctx_.batch_size_ = batch_size;
+      ExternalSortOptions options;
+      options.num_threads_ = num_threads;
+      auto sort = MakeSort(Keys(), options);
+      ASSERT_EQ(Run(sort.get()), expected) << "batch " << batch_size << ", threads " << num_threads;
+      EXPECT_EQ(sort->GetRunsSpilled(), 0U);
+    }
+  }
+}
+
+TEST_F(SortOperatorTest, SpillsAndMergesRunsOverBudget) {
+  auto expected = SortedIds();
+  for (size_t batch_size : {7, 1024}) {
+    ctx_.batch_size_ = batch_size;
+    ExternalSortOptions options;
+    // a run per chunk at most, merged two at a time over several passes
+    options.memory_budget_ = 16 << 10;
+    options.max_fan_in_ = 2;
+    options.num_threads_ = 2;
+    auto sort = MakeSort(Keys(), options);
+    ASSERT_EQ(Run(sort.get()), expected) << "batch " << batch_size;
+    EXPECT_GT(sort->GetRunsSpilled(), 4U);
+    // a second run starts over
+    ASSERT_EQ(Run(sort.get()), expected) << "batch " << batch_size;
+  }
+}
+
+TEST_F(SortOperatorTest, RunsDeleteThePagesLeftWhenDropped) {
+  // a run dropped half way through, as when a merge throws, gives the pages it has not read back to the pool
+  std::vector<char> record(1000, 'r');
+  size_t records_per_page = (PAGE_SIZE - 8) / record.size();
+  size_t num_pages = 10;
+  page_id_t marker;
+  {
+    SortedRun run(bpm_.get(), record.size(), "test: run");
+    for (size_t i = 0; i < num_pages * records_per_page; i++) {
+      run.Append(record.data());
+    }
+    run.Finish();
+    ASSERT_TRUE(bpm_->NewPageGuarded(&marker).IsValid());
+    ASSERT_NE(run.Advance(), nullptr);
+  }
+  // the pages of the run come before the marker, and are handed out again first
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    ASSERT_TRUE(bpm_->NewPageGuarded(&page_id).IsValid());
+    EXPECT_LT(page_id, marker);
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "execution/operator.h"
+#include "execution/sort_key.h"
+#include "fmt/format.h"
+#include "rm/schema.h"
+#include "table_test_fixture.h"
+
+namespace redbase {
+
+/**
+ * SortRowsTest is the fixture of the tests of the ordering operators: a table of (grp, score, id, name) rows drawn
+ * at random, with NULLs and repeated keys, and the rows themselves to check an order against.
+ */
+class SortRowsTest : public TableTest {
+ protected:
+  /** (grp, score, id, name) of a row; grp and score may be NULL */
+  struct Row {
+    std::optional<int64_t> grp_;
+    std::optional<double> score_;
+    int64_t id_;
+    std::string name_;
+  };
+
+  /** Fills `table_` with `count` rows drawn from `seed`, grp out of `groups` values around 0 */
+  void FillRows(uint64_t seed, int64_t count, int64_t groups) {
+    std::mt19937_64 rng(seed);
+    FillTable(table_, schema_, count, [&](char *tuple, int64_t id) {
+      Row row{static_cast<int64_t>(rng() % groups) - groups / 2, static_cast<double>(rng() % 2001) / 8 - 125, id,
+              fmt::format("n{}", rng() % 300)};
+      if (rng() % 13 == 0) {
+        row.grp_.reset();
+      }
+      if (rng() % 17 == 0) {
+        row.score_.reset();
+      }
+      schema_.SetValue(tuple, 0, row.grp_ ? Value(TypeId::INTEGER, *row.grp_) : Value());
+      schema_.SetValue(tuple, 1, row.score_ ? Value(*row.score_) : Value());
+      schema_.SetValue(tuple, 2, Value(TypeId::BIGINT, id));
+      schema_.SetChar(tuple, 3, row.name_);
+      rows_.push_back(row);
+    });
+  }
+
+  /** @return the ids of the rows in the order `op` hands them out, checking the other columns came along */
+  auto Run(Operator *op) -> std::vector<int64_t> {
+    std::vector<int64_t> ids;
+    op->Init();
+    DataChunk chunk = op->MakeChunk();
+    while (op->Next(&chunk)) {
+      EXPECT_GT(chunk.GetSelectedCount(), 0U);
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        int64_t id = chunk.GetValue(2, i).GetAsInteger();
+        const Row &row = rows_[id];
+        EXPECT_EQ(chunk.GetValue(0, i).IsNull(), !row.grp_.has_value());
+        EXPECT_EQ(chunk.GetValue(1, i).IsNull(), !row.score_.has_value());
+        const Vector &name = chunk.GetColumn(3);
+        EXPECT_STREQ(name.GetData() + chunk.GetSelection()[i] * name.GetWidth(), row.name_.c_str());
+        ids.push_back(id);
+      }
+    }
+    return ids;
+  }
+
+  /** ORDER BY grp ASC, score DESC, name ASC, id ASC: every key is unique so that the order is total */
+  static auto Keys() -> std::vector<SortKey> { return {{0, true}, {1, false}, {3, true}, {2, true}}; }
+
+  /** @return the ids of every row in the order of Keys() */
+  auto SortedIds() const -> std::vector<int64_t> {
+    std::vector<Row> sorted = rows_;
+    // NULLs first when ascending, last when descending
+    std::sort(sorted.begin(), sorted.end(), [](const Row &lhs, const Row &rhs) {
+      auto grp = [](const Row &row) { return std::make_tuple(row.grp_.has_value(), row.grp_.value_or(0)); };
+      auto score = [](const Row &row) { return std::make_tuple(row.score_.has_value(), row.score_.value_or(0)); };
+      if (grp(lhs) != grp(rhs)) {
+        return grp(lhs) < grp(rhs);
+      }
+      if (score(lhs) != score(rhs)) {
+        return score(lhs) > score(rhs);
+      }
+      return std::tie(lhs.name_, lhs.id_) < std::tie(rhs.name_, rhs.id_);
+    });
+    std::vector<int64_t> ids;
+    for (const auto &row : sorted) {
+      ids.push_back(row.id_);
+    }
+    return ids;
+  }
+
+  Schema schema_{{Column("grp", TypeId::INTEGER), Column("score", TypeId::DOUBLE), Column("id", TypeId::BIGINT),
+                  Column("name", TypeId::CHAR, 12)}};
+  ExecutorContext ctx_;
+  TableHeap *table_{nullptr};
+  std::vector<Row> rows_;
+};
+
+}  // namespace redbase
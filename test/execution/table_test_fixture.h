@@ -0,0 +1,65 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "pf/pf_manager.h"
+#include "rm/schema.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+/**
+ * TableTest is the fixture of the operator tests: a buffer pool of 64 frames over a database file of their own, and
+ * the table heaps they scan. The heaps belong to the fixture and are dropped before the file is shut down.
+ */
+class TableTest : public ::testing::Test {
+ protected:
+  /** Opens a buffer pool over a fresh `file`, first thing in SetUp() */
+  void OpenDatabase(const std::string &file) {
+    remove(file.c_str());
+    pf_manager_ = std::make_unique<PFManager>(file);
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  /** @return a new, empty table heap */
+  auto AddTable() -> TableHeap * {
+    tables_.push_back(std::make_unique<TableHeap>(bpm_.get()));
+    return tables_.back().get();
+  }
+
+  /**
+   * Inserts `count` tuples of `schema` into `table`.
+   * @param fill called as fill(tuple, i) to set the columns of the i-th tuple, whose bytes start out zeroed
+   */
+  template <typename Fill>
+  void FillTable(TableHeap *table, const Schema &schema, int64_t count, Fill &&fill) {
+    std::vector<char> tuple(schema.GetTupleSize());
+    for (int64_t i = 0; i < count; i++) {
+      std::fill(tuple.begin(), tuple.end(), 0);
+      std::forward<Fill>(fill)(tuple.data(), i);
+      ASSERT_TRUE(table->InsertTuple({false}, tuple.data(), tuple.size()).has_value());
+    }
+  }
+
+  /** Drops the tables, then shuts the file down */
+  void TearDown() override {
+    tables_.clear();
+    if (pf_manager_ != nullptr) {
+      pf_manager_->Shutdown();
+    }
+  }
+
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::vector<std::unique_ptr<TableHeap>> tables_;
+};
+
+}  // namespace redbase
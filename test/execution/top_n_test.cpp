@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "execution/seq_scan_operator.h"
+#include "execution/top_n_operator.h"
+#include "rm/zone_map.h"
+#include "sort_rows_fixture.h"
+
+namespace redbase {
+
+class TopNTest : public SortRowsTest {
+ protected:
+  void SetUp() override {
+    OpenDatabase("top_n_test.db");
+    table_ = AddTable();
+    zone_map_ = std::make_unique<ZoneMap>(bpm_.get(), &schema_, std::vector<uint32_t>{0, 1, 2});
+    table_->SetZoneMap(zone_map_.get());
+    FillRows(11, 8000, 400);
+  }
+
+  void TearDown() override {
+    tables_.clear();
+    zone_map_.reset();
+    SortRowsTest::TearDown();
+  }
+
+  /**
+   * @return a Top-N over a scan of every column; with `filter`, the scan checks the dynamic filter of the Top-N on
+   * the column of the first key
+   */
+  auto MakeTopN(std::vector<SortKey> keys, size_t limit, size_t offset, size_t num_threads, bool filter)
+      -> std::unique_ptr<TopNOperator> {
+    auto scan = std::make_unique<SeqScanOperator>(&ctx_, table_, &schema_, std::vector<uint32_t>{0, 1, 2, 3});
+    scan_ = scan.get();
+    uint32_t first_col = keys.front().col_idx_;
+    TopNOptions options;
+    options.num_threads_ = num_threads;
+    auto top_n = std::make_unique<TopNOperator>(&ctx_, std::move(scan), std::move(keys), limit, offset, options);
+    if (filter) {
+      scan_->SetDynamicFilter(top_n->MakeDynamicFilter(first_col));
+    }
+    return top_n;
+  }
+
+  /** @return the ids of the rows [offset, offset + limit) of the order of Keys() */
+  auto ExpectedIds(size_t limit, size_t offset) const -> std::vector<int64_t> {
+    std::vector<int64_t> sorted = SortedIds();
+    size_t begin = std::min(sorted.size(), offset);
+    size_t end = std::min(sorted.size(), offset + limit);
+    return {sorted.begin() + begin, sorted.begin() + end};
+  }
+
+  std::unique_ptr<ZoneMap> zone_map_;
+  SeqScanOperator *scan_{nullptr};
+};
+
+TEST_F(TopNTest, MatchesSortAtAnyBatchSize) {
+  for (size_t batch_size : {1, 7, 1024}) {
+    for (size_t num_threads : {1, 4}) {
+      for (auto [limit, offset] : {std::pair<size_t, size_t>{10, 0}, {100, 35}, {0, 5}, {20, 7990}, {50, 9000}}) {
+        for (bool filter : {false, true}) {
+          ctx_.batch_size_ = batch_size;
+          auto top_n = MakeTopN(Keys(), limit, offset, num_threads, filter);
+          ASSERT_EQ(Run(top_n.get()), ExpectedIds(limit, offset))
+              << "batch " << batch_size << ", threads " << num_threads << ", limit " << limit << ", offset "
+              << offset << ", filter " << filter;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TopNTest, DynamicFilterSkipsPages) {
+  // ids grow with the pages: once the first rows are in, no later page can beat them
+  for (size_t num_threads : {1, 4}) {
+    auto top_n = MakeTopN({{2, true}}, 10, 0, num_threads, true);
+    std::vector<int64_t> expected = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ASSERT_EQ(Run(top_n.get()), expected);
+    EXPECT_GT(scan_->GetPagesSkipped(), 0U);
+    // a second run starts over, under the range the first one left
+    ASSERT_EQ(Run(top_n.get()), expected);
+  }
+
+  // the best scores are scattered over the pages, the rows past the worst of them are dropped by the scan
+  ctx_.batch_size_ = 64;
+  for (bool ascending : {true, false}) {
+    auto top_n = MakeTopN({{1, ascending}, {2, true}}, 30, 0, 1, true);
+    std::vector<Row> sorted = rows_;
+    std::sort(sorted.begin(), sorted.end(), [ascending](const Row &lhs, const Row &rhs) {
+      auto score = [](const Row &row) { return std::make_tuple(row.score_.has_value(), row.score_.value_or(0)); };
+      if (score(lhs) != score(rhs)) {
+        return ascending ? score(lhs) < score(rhs) : score(lhs) > score(rhs);
+      }
+      return lhs.id_ < rhs.id_;
+    });
+    std::vector<int64_t> expected;
+    for (size_t i = 0; i < 30; i++) {
+      expected.push_back(sorted[i].id_);
+    }
+    ASSERT_EQ(Run(top_n.get()), expected) << "ascending " << ascending;
+    EXPECT_GT(scan_->GetRowsFiltered(), 0U);
+  }
+}
+
+}  // namespace redbase
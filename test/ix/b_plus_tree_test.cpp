@@ -0,0 +1,393 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "ix/b_plus_tree.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+using Key = GenericKey<16>;
+using Comparator = GenericComparator<16>;
+using Tree = BPlusTree<Key, RID, Comparator>;
+
+static auto MakeKey(const Schema &key_schema, int64_t v) -> Key {
+  char tuple[16] = {0};
+  key_schema.SetValue(tuple, 0, Value(TypeId::BIGINT, v));
+  Key key;
+  key.SetFromKey(tuple, key_schema.GetTupleSize());
+  return key;
+}
+
+static auto KeyValue(const Schema &key_schema, const Key &key) -> int64_t {
+  return key_schema.GetValue(key.data_, 0).GetAsInteger();
+}
+
+class BPlusTreeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("b_plus_tree_test.db");
+    pf_manager_ = std::make_unique<PFManager>("b_plus_tree_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  Schema key_schema_{{Column("k", TypeId::BIGINT)}};
+  Comparator comparator_{&key_schema_};
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(BPlusTreeTest, InsertLookupAndRangeScan) {
+  // tiny nodes, so that the tree grows a few levels
+  Tree tree("index", bpm_.get(), comparator_, 3, 4);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  std::vector<int64_t> keys(500);
+  for (int i = 0; i < 500; i++) {
+    keys[i] = i * 2;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (auto k : keys) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(static_cast<page_id_t>(k), 0)));
+  }
+  EXPECT_FALSE(tree.Insert(MakeKey(key_schema_, 10), RID(0, 0)));
+
+  std::vector<RID> result;
+  for (int64_t k = 0; k < 1000; k++) {
+    result.clear();
+    EXPECT_EQ(k % 2 == 0, tree.GetValue(MakeKey(key_schema_, k), &result));
+    if (k % 2 == 0) {
+      EXPECT_EQ(static_cast<page_id_t>(k), result[0].GetPageId());
+    }
+  }
+
+  int64_t expected = 101 + 1;
+  for (auto iter = tree.Begin(MakeKey(key_schema_, 101)); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ(expected, KeyValue(key_schema_, (*iter).first));
+    expected += 2;
+  }
+  EXPECT_EQ(1000, expected);
+
+  // reopen from the header page
+  Tree reopened("index", tree.GetHeaderPageId(), bpm_.get(), comparator_, 3, 4);
+  result.clear();
+  EXPECT_TRUE(reopened.GetValue(MakeKey(key_schema_, 998), &result));
+}
+
+TEST_F(BPlusTreeTest, RemoveMergesAndRedistributes) {
+  Tree tree("index", bpm_.get(), comparator_, 3, 4);
+  const int64_t n = 400;
+  for (int64_t k = 0; k < n; k++) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k))));
+  }
+
+  std::vector<int64_t> keys(n);
+  for (int64_t k = 0; k < n; k++) {
+    keys[k] = k;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  std::vector<int64_t> removed(keys.begin(), keys.begin() + n / 2);
+  for (auto k : removed) {
+    ASSERT_TRUE(tree.Remove(MakeKey(key_schema_, k)));
+  }
+  EXPECT_FALSE(tree.Remove(MakeKey(key_schema_, removed[0])));
+
+  std::vector<int64_t> remaining(keys.begin() + n / 2, keys.end());
+  std::sort(remaining.begin(), remaining.end());
+  size_t i = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter, ++i) {
+    ASSERT_LT(i, remaining.size());
+    EXPECT_EQ(remaining[i], KeyValue(key_schema_, (*iter).first));
+  }
+  EXPECT_EQ(remaining.size(), i);
+
+  for (auto k : remaining) {
+    ASSERT_TRUE(tree.Remove(MakeKey(key_schema_, k)));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin().IsEnd());
+}
+
+TEST_F(BPlusTreeTest, NonUniqueKeys) {
+  using MultiTree = BPlusTree<NonUniqueKey<Key>, RID, NonUniqueComparator<Key, Comparator>>;
+  MultiTree tree("multi", bpm_.get(), NonUniqueComparator<Key, Comparator>(comparator_), 4, 4);
+  for (int64_t k = 0; k < 50; k++) {
+    for (uint32_t dup = 0; dup < 5; dup++) {
+      RID rid(static_cast<page_id_t>(k), dup);
+      ASSERT_TRUE(tree.Insert({MakeKey(key_schema_, k), rid}, rid));
+    }
+  }
+
+  std::vector<RID> rids;
+  EXPECT_TRUE(GetAllValues(tree, MakeKey(key_schema_, 17), &rids));
+  ASSERT_EQ(5U, rids.size());
+  for (uint32_t dup = 0; dup < 5; dup++) {
+    EXPECT_EQ(RID(17, dup), rids[dup]);
+  }
+
+  ASSERT_TRUE(tree.Remove({MakeKey(key_schema_, 17), RID(17, 2)}));
+  rids.clear();
+  GetAllValues(tree, MakeKey(key_schema_, 17), &rids);
+  EXPECT_EQ(4U, rids.size());
+  rids.clear();
+  EXPECT_FALSE(GetAllValues(tree, MakeKey(key_schema_, 50), &rids));
+}
+
+TEST_F(BPlusTreeTest, ConcurrentInsertRemoveLookup) {
+  Tree tree("index", bpm_.get(), comparator_, 8, 8);
+  const int num_threads = 8;
+  const int64_t per_thread = 1000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int64_t i = 0; i < per_thread; i++) {
+        int64_t k = i * num_threads + t;
+        ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k))));
+        std::vector<RID> result;
+        ASSERT_TRUE(tree.GetValue(MakeKey(key_schema_, k), &result));
+      }
+      // every thread removes the odd keys it inserted
+      for (int64_t i = 1; i < per_thread; i += 2) {
+        ASSERT_TRUE(tree.Remove(MakeKey(key_schema_, i * num_threads + t)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t count = 0;
+  int64_t last = -1;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    int64_t k = KeyValue(key_schema_, (*iter).first);
+    EXPECT_LT(last, k);
+    EXPECT_EQ(0, (k / num_threads) % 2);
+    last = k;
+    count++;
+  }
+  EXPECT_EQ(num_threads * per_thread / 2, count);
+}
+
+TEST_F(BPlusTreeTest, OptimisticLookupsDuringStructureChanges) {
+  Tree tree("index", bpm_.get(), comparator_, 4, 4);
+  // even keys are there from the start and must stay visible while writers split and merge nodes around them
+  const int64_t n = 2000;
+  for (int64_t k = 0; k < n; k += 2) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k))));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t k = 1 + 2 * t; k < n; k += 4) {
+          tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k)));
+        }
+        for (int64_t k = 1 + 2 * t; k < n; k += 4) {
+          tree.Remove(MakeKey(key_schema_, k));
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  std::atomic<int64_t> misses{0};
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<RID> result;
+      while (!done) {
+        int64_t k = (rng() % (n / 2)) * 2;
+        result.clear();
+        if (!tree.GetValue(MakeKey(key_schema_, k), &result) || result[0].GetSlotNum() != static_cast<uint32_t>(k)) {
+          misses++;
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, misses);
+
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ(expected, KeyValue(key_schema_, (*iter).first));
+    expected += 2;
+  }
+  EXPECT_EQ(n, expected);
+}
+
+TEST_F(BPlusTreeTest, BatchedLookupsKeepCallerOrder) {
+  Tree tree("index", bpm_.get(), comparator_, 4, 5);
+  std::vector<RID> scratch;
+  std::vector<std::optional<RID>> results;
+  EXPECT_EQ(0, tree.GetValues({MakeKey(key_schema_, 1)}, &results));
+  EXPECT_FALSE(results[0].has_value());
+
+  for (int64_t k = 0; k < 2000; k += 2) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k))));
+  }
+  // dense runs that walk sibling leaves, sparse keys that descend again, duplicates and keys past both ends
+  std::vector<int64_t> values;
+  for (int64_t k = 500; k < 700; k++) {
+    values.push_back(k);
+  }
+  for (int64_t k = -50; k < 2100; k += 97) {
+    values.push_back(k);
+  }
+  values.push_back(600);
+  values.push_back(1998);
+  std::shuffle(values.begin(), values.end(), std::mt19937(7));
+  std::vector<Key> keys;
+  size_t expected_found = 0;
+  for (auto v : values) {
+    keys.push_back(MakeKey(key_schema_, v));
+    expected_found += v >= 0 && v < 2000 && v % 2 == 0 ? 1 : 0;
+  }
+
+  EXPECT_EQ(expected_found, tree.GetValues(keys, &results));
+  ASSERT_EQ(keys.size(), results.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    scratch.clear();
+    bool found = tree.GetValue(keys[i], &scratch);
+    ASSERT_EQ(found, results[i].has_value()) << values[i];
+    if (found) {
+      EXPECT_EQ(static_cast<uint32_t>(values[i]), results[i]->GetSlotNum());
+    }
+  }
+}
+
+TEST_F(BPlusTreeTest, BatchedLookupsDuringMerges) {
+  Tree tree("index", bpm_.get(), comparator_, 4, 4);
+  // the even keys stay while writers split and merge the leaves around them; the batches are dense runs of them, so
+  // the lookups keep hopping to sibling leaves that the writers are merging away
+  const int64_t n = 2000;
+  for (int64_t k = 0; k < n; k += 2) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k))));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      for (int round = 0; round < 3; round++) {
+        for (int64_t k = 1 + 2 * t; k < n; k += 4) {
+          tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k)));
+        }
+        for (int64_t k = 1 + 2 * t; k < n; k += 4) {
+          tree.Remove(MakeKey(key_schema_, k));
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  std::atomic<int64_t> misses{0};
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<Key> keys;
+      std::vector<std::optional<RID>> results;
+      while (!done) {
+        int64_t first = (rng() % (n / 2 - 64)) * 2;
+        keys.clear();
+        for (int64_t k = first; k < first + 128; k += 2) {
+          keys.push_back(MakeKey(key_schema_, k));
+        }
+        tree.GetValues(keys, &results);
+        for (size_t i = 0; i < keys.size(); i++) {
+          if (!results[i].has_value() || results[i]->GetSlotNum() != static_cast<uint32_t>(first + 2 * i)) {
+            misses++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, misses);
+}
+
+TEST_F(BPlusTreeTest, BatchedLookupsDuringRemoves) {
+  Tree tree("index", bpm_.get(), comparator_, 4, 4);
+  // the multiples of 8 stay, the odd keys between them are removed and put back over and over, so that leaves empty
+  // out and merge away while the batches hop from leaf to leaf; keys 4 mod 8 are never there
+  const int64_t n = 2400;
+  for (int64_t k = 0; k < n; k++) {
+    if (k % 8 == 0 || k % 2 == 1) {
+      ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k))));
+    }
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; t++) {
+    writers.emplace_back([&, t] {
+      for (int round = 0; round < 4; round++) {
+        // a stretch of leaves at a time, so that whole leaves are left with nothing but removed keys
+        for (int64_t first = t * n / 2; first < (t + 1) * n / 2; first += 96) {
+          for (int64_t k = first + 1; k < first + 96; k += 2) {
+            tree.Remove(MakeKey(key_schema_, k));
+          }
+        }
+        for (int64_t k = t * n / 2 + 1; k < (t + 1) * n / 2; k += 2) {
+          tree.Insert(MakeKey(key_schema_, k), RID(0, static_cast<uint32_t>(k)));
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  std::atomic<int64_t> wrong{0};
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<Key> keys;
+      std::vector<std::optional<RID>> results;
+      while (!done) {
+        int64_t first = (rng() % (n / 8 - 32)) * 8;
+        keys.clear();
+        for (int64_t k = first; k < first + 256; k += 4) {
+          keys.push_back(MakeKey(key_schema_, k));
+        }
+        tree.GetValues(keys, &results);
+        for (size_t i = 0; i < keys.size(); i++) {
+          int64_t k = first + 4 * static_cast<int64_t>(i);
+          bool expected = k % 8 == 0;
+          if (results[i].has_value() != expected ||
+              (expected && results[i]->GetSlotNum() != static_cast<uint32_t>(k))) {
+            wrong++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, wrong);
+}
+
+}  // namespace redbase
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "ix/b_plus_tree.h"
+#include "ix/bloom_filter.h"
+#include "ix/extendible_hash_index.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+class BloomFilterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("bloom_filter_test.db");
+    pf_manager_ = std::make_unique<PFManager>("bloom_filter_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(BloomFilterTest, FalsePositiveRateAndPersistence) {
+  BloomFilterOptions options;
+  options.expected_keys_ = 100000;
+  options.false_positive_rate_ = 0.01;
+  BloomFilter filter(bpm_.get(), options);
+  EXPECT_LE(filter.EstimateFalsePositiveRate(filter.GetNumBlocks(), options.expected_keys_), 0.01);
+
+  for (uint64_t k = 0; k < options.expected_keys_; k++) {
+    filter.Insert(HashUtil::Mix(k));
+  }
+  for (uint64_t k = 0; k < options.expected_keys_; k++) {
+    ASSERT_TRUE(filter.MayContain(HashUtil::Mix(k))) << k;
+  }
+  uint64_t passed = 0;
+  for (uint64_t k = options.expected_keys_; k < 2 * options.expected_keys_; k++) {
+    passed += filter.MayContain(HashUtil::Mix(k)) ? 1 : 0;
+  }
+  EXPECT_LT(passed, options.expected_keys_ * 2 / 100);
+  auto stats = filter.GetStats();
+  EXPECT_EQ(stats.passed_, options.expected_keys_ + passed);
+  EXPECT_EQ(stats.skipped_, options.expected_keys_ - passed);
+
+  // the filter spans several pages
+  filter.Flush();
+  BloomFilter loaded(bpm_.get(), filter.GetFirstPageId());
+  EXPECT_EQ(loaded.GetNumBlocks(), filter.GetNumBlocks());
+  EXPECT_EQ(loaded.GetNumKeys(), options.expected_keys_);
+  for (uint64_t k = 0; k < 2 * options.expected_keys_; k++) {
+    ASSERT_EQ(loaded.MayContain(HashUtil::Mix(k)), k < options.expected_keys_ || filter.MayContain(HashUtil::Mix(k)));
+  }
+
+  // a budget below the target rate's size wins
+  options.max_bytes_ = 16 * 1024;
+  BloomFilter small(bpm_.get(), options);
+  EXPECT_EQ(small.GetSizeBytes(), options.max_bytes_);
+  EXPECT_GT(small.EstimateFalsePositiveRate(small.GetNumBlocks(), options.expected_keys_), 0.01);
+}
+
+TEST_F(BloomFilterTest, IndexesSkipAbsentKeys) {
+  BloomFilterOptions options;
+  options.expected_keys_ = 2000;
+  BloomFilter tree_filter(bpm_.get(), options);
+  BloomFilter hash_filter(bpm_.get(), options);
+  BPlusTree<int64_t, RID, IntegerComparator<int64_t>> tree("tree", bpm_.get(), IntegerComparator<int64_t>());
+  ExtendibleHashIndex<int64_t, RID, IntegerComparator<int64_t>> hash_index("hash", bpm_.get(),
+                                                                          IntegerComparator<int64_t>());
+  tree.SetBloomFilter(&tree_filter);
+  hash_index.SetBloomFilter(&hash_filter);
+  for (int64_t k = 0; k < 2000; k++) {
+    ASSERT_TRUE(tree.Insert(2 * k, RID(0, static_cast<uint32_t>(k))));
+    ASSERT_TRUE(hash_index.Insert(2 * k, RID(0, static_cast<uint32_t>(k))));
+  }
+
+  for (int64_t k = 0; k < 4000; k++) {
+    std::vector<RID> result;
+    ASSERT_EQ(tree.GetValue(k, &result), k % 2 == 0);
+    ASSERT_EQ(hash_index.GetValue(k, &result), k % 2 == 0);
+  }
+  for (const auto *filter : {&tree_filter, &hash_filter}) {
+    auto stats = filter->GetStats();
+    EXPECT_EQ(stats.skipped_ + stats.passed_, 4000);
+    // every passed probe of an absent key reached the index and found nothing
+    EXPECT_EQ(stats.passed_ - stats.false_positives_, 2000);
+    EXPECT_GT(stats.skipped_, 1900);
+  }
+}
+
+TEST_F(BloomFilterTest, KeysEqualByValueShareTheirHash) {
+  // -0.0 and 0.0 are the same key to the comparator, but not the same bytes
+  Schema key_schema({Column("d", TypeId::DOUBLE)});
+  GenericComparator<16> comparator(&key_schema);
+  auto make_key = [&](double d) {
+    char tuple[16] = {0};
+    key_schema.SetValue(tuple, 0, Value(d));
+    GenericKey<16> key;
+    key.SetFromKey(tuple, key_schema.GetTupleSize());
+    return key;
+  };
+  GenericKey<16> zero = make_key(0.0);
+  GenericKey<16> negative_zero = make_key(-0.0);
+  ASSERT_NE(0, memcmp(zero.data_, negative_zero.data_, sizeof(zero.data_)));
+  ASSERT_EQ(0, comparator(zero, negative_zero));
+  EXPECT_EQ(HashIndexKey(zero, comparator), HashIndexKey(negative_zero, comparator));
+
+  BloomFilterOptions options;
+  options.expected_keys_ = 100;
+  BloomFilter filter(bpm_.get(), options);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("tree", bpm_.get(), comparator);
+  tree.SetBloomFilter(&filter);
+  ASSERT_TRUE(tree.Insert(zero, RID(0, 1)));
+  ASSERT_TRUE(tree.Insert(make_key(1.5), RID(0, 2)));
+  std::vector<RID> result;
+  ASSERT_TRUE(tree.GetValue(negative_zero, &result));
+  EXPECT_EQ(RID(0, 1), result[0]);
+  std::vector<std::optional<RID>> results;
+  EXPECT_EQ(2U, tree.GetValues({negative_zero, make_key(1.5)}, &results));
+}
+
+}  // namespace redbase
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "ix/covering_index.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+using Key = GenericKey<16>;
+using Comparator = GenericComparator<16>;
+using CoveringTree = BPlusTree<Key, CoveringValue<32>, Comparator>;
+
+class CoveringIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("covering_index_test.db");
+    pf_manager_ = std::make_unique<PFManager>("covering_index_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  auto MakeKey(int64_t id) const -> Key {
+    char tuple[16] = {0};
+    key_schema_.SetValue(tuple, 0, Value(TypeId::BIGINT, id));
+    Key key;
+    key.SetFromKey(tuple, key_schema_.GetTupleSize());
+    return key;
+  }
+
+  Schema table_schema_{{Column("id", TypeId::BIGINT), Column("amount", TypeId::BIGINT),
+                        Column("name", TypeId::CHAR, 8), Column("notes", TypeId::CHAR, 64)}};
+  Schema key_schema_{{Column("id", TypeId::BIGINT)}};
+  Comparator comparator_{&key_schema_};
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(CoveringIndexTest, IndexOnlyScanReadsIncludeColumns) {
+  TableHeap heap(bpm_.get());
+  std::vector<int64_t> ids(3000);
+  std::iota(ids.begin(), ids.end(), 0);
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+  std::vector<char> tuple(table_schema_.GetTupleSize());
+  for (auto id : ids) {
+    std::fill(tuple.begin(), tuple.end(), 0);
+    table_schema_.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, id));
+    // every tenth amount is NULL
+    table_schema_.SetValue(tuple.data(), 1, id % 10 == 0 ? Value() : Value(TypeId::BIGINT, id * 3));
+    table_schema_.SetChar(tuple.data(), 2, "n" + std::to_string(id));
+    ASSERT_TRUE(heap.InsertTuple({false}, tuple.data(), tuple.size()).has_value());
+  }
+
+  IndexInclude include(&table_schema_, {1, 2});
+  EXPECT_TRUE(include.Covers({2, 1}));
+  EXPECT_FALSE(include.Covers({1, 3}));
+  EXPECT_EQ(include.GetPayloadColumn(2), 1U);
+  CoveringTree tree("index", bpm_.get(), comparator_);
+  auto make_key = [this](const TupleView &view) {
+    return MakeKey(table_schema_.GetValue(view.data_, 0).GetAsInteger());
+  };
+  EXPECT_EQ(3000U, BulkBuildCoveringIndex(bpm_.get(), &heap, &tree, make_key, include));
+
+  // the range [1000, 1999], in small batches
+  Key lower = MakeKey(1000);
+  Key upper = MakeKey(1999);
+  IndexOnlyScan<Key, 32, Comparator> scan(&tree, &include, &lower, &upper, 100);
+  const Schema &payload_schema = include.GetSchema();
+  std::vector<TupleView> batch;
+  std::vector<char> data;
+  int64_t expected = 1000;
+  while (scan.NextBatch(&batch)) {
+    EXPECT_LE(batch.size(), 100U);
+    for (const auto &view : batch) {
+      ASSERT_EQ(payload_schema.IsNull(view.data_, 0), expected % 10 == 0);
+      if (expected % 10 != 0) {
+        ASSERT_EQ(payload_schema.GetValue(view.data_, 0).GetAsInteger(), expected * 3);
+      }
+      ASSERT_EQ(payload_schema.GetChar(view.data_, 1), "n" + std::to_string(expected));
+      // the RID still leads to the heap tuple for the queries the index does not cover
+      heap.GetTuple(view.rid_, &data);
+      ASSERT_EQ(table_schema_.GetValue(data.data(), 0).GetAsInteger(), expected);
+      expected++;
+    }
+  }
+  EXPECT_EQ(expected, 2000);
+
+  // a payload too small for the INCLUDE columns is refused
+  IndexInclude wide(&table_schema_, {3});
+  BPlusTree<Key, CoveringValue<16>, Comparator> narrow("narrow", bpm_.get(), comparator_);
+  EXPECT_THROW(BulkBuildCoveringIndex(bpm_.get(), &heap, &narrow, make_key, wide), Exception);
+}
+
+}  // namespace redbase
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "ix/extendible_hash_index.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+using HashIndex = ExtendibleHashIndex<int64_t, RID, IntegerComparator<int64_t>>;
+
+class ExtendibleHashIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("extendible_hash_index_test.db");
+    pf_manager_ = std::make_unique<PFManager>("extendible_hash_index_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(ExtendibleHashIndexTest, SplitsAndMergesBuckets) {
+  // a single directory of tiny buckets, so that it grows deep
+  HashIndex index("index", bpm_.get(), IntegerComparator<int64_t>(), 0, 9, 8);
+  std::vector<int64_t> keys(1000);
+  for (int i = 0; i < 1000; i++) {
+    keys[i] = i * 7;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (auto k : keys) {
+    ASSERT_TRUE(index.Insert(k, RID(static_cast<page_id_t>(k), 0)));
+  }
+  EXPECT_FALSE(index.Insert(keys[0], RID(0, 0)));
+  EXPECT_GE(index.GetGlobalDepth(0), 7);
+
+  for (int64_t k = 0; k < 7000; k++) {
+    std::vector<RID> result;
+    ASSERT_EQ(index.GetValue(k, &result), k % 7 == 0) << k;
+    if (k % 7 == 0) {
+      EXPECT_EQ(result[0].GetPageId(), k);
+    }
+  }
+
+  for (auto k : keys) {
+    ASSERT_TRUE(index.Remove(k));
+  }
+  EXPECT_FALSE(index.Remove(keys[0]));
+  // every bucket emptied and merged back into one
+  EXPECT_EQ(index.GetGlobalDepth(0), 0);
+  std::vector<RID> result;
+  EXPECT_FALSE(index.GetValue(keys[0], &result));
+}
+
+TEST_F(ExtendibleHashIndexTest, ConcurrentInsertsAndLookups) {
+  HashIndex index("index", bpm_.get(), IntegerComparator<int64_t>(), 2, 9, 16);
+  constexpr int NUM_THREADS = 8;
+  constexpr int64_t PER_THREAD = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads.emplace_back([&, t] {
+      for (int64_t i = 0; i < PER_THREAD; i++) {
+        int64_t k = i * NUM_THREADS + t;
+        ASSERT_TRUE(index.Insert(k, RID(static_cast<page_id_t>(k), 0)));
+        std::vector<RID> result;
+        ASSERT_TRUE(index.GetValue(k, &result));
+        if (i % 2 == 1) {
+          ASSERT_TRUE(index.Remove(k - NUM_THREADS));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int64_t k = 0; k < PER_THREAD * NUM_THREADS; k++) {
+    std::vector<RID> result;
+    ASSERT_EQ(index.GetValue(k, &result), (k / NUM_THREADS) % 2 == 1) << k;
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/external_sorter.h"
+#include "common/exception.h"
+#include "ix/index_builder.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+using Key = GenericKey<16>;
+using Comparator = GenericComparator<16>;
+using Tree = BPlusTree<Key, RID, Comparator>;
+
+static constexpr int TUPLE_SIZE = 32;
+
+static auto MakeKey(const Schema &key_schema, int64_t v) -> Key {
+  char tuple[16] = {0};
+  key_schema.SetValue(tuple, 0, Value(TypeId::BIGINT, v));
+  Key key;
+  key.SetFromKey(tuple, key_schema.GetTupleSize());
+  return key;
+}
+
+class IndexBuilderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("index_builder_test.db");
+    pf_manager_ = std::make_unique<PFManager>("index_builder_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  Schema key_schema_{{Column("k", TypeId::BIGINT)}};
+  Comparator comparator_{&key_schema_};
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(IndexBuilderTest, ExternalSortSpillsAndMergesRuns) {
+  std::vector<int64_t> values(50000);
+  std::iota(values.begin(), values.end(), 0);
+  std::shuffle(values.begin(), values.end(), std::mt19937(7));
+
+  ExternalSortOptions options;
+  options.memory_budget_ = 2000 * sizeof(int64_t);
+  options.num_threads_ = 2;
+  options.max_fan_in_ = 4;  // 25 runs, merged in several passes
+  ExternalSorter<int64_t, std::less<>> sorter(bpm_.get(), std::less<>(), options);
+  for (auto v : values) {
+    sorter.Add(v);
+  }
+  sorter.Finish();
+  EXPECT_GT(sorter.GetRunsSpilled(), 25U);
+
+  int64_t expected = 0;
+  int64_t v;
+  while (sorter.Next(&v)) {
+    ASSERT_EQ(expected, v);
+    expected++;
+  }
+  EXPECT_EQ(50000, expected);
+}
+
+TEST_F(IndexBuilderTest, BulkBuildFromTableHeap) {
+  TableHeap heap(bpm_.get());
+  std::vector<int64_t> keys(5000);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  char tuple[TUPLE_SIZE] = {0};
+  for (auto k : keys) {
+    int64_t v = k * 2;
+    memcpy(tuple, &v, sizeof(v));
+    ASSERT_TRUE(heap.InsertTuple({false}, tuple, TUPLE_SIZE).has_value());
+  }
+
+  Tree tree("index", bpm_.get(), comparator_, 16, 8);
+  IndexBuildOptions options;
+  options.fill_factor_ = 0.75;
+  options.sort_options_.memory_budget_ = 1000 * sizeof(IndexEntry<Key>);
+  auto make_key = [this](const TupleView &tuple) {
+    int64_t v;
+    memcpy(&v, tuple.data_, sizeof(v));
+    return MakeKey(key_schema_, v);
+  };
+  EXPECT_EQ(5000U, BulkBuildIndex(bpm_.get(), &heap, &tree, make_key, options));
+
+  std::vector<RID> result;
+  std::vector<char> data;
+  for (int64_t k = 0; k < 10000; k++) {
+    result.clear();
+    ASSERT_EQ(k % 2 == 0, tree.GetValue(MakeKey(key_schema_, k), &result));
+    if (k % 2 == 0) {
+      heap.GetTuple(result[0], &data);
+      int64_t v;
+      memcpy(&v, data.data(), sizeof(v));
+      EXPECT_EQ(k, v);
+    }
+  }
+  int64_t expected = 0;
+  for (auto iter = tree.Begin(); !iter.IsEnd(); ++iter) {
+    ASSERT_EQ(MakeKey(key_schema_, expected).ToString(key_schema_), (*iter).first.ToString(key_schema_));
+    expected += 2;
+  }
+  EXPECT_EQ(10000, expected);
+
+  // the packed tree takes regular inserts and removes
+  for (int64_t k = 1; k < 10000; k += 2) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key_schema_, k), RID(0, 0)));
+  }
+  for (int64_t k = 0; k < 10000; k += 3) {
+    ASSERT_TRUE(tree.Remove(MakeKey(key_schema_, k)));
+  }
+  for (int64_t k = 0; k < 10000; k++) {
+    result.clear();
+    ASSERT_EQ(k % 3 != 0, tree.GetValue(MakeKey(key_schema_, k), &result));
+  }
+
+  EXPECT_THROW(BulkBuildIndex(bpm_.get(), &heap, &tree, make_key, options), Exception);
+}
+
+TEST_F(IndexBuilderTest, BulkLoadRejectsUnsortedInput) {
+  Tree tree("index", bpm_.get(), comparator_, 4, 4);
+  std::vector<int64_t> keys = {1, 2, 3, 5, 4, 6};
+  size_t next = 0;
+  auto source = [&](Key *key, RID *rid) {
+    if (next == keys.size()) {
+      return false;
+    }
+    *key = MakeKey(key_schema_, keys[next++]);
+    *rid = RID(0, 0);
+    return true;
+  };
+  EXPECT_THROW(tree.BulkLoad(keys.size(), source), Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+}
+
+}  // namespace redbase
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "ix/generic_key.h"
+#include "ix/lsm_tree.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+using LSMIndex = LSMTree<int64_t, RID, IntegerComparator<int64_t>>;
+
+class LSMTreeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("lsm_tree_test.db");
+    pf_manager_ = std::make_unique<PFManager>("lsm_tree_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  /** Small memtables and levels, so that a few thousand keys go through several flushes and compactions. */
+  static auto SmallOptions() -> LSMOptions {
+    LSMOptions options;
+    options.memtable_max_entries_ = 256;
+    options.level0_max_runs_ = 2;
+    options.level_size_ratio_ = 2;
+    options.interval_ = std::chrono::milliseconds(1);
+    return options;
+  }
+
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(LSMTreeTest, LookupsAndScansAcrossCompactions) {
+  LSMIndex index("index", bpm_.get(), IntegerComparator<int64_t>(), SmallOptions());
+  std::vector<int64_t> keys(4000);
+  for (int i = 0; i < 4000; i++) {
+    keys[i] = 2 * i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (auto k : keys) {
+    ASSERT_TRUE(index.Insert(k, RID(static_cast<page_id_t>(k), 0)));
+  }
+  EXPECT_FALSE(index.Insert(keys[0], RID(0, 0)));
+  // every odd multiple of 4 goes, its tombstone shadows the entry in a deeper run
+  for (int64_t k = 2; k < 8000; k += 4) {
+    ASSERT_TRUE(index.Remove(k));
+  }
+  EXPECT_FALSE(index.Remove(2));
+  EXPECT_FALSE(index.Remove(1));
+
+  auto stats = index.GetStats();
+  EXPECT_EQ(stats.entries_inserted_, 6000);
+  EXPECT_GT(stats.compactions_, 0);
+  EXPECT_GE(index.GetRunCounts().size(), 3);
+
+  for (int64_t k = 0; k < 8000; k++) {
+    std::vector<RID> result;
+    ASSERT_EQ(index.GetValue(k, &result), k % 4 == 0) << k;
+    if (k % 4 == 0) {
+      EXPECT_EQ(result[0].GetPageId(), k);
+    }
+  }
+  // the filters and key ranges answered most lookups of absent keys without a read
+  stats = index.GetStats();
+  EXPECT_GT(stats.runs_skipped_, stats.runs_probed_);
+
+  int64_t expected = 1000;
+  for (auto it = index.Begin(999); it != index.End(); ++it) {
+    ASSERT_EQ((*it).first, expected);
+    expected += 4;
+  }
+  EXPECT_EQ(expected, 8000);
+
+  // the runs are durable once the memtable is flushed
+  index.Flush();
+  LSMIndex reopened("index", index.GetHeaderPageId(), bpm_.get(), IntegerComparator<int64_t>(), SmallOptions());
+  EXPECT_EQ(reopened.GetRunCounts(), index.GetRunCounts());
+  size_t count = 0;
+  for (auto it = reopened.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ((*it).first, static_cast<int64_t>(4 * count));
+    count++;
+  }
+  EXPECT_EQ(count, 2000);
+}
+
+TEST_F(LSMTreeTest, BackgroundCompactionWithConcurrentReaders) {
+  LSMIndex index("index", bpm_.get(), IntegerComparator<int64_t>(), SmallOptions());
+  index.Start();
+  std::atomic<int64_t> inserted{0};
+  std::thread writer([&] {
+    for (int64_t k = 0; k < 5000; k++) {
+      ASSERT_TRUE(index.Insert(k, RID(0, static_cast<uint32_t>(k))));
+      inserted.store(k + 1, std::memory_order_release);
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      while (inserted.load(std::memory_order_acquire) < 5000) {
+        int64_t bound = inserted.load(std::memory_order_acquire);
+        if (bound == 0) {
+          continue;
+        }
+        // a key inserted before the lookup started is always found, whatever flush or compaction is under way
+        int64_t k = rng() % bound;
+        std::vector<RID> result;
+        ASSERT_TRUE(index.GetValue(k, &result)) << k;
+        EXPECT_EQ(result[0].GetSlotNum(), k);
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  index.Stop();
+
+  while (index.CompactOnce()) {
+  }
+  int64_t expected = 0;
+  for (auto it = index.Begin(); !it.IsEnd(); ++it) {
+    ASSERT_EQ((*it).first, expected++);
+  }
+  EXPECT_EQ(expected, 5000);
+  EXPECT_LT(index.GetRunCounts()[0], SmallOptions().level0_max_runs_);
+}
+
+TEST_F(LSMTreeTest, RunFiltersAgreeWithTheComparator) {
+  // -0.0 and 0.0 are one key to the comparator, with different bytes: the runs must not be skipped for either
+  Schema key_schema({Column("d", TypeId::DOUBLE)});
+  auto make_key = [&](double d) {
+    char tuple[16] = {0};
+    key_schema.SetValue(tuple, 0, Value(d));
+    GenericKey<16> key;
+    key.SetFromKey(tuple, key_schema.GetTupleSize());
+    return key;
+  };
+  LSMTree<GenericKey<16>, RID, GenericComparator<16>> index("index", bpm_.get(), GenericComparator<16>(&key_schema),
+                                                            SmallOptions());
+  ASSERT_TRUE(index.Insert(make_key(0.0), RID(1, 0)));
+  index.Flush();
+  std::vector<RID> result;
+  ASSERT_TRUE(index.GetValue(make_key(-0.0), &result));
+  EXPECT_EQ(RID(1, 0), result[0]);
+
+  // the tombstone in the newer run shadows the older entry
+  ASSERT_TRUE(index.Remove(make_key(-0.0)));
+  index.Flush();
+  result.clear();
+  EXPECT_FALSE(index.GetValue(make_key(0.0), &result));
+
+  ASSERT_TRUE(index.Insert(make_key(-0.0), RID(2, 0)));
+  index.Flush();
+  result.clear();
+  ASSERT_TRUE(index.GetValue(make_key(0.0), &result));
+  EXPECT_EQ(RID(2, 0), result[0]);
+}
+
+}  // namespace redbase
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "ix/b_plus_tree.h"
+#include "ix/node_search.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+/** @return the kernels the CPU supports, they are ordered from the most to the least widely available */
+static auto SupportedKernels() -> std::vector<SearchKernel> {
+  std::vector<SearchKernel> kernels = {SearchKernel::SCALAR};
+  if (GetSearchKernel() != SearchKernel::SCALAR) {
+    kernels.push_back(SearchKernel::SSE4);
+  }
+  if (GetSearchKernel() == SearchKernel::AVX2) {
+    kernels.push_back(SearchKernel::AVX2);
+  }
+  return kernels;
+}
+
+template <typename T>
+static void CheckKernels() {
+  std::mt19937_64 rng(7);
+  for (int n = 0; n <= 300; n += (n < 40 ? 1 : 37)) {
+    std::vector<T> keys(n);
+    // few distinct values, so that keys repeat, and the extremes of the type
+    std::uniform_int_distribution<T> dist(-50, 50);
+    for (auto &k : keys) {
+      k = dist(rng);
+    }
+    if (n > 2) {
+      keys[0] = std::numeric_limits<T>::min();
+      keys[n - 1] = std::numeric_limits<T>::max();
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<T> probes = {std::numeric_limits<T>::min(), std::numeric_limits<T>::max()};
+    for (T p = -52; p <= 52; p++) {
+      probes.push_back(p);
+    }
+    for (auto kernel : SupportedKernels()) {
+      for (auto p : probes) {
+        auto lower = static_cast<int>(std::lower_bound(keys.begin(), keys.end(), p) - keys.begin());
+        auto upper = static_cast<int>(std::upper_bound(keys.begin(), keys.end(), p) - keys.begin());
+        ASSERT_EQ(lower, NodeSearch(kernel, keys.data(), n, p, false)) << SearchKernelName(kernel) << " n=" << n;
+        ASSERT_EQ(upper, NodeSearch(kernel, keys.data(), n, p, true)) << SearchKernelName(kernel) << " n=" << n;
+      }
+    }
+  }
+}
+
+TEST(NodeSearchTest, KernelsMatchBinarySearch) {
+  CheckKernels<int32_t>();
+  CheckKernels<int64_t>();
+}
+
+TEST(NodeSearchTest, IntegerKeyTree) {
+  remove("node_search_test.db");
+  auto pf_manager = std::make_unique<PFManager>("node_search_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(64, pf_manager.get());
+  {
+    BPlusTree<int64_t, RID, IntegerComparator<int64_t>> tree("index", bpm.get(), IntegerComparator<int64_t>());
+    std::vector<int64_t> keys(20000);
+    for (int64_t i = 0; i < 20000; i++) {
+      keys[i] = i * 3 - 30000;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+    for (auto k : keys) {
+      ASSERT_TRUE(tree.Insert(k, RID(0, static_cast<uint32_t>(k + 30000))));
+    }
+    for (size_t i = 0; i < keys.size(); i += 2) {
+      ASSERT_TRUE(tree.Remove(keys[i]));
+    }
+
+    std::vector<RID> result;
+    for (size_t i = 0; i < keys.size(); i++) {
+      result.clear();
+      ASSERT_EQ(i % 2 == 1, tree.GetValue(keys[i], &result));
+      ASSERT_FALSE(tree.GetValue(keys[i] + 1, &result));
+    }
+    int64_t last = std::numeric_limits<int64_t>::min();
+    size_t count = 0;
+    for (auto iter = tree.Begin(-30000); !iter.IsEnd(); ++iter) {
+      ASSERT_LT(last, (*iter).first);
+      last = (*iter).first;
+      count++;
+    }
+    EXPECT_EQ(10000U, count);
+  }
+  pf_manager->Shutdown();
+}
+
+}  // namespace redbase
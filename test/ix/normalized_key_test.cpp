@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "ix/b_plus_tree.h"
+#include "ix/normalized_key.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+using UrlKey = NormalizedKey<64>;
+using UrlComparator = NormalizedComparator<64>;
+using UrlTree = BPlusTree<UrlKey, RID, UrlComparator>;
+
+static auto MakeUrl(int i) -> std::string { return fmt::format("https://example.com/catalog/items/{:08d}", i); }
+
+class NormalizedKeyTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("normalized_key_test.db");
+    pf_manager_ = std::make_unique<PFManager>("normalized_key_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+  }
+
+  void TearDown() override { pf_manager_->Shutdown(); }
+
+  auto MakeKey(const std::string &url) const -> UrlKey {
+    std::vector<char> tuple(url_schema_.GetTupleSize());
+    url_schema_.SetChar(tuple.data(), 0, url);
+    UrlKey key;
+    key.SetFromTuple(tuple.data(), normalizer_);
+    return key;
+  }
+
+  Schema url_schema_{{Column("url", TypeId::CHAR, 60)}};
+  KeyNormalizer normalizer_{&url_schema_};
+  UrlComparator comparator_;
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+};
+
+TEST_F(NormalizedKeyTest, ByteOrderMatchesColumnOrder) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::DOUBLE), Column("c", TypeId::CHAR, 6),
+                 Column("d", TypeId::BIGINT)});
+  KeyNormalizer normalizer(&schema);
+  GenericComparator<64> generic(&schema);
+  std::mt19937 rng(42);
+  const char *words[] = {"", "a", "ab", "abc", "b", "zz"};
+
+  std::vector<std::vector<char>> tuples(300, std::vector<char>(schema.GetTupleSize()));
+  for (auto &tuple : tuples) {
+    schema.SetValue(tuple.data(), 0, Value(TypeId::INTEGER, static_cast<int>(rng() % 7) - 3));
+    schema.SetValue(tuple.data(), 1, Value(static_cast<double>(static_cast<int>(rng() % 9) - 4) / 2));
+    schema.SetChar(tuple.data(), 2, words[rng() % 6]);
+    schema.SetValue(tuple.data(), 3, Value(TypeId::BIGINT, static_cast<int64_t>(rng() % 5) - (int64_t{1} << 40)));
+    for (uint32_t col = 0; col < 4; col++) {
+      schema.SetNull(tuple.data(), col, rng() % 8 == 0);
+    }
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    for (size_t j = 0; j < tuples.size(); j += 7) {
+      GenericKey<64> lhs;
+      GenericKey<64> rhs;
+      lhs.SetFromKey(tuples[i].data(), schema.GetTupleSize());
+      rhs.SetFromKey(tuples[j].data(), schema.GetTupleSize());
+      NormalizedKey<64> lhs_norm;
+      NormalizedKey<64> rhs_norm;
+      lhs_norm.SetFromTuple(tuples[i].data(), normalizer);
+      rhs_norm.SetFromTuple(tuples[j].data(), normalizer);
+      ASSERT_EQ(generic(lhs, rhs), NormalizedComparator<64>()(lhs_norm, rhs_norm)) << i << " vs " << j;
+    }
+  }
+}
+
+TEST_F(NormalizedKeyTest, PrefixRaisesNodeCapacity) {
+  using LeafPage = BPlusTreeLeafPage<UrlKey, RID, UrlComparator>;
+  struct alignas(8) {
+    char data_[PAGE_SIZE];
+  } buffer;
+  auto leaf = reinterpret_cast<LeafPage *>(buffer.data_);
+  leaf->Init();
+  int initial_max_size = leaf->GetMaxSize();
+  EXPECT_EQ(initial_max_size, LeafPage::InitialMaxSize(LeafPage::SLOT_CNT - 1));
+
+  UrlKey low = MakeKey(MakeUrl(0));
+  UrlKey high = MakeKey(MakeUrl(9999));
+  leaf->SetKeyRange(&low, &high);
+  EXPECT_EQ(leaf->GetPrefixLength(), 1 + MakeUrl(0).size() - 4);
+  EXPECT_GT(leaf->GetMaxSize(), 2 * initial_max_size);
+  for (int i = leaf->GetMaxSize() - 1; i >= 0; i--) {
+    ASSERT_TRUE(leaf->Insert(MakeKey(MakeUrl(i)), RID(0, i), comparator_));
+  }
+  for (int i = 0; i < leaf->GetMaxSize(); i++) {
+    RID rid;
+    ASSERT_TRUE(leaf->Lookup(MakeKey(MakeUrl(i)), &rid, comparator_));
+    EXPECT_EQ(rid.GetSlotNum(), static_cast<uint32_t>(i));
+  }
+  EXPECT_EQ(leaf->KeyIndex(MakeKey("https://example.com/a"), comparator_), 0);
+  EXPECT_EQ(leaf->KeyIndex(MakeKey("https://example.com/z"), comparator_), leaf->GetSize());
+}
+
+TEST_F(NormalizedKeyTest, PrefixCompressedTree) {
+  UrlTree tree("urls", bpm_.get(), comparator_);
+  std::vector<int> ids(20000);
+  for (int i = 0; i < 20000; i++) {
+    ids[i] = i;
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(7));
+  for (auto id : ids) {
+    ASSERT_TRUE(tree.Insert(MakeKey(MakeUrl(id)), RID(id, 0)));
+  }
+  // remove two thirds of the keys, enough to merge and redistribute nodes
+  std::set<int> removed;
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (i % 3 != 0) {
+      ASSERT_TRUE(tree.Remove(MakeKey(MakeUrl(ids[i]))));
+      removed.insert(ids[i]);
+    }
+  }
+  for (int id = 0; id < 20000; id += 13) {
+    std::vector<RID> result;
+    ASSERT_EQ(tree.GetValue(MakeKey(MakeUrl(id)), &result), removed.count(id) == 0) << id;
+  }
+
+  int prev = -1;
+  size_t count = 0;
+  for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+    int id = (*it).second.GetPageId();
+    ASSERT_GT(id, prev);
+    ASSERT_EQ(removed.count(id), 0);
+    prev = id;
+    count++;
+  }
+  EXPECT_EQ(count, ids.size() - removed.size());
+}
+
+TEST_F(NormalizedKeyTest, BulkLoadSetsFences) {
+  UrlTree tree("urls", bpm_.get(), comparator_);
+  int next = 0;
+  tree.BulkLoad(5000, [&](UrlKey *key, RID *rid) {
+    *key = MakeKey(MakeUrl(next));
+    *rid = RID(next, 0);
+    next++;
+    return true;
+  });
+  // the bulk-built leaves know their prefix, inserts fill them past their uncompressed capacity
+  for (int i = 5000; i < 15000; i++) {
+    ASSERT_TRUE(tree.Insert(MakeKey(MakeUrl(i)), RID(i, 0)));
+  }
+  for (int i = 0; i < 15000; i += 7) {
+    std::vector<RID> result;
+    ASSERT_TRUE(tree.GetValue(MakeKey(MakeUrl(i)), &result)) << i;
+    EXPECT_EQ(result[0].GetPageId(), i);
+  }
+}
+
+}  // namespace redbase
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "pf/pf_manager.h"
+#include "rm/blob_store.h"
+
+namespace redbase {
+
+TEST(BlobStoreTest, StreamLargeValue) {
+  remove("blob_store_test.db");
+  auto pf_manager = std::make_unique<PFManager>("blob_store_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(8, pf_manager.get());
+  BlobStore store(bpm.get());
+
+  // 100 pages worth of data through an 8 frame pool, written in odd sized pieces
+  std::string value;
+  for (int i = 0; value.size() < 100 * PAGE_SIZE; i++) {
+    value += "chunk-" + std::to_string(i) + ";";
+  }
+  auto writer = store.NewWriter();
+  for (size_t offset = 0; offset < value.size(); offset += 1000) {
+    writer.Append(value.data() + offset, std::min<size_t>(1000, value.size() - offset));
+  }
+  BlobId id = writer.Finish();
+  ASSERT_EQ(value.size(), id.size_);
+
+  // zero-copy chunks
+  auto reader = store.NewReader(id);
+  std::string chunks;
+  const char *data;
+  size_t size;
+  while (reader.NextChunk(&data, &size)) {
+    ASSERT_LE(size, static_cast<size_t>(PAGE_SIZE));
+    chunks.append(data, size);
+  }
+  EXPECT_EQ(value, chunks);
+
+  // copies of arbitrary size
+  reader = store.NewReader(id);
+  std::vector<char> buffer(777);
+  std::string copied;
+  while (reader.Remaining() > 0) {
+    size_t n = reader.Read(buffer.data(), buffer.size());
+    ASSERT_GT(n, 0U);
+    copied.append(buffer.data(), n);
+  }
+  EXPECT_EQ(value, copied);
+  EXPECT_EQ(0U, reader.Read(buffer.data(), buffer.size()));
+
+  store.Delete(id);
+  pf_manager->Shutdown();
+}
+
+TEST(BlobStoreTest, EmptyValue) {
+  remove("blob_store_test.db");
+  auto pf_manager = std::make_unique<PFManager>("blob_store_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(4, pf_manager.get());
+  BlobStore store(bpm.get());
+
+  BlobId id = store.Put(nullptr, 0);
+  EXPECT_EQ(INVALID_PAGE_ID, id.first_page_id_);
+  auto reader = store.NewReader(id);
+  const char *data;
+  size_t size;
+  EXPECT_FALSE(reader.NextChunk(&data, &size));
+  store.Delete(id);
+  pf_manager->Shutdown();
+}
+
+}  // namespace redbase
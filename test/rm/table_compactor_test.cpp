@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "pf/pf_manager.h"
+#include "rm/table_compactor.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+static constexpr int TUPLE_SIZE = 64;
+
+/** Fill a heap and delete all tuples but one in `keep_every`, @return the RIDs of the survivors */
+static auto MakeSparseHeap(TableHeap *heap, int num_tuples, int keep_every) -> std::vector<RID> {
+  std::vector<RID> live;
+  char tuple[TUPLE_SIZE];
+  for (int i = 0; i < num_tuples; i++) {
+    memset(tuple, 0, TUPLE_SIZE);
+    memcpy(tuple, &i, sizeof(i));
+    auto rid = heap->InsertTuple({false}, tuple, TUPLE_SIZE);
+    EXPECT_TRUE(rid.has_value());
+    if (i % keep_every == 0) {
+      live.push_back(*rid);
+    } else {
+      heap->UpdateTupleMeta({true}, *rid);
+    }
+  }
+  return live;
+}
+
+TEST(TableCompactorTest, MergesSparsePages) {
+  remove("table_compactor_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_compactor_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(16, pf_manager.get());
+  TableHeap heap(bpm.get());
+
+  const int num_tuples = 3000;
+  std::vector<RID> live = MakeSparseHeap(&heap, num_tuples, 10);
+  size_t pages_before = heap.GetPageCount();
+
+  TableCompactor compactor(&heap);
+  {
+    // an open scan keeps the compactor out
+    auto iterator = heap.MakeScanIterator();
+    EXPECT_EQ(0U, compactor.CompactOnce());
+    EXPECT_EQ(1U, compactor.GetStats().rounds_skipped_);
+  }
+  size_t freed = compactor.CompactOnce();
+  EXPECT_GT(freed, 0U);
+  EXPECT_EQ(pages_before - freed, heap.GetPageCount());
+  EXPECT_LT(heap.GetPageCount(), pages_before / 4);
+  EXPECT_GT(compactor.GetStats().tuples_moved_, 0U);
+
+  // the scan sees exactly the live tuples, in order
+  auto iterator = heap.MakeScanIterator();
+  std::vector<TupleView> batch;
+  int expected = 0;
+  while (iterator.NextBatch(&batch)) {
+    for (const auto &tuple : batch) {
+      int value;
+      memcpy(&value, tuple.data_, sizeof(value));
+      ASSERT_EQ(expected, value);
+      expected += 10;
+    }
+  }
+  EXPECT_EQ(num_tuples, expected);
+
+  // old RIDs are forwarded
+  std::vector<char> data;
+  for (size_t i = 0; i < live.size(); i++) {
+    EXPECT_FALSE(heap.GetTuple(live[i], &data).is_deleted_);
+    int value;
+    memcpy(&value, data.data(), sizeof(value));
+    EXPECT_EQ(static_cast<int>(i * 10), value);
+  }
+  heap.UpdateTupleMeta({true}, live[1]);
+  EXPECT_TRUE(heap.GetTuple(live[1], &data).is_deleted_);
+
+  pf_manager->Shutdown();
+}
+
+TEST(TableCompactorTest, PointAccessesUnderAnOpenScan) {
+  remove("table_compactor_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_compactor_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(16, pf_manager.get());
+  TableHeap heap(bpm.get());
+  std::vector<RID> live = MakeSparseHeap(&heap, 3000, 10);
+  TableCompactor compactor(&heap);
+  ASSERT_GT(compactor.CompactOnce(), 0U);
+
+  // the scan's hold of the compaction latch covers the accesses of its thread, which do not lock it again
+  auto iterator = heap.MakeScanIterator();
+  std::vector<char> data;
+  EXPECT_FALSE(heap.GetTuple(live[5], &data, iterator).is_deleted_);
+  int value;
+  memcpy(&value, data.data(), sizeof(value));
+  EXPECT_EQ(50, value);
+  value = 51;
+  memcpy(data.data(), &value, sizeof(value));
+  EXPECT_TRUE(heap.UpdateTupleInPlace(live[5], data.data(), TUPLE_SIZE, iterator));
+  heap.UpdateTupleMeta({true}, live[6], iterator);
+  EXPECT_TRUE(heap.GetTuple(live[6], &data, iterator).is_deleted_);
+  EXPECT_EQ(0U, compactor.CompactOnce());
+
+  // a scan of another heap holds nothing here
+  TableHeap other(bpm.get());
+  auto other_iterator = other.MakeScanIterator();
+  EXPECT_THROW(heap.GetTuple(live[5], &data, other_iterator), Exception);
+
+  pf_manager->Shutdown();
+}
+
+TEST(TableCompactorTest, ForwardedPagesAreNotReused) {
+  remove("table_compactor_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_compactor_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(16, pf_manager.get());
+  TableHeap heap(bpm.get());
+
+  const int num_tuples = 3000;
+  std::vector<RID> live = MakeSparseHeap(&heap, num_tuples, 10);
+  size_t pages_before = heap.GetPageCount();
+  TableCompactor compactor(&heap);
+  size_t freed = compactor.CompactOnce();
+  ASSERT_GT(freed, 0U);
+  std::set<page_id_t> unlinked;
+  for (const auto &rid : live) {
+    if (heap.ResolveRID(rid) != rid) {
+      unlinked.insert(rid.GetPageId());
+    }
+  }
+  ASSERT_FALSE(unlinked.empty());
+
+  // enough new pages to take every id compaction unlinked, were they free
+  char tuple[TUPLE_SIZE] = {0};
+  while (heap.GetPageCount() < pages_before + freed) {
+    ASSERT_TRUE(heap.InsertTuple({false}, tuple, TUPLE_SIZE).has_value());
+  }
+  for (page_id_t page_id : heap.GetPageIds(0, SIZE_MAX)) {
+    EXPECT_EQ(0U, unlinked.count(page_id)) << page_id;
+  }
+  std::vector<char> data;
+  for (size_t i = 0; i < live.size(); i++) {
+    EXPECT_FALSE(heap.GetTuple(live[i], &data).is_deleted_);
+    int value;
+    memcpy(&value, data.data(), sizeof(value));
+    EXPECT_EQ(static_cast<int>(i * 10), value);
+  }
+
+  // once the moved tuples are deleted and their pages merged in turn, the unlinked pages are handed out again
+  for (const auto &rid : live) {
+    heap.UpdateTupleMeta({true}, rid);
+  }
+  EXPECT_GT(compactor.CompactOnce(), 0U);
+  page_id_t page_id;
+  auto guard = bpm->NewPageGuarded(&page_id);
+  EXPECT_LT(page_id, static_cast<page_id_t>(pages_before));
+
+  pf_manager->Shutdown();
+}
+
+TEST(TableCompactorTest, BackgroundRoundsAreThrottled) {
+  remove("table_compactor_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_compactor_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(16, pf_manager.get());
+  TableHeap heap(bpm.get());
+  MakeSparseHeap(&heap, 3000, 10);
+  size_t pages_before = heap.GetPageCount();
+
+  CompactionOptions options;
+  options.max_pages_per_second_ = 200;
+  options.interval_ = std::chrono::milliseconds(20);
+  TableCompactor compactor(&heap, options);
+  compactor.Start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  compactor.Stop();
+
+  auto stats = compactor.GetStats();
+  EXPECT_GT(stats.pages_freed_, 0U);
+  EXPECT_EQ(pages_before - stats.pages_freed_, heap.GetPageCount());
+  // 4 pages per round, at most ~10 rounds
+  EXPECT_LE(stats.pages_visited_, 4U * 11);
+
+  pf_manager->Shutdown();
+}
+
+}  // namespace redbase
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+static constexpr int TUPLE_SIZE = 64;
+
+static void FillTuples(TableHeap *heap, int num_tuples) {
+  char tuple[TUPLE_SIZE];
+  for (int i = 0; i < num_tuples; i++) {
+    memset(tuple, 0, TUPLE_SIZE);
+    memcpy(tuple, &i, sizeof(i));
+    ASSERT_TRUE(heap->InsertTuple({false}, tuple, TUPLE_SIZE).has_value());
+  }
+}
+
+TEST(TableHeapTest, BatchScanWithReadAhead) {
+  remove("table_heap_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_heap_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(16, pf_manager.get());
+  TableHeap heap(bpm.get());
+
+  const int num_tuples = 2000;
+  FillTuples(&heap, num_tuples);
+  ASSERT_GT(heap.GetPageCount(), 16U);  // the scan has to go to disk
+
+  ScanOptions options;
+  options.batch_size_ = 100;
+  options.read_ahead_ = 4;
+  auto iterator = heap.MakeScanIterator(options);
+  std::vector<TupleView> batch;
+  int expected = 0;
+  while (iterator.NextBatch(&batch)) {
+    ASSERT_LE(batch.size(), 100U);
+    for (const auto &tuple : batch) {
+      int value;
+      memcpy(&value, tuple.data_, sizeof(value));
+      ASSERT_EQ(expected, value);
+      ASSERT_EQ(static_cast<uint32_t>(TUPLE_SIZE), tuple.size_);
+      expected++;
+    }
+  }
+  EXPECT_EQ(num_tuples, expected);
+  EXPECT_TRUE(batch.empty());
+
+  pf_manager->Shutdown();
+}
+
+TEST(TableHeapTest, DeletedTuplesAreSkipped) {
+  remove("table_heap_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_heap_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(16, pf_manager.get());
+  TableHeap heap(bpm.get());
+
+  char tuple[TUPLE_SIZE] = {0};
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    rids.push_back(*heap.InsertTuple({false}, tuple, TUPLE_SIZE));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    heap.UpdateTupleMeta({true}, rids[i]);
+  }
+
+  auto iterator = heap.MakeScanIterator();
+  std::vector<TupleView> batch;
+  size_t seen = 0;
+  while (iterator.NextBatch(&batch)) {
+    for (const auto &view : batch) {
+      EXPECT_EQ(1U, view.rid_.GetSlotNum() % 2);
+    }
+    seen += batch.size();
+  }
+  EXPECT_EQ(50U, seen);
+
+  pf_manager->Shutdown();
+}
+
+TEST(TableHeapTest, PartitionedScan) {
+  remove("table_heap_test.db");
+  auto pf_manager = std::make_unique<PFManager>("table_heap_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(64, pf_manager.get());
+  TableHeap heap(bpm.get());
+
+  const int num_tuples = 3000;
+  FillTuples(&heap, num_tuples);
+
+  ScanOptions options;
+  options.batch_size_ = 32;
+  options.read_ahead_ = 2;
+  auto iterators = heap.MakePartitionedScan(4, options);
+  ASSERT_EQ(4U, iterators.size());
+
+  std::vector<int64_t> sums(iterators.size(), 0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < iterators.size(); i++) {
+    threads.emplace_back([&, i] {
+      std::vector<TupleView> batch;
+      while (iterators[i].NextBatch(&batch)) {
+        for (const auto &view : batch) {
+          int value;
+          memcpy(&value, view.data_, sizeof(value));
+          sums[i] += value;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t total = 0;
+  for (auto sum : sums) {
+    total += sum;
+  }
+  EXPECT_EQ(static_cast<int64_t>(num_tuples) * (num_tuples - 1) / 2, total);
+
+  pf_manager->Shutdown();
+}
+
+TEST(TableHeapTest, ScanPagesAreEvictedFirst) {
+  LRUKReplacer replacer(4, 2);
+  replacer.RecordAccess(0, AccessType::Lookup);
+  replacer.RecordAccess(1, AccessType::Scan);
+  replacer.RecordAccess(0, AccessType::Lookup);
+  replacer.SetEvictable(0, true);
+  replacer.SetEvictable(1, true);
+
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+}
+
+}  // namespace redbase
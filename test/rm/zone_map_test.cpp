@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+#include "rm/zone_map.h"
+
+namespace redbase {
+
+TEST(ZoneMapTest, ScanSkipsPages) {
+  remove("zone_map_test.db");
+  auto pf_manager = std::make_unique<PFManager>("zone_map_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(32, pf_manager.get());
+  Schema schema({{"ts", TypeId::BIGINT}, {"reading", TypeId::DOUBLE}, {"tag", TypeId::CHAR, 40}});
+  TableHeap heap(bpm.get());
+  ZoneMap zone_map(bpm.get(), &schema, {0, 1});
+  heap.SetZoneMap(&zone_map);
+
+  const int num_tuples = 5000;
+  std::vector<char> tuple(schema.GetTupleSize());
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    schema.SetValue(tuple.data(), 0, {TypeId::BIGINT, i});
+    schema.SetValue(tuple.data(), 1, i % 10 == 0 ? Value::MakeNull(TypeId::DOUBLE) : Value(i * 0.5));
+    schema.SetChar(tuple.data(), 2, "sensor");
+    rids.push_back(*heap.InsertTuple({false}, tuple.data(), tuple.size()));
+  }
+
+  auto zone = zone_map.GetPageZone(rids[0].GetPageId(), 1);
+  ASSERT_TRUE(zone.has_value());
+  EXPECT_GT(zone->null_count_, 0U);
+  EXPECT_EQ(0.5, zone->min_.GetAsDouble());
+
+  ScanOptions options;
+  options.zone_map_ = &zone_map;
+  options.ranges_ = {{0, Value(TypeId::BIGINT, 1000), true, Value(TypeId::BIGINT, 1100), false}};
+  auto count_matches = [&](TableScanIterator *iterator) {
+    std::vector<TupleView> batch;
+    int matches = 0;
+    while (iterator->NextBatch(&batch)) {
+      for (const auto &view : batch) {
+        int64_t ts = schema.GetValue(view.data_, 0).GetAsInteger();
+        matches += (ts >= 1000 && ts < 1100) ? 1 : 0;
+      }
+    }
+    return matches;
+  };
+
+  auto iterator = heap.MakeScanIterator(options);
+  EXPECT_EQ(100, count_matches(&iterator));
+  EXPECT_GE(iterator.GetPagesSkipped(), heap.GetPageCount() - 3);
+
+  // an update widens the summary of its page, the page is no longer skipped
+  schema.SetValue(tuple.data(), 0, {TypeId::BIGINT, 1050});
+  ASSERT_TRUE(heap.UpdateTupleInPlace(rids[num_tuples - 1], tuple.data(), tuple.size()));
+  iterator = heap.MakeScanIterator(options);
+  EXPECT_EQ(101, count_matches(&iterator));
+
+  // summaries survive a flush and reload
+  zone_map.Flush();
+  ZoneMap reloaded(bpm.get(), &schema, {0, 1}, zone_map.GetFirstSummaryPageId());
+  options.zone_map_ = &reloaded;
+  iterator = heap.MakeScanIterator(options);
+  EXPECT_EQ(101, count_matches(&iterator));
+  auto reloaded_zone = reloaded.GetPageZone(rids[0].GetPageId(), 1);
+  ASSERT_TRUE(reloaded_zone.has_value());
+  EXPECT_EQ(zone->null_count_, reloaded_zone->null_count_);
+  EXPECT_EQ(zone->max_.GetAsDouble(), reloaded_zone->max_.GetAsDouble());
+
+  pf_manager->Shutdown();
+}
+
+TEST(ZoneMapTest, ScanFiltersTuplesInThePage) {
+  remove("zone_map_filter_test.db");
+  auto pf_manager = std::make_unique<PFManager>("zone_map_filter_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(32, pf_manager.get());
+  Schema schema({{"ts", TypeId::BIGINT}, {"reading", TypeId::DOUBLE}, {"code", TypeId::INTEGER}});
+  TableHeap heap(bpm.get());
+  ZoneMap zone_map(bpm.get(), &schema, {0});
+  heap.SetZoneMap(&zone_map);
+
+  const int num_tuples = 5000;
+  std::vector<char> tuple(schema.GetTupleSize());
+  for (int i = 0; i < num_tuples; i++) {
+    schema.SetValue(tuple.data(), 0, {TypeId::BIGINT, i});
+    schema.SetValue(tuple.data(), 1, i % 10 == 0 ? Value::MakeNull(TypeId::DOUBLE) : Value(i * 0.5));
+    schema.SetValue(tuple.data(), 2, {TypeId::INTEGER, i % 7});
+    heap.InsertTuple({false}, tuple.data(), tuple.size());
+  }
+
+  // 1000 <= ts < 2000.5, reading <= 900 or NULL, code == 3
+  ScanOptions options;
+  options.zone_map_ = &zone_map;
+  options.schema_ = &schema;
+  options.ranges_ = {{0, Value(TypeId::BIGINT, 1000), true, Value(2000.5), false},
+                     {1, std::nullopt, true, Value(900.0), true, true},
+                     {2, Value(TypeId::INTEGER, 3), true, Value(TypeId::BIGINT, 3), true}};
+  int expected = 0;
+  for (int i = 1000; i <= 2000; i++) {
+    expected += (i % 10 == 0 || i * 0.5 <= 900) && i % 7 == 3 ? 1 : 0;
+  }
+
+  auto iterator = heap.MakeScanIterator(options);
+  std::vector<TupleView> batch;
+  int matches = 0;
+  while (iterator.NextBatch(&batch)) {
+    for (const auto &view : batch) {
+      int64_t ts = schema.GetValue(view.data_, 0).GetAsInteger();
+      ASSERT_TRUE(ts >= 1000 && ts <= 2000);
+      ASSERT_TRUE(schema.IsNull(view.data_, 1) || schema.GetValue(view.data_, 1).GetAsDouble() <= 900);
+      ASSERT_EQ(3, schema.GetValue(view.data_, 2).GetAsInteger());
+      matches++;
+    }
+  }
+  EXPECT_EQ(expected, matches);
+  EXPECT_GT(iterator.GetPagesSkipped(), 0U);
+  EXPECT_GT(iterator.GetTuplesFiltered(), 0U);
+
+  // a range on a CHAR column cannot be checked
+  Schema with_char({{"tag", TypeId::CHAR, 8}});
+  options.schema_ = &with_char;
+  options.ranges_ = {{0, Value(TypeId::BIGINT, 1), true, std::nullopt, true}};
+  EXPECT_THROW(heap.MakeScanIterator(options), Exception);
+
+  pf_manager->Shutdown();
+}
+
+}  // namespace redbase
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/exception.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+#include "sql/parser.h"
+#include "sql/session.h"
+
+namespace redbase {
+
+class SessionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("session_test.db");
+    pf_manager_ = std::make_unique<PFManager>("session_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(64, pf_manager_.get());
+    heap_ = std::make_unique<TableHeap>(bpm_.get());
+    // id, a = id % 10, b = id / 4.0
+    Schema schema({Column("id", TypeId::BIGINT), Column("a", TypeId::INTEGER), Column("b", TypeId::DOUBLE),
+                   Column("tag", TypeId::CHAR, 8)});
+    std::vector<char> tuple(schema.GetTupleSize());
+    for (int64_t id = 0; id < 1000; id++) {
+      std::fill(tuple.begin(), tuple.end(), 0);
+      schema.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, id));
+      schema.SetValue(tuple.data(), 1, Value(TypeId::INTEGER, id % 10));
+      schema.SetValue(tuple.data(), 2, Value(id / 4.0));
+      schema.SetChar(tuple.data(), 3, "t");
+      ASSERT_TRUE(heap_->InsertTuple({false}, tuple.data(), tuple.size()).has_value());
+    }
+    catalog_.CreateTable("t", std::move(schema), heap_.get());
+  }
+
+  void TearDown() override {
+    heap_.reset();
+    pf_manager_->Shutdown();
+  }
+
+  /** @return the selected rows of the output of the operators, their numeric columns as doubles */
+  static auto Run(std::unique_ptr<Operator> plan) -> std::vector<std::vector<double>> {
+    plan->Init();
+    DataChunk chunk = plan->MakeChunk();
+    std::vector<std::vector<double>> rows;
+    while (plan->Next(&chunk)) {
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        std::vector<double> row;
+        for (uint32_t col = 0; col < plan->GetOutputSchema().GetColumnCount(); col++) {
+          if (!IsNumeric(plan->GetOutputSchema().GetColumn(col).GetType())) {
+            continue;
+          }
+          row.push_back(chunk.GetValue(col, i).GetAsDouble());
+        }
+        rows.push_back(std::move(row));
+      }
+    }
+    return rows;
+  }
+
+  ExecutorContext ctx_;
+  Catalog catalog_;
+  std::unique_ptr<PFManager> pf_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<TableHeap> heap_;
+};
+
+TEST_F(SessionTest, NormalizesAndParses) {
+  EXPECT_EQ("SELECT a , b * 2 FROM t WHERE a <= ? AND b BETWEEN 1 AND 2.5",
+            NormalizeSql("select a,b*2\n  from t Where a<=?  and b between 1 and 2.5;"));
+  EXPECT_EQ(NormalizeSql("SELECT * FROM t"), NormalizeSql("  Select *   From t"));
+
+  auto statement = ParseSelect("SELECT id, -a + 1 FROM t WHERE a IN (1, ?, 3) AND id > ? LIMIT 5 OFFSET 2");
+  EXPECT_EQ(2U, statement.select_list_.size());
+  EXPECT_EQ("t", statement.table_);
+  EXPECT_EQ(2U, statement.param_count_);
+  EXPECT_EQ(5, *statement.limit_);
+  EXPECT_EQ(2, statement.offset_);
+  ASSERT_TRUE(statement.where_.has_value());
+  EXPECT_EQ(ParsedKind::AND, statement.where_->kind_);
+  EXPECT_EQ(ParsedKind::IN_LIST, statement.where_->children_[0].kind_);
+
+  EXPECT_THROW(ParseSelect("SELECT FROM t"), Exception);
+  EXPECT_THROW(ParseSelect("SELECT a FROM t WHERE a"), Exception);
+  EXPECT_THROW(ParseSelect("SELECT a FROM t LIMIT 1.5"), Exception);
+  EXPECT_THROW(ParseSelect("SELECT a FROM t WHERE a = 'x'"), Exception);
+  EXPECT_THROW(ParseSelect("SELECT a FROM t WHERE a = 99999999999999999999"), Exception);
+}
+
+TEST_F(SessionTest, PreparedStatementTakesParameters) {
+  Session session(&catalog_, &ctx_);
+  auto statement = session.Prepare("SELECT id, a + b FROM t WHERE a < ? AND id BETWEEN ? AND 500 LIMIT 4 OFFSET 1");
+  EXPECT_EQ(2U, statement.GetParameterCount());
+
+  for (int64_t low : {100, 203}) {
+    std::vector<std::vector<double>> expected;
+    for (int64_t id = low; id <= 500 && expected.size() < 5; id++) {
+      if (id % 10 < 3) {
+        expected.push_back({static_cast<double>(id), static_cast<double>(id % 10) + id / 4.0});
+      }
+    }
+    expected.erase(expected.begin());
+    EXPECT_EQ(expected, Run(statement.Execute({Value(TypeId::INTEGER, 3), Value(TypeId::BIGINT, low)})));
+  }
+
+  // SELECT * reads every column, the CHAR one too
+  auto plan = session.Execute("SELECT * FROM t WHERE id = ?", {Value(TypeId::BIGINT, 42)});
+  EXPECT_EQ(4U, plan->GetOutputSchema().GetColumnCount());
+  auto rows = Run(std::move(plan));
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ((std::vector<double>{42, 2, 10.5}), rows[0]);
+
+  EXPECT_THROW(statement.Execute({Value(TypeId::INTEGER, 3)}), Exception);
+  EXPECT_THROW(statement.Execute({Value(TypeId::INTEGER, 3), Value::MakeNull(TypeId::BIGINT)}), Exception);
+  EXPECT_THROW(session.Prepare("SELECT c FROM t"), Exception);
+  EXPECT_THROW(session.Prepare("SELECT a FROM u"), Exception);
+  EXPECT_THROW(session.Prepare("SELECT a FROM t WHERE tag = 1"), Exception);
+  EXPECT_THROW(session.Prepare("SELECT a FROM t WHERE a BETWEEN id AND 3"), Exception);
+}
+
+TEST_F(SessionTest, PlanCacheIsSharedAndInvalidated) {
+  PlanCache cache;
+  Session first(&catalog_, &ctx_, &cache);
+  Session second(&catalog_, &ctx_, &cache);
+
+  auto statement = first.Prepare("SELECT id FROM t WHERE a = ? AND id < 100");
+  EXPECT_EQ(0U, cache.GetHits());
+  EXPECT_EQ(1U, cache.GetSize());
+  // the same statement, laid out differently, is planned once for both sessions
+  auto seven = std::vector<Value>{Value(TypeId::INTEGER, 7)};
+  EXPECT_EQ(10U, Run(second.Execute("select id from t where a = ?  and id < 100", seven)).size());
+  EXPECT_EQ(1U, cache.GetHits());
+  EXPECT_EQ(1U, cache.GetSize());
+
+  // new statistics make the plan stale: the next execution plans the statement again
+  catalog_.SetStatistics("t", {1000});
+  EXPECT_EQ(10U, Run(statement.Execute(seven)).size());
+  EXPECT_EQ(1U, cache.GetInvalidations());
+  EXPECT_EQ(10U, Run(second.Execute("SELECT id FROM t WHERE a = ? AND id < 100", seven)).size());
+  EXPECT_EQ(2U, cache.GetHits());
+
+  // a table dropped and created again with another layout: the prepared statement binds to the new one
+  catalog_.DropTable("t");
+  EXPECT_THROW(statement.Execute(seven), Exception);
+  auto heap = std::make_unique<TableHeap>(bpm_.get());
+  Schema schema({Column("a", TypeId::BIGINT), Column("id", TypeId::BIGINT)});
+  std::vector<char> tuple(schema.GetTupleSize());
+  for (int64_t i = 0; i < 20; i++) {
+    schema.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, 7));
+    schema.SetValue(tuple.data(), 1, Value(TypeId::BIGINT, i * 10));
+    ASSERT_TRUE(heap->InsertTuple({false}, tuple.data(), tuple.size()).has_value());
+  }
+  catalog_.CreateTable("t", std::move(schema), heap.get());
+  EXPECT_EQ(10U, Run(statement.Execute(seven)).size());
+
+  // past its capacity the cache drops the least recently used plan
+  PlanCache small(2);
+  Session session(&catalog_, &ctx_, &small);
+  session.Prepare("SELECT a FROM t");
+  session.Prepare("SELECT id FROM t");
+  session.Prepare("SELECT a FROM t");
+  session.Prepare("SELECT a, id FROM t");
+  EXPECT_EQ(2U, small.GetSize());
+  session.Prepare("SELECT a FROM t");
+  EXPECT_EQ(2U, small.GetHits());
+  session.Prepare("SELECT id FROM t");
+  EXPECT_EQ(2U, small.GetHits());
+}
+
+}  // namespace redbase
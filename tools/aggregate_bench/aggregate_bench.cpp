@@ -0,0 +1,142 @@
+/**
+ * aggregate_bench: throughput of the hash aggregation as the number of groups grows.
+ *
+ * The input has --rows rows (key BIGINT, value BIGINT) whose keys are drawn from --groups distinct values (every one
+ * of them showing up when rows is a few times groups), generated in memory a chunk at a time so that only the
+ * aggregation is measured. The query is SELECT key, COUNT(*), SUM(value), MIN(value), MAX(value), AVG(value) GROUP
+ * BY key. It runs in memory on 1 and --threads threads, then with a budget of a quarter of the groups, which spills
+ * partial states to temp pages of the buffer pool.
+ *
+ *   redbase-aggregate-bench [--rows 40000000] [--groups 10000000] [--threads 4] [--pool 65536]
+ *
+ * The 10M to 100M groups of large GROUP BYs take --groups 100000000 --rows 200000000 and tens of GB of memory.
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/hash_aggregate_operator.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+/** Chunks of (key, value) rows, the keys drawn at random from [0, groups). */
+class KeySource : public Operator {
+ public:
+  KeySource(ExecutorContext *ctx, size_t rows, size_t groups)
+      : Operator(ctx, Schema({Column("key", TypeId::BIGINT), Column("value", TypeId::BIGINT)})),
+        rows_(rows),
+        groups_(groups) {}
+
+  void Init() override {
+    pos_ = 0;
+    rng_.seed(42);
+  }
+
+  auto Next(DataChunk *chunk) -> bool override {
+    size_t count = std::min(chunk->GetCapacity(), rows_ - pos_);
+    if (count == 0) {
+      return false;
+    }
+    auto *keys = chunk->GetColumn(0).GetData<int64_t>();
+    auto *values = chunk->GetColumn(1).GetData<int64_t>();
+    for (size_t i = 0; i < count; i++) {
+      keys[i] = static_cast<int64_t>(rng_() % groups_);
+      values[i] = static_cast<int64_t>(pos_ + i);
+    }
+    pos_ += count;
+    chunk->SetSize(count);
+    return true;
+  }
+
+ private:
+  size_t rows_;
+  size_t groups_;
+  size_t pos_{0};
+  std::mt19937_64 rng_;
+};
+
+static void RunBench(size_t rows, size_t groups, size_t num_threads, size_t pool_size) {
+  const char *db_file = "aggregate_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+
+  // hash, key (padded), 5 states, a slot and a half
+  size_t group_bytes = 8 + 16 + 5 * 16 + 24;
+  struct Config {
+    const char *name_;
+    size_t num_threads_;
+    size_t memory_budget_;
+  };
+  std::vector<Config> configs = {{"in memory, 1 thread", 1, SIZE_MAX},
+                                 {"in memory", num_threads, SIZE_MAX},
+                                 {"1/4 in budget", num_threads, groups * group_bytes / 4}};
+  std::vector<Aggregate> aggregates = {{AggregateType::COUNT_STAR},
+                                       {AggregateType::SUM, 1},
+                                       {AggregateType::MIN, 1},
+                                       {AggregateType::MAX, 1},
+                                       {AggregateType::AVG, 1}};
+  printf("%-22s %10s %12s %10s %10s %8s\n", "config", "secs", "rows/s", "ns/row", "groups", "spilled");
+  for (const auto &config : configs) {
+    ExecutorContext ctx;
+    HashAggregateOptions options;
+    options.num_threads_ = config.num_threads_;
+    options.memory_budget_ = config.memory_budget_;
+    options.partition_bits_ = 6;
+    HashAggregateOperator aggregate(&ctx, std::make_unique<KeySource>(&ctx, rows, groups), {0}, aggregates,
+                                    bpm.get(), options);
+    auto start = std::chrono::steady_clock::now();
+    aggregate.Init();
+    DataChunk chunk = aggregate.MakeChunk();
+    size_t result_rows = 0;
+    int64_t total = 0;
+    while (aggregate.Next(&chunk)) {
+      const auto *counts = chunk.GetColumn(1).GetData<int64_t>();
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        total += counts[chunk.GetSelection()[i]];
+      }
+      result_rows += chunk.GetSelectedCount();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (static_cast<size_t>(total) != rows) {
+      printf("%zu rows counted out of %zu\n", static_cast<size_t>(total), rows);
+    }
+    printf("%-22s %10.3f %12.0f %10.1f %10zu %8zu\n", config.name_, secs, rows / secs,
+           secs * 1e9 / static_cast<double>(rows), result_rows, aggregate.GetPartitionsSpilled());
+  }
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  size_t rows = 40000000;
+  size_t groups = 10000000;
+  size_t num_threads = 4;
+  size_t pool_size = 65536;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--rows") {
+      rows = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--groups") {
+      groups = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    } else if (arg == "--threads") {
+      num_threads = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--rows N] [--groups N] [--threads N] [--pool N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(rows, groups, num_threads, pool_size);
+  return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * btree_bench: multithreaded insert and point lookup throughput of the B+ tree index.
+ *
+ * For 1, 2, 4, ... up to --threads threads, a fresh tree is filled with --keys keys (split evenly across the
+ * threads, each inserting its share in random order), then every thread runs --keys / threads random lookups, the
+ * same lookups again through GetValues() in batches of --batch keys, then as many operations of a read-mostly mix
+ * (95% lookups, 5% inserts of new keys).
+ *
+ *   redbase-btree-bench [--threads 32] [--keys 1000000] [--pool 4096] [--batch 256]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "ix/b_plus_tree.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+using Key = GenericKey<16>;
+using Comparator = GenericComparator<16>;
+using Tree = BPlusTree<Key, RID, Comparator>;
+
+static auto MakeKey(const Schema &key_schema, int64_t v) -> Key {
+  char tuple[16] = {0};
+  key_schema.SetValue(tuple, 0, Value(TypeId::BIGINT, v));
+  Key key;
+  key.SetFromKey(tuple, key_schema.GetTupleSize());
+  return key;
+}
+
+/** Run `body(thread_idx)` on `num_threads` threads, @return the elapsed seconds */
+template <typename F>
+static auto RunThreads(int num_threads, F body) -> double {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back(body, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void RunBench(int num_threads, int64_t num_keys, size_t pool_size, size_t batch_size) {
+  const char *db_file = "btree_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+  Schema key_schema({Column("k", TypeId::BIGINT)});
+  Tree tree("bench", bpm.get(), Comparator(&key_schema));
+
+  int64_t per_thread = num_keys / num_threads;
+  double insert_secs = RunThreads(num_threads, [&](int t) {
+    std::vector<int64_t> keys(per_thread);
+    for (int64_t i = 0; i < per_thread; i++) {
+      keys[i] = i * num_threads + t;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(t));
+    for (auto k : keys) {
+      tree.Insert(MakeKey(key_schema, k), RID(static_cast<page_id_t>(k >> 16), static_cast<uint32_t>(k & 0xffff)));
+    }
+  });
+
+  std::atomic<int64_t> found{0};
+  double lookup_secs = RunThreads(num_threads, [&](int t) {
+    std::mt19937_64 rng(t + 1000);
+    std::uniform_int_distribution<int64_t> dist(0, per_thread * num_threads - 1);
+    std::vector<RID> result;
+    int64_t hits = 0;
+    for (int64_t i = 0; i < per_thread; i++) {
+      result.clear();
+      hits += tree.GetValue(MakeKey(key_schema, dist(rng)), &result) ? 1 : 0;
+    }
+    found += hits;
+  });
+
+  std::atomic<int64_t> batch_found{0};
+  double batch_secs = RunThreads(num_threads, [&](int t) {
+    std::mt19937_64 rng(t + 1000);
+    std::uniform_int_distribution<int64_t> dist(0, per_thread * num_threads - 1);
+    std::vector<Key> keys;
+    std::vector<std::optional<RID>> results;
+    int64_t hits = 0;
+    for (int64_t i = 0; i < per_thread; i++) {
+      keys.push_back(MakeKey(key_schema, dist(rng)));
+      if (keys.size() == batch_size || i + 1 == per_thread) {
+        hits += static_cast<int64_t>(tree.GetValues(keys, &results));
+        keys.clear();
+      }
+    }
+    batch_found += hits;
+  });
+
+  double mixed_secs = RunThreads(num_threads, [&](int t) {
+    std::mt19937_64 rng(t + 2000);
+    std::uniform_int_distribution<int64_t> dist(0, per_thread * num_threads - 1);
+    std::vector<RID> result;
+    int64_t next_key = per_thread * num_threads + t;
+    for (int64_t i = 0; i < per_thread; i++) {
+      if (rng() % 100 < 5) {
+        tree.Insert(MakeKey(key_schema, next_key), RID(0, 0));
+        next_key += num_threads;
+      } else {
+        result.clear();
+        tree.GetValue(MakeKey(key_schema, dist(rng)), &result);
+      }
+    }
+  });
+
+  int64_t total = per_thread * num_threads;
+  printf("%7d %16.0f %16.0f %16.0f %16.0f %10s\n", num_threads, total / insert_secs, total / lookup_secs,
+         total / batch_secs, total / mixed_secs, found == total && batch_found == total ? "ok" : "MISSING");
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  int max_threads = 32;
+  int64_t num_keys = 1000000;
+  size_t pool_size = 4096;
+  size_t batch_size = 256;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--threads") {
+      max_threads = std::atoi(argv[i + 1]);
+    } else if (arg == "--keys") {
+      num_keys = std::atoll(argv[i + 1]);
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--batch") {
+      batch_size = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    } else {
+      fprintf(stderr, "usage: %s [--threads N] [--keys N] [--pool N] [--batch N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("%7s %16s %16s %16s %16s %10s\n", "threads", "insert ops/s", "lookup ops/s", "batched ops/s", "95/5 ops/s",
+         "check");
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    redbase::RunBench(threads, num_keys, pool_size, batch_size);
+  }
+  return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * executor_bench: throughput of the batch-at-a-time executor as a function of the batch size.
+ *
+ * A table of --rows tuples (id BIGINT, a INTEGER, b DOUBLE, padding CHAR(40)) is loaded once, then the query
+ *
+ *   SELECT a + b, id FROM t WHERE a < 50 AND b > 1000.0
+ *
+ * (about a quarter of the rows pass) runs through scan, filter and projection operators at batch sizes 1 (a
+ * tuple-at-a-time executor), 16, 128, 1024 and 2048, once with the filter evaluated on the decoded chunks and once
+ * with its comparisons pushed down into the scan, which checks them on the tuples in their pages. Every run scans
+ * the whole table from the buffer pool, which --pool should make large enough to hold it.
+ *
+ *   redbase-executor-bench [--rows 2000000] [--pool 32768] [--repeat 3]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/filter_operator.h"
+#include "execution/projection_operator.h"
+#include "execution/seq_scan_operator.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+static auto MakePlan(ExecutorContext *ctx, TableHeap *heap, const Schema *schema) -> std::unique_ptr<Operator> {
+  auto scan = std::make_unique<SeqScanOperator>(ctx, heap, schema, std::vector<uint32_t>{0, 1, 2});
+  auto id = std::make_shared<ColumnRefExpression>(0, TypeId::BIGINT);
+  auto a = std::make_shared<ColumnRefExpression>(1, TypeId::INTEGER);
+  auto b = std::make_shared<ColumnRefExpression>(2, TypeId::DOUBLE);
+  auto predicate = std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{
+      std::make_shared<ComparisonExpression>(ComparisonType::LESS_THAN, a,
+                                             std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 50))),
+      std::make_shared<ComparisonExpression>(ComparisonType::GREATER_THAN, b,
+                                             std::make_shared<ConstantExpression>(Value(1000.0)))});
+  auto filter = std::make_unique<FilterOperator>(ctx, std::move(scan), predicate);
+  return std::make_unique<ProjectionOperator>(
+      ctx, std::move(filter),
+      std::vector<ExpressionRef>{std::make_shared<ArithmeticExpression>(ArithmeticType::PLUS, a, b), id});
+}
+
+static void RunBench(int64_t num_rows, size_t pool_size, int repeat) {
+  const char *db_file = "executor_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+  Schema schema({Column("id", TypeId::BIGINT), Column("a", TypeId::INTEGER), Column("b", TypeId::DOUBLE),
+                 Column("padding", TypeId::CHAR, 40)});
+  auto heap = std::make_unique<TableHeap>(bpm.get());
+  std::mt19937_64 rng(42);
+  std::vector<char> tuple(schema.GetTupleSize());
+  for (int64_t id = 0; id < num_rows; id++) {
+    std::fill(tuple.begin(), tuple.end(), 0);
+    schema.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, id));
+    schema.SetValue(tuple.data(), 1, Value(TypeId::INTEGER, static_cast<int64_t>(rng() % 100)));
+    schema.SetValue(tuple.data(), 2, Value(static_cast<double>(rng() % 2000)));
+    heap->InsertTuple({false}, tuple.data(), tuple.size());
+  }
+
+  printf("%10s %10s %14s %10s %12s\n", "pushdown", "batch", "rows/s", "ns/row", "result rows");
+  for (bool push_down : {false, true}) {
+    for (size_t batch_size : {1, 16, 128, 1024, 2048}) {
+      ExecutorContext ctx{batch_size};
+      ctx.push_down_predicates_ = push_down;
+      double best_secs = 0;
+      size_t result_rows = 0;
+      for (int r = 0; r < repeat; r++) {
+        auto plan = MakePlan(&ctx, heap.get(), &schema);
+        auto start = std::chrono::steady_clock::now();
+        plan->Init();
+        DataChunk chunk = plan->MakeChunk();
+        double checksum = 0;
+        result_rows = 0;
+        while (plan->Next(&chunk)) {
+          const auto *sums = chunk.GetColumn(0).GetData<double>();
+          for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+            checksum += sums[chunk.GetSelection()[i]];
+          }
+          result_rows += chunk.GetSelectedCount();
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best_secs = r == 0 ? secs : std::min(best_secs, secs);
+        if (checksum < 0) {
+          printf("unreachable\n");
+        }
+      }
+      printf("%10s %10zu %14.0f %10.1f %12zu\n", push_down ? "on" : "off", batch_size, num_rows / best_secs,
+             best_secs * 1e9 / num_rows, result_rows);
+    }
+  }
+  heap.reset();
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  int64_t num_rows = 2000000;
+  size_t pool_size = 32768;
+  int repeat = 3;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--rows") {
+      num_rows = std::atoll(argv[i + 1]);
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--repeat") {
+      repeat = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      fprintf(stderr, "usage: %s [--rows N] [--pool N] [--repeat N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(num_rows, pool_size, repeat);
+  return 0;
+}
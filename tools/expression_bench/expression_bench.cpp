@@ -0,0 +1,148 @@
+/**
+ * expression_bench: cost per row of the interpreted expressions and of the fused kernels they are lowered into by
+ * CompileExpression().
+ *
+ * A chunk of 1024 rows (a INTEGER, b BIGINT, c DOUBLE, one row in 13 NULL) is built in memory, and every expression
+ * is run over it --iterations times (best of 5), dense and through a selection of half the rows:
+ *
+ *   a < 50 AND c > 500.0          a predicate, COMPARE_AND_COMPARE
+ *   a + b > 1000                  a predicate, ARITHMETIC_COMPARE
+ *   a * c                         a value, ARITHMETIC_COLUMNS
+ *   b - 5                         a value, ARITHMETIC_CONSTANT
+ *
+ *   redbase-expression-bench [--iterations 20000]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "execution/compiled_expression.h"
+
+namespace redbase {
+
+static auto MakeChunk(bool sparse) -> DataChunk {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT), Column("c", TypeId::DOUBLE)});
+  DataChunk chunk;
+  chunk.Initialize(schema, EXECUTION_BATCH_SIZE);
+  std::mt19937_64 rng(7);
+  for (uint32_t row = 0; row < EXECUTION_BATCH_SIZE; row++) {
+    chunk.GetColumn(0).SetValue(row, Value(TypeId::INTEGER, static_cast<int64_t>(rng() % 100)));
+    chunk.GetColumn(1).SetValue(row, Value(TypeId::BIGINT, static_cast<int64_t>(rng() % 2000)));
+    chunk.GetColumn(2).SetValue(row, Value(static_cast<double>(rng() % 1000)));
+    if (row % 13 == 0) {
+      chunk.GetColumn(rng() % 3).SetValue(row, Value::MakeNull(TypeId::INTEGER));
+    }
+  }
+  chunk.SetSize(EXECUTION_BATCH_SIZE);
+  if (sparse) {
+    SelectionVector selection(EXECUTION_BATCH_SIZE);
+    size_t count = 0;
+    for (uint32_t row = 0; row < EXECUTION_BATCH_SIZE; row += 2) {
+      selection.GetData()[count++] = row;
+    }
+    selection.SetCount(count);
+    chunk.SetSize(EXECUTION_BATCH_SIZE, selection);
+  }
+  return chunk;
+}
+
+/** Runs of --iterations per measure, the fastest is kept. */
+static constexpr int ROUNDS = 5;
+
+/** @return the ns per selected row of an expression, and its output (the rows kept, or the values) */
+static auto Run(const ExpressionRef &expression, bool predicate, const DataChunk &chunk, int iterations,
+                std::vector<std::string> *output) -> double {
+  SelectionVector selection(EXECUTION_BATCH_SIZE);
+  Vector result;
+  double best_secs = 0;
+  for (int round = 0; round < ROUNDS; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      if (predicate) {
+        selection.Assign(chunk.GetSelection());
+        expression->Select(chunk, &selection);
+      } else {
+        expression->Evaluate(chunk, &result);
+      }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    best_secs = round == 0 ? secs : std::min(best_secs, secs);
+  }
+  output->clear();
+  if (predicate) {
+    for (size_t i = 0; i < selection.GetCount(); i++) {
+      output->push_back(std::to_string(selection[i]));
+    }
+  } else {
+    for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+      output->push_back(result.GetValue(chunk.GetSelection()[i]).ToString());
+    }
+  }
+  return best_secs * 1e9 / (static_cast<double>(iterations) * chunk.GetSelectedCount());
+}
+
+static void RunBench(int iterations) {
+  auto a = std::make_shared<ColumnRefExpression>(0, TypeId::INTEGER);
+  auto b = std::make_shared<ColumnRefExpression>(1, TypeId::BIGINT);
+  auto c = std::make_shared<ColumnRefExpression>(2, TypeId::DOUBLE);
+  struct Case {
+    const char *name_;
+    ExpressionRef expression_;
+    bool predicate_;
+  };
+  std::vector<Case> cases = {
+      {"a < 50 AND c > 500.0",
+       std::make_shared<ConjunctionExpression>(std::vector<ExpressionRef>{
+           std::make_shared<ComparisonExpression>(ComparisonType::LESS_THAN, a,
+                                                  std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 50))),
+           std::make_shared<ComparisonExpression>(ComparisonType::GREATER_THAN, c,
+                                                  std::make_shared<ConstantExpression>(Value(500.0)))}),
+       true},
+      {"a + b > 1000",
+       std::make_shared<ComparisonExpression>(ComparisonType::GREATER_THAN,
+                                              std::make_shared<ArithmeticExpression>(ArithmeticType::PLUS, a, b),
+                                              std::make_shared<ConstantExpression>(Value(TypeId::BIGINT, 1000))),
+       true},
+      {"a * c", std::make_shared<ArithmeticExpression>(ArithmeticType::MULTIPLY, a, c), false},
+      {"b - 5",
+       std::make_shared<ArithmeticExpression>(ArithmeticType::MINUS, b,
+                                              std::make_shared<ConstantExpression>(Value(TypeId::INTEGER, 5))),
+       false},
+  };
+
+  printf("%-22s %8s %14s %14s %9s %8s\n", "expression", "rows", "interpreted", "compiled", "speedup", "match");
+  for (bool sparse : {false, true}) {
+    DataChunk chunk = MakeChunk(sparse);
+    for (const auto &c : cases) {
+      std::vector<std::string> interpreted_output;
+      std::vector<std::string> compiled_output;
+      double interpreted = Run(c.expression_, c.predicate_, chunk, iterations, &interpreted_output);
+      double compiled = Run(CompileExpression(c.expression_), c.predicate_, chunk, iterations, &compiled_output);
+      printf("%-22s %8s %11.2f ns %11.2f ns %8.2fx %8s\n", c.name_, sparse ? "half" : "all", interpreted, compiled,
+             interpreted / compiled, interpreted_output == compiled_output ? "yes" : "NO");
+    }
+  }
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  int iterations = 20000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--iterations") {
+      iterations = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(iterations);
+  return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * hash_index_bench: point lookup throughput of the extendible hash index against the B+ tree.
+ *
+ * Both indexes are filled with --keys int64 keys in random order, then --threads threads run --lookups lookups each,
+ * first on uniformly drawn keys, then on Zipfian ones (skew --theta, the hot keys scattered over the key space). Half
+ * of the lookups target absent keys. With --bloom, both indexes get a Bloom filter of that false positive rate, and
+ * the filter counters are printed after each workload.
+ *
+ *   redbase-hash-index-bench [--keys 1000000] [--lookups 1000000] [--threads 4] [--theta 0.99] [--pool 16384]
+ *                            [--bloom 0.01]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/util/hash_util.h"
+#include "ix/b_plus_tree.h"
+#include "ix/bloom_filter.h"
+#include "ix/extendible_hash_index.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+using Comparator = IntegerComparator<int64_t>;
+using Tree = BPlusTree<int64_t, RID, Comparator>;
+using HashIndex = ExtendibleHashIndex<int64_t, RID, Comparator>;
+
+/** Draws ranks in [0, n) following a Zipfian distribution (Gray et al., "Quickly generating billion-record ..."). */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t n, double theta) : n_(n), theta_(theta) {
+    double zeta_2 = 1 + std::pow(0.5, theta_);
+    zeta_n_ = 0;
+    for (uint64_t i = 1; i <= n_; i++) {
+      zeta_n_ += 1 / std::pow(static_cast<double>(i), theta_);
+    }
+    alpha_ = 1 / (1 - theta_);
+    eta_ = (1 - std::pow(2.0 / n_, 1 - theta_)) / (1 - zeta_2 / zeta_n_);
+  }
+
+  template <typename Rng>
+  auto Next(Rng *rng) const -> uint64_t {
+    double u = std::uniform_real_distribution<double>(0, 1)(*rng);
+    double uz = u * zeta_n_;
+    if (uz < 1) {
+      return 0;
+    }
+    if (uz < 1 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    return std::min<uint64_t>(n_ - 1, static_cast<uint64_t>(n_ * std::pow(eta_ * u - eta_ + 1, alpha_)));
+  }
+
+ private:
+  uint64_t n_;
+  double theta_;
+  double zeta_n_;
+  double alpha_;
+  double eta_;
+};
+
+/** Run `body(thread_idx)` on `num_threads` threads, @return the elapsed seconds */
+template <typename F>
+static auto RunThreads(int num_threads, F body) -> double {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back(body, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** @return the lookup keys of every thread: even keys are in the index, odd ones are not */
+static auto MakeProbes(int num_threads, int64_t num_keys, int64_t num_lookups, const ZipfianGenerator *zipf)
+    -> std::vector<std::vector<int64_t>> {
+  std::vector<std::vector<int64_t>> probes(num_threads);
+  for (int t = 0; t < num_threads; t++) {
+    std::mt19937_64 rng(t + 1);
+    std::uniform_int_distribution<int64_t> uniform(0, 2 * num_keys - 1);
+    for (int64_t i = 0; i < num_lookups; i++) {
+      if (zipf == nullptr) {
+        probes[t].push_back(uniform(rng));
+      } else {
+        // scatter the ranks, so that the hot keys are not neighbours
+        probes[t].push_back(static_cast<int64_t>(HashUtil::Mix(zipf->Next(&rng)) % (2 * num_keys)));
+      }
+    }
+  }
+  return probes;
+}
+
+template <typename Index>
+static auto TimeLookups(const Index &index, const std::vector<std::vector<int64_t>> &probes, int64_t *found)
+    -> double {
+  std::vector<int64_t> hits(probes.size());
+  double secs = RunThreads(static_cast<int>(probes.size()), [&](int t) {
+    std::vector<RID> result;
+    for (auto k : probes[t]) {
+      result.clear();
+      hits[t] += index.GetValue(k, &result) ? 1 : 0;
+    }
+  });
+  *found = std::accumulate(hits.begin(), hits.end(), int64_t{0});
+  return secs;
+}
+
+/** Print and reset the counters of a filter, if any. */
+static void ReportFilter(const char *index, BloomFilter *filter) {
+  if (filter == nullptr) {
+    return;
+  }
+  auto stats = filter->GetStats();
+  printf("%-10s %-10s %16lu skipped, %lu passed, %lu false positives\n", index, "bloom", stats.skipped_, stats.passed_,
+         stats.false_positives_);
+  filter->ResetStats();
+}
+
+static void RunBench(int64_t num_keys, int64_t num_lookups, int num_threads, double theta, size_t pool_size,
+                     double bloom_rate) {
+  const char *db_file = "hash_index_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+  Tree tree("tree", bpm.get(), Comparator());
+  HashIndex hash_index("hash", bpm.get(), Comparator());
+  std::unique_ptr<BloomFilter> tree_filter;
+  std::unique_ptr<BloomFilter> hash_filter;
+  if (bloom_rate > 0) {
+    BloomFilterOptions options;
+    options.expected_keys_ = num_keys;
+    options.false_positive_rate_ = bloom_rate;
+    tree_filter = std::make_unique<BloomFilter>(bpm.get(), options);
+    hash_filter = std::make_unique<BloomFilter>(bpm.get(), options);
+    tree.SetBloomFilter(tree_filter.get());
+    hash_index.SetBloomFilter(hash_filter.get());
+  }
+
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    keys[i] = 2 * i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  auto start = std::chrono::steady_clock::now();
+  for (auto k : keys) {
+    tree.Insert(k, RID(static_cast<page_id_t>(k >> 16), static_cast<uint32_t>(k & 0xffff)));
+  }
+  double tree_insert_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (auto k : keys) {
+    hash_index.Insert(k, RID(static_cast<page_id_t>(k >> 16), static_cast<uint32_t>(k & 0xffff)));
+  }
+  double hash_insert_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%-10s %-10s %16.0f\n", "b+tree", "insert", num_keys / tree_insert_secs);
+  printf("%-10s %-10s %16.0f\n", "hash", "insert", num_keys / hash_insert_secs);
+
+  ZipfianGenerator zipf(2 * num_keys, theta);
+  for (const auto *dist : {"uniform", "zipfian"}) {
+    auto probes = MakeProbes(num_threads, num_keys, num_lookups, std::string(dist) == "zipfian" ? &zipf : nullptr);
+    int64_t tree_found;
+    int64_t hash_found;
+    double tree_secs = TimeLookups(tree, probes, &tree_found);
+    double hash_secs = TimeLookups(hash_index, probes, &hash_found);
+    int64_t total = num_lookups * num_threads;
+    printf("%-10s %-10s %16.0f\n", "b+tree", dist, total / tree_secs);
+    printf("%-10s %-10s %16.0f %s\n", "hash", dist, total / hash_secs, tree_found == hash_found ? "" : "MISMATCH");
+    ReportFilter("b+tree", tree_filter.get());
+    ReportFilter("hash", hash_filter.get());
+  }
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  int64_t num_keys = 1000000;
+  int64_t num_lookups = 1000000;
+  int num_threads = 4;
+  double theta = 0.99;
+  size_t pool_size = 16384;
+  double bloom_rate = 0;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--keys") {
+      num_keys = std::atoll(argv[i + 1]);
+    } else if (arg == "--lookups") {
+      num_lookups = std::atoll(argv[i + 1]);
+    } else if (arg == "--threads") {
+      num_threads = std::atoi(argv[i + 1]);
+    } else if (arg == "--theta") {
+      theta = std::atof(argv[i + 1]);
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--bloom") {
+      bloom_rate = std::atof(argv[i + 1]);
+    } else {
+      fprintf(stderr, "usage: %s [--keys N] [--lookups N] [--threads N] [--theta F] [--pool N] [--bloom F]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  printf("%-10s %-10s %16s\n", "index", "workload", "ops/s");
+  redbase::RunBench(num_keys, num_lookups, num_threads, theta, pool_size, bloom_rate);
+  return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * hash_join_bench: throughput of the radix-partitioned hash join.
+ *
+ * The build side has --build rows (key BIGINT, payload BIGINT) with distinct keys in a random order, the probe side
+ * --probe rows (key BIGINT, id BIGINT) whose keys hit the build side half of the time. Both are generated in memory a
+ * chunk at a time, so that only the join is measured. The join runs with 1, 64 and 1024 partitions in memory, then
+ * with a budget of a quarter of the build side, which spills most partitions to temp pages of the buffer pool.
+ *
+ *   redbase-hash-join-bench [--build 2000000] [--probe 8000000] [--threads 4] [--pool 65536]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/hash_join_operator.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+/** Chunks of (key, value) rows, the keys taken from a list. */
+class KeySource : public Operator {
+ public:
+  KeySource(ExecutorContext *ctx, const std::vector<int64_t> *keys)
+      : Operator(ctx, Schema({Column("key", TypeId::BIGINT), Column("value", TypeId::BIGINT)})), keys_(keys) {}
+
+  void Init() override { pos_ = 0; }
+
+  auto Next(DataChunk *chunk) -> bool override {
+    size_t count = std::min(chunk->GetCapacity(), keys_->size() - pos_);
+    if (count == 0) {
+      return false;
+    }
+    auto *keys = chunk->GetColumn(0).GetData<int64_t>();
+    auto *values = chunk->GetColumn(1).GetData<int64_t>();
+    for (size_t i = 0; i < count; i++) {
+      keys[i] = (*keys_)[pos_ + i];
+      values[i] = static_cast<int64_t>(pos_ + i);
+    }
+    pos_ += count;
+    chunk->SetSize(count);
+    return true;
+  }
+
+ private:
+  const std::vector<int64_t> *keys_;
+  size_t pos_{0};
+};
+
+static void RunBench(size_t build_rows, size_t probe_rows, size_t num_threads, size_t pool_size) {
+  const char *db_file = "hash_join_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+
+  std::mt19937_64 rng(42);
+  std::vector<int64_t> build_keys(build_rows);
+  std::iota(build_keys.begin(), build_keys.end(), 0);
+  std::shuffle(build_keys.begin(), build_keys.end(), rng);
+  std::vector<int64_t> probe_keys(probe_rows);
+  for (auto &key : probe_keys) {
+    key = static_cast<int64_t>(rng() % (2 * build_rows));
+  }
+
+  size_t build_bytes = build_rows * (2 + 2 * sizeof(int64_t) + sizeof(int64_t));
+  struct Config {
+    const char *name_;
+    size_t partition_bits_;
+    size_t memory_budget_;
+  };
+  std::vector<Config> configs = {{"1 partition", 0, SIZE_MAX},
+                                 {"64 partitions", 6, SIZE_MAX},
+                                 {"1024 partitions", 10, SIZE_MAX},
+                                 {"64, 1/4 in budget", 6, build_bytes / 4}};
+  printf("%-20s %10s %14s %10s %12s %9s\n", "config", "secs", "probe rows/s", "ns/row", "result rows", "spilled");
+  for (const auto &config : configs) {
+    ExecutorContext ctx;
+    HashJoinOptions options;
+    options.partition_bits_ = config.partition_bits_;
+    options.memory_budget_ = config.memory_budget_;
+    options.num_threads_ = num_threads;
+    HashJoinOperator join(&ctx, std::make_unique<KeySource>(&ctx, &probe_keys),
+                          std::make_unique<KeySource>(&ctx, &build_keys), 0, 0, bpm.get(), options);
+    auto start = std::chrono::steady_clock::now();
+    join.Init();
+    DataChunk chunk = join.MakeChunk();
+    size_t result_rows = 0;
+    int64_t checksum = 0;
+    while (join.Next(&chunk)) {
+      const auto *values = chunk.GetColumn(3).GetData<int64_t>();
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        checksum += values[chunk.GetSelection()[i]];
+      }
+      result_rows += chunk.GetSelectedCount();
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (checksum < 0) {
+      printf("unreachable\n");
+    }
+    printf("%-20s %10.3f %14.0f %10.1f %12zu %9zu\n", config.name_, secs, probe_rows / secs,
+           secs * 1e9 / static_cast<double>(build_rows + probe_rows), result_rows, join.GetPartitionsSpilled());
+  }
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  size_t build_rows = 2000000;
+  size_t probe_rows = 8000000;
+  size_t num_threads = 4;
+  size_t pool_size = 65536;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--build") {
+      build_rows = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--probe") {
+      probe_rows = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--threads") {
+      num_threads = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--build N] [--probe N] [--threads N] [--pool N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(build_rows, probe_rows, num_threads, pool_size);
+  return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ * node_search_bench: cost of searching a key inside one full B+ tree leaf, per key width.
+ *
+ * Integer keys (int32_t, int64_t) are searched with every SIMD kernel the CPU supports and with the scalar one;
+ * GenericKeys of 8 to 64 bytes, which the tree compares column by column through the key schema, go through the
+ * regular binary search of the leaf. Every search looks up a random key of the leaf.
+ *
+ *   redbase-node-search-bench [--searches 10000000]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/rid.h"
+#include "ix/b_plus_tree_leaf_page.h"
+#include "ix/generic_key.h"
+#include "ix/node_search.h"
+
+namespace redbase {
+
+/** A page-sized, suitably aligned buffer to lay a leaf out in. */
+struct alignas(64) PageBuffer {
+  char data_[PAGE_SIZE];
+};
+
+/** Run `search(probe)` over the probes, @return the nanoseconds per search */
+template <typename Probe, typename F>
+static auto TimeSearches(const std::vector<Probe> &probes, size_t num_searches, F search) -> double {
+  int64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_searches; i++) {
+    checksum += search(probes[i % probes.size()]);
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (checksum == -1) {
+    printf("unreachable\n");  // keeps the searches from being optimized away
+  }
+  return secs * 1e9 / num_searches;
+}
+
+static void PrintRow(const std::string &key, size_t width, int slots, const char *search, double ns) {
+  printf("%-16s %6zu %6d %-10s %10.2f\n", key.c_str(), width, slots, search, ns);
+}
+
+template <typename T>
+static void BenchIntegerKey(const char *name, size_t num_searches) {
+  using LeafPage = BPlusTreeLeafPage<T, RID, IntegerComparator<T>>;
+  auto buffer = std::make_unique<PageBuffer>();
+  auto leaf = reinterpret_cast<LeafPage *>(buffer->data_);
+  leaf->Init();
+  IntegerComparator<T> comparator;
+  for (int i = 0; i < leaf->GetMaxSize(); i++) {
+    leaf->Insert(static_cast<T>(i) * 2, RID(0, i), comparator);
+  }
+  int size = leaf->GetSize();
+  std::vector<T> keys(size);
+  for (int i = 0; i < size; i++) {
+    keys[i] = leaf->KeyAt(i);
+  }
+  std::vector<T> probes(1 << 16);
+  std::mt19937_64 rng(42);
+  for (auto &p : probes) {
+    p = keys[rng() % size];
+  }
+
+  std::vector<SearchKernel> kernels = {SearchKernel::SCALAR};
+  if (GetSearchKernel() != SearchKernel::SCALAR) {
+    kernels.push_back(SearchKernel::SSE4);
+  }
+  if (GetSearchKernel() == SearchKernel::AVX2) {
+    kernels.push_back(SearchKernel::AVX2);
+  }
+  for (auto kernel : kernels) {
+    double ns =
+        TimeSearches(probes, num_searches, [&](T p) { return NodeSearch(kernel, keys.data(), size, p, false); });
+    PrintRow(name, sizeof(T), size, SearchKernelName(kernel), ns);
+  }
+  double ns = TimeSearches(probes, num_searches, [&](T p) { return leaf->KeyIndex(p, comparator); });
+  PrintRow(name, sizeof(T), size, "leaf", ns);
+}
+
+template <size_t KeySize>
+static void BenchGenericKey(size_t num_searches) {
+  using LeafPage = BPlusTreeLeafPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  Schema key_schema({Column("k", KeySize > 8 ? TypeId::BIGINT : TypeId::INTEGER)});
+  GenericComparator<KeySize> comparator(&key_schema);
+  auto make_key = [&](int64_t v) {
+    char tuple[16] = {0};
+    key_schema.SetValue(tuple, 0, KeySize > 8 ? Value(TypeId::BIGINT, v) : Value(TypeId::INTEGER, v));
+    GenericKey<KeySize> key;
+    key.SetFromKey(tuple, key_schema.GetTupleSize());
+    return key;
+  };
+
+  auto buffer = std::make_unique<PageBuffer>();
+  auto leaf = reinterpret_cast<LeafPage *>(buffer->data_);
+  leaf->Init();
+  for (int i = 0; i < leaf->GetMaxSize(); i++) {
+    leaf->Insert(make_key(i * 2), RID(0, i), comparator);
+  }
+  std::vector<GenericKey<KeySize>> probes(1 << 16);
+  std::mt19937_64 rng(42);
+  for (auto &p : probes) {
+    p = leaf->KeyAt(static_cast<int>(rng() % leaf->GetSize()));
+  }
+  double ns =
+      TimeSearches(probes, num_searches, [&](const GenericKey<KeySize> &p) { return leaf->KeyIndex(p, comparator); });
+  PrintRow("GenericKey<" + std::to_string(KeySize) + ">", KeySize, leaf->GetSize(), "binary", ns);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  size_t num_searches = 10000000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--searches") {
+      num_searches = std::strtoull(argv[i + 1], nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--searches N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("%-16s %6s %6s %-10s %10s\n", "key", "bytes", "slots", "search", "ns/search");
+  redbase::BenchIntegerKey<int32_t>("int32_t", num_searches);
+  redbase::BenchIntegerKey<int64_t>("int64_t", num_searches);
+  redbase::BenchGenericKey<8>(num_searches);
+  redbase::BenchGenericKey<16>(num_searches);
+  redbase::BenchGenericKey<32>(num_searches);
+  redbase::BenchGenericKey<64>(num_searches);
+  return 0;
+}
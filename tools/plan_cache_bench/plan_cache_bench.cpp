@@ -0,0 +1,134 @@
+/**
+ * plan_cache_bench: per-statement overhead of parsing, binding and planning, with and without a plan cache.
+ *
+ * A table t (id BIGINT, a INTEGER, b DOUBLE) of --rows rows (small, so that running a statement costs little next to
+ * preparing it) is registered in a catalog, then --statements executions of a mix of parameterized statements such as
+ *
+ *   SELECT id, a + b FROM t WHERE id = ? AND a < ?
+ *
+ * run three ways: as SQL text through a session without a plan cache (every statement is parsed, bound and
+ * planned), as SQL text through a session with a plan cache (normalized and looked up), and through statements
+ * prepared once (executed with parameters only). For each, the time to turn a statement into operators and the time
+ * per statement including the run are reported.
+ *
+ *   redbase-plan-cache-bench [--rows 64] [--statements 200000]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+#include "sql/session.h"
+
+namespace redbase {
+
+/** The statements of the mix, each with two parameters. */
+static const char *const STATEMENTS[] = {
+    "SELECT id, a + b FROM t WHERE id = ? AND a < ?",
+    "SELECT * FROM t WHERE a BETWEEN ? AND ? LIMIT 10",
+    "SELECT b * 2, id FROM t WHERE a IN (?, ?) AND b > 1.5",
+    "select id from t where id >= ? and id < ? + 8",
+};
+
+static auto Drain(Operator *plan) -> size_t {
+  plan->Init();
+  DataChunk chunk = plan->MakeChunk();
+  size_t rows = 0;
+  while (plan->Next(&chunk)) {
+    rows += chunk.GetSelectedCount();
+  }
+  return rows;
+}
+
+/**
+ * Run the statements of the mix in turn.
+ * @param make the operators of an execution of statement s with the given parameters
+ */
+static void RunMode(const char *name, size_t num_statements,
+                    const std::function<std::unique_ptr<Operator>(size_t, const std::vector<Value> &)> &make) {
+  double plan_secs = 0;
+  size_t rows = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_statements; i++) {
+    std::vector<Value> params = {Value(TypeId::BIGINT, static_cast<int64_t>(i % 50)),
+                                 Value(TypeId::BIGINT, static_cast<int64_t>(i % 7 + 3))};
+    auto plan_start = std::chrono::steady_clock::now();
+    auto plan = make(i % std::size(STATEMENTS), params);
+    plan_secs += std::chrono::duration<double>(std::chrono::steady_clock::now() - plan_start).count();
+    rows += Drain(plan.get());
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("%12s %14.2f %14.2f %14.0f %12zu\n", name, plan_secs * 1e6 / num_statements, secs * 1e6 / num_statements,
+         num_statements / secs, rows);
+}
+
+static void RunBench(int64_t num_rows, size_t num_statements) {
+  const char *db_file = "plan_cache_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(1024, pf_manager.get());
+  Schema schema({Column("id", TypeId::BIGINT), Column("a", TypeId::INTEGER), Column("b", TypeId::DOUBLE)});
+  auto heap = std::make_unique<TableHeap>(bpm.get());
+  std::vector<char> tuple(schema.GetTupleSize());
+  for (int64_t id = 0; id < num_rows; id++) {
+    schema.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, id));
+    schema.SetValue(tuple.data(), 1, Value(TypeId::INTEGER, id % 10));
+    schema.SetValue(tuple.data(), 2, Value(id * 0.5));
+    heap->InsertTuple({false}, tuple.data(), tuple.size());
+  }
+  Catalog catalog;
+  catalog.CreateTable("t", schema, heap.get());
+  ExecutorContext ctx;
+
+  printf("%12s %14s %14s %14s %12s\n", "mode", "us/plan", "us/stmt", "stmts/s", "result rows");
+  Session uncached(&catalog, &ctx);
+  RunMode("no cache", num_statements, [&](size_t s, const std::vector<Value> &params) {
+    return uncached.Execute(STATEMENTS[s], params);
+  });
+
+  PlanCache cache;
+  Session cached(&catalog, &ctx, &cache);
+  RunMode("plan cache", num_statements, [&](size_t s, const std::vector<Value> &params) {
+    return cached.Execute(STATEMENTS[s], params);
+  });
+
+  std::vector<PreparedStatement> prepared;
+  for (const char *sql : STATEMENTS) {
+    prepared.push_back(uncached.Prepare(sql));
+  }
+  RunMode("prepared", num_statements,
+          [&](size_t s, const std::vector<Value> &params) { return prepared[s].Execute(params); });
+
+  printf("plan cache: %zu hits, %zu misses\n", cache.GetHits(), cache.GetMisses());
+  heap.reset();
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  int64_t num_rows = 64;
+  size_t num_statements = 200000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--rows") {
+      num_rows = std::atoll(argv[i + 1]);
+    } else if (arg == "--statements") {
+      num_statements = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    } else {
+      fprintf(stderr, "usage: %s [--rows N] [--statements N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(num_rows, num_statements);
+  return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * scaling_bench: speedup of morsel-driven execution from 1 to --threads workers.
+ *
+ * A fact table t (k BIGINT, grp INTEGER, v BIGINT) of --rows rows and a dimension table d (k BIGINT, w BIGINT) of
+ * --dim rows are loaded into table heaps of a buffer pool large enough to hold them, then three queries run on a
+ * TaskScheduler of 1, 2, 4, ... workers, their pipelines split into morsels of MORSEL_PAGES pages:
+ *
+ *   scan       SELECT COUNT(*), SUM(v) FROM t WHERE v < 500
+ *   aggregate  SELECT grp, COUNT(*), SUM(v) FROM t GROUP BY grp      (--groups groups)
+ *   join       SELECT COUNT(*), SUM(w) FROM t JOIN d ON t.k = d.k
+ *
+ *   redbase-scaling-bench [--rows 8000000] [--dim 200000] [--groups 100000] [--threads 8] [--pool 131072]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/task_scheduler.h"
+#include "execution/expression.h"
+#include "execution/filter_operator.h"
+#include "execution/hash_aggregate_operator.h"
+#include "execution/hash_join_operator.h"
+#include "execution/seq_scan_operator.h"
+#include "pf/pf_manager.h"
+#include "rm/table_heap.h"
+
+namespace redbase {
+
+/** The tables of the queries. */
+struct Tables {
+  Schema fact_schema_{{Column("k", TypeId::BIGINT), Column("grp", TypeId::INTEGER), Column("v", TypeId::BIGINT)}};
+  Schema dim_schema_{{Column("k", TypeId::BIGINT), Column("w", TypeId::BIGINT)}};
+  std::unique_ptr<TableHeap> fact_;
+  std::unique_ptr<TableHeap> dim_;
+};
+
+static void Load(Tables *tables, BufferPoolManager *bpm, size_t rows, size_t dim_rows, size_t groups) {
+  std::mt19937_64 rng(42);
+  tables->fact_ = std::make_unique<TableHeap>(bpm);
+  std::vector<char> tuple(tables->fact_schema_.GetTupleSize());
+  for (size_t i = 0; i < rows; i++) {
+    // half of the rows find their key in d
+    tables->fact_schema_.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, static_cast<int64_t>(rng() % (2 * dim_rows))));
+    tables->fact_schema_.SetValue(tuple.data(), 1, Value(TypeId::INTEGER, static_cast<int64_t>(rng() % groups)));
+    tables->fact_schema_.SetValue(tuple.data(), 2, Value(TypeId::BIGINT, static_cast<int64_t>(rng() % 1000)));
+    tables->fact_->InsertTuple({false}, tuple.data(), tuple.size());
+  }
+  tables->dim_ = std::make_unique<TableHeap>(bpm);
+  tuple.resize(tables->dim_schema_.GetTupleSize());
+  for (size_t i = 0; i < dim_rows; i++) {
+    tables->dim_schema_.SetValue(tuple.data(), 0, Value(TypeId::BIGINT, static_cast<int64_t>(i)));
+    tables->dim_schema_.SetValue(tuple.data(), 1, Value(TypeId::BIGINT, static_cast<int64_t>(i % 97)));
+    tables->dim_->InsertTuple({false}, tuple.data(), tuple.size());
+  }
+}
+
+static auto MakeScanQuery(ExecutorContext *ctx, Tables *tables, BufferPoolManager *bpm) -> std::unique_ptr<Operator> {
+  auto scan = std::make_unique<SeqScanOperator>(ctx, tables->fact_.get(), &tables->fact_schema_,
+                                                std::vector<uint32_t>{2});
+  auto predicate = std::make_shared<ComparisonExpression>(
+      ComparisonType::LESS_THAN, std::make_shared<ColumnRefExpression>(0, TypeId::BIGINT),
+      std::make_shared<ConstantExpression>(Value(TypeId::BIGINT, 500)));
+  auto filter = std::make_unique<FilterOperator>(ctx, std::move(scan), predicate);
+  return std::make_unique<HashAggregateOperator>(
+      ctx, std::move(filter), std::vector<uint32_t>{},
+      std::vector<Aggregate>{{AggregateType::COUNT_STAR}, {AggregateType::SUM, 0}}, bpm);
+}
+
+static auto MakeAggregateQuery(ExecutorContext *ctx, Tables *tables, BufferPoolManager *bpm)
+    -> std::unique_ptr<Operator> {
+  auto scan = std::make_unique<SeqScanOperator>(ctx, tables->fact_.get(), &tables->fact_schema_,
+                                                std::vector<uint32_t>{1, 2});
+  return std::make_unique<HashAggregateOperator>(
+      ctx, std::move(scan), std::vector<uint32_t>{0},
+      std::vector<Aggregate>{{AggregateType::COUNT_STAR}, {AggregateType::SUM, 1}}, bpm);
+}
+
+static auto MakeJoinQuery(ExecutorContext *ctx, Tables *tables, BufferPoolManager *bpm) -> std::unique_ptr<Operator> {
+  auto probe = std::make_unique<SeqScanOperator>(ctx, tables->fact_.get(), &tables->fact_schema_,
+                                                 std::vector<uint32_t>{0});
+  auto build = std::make_unique<SeqScanOperator>(ctx, tables->dim_.get(), &tables->dim_schema_,
+                                                 std::vector<uint32_t>{0, 1});
+  auto join = std::make_unique<HashJoinOperator>(ctx, std::move(probe), std::move(build), 0, 0, bpm);
+  // probe k, build k, build w
+  return std::make_unique<HashAggregateOperator>(
+      ctx, std::move(join), std::vector<uint32_t>{},
+      std::vector<Aggregate>{{AggregateType::COUNT_STAR}, {AggregateType::SUM, 2}}, bpm);
+}
+
+/** @return the sum of the BIGINT outputs of a query, as a checksum, and the number of rows */
+static auto RunQuery(Operator *query, size_t *result_rows) -> int64_t {
+  query->Init();
+  DataChunk chunk = query->MakeChunk();
+  int64_t checksum = 0;
+  *result_rows = 0;
+  while (query->Next(&chunk)) {
+    for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+      for (size_t col = 0; col < chunk.GetColumnCount(); col++) {
+        Value value = chunk.GetValue(col, i);
+        checksum += value.IsNull() ? 0 : value.GetAsInteger();
+      }
+    }
+    *result_rows += chunk.GetSelectedCount();
+  }
+  return checksum;
+}
+
+static void RunBench(size_t rows, size_t dim_rows, size_t groups, size_t max_threads, size_t pool_size) {
+  const char *db_file = "scaling_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+  Tables tables;
+  Load(&tables, bpm.get(), rows, dim_rows, groups);
+  printf("t: %zu rows in %zu pages, d: %zu rows, %zu pages per morsel\n", rows, tables.fact_->GetPageCount(),
+         dim_rows, MORSEL_PAGES);
+
+  struct Query {
+    const char *name_;
+    std::function<std::unique_ptr<Operator>(ExecutorContext *, Tables *, BufferPoolManager *)> make_;
+    double base_secs_{0};
+    int64_t checksum_{0};
+  };
+  std::vector<Query> queries = {{"scan", MakeScanQuery}, {"aggregate", MakeAggregateQuery}, {"join", MakeJoinQuery}};
+  printf("%-10s %8s %10s %12s %8s %10s\n", "query", "workers", "secs", "rows/s", "speedup", "result");
+  std::vector<size_t> worker_counts;
+  for (size_t workers = 1; workers < max_threads; workers *= 2) {
+    worker_counts.push_back(workers);
+  }
+  worker_counts.push_back(max_threads);
+  for (size_t workers : worker_counts) {
+    TaskScheduler scheduler(workers);
+    ExecutorContext ctx;
+    ctx.scheduler_ = &scheduler;
+    for (auto &query : queries) {
+      auto op = query.make_(&ctx, &tables, bpm.get());
+      auto start = std::chrono::steady_clock::now();
+      size_t result_rows;
+      int64_t checksum = RunQuery(op.get(), &result_rows);
+      double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (workers == 1) {
+        query.base_secs_ = secs;
+        query.checksum_ = checksum;
+      } else if (checksum != query.checksum_) {
+        printf("%s: checksum %lld with %zu workers, %lld with 1\n", query.name_, static_cast<long long>(checksum),
+               workers, static_cast<long long>(query.checksum_));
+      }
+      printf("%-10s %8zu %10.3f %12.0f %8.2f %10zu\n", query.name_, workers, secs, rows / secs, query.base_secs_ / secs,
+             result_rows);
+    }
+  }
+  tables.fact_.reset();
+  tables.dim_.reset();
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  size_t rows = 8000000;
+  size_t dim_rows = 200000;
+  size_t groups = 100000;
+  size_t num_threads = 8;
+  size_t pool_size = 131072;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--rows") {
+      rows = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--dim") {
+      dim_rows = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    } else if (arg == "--groups") {
+      groups = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    } else if (arg == "--threads") {
+      num_threads = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--rows N] [--dim N] [--groups N] [--threads N] [--pool N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(rows, dim_rows, groups, num_threads, pool_size);
+  return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * sort_bench: throughput of the sort operator, in memory and spilling.
+ *
+ * The input has --rows rows (key BIGINT, value BIGINT) with random keys, generated in memory a chunk at a time so
+ * that only the sort is measured. The sort runs with everything in memory on 1 and --threads threads, then with a
+ * budget of a tenth of the records, which spills runs to temp pages of the buffer pool and merges them.
+ *
+ *   redbase-sort-bench [--rows 4000000] [--threads 4] [--pool 65536]
+ */
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/sort_operator.h"
+#include "pf/pf_manager.h"
+
+namespace redbase {
+
+/** Chunks of (key, value) rows, the keys taken from a list. */
+class KeySource : public Operator {
+ public:
+  KeySource(ExecutorContext *ctx, const std::vector<int64_t> *keys)
+      : Operator(ctx, Schema({Column("key", TypeId::BIGINT), Column("value", TypeId::BIGINT)})), keys_(keys) {}
+
+  void Init() override { pos_ = 0; }
+
+  auto Next(DataChunk *chunk) -> bool override {
+    size_t count = std::min(chunk->GetCapacity(), keys_->size() - pos_);
+    if (count == 0) {
+      return false;
+    }
+    auto *keys = chunk->GetColumn(0).GetData<int64_t>();
+    auto *values = chunk->GetColumn(1).GetData<int64_t>();
+    for (size_t i = 0; i < count; i++) {
+      keys[i] = (*keys_)[pos_ + i];
+      values[i] = static_cast<int64_t>(pos_ + i);
+    }
+    pos_ += count;
+    chunk->SetSize(count);
+    return true;
+  }
+
+ private:
+  const std::vector<int64_t> *keys_;
+  size_t pos_{0};
+};
+
+static void RunBench(size_t rows, size_t num_threads, size_t pool_size) {
+  const char *db_file = "sort_bench.db";
+  remove(db_file);
+  auto pf_manager = std::make_unique<PFManager>(db_file);
+  auto bpm = std::make_unique<BufferPoolManager>(pool_size, pf_manager.get());
+
+  std::mt19937_64 rng(42);
+  std::vector<int64_t> keys(rows);
+  for (auto &key : keys) {
+    key = static_cast<int64_t>(rng());
+  }
+
+  // key (flag + 8 bytes), row (2 flags + 16 bytes), entry
+  size_t bytes = rows * (9 + 18 + 16);
+  struct Config {
+    const char *name_;
+    size_t num_threads_;
+    size_t memory_budget_;
+  };
+  std::vector<Config> configs = {{"in memory, 1 thread", 1, SIZE_MAX},
+                                 {"in memory", num_threads, SIZE_MAX},
+                                 {"1/10 in budget", num_threads, bytes / 10}};
+  printf("%-22s %10s %12s %10s %8s\n", "config", "secs", "rows/s", "ns/row", "runs");
+  for (const auto &config : configs) {
+    ExecutorContext ctx;
+    ExternalSortOptions options;
+    options.num_threads_ = config.num_threads_;
+    options.memory_budget_ = config.memory_budget_;
+    SortOperator sort(&ctx, std::make_unique<KeySource>(&ctx, &keys), {{0, true}}, bpm.get(), options);
+    auto start = std::chrono::steady_clock::now();
+    sort.Init();
+    DataChunk chunk = sort.MakeChunk();
+    int64_t previous = INT64_MIN;
+    size_t out_of_order = 0;
+    while (sort.Next(&chunk)) {
+      const auto *values = chunk.GetColumn(0).GetData<int64_t>();
+      for (size_t i = 0; i < chunk.GetSelectedCount(); i++) {
+        int64_t key = values[chunk.GetSelection()[i]];
+        out_of_order += key < previous ? 1 : 0;
+        previous = key;
+      }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (out_of_order != 0) {
+      printf("%zu rows out of order\n", out_of_order);
+    }
+    printf("%-22s %10.3f %12.0f %10.1f %8zu\n", config.name_, secs, rows / secs, secs * 1e9 / static_cast<double>(rows),
+           sort.GetRunsSpilled());
+  }
+  pf_manager->Shutdown();
+  remove(db_file);
+}
+
+}  // namespace redbase
+
+auto main(int argc, char **argv) -> int {
+  size_t rows = 4000000;
+  size_t num_threads = 4;
+  size_t pool_size = 65536;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string arg = argv[i];
+    if (arg == "--rows") {
+      rows = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--threads") {
+      num_threads = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--pool") {
+      pool_size = std::strtoull(argv[i + 1], nullptr, 10);
+    } else {
+      fprintf(stderr, "usage: %s [--rows N] [--threads N] [--pool N]\n", argv[0]);
+      return 1;
+    }
+  }
+  redbase::RunBench(rows, num_threads, pool_size);
+  return 0;
+}